@@ -33,6 +33,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 """
 
 from math import ceil, floor
+import mmap
 import os
 from os.path import isfile, splitext
 import warnings
@@ -43,8 +44,13 @@ import numpy as np
 _ROCKETLOGGER_ADC_CLOCK_SCALE = (100e6 / 49) / 2.048e6
 
 _ROCKETLOGGER_FILE_MAGIC = 0x444C5225
+_ROCKETLOGGER_CHECKPOINT_MAGIC = 0x434C5225
 
-_SUPPORTED_FILE_VERSIONS = [1, 2, 3, 4]
+_SUPPORTED_FILE_VERSIONS = [1, 2, 3, 4, 5, 6]
+_COMPRESSED_FILE_VERSION = 5
+_PLANAR_FILE_VERSION = 6
+_FILE_VERSION_MASK = 0x00FF
+_FILE_VERSION_FLAG_CHECKSUM = 0x0100
 
 _BINARY_CHANNEL_STUFF_BYTES = 4
 _TIMESTAMP_SECONDS_BYTES = 8
@@ -63,6 +69,52 @@ _COMMENT_LENGTH_BYTES = 4
 _CHANNEL_BINARY_COUNT_BYTES = 2
 _CHANNEL_ANALOG_COUNT_BYTES = 2
 
+_COMPRESSED_BLOCK_SIZE_BYTES = 4
+_COMPRESSED_VALUE_BYTES = 4
+_COMPRESSED_GROUP_SIZE = 128
+_COMPRESSED_DECODE_VALUES = 2**20
+
+_COLUMN_OFFSET_BYTES = 4
+
+_BLOCK_CHECKSUM_BYTES = 4
+
+_INDEX_FILE_MAGIC = 0x494C5225
+_INDEX_FILE_EXTENSION = ".rli"
+_SUPPORTED_INDEX_VERSIONS = [1]
+_INDEX_HEADER_BYTES = 24
+_INDEX_RECORD_DTYPE = np.dtype(
+    [
+        ("block_offset", "<u8"),
+        ("realtime_sec", "<i8"),
+        ("realtime_ns", "<i8"),
+        ("monotonic_sec", "<i8"),
+        ("monotonic_ns", "<i8"),
+    ]
+)
+
+_SUMMARY_FILE_MAGIC = 0x534C5225
+_SUMMARY_FILE_EXTENSION = ".rls"
+_SUPPORTED_SUMMARY_VERSIONS = [1]
+_SUMMARY_BIN_SIZE_BYTES = 4
+_SUMMARY_CHANNEL_DTYPE = np.dtype(
+    [
+        ("min", "<i4"),
+        ("max", "<i4"),
+        ("mean", "<f4"),
+        ("valid", "<f4"),
+    ]
+)
+_OVERVIEW_BIN_COUNT_MAX = 10000
+
+_CHECKPOINT_MAGIC_BYTES = 4
+_CHECKPOINT_OFFSET_BYTES = 8
+_CHECKPOINT_BYTES = (
+    _CHECKPOINT_MAGIC_BYTES
+    + _DATA_BLOCK_COUNT_BYTES
+    + _SAMPLE_COUNT_BYTES
+    + _CHECKPOINT_OFFSET_BYTES
+)
+
 _CHANNEL_UNIT_INDEX_BYTES = 4
 _CHANNEL_SCALE_BYTES = 4
 _CHANNEL_DATA_BYTES_BYTES = 2
@@ -227,6 +279,285 @@ def _read_timestamp(file_handle):
     return timestamp_ns
 
 
+def _get_data_block_bytes(header):
+    """
+    Get the size of the uncompressed data blocks of a data file, including
+    the data block checksum if stored.
+
+    :param header: The file header dictionary of the data file
+
+    :returns: Size of a data block in bytes
+    """
+    block_bin_bytes = _BINARY_CHANNEL_STUFF_BYTES * ceil(
+        header["channel_binary_count"] / (_BINARY_CHANNEL_STUFF_BYTES * 8)
+    )
+    block_analog_bytes = sum(
+        [
+            c["data_size"]
+            for c in header["channels"]
+            if not _CHANNEL_IS_BINARY[c["unit_index"]]
+        ]
+    )
+    block_checksum_bytes = 0
+    if header.get("block_checksum", False):
+        block_checksum_bytes = _BLOCK_CHECKSUM_BYTES
+    return (
+        2 * _TIMESTAMP_BYTES
+        + header["data_block_size"] * (block_bin_bytes + block_analog_bytes)
+        + block_checksum_bytes
+    )
+
+
+def _search_block_time(block_timestamp, block_count, timestamp):
+    """
+    Binary search the data blocks for a realtime timestamp.
+
+    :param block_timestamp: Function returning the realtime timestamp of the
+        data block with the given index
+
+    :param block_count: Number of data blocks to search
+
+    :param timestamp: The timestamp to search for
+
+    :returns: Number of data blocks with a timestamp not after the searched one
+    """
+    low = 0
+    high = block_count
+    while low < high:
+        middle = (low + high) // 2
+        if block_timestamp(middle) <= timestamp:
+            low = middle + 1
+        else:
+            high = middle
+    return low
+
+
+def _read_channel(file_handle):
+    """
+    Read a channel definition of a file header.
+
+    :param file_handle: The file handle to read from at current position
+
+    :returns: Dictionary containing the read channel definition
+    """
+    channel = {}
+    channel["unit_index"] = _read_uint(file_handle, _CHANNEL_UNIT_INDEX_BYTES)
+    channel["scale"] = _read_int(file_handle, _CHANNEL_SCALE_BYTES)
+    channel["data_size"] = _read_uint(file_handle, _CHANNEL_DATA_BYTES_BYTES)
+    channel["valid_link"] = _read_uint(file_handle, _CHANNEL_VALID_LINK_BYTES)
+    channel["name"] = _read_str(file_handle, _CHANNEL_NAME_BYTES)
+
+    try:
+        channel["unit"] = _CHANNEL_UNIT_NAMES[channel["unit_index"]]
+    except KeyError:
+        raise KeyError(f"Undefined channel unit with index {channel['unit_index']}.")
+
+    return channel
+
+
+def _get_summary_record_dtype(channel_count):
+    """
+    Get the Numpy data type of the records of a measurement summary.
+
+    :param channel_count: Number of summarized channels
+
+    :returns: The Numpy data type of the summary records
+    """
+    return np.dtype(
+        [
+            ("level", "<u4"),
+            ("sample_count", "<u4"),
+            ("timestamp_sec", "<i8"),
+            ("timestamp_ns", "<i8"),
+            ("channel", _SUMMARY_CHANNEL_DTYPE, (channel_count,)),
+        ]
+    )
+
+
+def _get_summary_bin_counts(bin_ratio, bin_count):
+    """
+    Get the number of complete bins of a measurement summary per level.
+
+    Complete bins are stored as soon as they are complete, such that a bin is
+    stored right after the last bin of the finer levels it aggregates.
+
+    :param bin_ratio: List of the bin size of each level relative to the
+        finest level
+
+    :param bin_count: Total number of complete bins stored
+
+    :returns: List of the number of complete bins stored for each level
+    """
+
+    def stored_bins(count):
+        return sum([count // ratio for ratio in bin_ratio])
+
+    # largest number of finest bins with all completed bins stored
+    low = 0
+    high = bin_count
+    while low < high:
+        middle = (low + high + 1) // 2
+        if stored_bins(middle) <= bin_count:
+            low = middle
+        else:
+            high = middle - 1
+    return [low // ratio for ratio in bin_ratio]
+
+
+def _get_summary_bin_positions(bin_ratio, level, bin_index):
+    """
+    Get the record position of complete bins of a measurement summary level.
+
+    :param bin_ratio: List of the bin size of each level relative to the
+        finest level
+
+    :param level: The summary level of the bins
+
+    :param bin_index: Numpy array of the indexes of the bins within the level
+
+    :returns: Numpy array of the record positions of the bins
+    """
+    # number of finest bins completed when the bin is stored
+    finest_bins = (bin_index.astype(np.int64) + 1) * bin_ratio[level]
+
+    # bins of coarser levels completed at the same time are stored after it
+    position = np.full_like(finest_bins, -1)
+    for lvl, ratio in enumerate(bin_ratio):
+        if lvl <= level:
+            position += finest_bins // ratio
+        else:
+            position += (finest_bins - 1) // ratio
+    return position
+
+
+def _read_compressed_block_offsets(file_handle, data_offset, data_end):
+    """
+    Locate the compressed data blocks by their block size.
+
+    :param file_handle: The file handle to read from
+
+    :param data_offset: File offset of the first data block
+
+    :param data_end: File offset of the end of the data blocks
+
+    :returns: Tuple of the Numpy array of the file offsets of all complete
+        data blocks, and the file offset after the last complete data block
+    """
+    block_offsets = []
+    block_bytes_min = _COMPRESSED_BLOCK_SIZE_BYTES + 2 * _TIMESTAMP_BYTES
+    offset = data_offset
+    while offset + block_bytes_min <= data_end:
+        file_handle.seek(offset)
+        block_bytes = _read_uint(file_handle, _COMPRESSED_BLOCK_SIZE_BYTES)
+        if block_bytes < block_bytes_min or offset + block_bytes > data_end:
+            break
+        block_offsets.append(offset)
+        offset = offset + block_bytes
+
+    return np.array(block_offsets, dtype=np.int64), offset
+
+
+def _decode_compressed_blocks(file_bytes, block_offsets, block_size, column_count):
+    """
+    Decode compressed data blocks to the uncompressed data block layout.
+
+    Compressed data blocks store each data column as the first value, followed
+    by the zig-zag encoded differences of consecutive values. The differences
+    are bit-packed in groups of values sharing the same bit width.
+
+    :param file_bytes: Numpy byte array of the file content
+
+    :param block_offsets: Numpy array of the file offsets of the data blocks
+
+    :param block_size: Number of samples per data block
+
+    :param column_count: Number of 32 bit data columns per sample
+
+    :returns: Numpy byte array of the decoded data blocks, one row per block
+    """
+    group_count = ceil(block_size / _COMPRESSED_GROUP_SIZE)
+    width_offset = (
+        _COMPRESSED_BLOCK_SIZE_BYTES
+        + 2 * _TIMESTAMP_BYTES
+        + column_count * _COMPRESSED_VALUE_BYTES
+    )
+    payload_offset = width_offset + _COMPRESSED_VALUE_BYTES * ceil(
+        column_count * group_count / _COMPRESSED_VALUE_BYTES
+    )
+    blocks = np.empty(
+        (
+            len(block_offsets),
+            2 * _TIMESTAMP_BYTES + block_size * column_count * _COMPRESSED_VALUE_BYTES,
+        ),
+        dtype=np.uint8,
+    )
+
+    # group of each value of a column and the value index within the group
+    value_group = np.arange(block_size) // _COMPRESSED_GROUP_SIZE
+    value_index = np.arange(block_size) % _COMPRESSED_GROUP_SIZE
+    group_lengths = np.minimum(
+        block_size - np.arange(group_count) * _COMPRESSED_GROUP_SIZE,
+        _COMPRESSED_GROUP_SIZE,
+    )
+
+    # decode blocks in chunks to limit the memory of intermediate arrays
+    chunk_blocks = max(
+        1, _COMPRESSED_DECODE_VALUES // max(1, block_size * column_count)
+    )
+    for chunk_start in range(0, len(block_offsets), chunk_blocks):
+        offsets = block_offsets[chunk_start : chunk_start + chunk_blocks]
+        chunk = blocks[chunk_start : chunk_start + chunk_blocks]
+
+        # timestamps and first value of each column
+        block_header = file_bytes[
+            offsets[:, None] + np.arange(_COMPRESSED_BLOCK_SIZE_BYTES, width_offset)
+        ]
+        chunk[:, : 2 * _TIMESTAMP_BYTES] = block_header[:, : 2 * _TIMESTAMP_BYTES]
+        first_values = np.ascontiguousarray(
+            block_header[:, 2 * _TIMESTAMP_BYTES :]
+        ).view("<u4")
+
+        # bit width and bit offset of each group
+        widths = file_bytes[
+            offsets[:, None] + width_offset + np.arange(column_count * group_count)
+        ].astype(np.int64)
+        group_bits = 8 * ((widths * np.tile(group_lengths, column_count) + 7) // 8)
+        group_offsets = np.cumsum(group_bits, axis=1) - group_bits
+        widths = widths.reshape((len(offsets), column_count, group_count))
+        group_offsets = group_offsets.reshape((len(offsets), column_count, group_count))
+
+        # bit width and bit offset of each value
+        value_widths = widths[:, :, value_group]
+        value_offsets = (
+            8 * (offsets[:, None, None] + payload_offset)
+            + group_offsets[:, :, value_group]
+            + value_index * value_widths
+        )
+
+        # gather the 5 bytes covering a value of up to 32 bits at any bit offset
+        byte_offsets = value_offsets >> 3
+        words = np.zeros(value_offsets.shape, dtype=np.uint64)
+        for k in range(5):
+            byte_indexes = np.minimum(byte_offsets + k, len(file_bytes) - 1)
+            words |= file_bytes[byte_indexes].astype(np.uint64) << np.uint64(8 * k)
+        masks = (np.uint64(1) << value_widths.astype(np.uint64)) - np.uint64(1)
+        zigzag = (words >> (value_offsets & 7).astype(np.uint64)) & masks
+
+        # zig-zag decode differences and accumulate them to the values
+        deltas = (zigzag >> np.uint64(1)).astype(np.int64) ^ -(
+            zigzag & np.uint64(1)
+        ).astype(np.int64)
+        values = first_values[:, :, None].astype(np.int64) + np.cumsum(deltas, axis=2)
+
+        # store values sample-major as uncompressed data blocks
+        sample_values = np.ascontiguousarray(values.transpose((0, 2, 1)), dtype="<u4")
+        chunk[:, 2 * _TIMESTAMP_BYTES :] = sample_values.reshape(
+            (len(offsets), -1)
+        ).view(np.uint8)
+
+    return blocks
+
+
 class RocketLoggerFileError(IOError):
     """RocketLogger file read/write related errors."""
 
@@ -290,6 +621,9 @@ class RocketLoggerData:
         decimation_factor=1,
         recovery=False,
         memory_mapped=True,
+        start_time=None,
+        end_time=None,
+        channel_names=["all"],
     ):
         self._data = []
         self._filename = None
@@ -310,6 +644,9 @@ class RocketLoggerData:
                 decimation_factor=decimation_factor,
                 recovery=recovery,
                 memory_mapped=memory_mapped,
+                start_time=start_time,
+                end_time=end_time,
+                channel_names=channel_names,
             )
         else:
             raise FileNotFoundError(f"File '{filename}' does not exist.")
@@ -326,7 +663,10 @@ class RocketLoggerData:
         header = {}
 
         header["file_magic"] = _read_uint(file_handle, _FILE_MAGIC_BYTES)
-        header["file_version"] = _read_uint(file_handle, _FILE_VERSION_BYTES)
+        file_version = _read_uint(file_handle, _FILE_VERSION_BYTES)
+        header["file_version"] = file_version & _FILE_VERSION_MASK
+        if file_version & _FILE_VERSION_FLAG_CHECKSUM:
+            header["block_checksum"] = True
 
         # file consistency check
         if header["file_magic"] != _ROCKETLOGGER_FILE_MAGIC:
@@ -339,6 +679,10 @@ class RocketLoggerData:
             raise RocketLoggerFileError(
                 f"Unsupported RocketLogger data file version {header['file_version']}."
             )
+        if header.get("block_checksum", False) and header["file_version"] < 4:
+            raise RocketLoggerFileError(
+                f"Unsupported RocketLogger data file version {file_version}."
+            )
 
         # read static header fields
         header["header_length"] = _read_uint(file_handle, _HEADER_LENGTH_BYTES)
@@ -410,19 +754,7 @@ class RocketLoggerData:
         for ch in range(
             header["channel_binary_count"] + header["channel_analog_count"]
         ):
-            channel = {}
-            channel["unit_index"] = _read_uint(file_handle, _CHANNEL_UNIT_INDEX_BYTES)
-            channel["scale"] = _read_int(file_handle, _CHANNEL_SCALE_BYTES)
-            channel["data_size"] = _read_uint(file_handle, _CHANNEL_DATA_BYTES_BYTES)
-            channel["valid_link"] = _read_uint(file_handle, _CHANNEL_VALID_LINK_BYTES)
-            channel["name"] = _read_str(file_handle, _CHANNEL_NAME_BYTES)
-
-            try:
-                channel["unit"] = _CHANNEL_UNIT_NAMES[channel["unit_index"]]
-            except KeyError:
-                raise KeyError(
-                    f"Undefined channel unit with index {channel['unit_index']}."
-                )
+            channel = _read_channel(file_handle)
 
             # FILE VERSION DEPENDENT FIXES (BACKWARD COMPATIBILITY)
             # fix 1 based indexing of valid channel links for file version <= 2
@@ -435,6 +767,12 @@ class RocketLoggerData:
             # add channel to header
             header["channels"].append(channel)
 
+        # read data column offsets of channel-planar data blocks
+        if header["file_version"] == _PLANAR_FILE_VERSION:
+            header["column_offsets"] = self._read_file_column_offsets(
+                file_handle, header
+            )
+
         # consistency check: file stream position matches header size
         stream_position = file_handle.tell()
         if stream_position != header["header_length"]:
@@ -445,6 +783,49 @@ class RocketLoggerData:
 
         return header
 
+    def _read_file_column_offsets(self, file_handle, header):
+        """
+        Read the data column offsets of a channel-planar data file.
+
+        :param file_handle: The file handle to read from, with pointer
+            positioned after the channel definitions
+
+        :param header: The file header dictionary with the channel definitions
+
+        :returns: List of the byte offsets of the data columns within a data
+            block, the binary channel column first if available
+        """
+        column_bytes = [
+            c["data_size"]
+            for c in header["channels"]
+            if not _CHANNEL_IS_BINARY[c["unit_index"]]
+        ]
+        if header["channel_binary_count"] > 0:
+            column_bytes.insert(
+                0,
+                _BINARY_CHANNEL_STUFF_BYTES
+                * ceil(
+                    header["channel_binary_count"] / (_BINARY_CHANNEL_STUFF_BYTES * 8)
+                ),
+            )
+
+        column_offsets = [
+            _read_uint(file_handle, _COLUMN_OFFSET_BYTES) for _ in column_bytes
+        ]
+
+        # consistency check: columns within data block and not overlapping
+        block_bytes = _get_data_block_bytes(header)
+        columns = sorted(zip(column_offsets, column_bytes))
+        column_end = 2 * _TIMESTAMP_BYTES
+        for offset, data_size in columns:
+            if offset < column_end:
+                raise RocketLoggerFileError(f"Invalid data column offset {offset}.")
+            column_end = offset + header["data_block_size"] * data_size
+        if column_end > block_bytes:
+            raise RocketLoggerFileError("Data columns exceed data block size.")
+
+        return column_offsets
+
     def _validate_matching_header(self, header1, header2):
         """
         Validate that file headers match, i.e. correspond to the same measurement.
@@ -470,8 +851,292 @@ class RocketLoggerData:
                     f"File header not matching at field: {header_field}"
                 )
 
+    def _read_file_checkpoint(self, file_handle, header):
+        """
+        Read the checkpoint record at the end of an unfinished data file.
+
+        The checkpoint record is present after the last data block of files
+        not properly closed, e.g. due to power supply failures during
+        measurements, and holds the block and sample count of the data
+        blocks completely written to the file.
+
+        :param file_handle: The file handle to read from
+
+        :param header: The file header dictionary, block and sample counts are
+            updated from a valid checkpoint record
+
+        :returns: Size of the checkpoint record in bytes if a valid record was
+            found, 0 otherwise
+        """
+        file_size = file_handle.seek(0, os.SEEK_END)
+        if file_size < header["header_length"] + _CHECKPOINT_BYTES:
+            return 0
+
+        file_handle.seek(file_size - _CHECKPOINT_BYTES)
+        checkpoint_magic = _read_uint(file_handle, _CHECKPOINT_MAGIC_BYTES)
+        data_block_count = _read_uint(file_handle, _DATA_BLOCK_COUNT_BYTES)
+        sample_count = _read_uint(file_handle, _SAMPLE_COUNT_BYTES)
+        checkpoint_offset = _read_uint(file_handle, _CHECKPOINT_OFFSET_BYTES)
+
+        # valid record only if located at the offset it was written for
+        if (
+            checkpoint_magic != _ROCKETLOGGER_CHECKPOINT_MAGIC
+            or checkpoint_offset != file_size - _CHECKPOINT_BYTES
+            or ceil(sample_count / header["data_block_size"]) != data_block_count
+        ):
+            return 0
+
+        if data_block_count != header["data_block_count"]:
+            warnings.warn(
+                RocketLoggerDataWarning(
+                    f"unfinished file: using checkpoint of {data_block_count} "
+                    f"data blocks, header lists {header['data_block_count']}."
+                )
+            )
+        header["data_block_count"] = data_block_count
+        header["sample_count"] = sample_count
+
+        return _CHECKPOINT_BYTES
+
+    def _read_file_index(self, file_name, header):
+        """
+        Read the data block index stored alongside a data file.
+
+        :param file_name: The name of the indexed data file
+
+        :param header: The file header dictionary of the indexed data file
+
+        :returns: Numpy array of the index records of the data blocks, memory
+            mapped, or None if no valid and complete index is available
+        """
+        index_file_name = splitext(file_name)[0] + _INDEX_FILE_EXTENSION
+        if not isfile(index_file_name):
+            return None
+
+        with open(index_file_name, "rb") as index_handle:
+            index_magic = _read_uint(index_handle, 4)
+            index_version = _read_uint(index_handle, 2)
+            record_bytes = _read_uint(index_handle, 2)
+            start_time = _read_timestamp(index_handle)
+            index_size = index_handle.seek(0, os.SEEK_END)
+
+            # index of the matching data file with records for all data blocks
+            if (
+                index_magic != _INDEX_FILE_MAGIC
+                or index_version not in _SUPPORTED_INDEX_VERSIONS
+                or record_bytes != _INDEX_RECORD_DTYPE.itemsize
+                or start_time != header["start_time"]
+                or (index_size - _INDEX_HEADER_BYTES) // record_bytes
+                < header["data_block_count"]
+            ):
+                return None
+            if header["data_block_count"] == 0:
+                return np.empty(0, dtype=_INDEX_RECORD_DTYPE)
+
+            index = np.memmap(
+                index_handle,
+                offset=_INDEX_HEADER_BYTES,
+                mode="r",
+                dtype=_INDEX_RECORD_DTYPE,
+                shape=header["data_block_count"],
+            )
+
+        if index[0]["block_offset"] != header["header_length"]:
+            return None
+        return index
+
+    def _read_summary(self, file_name, header):
+        """
+        Read the measurement summary stored alongside a data file.
+
+        :param file_name: The name of the summarized data file
+
+        :param header: The file header dictionary of the summarized data file
+
+        :returns: Dictionary of the summary header, the summarized channels,
+            the number of bins per level and the memory mapped summary records
+
+        :raises RocketLoggerFileError: If no matching summary is available
+        """
+        summary_file_name = splitext(file_name)[0] + _SUMMARY_FILE_EXTENSION
+        if not isfile(summary_file_name):
+            raise RocketLoggerFileError(
+                f"Summary file '{summary_file_name}' does not exist."
+            )
+
+        with open(summary_file_name, "rb") as summary_handle:
+            summary = {}
+            summary_magic = _read_uint(summary_handle, 4)
+            summary["summary_version"] = _read_uint(summary_handle, 2)
+            record_bytes = _read_uint(summary_handle, 2)
+            channel_count = _read_uint(summary_handle, 2)
+            level_count = _read_uint(summary_handle, 2)
+            summary["sample_rate"] = _read_uint(summary_handle, 4)
+            summary["start_time"] = _read_timestamp(summary_handle)
+            summary["bin_size"] = [
+                _read_uint(summary_handle, _SUMMARY_BIN_SIZE_BYTES)
+                for _ in range(level_count)
+            ]
+            summary["channels"] = [
+                _read_channel(summary_handle) for _ in range(channel_count)
+            ]
+            records_offset = summary_handle.tell()
+            summary_size = summary_handle.seek(0, os.SEEK_END)
+
+            record_dtype = _get_summary_record_dtype(channel_count)
+            if (
+                summary_magic != _SUMMARY_FILE_MAGIC
+                or summary["summary_version"] not in _SUPPORTED_SUMMARY_VERSIONS
+                or record_bytes != record_dtype.itemsize
+            ):
+                raise RocketLoggerFileError(
+                    f"Unsupported summary file '{summary_file_name}'."
+                )
+            if summary["start_time"] != header["start_time"]:
+                raise RocketLoggerFileError(
+                    f"Summary file '{summary_file_name}' not matching data file."
+                )
+
+            record_count = (summary_size - records_offset) // record_bytes
+            if record_count == 0:
+                summary["records"] = np.empty(0, dtype=record_dtype)
+            else:
+                summary["records"] = np.memmap(
+                    summary_handle,
+                    offset=records_offset,
+                    mode="r",
+                    dtype=record_dtype,
+                    shape=record_count,
+                )
+
+        # incomplete bins stored last when the measurement finished
+        records = summary["records"]
+        summary["bin_incomplete"] = {}
+        for position in range(record_count - 1, record_count - level_count - 1, -1):
+            if position < 0:
+                break
+            level = int(records[position]["level"])
+            if level >= level_count or level in summary["bin_incomplete"]:
+                break
+            if records[position]["sample_count"] >= summary["bin_size"][level]:
+                break
+            summary["bin_incomplete"][level] = position
+
+        # number of complete bins from the record order
+        summary["bin_ratio"] = [
+            bin_size // summary["bin_size"][0] for bin_size in summary["bin_size"]
+        ]
+        summary["bin_count"] = _get_summary_bin_counts(
+            summary["bin_ratio"], record_count - len(summary["bin_incomplete"])
+        )
+
+        return summary
+
+    def _select_file_blocks(
+        self, file_handle, header, index, block_offsets, start_time, end_time
+    ):
+        """
+        Select the data blocks of a data file overlapping with a time range.
+
+        Uses a binary search on the realtime timestamps of the data blocks,
+        read from the data block index if available, or the data file otherwise.
+
+        :param file_handle: The file handle of the data file
+
+        :param header: The file header dictionary of the data file
+
+        :param index: Numpy array of the index records of the data blocks, or
+            None if not available
+
+        :param block_offsets: Numpy array of the file offsets of the data
+            blocks, required for compressed data files without index only
+
+        :param start_time: Start of the time range, None for the file start
+
+        :param end_time: End of the time range, None for the file end
+
+        :returns: Tuple of the index of the first selected data block and the
+            number of selected data blocks
+        """
+        block_count = header["data_block_count"]
+
+        if index is not None:
+
+            def block_timestamp(block_index):
+                record = index[block_index]
+                return np.datetime64(int(record["realtime_sec"]), "s") + np.timedelta64(
+                    int(record["realtime_ns"]), "ns"
+                )
+
+        elif header["file_version"] == _COMPRESSED_FILE_VERSION:
+
+            def block_timestamp(block_index):
+                file_handle.seek(
+                    int(block_offsets[block_index]) + _COMPRESSED_BLOCK_SIZE_BYTES
+                )
+                return _read_timestamp(file_handle)
+
+        else:
+            block_bytes = _get_data_block_bytes(header)
+
+            def block_timestamp(block_index):
+                file_handle.seek(header["header_length"] + block_index * block_bytes)
+                return _read_timestamp(file_handle)
+
+        # blocks ending after the start time and starting before the end time
+        first_block = 0
+        if start_time is not None:
+            block_duration = np.timedelta64(
+                round(
+                    1e9
+                    * header["data_block_size"]
+                    / (header["sample_rate"] * _ROCKETLOGGER_ADC_CLOCK_SCALE)
+                ),
+                "ns",
+            )
+            first_block = _search_block_time(
+                block_timestamp, block_count, start_time - block_duration
+            )
+        last_block = block_count
+        if end_time is not None:
+            last_block = _search_block_time(block_timestamp, block_count, end_time)
+
+        return first_block, max(last_block - first_block, 0)
+
+    def _select_channels(self, header, channel_names):
+        """
+        Select the channels to load, including their linked valid channels.
+
+        :param header: The file header dictionary of the data file
+
+        :param channel_names: List of the names of the channels to load
+
+        :returns: List of the names of the channels to load
+        """
+        header_channel_names = [channel["name"] for channel in header["channels"]]
+        selected_channel_names = []
+        for channel_name in channel_names:
+            if channel_name not in header_channel_names:
+                raise KeyError(f"Channel '{channel_name}' not found.")
+            selected_channel_names.append(channel_name)
+
+            channel = header["channels"][header_channel_names.index(channel_name)]
+            if channel["valid_link"] != _CHANNEL_VALID_UNLINKED:
+                selected_channel_names.append(
+                    header_channel_names[channel["valid_link"]]
+                )
+
+        return selected_channel_names
+
     def _read_file_data(
-        self, file_handle, file_header, decimation_factor=1, memory_mapped=True
+        self,
+        file_handle,
+        file_header,
+        decimation_factor=1,
+        memory_mapped=True,
+        block_offsets=None,
+        first_block=0,
+        channel_names=None,
     ):
         """
         Read data block at the current position in the RocketLogger data file.
@@ -488,9 +1153,18 @@ class RocketLoggerData:
             increase file read performance for many smaller files and/or
             some system configurations.
 
+        :param block_offsets: Numpy array of the file offsets of the data
+            blocks, required for compressed data files only
+
+        :param first_block: Index of the first data block to read
+
+        :param channel_names: Names of the channels to extract, None to extract
+            all channels. For channel-planar data files only the data columns
+            of the extracted channels are read from memory mapped files.
+
         :returns: Tuple of realtime, monotonic clock based Numpy datetime64
             arrays, and the list of Numpy arrays containing the read channel
-            data
+            data (None for channels not extracted)
         """
         # generate data type to read from header info
         total_bin_bytes = _BINARY_CHANNEL_STUFF_BYTES * ceil(
@@ -518,26 +1192,91 @@ class RocketLoggerData:
 
         # read raw data from file
         data_dtype = np.dtype({"names": data_names, "formats": data_formats})
-        block_dtype = np.dtype(
+        timestamp_dtype = np.dtype(
             [
                 ("realtime_sec", f"<M{_TIMESTAMP_SECONDS_BYTES:d}[s]"),
                 ("realtime_ns", f"<m{_TIMESTAMP_NANOSECONDS_BYTES:d}[ns]"),
                 ("monotonic_sec", f"<M{_TIMESTAMP_SECONDS_BYTES:d}[s]"),
                 ("monotonic_ns", f"<m{_TIMESTAMP_NANOSECONDS_BYTES:d}[ns]"),
-                ("data", (data_dtype, (file_header["data_block_size"],))),
             ]
         )
+        if file_header["file_version"] == _PLANAR_FILE_VERSION:
+            # data columns of all samples at the offsets defined in the header
+            block_dtype = np.dtype(
+                {
+                    "names": list(timestamp_dtype.names) + data_names,
+                    "formats": [
+                        timestamp_dtype.fields[name][0]
+                        for name in timestamp_dtype.names
+                    ]
+                    + [
+                        (data_format, (file_header["data_block_size"],))
+                        for data_format in data_formats
+                    ],
+                    "offsets": [
+                        timestamp_dtype.fields[name][1]
+                        for name in timestamp_dtype.names
+                    ]
+                    + file_header["column_offsets"],
+                    "itemsize": _get_data_block_bytes(file_header),
+                }
+            )
+        else:
+            # compressed data blocks are decoded without checksum
+            checksum_dtype = []
+            if (
+                file_header.get("block_checksum", False)
+                and file_header["file_version"] != _COMPRESSED_FILE_VERSION
+            ):
+                checksum_dtype = [("checksum", f"<u{_BLOCK_CHECKSUM_BYTES:d}")]
+            block_dtype = np.dtype(
+                timestamp_dtype.descr
+                + [("data", (data_dtype, (file_header["data_block_size"],)))]
+                + checksum_dtype
+            )
 
         # access file data, either memory mapped or direct read to memory
-        file_handle.seek(file_header["header_length"])
-        if memory_mapped:
+        data_offset = file_header["header_length"] + first_block * block_dtype.itemsize
+        file_handle.seek(data_offset)
+        if file_header["file_version"] == _COMPRESSED_FILE_VERSION:
+            # decode compressed blocks of 32 bit data columns to memory
+            column_count = len(data_names)
+            if data_dtype.itemsize != column_count * _COMPRESSED_VALUE_BYTES:
+                raise RocketLoggerFileError(
+                    "Unsupported channel data size for compressed data file."
+                )
+            if memory_mapped:
+                file_bytes = np.memmap(file_handle, mode="r", dtype=np.uint8)
+            else:
+                file_handle.seek(0)
+                file_bytes = np.fromfile(file_handle, dtype=np.uint8, sep="")
+            file_data = _decode_compressed_blocks(
+                file_bytes,
+                np.array(
+                    block_offsets[
+                        first_block : first_block + file_header["data_block_count"]
+                    ],
+                    dtype=np.int64,
+                ),
+                file_header["data_block_size"],
+                column_count,
+            ).view(block_dtype)[:, 0]
+        elif memory_mapped:
             file_data = np.memmap(
                 file_handle,
-                offset=file_header["header_length"],
+                offset=data_offset,
                 mode="r",
                 dtype=block_dtype,
                 shape=file_header["data_block_count"],
             )
+
+            # avoid read-ahead of the data columns of channels not extracted
+            if (
+                file_header["file_version"] == _PLANAR_FILE_VERSION
+                and channel_names is not None
+                and hasattr(mmap, "MADV_RANDOM")
+            ):
+                file_data._mmap.madvise(mmap.MADV_RANDOM)
         else:
             file_data = np.fromfile(
                 file_handle,
@@ -547,7 +1286,10 @@ class RocketLoggerData:
             )
 
         # reference for data blocks speeds up access time
-        block_data = np.array(file_data["data"], copy=False)
+        if file_header["file_version"] == _PLANAR_FILE_VERSION:
+            block_data = file_data
+        else:
+            block_data = np.array(file_data["data"], copy=False)
 
         # extract timestamps
         timestamps_realtime = file_data["realtime_sec"] + file_data["realtime_ns"]
@@ -561,6 +1303,11 @@ class RocketLoggerData:
         # extract binary channels
         for binary_channel_index in range(file_header["channel_binary_count"]):
             channel_index = binary_channel_index
+            if (
+                channel_names is not None
+                and file_header["channels"][channel_index]["name"] not in channel_names
+            ):
+                continue
             data[channel_index] = np.array(
                 2 ** binary_channel_index & block_data["bin"], dtype=np.dtype("b1")
             )
@@ -583,6 +1330,11 @@ class RocketLoggerData:
         # extract analog channels
         for analog_channel_index in range(file_header["channel_analog_count"]):
             channel_index = file_header["channel_binary_count"] + analog_channel_index
+            if (
+                channel_names is not None
+                and analog_data_names[analog_channel_index] not in channel_names
+            ):
+                continue
             data[channel_index] = np.array(
                 block_data[analog_data_names[analog_channel_index]],
                 dtype=np.dtype(analog_data_formats[analog_channel_index]),
@@ -759,6 +1511,9 @@ class RocketLoggerData:
         decimation_factor=1,
         recovery=False,
         memory_mapped=True,
+        start_time=None,
+        end_time=None,
+        channel_names=["all"],
     ):
         """
         Read data from a RocketLogger data file.
@@ -788,6 +1543,21 @@ class RocketLoggerData:
             memory at once, instead of using memory mapped reading. Might
             increase file read performance for many smaller files and/or
             some system configurations.
+
+        :param start_time: Load only the data blocks from the one containing
+            the given realtime timestamp (any value accepted by Numpy's
+            datetime64, in UTC). Uses a binary search on the data block index
+            stored alongside the data files if available.
+
+        :param end_time: Load only the data blocks up to the one containing
+            the given realtime timestamp (any value accepted by Numpy's
+            datetime64, in UTC)
+
+        :param channel_names: Load only the data of the given channels and
+            their linked valid channels. List of channel names or "all" to load
+            all channels. For data files stored with channel-planar layout,
+            only the selected channels are read from memory mapped files.
+            Ignored for header only import.
         """
         if self._filename is not None:
             raise RocketLoggerDataError(
@@ -810,6 +1580,14 @@ class RocketLoggerData:
                 "a list of integers or an integer Numpy array."
             )
 
+        if not isinstance(channel_names, list):
+            channel_names = [channel_names]
+
+        if start_time is not None:
+            start_time = np.datetime64(start_time, "ns")
+        if end_time is not None:
+            end_time = np.datetime64(end_time, "ns")
+
         file_basename, file_extension = splitext(filename)
         file_number = 0
         files_loaded = 0
@@ -834,6 +1612,13 @@ class RocketLoggerData:
                 if files_loaded == 0:
                     # read full header for first file
                     header = self._read_file_header(file_handle)
+
+                    # channels to load including their linked valid channels
+                    load_channel_names = None
+                    if "all" not in channel_names:
+                        load_channel_names = self._select_channels(
+                            header, channel_names
+                        )
                 else:
                     # read header lead-in only for continuation file
                     header = self._read_file_header_lead_in(file_handle)
@@ -845,6 +1630,11 @@ class RocketLoggerData:
                     # reuse previously read header fields
                     header["comment"] = self._header["comment"]
                     header["channels"] = self._header["channels"]
+                    if "column_offsets" in self._header:
+                        header["column_offsets"] = self._header["column_offsets"]
+
+                # use counts of checkpoint record of unfinished files
+                checkpoint_bytes = self._read_file_checkpoint(file_handle, header)
 
                 # validate decimation factor argument
                 if (header["data_block_size"] % decimation_factor) > 0:
@@ -858,32 +1648,51 @@ class RocketLoggerData:
                     self._timestamps_monotonic = None
                     self._data = None
                 else:
-                    # calculate data block size
-                    block_bin_bytes = _BINARY_CHANNEL_STUFF_BYTES * ceil(
-                        header["channel_binary_count"]
-                        / (_BINARY_CHANNEL_STUFF_BYTES * 8)
-                    )
-                    block_analog_bytes = sum(
-                        [
-                            c["data_size"]
-                            for c in header["channels"]
-                            if not _CHANNEL_IS_BINARY[c["unit_index"]]
-                        ]
-                    )
-                    block_size_bytes = 2 * _TIMESTAMP_BYTES + header[
-                        "data_block_size"
-                    ] * (block_bin_bytes + block_analog_bytes)
-
-                    # file size and header consistency check and recovery
                     file_size = file_handle.seek(0, os.SEEK_END)
-                    file_data_bytes = (
-                        header["header_length"]
-                        + header["data_block_count"] * block_size_bytes
-                    )
-                    if file_size != file_data_bytes:
+                    index = self._read_file_index(file_name, header)
+                    if header["file_version"] == _COMPRESSED_FILE_VERSION:
+                        # locate compressed data blocks using the index if valid
+                        block_offsets = None
+                        if index is not None and len(index) > 0:
+                            last_offset = int(index[-1]["block_offset"])
+                            file_handle.seek(last_offset)
+                            data_end = last_offset + _read_uint(
+                                file_handle, _COMPRESSED_BLOCK_SIZE_BYTES
+                            )
+                            if data_end + checkpoint_bytes == file_size:
+                                block_offsets = index["block_offset"]
+                                data_blocks_recovered = len(block_offsets)
+                                file_data_valid = True
+
+                        # locate compressed data blocks of variable size
+                        if block_offsets is None:
+                            block_offsets, data_end = _read_compressed_block_offsets(
+                                file_handle,
+                                header["header_length"],
+                                file_size - checkpoint_bytes,
+                            )
+                            data_blocks_recovered = len(block_offsets)
+                            file_data_valid = (
+                                data_blocks_recovered == header["data_block_count"]
+                                and data_end + checkpoint_bytes == file_size
+                            )
+                    else:
+                        # file size and header consistency check
+                        block_offsets = None
+                        block_size_bytes = _get_data_block_bytes(header)
+                        file_data_bytes = (
+                            header["header_length"]
+                            + header["data_block_count"] * block_size_bytes
+                            + checkpoint_bytes
+                        )
                         data_blocks_recovered = floor(
-                            (file_size - header["header_length"]) / block_size_bytes
+                            (file_size - header["header_length"] - checkpoint_bytes)
+                            / block_size_bytes
                         )
+                        file_data_valid = file_size == file_data_bytes
+
+                    # recovery of incomplete data blocks
+                    if not file_data_valid:
                         data_blocks_truncated = (
                             header["data_block_count"] - data_blocks_recovered
                         )
@@ -906,6 +1715,24 @@ class RocketLoggerData:
                                 "the file end."
                             )
 
+                    # index is incomplete for additionally recovered data blocks
+                    if index is not None and len(index) < header["data_block_count"]:
+                        index = None
+
+                    # select data blocks of the time range
+                    first_block = 0
+                    if start_time is not None or end_time is not None:
+                        first_block, block_count = self._select_file_blocks(
+                            file_handle,
+                            header,
+                            index,
+                            block_offsets,
+                            start_time,
+                            end_time,
+                        )
+                        header["data_block_count"] = block_count
+                        header["sample_count"] = block_count * header["data_block_size"]
+
                     # channels: read actual sampled data
                     (
                         timestamps_realtime,
@@ -916,6 +1743,9 @@ class RocketLoggerData:
                         header,
                         decimation_factor=decimation_factor,
                         memory_mapped=memory_mapped,
+                        block_offsets=block_offsets,
+                        first_block=first_block,
+                        channel_names=load_channel_names,
                     )
 
                     # store new data array on first file, append on following
@@ -927,7 +1757,8 @@ class RocketLoggerData:
                             (self._timestamps_monotonic, timestamps_monotonic)
                         )
                         for i in range(len(self._data)):
-                            self._data[i] = np.concatenate((self._data[i], data[i]))
+                            if data[i] is not None:
+                                self._data[i] = np.concatenate((self._data[i], data[i]))
                     else:
                         self._timestamps_realtime = timestamps_realtime
                         self._timestamps_monotonic = timestamps_monotonic
@@ -957,6 +1788,16 @@ class RocketLoggerData:
                 f"Could not load valid data from '{filename}' "
                 "and current import configuration."
             )
+        if (start_time is not None or end_time is not None) and (
+            not header_only and self._header["sample_count"] == 0
+        ):
+            raise RocketLoggerDataError("No data found in the selected time range.")
+
+        # remove channels not selected for import
+        if load_channel_names is not None and not header_only:
+            for channel_name in self.get_channel_names():
+                if channel_name not in load_channel_names:
+                    self.remove_channel(channel_name)
 
         # adjust header files for decimation
         self._header["sample_count"] = round(
@@ -1166,6 +2007,84 @@ class RocketLoggerData:
 
         return validity
 
+    def get_overview(self, channel_names=["all"], resolution=None):
+        """
+        Get a min/max/mean overview of the measurement from its summary file.
+
+        The summary file (`*.rls`) is stored alongside the data file by the
+        RocketLogger and summarizes the analog channels at multiple time
+        resolutions, such that whole measurements can be displayed without
+        reading their data. The overview is also available for header only
+        imported files. For sample rates below 1 kSPS, the summary is computed
+        from the samples before their aggregation to the stored sample rate.
+
+        :param channel_names: The names of the channels for which the overview
+            shall be returned. List of channel names or "all" to select all
+            summarized channels.
+
+        :param resolution: The time resolution of the overview in seconds. The
+            finest summary level with a bin duration of at least the resolution
+            is used. By default, the finest level with at most 10000 bins is
+            used.
+
+        :returns: Dictionary of the overview with the bin start times `time`
+            and the bin durations `duration` in seconds, and Numpy arrays of
+            the `min`, `max` and `mean` values and the ratio of `valid`
+            samples with one column per channel
+
+        :raises RocketLoggerFileError: If no matching summary is available
+        """
+        if not isinstance(channel_names, list):
+            channel_names = [channel_names]
+
+        summary = self._read_summary(self._filename, self._header)
+        summary_channel_names = [channel["name"] for channel in summary["channels"]]
+        if "all" in channel_names:
+            channel_names = summary_channel_names
+
+        # select summary level
+        level_count = len(summary["bin_size"])
+        level_duration = [
+            bin_size / summary["sample_rate"] for bin_size in summary["bin_size"]
+        ]
+        level = level_count - 1
+        for lvl in range(level_count):
+            if resolution is not None and level_duration[lvl] >= resolution:
+                level = lvl
+                break
+            bin_count = summary["bin_count"][lvl] + (lvl in summary["bin_incomplete"])
+            if resolution is None and bin_count <= _OVERVIEW_BIN_COUNT_MAX:
+                level = lvl
+                break
+
+        # read the records of the level in bin order
+        positions = _get_summary_bin_positions(
+            summary["bin_ratio"], level, np.arange(summary["bin_count"][level])
+        )
+        if level in summary["bin_incomplete"]:
+            positions = np.append(positions, summary["bin_incomplete"][level])
+        records = summary["records"][positions]
+
+        overview = {
+            "time": records["timestamp_sec"].astype("datetime64[s]")
+            + records["timestamp_ns"].astype("timedelta64[ns]"),
+            "duration": records["sample_count"] / summary["sample_rate"],
+        }
+        for field in ["min", "max", "mean", "valid"]:
+            overview[field] = np.empty((len(records), len(channel_names)))
+
+        for channel_name in channel_names:
+            if channel_name not in summary_channel_names:
+                raise KeyError(f"Channel '{channel_name}' not found in summary.")
+            index = summary_channel_names.index(channel_name)
+            column = channel_names.index(channel_name)
+            scale = 10 ** summary["channels"][index]["scale"]
+            for field in ["min", "max", "mean"]:
+                overview[field][:, column] = records["channel"][field][:, index] * scale
+            overview["valid"][:, column] = records["channel"]["valid"][:, index]
+
+        return overview
+
     def merge_channels(self, keep_channels=False):
         """
         Merge seamlessly switched current channels into a combined channel.
@@ -0,0 +1,368 @@
+"""
+RocketLogger Shared Memory Data Reader.
+
+Client for the measurement data published by the RocketLogger for the web
+interface.
+
+
+Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+"""
+
+import ctypes
+import ctypes.util
+
+import numpy as np
+
+
+ROCKETLOGGER_DATA_SHM_KEY = 4443
+"""Default RocketLogger data shared memory key."""
+
+_SHM_VERSION = 1
+
+_SHM_SEQUENCE_MASK = 0xFFFFFFFF
+
+_SHM_RDONLY = 0o10000
+
+_SHM_HEADER_DTYPE = np.dtype(
+    [
+        ("version", "<u2"),
+        ("header_size", "<u2"),
+        ("block_count", "<u4"),
+        ("block_size", "<u4"),
+        ("block_length", "<u4"),
+        ("sample_rate", "<u4"),
+        ("update_rate", "<u4"),
+        ("channel_mask", "<u4"),
+        ("digital_enable", "<u4"),
+        ("write_sequence", "<u4"),
+        ("stopped", "<u4"),
+    ]
+)
+
+_SHM_BLOCK_DTYPE = np.dtype(
+    [
+        ("sequence", "<u4"),
+        ("sample_count", "<u4"),
+        ("index", "<u8"),
+        ("samples_lost", "<u8"),
+        ("timestamp_realtime", "<i8", (2,)),
+        ("timestamp_monotonic", "<i8", (2,)),
+    ]
+)
+
+_SHM_CHANNELS = [
+    {"name": "V1", "unit": "V", "scale": 1e-8},
+    {"name": "V2", "unit": "V", "scale": 1e-8},
+    {"name": "V3", "unit": "V", "scale": 1e-8},
+    {"name": "V4", "unit": "V", "scale": 1e-8},
+    {"name": "I1L", "unit": "A", "scale": 1e-11},
+    {"name": "I1H", "unit": "A", "scale": 1e-9},
+    {"name": "I2L", "unit": "A", "scale": 1e-11},
+    {"name": "I2H", "unit": "A", "scale": 1e-9},
+    {"name": "DT", "unit": "s", "scale": 1e-9},
+]
+
+
+def _load_libc():
+    """
+    Load the C library providing the System V shared memory functions.
+
+    :returns: The C library with argument and return types of the shared
+        memory functions set up
+    """
+    libc = ctypes.CDLL(ctypes.util.find_library("c"), use_errno=True)
+    libc.shmget.argtypes = [ctypes.c_int, ctypes.c_size_t, ctypes.c_int]
+    libc.shmget.restype = ctypes.c_int
+    libc.shmat.argtypes = [ctypes.c_int, ctypes.c_void_p, ctypes.c_int]
+    libc.shmat.restype = ctypes.c_void_p
+    libc.shmdt.argtypes = [ctypes.c_void_p]
+    libc.shmdt.restype = ctypes.c_int
+    return libc
+
+
+def _parse_timestamp(values):
+    """
+    Convert a raw RocketLogger timestamp to a numpy datetime.
+
+    :param values: Array of the seconds and nanoseconds of the timestamp
+
+    :returns: The timestamp as numpy datetime64 in nanoseconds
+    """
+    return np.datetime64(int(values[0]) * 1000000000 + int(values[1]), "ns")
+
+
+class RocketLoggerSharedMemoryError(IOError):
+    """RocketLogger shared memory data reader related errors."""
+
+    pass
+
+
+class RocketLoggerOverrunError(RocketLoggerSharedMemoryError):
+    """Data blocks overwritten before the reader processed them."""
+
+    pass
+
+
+class RocketLoggerDataReader:
+    """
+    RocketLogger shared memory data reader.
+
+    Reads the calibrated data blocks of a running measurement at full rate
+    from the shared memory ring written by the RocketLogger when sampling
+    with the `--shm` option. Any number of readers can attach read-only,
+    the RocketLogger never waits for them. A reader falling behind by more
+    than the ring size gets a :class:`RocketLoggerOverrunError` and resumes
+    with the oldest block still available.
+
+    The channel values are returned as the raw calibrated integer values
+    mapped from the shared memory, multiply them by the channel `scale` of
+    :attr:`channels` to get the values in the channel `unit`.
+
+    Only works on the RocketLogger itself, i.e. on Linux systems with the
+    System V shared memory of the measurement.
+
+    :param key: The System V key of the RocketLogger data shared memory
+    """
+
+    def __init__(self, key=ROCKETLOGGER_DATA_SHM_KEY):
+        self._key = key
+        self._libc = None
+        self._address = None
+        self._memory = None
+        self._header = None
+        self._sequence = 0
+        self.channels = []
+        self.blocks_lost = 0
+
+    def __enter__(self):
+        self.open()
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+    def open(self):
+        """
+        Attach read-only to the data shared memory ring of the running
+        measurement, starting with the next block written.
+        """
+        if self._libc is None:
+            self._libc = _load_libc()
+
+        shm_id = self._libc.shmget(self._key, 0, 0)
+        if shm_id < 0:
+            errno = ctypes.get_errno()
+            raise RocketLoggerSharedMemoryError(
+                errno, "No data shared memory, measurement with --shm running?"
+            )
+        address = self._libc.shmat(shm_id, None, _SHM_RDONLY)
+        if address is None or address == ctypes.c_void_p(-1).value:
+            errno = ctypes.get_errno()
+            raise RocketLoggerSharedMemoryError(
+                errno, "Failed attaching to the data shared memory."
+            )
+        self._address = address
+
+        # map header first to get the size of the ring
+        header = np.frombuffer(
+            (ctypes.c_uint8 * _SHM_HEADER_DTYPE.itemsize).from_address(address),
+            dtype=_SHM_HEADER_DTYPE,
+            count=1,
+        )
+        if int(header["version"][0]) != _SHM_VERSION:
+            version = int(header["version"][0])
+            self.close()
+            raise RocketLoggerSharedMemoryError(
+                f"Unsupported data shared memory version {version}."
+            )
+
+        size = int(header["header_size"][0]) + int(header["block_count"][0]) * int(
+            header["block_size"][0]
+        )
+        self._memory = np.frombuffer(
+            (ctypes.c_uint8 * size).from_address(address), dtype=np.uint8
+        )
+        self._memory.flags.writeable = False
+        self._header = self._memory[: _SHM_HEADER_DTYPE.itemsize].view(
+            _SHM_HEADER_DTYPE
+        )
+
+        channel_mask = int(self._header["channel_mask"][0])
+        self.channels = [
+            channel
+            for i, channel in enumerate(_SHM_CHANNELS)
+            if channel_mask & (1 << i)
+        ]
+        self._sequence = int(self._header["write_sequence"][0])
+        self.blocks_lost = 0
+
+    def close(self):
+        """
+        Detach from the data shared memory ring.
+        """
+        self._header = None
+        self._memory = None
+        if self._address is not None:
+            self._libc.shmdt(self._address)
+            self._address = None
+
+    @property
+    def sample_rate(self):
+        """Sample rate of the data in the shared memory ring."""
+        return int(self._header["sample_rate"][0])
+
+    @property
+    def block_length(self):
+        """Maximum number of samples per data block."""
+        return int(self._header["block_length"][0])
+
+    @property
+    def block_count(self):
+        """Number of data blocks in the shared memory ring."""
+        return int(self._header["block_count"][0])
+
+    def read(self, copy=True):
+        """
+        Read the next data block.
+
+        Without copy, the returned channel arrays are mapped from the shared
+        memory and are overwritten by the RocketLogger after about the
+        ring's time span, call :func:`validate` after processing to detect
+        data overwritten during processing.
+
+        :param copy: Whether to copy the data out of the shared memory
+
+        :returns: Dictionary with the block's `sequence` number, sampled
+            buffer `index`, total `samples_lost` by sampling overruns,
+            `sample_rate`, realtime and monotonic timestamps, raw `channels`
+            values by name and raw `digital` values (digital inputs in bits
+            0-5, low range valid flags in bits 6-7, `None` if the digital
+            inputs are disabled), `None` if no new block is available
+
+        :raises RocketLoggerOverrunError: If blocks were overwritten before
+            they were read, the next read continues with the oldest block
+            still available
+
+        :raises RocketLoggerSharedMemoryError: If the measurement stopped and
+            all blocks were read
+        """
+        if self._header is None:
+            raise RocketLoggerSharedMemoryError("Data shared memory not open.")
+
+        # stop state before checking, for the last blocks written before stop
+        stopped = int(self._header["stopped"][0]) != 0
+        block_count = self.block_count
+        write_sequence = int(self._header["write_sequence"][0])
+        available = (write_sequence - self._sequence) & _SHM_SEQUENCE_MASK
+        if available == 0 or available > _SHM_SEQUENCE_MASK // 2:
+            if stopped:
+                raise RocketLoggerSharedMemoryError("Measurement stopped.")
+            return None
+
+        # block overwritten, or its slot is the next to be overwritten
+        if available >= block_count:
+            oldest = (write_sequence - block_count + 1) & _SHM_SEQUENCE_MASK
+            lost = (oldest - self._sequence) & _SHM_SEQUENCE_MASK
+            self.blocks_lost += lost
+            self._sequence = oldest
+            raise RocketLoggerOverrunError(
+                f"Data shared memory overrun, {lost} blocks lost."
+            )
+
+        sequence = self._sequence
+        offset = self._get_block_offset(sequence)
+        block = self._get_block(offset)
+        sample_count = int(block["sample_count"][0])
+        data = {
+            "sequence": sequence,
+            "index": int(block["index"][0]),
+            "samples_lost": int(block["samples_lost"][0]),
+            "sample_rate": self.sample_rate,
+            "timestamp_realtime": _parse_timestamp(block["timestamp_realtime"][0]),
+            "timestamp_monotonic": _parse_timestamp(block["timestamp_monotonic"][0]),
+            "channels": {},
+            "digital": None,
+        }
+
+        # one array of block_length values per stored channel, digital last
+        block_length = self.block_length
+        offset += _SHM_BLOCK_DTYPE.itemsize
+        for channel in self.channels:
+            values = self._memory[offset : offset + 4 * sample_count].view("<i4")
+            data["channels"][channel["name"]] = values.copy() if copy else values
+            offset += 4 * block_length
+        if int(self._header["digital_enable"][0]):
+            values = self._memory[offset : offset + 4 * sample_count].view("<u4")
+            data["digital"] = values.copy() if copy else values
+        self._sequence = (sequence + 1) & _SHM_SEQUENCE_MASK
+
+        # block header or copied data overwritten while reading
+        self.validate(data)
+
+        return data
+
+    def validate(self, data):
+        """
+        Validate a data block was not overwritten since it was read.
+
+        :param data: The data block as returned by :func:`read`
+
+        :raises RocketLoggerOverrunError: If the block was overwritten
+        """
+        block = self._get_block(self._get_block_offset(data["sequence"]))
+        if int(block["sequence"][0]) != data["sequence"]:
+            self.blocks_lost += 1
+            raise RocketLoggerOverrunError(
+                f"Data shared memory block {data['sequence']} overwritten."
+            )
+
+    def _get_block_offset(self, sequence):
+        """
+        Get the offset of the ring slot of a block in the shared memory.
+
+        :param sequence: The sequence of the block
+
+        :returns: The offset of the block header in bytes
+        """
+        slot = sequence % int(self._header["block_count"][0])
+        return int(self._header["header_size"][0]) + slot * int(
+            self._header["block_size"][0]
+        )
+
+    def _get_block(self, offset):
+        """
+        Map the header of a block in the shared memory.
+
+        :param offset: The offset of the block header in bytes
+
+        :returns: The block header mapped from the shared memory
+        """
+        return self._memory[offset : offset + _SHM_BLOCK_DTYPE.itemsize].view(
+            _SHM_BLOCK_DTYPE
+        )
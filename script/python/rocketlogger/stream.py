@@ -0,0 +1,313 @@
+"""
+RocketLogger Data Stream Support.
+
+Client for the measurement data published by the RocketLogger for the web
+interface.
+
+
+Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+"""
+
+import json
+import warnings
+
+import numpy as np
+
+
+ROCKETLOGGER_DATA_SOCKET = "tcp://127.0.0.1:8277"
+"""Default RocketLogger data socket address."""
+
+_STREAM_HEADER_VERSION = 1
+
+_STREAM_METADATA_TOPIC = b"metadata"
+
+_STREAM_LEVELS = ["full", "10k", "1k", "10"]
+
+_STREAM_GROUPS = ["all", "voltage", "current", "ambient", "digital"]
+
+_STREAM_HEADER_DTYPE = np.dtype(
+    [
+        ("header_version", "<u2"),
+        ("header_size", "<u2"),
+        ("metadata_version", "<u4"),
+        ("sequence", "<u8"),
+        ("samples_lost", "<u8"),
+        ("messages_dropped", "<u8"),
+        ("sample_rate", "<u4"),
+        ("layout_hash", "<u4"),
+    ]
+)
+
+
+def _parse_stream_header(frame):
+    """
+    Parse the binary header frame of a data message.
+
+    :param frame: The header frame bytes
+
+    :returns: Dictionary of the header fields
+    """
+    header_version = int(np.frombuffer(frame, dtype="<u2", count=1)[0])
+    if header_version != _STREAM_HEADER_VERSION:
+        raise RocketLoggerStreamError(
+            f"Unsupported data stream header version {header_version}."
+        )
+    values = np.frombuffer(frame, dtype=_STREAM_HEADER_DTYPE, count=1)[0]
+    return {name: int(values[name]) for name in _STREAM_HEADER_DTYPE.names}
+
+
+def _parse_timestamp(values):
+    """
+    Convert a raw RocketLogger timestamp to a numpy datetime.
+
+    :param values: Array of the seconds and nanoseconds of the timestamp
+
+    :returns: The timestamp as numpy datetime64 in nanoseconds
+    """
+    return np.datetime64(int(values[0]) * 1000000000 + int(values[1]), "ns")
+
+
+class RocketLoggerStreamError(IOError):
+    """RocketLogger data stream related errors."""
+
+    pass
+
+
+class RocketLoggerStreamWarning(Warning):
+    """RocketLogger data stream related warnings."""
+
+    pass
+
+
+class RocketLoggerStream:
+    """
+    RocketLogger data stream client.
+
+    Receives the data buffers of a running measurement from the RocketLogger
+    data socket and detects gaps in the stream using the buffer sequence
+    numbers. Gaps are reported as :class:`RocketLoggerStreamWarning`, with
+    the samples lost by sampling overruns and the messages dropped by the
+    publisher, the remaining buffers were lost in transport.
+
+    The data is published per resolution level, all samples (`full`) or
+    min/max/mean envelopes at 10 kHz (`10k`), 1 kHz (`1k`) or 10 Hz (`10`),
+    and channel group (`all`, `voltage`, `current`, `ambient` or `digital`).
+    Only the data of subscribed levels and groups is computed and published.
+
+    Requires the `pyzmq` package for receiving data.
+
+    :param address: The ZeroMQ address of the RocketLogger data socket
+
+    :param level: The resolution level of the data to receive
+
+    :param group: The channel group of the data to receive
+
+    :param context: The ZeroMQ context to use, `None` for the global instance
+    """
+
+    def __init__(
+        self, address=ROCKETLOGGER_DATA_SOCKET, level="1k", group="all", context=None
+    ):
+        if level not in _STREAM_LEVELS:
+            raise ValueError(f"Invalid resolution level '{level}'.")
+        if group not in _STREAM_GROUPS:
+            raise ValueError(f"Invalid channel group '{group}'.")
+
+        self._address = address
+        self._level = level
+        self._group = group
+        self._topic = f"data.{level}.{group}".encode()
+        self._context = context
+        self._socket = None
+        self._metadata = None
+        self._header = None
+        self.gap_count = 0
+        self.buffers_missing = 0
+
+    def __enter__(self):
+        self.connect()
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+    def connect(self):
+        """
+        Connect to the RocketLogger data socket and subscribe to the metadata
+        and the data of the selected resolution level and channel group.
+        """
+        import zmq
+
+        if self._context is None:
+            self._context = zmq.Context.instance()
+        self._socket = self._context.socket(zmq.SUB)
+        self._socket.connect(self._address)
+        self._socket.setsockopt(zmq.SUBSCRIBE, _STREAM_METADATA_TOPIC)
+        self._socket.setsockopt(zmq.SUBSCRIBE, self._topic)
+
+    def close(self):
+        """
+        Close the connection to the RocketLogger data socket.
+        """
+        if self._socket is not None:
+            self._socket.close()
+            self._socket = None
+
+    def receive(self, timeout=None):
+        """
+        Receive the next data buffer.
+
+        Metadata messages and data received before the matching metadata are
+        processed without returning.
+
+        :param timeout: Maximum time to wait for each message in
+            milliseconds, `None` to wait indefinitely
+
+        :returns: The data buffer as returned by :func:`parse`, `None` on
+            timeout
+        """
+        if self._socket is None:
+            raise RocketLoggerStreamError("Data stream not connected.")
+
+        while True:
+            if self._socket.poll(timeout) == 0:
+                return None
+            data = self.parse(self._socket.recv_multipart())
+            if data is not None:
+                return data
+
+    def parse(self, frames):
+        """
+        Parse a message received from the RocketLogger data socket.
+
+        :param frames: List of the message frames, starting with the topic
+
+        :returns: Dictionary with the buffer's `sequence` number,
+            `sample_rate`, published `data_rate`, realtime and monotonic
+            timestamps, `channels` values by name (dictionaries of `min`,
+            `max` and `mean` values for envelopes) and `gap` details (`None`
+            if the buffer directly follows the previous one), or `None` for
+            metadata and data without matching metadata
+        """
+        # metadata is published on change and to each new subscriber
+        topic = bytes(frames[0])
+        if topic == _STREAM_METADATA_TOPIC:
+            self._metadata = json.loads(bytes(frames[1]))
+            return None
+        if topic != self._topic:
+            return None
+
+        frames = frames[1:]
+        header = _parse_stream_header(frames[0])
+        gap = self._check_gap(header)
+
+        # skip data until the metadata of its version was received
+        metadata = self._metadata
+        if (
+            metadata is None
+            or metadata["version"] != header["metadata_version"]
+            or metadata["layout_hash"] != header["layout_hash"]
+        ):
+            return None
+
+        level = metadata["levels"][self._level]
+        timestamps = np.frombuffer(frames[1], dtype="<i8").reshape(2, 2)
+        data = {
+            "sequence": header["sequence"],
+            "sample_rate": header["sample_rate"],
+            "data_rate": level["data_rate"],
+            "timestamp_realtime": _parse_timestamp(timestamps[0]),
+            "timestamp_monotonic": _parse_timestamp(timestamps[1]),
+            "channels": {},
+            "gap": gap,
+        }
+
+        # one frame per non-binary channel of the group, the digital values in
+        # the last
+        frame_index = 2
+        digital = np.frombuffer(frames[-1], dtype="<u4")
+        if level["envelope"]:
+            digital = digital.reshape(2, -1)
+        for channel in metadata["channels"]:
+            if self._group != "all" and channel.get("group") != self._group:
+                continue
+            if channel["unit"] == "binary":
+                values = (digital & (1 << channel["bit"])) > 0
+                if level["envelope"]:
+                    values = {"min": values[0], "max": values[1]}
+                data["channels"][channel["name"]] = values
+                continue
+
+            values = np.frombuffer(frames[frame_index], dtype="<i4")
+            values = values * channel.get("scale", 1)
+            frame_index += 1
+            if level["envelope"] and channel.get("envelope", True):
+                values = values.reshape(3, -1)
+                values = {"min": values[0], "max": values[1], "mean": values[2]}
+            data["channels"][channel["name"]] = values
+
+        return data
+
+    def _check_gap(self, header):
+        """
+        Check the buffer sequence for a gap to the previous data message.
+
+        :param header: The header of the data message
+
+        :returns: Dictionary with the number of missing `buffers`, the
+            `samples_lost` by sampling overruns and the `messages_dropped`
+            by the publisher, `None` if there is no gap
+        """
+        previous = self._header
+        self._header = header
+
+        # sequence restarts with a new measurement
+        if previous is None or header["sequence"] <= previous["sequence"]:
+            return None
+
+        gap = {
+            "buffers": header["sequence"] - previous["sequence"] - 1,
+            "samples_lost": header["samples_lost"] - previous["samples_lost"],
+            "messages_dropped": header["messages_dropped"]
+            - previous["messages_dropped"],
+        }
+        if gap["buffers"] == 0:
+            return None
+
+        self.gap_count += 1
+        self.buffers_missing += gap["buffers"]
+        warnings.warn(
+            RocketLoggerStreamWarning(
+                f"Data stream gap of {gap['buffers']} buffers: "
+                f"{gap['samples_lost']} samples lost by sampling overrun, "
+                f"{gap['messages_dropped']} messages dropped by publisher."
+            )
+        )
+
+        return gap
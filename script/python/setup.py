@@ -71,6 +71,7 @@ setup(
     extras_require={
         "dataframe": ["pandas"],
         "plot": ["matplotlib"],
+        "stream": ["pyzmq"],
         "dev": ["black", "sphinx"],
         "test": ["pytest", "pytest-cov", "tox"],
     },
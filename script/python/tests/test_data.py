@@ -67,6 +67,8 @@ _SPLIT_TEST_FILE = os.path.join(_TEST_FILE_DIR, "test_split.rld")
 _NON_SPLIT_TEST_FILE = os.path.join(_TEST_FILE_DIR, "test_non_split.rld")
 _SPLIT_TRUNCATED_TEST_FILE = os.path.join(_TEST_FILE_DIR, "test_split_truncated.rld")
 _TEMP_FILE = os.path.join(_TEST_FILE_DIR, "temp_data.rld")
+_TEMP_INDEX_FILE = os.path.join(_TEST_FILE_DIR, "temp_data.rli")
+_TEMP_SUMMARY_FILE = os.path.join(_TEST_FILE_DIR, "temp_data.rls")
 
 
 def _file_copy_byte_flipped(file_in, file_out, offset, mask=0xA5):
@@ -77,6 +79,222 @@ def _file_copy_byte_flipped(file_in, file_out, offset, mask=0xA5):
     )
 
 
+def _file_copy_checkpointed(file_in, file_out, header_block_count, offset_error=0):
+    data = np.fromfile(file_in, np.uint8)
+    block_size = int(data[0x08:0x0C].view(np.uint32)[0])
+    block_count = int(data[0x0C:0x10].view(np.uint32)[0])
+    sample_count = int(data[0x10:0x18].view(np.uint64)[0])
+    data[0x0C:0x10] = np.array([header_block_count], np.uint32).view(np.uint8)
+    data[0x10:0x18] = np.array([header_block_count * block_size], np.uint64).view(
+        np.uint8
+    )
+    checkpoint = np.concatenate(
+        [
+            np.array([0x434C5225, block_count], np.uint32).view(np.uint8),
+            np.array([sample_count, data.size + offset_error], np.uint64).view(
+                np.uint8
+            ),
+        ]
+    )
+    np.concatenate([data, checkpoint]).tofile(file_out)
+
+
+def _file_copy_compressed(file_in, file_out):
+    data = np.fromfile(file_in, np.uint8)
+    header_length = int(data[0x06:0x08].view(np.uint16)[0])
+    block_size = int(data[0x08:0x0C].view(np.uint32)[0])
+    block_count = int(data[0x0C:0x10].view(np.uint32)[0])
+    data[0x04:0x06] = np.array([5], np.uint16).view(np.uint8)
+    blocks = data[header_length:].reshape((block_count, -1))
+    column_count = (blocks.shape[1] - 32) // (4 * block_size)
+
+    file_data = [data[:header_length]]
+    for block in blocks:
+        values = block[32:].view(np.uint32).reshape((block_size, column_count)).T
+        deltas = np.diff(values, prepend=values[:, :1]).astype(np.int32)
+        deltas = deltas.astype(np.int64)
+        zigzag = ((deltas << 1) ^ (deltas >> 31)).astype(np.uint32)
+        widths = []
+        payload = []
+        for column in zigzag:
+            for group in np.split(column, range(128, block_size, 128)):
+                width = int(group.max()).bit_length()
+                bits = (group[:, None] >> np.arange(width, dtype=np.uint32)) & 1
+                widths.append(width)
+                payload.append(np.packbits(bits.astype(np.uint8), bitorder="little"))
+        widths = np.array(widths + [0] * (-len(widths) % 4), np.uint8)
+        payload = np.concatenate(payload)
+        payload = np.concatenate([payload, np.zeros(-payload.size % 4, np.uint8)])
+        block_data = np.concatenate(
+            [block[:32], values[:, 0].astype(np.uint32).view(np.uint8), widths, payload]
+        )
+        block_bytes = np.array([4 + block_data.size], np.uint32).view(np.uint8)
+        file_data.extend([block_bytes, block_data])
+    np.concatenate(file_data).tofile(file_out)
+
+
+def _header_set_version(header, file_version):
+    if int(header[0x04:0x06].view(np.uint16)[0]) <= 2:
+        # fix 1 based indexing of valid channel links for file version <= 2
+        channel_offset = 0x38 + int(header[0x30:0x34].view(np.uint32)[0])
+        channels = header[channel_offset:].reshape((-1, 28))
+        links = channels[:, 10:12].copy().view(np.uint16)
+        links[links != 0xFFFF] -= 1
+        channels[:, 10:12] = links.view(np.uint8)
+    header[0x04:0x06] = np.array([file_version], np.uint16).view(np.uint8)
+
+
+def _file_copy_planar(file_in, file_out, column_offset_error=0):
+    data = np.fromfile(file_in, np.uint8)
+    header_length = int(data[0x06:0x08].view(np.uint16)[0])
+    block_size = int(data[0x08:0x0C].view(np.uint32)[0])
+    block_count = int(data[0x0C:0x10].view(np.uint32)[0])
+    blocks = data[header_length:].reshape((block_count, -1))
+    column_count = (blocks.shape[1] - 32) // (4 * block_size)
+    column_offsets = 32 + 4 * block_size * np.arange(column_count, dtype=np.uint32)
+    column_offsets[-1] += column_offset_error
+
+    header = data[:header_length].copy()
+    _header_set_version(header, 6)
+    header[0x06:0x08] = np.array([header_length + 4 * column_count], np.uint16).view(
+        np.uint8
+    )
+    file_data = [header, column_offsets.astype(np.uint32).view(np.uint8)]
+    for block in blocks:
+        values = block[32:].view(np.uint32).reshape((block_size, column_count)).T
+        file_data.extend([block[:32], values.copy().view(np.uint8).reshape(-1)])
+    np.concatenate(file_data).tofile(file_out)
+
+
+def _file_copy_checksum(file_in, file_out):
+    data = np.fromfile(file_in, np.uint8)
+    header_length = int(data[0x06:0x08].view(np.uint16)[0])
+    block_count = int(data[0x0C:0x10].view(np.uint32)[0])
+    file_version = int(data[0x04:0x06].view(np.uint16)[0])
+    if file_version == 5:
+        block_offsets = [header_length]
+        for _ in range(block_count):
+            offset = block_offsets[-1]
+            block_offsets.append(
+                offset + int(data[offset : offset + 4].view(np.uint32)[0])
+            )
+    else:
+        block_bytes = (data.size - header_length) // block_count
+        block_offsets = header_length + block_bytes * np.arange(block_count + 1)
+
+    _header_set_version(data[:header_length], max(file_version, 4) | 0x0100)
+    file_data = [data[:header_length]]
+    for i in range(block_count):
+        block = data[block_offsets[i] : block_offsets[i + 1]].copy()
+        if file_version == 5:
+            block_bytes = np.array([block.size + 4], np.uint32)
+            block[0:4] = block_bytes.view(np.uint8)
+        # the checksums are not verified when reading data files
+        file_data.extend([block, np.array([i], np.uint32).view(np.uint8)])
+    np.concatenate(file_data).tofile(file_out)
+
+
+def _file_write_index(file_in, file_out, start_time_error=0):
+    data = np.fromfile(file_in, np.uint8)
+    file_version = int(data[0x04:0x06].view(np.uint16)[0])
+    header_length = int(data[0x06:0x08].view(np.uint16)[0])
+    block_count = int(data[0x0C:0x10].view(np.uint32)[0])
+    if file_version == 5:
+        offsets = [header_length]
+        for _ in range(block_count - 1):
+            offset = offsets[-1]
+            offsets.append(offset + int(data[offset : offset + 4].view(np.uint32)[0]))
+        offsets = np.array(offsets)
+        timestamp_offsets = offsets + 4
+    else:
+        block_bytes = (data.size - header_length) // block_count
+        offsets = header_length + block_bytes * np.arange(block_count)
+        timestamp_offsets = offsets
+    timestamps = data[timestamp_offsets[:, None] + np.arange(32)].view(np.int64)
+
+    records = np.zeros(block_count, dtype=rld._INDEX_RECORD_DTYPE)
+    records["block_offset"] = offsets
+    records["realtime_sec"] = timestamps[:, 0]
+    records["realtime_ns"] = timestamps[:, 1]
+    records["monotonic_sec"] = timestamps[:, 2]
+    records["monotonic_ns"] = timestamps[:, 3]
+    start_time = data[0x20:0x30].view(np.int64) + [start_time_error, 0]
+    index_header = np.concatenate(
+        [
+            np.array([0x494C5225], np.uint32).view(np.uint8),
+            np.array([1, rld._INDEX_RECORD_DTYPE.itemsize], np.uint16).view(np.uint8),
+            start_time.astype(np.int64).view(np.uint8),
+        ]
+    )
+    np.concatenate([index_header, records.view(np.uint8)]).tofile(file_out)
+
+
+def _file_write_summary(
+    file_in, file_out, bin_size=[10, 100, 1000, 10000], finish=True
+):
+    data = RocketLoggerData(file_in)
+    header = data._header
+    channels = [
+        i
+        for i, channel in enumerate(header["channels"])
+        if not rld._CHANNEL_IS_BINARY[channel["unit_index"]]
+    ]
+    sample_count = header["sample_count"]
+    sample_period = np.timedelta64(1000000000 // header["sample_rate"], "ns")
+    sample_offset = np.arange(sample_count) % header["data_block_size"]
+    sample_time = (
+        np.repeat(data._timestamps_realtime, header["data_block_size"])
+        + sample_offset * sample_period
+    )
+
+    # bins in the order of completion, incomplete bins last
+    bins = []
+    for end in range(bin_size[0], sample_count + 1, bin_size[0]):
+        for level, size in enumerate(bin_size):
+            if end % size == 0:
+                bins.append((level, end - size, size))
+    for level, size in enumerate(bin_size):
+        start = (sample_count // size) * size
+        if finish and start < sample_count:
+            bins.append((level, start, sample_count - start))
+
+    records = np.zeros(len(bins), dtype=rld._get_summary_record_dtype(len(channels)))
+    for i, (level, start, count) in enumerate(bins):
+        timestamp = sample_time[start].astype("datetime64[ns]").astype(np.int64)
+        records[i]["level"] = level
+        records[i]["sample_count"] = count
+        records[i]["timestamp_sec"] = timestamp // 1000000000
+        records[i]["timestamp_ns"] = timestamp % 1000000000
+        for column, index in enumerate(channels):
+            values = data._data[index][start : start + count]
+            records[i]["channel"][column]["min"] = values.min()
+            records[i]["channel"][column]["max"] = values.max()
+            records[i]["channel"][column]["mean"] = values.mean()
+            valid_link = header["channels"][index]["valid_link"]
+            if valid_link != rld._CHANNEL_VALID_UNLINKED:
+                valid = data._data[valid_link][start : start + count]
+                records[i]["channel"][column]["valid"] = valid.mean()
+            else:
+                records[i]["channel"][column]["valid"] = 1
+
+    file_data = np.fromfile(file_in, np.uint8)
+    header_length = header["header_length"]
+    channel_bytes = file_data[header_length - len(channels) * 28 : header_length]
+    summary_header = np.concatenate(
+        [
+            np.array([0x534C5225], np.uint32).view(np.uint8),
+            np.array(
+                [1, records.dtype.itemsize, len(channels), len(bin_size)], np.uint16
+            ).view(np.uint8),
+            np.array([header["sample_rate"]], np.uint32).view(np.uint8),
+            file_data[0x20:0x30],
+            np.array(bin_size, np.uint32).view(np.uint8),
+            channel_bytes,
+        ]
+    )
+    np.concatenate([summary_header, records.view(np.uint8)]).tofile(file_out)
+
+
 class TestDecimation(TestCase):
     def test_binary_decimation(self):
         data_in = np.ones((100))
@@ -355,7 +573,9 @@ class TestJoinFile(TestCase):
 
 class TestJoinMissmatch(TestCase):
     def test_exclude_all(self):
-        with self.assertRaisesRegex(RocketLoggerDataError, "header not matching at field: start_time"):
+        with self.assertRaisesRegex(
+            RocketLoggerDataError, "header not matching at field: start_time"
+        ):
             RocketLoggerData(_NON_SPLIT_TEST_FILE)
 
 
@@ -657,6 +877,388 @@ class TestRecoveryFile(TestCase):
         self.assertEqual(data.get_data("V3").shape, (400, 1))
 
 
+class TestCheckpointFile(TestCase):
+    def test_load(self):
+        _file_copy_checkpointed(_FULL_TEST_FILE, _TEMP_FILE, 1)
+        with self.assertWarnsRegex(RocketLoggerDataWarning, "unfinished file"):
+            data = RocketLoggerData(_TEMP_FILE)
+        self.assertEqual(data._header["data_block_count"], 5)
+        self.assertEqual(data._header["sample_count"], 5000)
+        self.assertEqual(data.get_data("V1").shape, (5000, 1))
+
+    def test_load_matching_header(self):
+        _file_copy_checkpointed(_FULL_TEST_FILE, _TEMP_FILE, 5)
+        data = RocketLoggerData(_TEMP_FILE)
+        self.assertEqual(data._header["data_block_count"], 5)
+        self.assertEqual(data.get_data("V1").shape, (5000, 1))
+
+    def test_header_only(self):
+        _file_copy_checkpointed(_FULL_TEST_FILE, _TEMP_FILE, 1)
+        with self.assertWarnsRegex(RocketLoggerDataWarning, "unfinished file"):
+            data = RocketLoggerData(_TEMP_FILE, header_only=True)
+        self.assertEqual(data._header["data_block_count"], 5)
+        self.assertEqual(data._header["sample_count"], 5000)
+
+    def test_invalid_checkpoint(self):
+        _file_copy_checkpointed(_FULL_TEST_FILE, _TEMP_FILE, 1, offset_error=8)
+        with self.assertRaisesRegex(RocketLoggerDataError, "corrupt data: file size"):
+            RocketLoggerData(_TEMP_FILE)
+
+    def test_invalid_checkpoint_recovery(self):
+        _file_copy_checkpointed(_FULL_TEST_FILE, _TEMP_FILE, 1, offset_error=8)
+        with self.assertWarnsRegex(RocketLoggerDataWarning, "corrupt data: recovered"):
+            data = RocketLoggerData(_TEMP_FILE, recovery=True)
+        self.assertEqual(data._header["data_block_count"], 5)
+        self.assertEqual(data.get_data("V1").shape, (5000, 1))
+
+    @classmethod
+    def tearDownClass(cls):
+        try:
+            os.remove(_TEMP_FILE)
+        except FileNotFoundError:
+            pass
+
+
+class TestCompressedFile(TestCase):
+    def setUp(self):
+        _file_copy_compressed(_FULL_TEST_FILE, _TEMP_FILE)
+
+    def test_load(self):
+        data = RocketLoggerData(_TEMP_FILE)
+        self.assertEqual(data._header["file_version"], 5)
+        self.assertEqual(data.get_data().shape, (5000, 16))
+
+    def test_data_matching(self):
+        data = RocketLoggerData(_TEMP_FILE)
+        data_ref = RocketLoggerData(_FULL_TEST_FILE)
+        self.assertTrue(np.array_equal(data.get_data(), data_ref.get_data()))
+        self.assertTrue(
+            np.array_equal(data.get_time("local"), data_ref.get_time("local"))
+        )
+
+    def test_direct_read(self):
+        data = RocketLoggerData(_TEMP_FILE, memory_mapped=False)
+        data_ref = RocketLoggerData(_FULL_TEST_FILE)
+        self.assertTrue(np.array_equal(data.get_data(), data_ref.get_data()))
+
+    def test_with_decimation(self):
+        data = RocketLoggerData(_TEMP_FILE, decimation_factor=10)
+        data_ref = RocketLoggerData(_FULL_TEST_FILE, decimation_factor=10)
+        self.assertEqual(data.get_data().shape, (500, 16))
+        self.assertTrue(np.array_equal(data.get_data(), data_ref.get_data()))
+
+    def test_checkpoint(self):
+        _file_copy_checkpointed(_TEMP_FILE, _TEMP_FILE, 1)
+        with self.assertWarnsRegex(RocketLoggerDataWarning, "unfinished file"):
+            data = RocketLoggerData(_TEMP_FILE)
+        self.assertEqual(data.get_data("V1").shape, (5000, 1))
+
+    def test_truncated(self):
+        data = np.fromfile(_TEMP_FILE, np.uint8)
+        data[:-8].tofile(_TEMP_FILE)
+        with self.assertRaisesRegex(RocketLoggerDataError, "corrupt data: file size"):
+            RocketLoggerData(_TEMP_FILE)
+
+    def test_truncated_recovery(self):
+        data = np.fromfile(_TEMP_FILE, np.uint8)
+        data[:-8].tofile(_TEMP_FILE)
+        with self.assertWarnsRegex(RocketLoggerDataWarning, "corrupt data: recovered"):
+            data = RocketLoggerData(_TEMP_FILE, recovery=True)
+        self.assertEqual(data._header["data_block_count"], 4)
+        self.assertEqual(data.get_data("V1").shape, (4000, 1))
+
+    @classmethod
+    def tearDownClass(cls):
+        try:
+            os.remove(_TEMP_FILE)
+        except FileNotFoundError:
+            pass
+
+
+class TestPlanarFile(TestCase):
+    def setUp(self):
+        _file_copy_planar(_FULL_TEST_FILE, _TEMP_FILE)
+
+    def test_load(self):
+        data = RocketLoggerData(_TEMP_FILE)
+        self.assertEqual(data._header["file_version"], 6)
+        self.assertEqual(data.get_data().shape, (5000, 16))
+
+    def test_data_matching(self):
+        data = RocketLoggerData(_TEMP_FILE)
+        data_ref = RocketLoggerData(_FULL_TEST_FILE)
+        self.assertTrue(np.array_equal(data.get_data(), data_ref.get_data()))
+        self.assertTrue(
+            np.array_equal(data.get_time("local"), data_ref.get_time("local"))
+        )
+
+    def test_direct_read(self):
+        data = RocketLoggerData(_TEMP_FILE, memory_mapped=False)
+        data_ref = RocketLoggerData(_FULL_TEST_FILE)
+        self.assertTrue(np.array_equal(data.get_data(), data_ref.get_data()))
+
+    def test_with_decimation(self):
+        data = RocketLoggerData(_TEMP_FILE, decimation_factor=10)
+        data_ref = RocketLoggerData(_FULL_TEST_FILE, decimation_factor=10)
+        self.assertEqual(data.get_data().shape, (500, 16))
+        self.assertTrue(np.array_equal(data.get_data(), data_ref.get_data()))
+
+    def test_channel_selection(self):
+        data = RocketLoggerData(_TEMP_FILE, channel_names=["I1L"])
+        data_ref = RocketLoggerData(_FULL_TEST_FILE)
+        self.assertEqual(data.get_channel_names(), ["I1L", "I1L_valid"])
+        self.assertTrue(np.array_equal(data.get_data("I1L"), data_ref.get_data("I1L")))
+        self.assertTrue(
+            np.array_equal(data.get_validity("I1L"), data_ref.get_validity("I1L"))
+        )
+
+    def test_channel_selection_time_range(self):
+        _file_write_index(_TEMP_FILE, _TEMP_INDEX_FILE)
+        timestamps = RocketLoggerData(_FULL_TEST_FILE)._timestamps_realtime
+        start_time = timestamps[1] + np.timedelta64(500, "ms")
+        data = RocketLoggerData(_TEMP_FILE, start_time=start_time, channel_names="V2")
+        data_ref = RocketLoggerData(_FULL_TEST_FILE)
+        self.assertTrue(
+            np.array_equal(data.get_data(), data_ref.get_data("V2")[1000:, :])
+        )
+
+    def test_truncated_recovery(self):
+        data = np.fromfile(_TEMP_FILE, np.uint8)
+        data[:-8].tofile(_TEMP_FILE)
+        with self.assertWarnsRegex(RocketLoggerDataWarning, "corrupt data: recovered"):
+            data = RocketLoggerData(_TEMP_FILE, recovery=True)
+        self.assertEqual(data.get_data("V1").shape, (4000, 1))
+
+    def test_invalid_column_offsets(self):
+        _file_copy_planar(_FULL_TEST_FILE, _TEMP_FILE, column_offset_error=-4)
+        with self.assertRaisesRegex(RocketLoggerFileError, "Invalid data column"):
+            RocketLoggerData(_TEMP_FILE)
+
+    def test_column_offsets_exceeding_block(self):
+        _file_copy_planar(_FULL_TEST_FILE, _TEMP_FILE, column_offset_error=4)
+        with self.assertRaisesRegex(RocketLoggerFileError, "exceed data block"):
+            RocketLoggerData(_TEMP_FILE)
+
+    def tearDown(self):
+        for file_name in [_TEMP_FILE, _TEMP_INDEX_FILE]:
+            try:
+                os.remove(file_name)
+            except FileNotFoundError:
+                pass
+
+
+class TestChecksumFile(TestCase):
+    def setUp(self):
+        _file_copy_checksum(_FULL_TEST_FILE, _TEMP_FILE)
+
+    def test_load(self):
+        data = RocketLoggerData(_TEMP_FILE)
+        self.assertEqual(data._header["file_version"], 4)
+        self.assertTrue(data._header["block_checksum"])
+        self.assertEqual(data.get_data().shape, (5000, 16))
+
+    def test_data_matching(self):
+        data = RocketLoggerData(_TEMP_FILE)
+        data_ref = RocketLoggerData(_FULL_TEST_FILE)
+        self.assertTrue(np.array_equal(data.get_data(), data_ref.get_data()))
+        self.assertTrue(
+            np.array_equal(data.get_time("local"), data_ref.get_time("local"))
+        )
+
+    def test_direct_read(self):
+        data = RocketLoggerData(_TEMP_FILE, memory_mapped=False)
+        data_ref = RocketLoggerData(_FULL_TEST_FILE)
+        self.assertTrue(np.array_equal(data.get_data(), data_ref.get_data()))
+
+    def test_time_range(self):
+        timestamps = RocketLoggerData(_FULL_TEST_FILE)._timestamps_realtime
+        start_time = timestamps[1] + np.timedelta64(500, "ms")
+        data = RocketLoggerData(_TEMP_FILE, start_time=start_time)
+        data_ref = RocketLoggerData(_FULL_TEST_FILE)
+        self.assertTrue(np.array_equal(data.get_data(), data_ref.get_data()[1000:, :]))
+
+    def test_compressed(self):
+        _file_copy_compressed(_FULL_TEST_FILE, _TEMP_FILE)
+        _file_copy_checksum(_TEMP_FILE, _TEMP_FILE)
+        data = RocketLoggerData(_TEMP_FILE)
+        data_ref = RocketLoggerData(_FULL_TEST_FILE)
+        self.assertEqual(data._header["file_version"], 5)
+        self.assertTrue(np.array_equal(data.get_data(), data_ref.get_data()))
+
+    def tearDown(self):
+        try:
+            os.remove(_TEMP_FILE)
+        except FileNotFoundError:
+            pass
+
+
+class TestTimeRange(TestCase):
+    def setUp(self):
+        data = np.fromfile(_FULL_TEST_FILE, np.uint8)
+        data.tofile(_TEMP_FILE)
+        _file_write_index(_TEMP_FILE, _TEMP_INDEX_FILE)
+        self.timestamps = RocketLoggerData(_FULL_TEST_FILE)._timestamps_realtime
+
+    def tearDown(self):
+        for file_name in [_TEMP_FILE, _TEMP_INDEX_FILE]:
+            try:
+                os.remove(file_name)
+            except FileNotFoundError:
+                pass
+
+    def test_index(self):
+        data = RocketLoggerData(_TEMP_FILE, header_only=True)
+        index = data._read_file_index(_TEMP_FILE, data._header)
+        self.assertEqual(len(index), 5)
+
+    def test_start_time(self):
+        start_time = self.timestamps[2] + np.timedelta64(500, "ms")
+        data = RocketLoggerData(_TEMP_FILE, start_time=start_time)
+        self.assertEqual(data._header["data_block_count"], 3)
+        self.assertEqual(data.get_data("V1").shape, (3000, 1))
+        self.assertTrue(np.array_equal(data._timestamps_realtime, self.timestamps[2:]))
+
+    def test_end_time(self):
+        end_time = self.timestamps[2] + np.timedelta64(500, "ms")
+        data = RocketLoggerData(_TEMP_FILE, end_time=end_time)
+        self.assertEqual(data._header["data_block_count"], 3)
+        self.assertTrue(np.array_equal(data._timestamps_realtime, self.timestamps[:3]))
+
+    def test_time_range(self):
+        start_time = self.timestamps[1] + np.timedelta64(500, "ms")
+        end_time = self.timestamps[3] + np.timedelta64(500, "ms")
+        data = RocketLoggerData(_TEMP_FILE, start_time=start_time, end_time=end_time)
+        data_ref = RocketLoggerData(_FULL_TEST_FILE)
+        self.assertEqual(data._header["sample_count"], 3000)
+        self.assertTrue(
+            np.array_equal(data.get_data(), data_ref.get_data()[1000:4000, :])
+        )
+
+    def test_time_range_string(self):
+        start_time = self.timestamps[1] + np.timedelta64(500, "ms")
+        data = RocketLoggerData(_TEMP_FILE, start_time=str(start_time))
+        self.assertEqual(data._header["data_block_count"], 4)
+
+    def test_time_range_without_index(self):
+        os.remove(_TEMP_INDEX_FILE)
+        start_time = self.timestamps[1] + np.timedelta64(500, "ms")
+        end_time = self.timestamps[3] + np.timedelta64(500, "ms")
+        data = RocketLoggerData(_TEMP_FILE, start_time=start_time, end_time=end_time)
+        self.assertEqual(data._header["data_block_count"], 3)
+
+    def test_time_range_mismatching_index(self):
+        _file_write_index(_TEMP_FILE, _TEMP_INDEX_FILE, start_time_error=1)
+        data = RocketLoggerData(_TEMP_FILE, header_only=True)
+        self.assertIsNone(data._read_file_index(_TEMP_FILE, data._header))
+        start_time = self.timestamps[1] + np.timedelta64(500, "ms")
+        data = RocketLoggerData(_TEMP_FILE, start_time=start_time)
+        self.assertEqual(data._header["data_block_count"], 4)
+
+    def test_time_range_compressed(self):
+        _file_copy_compressed(_FULL_TEST_FILE, _TEMP_FILE)
+        _file_write_index(_TEMP_FILE, _TEMP_INDEX_FILE)
+        start_time = self.timestamps[1] + np.timedelta64(500, "ms")
+        end_time = self.timestamps[3] + np.timedelta64(500, "ms")
+        data = RocketLoggerData(_TEMP_FILE, start_time=start_time, end_time=end_time)
+        data_ref = RocketLoggerData(_FULL_TEST_FILE)
+        self.assertTrue(
+            np.array_equal(data.get_data(), data_ref.get_data()[1000:4000, :])
+        )
+
+    def test_time_range_empty(self):
+        start_time = self.timestamps[-1] + np.timedelta64(10, "s")
+        with self.assertRaisesRegex(RocketLoggerDataError, "No data found"):
+            RocketLoggerData(_TEMP_FILE, start_time=start_time)
+
+
+class TestOverview(TestCase):
+    def setUp(self):
+        data = np.fromfile(_FULL_TEST_FILE, np.uint8)
+        data.tofile(_TEMP_FILE)
+        _file_write_summary(_TEMP_FILE, _TEMP_SUMMARY_FILE)
+        self.data = RocketLoggerData(_FULL_TEST_FILE)
+        self.channel_names = ["V1", "V2", "I1L", "I1H"]
+
+    def tearDown(self):
+        for file_name in [_TEMP_FILE, _TEMP_SUMMARY_FILE]:
+            try:
+                os.remove(file_name)
+            except FileNotFoundError:
+                pass
+
+    def check_overview(self, overview, bin_size):
+        values = self.data.get_data(self.channel_names)
+        bin_count = int(np.ceil(values.shape[0] / bin_size))
+        self.assertEqual(overview["time"].shape, (bin_count,))
+        self.assertEqual(overview["min"].shape, (bin_count, 4))
+        for k in [0, bin_count // 2, bin_count - 1]:
+            bin_values = values[k * bin_size : (k + 1) * bin_size]
+            self.assertTrue(np.allclose(overview["min"][k], bin_values.min(axis=0)))
+            self.assertTrue(np.allclose(overview["max"][k], bin_values.max(axis=0)))
+            self.assertTrue(
+                np.allclose(overview["mean"][k], bin_values.mean(axis=0), atol=1e-9)
+            )
+        time_error = overview["time"][0] - self.data._timestamps_realtime[0]
+        self.assertEqual(time_error, np.timedelta64(0, "ns"))
+
+    def test_overview_default(self):
+        data = RocketLoggerData(_TEMP_FILE)
+        self.check_overview(data.get_overview(self.channel_names), 10)
+
+    def test_overview_resolution(self):
+        data = RocketLoggerData(_TEMP_FILE)
+        for resolution, bin_size in [(0.005, 10), (0.1, 100), (0.5, 1000), (2, 10000)]:
+            overview = data.get_overview(self.channel_names, resolution=resolution)
+            self.check_overview(overview, bin_size)
+            self.assertAlmostEqual(overview["duration"][0], min(bin_size, 5000) / 1000)
+
+    def test_overview_resolution_coarsest(self):
+        data = RocketLoggerData(_TEMP_FILE)
+        overview = data.get_overview(self.channel_names, resolution=3600)
+        self.check_overview(overview, 10000)
+
+    def test_overview_all_channels(self):
+        data = RocketLoggerData(_TEMP_FILE)
+        overview = data.get_overview()
+        self.assertEqual(overview["min"].shape[1], 8)
+
+    def test_overview_valid(self):
+        data = RocketLoggerData(_TEMP_FILE)
+        overview = data.get_overview(["I1L", "V1"], resolution=10)
+        valid = self.data.get_validity(["I1L"])
+        self.assertAlmostEqual(overview["valid"][0, 0], valid.mean(), places=6)
+        self.assertEqual(overview["valid"][0, 1], 1)
+
+    def test_overview_header_only(self):
+        data = RocketLoggerData(_TEMP_FILE, header_only=True)
+        self.check_overview(data.get_overview(self.channel_names), 10)
+
+    def test_overview_unfinished(self):
+        _file_write_summary(
+            _TEMP_FILE, _TEMP_SUMMARY_FILE, bin_size=[7, 70, 700, 7000], finish=False
+        )
+        data = RocketLoggerData(_TEMP_FILE)
+        overview = data.get_overview(self.channel_names, resolution=0.07)
+        self.assertEqual(overview["time"].shape, (5000 // 70,))
+
+    def test_overview_unknown_channel(self):
+        data = RocketLoggerData(_TEMP_FILE)
+        with self.assertRaisesRegex(KeyError, "not found in summary"):
+            data.get_overview(["DI1"])
+
+    def test_overview_no_summary(self):
+        os.remove(_TEMP_SUMMARY_FILE)
+        data = RocketLoggerData(_TEMP_FILE)
+        with self.assertRaisesRegex(RocketLoggerFileError, "does not exist"):
+            data.get_overview()
+
+    def test_overview_mismatching_summary(self):
+        _file_write_summary(_STEPS_TEST_FILE, _TEMP_SUMMARY_FILE)
+        data = RocketLoggerData(_TEMP_FILE)
+        with self.assertRaisesRegex(RocketLoggerFileError, "not matching"):
+            data.get_overview()
+
+
 class TestRecoverySplitFile(TestCase):
     def test_no_recovery(self):
         with self.assertRaisesRegex(RocketLoggerDataError, "corrupt data: file size"):
@@ -897,6 +1499,19 @@ class TestChannelHandling(TestCase):
         with self.assertRaisesRegex(KeyError, "not found"):
             self.data.remove_channel("A")
 
+    def test_load_channel_selection(self):
+        data = RocketLoggerData(_FULL_TEST_FILE, channel_names=["V1", "I2L"])
+        self.assertEqual(data.get_channel_names(), ["I2L", "I2L_valid", "V1"])
+        self.assertEqual(data._header["channels"][2]["valid_link"], 0)
+        self.assertTrue(np.array_equal(data.get_data("V1"), self.data.get_data("V1")))
+        self.assertTrue(
+            np.array_equal(data.get_validity("I2L"), self.data.get_validity("I2L"))
+        )
+
+    def test_load_channel_selection_inexistent(self):
+        with self.assertRaisesRegex(KeyError, "not found"):
+            RocketLoggerData(_FULL_TEST_FILE, channel_names=["A"])
+
 
 class TestChannelMerge(TestCase):
     def test_channel_names(self):
@@ -1156,7 +1771,7 @@ class TestDataHandling(TestCase):
         temp = self.data.get_time(time_reference="local")
         dtemp = np.diff(temp).mean()
         dt = (
-            np.timedelta64(10 ** 9, "ns")
+            np.timedelta64(10**9, "ns")
             / _ROCKETLOGGER_ADC_CLOCK_SCALE
             / self.data.get_header()["sample_rate"]
         )
@@ -1166,7 +1781,7 @@ class TestDataHandling(TestCase):
         temp = self.data.get_time(time_reference="network")
         dtemp = np.diff(temp).mean()
         dt = (
-            np.timedelta64(10 ** 9, "ns")
+            np.timedelta64(10**9, "ns")
             / _ROCKETLOGGER_ADC_CLOCK_SCALE
             / self.data.get_header()["sample_rate"]
         )
@@ -0,0 +1,197 @@
+"""
+RocketLogger shared memory data reader tests.
+
+
+
+Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+"""
+
+import json
+from unittest import TestCase
+
+import ctypes
+import os
+from unittest import TestCase
+
+import numpy as np
+
+from rocketlogger.shm import (
+    RocketLoggerDataReader,
+    RocketLoggerOverrunError,
+    RocketLoggerSharedMemoryError,
+    _SHM_BLOCK_DTYPE,
+    _SHM_HEADER_DTYPE,
+    _load_libc,
+)
+
+
+_IPC_CREAT = 0o1000
+_IPC_RMID = 0
+_BLOCK_COUNT = 4
+_BLOCK_LENGTH = 16
+_CHANNEL_MASK = 0x11  # V1 and I1L
+_SEQUENCE_INVALID = 0xFFFFFFFF
+_BLOCK_SIZE = _SHM_BLOCK_DTYPE.itemsize + 3 * 4 * _BLOCK_LENGTH
+_SIZE = _SHM_HEADER_DTYPE.itemsize + _BLOCK_COUNT * _BLOCK_SIZE
+
+
+class _RingWriter:
+    """Data shared memory ring writer mirroring the RocketLogger's."""
+
+    def __init__(self, key):
+        self._libc = _load_libc()
+        self._libc.shmctl.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.c_void_p]
+        self._id = self._libc.shmget(key, _SIZE, _IPC_CREAT | 0o600)
+        if self._id < 0:
+            raise OSError(ctypes.get_errno(), "shmget failed")
+        self._address = self._libc.shmat(self._id, None, 0)
+        self.memory = np.frombuffer(
+            (ctypes.c_uint8 * _SIZE).from_address(self._address), dtype=np.uint8
+        )
+        self.header = self.memory[: _SHM_HEADER_DTYPE.itemsize].view(_SHM_HEADER_DTYPE)
+        self.header["version"] = 1
+        self.header["header_size"] = _SHM_HEADER_DTYPE.itemsize
+        self.header["block_count"] = _BLOCK_COUNT
+        self.header["block_size"] = _BLOCK_SIZE
+        self.header["block_length"] = _BLOCK_LENGTH
+        self.header["sample_rate"] = 1000
+        self.header["update_rate"] = 10
+        self.header["channel_mask"] = _CHANNEL_MASK
+        self.header["digital_enable"] = 1
+        self.header["write_sequence"] = 0
+        self.header["stopped"] = 0
+        for slot in range(_BLOCK_COUNT):
+            self.block(slot)["sequence"] = _SEQUENCE_INVALID
+
+    def block(self, sequence):
+        offset = _SHM_HEADER_DTYPE.itemsize + (sequence % _BLOCK_COUNT) * _BLOCK_SIZE
+        return self.memory[offset : offset + _SHM_BLOCK_DTYPE.itemsize].view(
+            _SHM_BLOCK_DTYPE
+        )
+
+    def write(self, sample_count=_BLOCK_LENGTH):
+        sequence = int(self.header["write_sequence"][0])
+        block = self.block(sequence)
+        block["sequence"] = _SEQUENCE_INVALID
+        block["sample_count"] = sample_count
+        block["index"] = sequence
+        block["samples_lost"] = 0
+        block["timestamp_realtime"] = [1600000000, sequence]
+        block["timestamp_monotonic"] = [100, sequence]
+        offset = _SHM_HEADER_DTYPE.itemsize + (sequence % _BLOCK_COUNT) * _BLOCK_SIZE
+        values = self.memory[offset + _SHM_BLOCK_DTYPE.itemsize :][
+            : 3 * 4 * _BLOCK_LENGTH
+        ].view("<u4")
+        values[:] = sequence
+        block["sequence"] = sequence
+        self.header["write_sequence"] = (sequence + 1) & 0xFFFFFFFF
+
+    def close(self):
+        self._libc.shmdt(self._address)
+        self._libc.shmctl(self._id, _IPC_RMID, None)
+
+
+class TestSharedMemory(TestCase):
+    def setUp(self):
+        self.key = 0x524C0000 | (os.getpid() & 0xFFFF)
+        self.writer = _RingWriter(self.key)
+        self.reader = RocketLoggerDataReader(self.key)
+        self.reader.open()
+
+    def tearDown(self):
+        self.reader.close()
+        self.writer.close()
+
+    def test_layout(self):
+        self.assertEqual(self.reader.sample_rate, 1000)
+        self.assertEqual(self.reader.block_length, _BLOCK_LENGTH)
+        self.assertEqual(self.reader.block_count, _BLOCK_COUNT)
+        self.assertEqual([c["name"] for c in self.reader.channels], ["V1", "I1L"])
+
+    def test_empty(self):
+        self.assertIsNone(self.reader.read())
+
+    def test_sequential(self):
+        for sequence in range(10):
+            self.writer.write()
+            data = self.reader.read()
+            self.assertEqual(data["sequence"], sequence)
+            self.assertEqual(
+                data["timestamp_monotonic"],
+                np.datetime64(100000000000 + sequence, "ns"),
+            )
+            self.assertTrue((data["channels"]["I1L"] == sequence).all())
+            self.assertTrue((data["digital"] == sequence).all())
+        self.assertIsNone(self.reader.read())
+        self.assertEqual(self.reader.blocks_lost, 0)
+
+    def test_partial_block(self):
+        self.writer.write(sample_count=5)
+        data = self.reader.read()
+        self.assertEqual(len(data["channels"]["V1"]), 5)
+        self.assertEqual(len(data["digital"]), 5)
+
+    def test_overrun(self):
+        for _ in range(6):
+            self.writer.write()
+        with self.assertRaises(RocketLoggerOverrunError):
+            self.reader.read()
+        self.assertEqual(self.reader.blocks_lost, 3)
+
+        # resume with the oldest block still available
+        self.assertEqual(self.reader.read()["sequence"], 3)
+
+    def test_overwrite_while_processing(self):
+        self.writer.write()
+        data = self.reader.read(copy=False)
+        self.reader.validate(data)
+        for _ in range(_BLOCK_COUNT):
+            self.writer.write()
+        self.assertTrue((data["channels"]["V1"] == _BLOCK_COUNT).all())
+        with self.assertRaises(RocketLoggerOverrunError):
+            self.reader.validate(data)
+
+    def test_stopped(self):
+        self.writer.write()
+        self.writer.header["stopped"] = 1
+        self.assertEqual(self.reader.read()["sequence"], 0)
+        with self.assertRaises(RocketLoggerSharedMemoryError):
+            self.reader.read()
+
+    def test_sequence_wrap(self):
+        self.writer.header["write_sequence"] = 0xFFFFFFFE
+        self.reader.close()
+        self.reader.open()
+        for sequence in [0xFFFFFFFE, 0xFFFFFFFF, 0]:
+            self.writer.write()
+            self.assertEqual(self.reader.read()["sequence"], sequence)
+
+    def test_not_running(self):
+        with self.assertRaises(RocketLoggerSharedMemoryError):
+            RocketLoggerDataReader(self.key + 1).open()
@@ -0,0 +1,183 @@
+"""
+RocketLogger data stream tests.
+
+
+Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+"""
+
+import json
+from unittest import TestCase
+import warnings
+
+import numpy as np
+
+from rocketlogger.stream import (
+    RocketLoggerStream,
+    RocketLoggerStreamError,
+    RocketLoggerStreamWarning,
+    _STREAM_HEADER_DTYPE,
+)
+
+
+_METADATA = {
+    "version": 7,
+    "layout_hash": 0x12345678,
+    "sample_rate": 1000,
+    "web_level": "1k",
+    "levels": {
+        "full": {"data_rate": 1000, "envelope": False},
+        "10k": {"data_rate": 1000, "envelope": True},
+        "1k": {"data_rate": 1000, "envelope": True},
+        "10": {"data_rate": 100, "envelope": True},
+    },
+    "channels": [
+        {"name": "V1", "group": "voltage", "unit": "V", "scale": 1e-8},
+        {
+            "name": "T",
+            "group": "ambient",
+            "unit": "K",
+            "scale": 1e-2,
+            "envelope": False,
+        },
+        {"name": "DI1", "group": "digital", "unit": "binary", "bit": 0},
+    ],
+}
+
+
+def _data_message(
+    sequence, samples_lost=0, messages_dropped=0, version=7, topic=b"data.10.all"
+):
+    header = np.zeros(1, dtype=_STREAM_HEADER_DTYPE)
+    header["header_version"] = 1
+    header["header_size"] = _STREAM_HEADER_DTYPE.itemsize
+    header["metadata_version"] = version
+    header["sequence"] = sequence
+    header["samples_lost"] = samples_lost
+    header["messages_dropped"] = messages_dropped
+    header["sample_rate"] = _METADATA["sample_rate"]
+    header["layout_hash"] = _METADATA["layout_hash"]
+
+    timestamps = np.array([1600000000, 500, 100, 0], dtype="<i8")
+    envelope = np.repeat(np.array([-100, 100, 10], dtype="<i4"), 10)
+    sensor = np.array([2500], dtype="<i4")
+    digital = np.repeat(np.array([0x00, 0x01], dtype="<u4"), 10)
+
+    return [
+        topic,
+        header.tobytes(),
+        timestamps.tobytes(),
+        envelope.tobytes(),
+        sensor.tobytes(),
+        digital.tobytes(),
+    ]
+
+
+class TestStream(TestCase):
+    def setUp(self):
+        self.stream = RocketLoggerStream(level="10")
+        metadata = json.dumps(_METADATA).encode()
+        self.assertIsNone(self.stream.parse([b"metadata", metadata]))
+
+    def test_data(self):
+        data = self.stream.parse(_data_message(0))
+        self.assertEqual(data["sequence"], 0)
+        self.assertEqual(data["data_rate"], 100)
+        self.assertEqual(
+            data["timestamp_realtime"], np.datetime64(1600000000000000500, "ns")
+        )
+        self.assertIsNone(data["gap"])
+
+    def test_envelope(self):
+        data = self.stream.parse(_data_message(0))
+        v1 = data["channels"]["V1"]
+        self.assertEqual(len(v1["mean"]), 10)
+        self.assertAlmostEqual(v1["min"][0], -1e-6)
+        self.assertAlmostEqual(v1["max"][0], 1e-6)
+        self.assertAlmostEqual(v1["mean"][0], 1e-7)
+
+    def test_no_envelope(self):
+        data = self.stream.parse(_data_message(0))
+        self.assertAlmostEqual(data["channels"]["T"][0], 25)
+
+    def test_digital(self):
+        data = self.stream.parse(_data_message(0))
+        self.assertFalse(data["channels"]["DI1"]["min"].any())
+        self.assertTrue(data["channels"]["DI1"]["max"].all())
+
+    def test_group(self):
+        stream = RocketLoggerStream(level="10", group="voltage")
+        stream.parse([b"metadata", json.dumps(_METADATA).encode()])
+        message = _data_message(0, topic=b"data.10.voltage")
+        data = stream.parse(message[:4] + [b""])
+        self.assertEqual(list(data["channels"]), ["V1"])
+
+    def test_other_topic(self):
+        message = _data_message(0, topic=b"data.1k.all")
+        self.assertIsNone(self.stream.parse(message))
+
+    def test_invalid_level(self):
+        with self.assertRaises(ValueError):
+            RocketLoggerStream(level="100")
+
+    def test_unknown_metadata(self):
+        self.assertIsNone(self.stream.parse(_data_message(0, version=8)))
+
+    def test_unsupported_header(self):
+        message = _data_message(0)
+        message[1] = b"\x02" + message[1][1:]
+        with self.assertRaises(RocketLoggerStreamError):
+            self.stream.parse(message)
+
+    def test_not_connected(self):
+        with self.assertRaises(RocketLoggerStreamError):
+            self.stream.receive()
+
+    def test_continuous(self):
+        with warnings.catch_warnings():
+            warnings.simplefilter("error")
+            for sequence in range(10):
+                self.stream.parse(_data_message(sequence))
+        self.assertEqual(self.stream.gap_count, 0)
+
+    def test_gap(self):
+        self.stream.parse(_data_message(10, 100, 1))
+        with self.assertWarns(RocketLoggerStreamWarning):
+            data = self.stream.parse(_data_message(14, 200, 2))
+        self.assertEqual(data["gap"]["buffers"], 3)
+        self.assertEqual(data["gap"]["samples_lost"], 100)
+        self.assertEqual(data["gap"]["messages_dropped"], 1)
+        self.assertEqual(self.stream.gap_count, 1)
+        self.assertEqual(self.stream.buffers_missing, 3)
+
+    def test_new_measurement(self):
+        self.stream.parse(_data_message(100))
+        with warnings.catch_warnings():
+            warnings.simplefilter("error")
+            self.stream.parse(_data_message(0))
+        self.assertEqual(self.stream.gap_count, 0)
@@ -143,6 +143,19 @@ app.get('/data/download/:filename', async (request, reply) => {
     }
 });
 
+app.get('/data/overview/:filename', async (request, reply) => {
+    const filename = request.params.filename;
+    const resolution = request.query.resolution ? Number(request.query.resolution) : null;
+    try {
+        await rl_files.validate_data_file(filename);
+        const overview = await rl_files.get_data_file_overview(filename, resolution);
+        reply.json(overview);
+    }
+    catch (err) {
+        reply.status(400).send(`Error accessing data file overview ${filename}: ${err}`);
+    }
+});
+
 app.get('/data/delete/:filename', async (request, reply) => {
     const filename = request.params.filename;
     try {
@@ -17,11 +17,19 @@ const data_socket = 'tcp://127.0.0.1:8277';
 /// RocketLogger maximum web downstream data rate [in 1/s]
 const web_data_rate = 1000;
 
+/// Topic of the data stream metadata messages
+const metadata_topic = 'metadata';
+
+/// Supported data message header format version
+const data_header_version = 1;
+
 
 class Subscriber {
-    constructor(socketAddress) {
+    constructor(socketAddress, topics = []) {
         this._onUpdate = null;
+        this._socket = null;
         this._socketAddress = socketAddress;
+        this._topics = topics;
         this._debug = debug('rocketlogger:data');
     }
 
@@ -35,7 +43,7 @@ class Subscriber {
     async run() {
         this._socket = new zmq.Subscriber();
         this._socket.connect(this._socketAddress);
-        this._socket.subscribe();
+        this._socket.subscribe(...this._topics);
 
         for await (const raw of this._socket) {
             // this._debug(`subscriber new data: ${raw}`);
@@ -45,7 +53,8 @@ class Subscriber {
             } catch (err) {
                 this._debug(`subscriber parse error: ${err}`);
             }
-            if (this._onUpdate !== null) {
+            // skip messages without update, e.g. data stream metadata
+            if (data !== null && this._onUpdate !== null) {
                 this._onUpdate(data);
             }
         }
@@ -68,21 +77,110 @@ class StatusSubscriber extends Subscriber {
 
 class DataSubscriber extends Subscriber {
     constructor(socketAddress = data_socket) {
-        super(socketAddress);
+        super(socketAddress, [metadata_topic]);
+        this._metadata = null;
+        this._topic = null;
+        this._header = null;
+        this.gap_count = 0;
+        this.buffers_missing = 0;
     }
 
-    _parse(raw) { return parse_data_to_message(raw); }
+    _parse(raw) {
+        // metadata is published on change and to each new subscriber
+        if (raw[0].toString() === metadata_topic) {
+            const metadata = JSON.parse(raw[1]);
+            this._metadata = { ...metadata, ...metadata.levels[metadata.web_level] };
+            this._subscribe_data(`data.${metadata.web_level}.all`);
+            return null;
+        }
+
+        // data messages consist of the topic and the data frames
+        const data = raw.slice(1);
+        const header = parse_stream_header(data[0]);
+        this._check_gap(header);
+
+        // skip data until the metadata of its version was received
+        if (this._metadata === null ||
+            this._metadata.version !== header.metadata_version ||
+            this._metadata.layout_hash !== header.layout_hash) {
+            return null;
+        }
+
+        return parse_data_to_message(this._metadata, data);
+    }
+
+    _subscribe_data(topic) {
+        // only data of the resolution level plotted is computed and published
+        if (topic === this._topic) {
+            return;
+        }
+        if (this._socket !== null) {
+            if (this._topic !== null) {
+                this._socket.unsubscribe(this._topic);
+            }
+            this._socket.subscribe(topic);
+        }
+        this._topic = topic;
+    }
+
+    _check_gap(header) {
+        const previous = this._header;
+        this._header = header;
+
+        // sequence restarts with a new measurement
+        if (previous === null || header.sequence <= previous.sequence) {
+            return null;
+        }
+
+        const gap = {
+            buffers: header.sequence - previous.sequence - 1,
+            samples_lost: header.samples_lost - previous.samples_lost,
+            messages_dropped: header.messages_dropped - previous.messages_dropped,
+        };
+        if (gap.buffers === 0) {
+            return null;
+        }
+
+        // buffers not lost by overruns or dropped by the publisher are lost
+        // in transport, e.g. if the subscriber cannot keep up
+        this.gap_count += 1;
+        this.buffers_missing += gap.buffers;
+        this._debug(`data stream gap of ${gap.buffers} buffers: ` +
+            `${gap.samples_lost} samples lost by sampling overrun, ` +
+            `${gap.messages_dropped} messages dropped by publisher`);
+
+        return gap;
+    }
 }
 
 
-function parse_data_to_message(data) {
+function parse_stream_header(data) {
+    const header = {
+        header_version: data.readUInt16LE(0),
+        header_size: data.readUInt16LE(2),
+    };
+    if (header.header_version !== data_header_version) {
+        throw Error(`unsupported data header version ${header.header_version}`);
+    }
+
+    header.metadata_version = data.readUInt32LE(4);
+    header.sequence = Number(data.readBigUInt64LE(8));
+    header.samples_lost = Number(data.readBigUInt64LE(16));
+    header.messages_dropped = Number(data.readBigUInt64LE(24));
+    header.sample_rate = data.readUInt32LE(32);
+    header.layout_hash = data.readUInt32LE(36);
+
+    return header;
+}
+
+function parse_data_to_message(stream_metadata, data) {
     const message = {
         metadata: {},
         data: {},
         digital: null,
     };
 
-    const header = parse_data_header(data);
+    const header = parse_data_header(stream_metadata, data);
 
     for (const metadata of header.channels) {
         message.metadata[metadata.name] = metadata;
@@ -108,15 +206,20 @@ function parse_data_to_message(data) {
     return message;
 }
 
-function parse_data_header(data) {
-    const header = JSON.parse(data[0]);
+function parse_data_header(stream_metadata, data) {
+    const header = { ...stream_metadata };
 
     header.downsample_factor = Math.max(1, header.data_rate / web_data_rate);
 
-    // find maximum sample count in channel data message parts
+    // find maximum sample count in channel data message parts, envelopes
+    // consist of min, max and mean values and AND and OR values for digital
     header.sample_count = 1;
     for (let i = 3; i < data.length; i++) {
-        const sample_count = data[i].buffer.byteLength / Uint32Array.BYTES_PER_ELEMENT;
+        let values_per_sample = 1;
+        if (header.envelope) {
+            values_per_sample = (i === data.length - 1) ? 2 : 3;
+        }
+        const sample_count = data[i].buffer.byteLength / Uint32Array.BYTES_PER_ELEMENT / values_per_sample;
         if (sample_count > header.sample_count) {
             header.sample_count = sample_count;
         }
@@ -132,24 +235,27 @@ function parse_time_data(header, data) {
     const data_out = new Float64Array(data_out_length);
     for (let j = 0; j < data_out_length; j++) {
         data_out[j] = Number(time_in_view[0]) * 1e3 + Number(time_in_view[1]) / 1e6
-            + j * 1e3 / web_data_rate;
+            + j * 1e3 * header.downsample_factor / header.data_rate;
     }
 
     return data_out;
 }
 function parse_digital_data(header, data) {
+    // envelopes consist of the AND values followed by the OR values
     const data_in_view = new Uint32Array(data.buffer);
-    const data_out_length = Math.min(data_in_view.length, Math.ceil(header.sample_count / header.downsample_factor));
-    const data_resample_factor = Math.floor(data_in_view.length / data_out_length);
+    const data_in_length = header.envelope ? data_in_view.length / 2 : data_in_view.length;
+    const data_in_min = data_in_view.subarray(0, data_in_length);
+    const data_in_max = header.envelope ? data_in_view.subarray(data_in_length) : data_in_min;
+    const data_out_length = Math.min(data_in_length, Math.ceil(header.sample_count / header.downsample_factor));
+    const data_resample_factor = Math.floor(data_in_length / data_out_length);
 
     const data_out = new Uint16Array(data_out_length);
     for (let j = 0, offset_in = 0; j < data_out.length; j++) {
         let min = 0xff;
         let max = 0x00;
         for (let k = 0; k < data_resample_factor; k++, offset_in++) {
-            const value = data_in_view[offset_in];
-            min &= value;
-            max |= value;
+            min &= data_in_min[offset_in];
+            max |= data_in_max[offset_in];
         }
         data_out[j] = max << 8 | min;
     }
@@ -162,7 +268,11 @@ function parse_channel_data(header, metadata, data) {
         throw Error('cannot parse binary as non-binary data');
     }
 
-    const data_in_view = new Int32Array(data.buffer);
+    // envelopes consist of the min, max and mean values, plot the mean values
+    let data_in_view = new Int32Array(data.buffer);
+    if (header.envelope && metadata.envelope !== false) {
+        data_in_view = data_in_view.subarray(2 * data_in_view.length / 3);
+    }
     const data_out_length = Math.min(data_in_view.length, Math.ceil(header.sample_count / header.downsample_factor));
     const data_resample_factor = Math.floor(data_in_view.length / data_out_length);
 
@@ -5,9 +5,10 @@ import fs from 'fs/promises';
 import path from 'path';
 import picomatch from 'picomatch';
 
+import { get_summary_path, read_summary_overview } from './rl.summary.js';
 import { bytes_to_string, date_to_string } from './util.js';
 
-export { delete_data_file, filter_data_filename, get_data_path, get_data_file_info, get_log_path, validate_data_file };
+export { delete_data_file, filter_data_filename, get_data_path, get_data_file_info, get_data_file_overview, get_log_path, validate_data_file };
 
 
 /// RocketLogger measurement data path
@@ -45,6 +46,10 @@ function get_log_path() {
     return path_system_logfile;
 }
 
+async function get_data_file_overview(filename, resolution = null) {
+    return read_summary_overview(get_summary_path(get_data_path(filename)), resolution);
+}
+
 
 // data file info helper functions
 async function get_data_file_info() {
@@ -54,7 +59,7 @@ async function get_data_file_info() {
 }
 
 async function get_data_files() {
-    const is_data_file = picomatch('*.@(rld|csv)');
+    const is_data_file = picomatch('*.@(rld|csv|arrow)');
     const dir_files = await fs.readdir(path_data);
     const data_files = dir_files.filter(f => is_data_file(f));
     return data_files.map(f => path.join(path_data, f));
@@ -0,0 +1,236 @@
+"use strict";
+
+// imports
+import fs from 'fs/promises';
+import path from 'path';
+
+export { get_summary_path, read_summary_overview };
+
+
+/// Measurement summary file magic constant (ASCII %RLS)
+const summary_magic = 0x534C5225;
+
+/// Supported measurement summary file version
+const summary_version = 1;
+
+/// Measurement summary file extension
+const summary_extension = '.rls';
+
+/// Size of the summary header before the bin sizes [in bytes]
+const summary_header_length = 32;
+
+/// Size of a channel definition [in bytes]
+const summary_channel_length = 28;
+
+/// Size of the summary record fields before the channel summaries [in bytes]
+const summary_record_header_length = 24;
+
+/// Size of a channel summary within a summary record [in bytes]
+const summary_record_channel_length = 16;
+
+/// Maximum number of overview bins returned
+const overview_bin_count_max = 10000;
+
+/// Channel units by unit index, as used for the live data
+const channel_units = { 1: 'V', 2: 'A', 10: 's' };
+
+
+// measurement summary file helper functions
+function get_summary_path(data_path) {
+    const parsed = path.parse(data_path);
+    return path.join(parsed.dir, parsed.name + summary_extension);
+}
+
+async function read_summary_overview(summary_path, resolution = null) {
+    const file = await fs.open(summary_path, 'r');
+    try {
+        const summary = await read_summary_header(file);
+        const level = select_summary_level(summary, resolution);
+        const records = await read_summary_level(file, summary, level);
+        return summary_records_to_overview(summary, level, records);
+    } finally {
+        await file.close();
+    }
+}
+
+async function read_summary_header(file) {
+    const header = Buffer.alloc(summary_header_length);
+    await file.read(header, 0, summary_header_length, 0);
+    if (header.readUInt32LE(0) !== summary_magic || header.readUInt16LE(4) !== summary_version) {
+        throw Error('unsupported measurement summary file');
+    }
+
+    const summary = {
+        record_length: header.readUInt16LE(6),
+        channel_count: header.readUInt16LE(8),
+        level_count: header.readUInt16LE(10),
+        sample_rate: header.readUInt32LE(12),
+        start_time: Number(header.readBigInt64LE(16)) * 1e3 + Number(header.readBigInt64LE(24)) / 1e6,
+        bin_size: [],
+        channels: [],
+    };
+    if (summary.record_length !== summary_record_header_length + summary.channel_count * summary_record_channel_length) {
+        throw Error('invalid measurement summary record length');
+    }
+
+    // bin sizes and summarized channel definitions
+    const definitions_length = summary.level_count * Uint32Array.BYTES_PER_ELEMENT +
+        summary.channel_count * summary_channel_length;
+    const definitions = Buffer.alloc(definitions_length);
+    await file.read(definitions, 0, definitions_length, summary_header_length);
+    for (let i = 0; i < summary.level_count; i++) {
+        summary.bin_size.push(definitions.readUInt32LE(i * Uint32Array.BYTES_PER_ELEMENT));
+    }
+    for (let i = 0; i < summary.channel_count; i++) {
+        const offset = summary.level_count * Uint32Array.BYTES_PER_ELEMENT + i * summary_channel_length;
+        const name = definitions.toString('ascii', offset + 12, offset + summary_channel_length);
+        summary.channels.push({
+            name: name.split('\0')[0],
+            unit: channel_units[definitions.readUInt32LE(offset)] ?? '',
+            scale: definitions.readInt32LE(offset + 4),
+        });
+    }
+    summary.records_offset = summary_header_length + definitions_length;
+
+    // incomplete bins are stored last, ordered by level, when the measurement finished
+    const file_stat = await file.stat();
+    const record_count = Math.floor((file_stat.size - summary.records_offset) / summary.record_length);
+    summary.bin_incomplete = {};
+    const record_header = Buffer.alloc(Uint32Array.BYTES_PER_ELEMENT * 2);
+    for (let position = record_count - 1; position >= Math.max(0, record_count - summary.level_count); position--) {
+        await file.read(record_header, 0, record_header.length, summary.records_offset + position * summary.record_length);
+        const level = record_header.readUInt32LE(0);
+        if (level >= summary.level_count || level in summary.bin_incomplete ||
+            record_header.readUInt32LE(4) >= summary.bin_size[level]) {
+            break;
+        }
+        summary.bin_incomplete[level] = position;
+    }
+
+    // complete bins are stored right after the last bin of the finer levels they aggregate
+    summary.bin_ratio = summary.bin_size.map(size => size / summary.bin_size[0]);
+    summary.bin_count = get_summary_bin_counts(summary.bin_ratio,
+        record_count - Object.keys(summary.bin_incomplete).length);
+
+    return summary;
+}
+
+function get_summary_bin_counts(bin_ratio, bin_count) {
+    const stored_bins = count => bin_ratio.reduce((sum, ratio) => sum + Math.floor(count / ratio), 0);
+
+    // largest number of finest bins with all completed bins stored
+    let low = 0;
+    let high = bin_count;
+    while (low < high) {
+        const middle = Math.floor((low + high + 1) / 2);
+        if (stored_bins(middle) <= bin_count) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return bin_ratio.map(ratio => Math.floor(low / ratio));
+}
+
+function get_summary_bin_position(bin_ratio, level, bin_index) {
+    // number of finest bins completed when the bin is stored
+    const finest_bins = (bin_index + 1) * bin_ratio[level];
+
+    // bins of coarser levels completed at the same time are stored after it
+    let position = -1;
+    for (let lvl = 0; lvl < bin_ratio.length; lvl++) {
+        if (lvl <= level) {
+            position += Math.floor(finest_bins / bin_ratio[lvl]);
+        } else {
+            position += Math.floor((finest_bins - 1) / bin_ratio[lvl]);
+        }
+    }
+    return position;
+}
+
+function select_summary_level(summary, resolution) {
+    // finest level with bin duration of at least the resolution, limited in number of bins
+    for (let level = 0; level < summary.level_count; level++) {
+        const bin_count = summary.bin_count[level] + (level in summary.bin_incomplete ? 1 : 0);
+        const bin_duration = summary.bin_size[level] / summary.sample_rate;
+        if (bin_count <= overview_bin_count_max && (resolution === null || bin_duration >= resolution)) {
+            return level;
+        }
+    }
+    return summary.level_count - 1;
+}
+
+async function read_summary_level(file, summary, level) {
+    const positions = [];
+    for (let i = 0; i < summary.bin_count[level]; i++) {
+        positions.push(get_summary_bin_position(summary.bin_ratio, level, i));
+    }
+    if (level in summary.bin_incomplete) {
+        positions.push(summary.bin_incomplete[level]);
+    }
+
+    const records = Buffer.alloc(positions.length * summary.record_length);
+    if (positions.length === 0) {
+        return records;
+    }
+
+    // read densely stored levels at once, otherwise record by record
+    const span = positions[positions.length - 1] - positions[0] + 1;
+    if (span <= 2 * positions.length) {
+        const span_records = Buffer.alloc(span * summary.record_length);
+        await file.read(span_records, 0, span_records.length,
+            summary.records_offset + positions[0] * summary.record_length);
+        positions.forEach((position, i) => {
+            const offset = (position - positions[0]) * summary.record_length;
+            span_records.copy(records, i * summary.record_length, offset, offset + summary.record_length);
+        });
+    } else {
+        for (let i = 0; i < positions.length; i++) {
+            await file.read(records, i * summary.record_length, summary.record_length,
+                summary.records_offset + positions[i] * summary.record_length);
+        }
+    }
+
+    return records;
+}
+
+function summary_records_to_overview(summary, level, records) {
+    const bin_count = records.length / summary.record_length;
+    const overview = {
+        level: level,
+        start_time: summary.start_time,
+        resolution: summary.bin_size[level] / summary.sample_rate,
+        time: new Array(bin_count),
+        duration: new Array(bin_count),
+        channels: {},
+    };
+
+    for (const channel of summary.channels) {
+        overview.channels[channel.name] = {
+            unit: channel.unit,
+            min: new Array(bin_count),
+            max: new Array(bin_count),
+            mean: new Array(bin_count),
+            valid: new Array(bin_count),
+        };
+    }
+
+    for (let i = 0; i < bin_count; i++) {
+        const offset = i * summary.record_length;
+        overview.time[i] = Number(records.readBigInt64LE(offset + 8)) * 1e3 +
+            Number(records.readBigInt64LE(offset + 16)) / 1e6;
+        overview.duration[i] = records.readUInt32LE(offset + 4) / summary.sample_rate;
+
+        summary.channels.forEach((channel, ch) => {
+            const channel_offset = offset + summary_record_header_length + ch * summary_record_channel_length;
+            const scale = Math.pow(10, channel.scale);
+            const channel_overview = overview.channels[channel.name];
+            channel_overview.min[i] = records.readInt32LE(channel_offset) * scale;
+            channel_overview.max[i] = records.readInt32LE(channel_offset + 4) * scale;
+            channel_overview.mean[i] = records.readFloatLE(channel_offset + 8) * scale;
+            channel_overview.valid[i] = records.readFloatLE(channel_offset + 12);
+        });
+    }
+
+    return overview;
+}
@@ -40,7 +40,7 @@ const RL_CHANNEL_NAMES = ['V1', 'V2', 'V3', 'V4', 'I1L', 'I1H', 'I2L', 'I2H'];
 /// RocketLogger force range channel names
 const RL_CHANNEL_FORCE_NAMES = ['I1H', 'I2H'];
 /// RocketLogger data file formats
-const RL_FILE_FORMATS = ['rld', 'csv'];
+const RL_FILE_FORMATS = ['rld', 'csv', 'arrow'];
 
 /// initialize RocketLogger control functionality
 function rocketlogger_init_control() {
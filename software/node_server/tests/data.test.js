@@ -0,0 +1,103 @@
+"use strict";
+
+import { DataSubscriber } from '../rl.data.js';
+
+
+/// Metadata of the test data stream
+const metadata = {
+    version: 7,
+    layout_hash: 0x12345678,
+    sample_rate: 1000,
+    web_level: '1k',
+    levels: {
+        'full': { data_rate: 1000, envelope: false },
+        '1k': { data_rate: 1000, envelope: false },
+    },
+    channels: [
+        { name: 'V1', group: 'voltage', unit: 'V', scale: 1e-8 },
+        { name: 'DI1', group: 'digital', unit: 'binary', bit: 0 },
+    ],
+};
+
+// build the message frames of a data buffer as published by the RocketLogger
+function data_message(sequence, samples_lost = 0, messages_dropped = 0, version = metadata.version) {
+    const header = Buffer.alloc(40);
+    header.writeUInt16LE(1, 0);
+    header.writeUInt16LE(40, 2);
+    header.writeUInt32LE(version, 4);
+    header.writeBigUInt64LE(BigInt(sequence), 8);
+    header.writeBigUInt64LE(BigInt(samples_lost), 16);
+    header.writeBigUInt64LE(BigInt(messages_dropped), 24);
+    header.writeUInt32LE(metadata.sample_rate, 32);
+    header.writeUInt32LE(metadata.layout_hash, 36);
+
+    const timestamps = Buffer.from(new BigInt64Array([1600000000n, 0n, 100n, 0n]).buffer);
+    const channel = Buffer.from(new Int32Array(100).fill(100000000).buffer);
+    const digital = Buffer.from(new Uint32Array(100).fill(0x01).buffer);
+
+    return [Buffer.from('data.1k.all'), header, timestamps, channel, digital];
+}
+
+
+describe('data stream', () => {
+    let subscriber = null;
+
+    beforeEach(() => {
+        subscriber = new DataSubscriber();
+        expect(subscriber._parse([Buffer.from('metadata'), Buffer.from(JSON.stringify(metadata))])).toBe(null);
+    });
+
+    test('data message', () => {
+        const message = subscriber._parse(data_message(0));
+        expect(message.time.length).toBe(100);
+        expect(message.data.V1[0]).toBeCloseTo(1);
+        expect(message.digital[0]).toBe(0x0101);
+    });
+
+    test('data topic of web level', () => {
+        expect(subscriber._topic).toBe('data.1k.all');
+    });
+
+    test('unknown metadata version', () => {
+        expect(subscriber._parse(data_message(0, 0, 0, 8))).toBe(null);
+    });
+
+    test('unsupported header version', () => {
+        const raw = data_message(0);
+        raw[1].writeUInt16LE(2, 0);
+        expect(() => subscriber._parse(raw)).toThrow('unsupported');
+    });
+
+    test('continuous sequence', () => {
+        for (let i = 0; i < 10; i++) {
+            subscriber._parse(data_message(i));
+        }
+        expect(subscriber.gap_count).toBe(0);
+    });
+
+    test('sequence gaps', () => {
+        subscriber._parse(data_message(0));
+        subscriber._parse(data_message(1));
+        subscriber._parse(data_message(3, 100));
+        expect(subscriber.gap_count).toBe(1);
+        expect(subscriber.buffers_missing).toBe(1);
+
+        subscriber._parse(data_message(6, 100, 2));
+        expect(subscriber.gap_count).toBe(2);
+        expect(subscriber.buffers_missing).toBe(3);
+    });
+
+    test('gap causes', () => {
+        subscriber._parse(data_message(10, 100, 1));
+        const gap = subscriber._check_gap({ sequence: 14, samples_lost: 200, messages_dropped: 2 });
+        expect(gap.buffers).toBe(3);
+        expect(gap.samples_lost).toBe(100);
+        expect(gap.messages_dropped).toBe(1);
+    });
+
+    test('new measurement', () => {
+        subscriber._parse(data_message(100));
+        subscriber._parse(data_message(0));
+        expect(subscriber.gap_count).toBe(0);
+    });
+});
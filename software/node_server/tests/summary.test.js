@@ -0,0 +1,123 @@
+"use strict";
+
+import fs from 'fs/promises';
+import os from 'os';
+import path from 'path';
+
+import { get_summary_path, read_summary_overview } from '../rl.summary.js';
+
+
+/// Sample rate of the test summary
+const sample_rate = 1000;
+
+/// Start time of the test summary [in seconds]
+const start_time = 1600000000;
+
+// write a summary of a ramp signal in the record order of the RocketLogger
+async function write_summary(summary_path, bin_size, sample_count, finish = true) {
+    const bins = [];
+    for (let end = bin_size[0]; end <= sample_count; end += bin_size[0]) {
+        bin_size.forEach((size, level) => {
+            if (end % size === 0) {
+                bins.push([level, end - size, size]);
+            }
+        });
+    }
+    bin_size.forEach((size, level) => {
+        const start = Math.floor(sample_count / size) * size;
+        if (finish && start < sample_count) {
+            bins.push([level, start, sample_count - start]);
+        }
+    });
+
+    const header = Buffer.alloc(32 + 4 * bin_size.length + 28);
+    header.writeUInt32LE(0x534C5225, 0);
+    header.writeUInt16LE(1, 4);
+    header.writeUInt16LE(24 + 16, 6);
+    header.writeUInt16LE(1, 8);
+    header.writeUInt16LE(bin_size.length, 10);
+    header.writeUInt32LE(sample_rate, 12);
+    header.writeBigInt64LE(BigInt(start_time), 16);
+    bin_size.forEach((size, level) => header.writeUInt32LE(size, 32 + 4 * level));
+    const channel_offset = 32 + 4 * bin_size.length;
+    header.writeUInt32LE(1, channel_offset);
+    header.writeInt32LE(-3, channel_offset + 4);
+    header.write('V1', channel_offset + 12, 'ascii');
+
+    const records = Buffer.alloc(bins.length * 40);
+    bins.forEach(([level, start, count], i) => {
+        const offset = i * 40;
+        records.writeUInt32LE(level, offset);
+        records.writeUInt32LE(count, offset + 4);
+        records.writeBigInt64LE(BigInt(start_time + Math.floor(start / sample_rate)), offset + 8);
+        records.writeBigInt64LE(BigInt((start % sample_rate) * 1e6), offset + 16);
+        records.writeInt32LE(start, offset + 24);
+        records.writeInt32LE(start + count - 1, offset + 28);
+        records.writeFloatLE(start + (count - 1) / 2, offset + 32);
+        records.writeFloatLE(1, offset + 36);
+    });
+
+    await fs.writeFile(summary_path, Buffer.concat([header, records]));
+}
+
+
+describe('measurement summary', () => {
+    let directory = null;
+    let summary_path = null;
+
+    beforeEach(async () => {
+        directory = await fs.mkdtemp(path.join(os.tmpdir(), 'rl-summary-'));
+        summary_path = get_summary_path(path.join(directory, 'data.rld'));
+    });
+
+    afterEach(async () => {
+        await fs.rm(directory, { recursive: true });
+    });
+
+    test('summary path', () => {
+        expect(get_summary_path('/data/test.rld')).toBe('/data/test.rls');
+        expect(get_summary_path('/data/test')).toBe('/data/test.rls');
+    });
+
+    test('default level', async () => {
+        await write_summary(summary_path, [10, 100, 1000, 10000], 25005);
+        const overview = await read_summary_overview(summary_path);
+        expect(overview.level).toBe(0);
+        expect(overview.time.length).toBe(2501);
+        expect(overview.duration[2500]).toBeCloseTo(0.005);
+    });
+
+    test('resolution', async () => {
+        await write_summary(summary_path, [10, 100, 1000, 10000], 25005);
+        for (const [resolution, level, size] of [[0.1, 1, 100], [1, 2, 1000], [60, 3, 10000]]) {
+            const overview = await read_summary_overview(summary_path, resolution);
+            expect(overview.level).toBe(level);
+            expect(overview.resolution).toBeCloseTo(size / sample_rate);
+            expect(overview.time.length).toBe(Math.ceil(25005 / size));
+            overview.channels.V1.min.forEach((value, i) => {
+                expect(value).toBeCloseTo(i * size * 1e-3);
+            });
+            overview.time.forEach((value, i) => {
+                expect(value).toBeCloseTo(start_time * 1e3 + i * size);
+            });
+        }
+    });
+
+    test('bin count limit', async () => {
+        await write_summary(summary_path, [1, 10, 100, 1000], 25005);
+        const overview = await read_summary_overview(summary_path, 0.001);
+        expect(overview.level).toBe(1);
+    });
+
+    test('unfinished measurement', async () => {
+        await write_summary(summary_path, [7, 70, 700, 7000], 25005, false);
+        const overview = await read_summary_overview(summary_path, 0.07);
+        expect(overview.time.length).toBe(Math.floor(25005 / 70));
+        expect(overview.channels.V1.max.at(-1)).toBeCloseTo((Math.floor(25005 / 70) * 70 - 1) * 1e-3);
+    });
+
+    test('invalid file', async () => {
+        await fs.writeFile(summary_path, Buffer.alloc(128));
+        await expect(read_summary_overview(summary_path)).rejects.toThrow('unsupported');
+    });
+});
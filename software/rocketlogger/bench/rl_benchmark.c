@@ -0,0 +1,685 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <argp.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ncurses.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <zmq.h>
+
+#include "../calibration.h"
+#include "../log.h"
+#include "../meter.h"
+#include "../pru.h"
+#include "../rl.h"
+#include "../rl_file.h"
+#include "../rl_socket.h"
+#include "../rl_summary.h"
+#include "../util.h"
+
+/// Benchmark log file
+#define BENCH_LOG_FILE "/tmp/rl_benchmark.log"
+/// Default minimum run time per benchmark case in milliseconds
+#define BENCH_TIME_DEFAULT_MS 200
+/// Minimum number of buffers processed per benchmark case
+#define BENCH_BUFFER_COUNT_MIN 3
+/// Default data file for the file storing stages
+#define BENCH_OUTPUT_DEFAULT "/dev/null"
+/// Number of supported sample rates
+#define BENCH_SAMPLE_RATE_COUNT 10
+/// Number of default channel masks
+#define BENCH_CHANNEL_MASK_COUNT 6
+/// Channel mask with all channels enabled
+#define BENCH_CHANNEL_MASK_ALL ((1 << RL_CHANNEL_COUNT) - 1)
+
+/**
+ * Benchmark stages.
+ */
+enum bench_stage {
+    BENCH_STAGE_CALIBRATION, /// Copy and calibrate PRU data
+    BENCH_STAGE_FILE_RLD,    /// Store data to RLD file
+    BENCH_STAGE_FILE_RLDZ,   /// Store data to compressed RLD file
+    BENCH_STAGE_FILE_RLDP,   /// Store data to channel-planar RLD file
+    BENCH_STAGE_FILE_RLDC,   /// Store data to checksummed RLD file
+    BENCH_STAGE_FILE_CSV,    /// Store data to CSV file
+    BENCH_STAGE_FILE_CSVF,   /// Store data to fixed width CSV file
+    BENCH_STAGE_FILE_ARROW,  /// Store data to Arrow IPC file
+    BENCH_STAGE_SUMMARY,     /// Summarize data for the measurement summary
+    BENCH_STAGE_SOCKET,      /// Publish data to the web interface socket
+    BENCH_STAGE_STATUS,      /// Update the status, published at status rate
+    BENCH_STAGE_METER,       /// Print data to the interactive meter
+    BENCH_STAGE_COUNT,       /// Number of benchmark stages
+};
+
+/**
+ * Typedef for benchmark stages.
+ */
+typedef enum bench_stage bench_stage_t;
+
+/// Benchmark stage names
+static char const *const BENCH_STAGE_NAMES[BENCH_STAGE_COUNT] = {
+    "calibration", "file_rld", "file_rldz",  "file_rldp", "file_rldc",
+    "file_csv",    "file_csvf", "file_arrow", "summary",   "socket",
+    "status",      "meter"};
+
+/// Supported sample rates
+static uint32_t const BENCH_SAMPLE_RATES[BENCH_SAMPLE_RATE_COUNT] = {
+    1, 10, 100, 1000, 2000, 4000, 8000, 16000, 32000, 64000};
+
+/// Default channel masks (bit i set enables channel i of RL_CHANNEL_NAMES)
+static uint32_t const BENCH_CHANNEL_MASKS[BENCH_CHANNEL_MASK_COUNT] = {
+    0x0FF, // default channels (V1-V4, I1L, I1H, I2L, I2H)
+    0x1FF, // all channels
+    0x00F, // voltage channels
+    0x0F0, // current channels
+    0x001, // single voltage channel
+    0x010, // single low range current channel
+};
+
+/// Channel scales of the default calibration file
+static double const BENCH_CALIBRATION_SCALES[RL_CHANNEL_COUNT] = {
+    -122.26593800080128, -122.26593800080128, -122.26593800080128,
+    -122.26593800080128, 17.53077787511489,   31.789143880208332,
+    17.53077787511489,   31.789143880208332,  5.0};
+
+/**
+ * Benchmark arguments.
+ */
+struct arguments {
+    /// Sample rate to benchmark only (0 for all supported rates)
+    uint32_t sample_rate;
+    /// Data update rate
+    uint32_t update_rate;
+    /// Channel mask to benchmark only (negative for default masks)
+    int channel_mask;
+    /// Benchmark all channel mask combinations
+    bool channel_mask_all;
+    /// Stages to benchmark
+    bool stage_enable[BENCH_STAGE_COUNT];
+    /// Minimum run time per benchmark case in milliseconds
+    uint32_t time_ms;
+    /// Data file for the file storing stages
+    char const *output;
+    /// Print results as JSON lines
+    bool json;
+};
+
+/**
+ * Benchmark state shared by the stages.
+ */
+struct bench_context {
+    /// Benchmark configuration
+    rl_config_t config;
+    /// Synthetic PRU data
+    pru_data_t *pru_data;
+    /// Calibrated analog data buffer
+    int32_t *analog_buffer;
+    /// Digital data buffer
+    uint32_t *digital_buffer;
+    /// Number of samples per buffer
+    size_t buffer_size;
+    /// Sequence number of the next buffer published to the data socket
+    uint64_t socket_sequence;
+    /// Data file for the file storing stages
+    FILE *data_file;
+    /// Measurement summary for the summary stage
+    rl_summary_t summary;
+    /// ZeroMQ context of the data socket subscriber
+    void *socket_subscriber_context;
+    /// Data socket subscriber to all topics, only subscribed topics are
+    /// computed and published
+    void *socket_subscriber;
+    /// Whether the data socket is available
+    bool socket_available;
+    /// Whether the status publisher is available
+    bool status_available;
+    /// Whether the meter screen is available
+    bool meter_available;
+};
+
+/**
+ * Typedef for benchmark state shared by the stages.
+ */
+typedef struct bench_context bench_context_t;
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state);
+static int bench_run_case(bench_context_t *const context, bench_stage_t stage,
+                          uint32_t sample_rate, uint32_t channel_mask,
+                          struct arguments const *const arguments);
+static int bench_run_stage(bench_context_t *const context, bench_stage_t stage);
+static void bench_generate_data(pru_data_t *const data, size_t length);
+static int64_t bench_time_ns(void);
+
+/**
+ * Program documentation
+ */
+static char doc[] =
+    "RocketLogger benchmark -- measure the data processing throughput.\n"
+    "Drives synthetic PRU data through the data processing stages for all "
+    "supported sample rates and a set of channel masks. Reports the "
+    "processing time per sample, the buffers processed per second and the "
+    "peak resident memory of each case.";
+
+/**
+ * Summary of program options
+ */
+static struct argp_option options[] = {
+    {"rate", 'r', "RATE", 0,
+     "Benchmark a single sampling rate in Hz only (all supported rates by "
+     "default).",
+     0},
+    {"update", 'u', "RATE", 0,
+     "Measurement data update rate in Hz (1 by default, uses 1 for rates "
+     "not divisible by it).",
+     0},
+    {"channels", 'c', "MASK", 0,
+     "Benchmark a single channel mask only, or 'all' for all channel mask "
+     "combinations. Bit i of the mask enables the i-th channel of V1, V2, V3, "
+     "V4, I1L, I1H, I2L, I2H, DT.",
+     0},
+    {"stage", 's', "STAGE", 0,
+     "Benchmark a single stage only: 'calibration', 'file_rld', "
+     "'file_rldz', 'file_rldp', 'file_rldc', 'file_csv', 'file_csvf', "
+     "'file_arrow', 'summary', 'socket', 'status' or 'meter'.",
+     0},
+    {"time", 't', "MS", 0,
+     "Minimum run time per benchmark case in milliseconds (200 by default).",
+     0},
+    {"output", 'o', "FILE", 0,
+     "Data file written by the file stages (/dev/null by default).", 0},
+    {"json", 'j', 0, 0, "Print results as JSON lines.", 0},
+    {0, 0, 0, 0, 0, 0},
+};
+
+/**
+ * The full `argp` parser configuration
+ */
+static struct argp argp = {
+    .options = options,
+    .parser = parse_opt,
+    .doc = doc,
+};
+
+/**
+ * RocketLogger processing throughput benchmark.
+ *
+ * @param argc Number of input arguments
+ * @param argv Input arguments
+ * @return standard Linux return codes
+ */
+int main(int argc, char *argv[]) {
+    struct arguments arguments = {
+        .sample_rate = 0,
+        .update_rate = 1,
+        .channel_mask = -1,
+        .channel_mask_all = false,
+        .stage_enable = {true, true, true, true, true, true, true},
+        .time_ms = BENCH_TIME_DEFAULT_MS,
+        .output = BENCH_OUTPUT_DEFAULT,
+        .json = false,
+    };
+    argp_parse(&argp, argc, argv, 0, 0, &arguments);
+
+    rl_log_init(BENCH_LOG_FILE, RL_LOG_ERROR);
+
+    // benchmark context with buffers sized for the maximum rate
+    bench_context_t context;
+    rl_config_reset(&context.config);
+    context.config.file_enable = true;
+    context.config.web_enable = true;
+    context.config.digital_enable = true;
+
+    size_t const buffer_size_max =
+        BENCH_SAMPLE_RATES[BENCH_SAMPLE_RATE_COUNT - 1];
+    context.pru_data = malloc(buffer_size_max * sizeof(pru_data_t));
+    context.analog_buffer =
+        malloc(buffer_size_max * RL_CHANNEL_COUNT * sizeof(int32_t));
+    context.digital_buffer = malloc(buffer_size_max * sizeof(uint32_t));
+    if (context.pru_data == NULL || context.analog_buffer == NULL ||
+        context.digital_buffer == NULL) {
+        rl_log(RL_LOG_ERROR, "failed allocating benchmark buffers");
+        exit(EXIT_FAILURE);
+    }
+    if (rl_file_block_buffer_init(buffer_size_max, RL_FILE_FORMAT_CSV) < 0) {
+        exit(EXIT_FAILURE);
+    }
+    bench_generate_data(context.pru_data, buffer_size_max);
+    calibration_reset_offsets();
+    for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+        rl_calibration.scales[j] = BENCH_CALIBRATION_SCALES[j];
+    }
+    calibration_update_fixed_point();
+
+    context.data_file = fopen64(arguments.output, "w");
+    if (context.data_file == NULL) {
+        rl_log(RL_LOG_ERROR, "failed to open data file '%s'; %d message: %s",
+               arguments.output, errno, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    // sockets and shared memory of a running measurement cannot be shared
+    context.socket_available = (rl_socket_init() == SUCCESS);
+    if (context.socket_available) {
+        context.socket_subscriber_context = zmq_ctx_new();
+        context.socket_subscriber =
+            zmq_socket(context.socket_subscriber_context, ZMQ_SUB);
+        zmq_connect(context.socket_subscriber, RL_ZMQ_DATA_SOCKET);
+        zmq_setsockopt(context.socket_subscriber, ZMQ_SUBSCRIBE, "", 0);
+        // wait for the subscription to reach the publisher
+        usleep(100000);
+    }
+    context.status_available = (rl_status_shm_init() == SUCCESS &&
+                                rl_status_pub_init() == SUCCESS);
+    rl_status_reset(&rl_status);
+    rl_status.config = &context.config;
+
+    // interactive meter writes to a virtual terminal discarding its output
+    FILE *meter_output = fopen("/dev/null", "w");
+    FILE *meter_input = fopen("/dev/null", "r");
+    SCREEN *meter_screen = NULL;
+    if (meter_output != NULL && meter_input != NULL) {
+        meter_screen = newterm("vt100", meter_output, meter_input);
+    }
+    context.meter_available = (meter_screen != NULL);
+    if (context.meter_available) {
+        set_term(meter_screen);
+    }
+
+    // run benchmark cases
+    int result = SUCCESS;
+    for (int r = 0; r < BENCH_SAMPLE_RATE_COUNT; r++) {
+        uint32_t const sample_rate = BENCH_SAMPLE_RATES[r];
+        if (arguments.sample_rate > 0 && arguments.sample_rate != sample_rate) {
+            continue;
+        }
+
+        // channel masks to benchmark
+        uint32_t mask_count = BENCH_CHANNEL_MASK_COUNT;
+        if (arguments.channel_mask_all) {
+            mask_count = BENCH_CHANNEL_MASK_ALL + 1;
+        } else if (arguments.channel_mask >= 0) {
+            mask_count = 1;
+        }
+
+        for (uint32_t m = 0; m < mask_count; m++) {
+            uint32_t channel_mask =
+                BENCH_CHANNEL_MASKS[m % BENCH_CHANNEL_MASK_COUNT];
+            if (arguments.channel_mask_all) {
+                channel_mask = m;
+            } else if (arguments.channel_mask >= 0) {
+                channel_mask = (uint32_t)arguments.channel_mask;
+            }
+
+            for (int s = 0; s < BENCH_STAGE_COUNT; s++) {
+                if (!arguments.stage_enable[s]) {
+                    continue;
+                }
+                int res = bench_run_case(&context, (bench_stage_t)s,
+                                         sample_rate, channel_mask, &arguments);
+                if (res < 0) {
+                    result = ERROR;
+                }
+            }
+        }
+    }
+
+    // cleanup
+    if (context.meter_available) {
+        endwin();
+        delscreen(meter_screen);
+    }
+    if (meter_output != NULL) {
+        fclose(meter_output);
+    }
+    if (meter_input != NULL) {
+        fclose(meter_input);
+    }
+    if (context.status_available) {
+        rl_status_pub_deinit();
+        rl_status_shm_deinit();
+    }
+    if (context.socket_available) {
+        zmq_close(context.socket_subscriber);
+        zmq_ctx_destroy(context.socket_subscriber_context);
+        rl_socket_deinit();
+    }
+    fclose(context.data_file);
+    rl_file_block_buffer_deinit();
+    free(context.pru_data);
+    free(context.analog_buffer);
+    free(context.digital_buffer);
+
+    exit(result == SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/**
+ * The CLI option parser function.
+ *
+ * @param key Argument key
+ * @param arg Argument string value
+ * @param state Argument state structure
+ * @return Error code or 0 on success
+ */
+static error_t parse_opt(int key, char *arg, struct argp_state *state) {
+    struct arguments *arguments = state->input;
+    char *end = NULL;
+
+    switch (key) {
+    case 'r':
+        arguments->sample_rate = (uint32_t)strtoul(arg, &end, 10);
+        if (*end == 'k') {
+            arguments->sample_rate *= 1000;
+            end++;
+        }
+        if (*end != '\0' || arguments->sample_rate == 0) {
+            argp_usage(state);
+        }
+        break;
+    case 'u':
+        arguments->update_rate = (uint32_t)strtoul(arg, &end, 10);
+        if (*end != '\0' || arguments->update_rate == 0) {
+            argp_usage(state);
+        }
+        break;
+    case 'c':
+        if (strcmp(arg, "all") == 0) {
+            arguments->channel_mask_all = true;
+        } else {
+            arguments->channel_mask = (int)strtol(arg, &end, 0);
+            if (*end != '\0' || arguments->channel_mask < 0 ||
+                arguments->channel_mask > BENCH_CHANNEL_MASK_ALL) {
+                argp_usage(state);
+            }
+        }
+        break;
+    case 's': {
+        bool found = false;
+        for (int i = 0; i < BENCH_STAGE_COUNT; i++) {
+            arguments->stage_enable[i] =
+                (strcmp(arg, BENCH_STAGE_NAMES[i]) == 0);
+            found = found || arguments->stage_enable[i];
+        }
+        if (!found) {
+            argp_usage(state);
+        }
+        break;
+    }
+    case 't':
+        arguments->time_ms = (uint32_t)strtoul(arg, &end, 10);
+        if (*end != '\0') {
+            argp_usage(state);
+        }
+        break;
+    case 'o':
+        arguments->output = arg;
+        break;
+    case 'j':
+        arguments->json = true;
+        break;
+    case ARGP_KEY_ARG:
+        argp_usage(state);
+        break;
+    default:
+        return ARGP_ERR_UNKNOWN;
+    }
+
+    return 0;
+}
+
+/**
+ * Run a single benchmark case and print its result.
+ *
+ * @param context The benchmark context
+ * @param stage The stage to benchmark
+ * @param sample_rate The sample rate to benchmark
+ * @param channel_mask The channel mask to benchmark
+ * @param arguments The benchmark arguments
+ * @return Returns 0 on success, negative on failure
+ */
+static int bench_run_case(bench_context_t *const context, bench_stage_t stage,
+                          uint32_t sample_rate, uint32_t channel_mask,
+                          struct arguments const *const arguments) {
+    // configure case, update rate needs to divide the sample rate
+    rl_config_t *const config = &context->config;
+    config->sample_rate = sample_rate;
+    config->update_rate = arguments->update_rate;
+    if (sample_rate % config->update_rate > 0) {
+        config->update_rate = 1;
+    }
+    for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+        config->channel_enable[j] = (channel_mask & (1 << j)) > 0;
+    }
+    config->file_format = RL_FILE_FORMAT_RLD;
+    if (stage == BENCH_STAGE_FILE_CSV || stage == BENCH_STAGE_FILE_CSVF) {
+        config->file_format = RL_FILE_FORMAT_CSV;
+    } else if (stage == BENCH_STAGE_FILE_ARROW) {
+        config->file_format = RL_FILE_FORMAT_ARROW;
+    }
+    config->file_compress_enable = (stage == BENCH_STAGE_FILE_RLDZ);
+    config->file_planar_enable = (stage == BENCH_STAGE_FILE_RLDP);
+    config->file_crc_enable = (stage == BENCH_STAGE_FILE_RLDC);
+    config->file_fixed_width_enable = (stage == BENCH_STAGE_FILE_CSVF);
+
+    // PRU buffer size at native sample rate (aggregated when storing)
+    uint32_t native_rate = sample_rate;
+    if (native_rate < RL_SAMPLE_RATE_MIN) {
+        native_rate = RL_SAMPLE_RATE_MIN;
+    }
+    context->buffer_size = native_rate / config->update_rate;
+
+    if (stage == BENCH_STAGE_SOCKET) {
+        rl_socket_metadata(config);
+    }
+    if (stage == BENCH_STAGE_SUMMARY) {
+        rl_file_header_t header;
+        rl_file_setup_data_lead_in(&header.lead_in, config);
+        header.channel =
+            malloc((header.lead_in.channel_bin_count +
+                    header.lead_in.channel_count) *
+                   sizeof(rl_file_channel_t));
+        rl_file_setup_data_header(&header, config);
+        int res = rl_summary_init(&context->summary, context->data_file,
+                                  &header, config);
+        free(header.channel);
+        if (res < 0) {
+            return ERROR;
+        }
+    }
+
+    // stages following the calibration process calibrated data, values
+    // formatted to text depend on the data
+    if (stage != BENCH_STAGE_CALIBRATION) {
+        calibration_apply(context->analog_buffer, context->digital_buffer,
+                          context->pru_data, context->buffer_size, config);
+    }
+
+    // process buffers for the minimum run time
+    uint64_t buffer_count = 0;
+    int64_t const time_start = bench_time_ns();
+    int64_t time_elapsed = 0;
+    do {
+        int res = bench_run_stage(context, stage);
+        if (res < 0) {
+            rl_log(RL_LOG_ERROR, "benchmark stage '%s' failed",
+                   BENCH_STAGE_NAMES[stage]);
+            return ERROR;
+        }
+        if (res == 0) {
+            // stage not available, skip
+            return SUCCESS;
+        }
+        buffer_count++;
+        time_elapsed = bench_time_ns() - time_start;
+    } while (buffer_count < BENCH_BUFFER_COUNT_MIN ||
+             time_elapsed < (int64_t)arguments->time_ms * 1000000);
+
+    // collect results
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    uint64_t const sample_count = buffer_count * context->buffer_size;
+    double const ns_per_sample = (double)time_elapsed / sample_count;
+    double const buffers_per_second = buffer_count * 1e9 / time_elapsed;
+
+    if (arguments->json) {
+        printf("{\"stage\": \"%s\", \"sample_rate\": %u, \"update_rate\": %u, "
+               "\"channel_mask\": %u, \"buffer_size\": %zu, \"buffers\": %llu, "
+               "\"time_ns\": %lld, \"ns_per_sample\": %.3f, "
+               "\"buffers_per_second\": %.3f, \"peak_rss_kb\": %ld}\n",
+               BENCH_STAGE_NAMES[stage], sample_rate, config->update_rate,
+               channel_mask, context->buffer_size,
+               (unsigned long long)buffer_count, (long long)time_elapsed,
+               ns_per_sample, buffers_per_second, usage.ru_maxrss);
+    } else {
+        printf("%-12s %6u Sps %3u Hz  mask 0x%03x  %10.3f ns/sample  %12.3f "
+               "buffers/s  %8ld kB peak RSS\n",
+               BENCH_STAGE_NAMES[stage], sample_rate, config->update_rate,
+               channel_mask, ns_per_sample, buffers_per_second,
+               usage.ru_maxrss);
+    }
+    fflush(stdout);
+
+    return SUCCESS;
+}
+
+/**
+ * Process one data buffer in a benchmark stage.
+ *
+ * @param context The benchmark context
+ * @param stage The stage to run
+ * @return Returns 1 on success, 0 if the stage is not available, negative on
+ * failure
+ */
+static int bench_run_stage(bench_context_t *const context,
+                           bench_stage_t stage) {
+    rl_timestamp_t timestamp_realtime;
+    rl_timestamp_t timestamp_monotonic;
+    create_time_stamp(&timestamp_realtime, &timestamp_monotonic);
+
+    int res = SUCCESS;
+    switch (stage) {
+    case BENCH_STAGE_CALIBRATION:
+        calibration_apply(context->analog_buffer, context->digital_buffer,
+                          context->pru_data, context->buffer_size,
+                          &context->config);
+        break;
+
+    case BENCH_STAGE_FILE_RLD:
+    case BENCH_STAGE_FILE_RLDZ:
+    case BENCH_STAGE_FILE_RLDP:
+    case BENCH_STAGE_FILE_RLDC:
+    case BENCH_STAGE_FILE_CSV:
+    case BENCH_STAGE_FILE_CSVF:
+    case BENCH_STAGE_FILE_ARROW:
+        res = rl_file_add_data_block(
+            context->data_file, context->analog_buffer, context->digital_buffer,
+            context->buffer_size, &timestamp_realtime, &timestamp_monotonic,
+            &context->config);
+        break;
+
+    case BENCH_STAGE_SUMMARY:
+        res = rl_summary_add(&context->summary, context->analog_buffer,
+                             context->digital_buffer, context->buffer_size,
+                             &timestamp_realtime);
+        break;
+
+    case BENCH_STAGE_SOCKET:
+        if (!context->socket_available) {
+            return 0;
+        }
+        res = rl_socket_handle_data(
+            context->analog_buffer, context->digital_buffer, NULL,
+            context->buffer_size, 0, context->socket_sequence++, 0,
+            &timestamp_realtime, &timestamp_monotonic, &context->config);
+        break;
+
+    case BENCH_STAGE_STATUS:
+        if (!context->status_available) {
+            return 0;
+        }
+        rl_status.sample_count += context->buffer_size;
+        rl_status.buffer_count++;
+        res = rl_status_update(&rl_status);
+        break;
+
+    case BENCH_STAGE_METER:
+        if (!context->meter_available) {
+            return 0;
+        }
+        meter_print_buffer(context->analog_buffer, context->digital_buffer,
+                           context->buffer_size, &timestamp_realtime,
+                           &timestamp_monotonic, &context->config);
+        break;
+
+    default:
+        return 0;
+    }
+
+    return (res < 0) ? ERROR : 1;
+}
+
+/**
+ * Generate synthetic PRU data with ADC value range.
+ *
+ * @param data The PRU data blocks to fill
+ * @param length Number of data blocks to fill
+ */
+static void bench_generate_data(pru_data_t *const data, size_t length) {
+    uint32_t random = 1;
+    for (size_t i = 0; i < length; i++) {
+        // linear congruential generator, 24 bit signed ADC values
+        random = random * 1103515245 + 12345;
+        data[i].channel_digital = (random >> 8) & 0xFF;
+        for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+            random = random * 1103515245 + 12345;
+            data[i].channel_analog[j] = ((int32_t)random) >> 8;
+        }
+    }
+}
+
+/**
+ * Get monotonic clock time.
+ *
+ * @return The current monotonic time in nanoseconds
+ */
+static int64_t bench_time_ns(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (int64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
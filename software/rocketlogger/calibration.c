@@ -29,29 +29,119 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <math.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 
 #include <unistd.h>
 
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "log.h"
 #include "rl.h"
 
 #include "calibration.h"
 
+/// Bit position of the high part of the fixed-point scale
+#define CALIBRATION_SCALE_HIGH_SHIFT 31
+/// Mask of the low part of the fixed-point scale
+#define CALIBRATION_SCALE_LOW_MASK                                             \
+    ((INT64_C(1) << CALIBRATION_SCALE_HIGH_SHIFT) - 1)
+/// Maximum magnitude of the fixed-point scale in bits
+#define CALIBRATION_SCALE_BITS 61
+/// Maximum number of fractional bits of the fixed-point result
+#define CALIBRATION_FRACTION_BITS_MAX 48
+/// Fractional bits resolved exactly by the double product for results < 2^31
+#define CALIBRATION_DOUBLE_FRACTION_BITS 23
+/// Maximum significant bits of a scale for exact double products (53 - 31)
+#define CALIBRATION_EXACT_SCALE_BITS 22
+
+/**
+ * Fixed-point calibration of a single channel.
+ *
+ * The calibrated value is trunc((value + offset) * scale) with scale
+ * approximated by (scale_high * 2^31 + scale_low) / 2^(fraction_bits + 31).
+ * Results within margin of an integer cannot be rounded reliably and are
+ * recalculated using the double precision calibration.
+ */
+struct calibration_fixed_point {
+    /// Channel offset (in bit)
+    int32_t offset;
+    /// High part of the fixed-point scale
+    int32_t scale_high;
+    /// Low part of the fixed-point scale (31 bit, non-negative)
+    int32_t scale_low;
+    /// Number of fractional bits of the fixed-point product
+    int32_t fraction_bits;
+    /// Mask of the fractional bits of the fixed-point product
+    int64_t fraction_mask;
+    /// Rounding ambiguity margin in fractional LSB (0: exact, negative: always
+    /// use double precision)
+    int64_t margin;
+};
+
+/**
+ * Typedef for fixed-point calibration of a single channel.
+ */
+typedef struct calibration_fixed_point calibration_fixed_point_t;
+
+/**
+ * Calculate the fixed-point calibration of a channel.
+ *
+ * @param fixed_point The fixed-point calibration to set up
+ * @param offset The channel offset
+ * @param scale The channel scale
+ */
+static void
+calibration_fixed_point_setup(calibration_fixed_point_t *const fixed_point,
+                              int offset, double scale);
+
+/**
+ * Calibrate a single value using the fixed-point calibration.
+ *
+ * Falls back to the double precision calibration for ambiguous results.
+ *
+ * @param value The raw channel value
+ * @param fp The fixed-point calibration of the channel
+ * @param channel The channel index
+ * @return The calibrated value, identical to the double precision calibration
+ */
+static inline int32_t
+calibration_fixed_point_apply(int32_t value,
+                              calibration_fixed_point_t const *const fp,
+                              int channel);
+
+/**
+ * Calibrate a single value using the double precision calibration.
+ *
+ * @param value The raw channel value
+ * @param channel The channel index
+ * @return The calibrated value
+ */
+static int32_t calibration_double_apply(int32_t value, int channel)
+    __attribute__((noinline));
+
 /// Global calibration data structure.
 rl_calibration_t rl_calibration;
 
+/// Fixed-point calibration derived from the global calibration data
+static calibration_fixed_point_t calibration_fixed_point[RL_CHANNEL_COUNT];
+
 void calibration_reset_offsets(void) {
     for (int i = 0; i < RL_CHANNEL_COUNT; i++) {
         rl_calibration.offsets[i] = 0;
     }
+    calibration_update_fixed_point();
 }
 
 void calibration_reset_scales(void) {
     for (int i = 0; i < RL_CHANNEL_COUNT; i++) {
         rl_calibration.scales[i] = 1;
     }
+    calibration_update_fixed_point();
 }
 
 int calibration_load(void) {
@@ -111,6 +201,7 @@ int calibration_load(void) {
     // PRU DT channel has implementation specific, fixed conversion
     rl_calibration.offsets[RL_CONFIG_CHANNEL_DT] = 0;
     rl_calibration.scales[RL_CONFIG_CHANNEL_DT] = 5;
+    calibration_update_fixed_point();
 
     // store calibration info information to status
     rl_status.calibration_time = calibration_file.calibration_time;
@@ -122,3 +213,241 @@ int calibration_load(void) {
 
     return SUCCESS;
 }
+
+void calibration_update_fixed_point(void) {
+    for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+        calibration_fixed_point_setup(&calibration_fixed_point[j],
+                                      rl_calibration.offsets[j],
+                                      rl_calibration.scales[j]);
+    }
+}
+
+void calibration_apply(int32_t *const analog_buffer,
+                       uint32_t *const digital_buffer,
+                       pru_data_t const *const pru_data, size_t buffer_size,
+                       rl_config_t const *const config) {
+    // fixed-point calibration of enabled channels, disabled ones yield zero
+    calibration_fixed_point_t fixed_point[RL_CHANNEL_COUNT] = {0};
+    for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+        if (config->channel_enable[j]) {
+            fixed_point[j] = calibration_fixed_point[j];
+        }
+    }
+
+#if defined(__ARM_NEON)
+    // channel pairs with an enabled channel are processed in vector lanes
+    int pair_index[RL_CHANNEL_COUNT / 2];
+    int pair_count = 0;
+    int32x2_t pair_offset[RL_CHANNEL_COUNT / 2];
+    int32x2_t pair_scale_high[RL_CHANNEL_COUNT / 2];
+    int32x2_t pair_scale_low[RL_CHANNEL_COUNT / 2];
+    int64x2_t pair_shift[RL_CHANNEL_COUNT / 2];
+    int64x2_t pair_fraction_mask[RL_CHANNEL_COUNT / 2];
+    int64x2_t pair_margin[RL_CHANNEL_COUNT / 2];
+    bool pair_scalar[RL_CHANNEL_COUNT / 2];
+    for (int j = 0; j + 1 < RL_CHANNEL_COUNT; j += 2) {
+        calibration_fixed_point_t const *const fp = &fixed_point[j];
+        if (!config->channel_enable[j] && !config->channel_enable[j + 1]) {
+            continue;
+        }
+        int32_t const offset[2] = {fp[0].offset, fp[1].offset};
+        int32_t const scale_high[2] = {fp[0].scale_high, fp[1].scale_high};
+        int32_t const scale_low[2] = {fp[0].scale_low, fp[1].scale_low};
+        int64_t const shift[2] = {-fp[0].fraction_bits, -fp[1].fraction_bits};
+        int64_t const fraction_mask[2] = {fp[0].fraction_mask,
+                                          fp[1].fraction_mask};
+        int64_t const margin[2] = {fp[0].margin, fp[1].margin};
+
+        pair_index[pair_count] = j;
+        pair_offset[pair_count] = vld1_s32(offset);
+        pair_scale_high[pair_count] = vld1_s32(scale_high);
+        pair_scale_low[pair_count] = vld1_s32(scale_low);
+        pair_shift[pair_count] = vld1q_s64(shift);
+        pair_fraction_mask[pair_count] = vld1q_s64(fraction_mask);
+        pair_margin[pair_count] = vld1q_s64(margin);
+        pair_scalar[pair_count] = (margin[0] < 0 || margin[1] < 0);
+        pair_count++;
+    }
+    bool const last_enable = config->channel_enable[RL_CHANNEL_COUNT - 1] &&
+                             (RL_CHANNEL_COUNT % 2 == 1);
+#else
+    int channel_index[RL_CHANNEL_COUNT];
+    int channel_count = 0;
+    for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+        if (config->channel_enable[j]) {
+            channel_index[channel_count] = j;
+            channel_count++;
+        }
+    }
+#endif
+
+    // reset disabled channels
+    for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+        if (!config->channel_enable[j]) {
+            memset(analog_buffer + j * buffer_size, 0,
+                   buffer_size * sizeof(int32_t));
+        }
+    }
+
+    for (size_t i = 0; i < buffer_size; i++) {
+        // get local data buffer pointers (channels buffer_size apart)
+        int32_t *const analog_data = analog_buffer + i;
+        int32_t const *const pru_analog = pru_data[i].channel_analog;
+
+        // copy digital channel data
+        digital_buffer[i] = pru_data[i].channel_digital;
+
+#if defined(__ARM_NEON)
+        // calibrate channel pairs in vector lanes
+        for (int p = 0; p < pair_count; p++) {
+            int const j = pair_index[p];
+            if (pair_scalar[p]) {
+                analog_data[j * buffer_size] = calibration_fixed_point_apply(
+                    pru_analog[j], &fixed_point[j], j);
+                analog_data[(j + 1) * buffer_size] =
+                    calibration_fixed_point_apply(pru_analog[j + 1],
+                                                  &fixed_point[j + 1], j + 1);
+                continue;
+            }
+
+            // product in fractional LSB: value * (high * 2^31 + low) / 2^31
+            int32x2_t const value =
+                vadd_s32(vld1_s32(&pru_analog[j]), pair_offset[p]);
+            int64x2_t const product = vaddq_s64(
+                vmull_s32(value, pair_scale_high[p]),
+                vshrq_n_s64(vmull_s32(value, pair_scale_low[p]),
+                            CALIBRATION_SCALE_HIGH_SHIFT));
+
+            // truncate toward zero by rounding up negative products
+            int64x2_t const round = vandq_s64(vshrq_n_s64(product, 63),
+                                              pair_fraction_mask[p]);
+            int64x2_t const result =
+                vshlq_s64(vaddq_s64(product, round), pair_shift[p]);
+            int32x2_t const result_narrow = vmovn_s64(result);
+            vst1_lane_s32(&analog_data[j * buffer_size], result_narrow, 0);
+            vst1_lane_s32(&analog_data[(j + 1) * buffer_size], result_narrow,
+                          1);
+
+            // fractional part within margin of an integer is ambiguous
+            int64x2_t const fraction = vandq_s64(
+                vaddq_s64(product, pair_margin[p]), pair_fraction_mask[p]);
+            int64x2_t const ambiguous = vshrq_n_s64(
+                vsubq_s64(fraction, vshlq_n_s64(pair_margin[p], 1)), 63);
+            if (vgetq_lane_s64(ambiguous, 0) | vgetq_lane_s64(ambiguous, 1)) {
+                analog_data[j * buffer_size] = calibration_fixed_point_apply(
+                    pru_analog[j], &fixed_point[j], j);
+                analog_data[(j + 1) * buffer_size] =
+                    calibration_fixed_point_apply(pru_analog[j + 1],
+                                                  &fixed_point[j + 1], j + 1);
+            }
+        }
+        if (last_enable) {
+            analog_data[(RL_CHANNEL_COUNT - 1) * buffer_size] =
+                calibration_fixed_point_apply(
+                    pru_analog[RL_CHANNEL_COUNT - 1],
+                    &fixed_point[RL_CHANNEL_COUNT - 1], RL_CHANNEL_COUNT - 1);
+        }
+#else
+        // calibrate enabled channels
+        for (int k = 0; k < channel_count; k++) {
+            int const j = channel_index[k];
+            analog_data[j * buffer_size] = calibration_fixed_point_apply(
+                pru_analog[j], &fixed_point[j], j);
+        }
+#endif
+    }
+}
+
+static void
+calibration_fixed_point_setup(calibration_fixed_point_t *const fixed_point,
+                              int offset, double scale) {
+    fixed_point->offset = offset;
+    fixed_point->scale_high = 0;
+    fixed_point->scale_low = 0;
+    fixed_point->fraction_bits = 0;
+    fixed_point->fraction_mask = 0;
+    fixed_point->margin = 0;
+
+    // zero scale is exact for any fraction bits
+    if (scale == 0) {
+        return;
+    }
+
+    // only use double precision for scales not representable
+    int exponent;
+    frexp(scale, &exponent);
+    int fraction_bits =
+        CALIBRATION_SCALE_BITS - CALIBRATION_SCALE_HIGH_SHIFT - exponent;
+    if (!isfinite(scale) || fraction_bits < 1) {
+        fixed_point->margin = -1;
+        return;
+    }
+    if (fraction_bits > CALIBRATION_FRACTION_BITS_MAX) {
+        fraction_bits = CALIBRATION_FRACTION_BITS_MAX;
+    }
+
+    // scale with fraction bits plus the bits of the low product part
+    double const scale_scaled =
+        ldexp(scale, fraction_bits + CALIBRATION_SCALE_HIGH_SHIFT);
+    int64_t const scale_fixed = llround(scale_scaled);
+    fixed_point->scale_high =
+        (int32_t)(scale_fixed >> CALIBRATION_SCALE_HIGH_SHIFT);
+    fixed_point->scale_low =
+        (int32_t)(scale_fixed & CALIBRATION_SCALE_LOW_MASK);
+    fixed_point->fraction_bits = fraction_bits;
+    fixed_point->fraction_mask = (INT64_C(1) << fraction_bits) - 1;
+
+    // exact if scale has few significant bits and no fraction beyond result
+    // fraction bits, as then the fixed-point and double products are exact
+    int64_t significant = scale_fixed < 0 ? -scale_fixed : scale_fixed;
+    while (significant != 0 && (significant & 0x1) == 0) {
+        significant = significant >> 1;
+    }
+    if ((double)scale_fixed == scale_scaled && fixed_point->scale_low == 0 &&
+        significant != 0 &&
+        significant < (INT64_C(1) << CALIBRATION_EXACT_SCALE_BITS)) {
+        return;
+    }
+
+    // margin covers the scale approximation and truncation of the low product
+    // (below 1 LSB each) and the double rounding error (2^-23 for results
+    // below 2^31)
+    fixed_point->margin = 2;
+    if (fraction_bits > CALIBRATION_DOUBLE_FRACTION_BITS) {
+        fixed_point->margin +=
+            INT64_C(1) << (fraction_bits - CALIBRATION_DOUBLE_FRACTION_BITS);
+    } else {
+        fixed_point->margin += 1;
+    }
+}
+
+static inline int32_t
+calibration_fixed_point_apply(int32_t value,
+                              calibration_fixed_point_t const *const fp,
+                              int channel) {
+    int64_t const fraction_mask = fp->fraction_mask;
+
+    if (fp->margin >= 0) {
+        // product in fractional LSB: value * (high * 2^31 + low) / 2^31
+        int32_t const offset_value = value + fp->offset;
+        int64_t const product =
+            (int64_t)offset_value * fp->scale_high +
+            (((int64_t)offset_value * fp->scale_low) >>
+             CALIBRATION_SCALE_HIGH_SHIFT);
+
+        // use result if fractional part not within margin of an integer
+        int64_t const fraction = (product + fp->margin) & fraction_mask;
+        if (fraction >= 2 * fp->margin) {
+            // truncate toward zero by rounding up negative products
+            int64_t const round = (product >> 63) & fraction_mask;
+            return (int32_t)((product + round) >> fp->fraction_bits);
+        }
+    }
+
+    return calibration_double_apply(value, channel);
+}
+
+static int32_t calibration_double_apply(int32_t value, int channel) {
+    return (int32_t)((value + rl_calibration.offsets[channel]) *
+                     rl_calibration.scales[channel]);
+}
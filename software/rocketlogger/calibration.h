@@ -32,8 +32,10 @@
 #ifndef CALIBRATION_H_
 #define CALIBRATION_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
+#include "pru.h"
 #include "rl.h"
 
 /// Calibration file header magic
@@ -99,6 +101,35 @@ void calibration_reset_scales(void);
  */
 int calibration_load(void);
 
+/**
+ * Update the fixed-point calibration derived from the calibration data.
+ *
+ * @note Called when resetting or loading the calibration. Call manually after
+ * modifying the global calibration data directly.
+ */
+void calibration_update_fixed_point(void);
+
+/**
+ * Copy PRU data buffer and apply the calibration to the enabled analog
+ * channels.
+ *
+ * Uses fixed-point arithmetic (NEON vectorized if available) with results
+ * identical to the double precision calibration. Disabled channels are set to
+ * zero. The analog data is stored channel-major, i.e. sample `i` of channel
+ * `j` at `analog_buffer[j * buffer_size + i]`.
+ *
+ * @param analog_buffer Analog data buffer (channel-major) to store the
+ * calibrated data to
+ * @param digital_buffer Digital data buffer to store the digital data to
+ * @param pru_data PRU data blocks to process
+ * @param buffer_size Number of data blocks to process
+ * @param config Current measurement configuration
+ */
+void calibration_apply(int32_t *const analog_buffer,
+                       uint32_t *const digital_buffer,
+                       pru_data_t const *const pru_data, size_t buffer_size,
+                       rl_config_t const *const config);
+
 /**
  * Global calibration data structure.
  */
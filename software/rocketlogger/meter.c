@@ -76,8 +76,8 @@ void meter_print_buffer(int32_t const *analog_buffer,
 
     // process data buffers
     for (size_t i = 0; i < buffer_size; i++) {
-        // point to sample buffer
-        int32_t const *const analog_data = analog_buffer + i * RL_CHANNEL_COUNT;
+        // point to sample buffer (channels buffer_size apart)
+        int32_t const *const analog_data = analog_buffer + i;
         uint32_t const *const digital_data = digital_buffer + i;
 
         // aggregate data
@@ -86,7 +86,7 @@ void meter_print_buffer(int32_t const *analog_buffer,
             // use first sample of buffer only, skip storing others
             if (i == 0) {
                 for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
-                    aggregate_analog[j] = (double)analog_data[j];
+                    aggregate_analog[j] = (double)analog_data[j * buffer_size];
                 }
                 aggregate_digital = *digital_data;
             }
@@ -96,7 +96,7 @@ void meter_print_buffer(int32_t const *analog_buffer,
         case RL_AGGREGATION_MODE_AVERAGE:
             // accumulate data of the aggregate window, store at the end
             for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
-                aggregate_analog[j] += (double)*(analog_data + j);
+                aggregate_analog[j] += (double)analog_data[j * buffer_size];
             }
             aggregate_digital = aggregate_digital & *digital_data;
             break;
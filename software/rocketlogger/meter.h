@@ -51,7 +51,7 @@ void meter_deinit(void);
 /**
  * Print data buffer in interactive console window.
  *
- * @param analog_buffer Analog data buffer to process
+ * @param analog_buffer Analog data buffer to process (channel-major)
  * @param digital_buffer Digital data buffer to process
  * @param buffer_size Number of samples in the buffer
  * @param timestamp_realtime Timestamp sampled from realtime clock
@@ -37,6 +37,7 @@
 #include <string.h>
 
 #include <linux/limits.h>
+#include <pthread.h>
 #include <pruss_intc_mapping.h>
 #include <prussdrv.h>
 #include <sys/types.h>
@@ -45,40 +46,373 @@
 #include "calibration.h"
 #include "log.h"
 #include "meter.h"
+#include "pru_ring.h"
+#include "pru_sim.h"
 #include "rl.h"
 #include "rl_file.h"
+#include "rl_pipeline.h"
+#include "rl_rt.h"
+#include "rl_shm.h"
 #include "rl_socket.h"
+#include "rl_summary.h"
+#include "rl_writer.h"
 #include "sem.h"
 #include "sensor/sensor.h"
 #include "util.h"
 
 #include "pru.h"
 
-int pru_init(void) {
-    tpruss_intc_initdata pruss_intc_initdata = PRUSS_INTC_INITDATA;
+/**
+ * Measurement file part opened ahead of time for splitting files.
+ */
+struct pru_sample_file_part {
+    /// Current measurement configuration
+    rl_config_t const *config;
+    /// Index of the file part
+    uint32_t index;
+    /// Result of opening the file part
+    int result;
+    /// Data file of the part
+    FILE *data_file;
+    /// Ambient file of the part
+    FILE *ambient_file;
+    /// Data block index file of the part (NULL if not available)
+    FILE *index_file;
+    /// Data file header of the part
+    rl_file_header_t data_file_header;
+    /// Ambient file header of the part
+    rl_file_header_t ambient_file_header;
+    /// Data file of the part for the asynchronous writer
+    rl_writer_file_t data_writer_file;
+    /// Ambient file of the part for the asynchronous writer
+    rl_writer_file_t ambient_writer_file;
+    /// Data file offset after the header
+    uint64_t data_file_offset;
+    /// Ambient file offset after the header
+    uint64_t ambient_file_offset;
+    /// Data file name of the part
+    char data_file_name[PATH_MAX];
+    /// Ambient file name of the part
+    char ambient_file_name[PATH_MAX];
+};
 
-    // initialize and open PRU device
-    prussdrv_init();
-    int ret = prussdrv_open(PRU_EVTOUT_0);
-    if (ret != 0) {
-        rl_log(RL_LOG_ERROR, "failed to open PRUSS driver");
-        return ERROR;
-    }
+/**
+ * Typedef for a measurement file part opened ahead of time.
+ */
+typedef struct pru_sample_file_part pru_sample_file_part_t;
 
-    // setup PRU interrupt mapping
-    prussdrv_pruintc_init(&pruss_intc_initdata);
+/**
+ * Data processing context of a sampling run, shared by the data handlers.
+ */
+struct pru_sample_context {
+    /// Current measurement configuration
+    rl_config_t const *config;
+    /// Number of samples aggregated to a single output sample
+    uint32_t aggregates;
+    /// Current data file
+    FILE *data_file;
+    /// Current ambient file
+    FILE *ambient_file;
+    /// Current data block index file (NULL if not available)
+    FILE *index_file;
+    /// Summary of the measurement (summary file is NULL if not available)
+    rl_summary_t summary;
+    /// Data file header
+    rl_file_header_t data_file_header;
+    /// Ambient file header
+    rl_file_header_t ambient_file_header;
+    /// Number of data files stored
+    uint32_t num_files;
+    /// Disk use rate in bytes per second, fixed for the measurement
+    uint32_t disk_use_rate;
+    /// Monotonic time in seconds of the last file header update
+    int64_t header_update_time;
+    /// Data file position at the last file header update
+    uint64_t header_update_offset;
+    /// Next file part, opened in background when splitting files
+    pru_sample_file_part_t next_part;
+    /// Thread opening the next file part
+    pthread_t part_thread;
+    /// Whether the thread opening the next file part was started
+    bool part_thread_started;
+    /// Whether files are written using the asynchronous writer
+    bool writer_enable;
+    /// Asynchronous file writer
+    rl_writer_t writer;
+    /// Data file for the asynchronous writer
+    rl_writer_file_t data_writer_file;
+    /// Ambient file for the asynchronous writer
+    rl_writer_file_t ambient_writer_file;
+    /// Data file offset of the next asynchronous write
+    uint64_t data_file_offset;
+    /// Ambient file offset of the next asynchronous write
+    uint64_t ambient_file_offset;
+    /// Whether web data processing was disabled after a failure
+    bool web_failure_disable;
+};
 
-    return SUCCESS;
-}
+/**
+ * Typedef for the data processing context of a sampling run.
+ */
+typedef struct pru_sample_context pru_sample_context_t;
 
-void pru_deinit(void) {
-    // disable PRU and close memory mappings
-    prussdrv_pru_disable(0);
-    prussdrv_exit();
+/**
+ * Initialize the PRU driver and enable PRU interrupts.
+ *
+ * @param config Current measurement configuration
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int pru_prussdrv_init(rl_config_t const *const config);
+
+/**
+ * Halt the PRU and deinitialize the PRU driver.
+ */
+static void pru_prussdrv_deinit(void);
+
+/**
+ * Map the PRU external shared memory reserved by the uio_pruss driver.
+ *
+ * @param address Pointer to store the physical address of the memory to
+ * @param size Pointer to store the size of the memory to
+ * @return User space address of the mapped memory
+ */
+static void *pru_prussdrv_map_memory(uint32_t *const address,
+                                     uint32_t *const size);
+
+/**
+ * Write PRU control structure to the PRU memory and run the PRU firmware.
+ *
+ * @param pru_control The PRU control structure to write
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int pru_prussdrv_start(pru_control_t const *const pru_control);
+
+/**
+ * Write a new state to the PRU memory.
+ *
+ * @param state The PRU state to write
+ * @return Returns number of bytes written, negative on failure
+ */
+static int pru_prussdrv_set_state(pru_state_t state);
+
+/**
+ * Wait for PRU event.
+ *
+ * @param timeout_us Time out in microseconds
+ * @return Returns 0 on timeout, negative on failure with errno set accordingly
+ */
+static int pru_prussdrv_wait_event(uint32_t timeout_us);
+
+/**
+ * Clear PRU event.
+ */
+static void pru_prussdrv_clear_event(void);
+
+/**
+ * Release a buffer to the PRU (no-op, the PRU does not wait for the reader).
+ *
+ * @param index The buffer index to release
+ */
+static void pru_prussdrv_release_buffer(uint32_t index);
+
+/**
+ * PRU acquisition backend using the PRU and ADC hardware.
+ */
+static pru_backend_t const pru_prussdrv_backend = {
+    .name = "pru",
+    .init = pru_prussdrv_init,
+    .deinit = pru_prussdrv_deinit,
+    .map_memory = pru_prussdrv_map_memory,
+    .start = pru_prussdrv_start,
+    .set_state = pru_prussdrv_set_state,
+    .wait_event = pru_prussdrv_wait_event,
+    .clear_event = pru_prussdrv_clear_event,
+    .release_buffer = pru_prussdrv_release_buffer,
+};
+
+/// The acquisition backend in use
+static pru_backend_t const *pru_backend = &pru_prussdrv_backend;
+
+/**
+ * Initialize and start the processing pipeline with the enabled consumers.
+ *
+ * @param pipeline The pipeline to initialize
+ * @param context The data processing context passed to the data handlers
+ * @param buffer_length Maximum number of samples per buffer
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int pru_sample_pipeline_init(rl_pipeline_t *const pipeline,
+                                    pru_sample_context_t *const context,
+                                    uint32_t buffer_length);
+
+/**
+ * Store a data buffer to the data and ambient files.
+ *
+ * Splits the measurement into a new file part when reaching the maximum file
+ * size.
+ *
+ * @param buffer The data buffer to store
+ * @param context The data processing context
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int pru_sample_handle_file(rl_pipeline_buffer_t const *const buffer,
+                                  void *const context);
+
+/**
+ * Get the current data file size, including pending asynchronous writes.
+ *
+ * @param context The data processing context
+ * @return The data file size in bytes
+ */
+static uint64_t
+pru_sample_get_file_size(pru_sample_context_t const *const context);
+
+/**
+ * Update a binary file header lead-in with the current counts, using the
+ * asynchronous writer if enabled.
+ *
+ * @param context The data processing context
+ * @param file The file to update
+ * @param writer_file The file to update for the asynchronous writer
+ * @param file_header The file header with the current counts
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int pru_sample_update_header_bin(
+    pru_sample_context_t *const context, FILE *file,
+    rl_writer_file_t const *const writer_file,
+    rl_file_header_t const *const file_header);
+
+/**
+ * Initialize the asynchronous writer and set up the current files for it.
+ *
+ * @param context The data processing context
+ * @param buffer_length Number of data samples per buffer
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int pru_sample_writer_init(pru_sample_context_t *const context,
+                                  uint32_t buffer_length);
+
+/**
+ * Wait for pending writes and deinitialize the asynchronous writer.
+ *
+ * @param context The data processing context
+ */
+static void pru_sample_writer_deinit(pru_sample_context_t *const context);
+
+/**
+ * Open the data block index file of a binary data file and store its header.
+ *
+ * Failing to open the index file is not critical, the data is stored without
+ * index in that case.
+ *
+ * @param data_file_name The name of the data file to index
+ * @param data_file_header The header of the data file to index
+ * @return The opened index file, NULL if not available
+ */
+static FILE *
+pru_sample_open_index_file(char const *const data_file_name,
+                           rl_file_header_t const *const data_file_header);
+
+/**
+ * Update the file headers with the final counts and remove the checkpoint
+ * record, before closing the files.
+ *
+ * @param context The data processing context
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int pru_sample_finish_file(pru_sample_context_t *const context);
+
+/**
+ * Open the summary file of the measurement and initialize the summary.
+ *
+ * Failures are not critical, the measurement continues without summary.
+ *
+ * @param context The data processing context of the sampling run
+ */
+static void pru_sample_open_summary(pru_sample_context_t *const context);
+
+/**
+ * Open the files of a measurement file part, preallocate the data file and
+ * store the file headers.
+ *
+ * @param file_part The file part to open
+ * @return Always NULL, the result is stored in the file part
+ */
+static void *pru_sample_open_file_part(void *const file_part);
+
+/**
+ * Start opening the next measurement file part in background.
+ *
+ * @param context The data processing context
+ */
+static void pru_sample_prepare_file_part(pru_sample_context_t *const context);
+
+/**
+ * Finish the current measurement files and continue with the next file part,
+ * then start preparing the following one.
+ *
+ * @param context The data processing context
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int pru_sample_switch_file_part(pru_sample_context_t *const context);
+
+/**
+ * Close and remove the unused next measurement file part.
+ *
+ * @param context The data processing context
+ */
+static void pru_sample_discard_file_part(pru_sample_context_t *const context);
+
+/**
+ * Close and remove the files of the opened next measurement file part.
+ *
+ * @param context The data processing context
+ */
+static void pru_sample_remove_file_part(pru_sample_context_t *const context);
+
+/**
+ * Publish a data buffer to the web interface data stream.
+ *
+ * Disables further publishing on failure, without reporting an error.
+ *
+ * @param buffer The data buffer to publish
+ * @param context The data processing context
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int pru_sample_handle_web(rl_pipeline_buffer_t const *const buffer,
+                                 void *const context);
+
+/**
+ * Print a data buffer to the interactive meter display.
+ *
+ * @param buffer The data buffer to display
+ * @param context The data processing context
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int pru_sample_handle_meter(rl_pipeline_buffer_t const *const buffer,
+                                   void *const context);
+
+int pru_init(rl_config_t const *const config) {
+    // select acquisition backend
+    switch (config->backend) {
+    case RL_BACKEND_SIMULATION:
+        pru_backend = &pru_sim_backend;
+        break;
+    case RL_BACKEND_PRU:
+    default:
+        pru_backend = &pru_prussdrv_backend;
+        break;
+    }
+    rl_log(RL_LOG_VERBOSE, "using '%s' acquisition backend", pru_backend->name);
+
+    return pru_backend->init(config);
 }
 
+void pru_deinit(void) { pru_backend->deinit(); }
+
 int pru_control_init(pru_control_t *const pru_control,
-                     rl_config_t const *const config, uint32_t aggregates) {
+                     rl_config_t const *const config, uint32_t aggregates,
+                     uint32_t buffer_count) {
     // zero aggregates value is also considered no aggregation
     if (aggregates == 0) {
         aggregates = 1;
@@ -102,30 +436,36 @@ int pru_control_init(pru_control_t *const pru_control,
     pru_control->sample_limit = config->sample_limit * aggregates;
     pru_control->buffer_length =
         1000 * pru_control->sample_rate / config->update_rate;
-
-    // get shared buffer addresses
-    uint32_t buffer_size_bytes =
+    pru_control->buffer_size =
         pru_control->buffer_length *
             (PRU_SAMPLE_SIZE * RL_CHANNEL_COUNT + PRU_DIGITAL_SIZE) +
         PRU_BUFFER_STATUS_SIZE;
 
-    void *pru_extmem_base;
-    prussdrv_map_extmem(&pru_extmem_base);
-    uint32_t pru_extmem_phys =
-        (uint32_t)prussdrv_get_phys_addr(pru_extmem_base);
-    pru_control->buffer0_addr = pru_extmem_phys;
-    pru_control->buffer1_addr = pru_extmem_phys + buffer_size_bytes;
+    // limit number of ring buffers to the available PRU memory
+    uint32_t pru_memory_address;
+    uint32_t pru_memory_size;
+    pru_backend->map_memory(&pru_memory_address, &pru_memory_size);
+    if (buffer_count > pru_memory_size / pru_control->buffer_size) {
+        buffer_count = pru_memory_size / pru_control->buffer_size;
+    }
+    if (buffer_count < PRU_BUFFER_COUNT_MIN) {
+        rl_log(RL_LOG_ERROR,
+               "insufficient PRU memory allocated/available.\n"
+               "update uio_pruss configuration:"
+               "options uio_pruss extram_pool_sz=0x%06x",
+               PRU_BUFFER_COUNT_MIN * pru_control->buffer_size);
+        errno = ENOMEM;
+        return ERROR;
+    }
+    pru_control->buffer_count = buffer_count;
+
+    // get shared buffer ring address
+    pru_control->buffer_addr = pru_memory_address;
 
     return SUCCESS;
 }
 
-int pru_set_state(pru_state_t state) {
-    int res = prussdrv_pru_write_memory(PRUSS0_PRU0_DATARAM, 0,
-                                        (unsigned int *)&state, sizeof(state));
-    // PRU memory write fence
-    __sync_synchronize();
-    return res;
-}
+int pru_set_state(pru_state_t state) { return pru_backend->set_state(state); }
 
 int pru_sample(FILE *data_file, FILE *ambient_file,
                rl_config_t const *const config) {
@@ -141,54 +481,88 @@ int pru_sample(FILE *data_file, FILE *ambient_file,
 
     // initialize PRU data structure
     pru_control_t pru;
-    res = pru_control_init(&pru, config, aggregates);
+    res = pru_control_init(&pru, config, aggregates, PRU_BUFFER_COUNT_MAX);
     if (res != SUCCESS) {
         rl_log(RL_LOG_ERROR, "failed initializing PRU data structure");
         return ERROR;
     }
 
-    // check max PRU buffer size
-    uint32_t pru_extmem_size = (uint32_t)prussdrv_extmem_size();
-    uint32_t pru_extmem_size_demand =
-        2 * (pru.buffer_length *
-                 (PRU_SAMPLE_SIZE * RL_CHANNEL_COUNT + PRU_DIGITAL_SIZE) +
-             PRU_BUFFER_STATUS_SIZE);
-    if (pru_extmem_size_demand > pru_extmem_size) {
-        rl_log(RL_LOG_ERROR,
-               "insufficient PRU memory allocated/available.\n"
-               "update uio_pruss configuration:"
-               "options uio_pruss extram_pool_sz=0x%06x",
-               pru_extmem_size_demand);
-        pru.state = PRU_STATE_OFF;
-    }
-
-    // get user space mapped PRU memory addresses
-    void const *buffer0 = prussdrv_get_virt_addr(pru.buffer0_addr);
-    void const *buffer1 = prussdrv_get_virt_addr(pru.buffer1_addr);
-
-    // data file headers
-    rl_file_header_t data_file_header;
-    rl_file_header_t ambient_file_header;
+    // get user space mapped PRU buffer ring
+    uint32_t pru_memory_address;
+    uint32_t pru_memory_size;
+    pru_ring_t pru_ring;
+    void *pru_memory =
+        pru_backend->map_memory(&pru_memory_address, &pru_memory_size);
+    pru_ring_init(&pru_ring, pru_memory, &pru);
+    rl_log(RL_LOG_INFO, "using PRU buffer ring of %u buffers with %u samples",
+           pru.buffer_count, pru.buffer_length);
+
+    // data processing context shared by the data handlers
+    pru_sample_context_t context = {
+        .config = config,
+        .aggregates = aggregates,
+        .data_file = data_file,
+        .ambient_file = ambient_file,
+        .index_file = NULL,
+        .summary = {.file = NULL},
+        .num_files = 1,
+        .disk_use_rate = rl_status.disk_use_rate,
+        .header_update_time = 0,
+        .header_update_offset = 0,
+        .part_thread_started = false,
+        .writer_enable = false,
+        .data_writer_file = {-1, -1},
+        .ambient_writer_file = {-1, -1},
+        .data_file_offset = 0,
+        .ambient_file_offset = 0,
+        .web_failure_disable = false,
+    };
 
     // DATA FILE STORING
     if (config->file_enable) {
 
         // data file header lead-in
-        rl_file_setup_data_lead_in(&(data_file_header.lead_in), config);
+        rl_file_setup_data_lead_in(&(context.data_file_header.lead_in),
+                                   config);
 
         // allocate channel info array
-        int total_channel_count = data_file_header.lead_in.channel_bin_count +
-                                  data_file_header.lead_in.channel_count;
-        data_file_header.channel = malloc(total_channel_count * sizeof(rl_file_channel_t));
+        int total_channel_count =
+            context.data_file_header.lead_in.channel_bin_count +
+            context.data_file_header.lead_in.channel_count;
+        context.data_file_header.channel =
+            malloc(total_channel_count * sizeof(rl_file_channel_t));
 
         // complete file header
-        rl_file_setup_data_header(&data_file_header, config);
+        rl_file_setup_data_header(&context.data_file_header, config);
 
-        // store header
+        // preallocate split file size, failed preallocation is not critical
+        if (config->file_size > 0) {
+            rl_file_preallocate(data_file, config->file_size);
+        }
+
+        // store header, and index header for binary files
         if (config->file_format == RL_FILE_FORMAT_RLD) {
-            rl_file_store_header_bin(data_file, &data_file_header);
+            rl_file_store_header_bin(data_file, &context.data_file_header);
+            context.index_file = pru_sample_open_index_file(
+                config->file_name, &context.data_file_header);
+            pru_sample_open_summary(&context);
         } else if (config->file_format == RL_FILE_FORMAT_CSV) {
-            rl_file_store_header_csv(data_file, &data_file_header);
+            rl_file_store_header_csv(data_file, &context.data_file_header);
+        } else if (config->file_format == RL_FILE_FORMAT_ARROW) {
+            rl_file_store_header_arrow(data_file, &context.data_file_header);
+        }
+
+        // preallocate buffers to assemble, compress, transpose or format
+        // data blocks
+        if (config->file_format != RL_FILE_FORMAT_RLD ||
+            config->file_writer == RL_FILE_WRITER_STDIO ||
+            config->file_compress_enable || config->file_planar_enable) {
+            res = rl_file_block_buffer_init(pru.buffer_length,
+                                            config->file_format);
+            if (res < 0) {
+                free(context.data_file_header.channel);
+                return ERROR;
+            }
         }
 
         // AMBIENT FILE STORING
@@ -196,38 +570,31 @@ int pru_sample(FILE *data_file, FILE *ambient_file,
         // file header lead-in
         if (config->ambient_enable) {
 
-            rl_file_setup_ambient_lead_in(&(ambient_file_header.lead_in),
-                                          config);
+            rl_file_setup_ambient_lead_in(
+                &(context.ambient_file_header.lead_in), config);
 
             // allocate channel array
-            ambient_file_header.channel =
+            context.ambient_file_header.channel =
                 malloc(rl_status.sensor_count * sizeof(rl_file_channel_t));
 
             // complete file header
-            rl_file_setup_ambient_header(&ambient_file_header, config);
+            rl_file_setup_ambient_header(&context.ambient_file_header, config);
 
             // store header
-            rl_file_store_header_bin(ambient_file, &ambient_file_header);
+            rl_file_store_header_bin(ambient_file,
+                                     &context.ambient_file_header);
         }
     }
     // EXECUTION
 
-    // write configuration to PRU memory
-    prussdrv_pru_write_memory(PRUSS0_PRU0_DATARAM, 0, (unsigned int *)&pru,
-                              sizeof(pru));
-
-    // PRU memory write fence
-    __sync_synchronize();
-
-    // run SPI on PRU0
-    res = prussdrv_exec_program(0, PRU_BINARY_FILE);
+    // write configuration to PRU memory and start sampling
+    res = pru_backend->start(&pru);
     if (res < 0) {
-        rl_log(RL_LOG_ERROR, "Failed starting PRU, binary not found");
         return ERROR;
     }
 
     // wait for PRU event (returns 0 on timeout, -1 on error with errno)
-    res = prussdrv_pru_wait_event_timeout(PRU_EVTOUT_0, PRU_TIMEOUT_US);
+    res = pru_backend->wait_event(PRU_TIMEOUT_US);
     if (res < 0) {
         // error checking interrupt occurred
         rl_log(RL_LOG_ERROR, "Failed waiting for PRU interrupt; %d message: %s",
@@ -259,13 +626,46 @@ int pru_sample(FILE *data_file, FILE *ambient_file,
     rl_pid_set(pid);
 
     // clear event
-    prussdrv_pru_clear_event(PRU_EVTOUT_0, PRU0_ARM_INTERRUPT);
+    pru_backend->clear_event();
+
+    // asynchronous file writer (threads are started only after forking)
+    if (config->file_enable && config->file_writer == RL_FILE_WRITER_ASYNC) {
+        res = pru_sample_writer_init(&context, pru.buffer_length);
+        if (res < 0) {
+            rl_log(RL_LOG_ERROR,
+                   "failed initializing file writer; %d message: %s", errno,
+                   strerror(errno));
+            rl_status.error = true;
+            pru_stop();
+            return ERROR;
+        }
+    }
 
     // CHANNEL DATA MEMORY ALLOCATION
-    int32_t *const analog_buffer = (int32_t *)malloc(
-        pru.buffer_length * RL_CHANNEL_COUNT * sizeof(int32_t));
-    uint32_t *const digital_buffer =
-        (uint32_t *)malloc(pru.buffer_length * sizeof(uint32_t));
+    // processing pipeline (threads are started only after potential forking)
+    rl_pipeline_t pipeline;
+    rl_pipeline_buffer_t inline_buffer = {.analog_buffer = NULL,
+                                          .digital_buffer = NULL};
+    if (config->pipeline_enable) {
+        res = pru_sample_pipeline_init(&pipeline, &context, pru.buffer_length);
+        if (res < 0) {
+            rl_log(RL_LOG_ERROR,
+                   "failed initializing processing pipeline; %d message: %s",
+                   errno, strerror(errno));
+            pru_sample_writer_deinit(&context);
+            rl_status.error = true;
+            pru_stop();
+            return ERROR;
+        }
+    }
+    // inline processing buffer, in pipelined mode the scratch buffer for the
+    // shared memory ring when the pipeline is full
+    if (!config->pipeline_enable || config->shm_enable) {
+        inline_buffer.analog_buffer = (int32_t *)malloc(
+            pru.buffer_length * RL_CHANNEL_COUNT * sizeof(int32_t));
+        inline_buffer.digital_buffer =
+            (uint32_t *)malloc(pru.buffer_length * sizeof(uint32_t));
+    }
     int32_t sensor_buffer[SENSOR_REGISTRY_SIZE];
 
     pru_buffer_t const *pru_buffer = NULL;
@@ -274,14 +674,37 @@ int pru_sample(FILE *data_file, FILE *ambient_file,
     uint32_t sensor_rate_counter = 0;
     rl_timestamp_t timestamp_monotonic;
     rl_timestamp_t timestamp_realtime;
+    bool timestamp_valid = false;
     uint32_t buffers_lost = 0;
-    uint32_t num_files = 1; // number of files stored
-    bool web_failure_disable = false;
+    uint32_t buffers_dropped = 0;
 
     // buffers to read in finite mode
     uint32_t buffer_read_count =
         div_ceil(config->sample_limit * aggregates, pru.buffer_length);
 
+    // wakeup latency and processing time measurement
+    rl_rt_latency_t latency;
+    rl_rt_latency_init(&latency, config->update_rate);
+    int64_t processing_start = -1;
+
+    // open next split file part in background (after potential forking)
+    if (config->file_enable && config->file_size > 0) {
+        pru_sample_prepare_file_part(&context);
+    }
+
+    // data shared memory ring at native rate, sampling continues without it
+    // on failure
+    bool shm_enable = false;
+    if (config->shm_enable) {
+        res = rl_shm_init(config, config->sample_rate * aggregates,
+                          pru.buffer_length);
+        if (res < 0) {
+            rl_log(RL_LOG_WARNING, "Failed creating shared data memory, "
+                                   "sampling without it");
+        }
+        shm_enable = (res == SUCCESS);
+    }
+
     // sampling started
     rl_status.sampling = true;
     res = rl_status_write(&rl_status);
@@ -290,115 +713,25 @@ int pru_sample(FILE *data_file, FILE *ambient_file,
                strerror(errno));
     }
 
+    // real-time profile: publish status in background, then raise priority
+    if (config->realtime_enable) {
+        res = rl_status_pub_async_start(&rl_status);
+        if (res < 0) {
+            rl_log(RL_LOG_WARNING, "Failed starting background status "
+                                   "publishing, publishing inline");
+        }
+        res = rl_rt_init();
+        if (res < 0) {
+            rl_log(RL_LOG_WARNING, "Failed applying real-time profile, "
+                                   "sampling without it");
+        }
+    }
+
     // continuous sampling loop
     for (uint32_t i = 0; rl_status.sampling &&
                          !(config->sample_limit > 0 && i >= buffer_read_count);
          i++) {
 
-        if (config->file_enable) {
-
-            // check if max file size reached
-            uint64_t file_size = (uint64_t)ftello(data_file);
-            if (config->file_size > 0 &&
-                file_size + rl_status.disk_use_rate > config->file_size) {
-
-                // close old data file
-                fclose(data_file);
-
-                // determine new file name
-                char file_name[PATH_MAX];
-                char new_file_ending[PATH_MAX];
-                strcpy(file_name, config->file_name);
-
-                // search for last .
-                char target = '.';
-                char *file_ending = file_name;
-                while (strchr(file_ending, target) != NULL) {
-                    file_ending = strchr(file_ending, target);
-                    file_ending++; // Increment file_ending, otherwise we'll
-                                   // find target at the same location
-                }
-                file_ending--;
-
-                // add file number
-                sprintf(new_file_ending, "_p%d", num_files);
-                strcat(new_file_ending, file_ending);
-                strcpy(file_ending, new_file_ending);
-
-                // open new data file
-                data_file = fopen64(file_name, "w+");
-
-                // update header for new file
-                data_file_header.lead_in.data_block_count = 0;
-                data_file_header.lead_in.sample_count = 0;
-
-                // store header
-                if (config->file_format == RL_FILE_FORMAT_RLD) {
-                    rl_file_store_header_bin(data_file, &data_file_header);
-                } else if (config->file_format == RL_FILE_FORMAT_CSV) {
-                    rl_file_store_header_csv(data_file, &data_file_header);
-                }
-
-                rl_log(RL_LOG_INFO, "Creating new data file: %s", file_name);
-
-                // AMBIENT FILE
-                if (config->ambient_enable) {
-                    // close old ambient file
-                    fclose(ambient_file);
-
-                    // determine new file name
-                    char *ambient_file_name =
-                        rl_file_get_ambient_file_name(config->file_name);
-                    strcpy(file_name, ambient_file_name);
-
-                    // search for last .
-                    file_ending = file_name;
-                    while (strchr(file_ending, target) != NULL) {
-                        file_ending = strchr(file_ending, target);
-                        file_ending++; // Increment file_ending, otherwise we'll
-                                       // find target at the same location
-                    }
-                    file_ending--;
-
-                    // add file number
-                    sprintf(new_file_ending, "_p%d", num_files);
-                    strcat(new_file_ending, file_ending);
-                    strcpy(file_ending, new_file_ending);
-
-                    // open new ambient file
-                    ambient_file = fopen64(file_name, "w+");
-
-                    // update header for new file
-                    ambient_file_header.lead_in.data_block_count = 0;
-                    ambient_file_header.lead_in.sample_count = 0;
-
-                    // store header
-                    rl_file_store_header_bin(ambient_file,
-                                             &ambient_file_header);
-
-                    rl_log(RL_LOG_INFO, "new ambient-file: %s", file_name);
-                }
-
-                num_files++;
-            }
-        }
-
-        // select current buffer
-        if (i % 2 == 0) {
-            pru_buffer = buffer0;
-        } else {
-            pru_buffer = buffer1;
-        }
-
-        // select buffer size, repecting non-full last buffer
-        if (i < buffer_read_count - 1 ||
-            pru.sample_limit % pru.buffer_length == 0) {
-            buffer_size = (size_t)pru.buffer_length;
-        } else {
-            // last buffer is not fully used
-            buffer_size = (size_t)(pru.sample_limit % pru.buffer_length);
-        }
-
         // trigger new ambient sensor read out if enabled
         sensor_buffer_size = 0;
         if (config->ambient_enable) {
@@ -414,165 +747,237 @@ int pru_sample(FILE *data_file, FILE *ambient_file,
                 config->update_rate;
         }
 
-        // wait for PRU event indicating new data (repeat wait on interrupts)
-        do {
+        // processing of the previous buffer completed
+        if (processing_start >= 0) {
+            rl_rt_histogram_add(rl_status.processing_time_histogram,
+                                &rl_status.processing_time_max,
+                                rl_rt_time_ns() - processing_start);
+        }
+
+        // wait for PRU to complete the current buffer, skipping overwritten
+        uint32_t const buffer_index = i;
+        uint32_t const buffers_lost_previous = buffers_lost;
+        bool buffer_waited = false;
+        int64_t wakeup_time = 0;
+        int event_res = 1;
+        while ((pru_buffer = pru_ring_check(&pru_ring, &i, &buffers_lost)) ==
+               NULL) {
             // wait for PRU event (returns 0 on timeout, -1 on error with errno)
-            res = prussdrv_pru_wait_event_timeout(PRU_EVTOUT_0, PRU_TIMEOUT_US);
+            event_res = pru_backend->wait_event(PRU_TIMEOUT_US);
+            if (event_res < 0 && errno == EINTR) {
+                continue;
+            } else if (event_res <= 0) {
+                break;
+            }
             // timestamp received data
+            wakeup_time = rl_rt_time_ns();
             create_time_stamp(&timestamp_realtime, &timestamp_monotonic);
-        } while (res < 0 && errno == EINTR);
-        if (res < 0) {
+            buffer_waited = true;
+
+            // clear event
+            pru_backend->clear_event();
+        }
+        if (event_res < 0) {
             // error checking interrupt occurred
             rl_log(RL_LOG_ERROR,
                    "Failed waiting for PRU interrupt; %d message: %s", errno,
                    strerror(errno));
             rl_status.error = true;
             break;
-        } else if (res == 0) {
+        } else if (event_res == 0) {
             // low level ADC timeout occurred
             rl_log(RL_LOG_ERROR, "ADC not responsive");
             rl_status.error = true;
             break;
         }
 
-        // adjust data timestamps with buffer latency (adjusted relative
-        // nanoseconds)
-        timestamp_realtime.nsec -= (int64_t)2048e3 * 490 / config->update_rate;
-        if (timestamp_realtime.nsec < 0) {
-            timestamp_realtime.sec -= 1;
-            timestamp_realtime.nsec += (int64_t)1e9;
-        }
-        timestamp_monotonic.nsec -= (int64_t)2048e3 * 490 / config->update_rate;
-        if (timestamp_monotonic.nsec < 0) {
-            timestamp_monotonic.sec -= 1;
-            timestamp_monotonic.nsec += (int64_t)1e9;
+        // buffers completed before waiting have no wakeup latency
+        if (buffer_waited) {
+            rl_rt_histogram_add(rl_status.wakeup_latency_histogram,
+                                &rl_status.wakeup_latency_max,
+                                rl_rt_latency_update(&latency, i, wakeup_time));
+            processing_start = wakeup_time;
+        } else {
+            processing_start = rl_rt_time_ns();
         }
 
-        // clear event
-        prussdrv_pru_clear_event(PRU_EVTOUT_0, PRU0_ARM_INTERRUPT);
-
-        // PRU memory sync before accessing data
-        __sync_synchronize();
-
-        // check for overrun (compare buffer numbers)
-        if (pru_buffer->index != i) {
-            buffers_lost += (pru_buffer->index - i);
+        // report buffers overwritten by the PRU before processing
+        if (buffers_lost != buffers_lost_previous) {
             rl_log(RL_LOG_WARNING,
                    "overrun: %d samples (%d buffer) lost (%d in total)",
-                   (pru_buffer->index - i) * pru.buffer_length,
-                   pru_buffer->index - i, buffers_lost);
-            i = pru_buffer->index;
+                   (i - buffer_index) * pru.buffer_length, i - buffer_index,
+                   buffers_lost);
         }
 
-        // process new data: copy data and apply calibration
-        for (size_t i = 0; i < buffer_size; i++) {
-            // get PRU data buffer pointer
-            pru_data_t const *const pru_data = &(pru_buffer->data[i]);
-
-            // get local data buffer pointers
-            int32_t *const analog_data = analog_buffer + i * RL_CHANNEL_COUNT;
-            uint32_t *const digital_data = digital_buffer + i;
-
-            // copy digital channel data
-            *digital_data = pru_data->channel_digital;
-
-            // copy and calibrate analog channel data
-            for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
-                analog_data[j] = (int32_t)((pru_data->channel_analog[j] +
-                                            rl_calibration.offsets[j]) *
-                                           rl_calibration.scales[j]);
+        if (buffer_waited || !timestamp_valid) {
+            if (!buffer_waited) {
+                create_time_stamp(&timestamp_realtime, &timestamp_monotonic);
             }
+            // adjust data timestamps with buffer latency
+            add_time_stamp_offset(&timestamp_realtime,
+                                  -(int64_t)2048e3 * 490 / config->update_rate);
+            add_time_stamp_offset(&timestamp_monotonic,
+                                  -(int64_t)2048e3 * 490 / config->update_rate);
+        } else {
+            // buffer completed before waiting, extrapolate the timestamps
+            // of the previous buffer by the elapsed buffer periods
+            int64_t const buffer_offset =
+                (int64_t)(i - buffer_index + 1) * (int64_t)1e9 /
+                config->update_rate;
+            add_time_stamp_offset(&timestamp_realtime, buffer_offset);
+            add_time_stamp_offset(&timestamp_monotonic, buffer_offset);
         }
+        timestamp_valid = true;
 
-        // update and write state
-        rl_status.sample_count += buffer_size / aggregates;
-        rl_status.buffer_count = i + 1 - buffers_lost;
-        res = rl_status_write(&rl_status);
-        if (res < 0) {
-            rl_log(RL_LOG_WARNING, "Failed writing status; %d message: %s",
-                   errno, strerror(errno));
-        }
-
-        // process data for web when enabled
-        if (config->web_enable && !web_failure_disable) {
-            res = rl_socket_handle_data(analog_buffer, digital_buffer,
-                                        sensor_buffer, buffer_size,
-                                        sensor_buffer_size, &timestamp_realtime,
-                                        &timestamp_monotonic, config);
-            if (res < 0) {
-                // disable web interface on failure, but continue sampling
-                web_failure_disable = true;
-                rl_log(RL_LOG_WARNING,
-                       "Web server connection failed; %d message: %s", errno,
-                       strerror(errno));
-                rl_log(RL_LOG_INFO,
-                       "Disabling web interface and continue sampling.");
-            }
+        // select buffer size, repecting non-full last buffer
+        if (i < buffer_read_count - 1 ||
+            pru.sample_limit % pru.buffer_length == 0) {
+            buffer_size = (size_t)pru.buffer_length;
+        } else {
+            // last buffer is not fully used
+            buffer_size = (size_t)(pru.sample_limit % pru.buffer_length);
         }
 
-        // update and write header
-        if (config->file_enable) {
-            // write the data buffer to file
-            int block_count = rl_file_add_data_block(
-                data_file, analog_buffer, digital_buffer, buffer_size,
-                &timestamp_realtime, &timestamp_monotonic, config);
-
-            // stop sampling on file error
-            if (block_count < 0) {
-                rl_log(RL_LOG_ERROR,
-                       "Adding data block to data file failed; %d message: %s",
-                       errno, strerror(errno));
+        // get buffer to process the data to
+        rl_pipeline_buffer_t *buffer = &inline_buffer;
+        if (config->pipeline_enable) {
+            // stop sampling if any of the data consumers failed
+            if (rl_pipeline_has_error(&pipeline)) {
+                rl_log(RL_LOG_ERROR, "Processing pipeline data consumer "
+                                     "failed, stopping sampling");
                 rl_status.error = true;
                 break;
             }
 
-            // update and store data file header
-            data_file_header.lead_in.data_block_count += block_count;
-            data_file_header.lead_in.sample_count +=
-                block_count * (buffer_size / aggregates);
-
-            if (config->file_format == RL_FILE_FORMAT_RLD) {
-                rl_file_update_header_bin(data_file, &data_file_header);
-            } else if (config->file_format == RL_FILE_FORMAT_CSV) {
-                rl_file_update_header_csv(data_file, &data_file_header);
+            buffer = rl_pipeline_acquire(&pipeline);
+            if (buffer == NULL) {
+                rl_log(RL_LOG_WARNING,
+                       "processing pipeline full: buffer %u dropped", i);
             }
         }
 
-        // handle ambient data if enabled and available
-        if (config->ambient_enable && sensor_buffer_size > 0) {
-            // fetch and write data
-            int block_count = rl_file_add_ambient_block(
-                ambient_file, sensor_buffer, sensor_buffer_size,
-                &timestamp_realtime, &timestamp_monotonic, config);
-
-            // stop sampling on file error
-            if (block_count < 0) {
-                rl_log(
-                    RL_LOG_ERROR,
-                    "Adding data block to ambient file failed; %d message: %s",
-                    errno, strerror(errno));
-                rl_status.error = true;
-                break;
-            }
-
-            // update and write header
-            ambient_file_header.lead_in.data_block_count += block_count;
-            ambient_file_header.lead_in.sample_count +=
-                block_count * RL_FILE_AMBIENT_DATA_BLOCK_SIZE;
-            rl_file_update_header_bin(ambient_file, &ambient_file_header);
+        if (buffer != NULL) {
+            buffer->index = i;
+            buffer->samples_lost =
+                (uint64_t)buffers_lost * pru.buffer_length / aggregates;
+            buffer->buffer_size = buffer_size;
+            buffer->sensor_buffer_size = sensor_buffer_size;
+            buffer->timestamp_realtime = timestamp_realtime;
+            buffer->timestamp_monotonic = timestamp_monotonic;
+            memcpy(buffer->sensor_buffer, sensor_buffer,
+                   sensor_buffer_size * sizeof(int32_t));
+        }
+
+        // process new data: copy data and apply calibration, the shared
+        // memory ring is written even if the pipeline is full
+        rl_pipeline_buffer_t *calibrated_buffer = buffer;
+        if (calibrated_buffer == NULL && shm_enable) {
+            calibrated_buffer = &inline_buffer;
+        }
+        if (calibrated_buffer != NULL) {
+            calibration_apply(calibrated_buffer->analog_buffer,
+                              calibrated_buffer->digital_buffer,
+                              pru_buffer->data, buffer_size, config);
+        }
+
+        // release PRU buffer, drop data if overwritten during processing
+        res = pru_ring_validate(&pru_ring, i);
+        pru_backend->release_buffer(i);
+        if (res < 0) {
+            buffers_lost++;
+            rl_log(RL_LOG_WARNING,
+                   "overrun: buffer %u overwritten while processing (%d "
+                   "buffers lost in total)",
+                   i, buffers_lost);
+            continue;
+        }
+
+        // write calibrated data to the shared memory ring for local readers
+        if (shm_enable) {
+            rl_shm_write(calibrated_buffer->analog_buffer,
+                         calibrated_buffer->digital_buffer, buffer_size, i,
+                         (uint64_t)buffers_lost * pru.buffer_length,
+                         &timestamp_realtime, &timestamp_monotonic);
+        }
+
+        // update and write state, buffers dropped by the pipeline are not
+        // processed by any consumer
+        if (buffer != NULL) {
+            rl_status.sample_count += buffer_size / aggregates;
+        } else {
+            buffers_dropped++;
+        }
+        rl_status.buffer_count = i + 1 - buffers_lost - buffers_dropped;
+        if (config->pipeline_enable) {
+            rl_pipeline_update_status(&pipeline, &rl_status);
+        }
+        if (context.writer_enable) {
+            rl_writer_update_status(&context.writer, &rl_status);
+        }
+        if (config->web_enable) {
+            rl_socket_update_status(&rl_status);
+        }
+        res = rl_status_update(&rl_status);
+        if (res < 0) {
+            rl_log(RL_LOG_WARNING, "Failed writing status; %d message: %s",
+                   errno, strerror(errno));
+        }
+
+        // hand over data to the consumer threads in pipelined mode
+        if (config->pipeline_enable) {
+            if (buffer != NULL) {
+                rl_pipeline_publish(&pipeline);
+            }
+            continue;
+        }
+
+        // process data for web when enabled
+        if (config->web_enable) {
+            pru_sample_handle_web(buffer, &context);
+        }
+
+        // store data to file when enabled, stop sampling on file error
+        if (config->file_enable) {
+            res = pru_sample_handle_file(buffer, &context);
+            if (res < 0) {
+                rl_status.error = true;
+                break;
+            }
         }
 
         // print meter output if enabled
         if (config->interactive_enable) {
-            meter_print_buffer(analog_buffer, digital_buffer, buffer_size,
-                               &timestamp_realtime, &timestamp_monotonic,
-                               config);
+            pru_sample_handle_meter(buffer, &context);
         }
     }
 
+    // leave real-time profile before waiting for the pipeline to drain
+    if (config->realtime_enable) {
+        rl_rt_deinit();
+        rl_status_pub_async_stop();
+    }
+
     // stop PRU
     pru_stop();
 
+    // readers detect the stop after reading the remaining blocks
+    if (shm_enable) {
+        rl_shm_deinit();
+    }
+
+    // wait for pending data to be processed and stop pipeline
+    if (config->pipeline_enable) {
+        res = rl_pipeline_stop(&pipeline);
+        if (res < 0) {
+            rl_log(RL_LOG_ERROR, "Processing pipeline data consumer failed");
+            rl_status.error = true;
+        }
+        rl_pipeline_update_status(&pipeline, &rl_status);
+    }
+    if (context.writer_enable) {
+        rl_writer_update_status(&context.writer, &rl_status);
+    }
+
     // sampling stopped, update status
     rl_status.sampling = false;
     res = rl_status_write(&rl_status);
@@ -582,8 +987,11 @@ int pru_sample(FILE *data_file, FILE *ambient_file,
     }
 
     // CLEANUP CHANNEL DATA MEMORY ALLOCATION
-    free(analog_buffer);
-    free(digital_buffer);
+    if (config->pipeline_enable) {
+        rl_pipeline_deinit(&pipeline);
+    }
+    free(inline_buffer.analog_buffer);
+    free(inline_buffer.digital_buffer);
 
     // deinitialize interactive measurement display when enabled
     if (config->interactive_enable) {
@@ -592,14 +1000,42 @@ int pru_sample(FILE *data_file, FILE *ambient_file,
 
     // FILE FINISH (flush)
     if (config->file_enable) {
-        // flush data file and clean up file header
-        fflush(data_file);
-        free(data_file_header.channel);
+        // remove unused split file part and store final headers
+        pru_sample_discard_file_part(&context);
+        res = pru_sample_finish_file(&context);
+        if (res < 0) {
+            rl_log(RL_LOG_ERROR, "Finishing data file failed");
+            rl_status.error = true;
+        }
+        pru_sample_writer_deinit(&context);
+
+        // flush data file and clean up file header and block buffer, split
+        // file parts are closed here and the first part by the caller
+        fflush(context.data_file);
+        if (context.num_files > 1) {
+            fclose(context.data_file);
+        }
+        free(context.data_file_header.channel);
+        rl_file_block_buffer_deinit();
+
+        // close data block index file
+        if (context.index_file != NULL) {
+            fclose(context.index_file);
+        }
+
+        // store the incomplete summary bins and close summary file
+        if (context.summary.file != NULL) {
+            rl_summary_finish(&context.summary);
+            fclose(context.summary.file);
+        }
 
         // flush ambient file and clean up file header
         if (config->ambient_enable) {
-            fflush(ambient_file);
-            free(ambient_file_header.channel);
+            fflush(context.ambient_file);
+            if (context.num_files > 1) {
+                fclose(context.ambient_file);
+            }
+            free(context.ambient_file_header.channel);
         }
 
         if (rl_status.error == false) {
@@ -624,7 +1060,696 @@ void pru_stop(void) {
     // wait for interrupt (if no ERROR occurred) and clear event
     if (!(rl_status.error)) {
         // wait for PRU event (returns 0 on timeout, -1 on error with errno)
-        prussdrv_pru_wait_event_timeout(PRU_EVTOUT_0, PRU_TIMEOUT_US);
-        prussdrv_pru_clear_event(PRU_EVTOUT_0, PRU0_ARM_INTERRUPT);
+        pru_backend->wait_event(PRU_TIMEOUT_US);
+        pru_backend->clear_event();
+    }
+}
+
+static int pru_sample_pipeline_init(rl_pipeline_t *const pipeline,
+                                    pru_sample_context_t *const context,
+                                    uint32_t buffer_length) {
+    rl_config_t const *const config = context->config;
+
+    int res = rl_pipeline_init(pipeline, rl_pipeline_get_buffer_count(config),
+                               buffer_length);
+    if (res < 0) {
+        return ERROR;
+    }
+
+    // file storage needs every buffer, streaming and display only the newest
+    if (config->file_enable) {
+        res = rl_pipeline_add_consumer(pipeline, RL_PIPELINE_CONSUMER_FILE,
+                                       pru_sample_handle_file, context, true);
+    }
+    if (res == SUCCESS && config->web_enable) {
+        res = rl_pipeline_add_consumer(pipeline, RL_PIPELINE_CONSUMER_WEB,
+                                       pru_sample_handle_web, context, false);
+    }
+    if (res == SUCCESS && config->interactive_enable) {
+        res = rl_pipeline_add_consumer(pipeline, RL_PIPELINE_CONSUMER_METER,
+                                       pru_sample_handle_meter, context, false);
+    }
+    if (res == SUCCESS) {
+        res = rl_pipeline_start(pipeline);
+    }
+
+    if (res < 0) {
+        rl_pipeline_deinit(pipeline);
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+static int pru_sample_handle_file(rl_pipeline_buffer_t const *const buffer,
+                                  void *const context) {
+    pru_sample_context_t *const ctx = (pru_sample_context_t *)context;
+    rl_config_t const *const config = ctx->config;
+
+    // switch to next file part when max file size reached
+    uint64_t file_size = pru_sample_get_file_size(ctx);
+    if (config->file_size > 0 &&
+        file_size + ctx->disk_use_rate > config->file_size) {
+        int res = pru_sample_switch_file_part(ctx);
+        if (res < 0) {
+            rl_log(RL_LOG_ERROR, "Switching to new data file failed");
+            return ERROR;
+        }
+    }
+
+    // write the data buffer to file, or encode it for asynchronous writing
+    uint64_t const block_offset = pru_sample_get_file_size(ctx);
+    int block_count = 1;
+    uint8_t *block = NULL;
+    size_t block_length = 0;
+    if (ctx->writer_enable) {
+        block = rl_writer_get_buffer(&ctx->writer, ctx->data_file_offset);
+        block_length = rl_file_encode_data_block(
+            block, buffer->analog_buffer, buffer->digital_buffer,
+            buffer->buffer_size, &buffer->timestamp_realtime,
+            &buffer->timestamp_monotonic, config);
+        if (block_length == 0) {
+            block_count = ERROR;
+        }
+    } else {
+        block_count = rl_file_add_data_block(
+            ctx->data_file, buffer->analog_buffer, buffer->digital_buffer,
+            buffer->buffer_size, &buffer->timestamp_realtime,
+            &buffer->timestamp_monotonic, config);
+    }
+    if (block_count < 0) {
+        rl_log(RL_LOG_ERROR,
+               "Adding data block to data file failed; %d message: %s", errno,
+               strerror(errno));
+        return ERROR;
+    }
+
+    // update data file header counts
+    ctx->data_file_header.lead_in.data_block_count += block_count;
+    ctx->data_file_header.lead_in.sample_count +=
+        block_count * (buffer->buffer_size / ctx->aggregates);
+
+    // index data block, continue without index on failure
+    if (ctx->index_file != NULL) {
+        int res = rl_file_add_index_record(ctx->index_file, block_offset,
+                                           &buffer->timestamp_realtime,
+                                           &buffer->timestamp_monotonic);
+        if (res < 0) {
+            rl_log(RL_LOG_WARNING, "failed indexing data block, continue "
+                                   "without data block index");
+            fclose(ctx->index_file);
+            ctx->index_file = NULL;
+        }
+    }
+
+    // summarize data block, continue without summary on failure
+    if (ctx->summary.file != NULL) {
+        int res = rl_summary_add(&ctx->summary, buffer->analog_buffer,
+                                 buffer->digital_buffer, buffer->buffer_size,
+                                 &buffer->timestamp_realtime);
+        if (res < 0) {
+            rl_log(RL_LOG_WARNING, "failed summarizing data block, continue "
+                                   "without measurement summary");
+            fclose(ctx->summary.file);
+            ctx->summary.file = NULL;
+        }
+    }
+
+    // store header only after update interval or data size threshold, binary
+    // files carry a checkpoint of the current counts after every data block
+    file_size = pru_sample_get_file_size(ctx) + block_length;
+    bool const header_update =
+        (buffer->timestamp_monotonic.sec - ctx->header_update_time >=
+         (int64_t)config->file_header_interval) ||
+        (file_size - ctx->header_update_offset >= RL_FILE_HEADER_UPDATE_BYTES);
+    int res = SUCCESS;
+    if (ctx->writer_enable) {
+        // checkpoint appended to the data block is overwritten by the next one
+        size_t const checkpoint_length = rl_file_encode_checkpoint(
+            block + block_length, &ctx->data_file_header, file_size);
+        res = rl_writer_submit(&ctx->writer, &ctx->data_writer_file, block,
+                               block_length + checkpoint_length,
+                               ctx->data_file_offset);
+        if (res < 0) {
+            rl_log(RL_LOG_ERROR,
+                   "Adding data block to data file failed; %d message: %s",
+                   errno, strerror(errno));
+            return ERROR;
+        }
+        ctx->data_file_offset = file_size;
+    } else if (config->file_format == RL_FILE_FORMAT_RLD) {
+        res = rl_file_store_checkpoint(ctx->data_file, &ctx->data_file_header);
+    }
+    if (config->file_format == RL_FILE_FORMAT_RLD && res == SUCCESS &&
+        header_update) {
+        res = pru_sample_update_header_bin(ctx, ctx->data_file,
+                                           &ctx->data_writer_file,
+                                           &ctx->data_file_header);
+    } else if (config->file_format == RL_FILE_FORMAT_CSV && header_update) {
+        res = rl_file_update_header_csv(ctx->data_file,
+                                        &ctx->data_file_header);
+    }
+    if (res < 0) {
+        return ERROR;
+    }
+    if (header_update) {
+        ctx->header_update_time = buffer->timestamp_monotonic.sec;
+        ctx->header_update_offset = file_size;
+        if (ctx->index_file != NULL) {
+            fflush(ctx->index_file);
+        }
+        if (ctx->summary.file != NULL) {
+            fflush(ctx->summary.file);
+        }
+    }
+
+    // handle ambient data if enabled and available
+    if (config->ambient_enable && buffer->sensor_buffer_size > 0) {
+        // fetch and write data
+        if (ctx->writer_enable) {
+            block =
+                rl_writer_get_buffer(&ctx->writer, ctx->ambient_file_offset);
+            block_length = rl_file_encode_ambient_block(
+                block, buffer->sensor_buffer, buffer->sensor_buffer_size,
+                &buffer->timestamp_realtime, &buffer->timestamp_monotonic);
+            block_count = rl_writer_submit(&ctx->writer,
+                                           &ctx->ambient_writer_file, block,
+                                           block_length,
+                                           ctx->ambient_file_offset);
+            ctx->ambient_file_offset += block_length;
+            if (block_count == SUCCESS) {
+                block_count = 1;
+            }
+        } else {
+            block_count = rl_file_add_ambient_block(
+                ctx->ambient_file, buffer->sensor_buffer,
+                buffer->sensor_buffer_size, &buffer->timestamp_realtime,
+                &buffer->timestamp_monotonic, config);
+        }
+        if (block_count < 0) {
+            rl_log(RL_LOG_ERROR,
+                   "Adding data block to ambient file failed; %d message: %s",
+                   errno, strerror(errno));
+            return ERROR;
+        }
+
+        // update header counts and store together with data file header
+        ctx->ambient_file_header.lead_in.data_block_count += block_count;
+        ctx->ambient_file_header.lead_in.sample_count +=
+            block_count * RL_FILE_AMBIENT_DATA_BLOCK_SIZE;
+        if (header_update) {
+            res = pru_sample_update_header_bin(ctx, ctx->ambient_file,
+                                               &ctx->ambient_writer_file,
+                                               &ctx->ambient_file_header);
+            if (res < 0) {
+                return ERROR;
+            }
+        }
+    }
+
+    return SUCCESS;
+}
+
+static uint64_t
+pru_sample_get_file_size(pru_sample_context_t const *const context) {
+    if (context->writer_enable) {
+        return context->data_file_offset;
+    }
+    return (uint64_t)ftello(context->data_file);
+}
+
+static int pru_sample_update_header_bin(
+    pru_sample_context_t *const context, FILE *file,
+    rl_writer_file_t const *const writer_file,
+    rl_file_header_t const *const file_header) {
+    if (!context->writer_enable) {
+        return rl_file_update_header_bin(file, file_header);
+    }
+
+    // rewrite lead-in in order with the pending data blocks
+    uint8_t *const buffer = rl_writer_get_buffer(&context->writer, 0);
+    memcpy(buffer, &(file_header->lead_in), sizeof(rl_file_lead_in_t));
+    int res = rl_writer_submit(&context->writer, writer_file, buffer,
+                               sizeof(rl_file_lead_in_t), 0);
+    if (res < 0) {
+        rl_log(RL_LOG_ERROR, "failed updating file header; %d message: %s",
+               errno, strerror(errno));
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+static int pru_sample_writer_init(pru_sample_context_t *const context,
+                                  uint32_t buffer_length) {
+    rl_config_t const *const config = context->config;
+
+    // largest write is a data block followed by its checkpoint record
+    size_t const buffer_size = rl_file_get_data_block_bytes_max(buffer_length) +
+                               sizeof(rl_file_checkpoint_t);
+    int res = rl_writer_init(&context->writer, buffer_size,
+                             RL_WRITER_BACKEND_IO_URING,
+                             config->file_direct_enable);
+    if (res < 0) {
+        return ERROR;
+    }
+    context->writer_enable = true;
+    rl_log(RL_LOG_VERBOSE, "using '%s' file writer backend",
+           (context->writer.backend == RL_WRITER_BACKEND_IO_URING)
+               ? "io_uring"
+               : "thread");
+
+    // continue writing after the headers stored using the file streams
+    fflush(context->data_file);
+    context->data_file_offset = (uint64_t)ftello(context->data_file);
+    rl_writer_file_open(&context->data_writer_file,
+                        fileno(context->data_file),
+                        config->file_direct_enable ? config->file_name : NULL);
+    if (config->ambient_enable) {
+        fflush(context->ambient_file);
+        context->ambient_file_offset = (uint64_t)ftello(context->ambient_file);
+        rl_writer_file_open(&context->ambient_writer_file,
+                            fileno(context->ambient_file), NULL);
+    }
+
+    return SUCCESS;
+}
+
+static void pru_sample_writer_deinit(pru_sample_context_t *const context) {
+    if (!context->writer_enable) {
+        return;
+    }
+
+    rl_writer_deinit(&context->writer);
+    rl_writer_file_close(&context->data_writer_file);
+    if (context->config->ambient_enable) {
+        rl_writer_file_close(&context->ambient_writer_file);
+    }
+    context->writer_enable = false;
+}
+
+static FILE *
+pru_sample_open_index_file(char const *const data_file_name,
+                           rl_file_header_t const *const data_file_header) {
+    char const *const index_file_name =
+        rl_file_get_index_file_name(data_file_name);
+    FILE *index_file = fopen64(index_file_name, "w");
+    if (index_file == NULL) {
+        rl_log(RL_LOG_WARNING,
+               "failed to open index file '%s', continue without data block "
+               "index; %d message: %s",
+               index_file_name, errno, strerror(errno));
+        return NULL;
     }
+
+    int res = rl_file_store_index_header(index_file, data_file_header);
+    if (res < 0) {
+        fclose(index_file);
+        unlink(index_file_name);
+        return NULL;
+    }
+
+    return index_file;
+}
+
+static void pru_sample_open_summary(pru_sample_context_t *const context) {
+    char const *const summary_file_name =
+        rl_summary_get_file_name(context->config->file_name);
+    FILE *summary_file = fopen64(summary_file_name, "w");
+    if (summary_file == NULL) {
+        rl_log(RL_LOG_WARNING,
+               "failed to open summary file '%s', continue without "
+               "measurement summary; %d message: %s",
+               summary_file_name, errno, strerror(errno));
+        return;
+    }
+
+    int res = rl_summary_init(&context->summary, summary_file,
+                              &context->data_file_header, context->config);
+    if (res < 0) {
+        fclose(summary_file);
+        unlink(summary_file_name);
+        context->summary.file = NULL;
+    }
+}
+
+static int pru_sample_finish_file(pru_sample_context_t *const context) {
+    rl_config_t const *const config = context->config;
+    int res = SUCCESS;
+
+    // wait for pending asynchronous writes, continue with the file streams
+    if (context->writer_enable) {
+        res = rl_writer_flush(&context->writer);
+        if (res < 0) {
+            rl_log(RL_LOG_ERROR, "failed writing files; %d message: %s", errno,
+                   strerror(errno));
+            return ERROR;
+        }
+        fseeko(context->data_file, (off_t)context->data_file_offset,
+               SEEK_SET);
+        if (config->ambient_enable) {
+            fseeko(context->ambient_file, (off_t)context->ambient_file_offset,
+                   SEEK_SET);
+        }
+    }
+
+    // store final data file header or footer, drop checkpoint and
+    // preallocated space
+    if (config->file_format == RL_FILE_FORMAT_RLD) {
+        res = rl_file_update_header_bin(context->data_file,
+                                        &context->data_file_header);
+    } else if (config->file_format == RL_FILE_FORMAT_CSV) {
+        res = rl_file_update_header_csv(context->data_file,
+                                        &context->data_file_header);
+    } else if (config->file_format == RL_FILE_FORMAT_ARROW) {
+        res = rl_file_store_footer_arrow(context->data_file,
+                                         &context->data_file_header);
+    }
+    if (res == SUCCESS) {
+        res = rl_file_trim(context->data_file);
+    }
+    if (res < 0) {
+        return ERROR;
+    }
+
+    // complete data block index
+    if (context->index_file != NULL) {
+        fflush(context->index_file);
+    }
+
+    // store final ambient file header
+    if (config->ambient_enable) {
+        fflush(context->ambient_file);
+        res = rl_file_update_header_bin(context->ambient_file,
+                                        &context->ambient_file_header);
+        if (res < 0) {
+            return ERROR;
+        }
+    }
+
+    return SUCCESS;
+}
+
+static void *pru_sample_open_file_part(void *const file_part) {
+    pru_sample_file_part_t *const part = (pru_sample_file_part_t *)file_part;
+    rl_config_t const *const config = part->config;
+
+    part->result = ERROR;
+
+    // open and preallocate data file, failed preallocation is not critical
+    rl_file_get_part_file_name(part->data_file_name, config->file_name,
+                               part->index);
+    part->data_file = fopen64(part->data_file_name, "w+");
+    if (part->data_file == NULL) {
+        rl_log(RL_LOG_ERROR, "failed to open data file '%s'; %d message: %s",
+               part->data_file_name, errno, strerror(errno));
+        return NULL;
+    }
+    rl_file_preallocate(part->data_file, config->file_size);
+
+    // store header without counts
+    part->data_file_header.lead_in.data_block_count = 0;
+    part->data_file_header.lead_in.sample_count = 0;
+    if (config->file_format == RL_FILE_FORMAT_RLD) {
+        rl_file_store_header_bin(part->data_file, &part->data_file_header);
+        part->index_file = pru_sample_open_index_file(part->data_file_name,
+                                                      &part->data_file_header);
+    } else if (config->file_format == RL_FILE_FORMAT_CSV) {
+        rl_file_store_header_csv(part->data_file, &part->data_file_header);
+    } else if (config->file_format == RL_FILE_FORMAT_ARROW) {
+        rl_file_store_header_arrow(part->data_file, &part->data_file_header);
+    }
+
+    // set up for asynchronous writes after the header
+    fflush(part->data_file);
+    part->data_file_offset = (uint64_t)ftello(part->data_file);
+    rl_writer_file_open(&part->data_writer_file, fileno(part->data_file),
+                        config->file_direct_enable ? part->data_file_name
+                                                   : NULL);
+
+    // open ambient file and store header without counts
+    if (config->ambient_enable) {
+        rl_file_get_part_file_name(
+            part->ambient_file_name,
+            rl_file_get_ambient_file_name(config->file_name), part->index);
+        part->ambient_file = fopen64(part->ambient_file_name, "w+");
+        if (part->ambient_file == NULL) {
+            rl_log(RL_LOG_ERROR,
+                   "failed to open ambient file '%s'; %d message: %s",
+                   part->ambient_file_name, errno, strerror(errno));
+            rl_writer_file_close(&part->data_writer_file);
+            fclose(part->data_file);
+            unlink(part->data_file_name);
+            part->data_file = NULL;
+            if (part->index_file != NULL) {
+                fclose(part->index_file);
+                unlink(rl_file_get_index_file_name(part->data_file_name));
+                part->index_file = NULL;
+            }
+            return NULL;
+        }
+
+        part->ambient_file_header.lead_in.data_block_count = 0;
+        part->ambient_file_header.lead_in.sample_count = 0;
+        rl_file_store_header_bin(part->ambient_file,
+                                 &part->ambient_file_header);
+        fflush(part->ambient_file);
+        part->ambient_file_offset = (uint64_t)ftello(part->ambient_file);
+        rl_writer_file_open(&part->ambient_writer_file,
+                            fileno(part->ambient_file), NULL);
+    }
+
+    part->result = SUCCESS;
+    return NULL;
+}
+
+static void pru_sample_prepare_file_part(pru_sample_context_t *const context) {
+    pru_sample_file_part_t *const part = &context->next_part;
+
+    // set up part with copies of the current file headers
+    part->config = context->config;
+    part->index = context->num_files;
+    part->data_file = NULL;
+    part->ambient_file = NULL;
+    part->index_file = NULL;
+    part->data_file_header = context->data_file_header;
+    part->ambient_file_header = context->ambient_file_header;
+    part->result = ERROR;
+
+    // open in background, the part is opened on demand if this fails
+    int res = pthread_create(&context->part_thread, NULL,
+                             pru_sample_open_file_part, part);
+    if (res != 0) {
+        rl_log(RL_LOG_WARNING,
+               "failed creating file part thread; %d message: %s", res,
+               strerror(res));
+    }
+    context->part_thread_started = (res == 0);
+}
+
+static int pru_sample_switch_file_part(pru_sample_context_t *const context) {
+    pru_sample_file_part_t *const part = &context->next_part;
+
+    // wait for background opened part, or open it now
+    if (context->part_thread_started) {
+        pthread_join(context->part_thread, NULL);
+        context->part_thread_started = false;
+    } else {
+        pru_sample_open_file_part(part);
+    }
+    if (part->result < 0) {
+        return ERROR;
+    }
+
+    // finish old files, the first part is closed by the caller of pru_sample
+    int res = pru_sample_finish_file(context);
+    if (res < 0) {
+        rl_log(RL_LOG_ERROR, "Finishing data file failed");
+        pru_sample_remove_file_part(context);
+        return ERROR;
+    }
+    rl_writer_file_close(&context->data_writer_file);
+    if (context->config->ambient_enable) {
+        rl_writer_file_close(&context->ambient_writer_file);
+    }
+    if (context->num_files > 1) {
+        fclose(context->data_file);
+        if (context->config->ambient_enable) {
+            fclose(context->ambient_file);
+        }
+    }
+
+    // index files of all parts are closed here
+    if (context->index_file != NULL) {
+        fclose(context->index_file);
+    }
+
+    // continue with new part
+    context->data_file = part->data_file;
+    context->ambient_file = part->ambient_file;
+    context->index_file = part->index_file;
+    context->data_writer_file = part->data_writer_file;
+    context->ambient_writer_file = part->ambient_writer_file;
+    context->data_file_offset = part->data_file_offset;
+    context->ambient_file_offset = part->ambient_file_offset;
+    context->data_file_header.lead_in.data_block_count = 0;
+    context->data_file_header.lead_in.sample_count = 0;
+    context->ambient_file_header.lead_in.data_block_count = 0;
+    context->ambient_file_header.lead_in.sample_count = 0;
+    context->header_update_offset = 0;
+    context->num_files++;
+
+    rl_log(RL_LOG_INFO, "Creating new data file: %s", part->data_file_name);
+    if (context->config->ambient_enable) {
+        rl_log(RL_LOG_INFO, "new ambient-file: %s", part->ambient_file_name);
+    }
+
+    // prepare the following part ahead of time
+    pru_sample_prepare_file_part(context);
+
+    return SUCCESS;
+}
+
+static void pru_sample_discard_file_part(pru_sample_context_t *const context) {
+    pru_sample_file_part_t *const part = &context->next_part;
+
+    if (!context->part_thread_started) {
+        return;
+    }
+    pthread_join(context->part_thread, NULL);
+    context->part_thread_started = false;
+
+    // remove unused files
+    if (part->result == SUCCESS) {
+        pru_sample_remove_file_part(context);
+    }
+}
+
+static void pru_sample_remove_file_part(pru_sample_context_t *const context) {
+    pru_sample_file_part_t *const part = &context->next_part;
+
+    rl_writer_file_close(&part->data_writer_file);
+    fclose(part->data_file);
+    unlink(part->data_file_name);
+    if (part->index_file != NULL) {
+        fclose(part->index_file);
+        unlink(rl_file_get_index_file_name(part->data_file_name));
+    }
+    if (context->config->ambient_enable) {
+        rl_writer_file_close(&part->ambient_writer_file);
+        fclose(part->ambient_file);
+        unlink(part->ambient_file_name);
+    }
+    part->result = ERROR;
+}
+
+static int pru_sample_handle_web(rl_pipeline_buffer_t const *const buffer,
+                                 void *const context) {
+    pru_sample_context_t *const ctx = (pru_sample_context_t *)context;
+
+    // skip processing after failure, to continue sampling without web
+    if (ctx->web_failure_disable) {
+        return SUCCESS;
+    }
+
+    int res = rl_socket_handle_data(
+        buffer->analog_buffer, buffer->digital_buffer, buffer->sensor_buffer,
+        buffer->buffer_size, buffer->sensor_buffer_size, buffer->index,
+        buffer->samples_lost, &buffer->timestamp_realtime,
+        &buffer->timestamp_monotonic, ctx->config);
+    if (res < 0) {
+        // disable web interface on failure, but continue sampling
+        ctx->web_failure_disable = true;
+        rl_log(RL_LOG_WARNING, "Web server connection failed; %d message: %s",
+               errno, strerror(errno));
+        rl_log(RL_LOG_INFO, "Disabling web interface and continue sampling.");
+    }
+
+    return SUCCESS;
+}
+
+static int pru_sample_handle_meter(rl_pipeline_buffer_t const *const buffer,
+                                   void *const context) {
+    pru_sample_context_t const *const ctx =
+        (pru_sample_context_t const *)context;
+
+    meter_print_buffer(buffer->analog_buffer, buffer->digital_buffer,
+                       buffer->buffer_size, &buffer->timestamp_realtime,
+                       &buffer->timestamp_monotonic, ctx->config);
+
+    return SUCCESS;
+}
+
+static int pru_prussdrv_init(rl_config_t const *const config) {
+    (void)config; // suppress unused parameter warning
+
+    tpruss_intc_initdata pruss_intc_initdata = PRUSS_INTC_INITDATA;
+
+    // initialize and open PRU device
+    prussdrv_init();
+    int ret = prussdrv_open(PRU_EVTOUT_0);
+    if (ret != 0) {
+        rl_log(RL_LOG_ERROR, "failed to open PRUSS driver");
+        return ERROR;
+    }
+
+    // setup PRU interrupt mapping
+    prussdrv_pruintc_init(&pruss_intc_initdata);
+
+    return SUCCESS;
+}
+
+static void pru_prussdrv_deinit(void) {
+    // disable PRU and close memory mappings
+    prussdrv_pru_disable(0);
+    prussdrv_exit();
+}
+
+static void *pru_prussdrv_map_memory(uint32_t *const address,
+                                     uint32_t *const size) {
+    void *pru_extmem_base;
+    prussdrv_map_extmem(&pru_extmem_base);
+    *address = (uint32_t)prussdrv_get_phys_addr(pru_extmem_base);
+    *size = (uint32_t)prussdrv_extmem_size();
+
+    return pru_extmem_base;
+}
+
+static int pru_prussdrv_start(pru_control_t const *const pru_control) {
+    // write configuration to PRU memory
+    prussdrv_pru_write_memory(PRUSS0_PRU0_DATARAM, 0,
+                              (unsigned int const *)pru_control,
+                              sizeof(pru_control_t));
+
+    // PRU memory write fence
+    __sync_synchronize();
+
+    // run SPI on PRU0
+    int res = prussdrv_exec_program(0, PRU_BINARY_FILE);
+    if (res < 0) {
+        rl_log(RL_LOG_ERROR, "Failed starting PRU, binary not found");
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+static int pru_prussdrv_set_state(pru_state_t state) {
+    int res = prussdrv_pru_write_memory(PRUSS0_PRU0_DATARAM, 0,
+                                        (unsigned int *)&state, sizeof(state));
+    // PRU memory write fence
+    __sync_synchronize();
+    return res;
+}
+
+static int pru_prussdrv_wait_event(uint32_t timeout_us) {
+    return prussdrv_pru_wait_event_timeout(PRU_EVTOUT_0, timeout_us);
+}
+
+static void pru_prussdrv_clear_event(void) {
+    prussdrv_pru_clear_event(PRU_EVTOUT_0, PRU0_ARM_INTERRUPT);
+}
+
+static void pru_prussdrv_release_buffer(uint32_t index) {
+    (void)index; // suppress unused parameter warning
 }
@@ -45,7 +45,13 @@
 /// Size of PRU channel data in bytes
 #define PRU_SAMPLE_SIZE 4
 /// Size of PRU buffer status in bytes
-#define PRU_BUFFER_STATUS_SIZE 4
+#define PRU_BUFFER_STATUS_SIZE 8
+/// Minimum number of buffers in the PRU shared memory ring
+#define PRU_BUFFER_COUNT_MIN 2
+/// Maximum number of buffers in the PRU shared memory ring
+#define PRU_BUFFER_COUNT_MAX 128
+/// Buffer index value marking a buffer header as not written
+#define PRU_BUFFER_INDEX_INVALID UINT32_MAX
 
 /**
  * Digital channel bit position in PRU digital information
@@ -89,10 +95,12 @@ struct pru_control {
     uint32_t sample_limit;
     /// Shared buffer length in number of data elements
     uint32_t buffer_length;
-    /// Memory address of the shared buffer 0
-    uint32_t buffer0_addr;
-    /// Memory address of the shared buffer 1
-    uint32_t buffer1_addr;
+    /// Number of buffers in the shared memory ring
+    uint32_t buffer_count;
+    /// Size of a single shared buffer in bytes (including buffer status)
+    uint32_t buffer_size;
+    /// Memory address of the first shared buffer of the ring
+    uint32_t buffer_addr;
 };
 
 /**
@@ -125,8 +133,10 @@ typedef struct pru_data pru_data_t;
  * PRU data buffer structure
  */
 struct pru_buffer {
-    /// buffer index
+    /// buffer index, written by the PRU before filling the buffer
     uint32_t index;
+    /// buffer sequence number, set to the index once the buffer is complete
+    uint32_t sequence;
     /// the data blocks
     pru_data_t const data[];
 };
@@ -136,14 +146,48 @@ struct pru_buffer {
  */
 typedef struct pru_buffer pru_buffer_t;
 
+/**
+ * PRU acquisition backend operations.
+ *
+ * Abstracts the interface to the PRU and its shared memory, to allow replacing
+ * the PRU and ADC hardware by a software implementation.
+ */
+struct pru_backend {
+    /// Backend name
+    char const *name;
+    /// Initialize the backend (returns 0 on success, negative on failure)
+    int (*init)(rl_config_t const *const config);
+    /// Stop and deinitialize the backend
+    void (*deinit)(void);
+    /// Get user space and PRU address, and size of the shared buffer memory
+    void *(*map_memory)(uint32_t *const address, uint32_t *const size);
+    /// Write the PRU control structure and start sampling
+    int (*start)(pru_control_t const *const pru_control);
+    /// Write a new PRU state (returns negative on failure)
+    int (*set_state)(pru_state_t state);
+    /// Wait for PRU event (returns 0 on timeout, negative on failure)
+    int (*wait_event)(uint32_t timeout_us);
+    /// Clear the PRU event
+    void (*clear_event)(void);
+    /// Release a buffer after its data was read (buffer may be overwritten)
+    void (*release_buffer)(uint32_t index);
+};
+
+/**
+ * Typedef for PRU acquisition backend operations.
+ */
+typedef struct pru_backend pru_backend_t;
+
 /**
  * Initialize PRU driver.
  *
- * Map PRU shared memory and enable PRU interrupts.
+ * Select the acquisition backend of the configuration, map PRU shared memory
+ * and enable PRU interrupts.
  *
+ * @param config Current measurement configuration
  * @return {@link SUCCESS} on success, {@link ERROR} otherwise
  */
-int pru_init(void);
+int pru_init(rl_config_t const *const config);
 
 /**
  * Shutdown PRU and deinitialize PRU driver.
@@ -155,14 +199,20 @@ void pru_deinit(void);
 /**
  * PRU data structure initialization.
  *
+ * The number of buffers in the shared memory ring is limited to the size of the
+ * PRU external memory reserved by the uio_pruss driver (or the shared memory
+ * size of the selected acquisition backend).
+ *
  * @param pru_control PRU data structure to initialize
  * @param config Current measurement configuration
  * @param aggregates Number of samples to aggregate for sampling rates smaller
  * than the minimal ADC rate (set 1 for no aggregates)
+ * @param buffer_count Maximum number of buffers in the shared memory ring
  * @return Returns 0 on success, negative on failure with errno set accordingly
  */
 int pru_control_init(pru_control_t *const pru_control,
-                     rl_config_t const *const config, uint32_t aggregates);
+                     rl_config_t const *const config, uint32_t aggregates,
+                     uint32_t buffer_count);
 
 /**
  * Write a new state to the PRU shared memory.
@@ -61,12 +61,15 @@ STATE_OFFSET                .set    0x00
 SAMPLE_RATE_OFFSET          .set    0x04
 SAMPLE_LIMIT_OFFSET         .set    0x08
 BUFFER_LENGTH_OFFSET        .set    0x0C
-BUFFER0_ADDR_OFFSET         .set    0x10
-BUFFER1_ADDR_OFFSET         .set    0x14
+BUFFER_COUNT_OFFSET         .set    0x10
+BUFFER_SIZE_OFFSET          .set    0x14
+BUFFER_ADDR_OFFSET          .set    0x18
 
 ; shared DDR buffer data layout
 BUFFER_CHANNEL_COUNT        .set    10
-BUFFER_INDEX_SIZE           .set    4
+BUFFER_INDEX_OFFSET         .set    0x00
+BUFFER_SEQUENCE_OFFSET      .set    0x04
+BUFFER_STATUS_SIZE          .set    8
 BUFFER_DATA_SIZE            .set    4
 BUFFER_BLOCK_SIZE           .set    (BUFFER_CHANNEL_COUNT * BUFFER_DATA_SIZE)
 
@@ -132,7 +135,11 @@ PRECISION                   .set    r23
 ; PRU register definitions: PRU user space configuration
 SAMPLE_RATE                 .set    r22
 
-; registers r18-r21 unused
+; PRU register definitions: shared DDR buffer ring state
+BUFFER_ADDRESS              .set    r21     ; address of the current buffer
+BUFFER_SLOT                 .set    r20     ; ring slot of the current buffer
+
+; registers r18-r19 unused
 
 ; PRU register definitions: ADC status and configuration register aliases
 ADC1_STATUS_REG             .set    DI_REG
@@ -782,7 +789,6 @@ MAIN:
     LBBO    &SAMPLE_RATE,   RAM_ADDRESS,    SAMPLE_RATE_OFFSET,     4
     LBBO    &BUFFER_SIZE,   RAM_ADDRESS,    BUFFER_LENGTH_OFFSET,   4
     LBBO    &SAMPLES_COUNT, RAM_ADDRESS,    SAMPLE_LIMIT_OFFSET,    4
-    LBBO    &MEM_POINTER,   RAM_ADDRESS,    BUFFER0_ADDR_OFFSET,    4
 
 INIT:
     ; initialize GPIO states
@@ -799,9 +805,11 @@ INIT:
     adc_init SAMPLE_RATE
 
 INIT_COMPLETE:
-    ; initialize buffer index to zero
+    ; initialize buffer index and ring slot to the first buffer
     ZERO    &BUFFER_INDEX,  4
-    
+    ZERO    &BUFFER_SLOT,   4
+    LBBO    &BUFFER_ADDRESS, RAM_ADDRESS, BUFFER_ADDR_OFFSET, 4
+
     ; start ADC conversion
     adc_start
 
@@ -816,6 +824,9 @@ SAMPLINGLOOP:
     QBLT    NEXTSAMPLE, BUFFER_SIZE, 0
 
     ; on full buffer:
+    ; mark buffer complete by setting sequence number to the buffer index
+    SBBO    &BUFFER_INDEX, BUFFER_ADDRESS, BUFFER_SEQUENCE_OFFSET, 4
+
     ; signal interrupt to user space program
     LDI     r31.b0, PRU_R31_VEC_VALID | PRU_EVTOUT_0
 
@@ -831,24 +842,27 @@ NEXTBUFFER:
     ; increment buffer index
     ADD     BUFFER_INDEX, BUFFER_INDEX, 1
 
+    ; advance to next ring slot, wrap around to first buffer at end of ring
+    ADD     BUFFER_SLOT, BUFFER_SLOT, 1
+    LBBO    &TMP_REG, RAM_ADDRESS, BUFFER_COUNT_OFFSET, 4
+    QBLE    RINGWRAP, BUFFER_SLOT, TMP_REG  ; if buffer count <= ring slot, wrap
+
+    ; point to subsequent buffer in the ring
+    LBBO    &TMP_REG, RAM_ADDRESS, BUFFER_SIZE_OFFSET, 4
+    ADD     BUFFER_ADDRESS, BUFFER_ADDRESS, TMP_REG
+    JMP     START
+RINGWRAP:
+    ; point to first buffer in the ring
+    ZERO    &BUFFER_SLOT, 4
+    LBBO    &BUFFER_ADDRESS, RAM_ADDRESS, BUFFER_ADDR_OFFSET, 4
+
 START:
     ; reload buffer size
     LBBO    &BUFFER_SIZE, RAM_ADDRESS, BUFFER_LENGTH_OFFSET, 4 ; reload buffer size
 
-    ; select data buffer
-    QBBC    BUFFER0, BUFFER_INDEX, 0
-    
-    ; point to buffer1 for odd indexes
-    LBBO    &MEM_POINTER, RAM_ADDRESS, BUFFER1_ADDR_OFFSET, 4
-    JMP     BUFFER1
-BUFFER0:
-    ; point to buffer0 for even indexes
-    LBBO    &MEM_POINTER, RAM_ADDRESS, BUFFER0_ADDR_OFFSET, 4
-BUFFER1:
-
     ; store buffer index
-    SBBO    &BUFFER_INDEX, MEM_POINTER, 0, 4
-    ADD     MEM_POINTER, MEM_POINTER, BUFFER_INDEX_SIZE
+    SBBO    &BUFFER_INDEX, BUFFER_ADDRESS, BUFFER_INDEX_OFFSET, 4
+    ADD     MEM_POINTER, BUFFER_ADDRESS, BUFFER_STATUS_SIZE
 
 
 NEXTSAMPLE:
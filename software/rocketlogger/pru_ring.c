@@ -0,0 +1,146 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "pru.h"
+#include "rl.h"
+
+#include "pru_ring.h"
+
+/**
+ * Get the writable ring buffer used for the buffer with a given index.
+ *
+ * @param ring The buffer ring
+ * @param index The buffer index
+ * @return Pointer to the buffer in the ring slot of the index
+ */
+static pru_buffer_t *pru_ring_get_slot(pru_ring_t const *const ring,
+                                       uint32_t index);
+
+void pru_ring_init(pru_ring_t *const ring, void *const base,
+                   pru_control_t const *const pru_control) {
+    ring->base = base;
+    ring->buffer_count = pru_control->buffer_count;
+    ring->buffer_size = pru_control->buffer_size;
+    ring->buffer_length = pru_control->buffer_length;
+
+    // invalidate buffer headers of all ring slots
+    for (uint32_t i = 0; i < ring->buffer_count; i++) {
+        pru_buffer_t *const buffer = pru_ring_get_slot(ring, i);
+        buffer->index = PRU_BUFFER_INDEX_INVALID;
+        buffer->sequence = PRU_BUFFER_INDEX_INVALID;
+    }
+
+    // PRU memory write fence
+    __sync_synchronize();
+}
+
+pru_buffer_t const *pru_ring_get_buffer(pru_ring_t const *const ring,
+                                        uint32_t index) {
+    return pru_ring_get_slot(ring, index);
+}
+
+pru_buffer_t const *pru_ring_check(pru_ring_t const *const ring,
+                                   uint32_t *const index,
+                                   uint32_t *const lost) {
+    while (true) {
+        pru_buffer_t const *const buffer = pru_ring_get_slot(ring, *index);
+
+        // PRU memory sync before accessing buffer status
+        __sync_synchronize();
+        uint32_t const buffer_sequence =
+            *(uint32_t const volatile *)&buffer->sequence;
+        uint32_t const buffer_index =
+            *(uint32_t const volatile *)&buffer->index;
+
+        // buffer complete, PRU memory sync before accessing data
+        if (buffer_index == *index && buffer_sequence == *index) {
+            __sync_synchronize();
+            return buffer;
+        }
+
+        // buffer not yet written or still being filled
+        if (buffer_index == PRU_BUFFER_INDEX_INVALID ||
+            (int32_t)(buffer_index - *index) <= 0) {
+            return NULL;
+        }
+
+        // overrun: skip to the oldest buffer the PRU did not overwrite yet
+        uint32_t const oldest_index = buffer_index - ring->buffer_count + 1;
+        *lost += oldest_index - *index;
+        *index = oldest_index;
+    }
+}
+
+int pru_ring_validate(pru_ring_t const *const ring, uint32_t index) {
+    pru_buffer_t const *const buffer = pru_ring_get_slot(ring, index);
+
+    // PRU memory sync before re-checking the buffer status
+    __sync_synchronize();
+    if (*(uint32_t const volatile *)&buffer->index != index) {
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+pru_data_t *pru_ring_write_start(pru_ring_t *const ring, uint32_t index) {
+    pru_buffer_t *const buffer = pru_ring_get_slot(ring, index);
+
+    *(uint32_t volatile *)&buffer->index = index;
+    __sync_synchronize();
+
+    return (pru_data_t *)buffer->data;
+}
+
+void pru_ring_write_complete(pru_ring_t *const ring, uint32_t index) {
+    pru_buffer_t *const buffer = pru_ring_get_slot(ring, index);
+
+    __sync_synchronize();
+    *(uint32_t volatile *)&buffer->sequence = index;
+    __sync_synchronize();
+}
+
+void pru_ring_write_buffer(pru_ring_t *const ring, uint32_t index,
+                           pru_data_t const *const data) {
+    pru_data_t *const buffer_data = pru_ring_write_start(ring, index);
+    memcpy(buffer_data, data, ring->buffer_length * sizeof(pru_data_t));
+    pru_ring_write_complete(ring, index);
+}
+
+static pru_buffer_t *pru_ring_get_slot(pru_ring_t const *const ring,
+                                       uint32_t index) {
+    uint32_t const slot = index % ring->buffer_count;
+    return (pru_buffer_t *)((uint8_t *)ring->base + slot * ring->buffer_size);
+}
@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PRU_RING_H_
+#define PRU_RING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pru.h"
+
+/**
+ * User space view of the PRU shared memory buffer ring.
+ *
+ * The PRU writes the buffer index to the buffer header before filling a
+ * buffer and sets the buffer sequence number to the same index after the last
+ * sample was written. A buffer is therefore complete if both values match the
+ * expected buffer index. Buffers are assigned to the ring slots in order, i.e.
+ * the buffer with index i is stored in ring slot (i % buffer_count).
+ */
+struct pru_ring {
+    /// User space address of the first buffer in the ring
+    void *base;
+    /// Number of buffers in the ring
+    uint32_t buffer_count;
+    /// Size of a single buffer in bytes (including buffer status)
+    uint32_t buffer_size;
+    /// Buffer length in number of data elements
+    uint32_t buffer_length;
+};
+
+/**
+ * Typedef for the PRU shared memory buffer ring.
+ */
+typedef struct pru_ring pru_ring_t;
+
+/**
+ * Initialize the buffer ring and invalidate all buffer headers.
+ *
+ * @param ring The buffer ring to initialize
+ * @param base User space address of the shared memory holding the ring
+ * @param pru_control The PRU control structure describing the ring layout
+ */
+void pru_ring_init(pru_ring_t *const ring, void *const base,
+                   pru_control_t const *const pru_control);
+
+/**
+ * Get the ring buffer used for the buffer with a given index.
+ *
+ * @param ring The buffer ring
+ * @param index The buffer index
+ * @return Pointer to the buffer in the ring slot of the index
+ */
+pru_buffer_t const *pru_ring_get_buffer(pru_ring_t const *const ring,
+                                        uint32_t index);
+
+/**
+ * Check whether the buffer with a given index is complete.
+ *
+ * If the PRU already overwrote the requested buffer, the index is advanced to
+ * the oldest buffer still available in the ring and the number of skipped
+ * buffers is added to the lost buffer counter.
+ *
+ * @param ring The buffer ring
+ * @param index Pointer to the index of the buffer to check, updated on overrun
+ * @param lost Pointer to the lost buffer counter, updated on overrun
+ * @return Pointer to the completed buffer, NULL if not yet completed
+ */
+pru_buffer_t const *pru_ring_check(pru_ring_t const *const ring,
+                                   uint32_t *const index, uint32_t *const lost);
+
+/**
+ * Validate a buffer was not overwritten while reading its data.
+ *
+ * To be called after the buffer data was processed, to detect overwrites by
+ * the PRU during processing.
+ *
+ * @param ring The buffer ring
+ * @param index The index of the processed buffer
+ * @return Returns 0 if the buffer is still valid, negative if overwritten
+ */
+int pru_ring_validate(pru_ring_t const *const ring, uint32_t index);
+
+/**
+ * Software PRU stand-in: start writing the buffer with a given index.
+ *
+ * Uses the same memory layout and write order as the PRU firmware.
+ *
+ * @param ring The buffer ring
+ * @param index The buffer index to start writing
+ * @return Pointer to the data blocks of the buffer to fill
+ */
+pru_data_t *pru_ring_write_start(pru_ring_t *const ring, uint32_t index);
+
+/**
+ * Software PRU stand-in: mark the buffer with a given index complete.
+ *
+ * @param ring The buffer ring
+ * @param index The buffer index to complete
+ */
+void pru_ring_write_complete(pru_ring_t *const ring, uint32_t index);
+
+/**
+ * Software PRU stand-in: write a full buffer to the ring.
+ *
+ * @param ring The buffer ring
+ * @param index The buffer index to write
+ * @param data The data blocks to copy to the buffer (buffer length elements)
+ */
+void pru_ring_write_buffer(pru_ring_t *const ring, uint32_t index,
+                           pru_data_t const *const data);
+
+#endif /* PRU_RING_H_ */
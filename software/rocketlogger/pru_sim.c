@@ -0,0 +1,667 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "calibration.h"
+#include "log.h"
+#include "pru.h"
+#include "pru_ring.h"
+#include "rl.h"
+#include "rl_file.h"
+#include "util.h"
+
+#include "pru_sim.h"
+
+/**
+ * State of the simulated PRU.
+ */
+struct pru_sim {
+    /// Current measurement configuration
+    rl_config_t const *config;
+    /// Simulated PRU shared memory
+    void *memory;
+    /// PRU control structure provided on start
+    pru_control_t control;
+    /// Buffer ring in the simulated shared memory
+    pru_ring_t ring;
+    /// Synthetic waveform period (NULL when replaying a file)
+    pru_data_t *waveform;
+    /// Position in the synthetic waveform period
+    uint32_t waveform_index;
+    /// Replayed data file (NULL for synthetic waveforms)
+    FILE *replay_file;
+    /// Lead-in of the replayed data file header
+    rl_file_lead_in_t replay_lead_in;
+    /// PRU digital channel mask of the binary channels of the replayed file
+    uint32_t replay_digital_mask[PRU_SIM_REPLAY_BINARY_COUNT];
+    /// PRU channel index of the analog channels of the replayed file
+    int replay_channel[RL_CHANNEL_COUNT];
+    /// Inverse calibration scale of the PRU channels
+    double replay_scale[RL_CHANNEL_COUNT];
+    /// Size of a data row of the replayed file in bytes
+    size_t replay_row_size;
+    /// Data block buffer of the replayed file
+    uint8_t *replay_block;
+    /// Number of rows in the data block buffer
+    uint32_t replay_block_rows;
+    /// Next row to read from the data block buffer
+    uint32_t replay_row;
+    /// Number of rows read from the replayed file
+    uint64_t replay_sample;
+    /// Producer thread
+    pthread_t thread;
+    /// Whether the producer thread was started
+    bool thread_started;
+    /// Mutex protecting the shared state below
+    pthread_mutex_t mutex;
+    /// Condition signaling changes of the shared state below
+    pthread_cond_t cond;
+    /// Current PRU state
+    pru_state_t state;
+    /// Whether a PRU event is pending
+    bool event;
+    /// Number of buffers released by the reader
+    uint32_t released;
+};
+
+/**
+ * Typedef for the state of the simulated PRU.
+ */
+typedef struct pru_sim pru_sim_t;
+
+/// The simulated PRU
+static pru_sim_t pru_sim = {
+    .memory = NULL,
+    .waveform = NULL,
+    .replay_file = NULL,
+    .replay_block = NULL,
+    .thread_started = false,
+};
+
+/*
+ * Simulated PRU backend operations, see {@link pru_backend} for the
+ * documentation of the individual operations.
+ */
+static int pru_sim_init(rl_config_t const *const config);
+static void pru_sim_deinit(void);
+static void *pru_sim_map_memory(uint32_t *const address, uint32_t *const size);
+static int pru_sim_start(pru_control_t const *const pru_control);
+static int pru_sim_set_state(pru_state_t state);
+static int pru_sim_wait_event(uint32_t timeout_us);
+static void pru_sim_clear_event(void);
+static void pru_sim_release_buffer(uint32_t index);
+
+/**
+ * Generate one period of the synthetic waveforms.
+ *
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int pru_sim_waveform_init(void);
+
+/**
+ * Open the data file to replay and set up the channel mapping.
+ *
+ * @param file_name The RLD file to replay
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int pru_sim_replay_init(char const *const file_name);
+
+/**
+ * Read the next data block of the replayed file, restart at end of file.
+ *
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int pru_sim_replay_read_block(void);
+
+/**
+ * Fill data blocks with the next samples of the simulation.
+ *
+ * @param data The data blocks to fill
+ * @param length Number of data blocks to fill
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int pru_sim_fill(pru_data_t *const data, uint32_t length);
+
+/**
+ * Raise the PRU event.
+ */
+static void pru_sim_raise_event(void);
+
+/**
+ * Producer thread filling the buffer ring.
+ *
+ * @param arg Unused thread argument
+ * @return Always NULL
+ */
+static void *pru_sim_run(void *arg);
+
+pru_backend_t const pru_sim_backend = {
+    .name = "simulation",
+    .init = pru_sim_init,
+    .deinit = pru_sim_deinit,
+    .map_memory = pru_sim_map_memory,
+    .start = pru_sim_start,
+    .set_state = pru_sim_set_state,
+    .wait_event = pru_sim_wait_event,
+    .clear_event = pru_sim_clear_event,
+    .release_buffer = pru_sim_release_buffer,
+};
+
+static int pru_sim_init(rl_config_t const *const config) {
+    pru_sim.config = config;
+    pru_sim.state = PRU_STATE_OFF;
+    pru_sim.event = false;
+    pru_sim.released = 0;
+    pru_sim.thread_started = false;
+
+    // allocate simulated PRU shared memory
+    pru_sim.memory = malloc(PRU_SIM_MEMORY_SIZE);
+    if (pru_sim.memory == NULL) {
+        rl_log(RL_LOG_ERROR,
+               "failed allocating simulated PRU memory; %d message: %s", errno,
+               strerror(errno));
+        return ERROR;
+    }
+    memset(pru_sim.memory, 0, PRU_SIM_MEMORY_SIZE);
+
+    // event condition uses monotonic clock for wait time outs
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&pru_sim.cond, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+    pthread_mutex_init(&pru_sim.mutex, NULL);
+
+    return SUCCESS;
+}
+
+static void pru_sim_deinit(void) {
+    // stop and join producer thread
+    pru_sim_set_state(PRU_STATE_OFF);
+    if (pru_sim.thread_started) {
+        pthread_join(pru_sim.thread, NULL);
+        pru_sim.thread_started = false;
+    }
+
+    pthread_cond_destroy(&pru_sim.cond);
+    pthread_mutex_destroy(&pru_sim.mutex);
+
+    if (pru_sim.replay_file != NULL) {
+        fclose(pru_sim.replay_file);
+        pru_sim.replay_file = NULL;
+    }
+    free(pru_sim.replay_block);
+    pru_sim.replay_block = NULL;
+    free(pru_sim.waveform);
+    pru_sim.waveform = NULL;
+    free(pru_sim.memory);
+    pru_sim.memory = NULL;
+}
+
+static void *pru_sim_map_memory(uint32_t *const address, uint32_t *const size) {
+    // no PRU address space, the ring is only accessed using the user space
+    *address = 0;
+    *size = PRU_SIM_MEMORY_SIZE;
+
+    return pru_sim.memory;
+}
+
+static int pru_sim_start(pru_control_t const *const pru_control) {
+    int res;
+
+    pru_sim.control = *pru_control;
+    pru_ring_init(&pru_sim.ring, pru_sim.memory, pru_control);
+
+    // set up the simulated data source
+    if (is_empty_string(pru_sim.config->simulation_file)) {
+        res = pru_sim_waveform_init();
+    } else {
+        res = pru_sim_replay_init(pru_sim.config->simulation_file);
+    }
+    if (res < 0) {
+        rl_log(RL_LOG_ERROR, "Failed starting PRU simulation");
+        return ERROR;
+    }
+
+    // initialization complete, producer thread is started on event clear
+    pthread_mutex_lock(&pru_sim.mutex);
+    pru_sim.state = pru_control->state;
+    pru_sim.released = 0;
+    pthread_mutex_unlock(&pru_sim.mutex);
+    pru_sim_raise_event();
+
+    return SUCCESS;
+}
+
+static int pru_sim_set_state(pru_state_t state) {
+    pthread_mutex_lock(&pru_sim.mutex);
+    pru_sim.state = state;
+    // without producer thread running, stopping is acknowledged immediately
+    if (state == PRU_STATE_OFF && !pru_sim.thread_started) {
+        pru_sim.event = true;
+    }
+    pthread_cond_broadcast(&pru_sim.cond);
+    pthread_mutex_unlock(&pru_sim.mutex);
+
+    return sizeof(state);
+}
+
+static int pru_sim_wait_event(uint32_t timeout_us) {
+    struct timespec timeout;
+    clock_gettime(CLOCK_MONOTONIC, &timeout);
+    timeout.tv_sec += timeout_us / 1000000;
+    timeout.tv_nsec += (timeout_us % 1000000) * 1000;
+    if (timeout.tv_nsec >= 1000000000) {
+        timeout.tv_sec += 1;
+        timeout.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&pru_sim.mutex);
+    int res = 0;
+    while (!pru_sim.event && res == 0) {
+        res = pthread_cond_timedwait(&pru_sim.cond, &pru_sim.mutex, &timeout);
+    }
+    bool const event = pru_sim.event;
+    pthread_mutex_unlock(&pru_sim.mutex);
+
+    if (res != 0 && res != ETIMEDOUT) {
+        errno = res;
+        return ERROR;
+    }
+
+    return event ? 1 : 0;
+}
+
+static void pru_sim_clear_event(void) {
+    pthread_mutex_lock(&pru_sim.mutex);
+    pru_sim.event = false;
+
+    // start producer thread after the start event was handled, i.e. after
+    // potential forking of the sampling process
+    if (!pru_sim.thread_started && pru_sim.state != PRU_STATE_OFF) {
+        // block signals in the producer thread, handled by the main thread
+        sigset_t signal_set;
+        sigset_t signal_set_backup;
+        sigemptyset(&signal_set);
+        sigaddset(&signal_set, SIGTERM);
+        sigaddset(&signal_set, SIGINT);
+        pthread_sigmask(SIG_BLOCK, &signal_set, &signal_set_backup);
+
+        int res = pthread_create(&pru_sim.thread, NULL, pru_sim_run, NULL);
+        if (res != 0) {
+            rl_log(RL_LOG_ERROR,
+                   "failed starting PRU simulation thread; %d message: %s", res,
+                   strerror(res));
+        } else {
+            pru_sim.thread_started = true;
+        }
+
+        pthread_sigmask(SIG_SETMASK, &signal_set_backup, NULL);
+    }
+    pthread_mutex_unlock(&pru_sim.mutex);
+}
+
+static void pru_sim_release_buffer(uint32_t index) {
+    pthread_mutex_lock(&pru_sim.mutex);
+    pru_sim.released = index + 1;
+    pthread_cond_broadcast(&pru_sim.cond);
+    pthread_mutex_unlock(&pru_sim.mutex);
+}
+
+static int pru_sim_waveform_init(void) {
+    free(pru_sim.waveform);
+    pru_sim.waveform = malloc(PRU_SIM_WAVEFORM_LENGTH * sizeof(pru_data_t));
+    if (pru_sim.waveform == NULL) {
+        rl_log(RL_LOG_ERROR,
+               "failed allocating simulation waveform; %d message: %s", errno,
+               strerror(errno));
+        return ERROR;
+    }
+    pru_sim.waveform_index = 0;
+
+    for (uint32_t i = 0; i < PRU_SIM_WAVEFORM_LENGTH; i++) {
+        pru_data_t *const data = &pru_sim.waveform[i];
+        double const phase = 2 * M_PI * i / PRU_SIM_WAVEFORM_LENGTH;
+
+        // digital inputs count through all input combinations
+        data->channel_digital =
+            (i * (PRU_DIGITAL_INPUT_MASK + 1) / PRU_SIM_WAVEFORM_LENGTH) &
+            PRU_DIGITAL_INPUT_MASK;
+
+        // sine waves with a channel specific harmonic and phase
+        for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+            double const value = sin((j % 4 + 1) * phase + j);
+            data->channel_analog[j] =
+                (int32_t)(PRU_SIM_WAVEFORM_AMPLITUDE * value);
+
+            // low current range is valid for the lower half of the amplitude
+            if (is_low_current(j) && fabs(value) < 0.5) {
+                data->channel_digital |= (j == RL_CONFIG_CHANNEL_I1L)
+                                             ? PRU_DIGITAL_I1L_VALID_MASK
+                                             : PRU_DIGITAL_I2L_VALID_MASK;
+            }
+        }
+    }
+
+    return SUCCESS;
+}
+
+static int pru_sim_replay_init(char const *const file_name) {
+    rl_file_lead_in_t *const lead_in = &pru_sim.replay_lead_in;
+
+    pru_sim.replay_file = fopen64(file_name, "r");
+    if (pru_sim.replay_file == NULL) {
+        rl_log(RL_LOG_ERROR,
+               "failed to open simulation file '%s'; %d message: %s",
+               file_name, errno, strerror(errno));
+        return ERROR;
+    }
+
+    // read and validate file header lead-in
+    size_t count = fread(lead_in, sizeof(rl_file_lead_in_t), 1,
+                         pru_sim.replay_file);
+    if (count != 1 || lead_in->file_magic != RL_FILE_MAGIC ||
+        (lead_in->file_version & RL_FILE_VERSION_MASK) != RL_FILE_VERSION) {
+        rl_log(RL_LOG_ERROR, "invalid simulation file, RLD version %u required",
+               RL_FILE_VERSION);
+        errno = EINVAL;
+        return ERROR;
+    }
+    if (lead_in->channel_bin_count > PRU_SIM_REPLAY_BINARY_COUNT ||
+        lead_in->channel_count > RL_CHANNEL_COUNT ||
+        lead_in->data_block_size == 0 || lead_in->sample_count == 0) {
+        rl_log(RL_LOG_ERROR, "unsupported simulation file channels or size");
+        errno = EINVAL;
+        return ERROR;
+    }
+
+    // read channel definitions following the comment
+    fseek(pru_sim.replay_file, sizeof(rl_file_lead_in_t) + lead_in->comment_length,
+          SEEK_SET);
+    for (int i = 0; i < lead_in->channel_bin_count + lead_in->channel_count;
+         i++) {
+        rl_file_channel_t channel;
+        count = fread(&channel, sizeof(rl_file_channel_t), 1,
+                      pru_sim.replay_file);
+        if (count != 1) {
+            rl_log(RL_LOG_ERROR, "failed reading simulation file channels");
+            errno = EIO;
+            return ERROR;
+        }
+        channel.name[RL_FILE_CHANNEL_NAME_LENGTH - 1] = 0;
+
+        // map binary channels to PRU digital channel bits
+        if (i < lead_in->channel_bin_count) {
+            uint32_t mask = 0;
+            for (int j = 0; j < RL_CHANNEL_DIGITAL_COUNT; j++) {
+                if (strcmp(channel.name, RL_CHANNEL_DIGITAL_NAMES[j]) == 0) {
+                    mask = PRU_DIGITAL_INPUT1_MASK << j;
+                }
+            }
+            if (strcmp(channel.name, RL_CHANNEL_VALID_NAMES[0]) == 0) {
+                mask = PRU_DIGITAL_I1L_VALID_MASK;
+            } else if (strcmp(channel.name, RL_CHANNEL_VALID_NAMES[1]) == 0) {
+                mask = PRU_DIGITAL_I2L_VALID_MASK;
+            }
+            pru_sim.replay_digital_mask[i] = mask;
+            continue;
+        }
+
+        // map analog channels to PRU channel index
+        int const k = i - lead_in->channel_bin_count;
+        pru_sim.replay_channel[k] = -1;
+        for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+            if (strcmp(channel.name, RL_CHANNEL_NAMES[j]) == 0) {
+                pru_sim.replay_channel[k] = j;
+            }
+        }
+    }
+
+    // replayed data is converted back to ADC values using the calibration
+    for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+        pru_sim.replay_scale[j] = 1.0 / rl_calibration.scales[j];
+    }
+
+    // allocate data block buffer
+    pru_sim.replay_row_size = lead_in->channel_count * sizeof(int32_t);
+    if (lead_in->channel_bin_count > 0) {
+        pru_sim.replay_row_size += sizeof(uint32_t);
+    }
+    pru_sim.replay_block =
+        malloc(lead_in->data_block_size * pru_sim.replay_row_size);
+    if (pru_sim.replay_block == NULL) {
+        rl_log(RL_LOG_ERROR,
+               "failed allocating simulation file buffer; %d message: %s",
+               errno, strerror(errno));
+        return ERROR;
+    }
+
+    // start replay from the first data block
+    pru_sim.replay_sample = lead_in->sample_count;
+    pru_sim.replay_block_rows = 0;
+    pru_sim.replay_row = 0;
+
+    rl_log(RL_LOG_INFO, "replaying %llu samples from simulation file '%s'",
+           lead_in->sample_count, file_name);
+
+    return SUCCESS;
+}
+
+static int pru_sim_replay_read_block(void) {
+    rl_file_lead_in_t const *const lead_in = &pru_sim.replay_lead_in;
+
+    // restart replay at the first data block at end of data
+    if (pru_sim.replay_sample >= lead_in->sample_count) {
+        fseek(pru_sim.replay_file, lead_in->header_length, SEEK_SET);
+        pru_sim.replay_sample = 0;
+    }
+
+    // skip block timestamps, read block data
+    uint32_t rows = lead_in->data_block_size;
+    if (lead_in->sample_count - pru_sim.replay_sample < rows) {
+        rows = (uint32_t)(lead_in->sample_count - pru_sim.replay_sample);
+    }
+    fseek(pru_sim.replay_file, 2 * sizeof(rl_timestamp_t), SEEK_CUR);
+    size_t count = fread(pru_sim.replay_block, pru_sim.replay_row_size, rows,
+                         pru_sim.replay_file);
+    if (count != rows) {
+        rl_log(RL_LOG_ERROR, "failed reading simulation file data block");
+        errno = EIO;
+        return ERROR;
+    }
+
+    // skip block checksum
+    if (lead_in->file_version & RL_FILE_VERSION_FLAG_CRC) {
+        fseek(pru_sim.replay_file, sizeof(uint32_t), SEEK_CUR);
+    }
+
+    pru_sim.replay_sample += rows;
+    pru_sim.replay_block_rows = rows;
+    pru_sim.replay_row = 0;
+
+    return SUCCESS;
+}
+
+static int pru_sim_fill(pru_data_t *const data, uint32_t length) {
+    // synthetic waveforms: copy from the waveform period
+    if (pru_sim.waveform != NULL) {
+        uint32_t i = 0;
+        while (i < length) {
+            uint32_t count = PRU_SIM_WAVEFORM_LENGTH - pru_sim.waveform_index;
+            if (count > length - i) {
+                count = length - i;
+            }
+            memcpy(&data[i], &pru_sim.waveform[pru_sim.waveform_index],
+                   count * sizeof(pru_data_t));
+            pru_sim.waveform_index =
+                (pru_sim.waveform_index + count) % PRU_SIM_WAVEFORM_LENGTH;
+            i += count;
+        }
+        return SUCCESS;
+    }
+
+    // replayed file: convert file rows back to PRU data
+    rl_file_lead_in_t const *const lead_in = &pru_sim.replay_lead_in;
+    for (uint32_t i = 0; i < length; i++) {
+        if (pru_sim.replay_row >= pru_sim.replay_block_rows) {
+            int res = pru_sim_replay_read_block();
+            if (res < 0) {
+                return ERROR;
+            }
+        }
+
+        uint8_t const *row =
+            pru_sim.replay_block + pru_sim.replay_row * pru_sim.replay_row_size;
+        pru_sim.replay_row++;
+
+        memset(&data[i], 0, sizeof(pru_data_t));
+
+        // binary channels
+        if (lead_in->channel_bin_count > 0) {
+            uint32_t binary;
+            memcpy(&binary, row, sizeof(uint32_t));
+            row += sizeof(uint32_t);
+            for (int j = 0; j < lead_in->channel_bin_count; j++) {
+                if (binary & (1 << j)) {
+                    data[i].channel_digital |= pru_sim.replay_digital_mask[j];
+                }
+            }
+        }
+
+        // analog channels, revert calibration
+        for (int k = 0; k < lead_in->channel_count; k++) {
+            int32_t value;
+            memcpy(&value, row + k * sizeof(int32_t), sizeof(int32_t));
+            int const j = pru_sim.replay_channel[k];
+            if (j < 0) {
+                continue;
+            }
+            data[i].channel_analog[j] =
+                (int32_t)lround(value * pru_sim.replay_scale[j]) -
+                rl_calibration.offsets[j];
+        }
+    }
+
+    return SUCCESS;
+}
+
+static void pru_sim_raise_event(void) {
+    pthread_mutex_lock(&pru_sim.mutex);
+    pru_sim.event = true;
+    pthread_cond_broadcast(&pru_sim.cond);
+    pthread_mutex_unlock(&pru_sim.mutex);
+}
+
+static void *pru_sim_run(void *arg) {
+    (void)arg; // suppress unused parameter warning
+
+    pru_control_t const *const control = &pru_sim.control;
+    bool const realtime = pru_sim.config->simulation_realtime;
+
+    // number of buffers to produce in finite mode
+    uint64_t buffer_limit = 0;
+    if (control->state == PRU_STATE_SAMPLE_FINITE) {
+        buffer_limit = ((uint64_t)control->sample_limit +
+                        control->buffer_length - 1) /
+                       control->buffer_length;
+    }
+
+    // buffer period in nanoseconds
+    int64_t const buffer_period =
+        (int64_t)control->buffer_length * 1000000 / control->sample_rate;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    for (uint32_t index = 0;; index++) {
+        // wait for sample limit stop or buffers released by the reader
+        pthread_mutex_lock(&pru_sim.mutex);
+        while (pru_sim.state != PRU_STATE_OFF &&
+               ((buffer_limit > 0 && index >= buffer_limit) ||
+                (!realtime &&
+                 index - pru_sim.released >= control->buffer_count))) {
+            pthread_cond_wait(&pru_sim.cond, &pru_sim.mutex);
+        }
+        pru_state_t const state = pru_sim.state;
+        pthread_mutex_unlock(&pru_sim.mutex);
+        if (state == PRU_STATE_OFF) {
+            break;
+        }
+
+        // pace buffers to the sample rate, restart pacing when lagging behind
+        if (realtime) {
+            next.tv_nsec += buffer_period;
+            next.tv_sec += next.tv_nsec / 1000000000;
+            next.tv_nsec = next.tv_nsec % 1000000000;
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            if ((now.tv_sec - next.tv_sec) * 1000000000 +
+                    (now.tv_nsec - next.tv_nsec) >
+                buffer_period) {
+                next = now;
+            }
+        }
+
+        // fill buffer using the PRU firmware write order
+        pru_data_t *const data = pru_ring_write_start(&pru_sim.ring, index);
+        int res = pru_sim_fill(data, control->buffer_length);
+        if (res < 0) {
+            rl_log(RL_LOG_ERROR, "PRU simulation failed, stop producing data");
+            break;
+        }
+        pru_ring_write_complete(&pru_sim.ring, index);
+
+        // buffer complete
+        pru_sim_raise_event();
+    }
+
+    // wait for stop request and acknowledge with final event
+    pthread_mutex_lock(&pru_sim.mutex);
+    while (pru_sim.state != PRU_STATE_OFF) {
+        pthread_cond_wait(&pru_sim.cond, &pru_sim.mutex);
+    }
+    pru_sim.event = true;
+    pthread_cond_broadcast(&pru_sim.cond);
+    pthread_mutex_unlock(&pru_sim.mutex);
+
+    return NULL;
+}
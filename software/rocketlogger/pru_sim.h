@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PRU_SIM_H_
+#define PRU_SIM_H_
+
+#include "pru.h"
+
+/// Size of the simulated PRU shared memory in bytes (uio_pruss configuration)
+#define PRU_SIM_MEMORY_SIZE 0x00500000
+/// Length of the synthetic waveform period in samples
+#define PRU_SIM_WAVEFORM_LENGTH 4000
+/// Peak amplitude of the synthetic waveforms in ADC bits
+#define PRU_SIM_WAVEFORM_AMPLITUDE 4000000
+/// Maximum number of binary channels of a replayed data file
+#define PRU_SIM_REPLAY_BINARY_COUNT 32
+
+/**
+ * PRU acquisition backend simulating the PRU and ADC in software.
+ *
+ * A producer thread fills the buffer ring using the memory layout and write
+ * order of the PRU firmware and raises the same PRU events, either with
+ * synthetic waveforms or with the data replayed from an RLD file. In real-time
+ * mode buffers are produced at the configured rate and overwritten if not read
+ * in time. Otherwise, buffers are produced as fast as possible and the
+ * producer waits for the reader to release buffers before overwriting them.
+ */
+extern pru_backend_t const pru_sim_backend;
+
+#endif /* PRU_SIM_H_ */
@@ -31,11 +31,15 @@
 
 #include <errno.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 
+#include <pthread.h>
+#include <sched.h>
 #include <sys/ipc.h>
 #include <sys/shm.h>
 #include <sys/types.h>
@@ -49,6 +53,28 @@
 
 #define RL_JSON_BUFFER_SIZE 10000
 
+/// Number of attempts to acquire the status shared memory sequence lock
+#define RL_STATUS_SHM_RETRY_MAX 1000
+
+/**
+ * RocketLogger status shared memory layout.
+ *
+ * The status is protected by a sequence lock: writers make the sequence odd
+ * while updating the status, readers retry until they copied the status with
+ * the same even sequence before and after.
+ */
+struct rl_status_shm {
+    /// Sequence counter, odd while a write is in progress
+    atomic_uint sequence;
+    /// The RocketLogger status
+    rl_status_t status;
+};
+
+/**
+ * Type definition for RocketLogger status shared memory layout.
+ */
+typedef struct rl_status_shm rl_status_shm_t;
+
 /**
  * RocketLogger reset configuration definition.
  */
@@ -59,18 +85,34 @@ const rl_config_t rl_config_default = {
     .sample_limit = 0,
     .sample_rate = RL_SAMPLE_RATE_MIN,
     .update_rate = 1,
+    .status_rate = 1,
     .channel_enable = RL_CONFIG_CHANNEL_ENABLE_DEFAULT,
     .channel_force_range = RL_CONFIG_CHANNEL_FORCE_RANGE_DEFAULT,
     .aggregation_mode = RL_AGGREGATION_MODE_DOWNSAMPLE,
     .digital_enable = true,
     .web_enable = true,
+    .web_rate = RL_CONFIG_WEB_RATE_DEFAULT,
+    .web_full_rate_enable = false,
+    .shm_enable = false,
+    .pipeline_enable = false,
+    .realtime_enable = false,
     .calibration_ignore = false,
     .ambient_enable = false,
     .file_enable = true,
     .file_name = RL_CONFIG_FILE_DEFAULT,
     .file_format = RL_FILE_FORMAT_RLD,
     .file_size = RL_CONFIG_FILE_SIZE_DEFAULT,
+    .file_header_interval = RL_CONFIG_FILE_HEADER_INTERVAL_DEFAULT,
+    .file_writer = RL_FILE_WRITER_STDIO,
+    .file_direct_enable = false,
+    .file_compress_enable = false,
+    .file_planar_enable = false,
+    .file_crc_enable = false,
+    .file_fixed_width_enable = false,
     .file_comment = RL_CONFIG_COMMENT_DEFAULT,
+    .backend = RL_BACKEND_PRU,
+    .simulation_file = "",
+    .simulation_realtime = true,
 };
 
 /**
@@ -88,6 +130,17 @@ const rl_status_t rl_status_default = {
     .disk_use_rate = 0,
     .sensor_count = 0,
     .sensor_available = {false},
+    .pipeline_backlog = {0},
+    .pipeline_dropped = {0},
+    .web_dropped = 0,
+    .wakeup_latency_histogram = {0},
+    .wakeup_latency_max = 0,
+    .processing_time_histogram = {0},
+    .processing_time_max = 0,
+    .write_queue_depth = 0,
+    .write_queue_depth_max = 0,
+    .write_latency_histogram = {0},
+    .write_latency_max = 0,
     .config = NULL,
 };
 
@@ -107,6 +160,10 @@ char const *const RL_CHANNEL_DIGITAL_NAMES[RL_CHANNEL_DIGITAL_COUNT] = {
 char const *const RL_CHANNEL_VALID_NAMES[RL_CHANNEL_SWITCHED_COUNT] = {
     "I1L_valid", "I2L_valid"};
 
+/// RocketLogger pipeline consumer names
+char const *const RL_PIPELINE_CONSUMER_NAMES[RL_PIPELINE_CONSUMER_COUNT] = {
+    "file", "web", "meter"};
+
 /// Global RocketLogger status variable.
 // rl_status_t rl_status = rl_status_default;
 rl_status_t rl_status = {
@@ -121,6 +178,17 @@ rl_status_t rl_status = {
     .disk_use_rate = 0,
     .sensor_count = 0,
     .sensor_available = {false},
+    .pipeline_backlog = {0},
+    .pipeline_dropped = {0},
+    .web_dropped = 0,
+    .wakeup_latency_histogram = {0},
+    .wakeup_latency_max = 0,
+    .processing_time_histogram = {0},
+    .processing_time_max = 0,
+    .write_queue_depth = 0,
+    .write_queue_depth_max = 0,
+    .write_latency_histogram = {0},
+    .write_latency_max = 0,
     .config = NULL,
 };
 
@@ -129,6 +197,26 @@ void *zmq_status_context = NULL;
 /// The ZeroMQ status publisher
 void *zmq_status_publisher = NULL;
 
+/// Status shared memory, mapped once per process
+static rl_status_shm_t *rl_status_shm = NULL;
+/// Time of the last status publication (monotonic clock)
+static struct timespec rl_status_publish_time = {0, 0};
+
+/// Whether the status is published by the background thread
+static bool rl_status_pub_async = false;
+/// Background status publishing thread
+static pthread_t rl_status_pub_thread;
+/// Lock for stopping the background status publishing thread
+static pthread_mutex_t rl_status_pub_mutex = PTHREAD_MUTEX_INITIALIZER;
+/// Condition for stopping the background status publishing thread
+static pthread_cond_t rl_status_pub_cond;
+/// Request to stop the background status publishing thread
+static bool rl_status_pub_stop = false;
+/// Free disk space in bytes polled by the background thread
+static atomic_uint_least64_t rl_status_pub_disk_free;
+/// Free disk space in permille polled by the background thread
+static atomic_uint rl_status_pub_disk_free_permille;
+
 /**
  * Print a configuration setting line with formated string value.
  *
@@ -139,6 +227,69 @@ void *zmq_status_publisher = NULL;
 static void print_config_line(char const *const description, char const *format,
                               ...);
 
+/**
+ * Print a timing histogram with its non-empty bins.
+ *
+ * @param description Histogram description
+ * @param histogram The histogram of RL_TIMING_HISTOGRAM_BINS bins
+ * @param max The maximum value in microseconds
+ */
+static void print_timing_histogram(char const *const description,
+                                   uint32_t const *const histogram,
+                                   uint32_t max);
+
+/**
+ * Append a timing histogram as JSON object to a string buffer.
+ *
+ * @param buffer The string buffer to append to
+ * @param length The size of the string buffer
+ * @param name The JSON key of the histogram object
+ * @param histogram The histogram of RL_TIMING_HISTOGRAM_BINS bins
+ * @param max The maximum value in microseconds
+ */
+static void snprintfcat_timing_histogram(char *const buffer, size_t length,
+                                         char const *const name,
+                                         uint32_t const *const histogram,
+                                         uint32_t max);
+
+/**
+ * Map the status shared memory into the process, if not already mapped.
+ *
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int rl_status_shm_map(void);
+
+/**
+ * Copy status to the shared memory using the sequence lock.
+ *
+ * @param status The status data structure to copy to the shared memory
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int rl_status_shm_write(rl_status_t const *const status);
+
+/**
+ * Update the file system state of the status.
+ *
+ * @param status The status data structure to update
+ */
+static void rl_status_update_disk(rl_status_t *const status);
+
+/**
+ * Publish the status as JSON string to the ZeroMQ status publisher.
+ *
+ * @param status The status data structure to publish
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int rl_status_publish(rl_status_t const *const status);
+
+/**
+ * Background status publishing thread.
+ *
+ * @param arg The measurement configuration
+ * @return Returns NULL
+ */
+static void *rl_status_pub_run(void *arg);
+
 void rl_config_print(rl_config_t const *const config) {
     // sampling in background or interactively
     print_config_line("Run in background",
@@ -195,17 +346,76 @@ void rl_config_print(rl_config_t const *const config) {
     case RL_FILE_FORMAT_CSV:
         print_config_line("File format", "CSV text file");
         break;
+
+    case RL_FILE_FORMAT_ARROW:
+        print_config_line("File format", "Apache Arrow IPC file");
+        break;
     default:
         print_config_line("File format", "undefined");
         break;
     }
     print_config_line("Max. file size", "%llu Bytes", config->file_size);
+    print_config_line("Header interval", "%u s",
+                      config->file_header_interval);
+    switch (config->file_writer) {
+    case RL_FILE_WRITER_STDIO:
+        print_config_line("File writer", "stdio");
+        break;
+    case RL_FILE_WRITER_ASYNC:
+        print_config_line("File writer", "asynchronous");
+        break;
+    default:
+        print_config_line("File writer", "undefined");
+        break;
+    }
+    print_config_line("Direct I/O",
+                      config->file_direct_enable ? "enabled" : "disabled");
+    print_config_line("Compression",
+                      config->file_compress_enable ? "enabled" : "disabled");
+    print_config_line("Planar layout",
+                      config->file_planar_enable ? "enabled" : "disabled");
+    print_config_line("Block checksum",
+                      config->file_crc_enable ? "enabled" : "disabled");
+    print_config_line("Fixed width",
+                      config->file_fixed_width_enable ? "enabled" : "disabled");
 
     print_config_line("Update rate", "%u Hz", config->update_rate);
+    print_config_line("Status rate", "%u Hz", config->status_rate);
     print_config_line("Web server",
                       config->web_enable ? "enabled" : "disabled");
+    if (config->web_full_rate_enable) {
+        print_config_line("Web data rate", "full rate");
+    } else {
+        print_config_line("Web data rate", "%u Hz envelopes", config->web_rate);
+    }
+    print_config_line("Shared data memory",
+                      config->shm_enable ? "enabled" : "disabled");
+    print_config_line("Pipelined processing",
+                      config->pipeline_enable ? "enabled" : "disabled");
+    print_config_line("Real-time profile",
+                      config->realtime_enable ? "enabled" : "disabled");
     print_config_line("Calibration measurement",
                       config->calibration_ignore ? "enabled" : "disabled");
+
+    switch (config->backend) {
+    case RL_BACKEND_PRU:
+        print_config_line("Acquisition backend", "PRU");
+        break;
+    case RL_BACKEND_SIMULATION:
+        print_config_line("Acquisition backend", "simulation");
+        if (is_empty_string(config->simulation_file)) {
+            print_config_line("Simulation data", "synthetic waveforms");
+        } else {
+            print_config_line("Simulation data", config->simulation_file);
+        }
+        print_config_line("Simulation timing",
+                          config->simulation_realtime ? "real-time"
+                                                      : "as fast as possible");
+        break;
+    default:
+        print_config_line("Acquisition backend", "undefined");
+        break;
+    }
 }
 
 void rl_config_print_cmd(rl_config_t const *const config) {
@@ -225,6 +435,7 @@ void rl_config_print_cmd(rl_config_t const *const config) {
     // sample rate and aggregation
     printf(" --rate=%u", config->sample_rate);
     printf(" --update=%u", config->update_rate);
+    printf(" --status-rate=%u", config->status_rate);
 
     // channels
     printf(" --channel=");
@@ -255,17 +466,55 @@ void rl_config_print_cmd(rl_config_t const *const config) {
     printf(" --ambient=%s", config->ambient_enable ? "true" : "false");
     printf(" --digital=%s", config->digital_enable ? "true" : "false");
     printf(" --web=%s", config->web_enable ? "true" : "false");
+    printf(" --web-rate=%u", config->web_rate);
+    printf(" --web-full-rate=%s",
+           config->web_full_rate_enable ? "true" : "false");
+    printf(" --shm=%s", config->shm_enable ? "true" : "false");
+    printf(" --pipeline=%s", config->pipeline_enable ? "true" : "false");
+    printf(" --realtime=%s", config->realtime_enable ? "true" : "false");
 
     if (config->calibration_ignore) {
         printf(" --calibration");
     }
 
+    // acquisition backend
+    if (config->backend == RL_BACKEND_SIMULATION) {
+        printf(" --backend=simulation");
+        if (!is_empty_string(config->simulation_file)) {
+            printf(" --simulation-file=%s", config->simulation_file);
+        }
+        printf(" --simulation-realtime=%s",
+               config->simulation_realtime ? "true" : "false");
+    } else {
+        printf(" --backend=pru");
+    }
+
     // file
     if (config->file_enable) {
         printf(" --output=%s", config->file_name);
-        printf(" --format=%s",
-               (config->file_format == RL_FILE_FORMAT_RLD) ? "rld" : "csv");
+        switch (config->file_format) {
+        case RL_FILE_FORMAT_CSV:
+            printf(" --format=csv");
+            break;
+        case RL_FILE_FORMAT_ARROW:
+            printf(" --format=arrow");
+            break;
+        default:
+            printf(" --format=rld");
+            break;
+        }
         printf(" --size=%llu", config->file_size);
+        printf(" --header-interval=%u", config->file_header_interval);
+        printf(" --writer=%s",
+               (config->file_writer == RL_FILE_WRITER_ASYNC) ? "async"
+                                                             : "stdio");
+        printf(" --direct=%s", config->file_direct_enable ? "true" : "false");
+        printf(" --compress=%s",
+               config->file_compress_enable ? "true" : "false");
+        printf(" --planar=%s", config->file_planar_enable ? "true" : "false");
+        printf(" --crc=%s", config->file_crc_enable ? "true" : "false");
+        printf(" --fixed-width=%s",
+               config->file_fixed_width_enable ? "true" : "false");
         printf(" --comment='%s'\n", config->file_comment);
     } else {
         printf(" --output=0\n");
@@ -288,6 +537,9 @@ char *rl_config_get_json(rl_config_t const *const config) {
                 config->background_enable ? "true" : "false");
     snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"interactive_enable\": %s, ",
                 config->interactive_enable ? "true " : "false");
+    snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"backend\": \"%s\", ",
+                (config->backend == RL_BACKEND_SIMULATION) ? "simulation"
+                                                           : "pru");
     snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"calibration_ignore\": %s, ",
                 config->calibration_ignore ? "true" : "false");
 
@@ -327,8 +579,16 @@ char *rl_config_get_json(rl_config_t const *const config) {
         snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"file\": { ");
         snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"comment\": \"%s\", ",
                     config->file_comment);
+        snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"compress\": %s, ",
+                    config->file_compress_enable ? "true" : "false");
+        snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"crc\": %s, ",
+                    config->file_crc_enable ? "true" : "false");
+        snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"direct\": %s, ",
+                    config->file_direct_enable ? "true" : "false");
         snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"filename\": \"%s\", ",
                     config->file_name);
+        snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"fixed_width\": %s, ",
+                    config->file_fixed_width_enable ? "true" : "false");
         switch (config->file_format) {
         case RL_FILE_FORMAT_RLD:
             snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"format\": \"rld\", ");
@@ -336,22 +596,59 @@ char *rl_config_get_json(rl_config_t const *const config) {
         case RL_FILE_FORMAT_CSV:
             snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"format\": \"csv\", ");
             break;
+        case RL_FILE_FORMAT_ARROW:
+            snprintfcat(buffer, RL_JSON_BUFFER_SIZE,
+                        "\"format\": \"arrow\", ");
+            break;
         default:
             snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"format\": null, ");
             break;
         }
-        snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"size\": %llu",
+        snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"header_interval\": %u, ",
+                    config->file_header_interval);
+        snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"planar\": %s, ",
+                    config->file_planar_enable ? "true" : "false");
+        snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"size\": %llu, ",
                     config->file_size);
+        snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"writer\": \"%s\"",
+                    (config->file_writer == RL_FILE_WRITER_ASYNC) ? "async"
+                                                                  : "stdio");
         snprintfcat(buffer, RL_JSON_BUFFER_SIZE, " }, ");
     }
+    snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"pipeline_enable\": %s, ",
+                config->pipeline_enable ? "true" : "false");
+    snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"realtime_enable\": %s, ",
+                config->realtime_enable ? "true" : "false");
     snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"sample_limit\": %llu, ",
                 config->sample_limit);
+    if (config->backend != RL_BACKEND_SIMULATION) {
+        snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"simulation\": null, ");
+    } else {
+        snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"simulation\": { ");
+        if (is_empty_string(config->simulation_file)) {
+            snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"file\": null, ");
+        } else {
+            snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"file\": \"%s\", ",
+                        config->simulation_file);
+        }
+        snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"realtime\": %s",
+                    config->simulation_realtime ? "true" : "false");
+        snprintfcat(buffer, RL_JSON_BUFFER_SIZE, " }, ");
+    }
+    snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"shm_enable\": %s, ",
+                config->shm_enable ? "true" : "false");
     snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"sample_rate\": %u, ",
                 config->sample_rate);
+    snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"status_rate\": %u, ",
+                config->status_rate);
     snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"update_rate\": %u, ",
                 config->update_rate);
-    snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"web_enable\": %s",
+    snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"web_enable\": %s, ",
                 config->web_enable ? "true" : "false");
+    snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"web_full_rate\": %s, ",
+                config->web_full_rate_enable ? "true" : "false");
+    snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"web_rate\": %u",
+                config->web_rate);
     snprintfcat(buffer, RL_JSON_BUFFER_SIZE, " }");
 
     return buffer;
@@ -389,8 +686,9 @@ int rl_config_read_default(rl_config_t *const config) {
         return ERROR;
     }
 
-    // read values
-    fread(config, sizeof(rl_config_t), 1, file);
+    // read values, a stored config of different size has another layout
+    size_t const count = fread(config, sizeof(rl_config_t), 1, file);
+    bool const size_valid = (count == 1 && fgetc(file) == EOF);
 
     // close file
     fclose(file);
@@ -399,8 +697,8 @@ int rl_config_read_default(rl_config_t *const config) {
     /// @todo drop once comment is stored together with default config
     config->file_comment = RL_CONFIG_COMMENT_DEFAULT;
 
-    // check version
-    if (config->config_version != RL_CONFIG_VERSION) {
+    // check version and size
+    if (!size_valid || config->config_version != RL_CONFIG_VERSION) {
         rl_log(RL_LOG_WARNING,
                "Old or invalid configuration file. Using default "
                "config as fall back.");
@@ -463,6 +761,22 @@ int rl_config_validate(rl_config_t const *const config) {
         return ERROR;
     }
 
+    // check supported status rate (non-zero)
+    if (config->status_rate == 0) {
+        rl_log(RL_LOG_ERROR, "invalid status rate (%u). Needs to be non-zero.",
+               config->status_rate);
+        return ERROR;
+    }
+
+    // check supported web data rate (one of the published envelope rates)
+    if (config->web_rate != 10 && config->web_rate != 1000 &&
+        config->web_rate != 10000) {
+        rl_log(RL_LOG_ERROR,
+               "invalid web data rate (%u). Needs to be 10, 1000 or 10000.",
+               config->web_rate);
+        return ERROR;
+    }
+
     // check supported file size (either zero or at least minimum value)
     if (config->file_size > 0 && config->file_size < RL_CONFIG_FILE_SIZE_MIN) {
         rl_log(RL_LOG_ERROR, "invalid update rate. Needs to be a valid divisor "
@@ -477,6 +791,15 @@ int rl_config_validate(rl_config_t const *const config) {
         return ERROR;
     }
 
+    // simulation replay file needs to be readable if provided
+    if (config->backend == RL_BACKEND_SIMULATION &&
+        !is_empty_string(config->simulation_file) &&
+        access(config->simulation_file, R_OK) < 0) {
+        rl_log(RL_LOG_ERROR, "cannot read simulation file '%s'.",
+               config->simulation_file);
+        return ERROR;
+    }
+
     // sample limit: accept any positive integer, or zero -> no check needed
     // .sample_limit = 0UL,
 
@@ -487,13 +810,25 @@ int rl_config_validate(rl_config_t const *const config) {
     // .channel_force_range = RL_CONFIG_CHANNEL_FORCE_RANGE_DEFAULT,
     // .digital_enable = true,
     // .web_enable = true,
+    // .web_full_rate_enable = false,
+    // .shm_enable = false,
+    // .pipeline_enable = false,
+    // .realtime_enable = false,
     // .calibration_ignore = false,
     // .ambient_enable = false,
     // .file_enable = true,
+    // .file_direct_enable = false,
+    // .file_compress_enable = false,
+    // .file_planar_enable = false,
+    // .file_crc_enable = false,
+    // .file_fixed_width_enable = false,
+    // .simulation_realtime = true,
 
     // checking enum values not required:
     // .aggregation_mode = RL_AGGREGATION_MODE_DOWNSAMPLE,
     // .file_format = RL_FILE_FORMAT_RLD,
+    // .file_writer = RL_FILE_WRITER_STDIO,
+    // .backend = RL_BACKEND_PRU,
 
     // check incompatible/invalid combinations
     if (config->background_enable && config->interactive_enable) {
@@ -501,6 +836,51 @@ int rl_config_validate(rl_config_t const *const config) {
                "enabling both background and interactive is unsupported.");
         return ERROR;
     }
+    if (config->realtime_enable && !config->pipeline_enable) {
+        rl_log(RL_LOG_ERROR, "real-time profile requires pipelined processing "
+                             "to keep storing and streaming data out of the "
+                             "real-time sampling thread.");
+        return ERROR;
+    }
+    if (config->file_writer == RL_FILE_WRITER_ASYNC &&
+        config->file_format != RL_FILE_FORMAT_RLD) {
+        rl_log(RL_LOG_ERROR,
+               "asynchronous file writer supports only the RLD file format.");
+        return ERROR;
+    }
+    if (config->file_direct_enable &&
+        config->file_writer != RL_FILE_WRITER_ASYNC) {
+        rl_log(RL_LOG_ERROR, "direct I/O requires the asynchronous writer.");
+        return ERROR;
+    }
+    if (config->file_compress_enable &&
+        config->file_format != RL_FILE_FORMAT_RLD) {
+        rl_log(RL_LOG_ERROR, "compression supports only the RLD file format.");
+        return ERROR;
+    }
+    if (config->file_planar_enable &&
+        config->file_format != RL_FILE_FORMAT_RLD) {
+        rl_log(RL_LOG_ERROR,
+               "planar layout supports only the RLD file format.");
+        return ERROR;
+    }
+    if (config->file_crc_enable &&
+        config->file_format != RL_FILE_FORMAT_RLD) {
+        rl_log(RL_LOG_ERROR,
+               "data block checksums support only the RLD file format.");
+        return ERROR;
+    }
+    if (config->file_planar_enable && config->file_compress_enable) {
+        rl_log(RL_LOG_ERROR,
+               "enabling both compression and planar layout is unsupported.");
+        return ERROR;
+    }
+    if (config->file_fixed_width_enable &&
+        config->file_format != RL_FILE_FORMAT_CSV) {
+        rl_log(RL_LOG_ERROR,
+               "fixed width data rows support only the CSV file format.");
+        return ERROR;
+    }
 
     return SUCCESS;
 }
@@ -548,6 +928,10 @@ int rl_status_pub_init(void) {
         return ERROR;
     }
 
+    // publish first status update immediately
+    rl_status_publish_time.tv_sec = 0;
+    rl_status_publish_time.tv_nsec = 0;
+
     return SUCCESS;
 }
 
@@ -562,9 +946,54 @@ int rl_status_pub_deinit(void) {
     return SUCCESS;
 }
 
+int rl_status_pub_async_start(rl_status_t const *const status) {
+    atomic_store(&rl_status_pub_disk_free, status->disk_free);
+    atomic_store(&rl_status_pub_disk_free_permille,
+                 status->disk_free_permille);
+
+    // stop condition with timeouts on the monotonic clock
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&rl_status_pub_cond, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+    rl_status_pub_stop = false;
+
+    int res = pthread_create(&rl_status_pub_thread, NULL, rl_status_pub_run,
+                             (void *)status->config);
+    if (res != 0) {
+        errno = res;
+        rl_log(RL_LOG_ERROR,
+               "failed starting status publishing thread; %d message: %s",
+               errno, strerror(errno));
+        pthread_cond_destroy(&rl_status_pub_cond);
+        return ERROR;
+    }
+
+    rl_status_pub_async = true;
+    return SUCCESS;
+}
+
+int rl_status_pub_async_stop(void) {
+    if (!rl_status_pub_async) {
+        return SUCCESS;
+    }
+
+    pthread_mutex_lock(&rl_status_pub_mutex);
+    rl_status_pub_stop = true;
+    pthread_cond_signal(&rl_status_pub_cond);
+    pthread_mutex_unlock(&rl_status_pub_mutex);
+
+    pthread_join(rl_status_pub_thread, NULL);
+    pthread_cond_destroy(&rl_status_pub_cond);
+    rl_status_pub_async = false;
+
+    return SUCCESS;
+}
+
 int rl_status_shm_init(void) {
     // create shared memory
-    int shm_id = shmget(RL_SHMEM_STATUS_KEY, sizeof(rl_status_t),
+    int shm_id = shmget(RL_SHMEM_STATUS_KEY, sizeof(rl_status_shm_t),
                         IPC_CREAT | RL_SHMEM_PERMISSIONS);
     if (shm_id == -1) {
         rl_log(RL_LOG_ERROR,
@@ -578,8 +1007,8 @@ int rl_status_shm_init(void) {
 
 int rl_status_shm_deinit(void) {
     // get ID and attach shared memory
-    int shm_id =
-        shmget(RL_SHMEM_STATUS_KEY, sizeof(rl_status_t), RL_SHMEM_PERMISSIONS);
+    int shm_id = shmget(RL_SHMEM_STATUS_KEY, sizeof(rl_status_shm_t),
+                        RL_SHMEM_PERMISSIONS);
     if (shm_id == -1) {
         rl_log(RL_LOG_ERROR,
                "failed getting shared memory id for removal; %d message: %s",
@@ -587,6 +1016,12 @@ int rl_status_shm_deinit(void) {
         return ERROR;
     }
 
+    // detach process mapping, if any
+    if (rl_status_shm != NULL) {
+        shmdt(rl_status_shm);
+        rl_status_shm = NULL;
+    }
+
     // mark shared memory for deletion
     int res = shmctl(shm_id, IPC_RMID, NULL);
     if (res == -1) {
@@ -600,107 +1035,94 @@ int rl_status_shm_deinit(void) {
 }
 
 int rl_status_read(rl_status_t *const status) {
-    // get ID and attach shared memory
-    int shm_id =
-        shmget(RL_SHMEM_STATUS_KEY, sizeof(rl_status_t), RL_SHMEM_PERMISSIONS);
-    if (shm_id == -1) {
-        rl_log(RL_LOG_ERROR,
-               "failed getting shared memory id for reading the "
-               "status; %d message: %s",
-               errno, strerror(errno));
+    int res = rl_status_shm_map();
+    if (res < 0) {
         return ERROR;
     }
 
-    rl_status_t const *const shm_status =
-        (rl_status_t const *const)shmat(shm_id, NULL, 0);
-    if (shm_status == (void *)-1) {
-        rl_log(RL_LOG_ERROR,
-               "failed mapping shared memory for reading the "
-               "status; %d message: %s",
-               errno, strerror(errno));
-        return ERROR;
+    // copy status until a snapshot without concurrent write is read
+    for (int retry = 0; retry < RL_STATUS_SHM_RETRY_MAX; retry++) {
+        unsigned int const sequence = atomic_load_explicit(
+            &rl_status_shm->sequence, memory_order_acquire);
+        if (sequence & 0x1) {
+            sched_yield();
+            continue;
+        }
+
+        memcpy(status, &rl_status_shm->status, sizeof(rl_status_t));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&rl_status_shm->sequence,
+                                 memory_order_relaxed) == sequence) {
+            status->config = NULL;
+            return SUCCESS;
+        }
     }
 
-    // copy status read from shared memory
-    memcpy(status, shm_status, sizeof(rl_status_t));
-    status->config = NULL;
+    rl_log(RL_LOG_ERROR, "failed reading consistent status, shared memory "
+                         "continuously being written");
+    errno = EBUSY;
+    return ERROR;
+}
+
+int rl_status_write(rl_status_t *const status) {
+    // update file system state for publishing
+    if (zmq_status_publisher != NULL) {
+        rl_status_update_disk(status);
+    }
 
-    // detach shared memory
-    int res = shmdt(shm_status);
+    int res = rl_status_shm_write(status);
     if (res < 0) {
-        rl_log(
-            RL_LOG_ERROR,
-            "failed detaching shared memory after status read; %d message: %s",
-            errno, strerror(errno));
         return ERROR;
     }
 
+    // write status json to zmq socket if enabled
+    if (zmq_status_publisher != NULL) {
+        clock_gettime(CLOCK_MONOTONIC, &rl_status_publish_time);
+        return rl_status_publish(status);
+    }
+
     return SUCCESS;
 }
 
-int rl_status_write(rl_status_t *const status) {
-    // get ID and attach shared memory
-    int shm_id =
-        shmget(RL_SHMEM_STATUS_KEY, sizeof(rl_status_t), RL_SHMEM_PERMISSIONS);
-    if (shm_id == -1) {
-        rl_log(RL_LOG_ERROR,
-               "failed getting shared memory id for writing the status; %d "
-               "message %s",
-               errno, strerror(errno));
-        return ERROR;
+int rl_status_update(rl_status_t *const status) {
+    // publishing in background, only merge its file system state
+    if (rl_status_pub_async) {
+        status->disk_free = atomic_load_explicit(&rl_status_pub_disk_free,
+                                                 memory_order_relaxed);
+        status->disk_free_permille = atomic_load_explicit(
+            &rl_status_pub_disk_free_permille, memory_order_relaxed);
+        return rl_status_shm_write(status);
     }
 
-    rl_status_t *const shm_status = (rl_status_t *const)shmat(shm_id, NULL, 0);
-    if (shm_status == (void *)-1) {
-        rl_log(RL_LOG_ERROR,
-               "failed mapping shared memory for writing the status; %d "
-               "message %s",
-               errno, strerror(errno));
-        return ERROR;
+    // check whether file system state and publishing are due
+    bool publish = false;
+    if (zmq_status_publisher != NULL) {
+        uint32_t const status_rate = (status->config != NULL)
+                                         ? status->config->status_rate
+                                         : rl_config_default.status_rate;
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t const elapsed_ns =
+            (int64_t)(now.tv_sec - rl_status_publish_time.tv_sec) *
+                1000000000LL +
+            (now.tv_nsec - rl_status_publish_time.tv_nsec);
+        if (elapsed_ns >= 1000000000LL / status_rate) {
+            rl_status_publish_time = now;
+            publish = true;
+        }
     }
 
-    // write status
-    memcpy(shm_status, status, sizeof(rl_status_t));
+    if (publish) {
+        rl_status_update_disk(status);
+    }
 
-    // detach shared memory
-    int res = shmdt(shm_status);
+    int res = rl_status_shm_write(status);
     if (res < 0) {
-        rl_log(
-            RL_LOG_ERROR,
-            "failed detaching shared memory after status write; %d message: %s",
-            errno, strerror(errno));
         return ERROR;
     }
 
-    // write status json to zmq socket if enabled
-    if (zmq_status_publisher != NULL) {
-        // update file system state
-        int64_t disk_free = 0;
-        int64_t disk_total = 0;
-        if (status->config != NULL) {
-            disk_free = fs_space_free(status->config->file_name);
-            disk_total = fs_space_total(status->config->file_name);
-        } else {
-            disk_free = fs_space_free(RL_CONFIG_FILE_DIR_DEFAULT);
-            disk_total = fs_space_total(RL_CONFIG_FILE_DIR_DEFAULT);
-        }
-
-        status->disk_free = disk_free;
-        if (disk_total > 0) {
-            status->disk_free_permille = (1000 * disk_free) / disk_total;
-        } else {
-            status->disk_free_permille = 0;
-        }
-
-        // get status as json string and publish to zeromq
-        char const *const status_json = rl_status_get_json(status);
-        int zmq_res =
-            zmq_send(zmq_status_publisher, status_json, strlen(status_json), 0);
-        if (zmq_res < 0) {
-            rl_log(RL_LOG_ERROR, "failed publishing status; %d message: %s",
-                   errno, strerror(errno));
-            return ERROR;
-        }
+    if (publish) {
+        return rl_status_publish(status);
     }
 
     return SUCCESS;
@@ -726,6 +1148,22 @@ void rl_status_print(rl_status_t const *const status) {
             print_config_line("", SENSOR_REGISTRY[i].name);
         }
     }
+    for (int i = 0; i < RL_PIPELINE_CONSUMER_COUNT; i++) {
+        print_config_line(i == 0 ? "Pipeline backlog/dropped" : "",
+                          "%-6s %u/%u buffers", RL_PIPELINE_CONSUMER_NAMES[i],
+                          status->pipeline_backlog[i],
+                          status->pipeline_dropped[i]);
+    }
+    print_config_line("Web dropped", "%u messages", status->web_dropped);
+    print_timing_histogram("Wakeup latency", status->wakeup_latency_histogram,
+                           status->wakeup_latency_max);
+    print_timing_histogram("Processing time",
+                           status->processing_time_histogram,
+                           status->processing_time_max);
+    print_config_line("Write queue depth", "%u (max. %u)",
+                      status->write_queue_depth, status->write_queue_depth_max);
+    print_timing_histogram("Write latency", status->write_latency_histogram,
+                           status->write_latency_max);
 }
 
 void rl_status_print_json(rl_status_t const *const status) {
@@ -774,7 +1212,38 @@ char *rl_status_get_json(rl_status_t const *const status) {
             snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "null");
         }
     }
-    snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "]");
+    snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "], ");
+    snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"pipeline\": { ");
+    for (int i = 0; i < RL_PIPELINE_CONSUMER_COUNT; i++) {
+        if (i > 0) {
+            snprintfcat(buffer, RL_JSON_BUFFER_SIZE, ", ");
+        }
+        snprintfcat(buffer, RL_JSON_BUFFER_SIZE,
+                    "\"%s\": { \"backlog\": %u, \"dropped\": %u }",
+                    RL_PIPELINE_CONSUMER_NAMES[i], status->pipeline_backlog[i],
+                    status->pipeline_dropped[i]);
+    }
+    snprintfcat(buffer, RL_JSON_BUFFER_SIZE, " }, ");
+    snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"web_dropped\": %u, ",
+                status->web_dropped);
+    snprintfcat(buffer, RL_JSON_BUFFER_SIZE, "\"timing\": { ");
+    snprintfcat_timing_histogram(buffer, RL_JSON_BUFFER_SIZE,
+                                 "wakeup_latency",
+                                 status->wakeup_latency_histogram,
+                                 status->wakeup_latency_max);
+    snprintfcat(buffer, RL_JSON_BUFFER_SIZE, ", ");
+    snprintfcat_timing_histogram(buffer, RL_JSON_BUFFER_SIZE,
+                                 "processing_time",
+                                 status->processing_time_histogram,
+                                 status->processing_time_max);
+    snprintfcat(buffer, RL_JSON_BUFFER_SIZE, ", ");
+    snprintfcat_timing_histogram(buffer, RL_JSON_BUFFER_SIZE, "write_latency",
+                                 status->write_latency_histogram,
+                                 status->write_latency_max);
+    snprintfcat(buffer, RL_JSON_BUFFER_SIZE, " }, ");
+    snprintfcat(buffer, RL_JSON_BUFFER_SIZE,
+                "\"writer\": { \"queue_depth\": %u, \"queue_depth_max\": %u }",
+                status->write_queue_depth, status->write_queue_depth_max);
     if (status->config != NULL) {
         char const *config_json = rl_config_get_json(status->config);
         snprintfcat(buffer, RL_JSON_BUFFER_SIZE, ", \"config\": %s",
@@ -794,3 +1263,173 @@ static void print_config_line(char const *description, char const *format,
     printf("\n");
     va_end(args);
 }
+
+static void print_timing_histogram(char const *const description,
+                                   uint32_t const *const histogram,
+                                   uint32_t max) {
+    print_config_line(description, "%u us max", max);
+    for (int i = 0; i < RL_TIMING_HISTOGRAM_BINS; i++) {
+        if (histogram[i] > 0) {
+            print_config_line("", "from %7u us: %u buffers",
+                              (i == 0) ? 0 : (1U << i), histogram[i]);
+        }
+    }
+}
+
+static void snprintfcat_timing_histogram(char *const buffer, size_t length,
+                                         char const *const name,
+                                         uint32_t const *const histogram,
+                                         uint32_t max) {
+    snprintfcat(buffer, length, "\"%s\": { \"max_us\": %u, \"histogram\": [",
+                name, max);
+    for (int i = 0; i < RL_TIMING_HISTOGRAM_BINS; i++) {
+        snprintfcat(buffer, length, "%s%u", (i > 0) ? ", " : "",
+                    histogram[i]);
+    }
+    snprintfcat(buffer, length, "] }");
+}
+
+static int rl_status_shm_map(void) {
+    if (rl_status_shm != NULL) {
+        return SUCCESS;
+    }
+
+    // get ID and attach shared memory
+    int shm_id = shmget(RL_SHMEM_STATUS_KEY, sizeof(rl_status_shm_t),
+                        RL_SHMEM_PERMISSIONS);
+    if (shm_id == -1) {
+        rl_log(RL_LOG_ERROR,
+               "failed getting shared memory id for the status; %d message: %s",
+               errno, strerror(errno));
+        return ERROR;
+    }
+
+    void *const shm = shmat(shm_id, NULL, 0);
+    if (shm == (void *)-1) {
+        rl_log(RL_LOG_ERROR,
+               "failed mapping shared memory for the status; %d message: %s",
+               errno, strerror(errno));
+        return ERROR;
+    }
+
+    rl_status_shm = (rl_status_shm_t *)shm;
+    return SUCCESS;
+}
+
+static int rl_status_shm_write(rl_status_t const *const status) {
+    int res = rl_status_shm_map();
+    if (res < 0) {
+        return ERROR;
+    }
+
+    // acquire sequence lock by making the sequence odd
+    unsigned int sequence =
+        atomic_load_explicit(&rl_status_shm->sequence, memory_order_relaxed);
+    for (int retry = 0;; retry++) {
+        if ((sequence & 0x1) == 0) {
+            if (atomic_compare_exchange_weak_explicit(
+                    &rl_status_shm->sequence, &sequence, sequence + 1,
+                    memory_order_acquire, memory_order_relaxed)) {
+                break;
+            }
+            continue;
+        }
+        if (retry >= RL_STATUS_SHM_RETRY_MAX) {
+            // a writer terminated while holding the lock, take it over
+            rl_log(RL_LOG_WARNING, "taking over stale status sequence lock");
+            break;
+        }
+        sched_yield();
+        sequence = atomic_load_explicit(&rl_status_shm->sequence,
+                                        memory_order_relaxed);
+    }
+    atomic_thread_fence(memory_order_release);
+
+    // write status and release lock with the next even sequence
+    memcpy(&rl_status_shm->status, status, sizeof(rl_status_t));
+    atomic_store_explicit(&rl_status_shm->sequence, (sequence | 0x1) + 1,
+                          memory_order_release);
+
+    return SUCCESS;
+}
+
+static void rl_status_update_disk(rl_status_t *const status) {
+    int64_t disk_free = 0;
+    int64_t disk_total = 0;
+    if (status->config != NULL) {
+        disk_free = fs_space_free(status->config->file_name);
+        disk_total = fs_space_total(status->config->file_name);
+    } else {
+        disk_free = fs_space_free(RL_CONFIG_FILE_DIR_DEFAULT);
+        disk_total = fs_space_total(RL_CONFIG_FILE_DIR_DEFAULT);
+    }
+
+    status->disk_free = disk_free;
+    if (disk_total > 0) {
+        status->disk_free_permille = (1000 * disk_free) / disk_total;
+    } else {
+        status->disk_free_permille = 0;
+    }
+}
+
+static int rl_status_publish(rl_status_t const *const status) {
+    // get status as json string and publish to zeromq
+    char const *const status_json = rl_status_get_json(status);
+    int zmq_res =
+        zmq_send(zmq_status_publisher, status_json, strlen(status_json), 0);
+    if (zmq_res < 0) {
+        rl_log(RL_LOG_ERROR, "failed publishing status; %d message: %s", errno,
+               strerror(errno));
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+static void *rl_status_pub_run(void *arg) {
+    rl_config_t const *const config = (rl_config_t const *)arg;
+    uint32_t const status_rate = (config != NULL)
+                                     ? config->status_rate
+                                     : rl_config_default.status_rate;
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    pthread_mutex_lock(&rl_status_pub_mutex);
+    while (!rl_status_pub_stop) {
+        // wait for the next status period or a stop request
+        next.tv_nsec += 1000000000L / status_rate;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        int res = 0;
+        while (!rl_status_pub_stop && res == 0) {
+            res = pthread_cond_timedwait(&rl_status_pub_cond,
+                                         &rl_status_pub_mutex, &next);
+        }
+        if (rl_status_pub_stop) {
+            break;
+        }
+        pthread_mutex_unlock(&rl_status_pub_mutex);
+
+        // publish consistent snapshot with updated file system state
+        rl_status_t status;
+        res = rl_status_read(&status);
+        if (res == SUCCESS) {
+            status.config = config;
+            rl_status_update_disk(&status);
+            atomic_store_explicit(&rl_status_pub_disk_free, status.disk_free,
+                                  memory_order_relaxed);
+            atomic_store_explicit(&rl_status_pub_disk_free_permille,
+                                  status.disk_free_permille,
+                                  memory_order_relaxed);
+            rl_status_publish(&status);
+        }
+
+        pthread_mutex_lock(&rl_status_pub_mutex);
+    }
+    pthread_mutex_unlock(&rl_status_pub_mutex);
+
+    return NULL;
+}
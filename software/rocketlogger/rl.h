@@ -64,6 +64,10 @@
 #define RL_SENSOR_COUNT_MAX 128
 /// Ambient sensor read out rate in samples per second
 #define RL_SENSOR_SAMPLE_RATE 1
+/// Number of data consumers in pipelined processing mode
+#define RL_PIPELINE_CONSUMER_COUNT 3
+/// Number of logarithmic bins of the timing histograms (up to 2^20 us)
+#define RL_TIMING_HISTOGRAM_BINS 21
 
 /// User folder calibration file path
 #define RL_CALIBRATION_USER_FILE                                               \
@@ -78,7 +82,7 @@
 #define RL_CONFIG_SYSTEM_FILE "/etc/rocketlogger/settings.dat"
 
 /// Default system configuration file path
-#define RL_CONFIG_VERSION 0x03
+#define RL_CONFIG_VERSION 0x04
 /// Configuration channel indexes
 #define RL_CONFIG_CHANNEL_V1 0
 #define RL_CONFIG_CHANNEL_V2 1
@@ -107,8 +111,12 @@
 #define RL_CONFIG_FILE_SIZE_MIN (5UL * 1000UL * 1000UL)
 /// Configuration file size default
 #define RL_CONFIG_FILE_SIZE_DEFAULT (1000UL * 1000UL * 1000UL)
+/// File header update interval default in seconds
+#define RL_CONFIG_FILE_HEADER_INTERVAL_DEFAULT 1
 /// Configuration file comment default
 #define RL_CONFIG_COMMENT_DEFAULT "Sampled using the RocketLogger"
+/// Web interface data stream rate default
+#define RL_CONFIG_WEB_RATE_DEFAULT 1000
 
 /// Key for status shared memory (used for creation)
 #define RL_SHMEM_STATUS_KEY 1111
@@ -139,8 +147,9 @@ typedef enum rl_aggregation_mode rl_aggregation_mode_t;
  * RocketLogger file formats.
  */
 enum rl_file_format {
-    RL_FILE_FORMAT_CSV, /// CSV format
-    RL_FILE_FORMAT_RLD, /// RLD binary format
+    RL_FILE_FORMAT_CSV,   /// CSV format
+    RL_FILE_FORMAT_RLD,   /// RLD binary format
+    RL_FILE_FORMAT_ARROW, /// Apache Arrow IPC file format
 };
 
 /**
@@ -148,6 +157,32 @@ enum rl_file_format {
  */
 typedef enum rl_file_format rl_file_format_t;
 
+/**
+ * RocketLogger file writers.
+ */
+enum rl_file_writer {
+    RL_FILE_WRITER_STDIO, /// Synchronous writes using buffered stdio streams
+    RL_FILE_WRITER_ASYNC, /// Asynchronous writes (io_uring or writer threads)
+};
+
+/**
+ * Type definition for RocketLogger file writer.
+ */
+typedef enum rl_file_writer rl_file_writer_t;
+
+/**
+ * RocketLogger data acquisition backends.
+ */
+enum rl_backend {
+    RL_BACKEND_PRU,        /// PRU and ADC hardware
+    RL_BACKEND_SIMULATION, /// Software simulation of the PRU and ADC
+};
+
+/**
+ * Type definition for RocketLogger data acquisition backend.
+ */
+typedef enum rl_backend rl_backend_t;
+
 /**
  * RocketLogger sampling configuration.
  */
@@ -164,6 +199,8 @@ struct rl_config {
     uint32_t sample_rate;
     /// Data update rate
     uint32_t update_rate;
+    /// Status update rate (disk space polling and status publishing)
+    uint32_t status_rate;
     /// Channels to sample
     bool channel_enable[RL_CHANNEL_COUNT];
     /// Current channels to force to high range
@@ -174,6 +211,17 @@ struct rl_config {
     bool digital_enable;
     /// Enable web interface connection
     bool web_enable;
+    /// Maximum rate of the min/max/mean envelopes published for the web
+    /// interface
+    uint32_t web_rate;
+    /// Publish all samples for the web interface instead of envelopes
+    bool web_full_rate_enable;
+    /// Write calibrated data to the local data shared memory ring
+    bool shm_enable;
+    /// Process data in pipelined mode using dedicated consumer threads
+    bool pipeline_enable;
+    /// Run sampling with real-time profile (priority and locked memory)
+    bool realtime_enable;
     /// Perform calibration measurement (ignore existing calibration)
     bool calibration_ignore;
     /// Enable logging of ambient sensor
@@ -186,8 +234,28 @@ struct rl_config {
     rl_file_format_t file_format;
     /// Maximum data file size
     uint64_t file_size;
+    /// File header update interval in seconds (0 to update every data block)
+    uint32_t file_header_interval;
+    /// File writer
+    rl_file_writer_t file_writer;
+    /// Write aligned file ranges using direct I/O (asynchronous writer only)
+    bool file_direct_enable;
+    /// Store data blocks compressed (RLD format only)
+    bool file_compress_enable;
+    /// Store data blocks channel-planar, one column per channel (RLD only)
+    bool file_planar_enable;
+    /// Store a CRC-32C checksum with each data block (RLD only)
+    bool file_crc_enable;
+    /// Store data rows of fixed width to split and parse in parallel (CSV only)
+    bool file_fixed_width_enable;
     /// File comment
     char const *file_comment;
+    /// Data acquisition backend
+    rl_backend_t backend;
+    /// RLD file to replay in simulation (empty for synthetic waveforms)
+    char simulation_file[PATH_MAX];
+    /// Pace simulation to the sample rate (as fast as possible otherwise)
+    bool simulation_realtime;
 };
 
 /**
@@ -221,6 +289,28 @@ struct rl_status {
     uint16_t sensor_count;
     /// Identifiers of sensors found
     bool sensor_available[RL_SENSOR_COUNT_MAX];
+    /// Number of buffers pending per pipeline consumer
+    uint32_t pipeline_backlog[RL_PIPELINE_CONSUMER_COUNT];
+    /// Number of buffers dropped per pipeline consumer
+    uint32_t pipeline_dropped[RL_PIPELINE_CONSUMER_COUNT];
+    /// Number of web data messages dropped by the data socket
+    uint32_t web_dropped;
+    /// Histogram of the wakeup latency from PRU buffer event to user space
+    uint32_t wakeup_latency_histogram[RL_TIMING_HISTOGRAM_BINS];
+    /// Maximum wakeup latency in microseconds
+    uint32_t wakeup_latency_max;
+    /// Histogram of the processing time per buffer
+    uint32_t processing_time_histogram[RL_TIMING_HISTOGRAM_BINS];
+    /// Maximum processing time per buffer in microseconds
+    uint32_t processing_time_max;
+    /// Number of file writes pending or in flight (asynchronous writer)
+    uint32_t write_queue_depth;
+    /// Maximum number of file writes pending or in flight
+    uint32_t write_queue_depth_max;
+    /// Histogram of the file write completion latency (asynchronous writer)
+    uint32_t write_latency_histogram[RL_TIMING_HISTOGRAM_BINS];
+    /// Maximum file write completion latency in microseconds
+    uint32_t write_latency_max;
     /// (local) reference to current config
     rl_config_t const *config;
 };
@@ -242,6 +332,9 @@ extern char const *const RL_CHANNEL_DIGITAL_NAMES[RL_CHANNEL_DIGITAL_COUNT];
 /// RocketLogger valid channel names
 extern char const *const RL_CHANNEL_VALID_NAMES[RL_CHANNEL_SWITCHED_COUNT];
 
+/// RocketLogger pipeline consumer names
+extern char const *const RL_PIPELINE_CONSUMER_NAMES[RL_PIPELINE_CONSUMER_COUNT];
+
 /**
  * Print RocketLogger configuration as text output.
  *
@@ -342,6 +435,26 @@ int rl_status_pub_init(void);
  */
 int rl_status_pub_deinit(void);
 
+/**
+ * Start publishing the RocketLogger status in a background thread.
+ *
+ * The file system state is polled and the status published at the configured
+ * status rate, rl_status_update() then only writes to the shared memory. The
+ * status must not be written using rl_status_write() until publishing in the
+ * background is stopped.
+ *
+ * @param status The status data structure being updated while sampling
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_status_pub_async_start(rl_status_t const *const status);
+
+/**
+ * Stop publishing the RocketLogger status in a background thread.
+ *
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_status_pub_async_stop(void);
+
 /**
  * Create and initialize the shared memory for the RocketLogger status.
  *
@@ -367,11 +480,25 @@ int rl_status_read(rl_status_t *const status);
 /**
  * Write new status of the RocketLogger to shared memory.
  *
+ * Also updates the file system state and publishes the status, if status
+ * publishing is initialized.
+ *
  * @param status The status data structure to copy to the shared memory
  * @return Returns 0 on success, negative on failure with errno set accordingly
  */
 int rl_status_write(rl_status_t *const status);
 
+/**
+ * Update the status of the RocketLogger in shared memory while sampling.
+ *
+ * Like rl_status_write(), but updates the file system state and publishes the
+ * status only at the configured status rate.
+ *
+ * @param status The status data structure to copy to the shared memory
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_status_update(rl_status_t *const status);
+
 /**
  * Print RocketLogger status as text output.
  *
@@ -0,0 +1,674 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "rl.h"
+#include "rl_file.h"
+
+#include "rl_arrow.h"
+
+/// Arrow IPC message continuation marker preceding the metadata length
+#define RL_ARROW_CONTINUATION 0xFFFFFFFF
+/// Arrow metadata version V5
+#define RL_ARROW_METADATA_VERSION 4
+/// Arrow message header type of a schema
+#define RL_ARROW_HEADER_SCHEMA 1
+/// Arrow message header type of a record batch
+#define RL_ARROW_HEADER_RECORD_BATCH 3
+/// Arrow data type of an integer column
+#define RL_ARROW_TYPE_INT 2
+/// Arrow data type of a boolean column
+#define RL_ARROW_TYPE_BOOL 6
+/// Size of the table fields, all fields use a slot of 8 bytes for alignment
+#define RL_ARROW_FIELD_BYTES 8
+/// Size of the field node and buffer structs of a record batch
+#define RL_ARROW_STRUCT_BYTES 16
+/// Size of the block struct of the file footer
+#define RL_ARROW_BLOCK_BYTES 24
+/// Maximum length of formatted metadata values
+#define RL_ARROW_VALUE_LENGTH 32
+
+/**
+ * Builder for flatbuffers as used for the Arrow IPC metadata.
+ *
+ * Unlike the flatbuffers library, the buffer is built front to back: objects
+ * are referenced by forward offsets only and are therefore stored after the
+ * tables referencing them. Each table has its own vtable, stored right before
+ * the table.
+ */
+struct rl_arrow_builder {
+    /// Buffer to build the flatbuffer in
+    uint8_t *buffer;
+    /// Size of the buffer in bytes
+    size_t size;
+    /// Length of the flatbuffer built so far in bytes
+    size_t length;
+    /// Whether the flatbuffer exceeded the buffer size
+    bool overflow;
+};
+
+/**
+ * Typedef for the flatbuffer builder.
+ */
+typedef struct rl_arrow_builder rl_arrow_builder_t;
+
+/**
+ * Reserve zero initialized space at the end of the flatbuffer.
+ *
+ * @param builder The flatbuffer builder
+ * @param length Number of bytes to reserve
+ * @param alignment Alignment of the reserved space in bytes
+ * @return Position of the reserved space in the flatbuffer
+ */
+static size_t rl_arrow_reserve(rl_arrow_builder_t *const builder,
+                               size_t length, size_t alignment);
+
+/**
+ * Store a value at a position of the flatbuffer, in little endian byte order.
+ *
+ * @param builder The flatbuffer builder
+ * @param position Position in the flatbuffer to store the value to
+ * @param value The value to store
+ * @param length Size of the value in bytes
+ */
+static void rl_arrow_put(rl_arrow_builder_t *const builder, size_t position,
+                         void const *value, size_t length);
+
+/**
+ * Store a forward offset to an object at a position of the flatbuffer.
+ *
+ * @param builder The flatbuffer builder
+ * @param position Position in the flatbuffer to store the offset to
+ * @param target Position of the referenced object
+ */
+static void rl_arrow_put_offset(rl_arrow_builder_t *const builder,
+                                size_t position, size_t target);
+
+/**
+ * Add a table with its vtable to the flatbuffer.
+ *
+ * @param builder The flatbuffer builder
+ * @param field_count Number of fields defined for the table
+ * @param field_mask Fields present in the table (bit i for field i)
+ * @return Position of the table in the flatbuffer
+ */
+static size_t rl_arrow_add_table(rl_arrow_builder_t *const builder,
+                                 uint16_t field_count, uint32_t field_mask);
+
+/**
+ * Get the position of a table field.
+ *
+ * @param table Position of the table in the flatbuffer
+ * @param field Index of the field
+ * @return Position of the field in the flatbuffer
+ */
+static inline size_t rl_arrow_field(size_t table, uint16_t field);
+
+/**
+ * Add a null terminated string to the flatbuffer.
+ *
+ * @param builder The flatbuffer builder
+ * @param string The string to add
+ * @return Position of the string in the flatbuffer
+ */
+static size_t rl_arrow_add_string(rl_arrow_builder_t *const builder,
+                                  char const *string);
+
+/**
+ * Add a vector with zero initialized elements to the flatbuffer.
+ *
+ * @param builder The flatbuffer builder
+ * @param count Number of elements of the vector
+ * @param element_size Size of the elements in bytes
+ * @param alignment Alignment of the elements in bytes
+ * @return Position of the vector in the flatbuffer
+ */
+static size_t rl_arrow_add_vector(rl_arrow_builder_t *const builder,
+                                  size_t count, size_t element_size,
+                                  size_t alignment);
+
+/**
+ * Add a key-value metadata table to the flatbuffer.
+ *
+ * @param builder The flatbuffer builder
+ * @param key The metadata key
+ * @param value The metadata value
+ * @return Position of the table in the flatbuffer
+ */
+static size_t rl_arrow_add_key_value(rl_arrow_builder_t *const builder,
+                                     char const *key, char const *value);
+
+/**
+ * Add the schema table of the file header channels to the flatbuffer.
+ *
+ * @param builder The flatbuffer builder
+ * @param file_header The file header to add the schema of
+ * @return Position of the schema table in the flatbuffer
+ */
+static size_t rl_arrow_add_schema(rl_arrow_builder_t *const builder,
+                                  rl_file_header_t const *const file_header);
+
+/**
+ * Add a schema field table of a channel to the flatbuffer.
+ *
+ * @param builder The flatbuffer builder
+ * @param file_header The file header of the channel
+ * @param index Index of the channel in the file header
+ * @return Position of the field table in the flatbuffer
+ */
+static size_t rl_arrow_add_field(rl_arrow_builder_t *const builder,
+                                 rl_file_header_t const *const file_header,
+                                 int index);
+
+/**
+ * Complete an encapsulated IPC message of a built flatbuffer.
+ *
+ * The flatbuffer was built after the space reserved for the message prefix,
+ * which is filled with the padded metadata length.
+ *
+ * @param builder The flatbuffer builder
+ * @return Size of the message metadata including prefix and padding, 0 on
+ * overflow with errno set accordingly
+ */
+static size_t rl_arrow_finish_message(rl_arrow_builder_t *const builder);
+
+/**
+ * Get the size of a column's data in a record batch body without padding.
+ *
+ * @param binary Whether the column is a binary channel
+ * @param row_count Number of rows of the record batch
+ * @return Size of the column data in bytes
+ */
+static size_t rl_arrow_get_column_data_bytes(bool binary, size_t row_count);
+
+size_t rl_arrow_get_header_bytes_max(rl_file_header_t const *const file_header) {
+    size_t const channel_count = file_header->lead_in.channel_bin_count +
+                                 file_header->lead_in.channel_count;
+    return 1024 + channel_count * 512 + strlen(file_header->comment);
+}
+
+size_t rl_arrow_get_footer_bytes_max(rl_file_header_t const *const file_header,
+                                     size_t block_count) {
+    return rl_arrow_get_header_bytes_max(file_header) +
+           block_count * RL_ARROW_BLOCK_BYTES;
+}
+
+size_t rl_arrow_get_column_bytes(bool binary, size_t row_count) {
+    size_t const length = rl_arrow_get_column_data_bytes(binary, row_count);
+    return (length + RL_ARROW_ALIGNMENT - 1) & ~(size_t)(RL_ARROW_ALIGNMENT - 1);
+}
+
+size_t rl_arrow_encode_header(uint8_t *const buffer, size_t size,
+                              rl_file_header_t const *const file_header) {
+    size_t const magic_length =
+        (RL_ARROW_MAGIC_LENGTH + RL_ARROW_ALIGNMENT - 1) &
+        ~(size_t)(RL_ARROW_ALIGNMENT - 1);
+    if (size < magic_length) {
+        errno = ENOBUFS;
+        return 0;
+    }
+
+    // file magic padded to the message alignment
+    memset(buffer, 0, magic_length);
+    memcpy(buffer, RL_ARROW_MAGIC, RL_ARROW_MAGIC_LENGTH);
+
+    // schema message after the prefix
+    rl_arrow_builder_t builder = {
+        .buffer = buffer + magic_length,
+        .size = size - magic_length,
+        .length = 0,
+        .overflow = false,
+    };
+    rl_arrow_reserve(&builder, 2 * sizeof(uint32_t), sizeof(uint32_t));
+    size_t const root = rl_arrow_reserve(&builder, sizeof(uint32_t),
+                                         sizeof(uint32_t));
+
+    // message: version, header type, header
+    size_t const message = rl_arrow_add_table(&builder, 5, 0x07);
+    int16_t const version = RL_ARROW_METADATA_VERSION;
+    uint8_t const header_type = RL_ARROW_HEADER_SCHEMA;
+    rl_arrow_put(&builder, rl_arrow_field(message, 0), &version,
+                 sizeof(version));
+    rl_arrow_put(&builder, rl_arrow_field(message, 1), &header_type,
+                 sizeof(header_type));
+    rl_arrow_put_offset(&builder, root, message);
+
+    size_t const schema = rl_arrow_add_schema(&builder, file_header);
+    rl_arrow_put_offset(&builder, rl_arrow_field(message, 2), schema);
+
+    size_t const length = rl_arrow_finish_message(&builder);
+    if (length == 0) {
+        return 0;
+    }
+    return magic_length + length;
+}
+
+size_t rl_arrow_encode_batch(uint8_t *const buffer, size_t size,
+                             size_t binary_count, size_t analog_count,
+                             size_t row_count,
+                             rl_timestamp_t const *const timestamp_realtime,
+                             rl_timestamp_t const *const timestamp_monotonic) {
+    size_t const column_count = binary_count + analog_count;
+    rl_arrow_builder_t builder = {
+        .buffer = buffer,
+        .size = size,
+        .length = 0,
+        .overflow = false,
+    };
+    rl_arrow_reserve(&builder, 2 * sizeof(uint32_t), sizeof(uint32_t));
+    size_t const root = rl_arrow_reserve(&builder, sizeof(uint32_t),
+                                         sizeof(uint32_t));
+
+    // message: version, header type, header, body length, custom metadata
+    size_t const message = rl_arrow_add_table(&builder, 5, 0x1f);
+    int16_t const version = RL_ARROW_METADATA_VERSION;
+    uint8_t const header_type = RL_ARROW_HEADER_RECORD_BATCH;
+    rl_arrow_put(&builder, rl_arrow_field(message, 0), &version,
+                 sizeof(version));
+    rl_arrow_put(&builder, rl_arrow_field(message, 1), &header_type,
+                 sizeof(header_type));
+    rl_arrow_put_offset(&builder, root, message);
+
+    // record batch: length, field nodes, buffers
+    size_t const batch = rl_arrow_add_table(&builder, 3, 0x07);
+    int64_t const length = (int64_t)row_count;
+    rl_arrow_put(&builder, rl_arrow_field(batch, 0), &length, sizeof(length));
+    rl_arrow_put_offset(&builder, rl_arrow_field(message, 2), batch);
+
+    // one field node of the batch length without nulls per column
+    size_t const nodes = rl_arrow_add_vector(
+        &builder, column_count, RL_ARROW_STRUCT_BYTES, sizeof(int64_t));
+    rl_arrow_put_offset(&builder, rl_arrow_field(batch, 1), nodes);
+    for (size_t i = 0; i < column_count; i++) {
+        rl_arrow_put(&builder,
+                     nodes + sizeof(uint32_t) + i * RL_ARROW_STRUCT_BYTES,
+                     &length, sizeof(length));
+    }
+
+    // empty validity buffer and data buffer per column, stored back to back
+    size_t const buffers = rl_arrow_add_vector(
+        &builder, 2 * column_count, RL_ARROW_STRUCT_BYTES, sizeof(int64_t));
+    rl_arrow_put_offset(&builder, rl_arrow_field(batch, 2), buffers);
+    int64_t body_offset = 0;
+    for (size_t i = 0; i < column_count; i++) {
+        bool const binary = (i < binary_count);
+        int64_t const data_length =
+            (int64_t)rl_arrow_get_column_data_bytes(binary, row_count);
+        size_t const position = buffers + sizeof(uint32_t) +
+                                (2 * i + 1) * RL_ARROW_STRUCT_BYTES;
+        rl_arrow_put(&builder, position - RL_ARROW_STRUCT_BYTES, &body_offset,
+                     sizeof(body_offset));
+        rl_arrow_put(&builder, position, &body_offset, sizeof(body_offset));
+        rl_arrow_put(&builder, position + sizeof(int64_t), &data_length,
+                     sizeof(data_length));
+        body_offset += (int64_t)rl_arrow_get_column_bytes(binary, row_count);
+    }
+    rl_arrow_put(&builder, rl_arrow_field(message, 3), &body_offset,
+                 sizeof(body_offset));
+
+    // data block timestamps in nanoseconds
+    char realtime[RL_ARROW_VALUE_LENGTH];
+    char monotonic[RL_ARROW_VALUE_LENGTH];
+    snprintf(realtime, sizeof(realtime), "%lld",
+             (long long)(timestamp_realtime->sec * 1000000000LL +
+                         timestamp_realtime->nsec));
+    snprintf(monotonic, sizeof(monotonic), "%lld",
+             (long long)(timestamp_monotonic->sec * 1000000000LL +
+                         timestamp_monotonic->nsec));
+    size_t const metadata =
+        rl_arrow_add_vector(&builder, 2, sizeof(uint32_t), sizeof(uint32_t));
+    rl_arrow_put_offset(&builder, rl_arrow_field(message, 4), metadata);
+    rl_arrow_put_offset(
+        &builder, metadata + sizeof(uint32_t),
+        rl_arrow_add_key_value(&builder, "timestamp_realtime", realtime));
+    rl_arrow_put_offset(
+        &builder, metadata + 2 * sizeof(uint32_t),
+        rl_arrow_add_key_value(&builder, "timestamp_monotonic", monotonic));
+
+    return rl_arrow_finish_message(&builder);
+}
+
+size_t rl_arrow_encode_footer(uint8_t *const buffer, size_t size,
+                              rl_file_header_t const *const file_header,
+                              rl_arrow_block_t const *blocks,
+                              size_t block_count) {
+    // end of stream marker: continuation marker and zero metadata length
+    uint32_t const end_of_stream[2] = {RL_ARROW_CONTINUATION, 0};
+    if (size < sizeof(end_of_stream)) {
+        errno = ENOBUFS;
+        return 0;
+    }
+    memcpy(buffer, end_of_stream, sizeof(end_of_stream));
+
+    rl_arrow_builder_t builder = {
+        .buffer = buffer + sizeof(end_of_stream),
+        .size = size - sizeof(end_of_stream),
+        .length = 0,
+        .overflow = false,
+    };
+    size_t const root = rl_arrow_reserve(&builder, sizeof(uint32_t),
+                                         sizeof(uint32_t));
+
+    // footer: version, schema, dictionaries, record batches
+    size_t const footer = rl_arrow_add_table(&builder, 4, 0x0f);
+    int16_t const version = RL_ARROW_METADATA_VERSION;
+    rl_arrow_put(&builder, rl_arrow_field(footer, 0), &version,
+                 sizeof(version));
+    rl_arrow_put_offset(&builder, root, footer);
+
+    size_t const schema = rl_arrow_add_schema(&builder, file_header);
+    rl_arrow_put_offset(&builder, rl_arrow_field(footer, 1), schema);
+
+    size_t const dictionaries = rl_arrow_add_vector(
+        &builder, 0, RL_ARROW_BLOCK_BYTES, sizeof(int64_t));
+    rl_arrow_put_offset(&builder, rl_arrow_field(footer, 2), dictionaries);
+
+    size_t const batches = rl_arrow_add_vector(
+        &builder, block_count, RL_ARROW_BLOCK_BYTES, sizeof(int64_t));
+    rl_arrow_put_offset(&builder, rl_arrow_field(footer, 3), batches);
+    for (size_t i = 0; i < block_count; i++) {
+        size_t const position =
+            batches + sizeof(uint32_t) + i * RL_ARROW_BLOCK_BYTES;
+        int64_t const offset = (int64_t)blocks[i].offset;
+        int32_t const metadata_length = (int32_t)blocks[i].metadata_length;
+        int64_t const body_length = (int64_t)blocks[i].body_length;
+        rl_arrow_put(&builder, position, &offset, sizeof(offset));
+        rl_arrow_put(&builder, position + sizeof(int64_t), &metadata_length,
+                     sizeof(metadata_length));
+        rl_arrow_put(&builder, position + 2 * sizeof(int64_t), &body_length,
+                     sizeof(body_length));
+    }
+
+    // footer size and file magic
+    int32_t const footer_length = (int32_t)builder.length;
+    size_t const trailer =
+        rl_arrow_reserve(&builder, sizeof(int32_t) + RL_ARROW_MAGIC_LENGTH, 1);
+    rl_arrow_put(&builder, trailer, &footer_length, sizeof(footer_length));
+    rl_arrow_put(&builder, trailer + sizeof(int32_t), RL_ARROW_MAGIC,
+                 RL_ARROW_MAGIC_LENGTH);
+    if (builder.overflow) {
+        errno = ENOBUFS;
+        return 0;
+    }
+
+    return sizeof(end_of_stream) + builder.length;
+}
+
+static size_t rl_arrow_reserve(rl_arrow_builder_t *const builder,
+                               size_t length, size_t alignment) {
+    size_t const position =
+        (builder->length + alignment - 1) & ~(size_t)(alignment - 1);
+    if (position + length > builder->size) {
+        builder->overflow = true;
+        return position;
+    }
+
+    memset(builder->buffer + builder->length, 0,
+           position + length - builder->length);
+    builder->length = position + length;
+    return position;
+}
+
+static void rl_arrow_put(rl_arrow_builder_t *const builder, size_t position,
+                         void const *value, size_t length) {
+    if (builder->overflow || position + length > builder->length) {
+        return;
+    }
+    memcpy(builder->buffer + position, value, length);
+}
+
+static void rl_arrow_put_offset(rl_arrow_builder_t *const builder,
+                                size_t position, size_t target) {
+    uint32_t const offset = (uint32_t)(target - position);
+    rl_arrow_put(builder, position, &offset, sizeof(offset));
+}
+
+static size_t rl_arrow_add_table(rl_arrow_builder_t *const builder,
+                                 uint16_t field_count, uint32_t field_mask) {
+    // vtable: vtable size, table size and field positions in the table
+    size_t const vtable_length = (2 + field_count) * sizeof(uint16_t);
+    size_t const vtable =
+        rl_arrow_reserve(builder, vtable_length, sizeof(uint16_t));
+    uint16_t const header[2] = {
+        (uint16_t)vtable_length,
+        (uint16_t)(RL_ARROW_FIELD_BYTES * (field_count + 1)),
+    };
+    rl_arrow_put(builder, vtable, header, sizeof(header));
+    for (uint16_t i = 0; i < field_count; i++) {
+        uint16_t const position =
+            (field_mask & (1 << i)) ? (uint16_t)(rl_arrow_field(0, i)) : 0;
+        rl_arrow_put(builder, vtable + (2 + i) * sizeof(uint16_t), &position,
+                     sizeof(position));
+    }
+
+    // table: offset back to the vtable followed by the field slots
+    size_t const table = rl_arrow_reserve(
+        builder, RL_ARROW_FIELD_BYTES * (field_count + 1), sizeof(uint64_t));
+    int32_t const vtable_offset = (int32_t)(table - vtable);
+    rl_arrow_put(builder, table, &vtable_offset, sizeof(vtable_offset));
+
+    return table;
+}
+
+static inline size_t rl_arrow_field(size_t table, uint16_t field) {
+    return table + RL_ARROW_FIELD_BYTES * (field + 1);
+}
+
+static size_t rl_arrow_add_string(rl_arrow_builder_t *const builder,
+                                  char const *string) {
+    uint32_t const length = (uint32_t)strlen(string);
+
+    // length prefix, characters and zero termination
+    size_t const position = rl_arrow_reserve(
+        builder, sizeof(uint32_t) + length + 1, sizeof(uint32_t));
+    rl_arrow_put(builder, position, &length, sizeof(length));
+    rl_arrow_put(builder, position + sizeof(uint32_t), string, length);
+
+    return position;
+}
+
+static size_t rl_arrow_add_vector(rl_arrow_builder_t *const builder,
+                                  size_t count, size_t element_size,
+                                  size_t alignment) {
+    // align elements after the length prefix (alignment of at least 4 bytes)
+    size_t const position_aligned =
+        (builder->length + sizeof(uint32_t) + alignment - 1) /
+            alignment * alignment -
+        sizeof(uint32_t);
+    rl_arrow_reserve(builder, position_aligned - builder->length, 1);
+
+    uint32_t const length = (uint32_t)count;
+    size_t const position = rl_arrow_reserve(
+        builder, sizeof(uint32_t) + count * element_size, sizeof(uint32_t));
+    rl_arrow_put(builder, position, &length, sizeof(length));
+
+    return position;
+}
+
+static size_t rl_arrow_add_key_value(rl_arrow_builder_t *const builder,
+                                     char const *key, char const *value) {
+    size_t const table = rl_arrow_add_table(builder, 2, 0x03);
+    rl_arrow_put_offset(builder, rl_arrow_field(table, 0),
+                        rl_arrow_add_string(builder, key));
+    rl_arrow_put_offset(builder, rl_arrow_field(table, 1),
+                        rl_arrow_add_string(builder, value));
+    return table;
+}
+
+static size_t rl_arrow_add_schema(rl_arrow_builder_t *const builder,
+                                  rl_file_header_t const *const file_header) {
+    rl_file_lead_in_t const *const lead_in = &file_header->lead_in;
+    int const channel_count = lead_in->channel_bin_count + lead_in->channel_count;
+
+    // schema: endianness (little endian by default), fields, custom metadata
+    size_t const schema = rl_arrow_add_table(builder, 3, 0x06);
+
+    size_t const fields = rl_arrow_add_vector(builder, channel_count,
+                                              sizeof(uint32_t),
+                                              sizeof(uint32_t));
+    rl_arrow_put_offset(builder, rl_arrow_field(schema, 1), fields);
+    for (int i = 0; i < channel_count; i++) {
+        rl_arrow_put_offset(builder, fields + (i + 1) * sizeof(uint32_t),
+                            rl_arrow_add_field(builder, file_header, i));
+    }
+
+    // measurement metadata
+    char sample_rate[RL_ARROW_VALUE_LENGTH];
+    char start_time[RL_ARROW_VALUE_LENGTH];
+    char mac_address[3 * MAC_ADDRESS_LENGTH];
+    snprintf(sample_rate, sizeof(sample_rate), "%u",
+             (uint32_t)lead_in->sample_rate);
+    snprintf(start_time, sizeof(start_time), "%lld",
+             (long long)(lead_in->start_time.sec * 1000000000LL +
+                         lead_in->start_time.nsec));
+    for (int i = 0; i < MAC_ADDRESS_LENGTH; i++) {
+        snprintf(mac_address + 3 * i, sizeof(mac_address) - 3 * i, "%02x:",
+                 (uint32_t)lead_in->mac_address[i]);
+    }
+    mac_address[3 * MAC_ADDRESS_LENGTH - 1] = 0;
+
+    size_t const metadata =
+        rl_arrow_add_vector(builder, 4, sizeof(uint32_t), sizeof(uint32_t));
+    rl_arrow_put_offset(builder, rl_arrow_field(schema, 2), metadata);
+    rl_arrow_put_offset(
+        builder, metadata + sizeof(uint32_t),
+        rl_arrow_add_key_value(builder, "sample_rate", sample_rate));
+    rl_arrow_put_offset(
+        builder, metadata + 2 * sizeof(uint32_t),
+        rl_arrow_add_key_value(builder, "start_time", start_time));
+    rl_arrow_put_offset(
+        builder, metadata + 3 * sizeof(uint32_t),
+        rl_arrow_add_key_value(builder, "mac_address", mac_address));
+    rl_arrow_put_offset(
+        builder, metadata + 4 * sizeof(uint32_t),
+        rl_arrow_add_key_value(builder, "comment", file_header->comment));
+
+    return schema;
+}
+
+static size_t rl_arrow_add_field(rl_arrow_builder_t *const builder,
+                                 rl_file_header_t const *const file_header,
+                                 int index) {
+    rl_file_channel_t const *const channel = &file_header->channel[index];
+    int const channel_count = file_header->lead_in.channel_bin_count +
+                              file_header->lead_in.channel_count;
+    bool const binary = (index < file_header->lead_in.channel_bin_count);
+
+    // field: name, (not) nullable, type, children, custom metadata
+    size_t const field = rl_arrow_add_table(builder, 7, 0x6d);
+    uint8_t const type_type = binary ? RL_ARROW_TYPE_BOOL : RL_ARROW_TYPE_INT;
+    rl_arrow_put(builder, rl_arrow_field(field, 2), &type_type,
+                 sizeof(type_type));
+
+    char name[RL_FILE_CHANNEL_NAME_LENGTH + 1] = {0};
+    memcpy(name, channel->name, RL_FILE_CHANNEL_NAME_LENGTH);
+    rl_arrow_put_offset(builder, rl_arrow_field(field, 0),
+                        rl_arrow_add_string(builder, name));
+
+    // boolean type without properties, or 32 bit signed integer type
+    size_t type = 0;
+    if (binary) {
+        type = rl_arrow_add_table(builder, 0, 0x00);
+    } else {
+        type = rl_arrow_add_table(builder, 2, 0x03);
+        int32_t const bit_width = 32;
+        uint8_t const is_signed = 1;
+        rl_arrow_put(builder, rl_arrow_field(type, 0), &bit_width,
+                     sizeof(bit_width));
+        rl_arrow_put(builder, rl_arrow_field(type, 1), &is_signed,
+                     sizeof(is_signed));
+    }
+    rl_arrow_put_offset(builder, rl_arrow_field(field, 3), type);
+
+    size_t const children =
+        rl_arrow_add_vector(builder, 0, sizeof(uint32_t), sizeof(uint32_t));
+    rl_arrow_put_offset(builder, rl_arrow_field(field, 5), children);
+
+    // channel unit, scale and linked valid channel
+    char const *unit = rl_unit_to_string(channel->unit);
+    char scale[RL_ARROW_VALUE_LENGTH];
+    snprintf(scale, sizeof(scale), "%d", (int)channel->channel_scale);
+    bool const linked = (channel->valid_data_channel < channel_count);
+
+    size_t const metadata = rl_arrow_add_vector(
+        builder, linked ? 3 : 2, sizeof(uint32_t), sizeof(uint32_t));
+    rl_arrow_put_offset(builder, rl_arrow_field(field, 6), metadata);
+    rl_arrow_put_offset(
+        builder, metadata + sizeof(uint32_t),
+        rl_arrow_add_key_value(builder, "unit", (unit != NULL) ? unit : ""));
+    rl_arrow_put_offset(builder, metadata + 2 * sizeof(uint32_t),
+                        rl_arrow_add_key_value(builder, "scale", scale));
+    if (linked) {
+        char valid_name[RL_FILE_CHANNEL_NAME_LENGTH + 1] = {0};
+        memcpy(valid_name,
+               file_header->channel[channel->valid_data_channel].name,
+               RL_FILE_CHANNEL_NAME_LENGTH);
+        rl_arrow_put_offset(
+            builder, metadata + 3 * sizeof(uint32_t),
+            rl_arrow_add_key_value(builder, "valid_channel", valid_name));
+    }
+
+    return field;
+}
+
+static size_t rl_arrow_finish_message(rl_arrow_builder_t *const builder) {
+    // pad flatbuffer such that the message body is aligned
+    size_t const length =
+        (builder->length + RL_ARROW_ALIGNMENT - 1) &
+        ~(size_t)(RL_ARROW_ALIGNMENT - 1);
+    rl_arrow_reserve(builder, length - builder->length, 1);
+    if (builder->overflow) {
+        errno = ENOBUFS;
+        return 0;
+    }
+
+    // prefix of continuation marker and flatbuffer length
+    uint32_t const prefix[2] = {
+        RL_ARROW_CONTINUATION,
+        (uint32_t)(length - sizeof(prefix)),
+    };
+    memcpy(builder->buffer, prefix, sizeof(prefix));
+
+    return length;
+}
+
+static size_t rl_arrow_get_column_data_bytes(bool binary, size_t row_count) {
+    if (binary) {
+        return (row_count + 7) / 8;
+    }
+    return row_count * sizeof(int32_t);
+}
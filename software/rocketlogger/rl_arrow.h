@@ -0,0 +1,160 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RL_ARROW_H_
+#define RL_ARROW_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rl.h"
+#include "rl_file.h"
+
+/// Arrow IPC file magic string, at the start and end of the file
+#define RL_ARROW_MAGIC "ARROW1"
+/// Length of the Arrow IPC file magic string
+#define RL_ARROW_MAGIC_LENGTH 6
+/// Alignment of the Arrow IPC messages and record batch body buffers
+#define RL_ARROW_ALIGNMENT 8
+/// Arrow IPC file extension
+#define RL_ARROW_EXTENSION ".arrow"
+/// Maximum size of an encoded record batch message without its body in bytes
+#define RL_ARROW_BATCH_METADATA_BYTES_MAX 2048
+
+/**
+ * Location of a record batch message in an Arrow IPC file, as listed in the
+ * file footer.
+ */
+struct rl_arrow_block {
+    /// File offset of the message
+    uint64_t offset;
+    /// Size of the message metadata, including its prefix and padding
+    uint32_t metadata_length;
+    /// Size of the message body
+    uint64_t body_length;
+};
+
+/**
+ * Typedef for the location of a record batch message in an Arrow IPC file.
+ */
+typedef struct rl_arrow_block rl_arrow_block_t;
+
+/**
+ * Get the maximum size of the encoded Arrow IPC file header.
+ *
+ * @param file_header The file header to encode
+ * @return Maximum size of the encoded file header in bytes
+ */
+size_t rl_arrow_get_header_bytes_max(rl_file_header_t const *const file_header);
+
+/**
+ * Get the maximum size of the encoded Arrow IPC file footer.
+ *
+ * @param file_header The file header to encode the schema of
+ * @param block_count Number of record batches stored in the file
+ * @return Maximum size of the encoded file footer in bytes
+ */
+size_t rl_arrow_get_footer_bytes_max(rl_file_header_t const *const file_header,
+                                     size_t block_count);
+
+/**
+ * Get the size of a column's buffer in a record batch body, including its
+ * padding.
+ *
+ * Binary channels are stored as bit-packed boolean columns, all other channels
+ * as 32 bit signed integer columns.
+ *
+ * @param binary Whether the column is a binary channel
+ * @param row_count Number of rows of the record batch
+ * @return Size of the column buffer in bytes
+ */
+size_t rl_arrow_get_column_bytes(bool binary, size_t row_count);
+
+/**
+ * Encode the Arrow IPC file header, i.e. the file magic followed by the schema
+ * message.
+ *
+ * The schema contains one field per channel of the file header, in the same
+ * order. Each field carries the channel unit, scale (as power of ten) and
+ * linked valid channel as field metadata, the schema carries the sample rate,
+ * start time, instrument MAC address and comment as schema metadata.
+ *
+ * @param buffer Buffer to store the file header to
+ * @param size Size of the buffer in bytes
+ * @param file_header The file header to encode
+ * @return Size of the encoded file header, 0 on failure with errno set
+ * accordingly
+ */
+size_t rl_arrow_encode_header(uint8_t *const buffer, size_t size,
+                              rl_file_header_t const *const file_header);
+
+/**
+ * Encode the metadata of a record batch message, i.e. the message prefix and
+ * record batch description without the body.
+ *
+ * The body stores the binary columns first followed by the analog columns,
+ * each using rl_arrow_get_column_bytes() bytes. The timestamps of the data
+ * block are stored as message metadata in nanoseconds.
+ *
+ * @param buffer Buffer to store the message metadata to
+ * @param size Size of the buffer in bytes
+ * @param binary_count Number of binary columns
+ * @param analog_count Number of analog columns
+ * @param row_count Number of rows of the record batch
+ * @param timestamp_realtime Timestamp sampled from realtime clock
+ * @param timestamp_monotonic Timestamp sampled from monotonic clock
+ * @return Size of the encoded message metadata, 0 on failure with errno set
+ * accordingly
+ */
+size_t rl_arrow_encode_batch(uint8_t *const buffer, size_t size,
+                             size_t binary_count, size_t analog_count,
+                             size_t row_count,
+                             rl_timestamp_t const *const timestamp_realtime,
+                             rl_timestamp_t const *const timestamp_monotonic);
+
+/**
+ * Encode the Arrow IPC file footer, i.e. the end of stream marker, the footer
+ * listing the record batches, the footer size and the file magic.
+ *
+ * @param buffer Buffer to store the file footer to
+ * @param size Size of the buffer in bytes
+ * @param file_header The file header to encode the schema of
+ * @param blocks Locations of the record batches stored in the file
+ * @param block_count Number of record batches stored in the file
+ * @return Size of the encoded file footer, 0 on failure with errno set
+ * accordingly
+ */
+size_t rl_arrow_encode_footer(uint8_t *const buffer, size_t size,
+                              rl_file_header_t const *const file_header,
+                              rl_arrow_block_t const *blocks,
+                              size_t block_count);
+
+#endif /* RL_ARROW_H_ */
@@ -0,0 +1,185 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#elif defined(__x86_64__) && defined(__GNUC__)
+#include <nmmintrin.h>
+#endif
+
+#include "rl_crc.h"
+
+/// Reversed CRC-32C (Castagnoli) polynomial
+#define RL_CRC32C_POLYNOMIAL 0x82F63B78
+
+/// CRC-32C lookup tables for processing 8 bytes at once (slicing-by-8)
+static uint32_t rl_crc32c_table[8][256];
+
+/// One-time initialization control of the lookup tables
+static pthread_once_t rl_crc32c_table_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Generate the CRC-32C lookup tables.
+ */
+static void rl_crc32c_table_init(void);
+
+/**
+ * Update a CRC-32C checksum using the lookup tables (slicing-by-8).
+ *
+ * @param crc The inverted checksum of the preceding data
+ * @param data The data to checksum
+ * @param length The length of the data in bytes
+ * @return The inverted checksum of the preceding data and the data range
+ */
+static uint32_t rl_crc32c_table_update(uint32_t crc, uint8_t const *data,
+                                       size_t length);
+
+#if defined(__ARM_FEATURE_CRC32) ||                                            \
+    (defined(__x86_64__) && defined(__GNUC__))
+/**
+ * Update a CRC-32C checksum using the processor's CRC32 instructions.
+ *
+ * @param crc The inverted checksum of the preceding data
+ * @param data The data to checksum
+ * @param length The length of the data in bytes
+ * @return The inverted checksum of the preceding data and the data range
+ */
+static uint32_t rl_crc32c_hw_update(uint32_t crc, uint8_t const *data,
+                                    size_t length);
+#endif
+
+uint32_t rl_crc32c(uint32_t crc, void const *data, size_t length) {
+    uint8_t const *const bytes = (uint8_t const *)data;
+
+#if defined(__ARM_FEATURE_CRC32)
+    return ~rl_crc32c_hw_update(~crc, bytes, length);
+#else
+#if defined(__x86_64__) && defined(__GNUC__)
+    if (__builtin_cpu_supports("sse4.2")) {
+        return ~rl_crc32c_hw_update(~crc, bytes, length);
+    }
+#endif
+    pthread_once(&rl_crc32c_table_once, rl_crc32c_table_init);
+    return ~rl_crc32c_table_update(~crc, bytes, length);
+#endif
+}
+
+static void rl_crc32c_table_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ ((crc & 0x01) ? RL_CRC32C_POLYNOMIAL : 0);
+        }
+        rl_crc32c_table[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int t = 1; t < 8; t++) {
+            uint32_t const crc = rl_crc32c_table[t - 1][i];
+            rl_crc32c_table[t][i] =
+                (crc >> 8) ^ rl_crc32c_table[0][crc & 0xff];
+        }
+    }
+}
+
+static uint32_t rl_crc32c_table_update(uint32_t crc, uint8_t const *data,
+                                       size_t length) {
+    // process 8 bytes at once, the data is stored little endian
+    while (length >= 8) {
+        uint32_t low;
+        uint32_t high;
+        memcpy(&low, data, sizeof(low));
+        memcpy(&high, data + sizeof(low), sizeof(high));
+        low ^= crc;
+        crc = rl_crc32c_table[7][low & 0xff] ^
+              rl_crc32c_table[6][(low >> 8) & 0xff] ^
+              rl_crc32c_table[5][(low >> 16) & 0xff] ^
+              rl_crc32c_table[4][low >> 24] ^
+              rl_crc32c_table[3][high & 0xff] ^
+              rl_crc32c_table[2][(high >> 8) & 0xff] ^
+              rl_crc32c_table[1][(high >> 16) & 0xff] ^
+              rl_crc32c_table[0][high >> 24];
+        data += 8;
+        length -= 8;
+    }
+
+    while (length > 0) {
+        crc = (crc >> 8) ^ rl_crc32c_table[0][(crc ^ *data) & 0xff];
+        data++;
+        length--;
+    }
+
+    return crc;
+}
+
+#if defined(__ARM_FEATURE_CRC32)
+static uint32_t rl_crc32c_hw_update(uint32_t crc, uint8_t const *data,
+                                    size_t length) {
+    while (length >= sizeof(uint32_t)) {
+        uint32_t value;
+        memcpy(&value, data, sizeof(value));
+        crc = __crc32cw(crc, value);
+        data += sizeof(value);
+        length -= sizeof(value);
+    }
+    while (length > 0) {
+        crc = __crc32cb(crc, *data);
+        data++;
+        length--;
+    }
+
+    return crc;
+}
+#elif defined(__x86_64__) && defined(__GNUC__)
+__attribute__((target("sse4.2"))) static uint32_t
+rl_crc32c_hw_update(uint32_t crc, uint8_t const *data, size_t length) {
+    uint64_t crc64 = crc;
+    while (length >= sizeof(uint64_t)) {
+        uint64_t value;
+        memcpy(&value, data, sizeof(value));
+        crc64 = _mm_crc32_u64(crc64, value);
+        data += sizeof(value);
+        length -= sizeof(value);
+    }
+    crc = (uint32_t)crc64;
+    while (length > 0) {
+        crc = _mm_crc32_u8(crc, *data);
+        data++;
+        length--;
+    }
+
+    return crc;
+}
+#endif
@@ -29,19 +29,28 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include <errno.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <fcntl.h>
 #include <linux/limits.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "log.h"
 #include "pru.h"
 #include "rl.h"
-#include "rl_file.h"
+#include "rl_arrow.h"
+#include "rl_crc.h"
 #include "sensor/sensor.h"
 #include "util.h"
 
@@ -77,6 +86,316 @@ void rl_file_setup_data_channels(rl_file_header_t *const header,
  */
 void rl_file_setup_ambient_channels(rl_file_header_t *const header);
 
+/**
+ * Write all data of an I/O vector to a file descriptor.
+ *
+ * Handles partial writes and interrupted system calls.
+ *
+ * @param fd The file descriptor to write to
+ * @param iov The I/O vector to write, updated to point to unwritten data
+ * @param iov_count Number of elements in the I/O vector
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int rl_file_writev_all(int fd, struct iovec *iov, int iov_count);
+
+/**
+ * Write a buffer to a file descriptor at a given offset.
+ *
+ * Handles partial writes and interrupted system calls.
+ *
+ * @param fd The file descriptor to write to
+ * @param buffer The data to write
+ * @param length Number of bytes to write
+ * @param offset File offset to write the data at
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int rl_file_pwrite_all(int fd, void const *buffer, size_t length,
+                              off_t offset);
+
+/// Cache line aligned buffer to assemble binary or CSV data blocks
+static uint8_t *rl_file_block_buffer = NULL;
+/// Size of the data block buffer in bytes
+static size_t rl_file_block_buffer_size = 0;
+/// Cache line aligned buffer of encoded samples to process data blocks further
+static uint8_t *rl_file_sample_buffer = NULL;
+/// Size of the sample buffer in bytes
+static size_t rl_file_sample_buffer_size = 0;
+/// Locations of the Arrow record batches stored since the last file footer
+static rl_arrow_block_t *rl_file_arrow_blocks = NULL;
+/// Number of Arrow record batches stored since the last file footer
+static size_t rl_file_arrow_block_count = 0;
+/// Number of Arrow record batch locations allocated
+static size_t rl_file_arrow_block_capacity = 0;
+
+/**
+ * Binary data block encoder function type.
+ *
+ * Appends the binary bit field and the enabled analog channels of consecutive
+ * samples to a data block buffer.
+ *
+ * @param block Data block buffer to append the encoded samples to
+ * @param analog_buffer Analog data of the samples to encode (channel-major)
+ * @param analog_stride Distance between the channels in the analog buffer
+ * @param digital_buffer Digital data of the samples to encode
+ * @param count Number of samples to encode
+ * @param channel_mask Enabled analog channels (bit i for channel index i)
+ * @param digital_enable Whether digital channels are stored
+ * @return Number of bytes appended to the data block buffer
+ */
+typedef size_t (*rl_file_encoder_t)(uint8_t *const block,
+                                    int32_t const *analog_buffer,
+                                    size_t analog_stride,
+                                    uint32_t const *digital_buffer,
+                                    size_t count, uint32_t channel_mask,
+                                    bool digital_enable);
+
+/**
+ * Get the enabled analog channels of a configuration as bit mask.
+ *
+ * @param config Current measurement configuration
+ * @return Enabled analog channels (bit i for channel index i)
+ */
+static uint32_t rl_file_get_channel_mask(rl_config_t const *const config);
+
+/**
+ * Select the binary data block encoder for the channel configuration.
+ *
+ * Returns an encoder specialized at compile time for common channel
+ * configurations, or the generic encoder otherwise.
+ *
+ * @param channel_mask Enabled analog channels (bit i for channel index i)
+ * @param digital_enable Whether digital channels are stored
+ * @return The data block encoder to use
+ */
+static rl_file_encoder_t rl_file_get_encoder(uint32_t channel_mask,
+                                             bool digital_enable);
+
+/**
+ * Get the number of data columns of a binary data block.
+ *
+ * @param config Current measurement configuration
+ * @return Number of data columns, including the binary bit field if stored
+ */
+static size_t rl_file_get_column_count(rl_config_t const *const config);
+
+/**
+ * Encode the binary bit field of a sample.
+ *
+ * @param digital_data Digital data of the sample
+ * @param digital_enable Whether digital channels are stored
+ * @param i1l_enable Whether the I1L valid channel is stored
+ * @param i2l_enable Whether the I2L valid channel is stored
+ * @return The binary bit field to store
+ */
+static inline uint32_t rl_file_encode_binary(uint32_t digital_data,
+                                             bool digital_enable,
+                                             bool i1l_enable, bool i2l_enable);
+
+/**
+ * Encode non-aggregated samples to the data columns of a channel-planar
+ * binary data block.
+ *
+ * @param block Data block buffer to append the data columns to
+ * @param analog_buffer Analog data of the samples to encode (channel-major)
+ * @param digital_buffer Digital data of the samples to encode
+ * @param buffer_size Number of samples to encode
+ * @param channel_mask Enabled analog channels (bit i for channel index i)
+ * @param digital_enable Whether digital channels are stored
+ * @return Number of bytes appended to the data block buffer
+ */
+static size_t rl_file_encode_columns(uint8_t *const block,
+                                     int32_t const *analog_buffer,
+                                     uint32_t const *digital_buffer,
+                                     size_t buffer_size, uint32_t channel_mask,
+                                     bool digital_enable);
+
+/**
+ * Transpose encoded samples to the data columns of a channel-planar binary
+ * data block.
+ *
+ * @param block Data block buffer to append the data columns to
+ * @param samples Encoded samples, with data columns of 32 bit each
+ * @param sample_count Number of encoded samples
+ * @param column_count Number of data columns per sample
+ * @return Number of bytes appended to the data block buffer
+ */
+static size_t rl_file_transpose_samples(uint8_t *const block,
+                                        uint8_t const *samples,
+                                        size_t sample_count,
+                                        size_t column_count);
+
+/**
+ * Aggregate samples and encode them to a binary data block.
+ *
+ * @param block Data block buffer to append the encoded samples to
+ * @param analog_buffer Analog data of the samples (channel-major)
+ * @param digital_buffer Digital data of the samples
+ * @param buffer_size Number of samples in the buffers
+ * @param config Current measurement configuration
+ * @return Number of bytes appended to the data block buffer
+ */
+static size_t rl_file_process_samples(uint8_t *const block,
+                                      int32_t const *analog_buffer,
+                                      uint32_t const *digital_buffer,
+                                      size_t buffer_size,
+                                      rl_config_t const *const config);
+
+/**
+ * Encode the sampling data buffer to a binary data block without checksum.
+ *
+ * @param block Buffer of at least rl_file_get_data_block_bytes_max() bytes
+ * @param analog_buffer Analog data buffer to process (channel-major)
+ * @param digital_buffer Digital data buffer to process
+ * @param buffer_size Number of data samples in the buffer
+ * @param timestamp_realtime Timestamp sampled from realtime clock
+ * @param timestamp_monotonic Timestamp sampled from monotonic clock
+ * @param config Current measurement configuration
+ * @return Number of bytes encoded, 0 on failure with errno set accordingly
+ */
+static size_t rl_file_encode_block_content(
+    uint8_t *const block, int32_t const *analog_buffer,
+    uint32_t const *digital_buffer, size_t buffer_size,
+    rl_timestamp_t const *const timestamp_realtime,
+    rl_timestamp_t const *const timestamp_monotonic,
+    rl_config_t const *const config);
+
+/**
+ * Encode samples to an Arrow record batch message.
+ *
+ * Non-aggregated samples are encoded to data columns directly, aggregated
+ * samples are encoded to the data block buffer and transposed first.
+ *
+ * @param block Buffer to store the record batch message to
+ * @param analog_buffer Analog data of the samples (channel-major)
+ * @param digital_buffer Digital data of the samples
+ * @param buffer_size Number of samples in the buffers
+ * @param timestamp_realtime Timestamp sampled from realtime clock
+ * @param timestamp_monotonic Timestamp sampled from monotonic clock
+ * @param config Current measurement configuration
+ * @param arrow_block Record batch location to store the metadata and body
+ * length to
+ * @return Size of the record batch message, 0 on failure with errno set
+ * accordingly
+ */
+static size_t rl_file_encode_arrow_batch(
+    uint8_t *const block, int32_t const *analog_buffer,
+    uint32_t const *digital_buffer, size_t buffer_size,
+    rl_timestamp_t const *const timestamp_realtime,
+    rl_timestamp_t const *const timestamp_monotonic,
+    rl_config_t const *const config, rl_arrow_block_t *const arrow_block);
+
+/**
+ * Get the maximum size of an Arrow record batch message.
+ *
+ * @param buffer_size Maximum number of data samples per block
+ * @return Maximum record batch message size in bytes
+ */
+static size_t rl_file_get_arrow_block_bytes_max(size_t buffer_size);
+
+/**
+ * Get the maximum size of a CSV data block, for fixed width data rows.
+ *
+ * @param buffer_size Maximum number of data samples per block
+ * @return Maximum CSV data block size in bytes
+ */
+static size_t rl_file_get_csv_block_bytes_max(size_t buffer_size);
+
+/**
+ * Format encoded samples as CSV data rows.
+ *
+ * @param buffer Buffer to store the data rows to
+ * @param samples Encoded samples, with data columns of 32 bit each
+ * @param sample_count Number of encoded samples
+ * @param timestamp_realtime Timestamp of the first data row
+ * @param config Current measurement configuration
+ * @return Number of characters stored to the buffer
+ */
+static size_t
+rl_file_format_csv_rows(char *const buffer, uint8_t const *samples,
+                        size_t sample_count,
+                        rl_timestamp_t const *const timestamp_realtime,
+                        rl_config_t const *const config);
+
+/**
+ * Format a normalized timestamp as decimal seconds, right-aligned to a
+ * minimum width.
+ *
+ * @param buffer Buffer to store the characters to
+ * @param timestamp The timestamp to format, nanoseconds below one second
+ * @param width Minimum number of characters, padded with leading spaces
+ * @return Number of characters stored to the buffer
+ */
+static size_t rl_file_format_timestamp(char *const buffer,
+                                       rl_timestamp_t const *const timestamp,
+                                       size_t width);
+
+/**
+ * Format a signed integer in decimal, right-aligned to a minimum width.
+ *
+ * Uses fixed size stores that overwrite up to RL_FILE_CSV_FORMAT_OVERRUN bytes
+ * following the formatted value.
+ *
+ * @param buffer Buffer to store the characters to
+ * @param value The value to format
+ * @param width Minimum number of characters, padded with leading spaces
+ * @return Number of characters stored to the buffer
+ */
+static inline size_t rl_file_format_int32(char *const buffer, int32_t value,
+                                          size_t width);
+
+/**
+ * Count the decimal digits of an unsigned integer.
+ *
+ * @param value The value to count the digits of
+ * @return Number of decimal digits, at least one
+ */
+static inline size_t rl_file_count_digits(uint32_t value);
+
+/**
+ * Format four decimal digits to a 32 bit word (little endian).
+ *
+ * @param value The value to format, less than 10000
+ * @return The four digit characters, the first in the lowest byte
+ */
+static inline uint32_t rl_file_format_digits4(uint32_t value);
+
+/**
+ * Format an unsigned integer in decimal, backwards from the end of a buffer.
+ *
+ * @param end End of the buffer to store the characters to
+ * @param value The value to format
+ * @return Pointer to the first character stored
+ */
+static inline char *rl_file_format_digits(char *const end, uint32_t value);
+
+/**
+ * Compress encoded samples to a compressed binary data block.
+ *
+ * @param block Data block buffer to store the compressed data block to
+ * @param samples Encoded samples, with data columns of 32 bit each
+ * @param sample_count Number of encoded samples
+ * @param column_count Number of data columns per sample
+ * @param timestamp_realtime Timestamp sampled from realtime clock
+ * @param timestamp_monotonic Timestamp sampled from monotonic clock
+ * @return Number of bytes of the compressed data block
+ */
+static size_t rl_file_compress_samples(
+    uint8_t *const block, uint8_t const *samples, size_t sample_count,
+    size_t column_count, rl_timestamp_t const *const timestamp_realtime,
+    rl_timestamp_t const *const timestamp_monotonic);
+
+/**
+ * Bit-pack values of a given bit width, least significant bit first.
+ *
+ * @param buffer Buffer to store the packed values to
+ * @param values Values to pack, with no bits set above the bit width
+ * @param count Number of values to pack
+ * @param width Bit width of the values
+ * @return Number of bytes stored, padded to full bytes
+ */
+static size_t rl_file_pack_bits(uint8_t *const buffer, uint32_t const *values,
+                                size_t count, uint32_t width);
+
 /// Global variable to determine i1l valid channel index
 int i1l_valid_channel = 0;
 /// Global variable to determine i2l valid channel index
@@ -115,6 +434,98 @@ char *rl_file_get_ambient_file_name(char const *const data_file_name) {
     return ambient_file_name;
 }
 
+char *rl_file_get_index_file_name(char const *const data_file_name) {
+    static char index_file_name[PATH_MAX];
+
+    // replace the file ending of the file name, if any
+    snprintf(index_file_name, PATH_MAX - strlen(RL_FILE_INDEX_EXTENSION), "%s",
+             data_file_name);
+    char *file_ending = strrchr(index_file_name, '.');
+    if (file_ending == NULL || strchr(file_ending, '/') != NULL) {
+        file_ending = index_file_name + strlen(index_file_name);
+    }
+    strcpy(file_ending, RL_FILE_INDEX_EXTENSION);
+
+    return index_file_name;
+}
+
+void rl_file_get_part_file_name(char *const part_file_name,
+                                char const *const file_name,
+                                uint32_t part_index) {
+    // file ending starts at last . character of the file base name
+    char const *file_ending = strrchr(file_name, '.');
+    char const *file_base = strrchr(file_name, '/');
+    if (file_ending == NULL || (file_base != NULL && file_ending < file_base)) {
+        file_ending = file_name + strlen(file_name);
+    }
+
+    // insert part number before file ending
+    snprintf(part_file_name, PATH_MAX, "%.*s_p%u%s",
+             (int)(file_ending - file_name), file_name, part_index,
+             file_ending);
+}
+
+int rl_file_block_buffer_init(size_t buffer_size,
+                              rl_file_format_t file_format) {
+    size_t const sample_size = rl_file_get_data_block_bytes_max(buffer_size);
+    size_t size = sample_size;
+    if (file_format == RL_FILE_FORMAT_CSV) {
+        size = rl_file_get_csv_block_bytes_max(buffer_size);
+    }
+    // record batches are assembled after aggregating samples in the buffer
+    if (file_format == RL_FILE_FORMAT_ARROW &&
+        rl_file_get_arrow_block_bytes_max(buffer_size) > size) {
+        size = rl_file_get_arrow_block_bytes_max(buffer_size);
+    }
+
+    // keep existing buffers if large enough
+    if (rl_file_block_buffer != NULL && rl_file_block_buffer_size >= size &&
+        rl_file_sample_buffer_size >= sample_size) {
+        return SUCCESS;
+    }
+    // grow without shrinking a block buffer previously sized for CSV blocks
+    if (size < rl_file_block_buffer_size) {
+        size = rl_file_block_buffer_size;
+    }
+    rl_file_block_buffer_deinit();
+
+    // data block buffer and buffer of encoded samples of binary block size
+    void *buffer = NULL;
+    void *sample_buffer = NULL;
+    int res = posix_memalign(&buffer, RL_FILE_BLOCK_BUFFER_ALIGNMENT, size);
+    if (res == 0) {
+        res = posix_memalign(&sample_buffer, RL_FILE_BLOCK_BUFFER_ALIGNMENT,
+                             sample_size);
+    }
+    if (res != 0) {
+        free(buffer);
+        errno = res;
+        rl_log(RL_LOG_ERROR,
+               "failed allocating data block buffer; %d message: %s", errno,
+               strerror(errno));
+        return ERROR;
+    }
+
+    rl_file_block_buffer = (uint8_t *)buffer;
+    rl_file_block_buffer_size = size;
+    rl_file_sample_buffer = (uint8_t *)sample_buffer;
+    rl_file_sample_buffer_size = sample_size;
+    return SUCCESS;
+}
+
+void rl_file_block_buffer_deinit(void) {
+    free(rl_file_block_buffer);
+    free(rl_file_sample_buffer);
+    rl_file_block_buffer = NULL;
+    rl_file_block_buffer_size = 0;
+    rl_file_sample_buffer = NULL;
+    rl_file_sample_buffer_size = 0;
+    free(rl_file_arrow_blocks);
+    rl_file_arrow_blocks = NULL;
+    rl_file_arrow_block_count = 0;
+    rl_file_arrow_block_capacity = 0;
+}
+
 void rl_file_setup_data_lead_in(rl_file_lead_in_t *const lead_in,
                                 rl_config_t const *const config) {
 
@@ -143,9 +554,22 @@ void rl_file_setup_data_lead_in(rl_file_lead_in_t *const lead_in,
     // lead_in setup
     lead_in->file_magic = RL_FILE_MAGIC;
     lead_in->file_version = RL_FILE_VERSION;
+    if (config->file_compress_enable) {
+        lead_in->file_version = RL_FILE_VERSION_COMPRESSED;
+    }
+    if (config->file_planar_enable) {
+        lead_in->file_version = RL_FILE_VERSION_PLANAR;
+    }
+    if (config->file_crc_enable) {
+        lead_in->file_version |= RL_FILE_VERSION_FLAG_CRC;
+    }
     lead_in->header_length =
         sizeof(rl_file_lead_in_t) + comment_length +
         (channel_count + channel_bin_count) * sizeof(rl_file_channel_t);
+    if (config->file_planar_enable) {
+        lead_in->header_length +=
+            rl_file_get_column_count(config) * sizeof(uint32_t);
+    }
     lead_in->data_block_size = config->sample_rate / config->update_rate;
     lead_in->data_block_count = 0; // needs to be updated
     lead_in->sample_count = 0;     // needs to be updated
@@ -231,9 +655,20 @@ void rl_file_store_header_bin(FILE *file_handle,
 
     file_header->lead_in.comment_length = comment_length + comment_align_bytes;
 
+    // channel-planar data blocks: one column per analog channel and bit field
+    int column_count = 0;
+    if ((file_header->lead_in.file_version & RL_FILE_VERSION_MASK) ==
+        RL_FILE_VERSION_PLANAR) {
+        column_count = file_header->lead_in.channel_count;
+        if (file_header->lead_in.channel_bin_count > 0) {
+            column_count++;
+        }
+    }
+
     file_header->lead_in.header_length =
         sizeof(rl_file_lead_in_t) + file_header->lead_in.comment_length +
-        total_channel_count * sizeof(rl_file_channel_t);
+        total_channel_count * sizeof(rl_file_channel_t) +
+        column_count * sizeof(uint32_t);
 
     // write lead-in
     fwrite(&(file_header->lead_in), sizeof(rl_file_lead_in_t), 1, file_handle);
@@ -248,6 +683,21 @@ void rl_file_store_header_bin(FILE *file_handle,
     // write channel information
     fwrite(file_header->channel, sizeof(rl_file_channel_t), total_channel_count,
            file_handle);
+
+    // write data column offsets within the channel-planar data blocks
+    if (column_count > 0) {
+        uint32_t const block_size = file_header->lead_in.data_block_size;
+        uint32_t column_offset = 2 * sizeof(rl_timestamp_t);
+        if (file_header->lead_in.channel_bin_count > 0) {
+            fwrite(&column_offset, sizeof(column_offset), 1, file_handle);
+            column_offset += block_size * sizeof(uint32_t);
+        }
+        for (int i = file_header->lead_in.channel_bin_count;
+             i < total_channel_count; i++) {
+            fwrite(&column_offset, sizeof(column_offset), 1, file_handle);
+            column_offset += block_size * file_header->channel[i].data_size;
+        }
+    }
     fflush(file_handle);
 }
 
@@ -321,30 +771,318 @@ void rl_file_store_header_csv(FILE *file_handle,
     fflush(file_handle);
 }
 
-void rl_file_update_header_bin(FILE *file_handle,
-                               rl_file_header_t const *const file_header) {
+int rl_file_update_header_bin(FILE *file_handle,
+                              rl_file_header_t const *const file_header) {
+    // rewrite lead-in in place without moving the stream position
+    int res = rl_file_pwrite_all(fileno(file_handle), &(file_header->lead_in),
+                                 sizeof(rl_file_lead_in_t), 0);
+    if (res < 0) {
+        rl_log(RL_LOG_ERROR, "failed updating file header; %d message: %s",
+               errno, strerror(errno));
+        return ERROR;
+    }
 
-    // seek to beginning and rewrite lead_in
-    rewind(file_handle);
-    fwrite(&(file_header->lead_in), sizeof(rl_file_lead_in_t), 1, file_handle);
+    return SUCCESS;
+}
+
+int rl_file_update_header_csv(FILE *file_handle,
+                              rl_file_header_t const *const file_header) {
+    char lead_in[256];
+
+    // format fixed width lead-in lines as stored by rl_file_store_header_csv
+    int length = snprintf(
+        lead_in, sizeof(lead_in),
+        "RocketLogger CSV File\n"
+        "File Version,%u\n"
+        "Block Size,%u\n"
+        "Block Count,%-20u\n"
+        "Sample Count,%-20llu\n",
+        (uint32_t)file_header->lead_in.file_version,
+        (uint32_t)file_header->lead_in.data_block_size,
+        (uint32_t)file_header->lead_in.data_block_count,
+        (uint64_t)file_header->lead_in.sample_count);
+
+    // rewrite lead-in in place without moving the stream position
+    int res = rl_file_pwrite_all(fileno(file_handle), lead_in, length, 0);
+    if (res < 0) {
+        rl_log(RL_LOG_ERROR, "failed updating file header; %d message: %s",
+               errno, strerror(errno));
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+void rl_file_store_header_arrow(FILE *file_handle,
+                                rl_file_header_t const *const file_header) {
+    size_t const size = rl_arrow_get_header_bytes_max(file_header);
+    uint8_t *const buffer = malloc(size);
+    if (buffer == NULL) {
+        rl_log(RL_LOG_ERROR, "failed allocating file header; %d message: %s",
+               errno, strerror(errno));
+        return;
+    }
+
+    size_t const length = rl_arrow_encode_header(buffer, size, file_header);
+    if (length == 0) {
+        rl_log(RL_LOG_ERROR, "failed encoding file header; %d message: %s",
+               errno, strerror(errno));
+    } else {
+        fwrite(buffer, 1, length, file_handle);
+    }
     fflush(file_handle);
-    fseek(file_handle, 0, SEEK_END);
+    free(buffer);
 }
 
-void rl_file_update_header_csv(FILE *file_handle,
+int rl_file_store_footer_arrow(FILE *file_handle,
                                rl_file_header_t const *const file_header) {
-    rewind(file_handle);
-    fprintf(file_handle, "RocketLogger CSV File\n");
-    fprintf(file_handle, "File Version,%u\n",
-            (uint32_t)file_header->lead_in.file_version);
-    fprintf(file_handle, "Block Size,%u\n",
-            (uint32_t)file_header->lead_in.data_block_size);
-    fprintf(file_handle, "Block Count,%-20u\n",
-            (uint32_t)file_header->lead_in.data_block_count);
-    fprintf(file_handle, "Sample Count,%-20llu\n",
-            (uint64_t)file_header->lead_in.sample_count);
+    size_t const size =
+        rl_arrow_get_footer_bytes_max(file_header, rl_file_arrow_block_count);
+    uint8_t *const buffer = malloc(size);
+    if (buffer == NULL) {
+        rl_log(RL_LOG_ERROR, "failed allocating file footer; %d message: %s",
+               errno, strerror(errno));
+        return ERROR;
+    }
+
+    // data blocks of the next file are listed in a new footer
+    size_t const length =
+        rl_arrow_encode_footer(buffer, size, file_header, rl_file_arrow_blocks,
+                               rl_file_arrow_block_count);
+    rl_file_arrow_block_count = 0;
+    if (length == 0 || fwrite(buffer, 1, length, file_handle) != length) {
+        rl_log(RL_LOG_ERROR, "failed storing file footer; %d message: %s",
+               errno, strerror(errno));
+        free(buffer);
+        return ERROR;
+    }
+    fflush(file_handle);
+    free(buffer);
+
+    return SUCCESS;
+}
+
+int rl_file_store_checkpoint(FILE *file_handle,
+                             rl_file_header_t const *const file_header) {
+    // checkpoint is placed at the end of the written data blocks
+    off_t const offset = ftello(file_handle);
+    if (offset < 0) {
+        rl_log(RL_LOG_ERROR,
+               "failed getting checkpoint file offset; %d message: %s", errno,
+               strerror(errno));
+        return ERROR;
+    }
+
+    uint8_t checkpoint[sizeof(rl_file_checkpoint_t)];
+    size_t const length =
+        rl_file_encode_checkpoint(checkpoint, file_header, (uint64_t)offset);
+
+    int res =
+        rl_file_pwrite_all(fileno(file_handle), checkpoint, length, offset);
+    if (res < 0) {
+        rl_log(RL_LOG_ERROR, "failed storing file checkpoint; %d message: %s",
+               errno, strerror(errno));
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+size_t rl_file_encode_checkpoint(uint8_t *const buffer,
+                                 rl_file_header_t const *const file_header,
+                                 uint64_t offset) {
+    rl_file_checkpoint_t const checkpoint = {
+        .checkpoint_magic = RL_FILE_CHECKPOINT_MAGIC,
+        .data_block_count = file_header->lead_in.data_block_count,
+        .sample_count = file_header->lead_in.sample_count,
+        .checkpoint_offset = offset,
+    };
+
+    memcpy(buffer, &checkpoint, sizeof(rl_file_checkpoint_t));
+    return sizeof(rl_file_checkpoint_t);
+}
+
+int rl_file_store_index_header(FILE *index_file,
+                               rl_file_header_t const *const data_file_header) {
+    rl_file_index_header_t const index_header = {
+        .index_magic = RL_FILE_INDEX_MAGIC,
+        .index_version = RL_FILE_INDEX_VERSION,
+        .record_length = sizeof(rl_file_index_record_t),
+        .start_time = data_file_header->lead_in.start_time,
+    };
+
+    size_t count =
+        fwrite(&index_header, sizeof(rl_file_index_header_t), 1, index_file);
+    if (count != 1) {
+        rl_log(RL_LOG_ERROR, "failed storing index header; %d message: %s",
+               errno, strerror(errno));
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+int rl_file_add_index_record(FILE *index_file, uint64_t block_offset,
+                             rl_timestamp_t const *const timestamp_realtime,
+                             rl_timestamp_t const *const timestamp_monotonic) {
+    rl_file_index_record_t const index_record = {
+        .block_offset = block_offset,
+        .timestamp_realtime = *timestamp_realtime,
+        .timestamp_monotonic = *timestamp_monotonic,
+    };
+
+    size_t count =
+        fwrite(&index_record, sizeof(rl_file_index_record_t), 1, index_file);
+    if (count != 1) {
+        rl_log(RL_LOG_ERROR, "failed storing index record; %d message: %s",
+               errno, strerror(errno));
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+int rl_file_preallocate(FILE *file_handle, uint64_t size) {
+    // round up to file system blocks
+    struct stat file_stat;
+    int res = fstat(fileno(file_handle), &file_stat);
+    if (res == 0 && file_stat.st_blksize > 0) {
+        uint64_t const block_size = (uint64_t)file_stat.st_blksize;
+        size = ((size + block_size - 1) / block_size) * block_size;
+    }
+
+    // allocate space without changing the file size visible to readers
+    res = fallocate(fileno(file_handle), FALLOC_FL_KEEP_SIZE, 0, (off_t)size);
+    if (res < 0) {
+        rl_log(RL_LOG_WARNING,
+               "failed preallocating file space; %d message: %s", errno,
+               strerror(errno));
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+int rl_file_trim(FILE *file_handle) {
+    // drop everything past the written data
     fflush(file_handle);
-    fseek(file_handle, 0, SEEK_END);
+    off_t const offset = ftello(file_handle);
+    if (offset < 0 || ftruncate(fileno(file_handle), offset) < 0) {
+        rl_log(RL_LOG_ERROR, "failed trimming file; %d message: %s", errno,
+               strerror(errno));
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+size_t rl_file_get_data_block_bytes_max(size_t buffer_size) {
+    // timestamps, binary bit field and all analog channels per sample
+    size_t const sample_bytes =
+        sizeof(uint32_t) + RL_CHANNEL_COUNT * sizeof(int32_t);
+    // compression: block size, first value and bit widths per column, padding
+    size_t const group_count =
+        (buffer_size + RL_FILE_COMPRESS_GROUP_SIZE - 1) /
+        RL_FILE_COMPRESS_GROUP_SIZE;
+    size_t const compress_bytes =
+        sizeof(uint32_t) +
+        (RL_CHANNEL_COUNT + 1) * (sizeof(int32_t) + group_count) +
+        2 * sizeof(uint32_t);
+    return 2 * sizeof(rl_timestamp_t) + buffer_size * sample_bytes +
+           compress_bytes + sizeof(uint32_t);
+}
+
+size_t rl_file_encode_data_block(
+    uint8_t *const block, int32_t const *analog_buffer,
+    uint32_t const *digital_buffer, size_t buffer_size,
+    rl_timestamp_t const *const timestamp_realtime,
+    rl_timestamp_t const *const timestamp_monotonic,
+    rl_config_t const *const config) {
+    size_t const block_bytes = rl_file_encode_block_content(
+        block, analog_buffer, digital_buffer, buffer_size, timestamp_realtime,
+        timestamp_monotonic, config);
+    if (block_bytes == 0 || !config->file_crc_enable) {
+        return block_bytes;
+    }
+
+    // checksum appended to the block, included in the compressed block size
+    if (config->file_compress_enable) {
+        uint32_t const compressed_bytes =
+            (uint32_t)(block_bytes + sizeof(uint32_t));
+        memcpy(block, &compressed_bytes, sizeof(compressed_bytes));
+    }
+    uint32_t const crc = rl_crc32c(RL_CRC32C_INIT, block, block_bytes);
+    memcpy(block + block_bytes, &crc, sizeof(crc));
+
+    return block_bytes + sizeof(crc);
+}
+
+static size_t rl_file_encode_block_content(
+    uint8_t *const block, int32_t const *analog_buffer,
+    uint32_t const *digital_buffer, size_t buffer_size,
+    rl_timestamp_t const *const timestamp_realtime,
+    rl_timestamp_t const *const timestamp_monotonic,
+    rl_config_t const *const config) {
+    // encode samples to intermediate buffer and compress them
+    if (config->file_compress_enable) {
+        int res = rl_file_block_buffer_init(buffer_size, RL_FILE_FORMAT_RLD);
+        if (res < 0) {
+            return 0;
+        }
+        size_t const column_count = rl_file_get_column_count(config);
+        size_t const sample_bytes = rl_file_process_samples(
+            rl_file_sample_buffer, analog_buffer, digital_buffer, buffer_size,
+            config);
+        size_t sample_count = 0;
+        if (column_count > 0) {
+            sample_count = sample_bytes / (column_count * sizeof(uint32_t));
+        }
+        return rl_file_compress_samples(block, rl_file_sample_buffer,
+                                        sample_count, column_count,
+                                        timestamp_realtime,
+                                        timestamp_monotonic);
+    }
+
+    // block timestamps followed by the encoded samples
+    memcpy(block, timestamp_realtime, sizeof(rl_timestamp_t));
+    memcpy(block + sizeof(rl_timestamp_t), timestamp_monotonic,
+           sizeof(rl_timestamp_t));
+
+    // channel-planar blocks store each data column contiguously
+    if (config->file_planar_enable) {
+        uint8_t *const block_data = block + 2 * sizeof(rl_timestamp_t);
+
+        // copy non-aggregated analog data columns directly
+        if (RL_SAMPLE_RATE_MIN / config->sample_rate <= 1) {
+            return 2 * sizeof(rl_timestamp_t) +
+                   rl_file_encode_columns(block_data, analog_buffer,
+                                          digital_buffer, buffer_size,
+                                          rl_file_get_channel_mask(config),
+                                          config->digital_enable);
+        }
+
+        // aggregate samples to intermediate buffer and transpose them
+        int res = rl_file_block_buffer_init(buffer_size, RL_FILE_FORMAT_RLD);
+        if (res < 0) {
+            return 0;
+        }
+        size_t const column_count = rl_file_get_column_count(config);
+        size_t const sample_bytes = rl_file_process_samples(
+            rl_file_sample_buffer, analog_buffer, digital_buffer, buffer_size,
+            config);
+        size_t sample_count = 0;
+        if (column_count > 0) {
+            sample_count = sample_bytes / (column_count * sizeof(uint32_t));
+        }
+        return 2 * sizeof(rl_timestamp_t) +
+               rl_file_transpose_samples(block_data, rl_file_sample_buffer,
+                                         sample_count, column_count);
+    }
+
+    return 2 * sizeof(rl_timestamp_t) +
+           rl_file_process_samples(block + 2 * sizeof(rl_timestamp_t),
+                                   analog_buffer, digital_buffer, buffer_size,
+                                   config);
 }
 
 int rl_file_add_data_block(FILE *data_file, int32_t const *analog_buffer,
@@ -352,11 +1090,7 @@ int rl_file_add_data_block(FILE *data_file, int32_t const *analog_buffer,
                            rl_timestamp_t const *const timestamp_realtime,
                            rl_timestamp_t const *const timestamp_monotonic,
                            rl_config_t const *const config) {
-    // aggregation buffer and configuration
-    int32_t aggregate_analog[RL_CHANNEL_COUNT] = {0};
-    int64_t aggregate_analog_sum[RL_CHANNEL_COUNT] = {0};
-    uint32_t aggregate_digital = ~((uint32_t)0);
-    size_t aggregate_count = RL_SAMPLE_RATE_MIN / config->sample_rate;
+    size_t const aggregate_count = RL_SAMPLE_RATE_MIN / config->sample_rate;
 
     // skip if not storing to file, or invalid file structure
     if (!config->file_enable) {
@@ -374,19 +1108,168 @@ int rl_file_add_data_block(FILE *data_file, int32_t const *analog_buffer,
         return ERROR;
     }
 
-    // write buffer timestamp to file
+    // CSV data rows are formatted from encoded samples and written at once
+    if (config->file_format == RL_FILE_FORMAT_CSV) {
+        int res = rl_file_block_buffer_init(buffer_size, RL_FILE_FORMAT_CSV);
+        if (res < 0) {
+            return ERROR;
+        }
+        size_t const column_count = rl_file_get_column_count(config);
+        size_t const sample_bytes =
+            rl_file_process_samples(rl_file_sample_buffer, analog_buffer,
+                                    digital_buffer, buffer_size, config);
+        size_t sample_count = 0;
+        if (column_count > 0) {
+            sample_count = sample_bytes / (column_count * sizeof(uint32_t));
+        }
+        size_t const length = rl_file_format_csv_rows(
+            (char *)rl_file_block_buffer, rl_file_sample_buffer, sample_count,
+            timestamp_realtime, config);
+
+        if (fwrite(rl_file_block_buffer, 1, length, data_file) != length) {
+            rl_log(RL_LOG_ERROR,
+                   "failed writing data block to file; %d message: %s", errno,
+                   strerror(errno));
+            return ERROR;
+        }
+    }
+
+    // binary data block is assembled in buffer and written at once
     if (config->file_format == RL_FILE_FORMAT_RLD) {
-        fwrite(timestamp_realtime, sizeof(rl_timestamp_t), 1, data_file);
-        fwrite(timestamp_monotonic, sizeof(rl_timestamp_t), 1, data_file);
-    } else if (config->file_format == RL_FILE_FORMAT_CSV) {
-        fprintf(data_file, "%lli.%09lli", timestamp_realtime->sec,
-                timestamp_realtime->nsec);
+        int res = rl_file_block_buffer_init(buffer_size, RL_FILE_FORMAT_RLD);
+        if (res < 0) {
+            return ERROR;
+        }
+        struct iovec iov = {
+            .iov_base = rl_file_block_buffer,
+            .iov_len = rl_file_encode_data_block(
+                rl_file_block_buffer, analog_buffer, digital_buffer,
+                buffer_size, timestamp_realtime, timestamp_monotonic, config),
+        };
+        if (iov.iov_len == 0) {
+            return ERROR;
+        }
+
+        // write pending stream data first and bypass the stream buffer
+        fflush(data_file);
+        res = rl_file_writev_all(fileno(data_file), &iov, 1);
+        if (res < 0) {
+            rl_log(RL_LOG_ERROR,
+                   "failed writing data block to file; %d message: %s", errno,
+                   strerror(errno));
+            return ERROR;
+        }
+
+        // synchronize stream position with the file descriptor
+        fseek(data_file, 0, SEEK_END);
+    }
+
+    // record batch is assembled in buffer and written at once, its location
+    // is kept for the file footer
+    if (config->file_format == RL_FILE_FORMAT_ARROW) {
+        int res = rl_file_block_buffer_init(buffer_size, RL_FILE_FORMAT_ARROW);
+        if (res < 0) {
+            return ERROR;
+        }
+        if (rl_file_arrow_block_count == rl_file_arrow_block_capacity) {
+            size_t const capacity = 2 * rl_file_arrow_block_capacity + 64;
+            void *blocks = realloc(rl_file_arrow_blocks,
+                                   capacity * sizeof(rl_arrow_block_t));
+            if (blocks == NULL) {
+                rl_log(RL_LOG_ERROR,
+                       "failed allocating record batch list; %d message: %s",
+                       errno, strerror(errno));
+                return ERROR;
+            }
+            rl_file_arrow_blocks = (rl_arrow_block_t *)blocks;
+            rl_file_arrow_block_capacity = capacity;
+        }
+
+        rl_arrow_block_t *const arrow_block =
+            &rl_file_arrow_blocks[rl_file_arrow_block_count];
+        struct iovec iov = {
+            .iov_base = rl_file_block_buffer,
+            .iov_len = rl_file_encode_arrow_batch(
+                rl_file_block_buffer, analog_buffer, digital_buffer,
+                buffer_size, timestamp_realtime, timestamp_monotonic, config,
+                arrow_block),
+        };
+        if (iov.iov_len == 0) {
+            rl_log(RL_LOG_ERROR,
+                   "failed encoding record batch; %d message: %s", errno,
+                   strerror(errno));
+            return ERROR;
+        }
+
+        // write pending stream data first and bypass the stream buffer
+        fflush(data_file);
+        arrow_block->offset = (uint64_t)ftello(data_file);
+        res = rl_file_writev_all(fileno(data_file), &iov, 1);
+        if (res < 0) {
+            rl_log(RL_LOG_ERROR,
+                   "failed writing data block to file; %d message: %s", errno,
+                   strerror(errno));
+            return ERROR;
+        }
+        rl_file_arrow_block_count++;
+
+        // synchronize stream position with the file descriptor
+        fseek(data_file, 0, SEEK_END);
+    }
+
+    // flush processed data if data is stored
+    if (config->file_enable && data_file != NULL) {
+        fflush(data_file);
+    }
+
+    return 1;
+}
+
+int rl_file_add_ambient_block(FILE *ambient_file, int32_t const *ambient_buffer,
+                              size_t buffer_size,
+                              rl_timestamp_t const *const timestamp_realtime,
+                              rl_timestamp_t const *const timestamp_monotonic,
+                              rl_config_t const *const config) {
+    // suppress unused parameter warning
+    (void)config;
+
+    // store timestamps
+    fwrite(timestamp_realtime, sizeof(rl_timestamp_t), 1, ambient_file);
+    fwrite(timestamp_monotonic, sizeof(rl_timestamp_t), 1, ambient_file);
+
+    // store sensor data
+    fwrite(ambient_buffer, sizeof(int32_t), buffer_size, ambient_file);
+
+    return 1;
+}
+
+static size_t rl_file_process_samples(uint8_t *const block,
+                                      int32_t const *analog_buffer,
+                                      uint32_t const *digital_buffer,
+                                      size_t buffer_size,
+                                      rl_config_t const *const config) {
+    // aggregation buffer and configuration
+    int32_t aggregate_analog[RL_CHANNEL_COUNT] = {0};
+    int64_t aggregate_analog_sum[RL_CHANNEL_COUNT] = {0};
+    uint32_t aggregate_digital = ~((uint32_t)0);
+    size_t aggregate_count = RL_SAMPLE_RATE_MIN / config->sample_rate;
+
+    uint8_t *block_data = block;
+    uint32_t const channel_mask = rl_file_get_channel_mask(config);
+    rl_file_encoder_t const encoder =
+        rl_file_get_encoder(channel_mask, config->digital_enable);
+
+    // encode non-aggregated binary data in a single pass
+    if (aggregate_count <= 1) {
+        return encoder(block_data, analog_buffer, buffer_size, digital_buffer,
+                       buffer_size, channel_mask, config->digital_enable);
     }
 
     // process data buffers
     for (size_t i = 0; i < buffer_size; i++) {
         // point to sample buffer to store by default (updated for aggregates)
-        int32_t const *analog_data = analog_buffer + i * RL_CHANNEL_COUNT;
+        int32_t const *analog_data = analog_buffer + i;
+        size_t analog_stride = buffer_size;
         uint32_t const *digital_data = digital_buffer + i;
 
         // handle aggregation when applicable
@@ -411,7 +1294,7 @@ int rl_file_add_data_block(FILE *data_file, int32_t const *analog_buffer,
             case RL_AGGREGATION_MODE_AVERAGE:
                 // accumulate data of the aggregate window, store when window complete
                 for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
-                    aggregate_analog_sum[j] += *(analog_data + j);
+                    aggregate_analog_sum[j] += analog_data[j * analog_stride];
                 }
                 aggregate_digital = aggregate_digital & *digital_data;
 
@@ -425,6 +1308,7 @@ int rl_file_add_data_block(FILE *data_file, int32_t const *analog_buffer,
 
                     // store aggregated data
                     analog_data = aggregate_analog;
+                    analog_stride = 1;
                     digital_data = &aggregate_digital;
                     aggregate_store = true;
                 }
@@ -442,97 +1326,669 @@ int rl_file_add_data_block(FILE *data_file, int32_t const *analog_buffer,
             }
         }
 
-        // write digital channels
-        if (config->file_format == RL_FILE_FORMAT_RLD) {
-            size_t index = 0;
-            uint32_t data = 0x00;
+        // encode binary data sample
+        block_data += encoder(block_data, analog_data, analog_stride,
+                              digital_data, 1, channel_mask,
+                              config->digital_enable);
+    }
 
-            // build binary bit field to store
-            if (config->digital_enable) {
-                data |= ((*digital_data & PRU_DIGITAL_INPUT_MASK) << index);
-                index += RL_CHANNEL_DIGITAL_COUNT;
-            }
-            if (config->channel_enable[RL_CONFIG_CHANNEL_I1L]) {
-                if (*digital_data & PRU_DIGITAL_I1L_VALID_MASK) {
-                    data |= (1 << index);
-                }
-                index++;
+    return block_data - block;
+}
+
+static size_t rl_file_compress_samples(
+    uint8_t *const block, uint8_t const *samples, size_t sample_count,
+    size_t column_count, rl_timestamp_t const *const timestamp_realtime,
+    rl_timestamp_t const *const timestamp_monotonic) {
+    size_t const group_count =
+        (sample_count + RL_FILE_COMPRESS_GROUP_SIZE - 1) /
+        RL_FILE_COMPRESS_GROUP_SIZE;
+    size_t const sample_bytes = column_count * sizeof(uint32_t);
+    uint32_t values[RL_FILE_COMPRESS_GROUP_SIZE];
+
+    // block size is stored once the block is complete
+    uint8_t *block_data = block + sizeof(uint32_t);
+
+    // block timestamps
+    memcpy(block_data, timestamp_realtime, sizeof(rl_timestamp_t));
+    block_data += sizeof(rl_timestamp_t);
+    memcpy(block_data, timestamp_monotonic, sizeof(rl_timestamp_t));
+    block_data += sizeof(rl_timestamp_t);
+
+    // first value of each column, zero for empty blocks
+    memset(block_data, 0, sample_bytes);
+    if (sample_count > 0) {
+        memcpy(block_data, samples, sample_bytes);
+    }
+    block_data += sample_bytes;
+
+    // bit width table, padded to 32 bit words
+    uint8_t *const widths = block_data;
+    block_data += column_count * group_count;
+    while ((block_data - block) % sizeof(uint32_t) != 0) {
+        *block_data++ = 0;
+    }
+
+    for (size_t j = 0; j < column_count; j++) {
+        uint32_t previous;
+        memcpy(&previous, samples + j * sizeof(uint32_t), sizeof(uint32_t));
+
+        for (size_t g = 0; g < group_count; g++) {
+            size_t const start = g * RL_FILE_COMPRESS_GROUP_SIZE;
+            size_t count = sample_count - start;
+            if (count > RL_FILE_COMPRESS_GROUP_SIZE) {
+                count = RL_FILE_COMPRESS_GROUP_SIZE;
             }
-            if (config->channel_enable[RL_CONFIG_CHANNEL_I2L]) {
-                if (*digital_data & PRU_DIGITAL_I2L_VALID_MASK) {
-                    data |= (1 << index);
-                }
-                index++;
+
+            // zig-zag encoded differences and their common bit width
+            uint32_t bits = 0;
+            for (size_t i = 0; i < count; i++) {
+                uint32_t value;
+                memcpy(&value,
+                       samples + (start + i) * sample_bytes +
+                           j * sizeof(uint32_t),
+                       sizeof(uint32_t));
+                int32_t const delta = (int32_t)(value - previous);
+                previous = value;
+                values[i] = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+                bits |= values[i];
             }
 
-            // write digital data to file if any channel available
-            if (index > 0) {
-                fwrite(&data, sizeof(data), 1, data_file);
+            uint32_t width = 0;
+            if (bits > 0) {
+                width = 32 - __builtin_clz(bits);
             }
-        } else if (config->file_format == RL_FILE_FORMAT_CSV) {
-            if (config->digital_enable) {
-                uint32_t binary_mask = PRU_DIGITAL_INPUT1_MASK;
-                for (int j = 0; j < RL_CHANNEL_DIGITAL_COUNT; j++) {
-                    fprintf(data_file, (RL_FILE_CSV_DELIMITER "%i"),
-                            (*digital_data & binary_mask) > 0);
-                    binary_mask = binary_mask << 1;
-                }
+            widths[j * group_count + g] = (uint8_t)width;
+            block_data += rl_file_pack_bits(block_data, values, count, width);
+        }
+    }
+
+    // pad block to 32 bit words and store its size
+    while ((block_data - block) % sizeof(uint32_t) != 0) {
+        *block_data++ = 0;
+    }
+    uint32_t const block_bytes = (uint32_t)(block_data - block);
+    memcpy(block, &block_bytes, sizeof(block_bytes));
+
+    return block_bytes;
+}
+
+static size_t rl_file_pack_bits(uint8_t *const buffer, uint32_t const *values,
+                                size_t count, uint32_t width) {
+    uint8_t *data = buffer;
+    uint64_t bits = 0;
+    uint32_t bit_count = 0;
+
+    if (width == 0) {
+        return 0;
+    }
+
+    // accumulate values and store full 32 bit words
+    for (size_t i = 0; i < count; i++) {
+        bits |= (uint64_t)values[i] << bit_count;
+        bit_count += width;
+        if (bit_count >= 32) {
+            uint32_t const word = (uint32_t)bits;
+            memcpy(data, &word, sizeof(word));
+            data += sizeof(word);
+            bits >>= 32;
+            bit_count -= 32;
+        }
+    }
+
+    // store remaining bits padded to full bytes
+    while (bit_count > 0) {
+        *data++ = (uint8_t)bits;
+        bits >>= 8;
+        bit_count = (bit_count > 8) ? bit_count - 8 : 0;
+    }
+
+    return data - buffer;
+}
+
+size_t rl_file_encode_ambient_block(
+    uint8_t *const block, int32_t const *ambient_buffer, size_t buffer_size,
+    rl_timestamp_t const *const timestamp_realtime,
+    rl_timestamp_t const *const timestamp_monotonic) {
+    // timestamps followed by the sensor data
+    memcpy(block, timestamp_realtime, sizeof(rl_timestamp_t));
+    memcpy(block + sizeof(rl_timestamp_t), timestamp_monotonic,
+           sizeof(rl_timestamp_t));
+    memcpy(block + 2 * sizeof(rl_timestamp_t), ambient_buffer,
+           buffer_size * sizeof(int32_t));
+
+    return 2 * sizeof(rl_timestamp_t) + buffer_size * sizeof(int32_t);
+}
+
+/**
+ * Encode samples to binary data block for a given channel configuration.
+ *
+ * Always inlined so the channel configuration of the specialized encoders is
+ * resolved at compile time, leaving an unrolled loop without branches.
+ *
+ * @param block Data block buffer to append the encoded samples to
+ * @param analog_buffer Analog data of the samples to encode (channel-major)
+ * @param analog_stride Distance between the channels in the analog buffer
+ * @param digital_buffer Digital data of the samples to encode
+ * @param count Number of samples to encode
+ * @param channel_mask Enabled analog channels (bit i for channel index i)
+ * @param digital_enable Whether digital channels are stored
+ * @return Number of bytes appended to the data block buffer
+ */
+static inline __attribute__((always_inline)) size_t
+rl_file_encode_samples(uint8_t *const block, int32_t const *analog_buffer,
+                       size_t analog_stride, uint32_t const *digital_buffer,
+                       size_t count,
+                       uint32_t channel_mask, bool digital_enable) {
+    bool const i1l_enable = (channel_mask & (1 << RL_CONFIG_CHANNEL_I1L)) > 0;
+    bool const i2l_enable = (channel_mask & (1 << RL_CONFIG_CHANNEL_I2L)) > 0;
+    uint8_t *block_data = block;
+
+    for (size_t i = 0; i < count; i++) {
+        int32_t const *const analog_data = analog_buffer + i;
+        uint32_t const digital_data = digital_buffer[i];
+
+        // build binary bit field to store if any channel available
+        if (digital_enable || i1l_enable || i2l_enable) {
+            uint32_t const data = rl_file_encode_binary(
+                digital_data, digital_enable, i1l_enable, i2l_enable);
+            memcpy(block_data, &data, sizeof(data));
+            block_data += sizeof(data);
+        }
+
+        // enabled analog channels (unrolled, -O2 does not peel the loop)
+#pragma GCC unroll 16
+        for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+            if (channel_mask & (1 << j)) {
+                memcpy(block_data, &analog_data[j * analog_stride],
+                       sizeof(int32_t));
+                block_data += sizeof(int32_t);
             }
-            if (config->channel_enable[RL_CONFIG_CHANNEL_I1L]) {
-                fprintf(data_file, (RL_FILE_CSV_DELIMITER "%i"),
-                        (*digital_data & PRU_DIGITAL_I1L_VALID_MASK) > 0);
+        }
+    }
+
+    return (size_t)(block_data - block);
+}
+
+/**
+ * Define a binary data block encoder specialized for a channel configuration.
+ *
+ * @param name Name of the encoder function
+ * @param mask Enabled analog channels (bit i for channel index i)
+ * @param digital Whether digital channels are stored
+ */
+#define RL_FILE_ENCODER(name, mask, digital)                                   \
+    static size_t name(uint8_t *const block, int32_t const *analog_buffer,     \
+                       size_t analog_stride, uint32_t const *digital_buffer,   \
+                       size_t count, uint32_t channel_mask,                    \
+                       bool digital_enable) {                                  \
+        (void)channel_mask;   /* suppress unused parameter warning */          \
+        (void)digital_enable; /* suppress unused parameter warning */          \
+        return rl_file_encode_samples(block, analog_buffer, analog_stride,     \
+                                      digital_buffer, count, (mask),           \
+                                      (digital));                              \
+    }
+
+/// Channel mask of all analog channels
+#define RL_FILE_CHANNEL_MASK_ALL ((1 << RL_CHANNEL_COUNT) - 1)
+/// Channel mask of the default analog channels (all except DT)
+#define RL_FILE_CHANNEL_MASK_DEFAULT                                           \
+    (RL_FILE_CHANNEL_MASK_ALL & ~(1 << RL_CONFIG_CHANNEL_DT))
+/// Channel mask of the voltage channels
+#define RL_FILE_CHANNEL_MASK_VOLTAGE                                           \
+    ((1 << RL_CONFIG_CHANNEL_V1) | (1 << RL_CONFIG_CHANNEL_V2) |               \
+     (1 << RL_CONFIG_CHANNEL_V3) | (1 << RL_CONFIG_CHANNEL_V4))
+/// Channel mask of the current channels
+#define RL_FILE_CHANNEL_MASK_CURRENT                                           \
+    ((1 << RL_CONFIG_CHANNEL_I1L) | (1 << RL_CONFIG_CHANNEL_I1H) |             \
+     (1 << RL_CONFIG_CHANNEL_I2L) | (1 << RL_CONFIG_CHANNEL_I2H))
+
+RL_FILE_ENCODER(rl_file_encode_all, RL_FILE_CHANNEL_MASK_ALL, false)
+RL_FILE_ENCODER(rl_file_encode_all_digital, RL_FILE_CHANNEL_MASK_ALL, true)
+RL_FILE_ENCODER(rl_file_encode_default, RL_FILE_CHANNEL_MASK_DEFAULT, false)
+RL_FILE_ENCODER(rl_file_encode_default_digital, RL_FILE_CHANNEL_MASK_DEFAULT,
+                true)
+RL_FILE_ENCODER(rl_file_encode_voltage, RL_FILE_CHANNEL_MASK_VOLTAGE, false)
+RL_FILE_ENCODER(rl_file_encode_voltage_digital, RL_FILE_CHANNEL_MASK_VOLTAGE,
+                true)
+RL_FILE_ENCODER(rl_file_encode_current, RL_FILE_CHANNEL_MASK_CURRENT, false)
+RL_FILE_ENCODER(rl_file_encode_current_digital, RL_FILE_CHANNEL_MASK_CURRENT,
+                true)
+
+/**
+ * Generic binary data block encoder for any channel configuration.
+ *
+ * @param block Data block buffer to append the encoded samples to
+ * @param analog_buffer Analog data of the samples to encode (channel-major)
+ * @param analog_stride Distance between the channels in the analog buffer
+ * @param digital_buffer Digital data of the samples to encode
+ * @param count Number of samples to encode
+ * @param channel_mask Enabled analog channels (bit i for channel index i)
+ * @param digital_enable Whether digital channels are stored
+ * @return Number of bytes appended to the data block buffer
+ */
+static size_t rl_file_encode_generic(uint8_t *const block,
+                                     int32_t const *analog_buffer,
+                                     size_t analog_stride,
+                                     uint32_t const *digital_buffer,
+                                     size_t count, uint32_t channel_mask,
+                                     bool digital_enable) {
+    return rl_file_encode_samples(block, analog_buffer, analog_stride,
+                                  digital_buffer, count, channel_mask,
+                                  digital_enable);
+}
+
+/**
+ * Specialized binary data block encoder table entry.
+ */
+struct rl_file_encoder_entry {
+    /// Enabled analog channels (bit i for channel index i)
+    uint32_t channel_mask;
+    /// Whether digital channels are stored
+    bool digital_enable;
+    /// The specialized encoder
+    rl_file_encoder_t encoder;
+};
+
+/// Binary data block encoders specialized for common channel configurations
+static struct rl_file_encoder_entry const RL_FILE_ENCODERS[] = {
+    {RL_FILE_CHANNEL_MASK_ALL, false, rl_file_encode_all},
+    {RL_FILE_CHANNEL_MASK_ALL, true, rl_file_encode_all_digital},
+    {RL_FILE_CHANNEL_MASK_DEFAULT, false, rl_file_encode_default},
+    {RL_FILE_CHANNEL_MASK_DEFAULT, true, rl_file_encode_default_digital},
+    {RL_FILE_CHANNEL_MASK_VOLTAGE, false, rl_file_encode_voltage},
+    {RL_FILE_CHANNEL_MASK_VOLTAGE, true, rl_file_encode_voltage_digital},
+    {RL_FILE_CHANNEL_MASK_CURRENT, false, rl_file_encode_current},
+    {RL_FILE_CHANNEL_MASK_CURRENT, true, rl_file_encode_current_digital},
+};
+
+static inline uint32_t rl_file_encode_binary(uint32_t digital_data,
+                                             bool digital_enable,
+                                             bool i1l_enable, bool i2l_enable) {
+    uint32_t index = 0;
+    uint32_t data = 0x00;
+
+    if (digital_enable) {
+        data |= (digital_data & PRU_DIGITAL_INPUT_MASK);
+        index += RL_CHANNEL_DIGITAL_COUNT;
+    }
+    if (i1l_enable) {
+        data |= (digital_data & PRU_DIGITAL_I1L_VALID_MASK) ? (1 << index) : 0;
+        index++;
+    }
+    if (i2l_enable) {
+        data |= (digital_data & PRU_DIGITAL_I2L_VALID_MASK) ? (1 << index) : 0;
+        index++;
+    }
+
+    return data;
+}
+
+static size_t rl_file_encode_columns(uint8_t *const block,
+                                     int32_t const *analog_buffer,
+                                     uint32_t const *digital_buffer,
+                                     size_t buffer_size, uint32_t channel_mask,
+                                     bool digital_enable) {
+    bool const i1l_enable = (channel_mask & (1 << RL_CONFIG_CHANNEL_I1L)) > 0;
+    bool const i2l_enable = (channel_mask & (1 << RL_CONFIG_CHANNEL_I2L)) > 0;
+    uint8_t *block_data = block;
+
+    // binary bit field column if any channel available
+    if (digital_enable || i1l_enable || i2l_enable) {
+        for (size_t i = 0; i < buffer_size; i++) {
+            uint32_t const data = rl_file_encode_binary(
+                digital_buffer[i], digital_enable, i1l_enable, i2l_enable);
+            memcpy(block_data, &data, sizeof(data));
+            block_data += sizeof(data);
+        }
+    }
+
+    // analog channels are already stored column-wise in the sample buffer
+    for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+        if (channel_mask & (1 << j)) {
+            memcpy(block_data, analog_buffer + j * buffer_size,
+                   buffer_size * sizeof(int32_t));
+            block_data += buffer_size * sizeof(int32_t);
+        }
+    }
+
+    return (size_t)(block_data - block);
+}
+
+static size_t rl_file_transpose_samples(uint8_t *const block,
+                                        uint8_t const *samples,
+                                        size_t sample_count,
+                                        size_t column_count) {
+    size_t const sample_bytes = column_count * sizeof(uint32_t);
+    uint8_t *block_data = block;
+
+    for (size_t j = 0; j < column_count; j++) {
+        for (size_t i = 0; i < sample_count; i++) {
+            memcpy(block_data,
+                   samples + i * sample_bytes + j * sizeof(uint32_t),
+                   sizeof(uint32_t));
+            block_data += sizeof(uint32_t);
+        }
+    }
+
+    return (size_t)(block_data - block);
+}
+
+static size_t rl_file_get_column_count(rl_config_t const *const config) {
+    size_t column_count = count_channels(config->channel_enable);
+    if (config->digital_enable ||
+        config->channel_enable[RL_CONFIG_CHANNEL_I1L] ||
+        config->channel_enable[RL_CONFIG_CHANNEL_I2L]) {
+        column_count++;
+    }
+    return column_count;
+}
+
+static uint32_t rl_file_get_channel_mask(rl_config_t const *const config) {
+    uint32_t channel_mask = 0;
+    for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+        if (config->channel_enable[j]) {
+            channel_mask |= (1 << j);
+        }
+    }
+    return channel_mask;
+}
+
+static rl_file_encoder_t rl_file_get_encoder(uint32_t channel_mask,
+                                             bool digital_enable) {
+    size_t const encoder_count =
+        sizeof(RL_FILE_ENCODERS) / sizeof(RL_FILE_ENCODERS[0]);
+    for (size_t i = 0; i < encoder_count; i++) {
+        if (RL_FILE_ENCODERS[i].channel_mask == channel_mask &&
+            RL_FILE_ENCODERS[i].digital_enable == digital_enable) {
+            return RL_FILE_ENCODERS[i].encoder;
+        }
+    }
+    return rl_file_encode_generic;
+}
+
+static size_t rl_file_encode_arrow_batch(
+    uint8_t *const block, int32_t const *analog_buffer,
+    uint32_t const *digital_buffer, size_t buffer_size,
+    rl_timestamp_t const *const timestamp_realtime,
+    rl_timestamp_t const *const timestamp_monotonic,
+    rl_config_t const *const config, rl_arrow_block_t *const arrow_block) {
+    size_t const column_count = rl_file_get_column_count(config);
+    size_t const analog_count = count_channels(config->channel_enable);
+    size_t binary_count = 0;
+    if (config->digital_enable) {
+        binary_count += RL_CHANNEL_DIGITAL_COUNT;
+    }
+    if (config->channel_enable[RL_CONFIG_CHANNEL_I1L]) {
+        binary_count++;
+    }
+    if (config->channel_enable[RL_CONFIG_CHANNEL_I2L]) {
+        binary_count++;
+    }
+
+    // encode samples to data columns in the sample buffer
+    size_t row_count = buffer_size;
+    if (RL_SAMPLE_RATE_MIN / config->sample_rate <= 1) {
+        rl_file_encode_columns(rl_file_sample_buffer, analog_buffer,
+                               digital_buffer, buffer_size,
+                               rl_file_get_channel_mask(config),
+                               config->digital_enable);
+    } else {
+        size_t const sample_bytes = rl_file_process_samples(
+            block, analog_buffer, digital_buffer, buffer_size, config);
+        row_count = 0;
+        if (column_count > 0) {
+            row_count = sample_bytes / (column_count * sizeof(uint32_t));
+        }
+        rl_file_transpose_samples(rl_file_sample_buffer, block, row_count,
+                                  column_count);
+    }
+
+    size_t const metadata_length = rl_arrow_encode_batch(
+        block, RL_ARROW_BATCH_METADATA_BYTES_MAX, binary_count, analog_count,
+        row_count, timestamp_realtime, timestamp_monotonic);
+    if (metadata_length == 0) {
+        return 0;
+    }
+
+    // binary channels bit-packed from the binary bit field column, by
+    // transposing the 8x8 bit matrix of the (at most 8) binary channels
+    // of 8 rows at once
+    uint8_t const *column = rl_file_sample_buffer;
+    uint8_t *body = block + metadata_length;
+    if (binary_count > 0) {
+        size_t const column_bytes = rl_arrow_get_column_bytes(true, row_count);
+        memset(body, 0, binary_count * column_bytes);
+        for (size_t i = 0; i < row_count; i += 8) {
+            uint64_t bits = 0;
+            for (size_t k = 0; k < 8 && i + k < row_count; k++) {
+                uint32_t binary;
+                memcpy(&binary, column + (i + k) * sizeof(uint32_t),
+                       sizeof(binary));
+                bits |= (uint64_t)(binary & 0xff) << (8 * k);
             }
-            if (config->channel_enable[RL_CONFIG_CHANNEL_I2L]) {
-                fprintf(data_file, (RL_FILE_CSV_DELIMITER "%i"),
-                        (*digital_data & PRU_DIGITAL_I2L_VALID_MASK) > 0);
+            uint64_t swap;
+            swap = (bits ^ (bits >> 7)) & 0x00AA00AA00AA00AAULL;
+            bits ^= swap ^ (swap << 7);
+            swap = (bits ^ (bits >> 14)) & 0x0000CCCC0000CCCCULL;
+            bits ^= swap ^ (swap << 14);
+            swap = (bits ^ (bits >> 28)) & 0x00000000F0F0F0F0ULL;
+            bits ^= swap ^ (swap << 28);
+            for (size_t j = 0; j < binary_count; j++) {
+                body[j * column_bytes + i / 8] = (uint8_t)(bits >> (8 * j));
             }
         }
+        body += binary_count * column_bytes;
+        column += row_count * sizeof(uint32_t);
+    }
 
-        // write analog channels
-        for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
-            // skip disabled channels
-            if (!config->channel_enable[j]) {
-                continue;
-            }
-            // write analog data to file
-            if (config->file_format == RL_FILE_FORMAT_RLD) {
-                fwrite(&analog_data[j], sizeof(int32_t), 1, data_file);
-            } else if (config->file_format == RL_FILE_FORMAT_CSV) {
-                fprintf(data_file, (RL_FILE_CSV_DELIMITER "%d"),
-                        analog_data[j]);
+    // analog channels copied with padding
+    size_t const column_bytes = rl_arrow_get_column_bytes(false, row_count);
+    for (size_t j = 0; j < analog_count; j++) {
+        memcpy(body, column, row_count * sizeof(int32_t));
+        memset(body + row_count * sizeof(int32_t), 0,
+               column_bytes - row_count * sizeof(int32_t));
+        body += column_bytes;
+        column += row_count * sizeof(int32_t);
+    }
+
+    arrow_block->metadata_length = (uint32_t)metadata_length;
+    arrow_block->body_length = (uint64_t)(body - (block + metadata_length));
+    return (size_t)(body - block);
+}
+
+static size_t rl_file_get_arrow_block_bytes_max(size_t buffer_size) {
+    return RL_ARROW_BATCH_METADATA_BYTES_MAX +
+           (RL_CHANNEL_DIGITAL_COUNT + 2) *
+               rl_arrow_get_column_bytes(true, buffer_size) +
+           RL_CHANNEL_COUNT * rl_arrow_get_column_bytes(false, buffer_size);
+}
+
+/// Maximum number of bytes written beyond a formatted CSV value
+#define RL_FILE_CSV_FORMAT_OVERRUN RL_FILE_CSV_VALUE_WIDTH
+
+/// Powers of ten representable as 32 bit unsigned integer
+static uint32_t const RL_FILE_POWERS_OF_TEN[] = {
+    1,      10,      100,      1000,      10000,
+    100000, 1000000, 10000000, 100000000, 1000000000,
+};
+
+/// Decimal digit pairs 00 to 99 for the integer to text conversion
+static char const RL_FILE_DIGIT_PAIRS[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536"
+    "37383940414243444546474849505152535455565758596061626364656667686970717273"
+    "7475767778798081828384858687888990919293949596979899";
+
+static size_t rl_file_get_csv_block_bytes_max(size_t buffer_size) {
+    // timestamp of sign, 19 digits, decimal point and nanoseconds in all rows
+    size_t const timestamp_bytes = 1 + 19 + 1 + 9;
+    // delimiter and bit for binary channels, delimiter and value for analog
+    size_t const row_bytes = timestamp_bytes +
+                             (RL_CHANNEL_DIGITAL_COUNT + 2) * 2 +
+                             RL_CHANNEL_COUNT * (1 + RL_FILE_CSV_VALUE_WIDTH) +
+                             1;
+    return buffer_size * row_bytes + RL_FILE_CSV_FORMAT_OVERRUN;
+}
+
+static size_t
+rl_file_format_csv_rows(char *const buffer, uint8_t const *samples,
+                        size_t sample_count,
+                        rl_timestamp_t const *const timestamp_realtime,
+                        rl_config_t const *const config) {
+    size_t const column_count = rl_file_get_column_count(config);
+    size_t const analog_count = count_channels(config->channel_enable);
+    size_t const analog_width =
+        config->file_fixed_width_enable ? RL_FILE_CSV_VALUE_WIDTH : 0;
+    size_t binary_count = 0;
+    if (config->digital_enable) {
+        binary_count += RL_CHANNEL_DIGITAL_COUNT;
+    }
+    if (config->channel_enable[RL_CONFIG_CHANNEL_I1L]) {
+        binary_count++;
+    }
+    if (config->channel_enable[RL_CONFIG_CHANNEL_I2L]) {
+        binary_count++;
+    }
+
+    // block timestamp in first row, blank of the same width in fixed width rows
+    size_t const timestamp_length = rl_file_format_timestamp(
+        buffer, timestamp_realtime,
+        config->file_fixed_width_enable ? RL_FILE_CSV_TIMESTAMP_WIDTH : 0);
+    char *row = buffer + timestamp_length;
+
+    for (size_t i = 0; i < sample_count; i++) {
+        uint8_t const *sample = samples + i * column_count * sizeof(uint32_t);
+        if (i > 0 && config->file_fixed_width_enable) {
+            memset(row, ' ', timestamp_length);
+            row += timestamp_length;
+        }
+
+        // binary channels as single bits, in order of the bit field
+        if (binary_count > 0) {
+            uint32_t binary;
+            memcpy(&binary, sample, sizeof(binary));
+            sample += sizeof(binary);
+            for (size_t j = 0; j < binary_count; j++) {
+                row[0] = RL_FILE_CSV_DELIMITER[0];
+                row[1] = (char)('0' + ((binary >> j) & 0x01));
+                row += 2;
             }
         }
 
-        // end of data row
-        if (config->file_format == RL_FILE_FORMAT_CSV) {
-            fprintf(data_file, "\n");
+        // analog channels
+        for (size_t j = 0; j < analog_count; j++) {
+            int32_t value;
+            memcpy(&value, sample, sizeof(value));
+            sample += sizeof(value);
+            *row++ = RL_FILE_CSV_DELIMITER[0];
+            row += rl_file_format_int32(row, value, analog_width);
         }
+
+        *row++ = '\n';
     }
 
-    // flush processed data if data is stored
-    if (config->file_enable && data_file != NULL) {
-        fflush(data_file);
+    return (size_t)(row - buffer);
+}
+
+static size_t rl_file_format_timestamp(char *const buffer,
+                                       rl_timestamp_t const *const timestamp,
+                                       size_t width) {
+    char digits[32];
+    char *const end = digits + sizeof(digits);
+
+    // nanoseconds zero padded to 9 digits
+    char *start = rl_file_format_digits(end, (uint32_t)timestamp->nsec);
+    while (end - start < 9) {
+        *--start = '0';
+    }
+    *--start = '.';
+
+    // seconds, using 64 bit divisions only beyond 32 bit (after year 2106)
+    uint64_t seconds = (timestamp->sec < 0) ? 0 - (uint64_t)timestamp->sec
+                                            : (uint64_t)timestamp->sec;
+    while (seconds > UINT32_MAX) {
+        *--start = (char)('0' + seconds % 10);
+        seconds /= 10;
+    }
+    start = rl_file_format_digits(start, (uint32_t)seconds);
+    if (timestamp->sec < 0) {
+        *--start = '-';
     }
 
-    return 1;
+    size_t const length = (size_t)(end - start);
+    size_t const padding = (length < width) ? width - length : 0;
+    memset(buffer, ' ', padding);
+    memcpy(buffer + padding, start, length);
+    return padding + length;
 }
 
-int rl_file_add_ambient_block(FILE *ambient_file, int32_t const *ambient_buffer,
-                              size_t buffer_size,
-                              rl_timestamp_t const *const timestamp_realtime,
-                              rl_timestamp_t const *const timestamp_monotonic,
-                              rl_config_t const *const config) {
-    // suppress unused parameter warning
-    (void)config;
+static inline size_t rl_file_format_int32(char *const buffer, int32_t value,
+                                          size_t width) {
+    uint32_t const magnitude =
+        (value < 0) ? 0 - (uint32_t)value : (uint32_t)value;
+    size_t const sign = (value < 0) ? 1 : 0;
+    size_t const digit_count = rl_file_count_digits(magnitude);
+    size_t length = sign + digit_count;
+    if (length < width) {
+        length = width;
+    }
+    char *digits = buffer + length - digit_count;
+
+    // padding and sign, the sign is overwritten by the digits if positive.
+    // Fixed size stores avoid branches on the number of digits, which are
+    // mispredicted for varying sample values
+    memset(buffer, ' ', RL_FILE_CSV_VALUE_WIDTH);
+    *(digits - sign) = '-';
+
+    // upper two digits, overwritten by the lower ones if not significant
+    uint32_t const high = magnitude / 100000000;
+    memcpy(digits, RL_FILE_DIGIT_PAIRS + 2 * high + (10 - digit_count), 2);
+
+    // lower eight digits in a 64 bit word, without leading zeros
+    uint32_t const low = magnitude % 100000000;
+    size_t const low_count = (digit_count > 8) ? 8 : digit_count;
+    uint64_t const word =
+        (rl_file_format_digits4(low / 10000) |
+         ((uint64_t)rl_file_format_digits4(low % 10000) << 32)) >>
+        (8 * (8 - low_count));
+    memcpy(digits + digit_count - low_count, &word, sizeof(word));
+
+    return length;
+}
 
-    // store timestamps
-    fwrite(timestamp_realtime, sizeof(rl_timestamp_t), 1, ambient_file);
-    fwrite(timestamp_monotonic, sizeof(rl_timestamp_t), 1, ambient_file);
+static inline size_t rl_file_count_digits(uint32_t value) {
+    // estimate from the bit width (log10(2) ~ 1233 / 4096), then correct
+    uint32_t const width = 32 - __builtin_clz(value | 1);
+    uint32_t const estimate = (width * 1233) >> 12;
+    return estimate + 1 -
+           (((value | 1) < RL_FILE_POWERS_OF_TEN[estimate]) ? 1 : 0);
+}
 
-    // store sensor data
-    fwrite(ambient_buffer, sizeof(int32_t), buffer_size, ambient_file);
+static inline uint32_t rl_file_format_digits4(uint32_t value) {
+    uint16_t high;
+    uint16_t low;
+    memcpy(&high, RL_FILE_DIGIT_PAIRS + 2 * (value / 100), sizeof(high));
+    memcpy(&low, RL_FILE_DIGIT_PAIRS + 2 * (value % 100), sizeof(low));
+    return (uint32_t)high | ((uint32_t)low << 16);
+}
 
-    return 1;
+static inline char *rl_file_format_digits(char *const end, uint32_t value) {
+    char *start = end;
+
+    // two digits per step using 32 bit divisions by constant
+    while (value >= 100) {
+        uint32_t const pair = value % 100;
+        value /= 100;
+        start -= 2;
+        memcpy(start, RL_FILE_DIGIT_PAIRS + 2 * pair, 2);
+    }
+    if (value >= 10) {
+        start -= 2;
+        memcpy(start, RL_FILE_DIGIT_PAIRS + 2 * value, 2);
+    } else {
+        *--start = (char)('0' + value);
+    }
+
+    return start;
 }
 
 void rl_file_setup_data_channels(rl_file_header_t *const file_header,
@@ -641,3 +2097,48 @@ void rl_file_setup_ambient_channels(rl_file_header_t *const header) {
         }
     }
 }
+
+static int rl_file_writev_all(int fd, struct iovec *iov, int iov_count) {
+    while (iov_count > 0) {
+        ssize_t written = writev(fd, iov, iov_count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return ERROR;
+        }
+
+        // skip completely written vector elements, advance partial ones
+        while (iov_count > 0 && (size_t)written >= iov->iov_len) {
+            written -= iov->iov_len;
+            iov++;
+            iov_count--;
+        }
+        if (iov_count > 0) {
+            iov->iov_base = (uint8_t *)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+
+    return SUCCESS;
+}
+
+static int rl_file_pwrite_all(int fd, void const *buffer, size_t length,
+                              off_t offset) {
+    uint8_t const *data = (uint8_t const *)buffer;
+    while (length > 0) {
+        ssize_t written = pwrite(fd, data, length, offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return ERROR;
+        }
+
+        data += written;
+        length -= written;
+        offset += written;
+    }
+
+    return SUCCESS;
+}
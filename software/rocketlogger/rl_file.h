@@ -45,6 +45,36 @@
 /// File format version of current implementation
 #define RL_FILE_VERSION 0x04
 
+/// File format version of the compressed data block variant
+#define RL_FILE_VERSION_COMPRESSED 0x05
+
+/// Number of consecutive values sharing a bit width in compressed data blocks
+#define RL_FILE_COMPRESS_GROUP_SIZE 128
+
+/// File format version of the channel-planar data block variant
+#define RL_FILE_VERSION_PLANAR 0x06
+
+/// File format version flag of data blocks followed by a CRC-32C checksum
+#define RL_FILE_VERSION_FLAG_CRC 0x0100
+
+/// File format version bits identifying the data block variant
+#define RL_FILE_VERSION_MASK 0x00FF
+
+/// File checkpoint record magic number (ascii %RLC)
+#define RL_FILE_CHECKPOINT_MAGIC 0x434C5225
+
+/// Data block index file magic number (ascii %RLI)
+#define RL_FILE_INDEX_MAGIC 0x494C5225
+
+/// Data block index file format version of current implementation
+#define RL_FILE_INDEX_VERSION 0x01
+
+/// Data block index file name extension, replacing the data file extension
+#define RL_FILE_INDEX_EXTENSION ".rli"
+
+/// Data written to file in bytes after which the header is updated
+#define RL_FILE_HEADER_UPDATE_BYTES (4UL * 1000UL * 1000UL)
+
 /// Maximum channel description length
 #define RL_FILE_CHANNEL_NAME_LENGTH 16
 
@@ -54,9 +84,18 @@
 /// Comment alignment in bytes
 #define RL_FILE_COMMENT_ALIGNMENT_BYTES sizeof(uint32_t)
 
+/// Alignment of the binary data block buffer in bytes (cache line size)
+#define RL_FILE_BLOCK_BUFFER_ALIGNMENT 64
+
 /// CSV value delimiter character
 #define RL_FILE_CSV_DELIMITER ","
 
+/// Width of the timestamp column of fixed width CSV data rows (until 2286)
+#define RL_FILE_CSV_TIMESTAMP_WIDTH 20
+
+/// Width of analog values in fixed width CSV data rows (32 bit with sign)
+#define RL_FILE_CSV_VALUE_WIDTH 11
+
 /// Ambient sensor data file name suffix
 #define RL_FILE_AMBIENT_SUFFIX "-ambient"
 
@@ -136,6 +175,68 @@ struct rl_file_lead_in {
  */
 typedef struct rl_file_lead_in rl_file_lead_in_t;
 
+/**
+ * Checkpoint record appended after the last data block of the binary file.
+ *
+ * The record is overwritten by the next data block and removed when the file
+ * is closed. A valid record at the end of an unfinished file provides the
+ * data block and sample counts not yet updated in the header.
+ */
+struct rl_file_checkpoint {
+    /// Checkpoint magic constant
+    uint32_t checkpoint_magic;
+    /// Number of data blocks stored in the file
+    uint32_t data_block_count;
+    /// Total sample count
+    uint64_t sample_count;
+    /// File offset of the checkpoint record (end of the data blocks)
+    uint64_t checkpoint_offset;
+};
+
+/**
+ * Typedef for RocketLogger file checkpoint record
+ */
+typedef struct rl_file_checkpoint rl_file_checkpoint_t;
+
+/**
+ * Header of the data block index file stored alongside a binary data file.
+ *
+ * The header is followed by one index record per data block stored in the
+ * data file, in the order of the data blocks.
+ */
+struct rl_file_index_header {
+    /// Index file magic constant
+    uint32_t index_magic;
+    /// Index file version number
+    uint16_t index_version;
+    /// Size of the index records in bytes
+    uint16_t record_length;
+    /// Start time of the indexed data file, to match it with the data file
+    rl_timestamp_t start_time;
+};
+
+/**
+ * Typedef for RocketLogger data block index file header
+ */
+typedef struct rl_file_index_header rl_file_index_header_t;
+
+/**
+ * Data block index record, locating a data block in the data file.
+ */
+struct rl_file_index_record {
+    /// File offset of the data block
+    uint64_t block_offset;
+    /// Realtime timestamp of the data block
+    rl_timestamp_t timestamp_realtime;
+    /// Monotonic timestamp of the data block
+    rl_timestamp_t timestamp_monotonic;
+};
+
+/**
+ * Typedef for RocketLogger data block index record
+ */
+typedef struct rl_file_index_record rl_file_index_record_t;
+
 /**
  * Channel definition for the binary file header.
  */
@@ -190,6 +291,53 @@ char *rl_unit_to_string(rl_unit_t unit);
  */
 char *rl_file_get_ambient_file_name(char const *const data_file_name);
 
+/**
+ * Derive the data block index file name from the data file name.
+ *
+ * @param data_file_name The data file name
+ * @return Pointer to the buffer of the derived index file name
+ */
+char *rl_file_get_index_file_name(char const *const data_file_name);
+
+/**
+ * Derive the file name of a measurement file part ("<name>_p<index>.<ext>").
+ *
+ * @param part_file_name Buffer of size PATH_MAX to write the part file name to
+ * @param file_name The file name of the first measurement file part
+ * @param part_index The index of the file part
+ */
+void rl_file_get_part_file_name(char *const part_file_name,
+                                char const *const file_name,
+                                uint32_t part_index);
+
+/**
+ * Get the maximum size of a binary data block including its timestamps.
+ *
+ * Includes the overhead of compressed data blocks in the worst case and the
+ * data block checksum.
+ *
+ * @param buffer_size Maximum number of data samples per block
+ * @return Maximum data block size in bytes
+ */
+size_t rl_file_get_data_block_bytes_max(size_t buffer_size);
+
+/**
+ * Allocate the cache line aligned buffers used to assemble data blocks.
+ *
+ * The buffers are grown when adding data blocks larger than allocated, calling
+ * this function before sampling avoids allocating in the data path.
+ *
+ * @param buffer_size Maximum number of data samples per block
+ * @param file_format The file format of the data blocks to assemble
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_file_block_buffer_init(size_t buffer_size, rl_file_format_t file_format);
+
+/**
+ * Free the data block buffers.
+ */
+void rl_file_block_buffer_deinit(void);
+
 /**
  * Set up data file header lead-in with current configuration.
  *
@@ -229,6 +377,10 @@ void rl_file_setup_ambient_header(rl_file_header_t *const file_header,
 /**
  * Store file header to file (in binary format).
  *
+ * For the channel-planar variant (RL_FILE_VERSION_PLANAR) the channel
+ * definitions are followed by the 32 bit byte offset of each data column
+ * within a data block, the binary bit field column first if stored.
+ *
  * @param file_handle Data file to write to
  * @param file_header The file header data structure to store to the file
  */
@@ -244,31 +396,181 @@ void rl_file_store_header_bin(FILE *file_handle,
 void rl_file_store_header_csv(FILE *file_handle,
                               rl_file_header_t const *const file_header);
 
+/**
+ * Store file header to file (in Arrow IPC file format).
+ *
+ * Stores the file magic and the schema message describing the channels.
+ *
+ * @param file_handle Data file to write to
+ * @param file_header The file header data structure to store to the file
+ */
+void rl_file_store_header_arrow(FILE *file_handle,
+                                rl_file_header_t const *const file_header);
+
+/**
+ * Store the file footer listing the data blocks stored since the last footer
+ * (in Arrow IPC file format).
+ *
+ * Completes the file at the current stream position. Data blocks added after
+ * the footer are listed in the footer of the next file.
+ *
+ * @param file_handle Data file to write to
+ * @param file_header The file header data structure of the file
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_file_store_footer_arrow(FILE *file_handle,
+                               rl_file_header_t const *const file_header);
+
 /**
  * Update file with new header lead-in (to write current sample count) in binary
  * format.
  *
+ * Uses a positioned write that leaves the file stream position untouched.
+ *
  * @param file_handle Data file to write to
  * @param file_header The file header data structure to store to the file
+ * @return Returns 0 on success, negative on failure with errno set accordingly
  */
-void rl_file_update_header_bin(FILE *file_handle,
-                               rl_file_header_t const *const file_header);
+int rl_file_update_header_bin(FILE *file_handle,
+                              rl_file_header_t const *const file_header);
 
 /**
  * Update file with new header lead-in (to write current sample count) in CSV
  * format.
  *
+ * Uses a positioned write that leaves the file stream position untouched.
+ *
  * @param file_handle Data file to write to
  * @param file_header The file header data structure to store to the file
+ * @return Returns 0 on success, negative on failure with errno set accordingly
  */
-void rl_file_update_header_csv(FILE *file_handle,
-                               rl_file_header_t const *const file_header);
+int rl_file_update_header_csv(FILE *file_handle,
+                              rl_file_header_t const *const file_header);
+
+/**
+ * Store checkpoint record with the current header counts after the last data
+ * block of a binary file.
+ *
+ * Uses a positioned write at the file stream position, such that the record is
+ * overwritten by the next data block.
+ *
+ * @param file_handle Data file to write to
+ * @param file_header The file header data structure with the current counts
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_file_store_checkpoint(FILE *file_handle,
+                             rl_file_header_t const *const file_header);
+
+/**
+ * Store the data block index file header for a binary data file.
+ *
+ * @param index_file Index file to write to
+ * @param data_file_header The header of the indexed data file
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_file_store_index_header(FILE *index_file,
+                               rl_file_header_t const *const data_file_header);
+
+/**
+ * Append the index record of a data block to the data block index file.
+ *
+ * @param index_file Index file to write to
+ * @param block_offset Data file offset of the data block
+ * @param timestamp_realtime Realtime timestamp of the data block
+ * @param timestamp_monotonic Monotonic timestamp of the data block
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_file_add_index_record(FILE *index_file, uint64_t block_offset,
+                             rl_timestamp_t const *const timestamp_realtime,
+                             rl_timestamp_t const *const timestamp_monotonic);
+
+/**
+ * Preallocate file system space for a file without changing its size.
+ *
+ * The size is rounded up to a multiple of the file system block size. The
+ * space beyond the written data is released again by rl_file_trim().
+ *
+ * @param file_handle File to preallocate space for
+ * @param size Number of bytes to preallocate
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_file_preallocate(FILE *file_handle, uint64_t size);
+
+/**
+ * Trim a file at the file stream position before closing it.
+ *
+ * Removes the checkpoint record of binary files and releases unused
+ * preallocated space. To be called after the final header update.
+ *
+ * @param file_handle File to truncate
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_file_trim(FILE *file_handle);
+
+/**
+ * Encode a checkpoint record with the current header counts.
+ *
+ * @param buffer Buffer of at least sizeof(rl_file_checkpoint_t) bytes
+ * @param file_header The file header data structure with the current counts
+ * @param offset File offset the checkpoint record is written at
+ * @return Number of bytes encoded
+ */
+size_t rl_file_encode_checkpoint(uint8_t *const buffer,
+                                 rl_file_header_t const *const file_header,
+                                 uint64_t offset);
+
+/**
+ * Encode the sampling data buffer to a binary data block with timestamps.
+ *
+ * With compression enabled the block is stored in the compressed format
+ * (RL_FILE_VERSION_COMPRESSED): a 32 bit block size in bytes, the timestamps,
+ * the first value of each data column (binary bit field if stored and enabled
+ * analog channels), the bit width of each group of RL_FILE_COMPRESS_GROUP_SIZE
+ * values per column, followed by the column-wise zig-zag encoded differences
+ * of consecutive values bit-packed with the width of their group. Each group
+ * is padded to full bytes, the width table and the block to 32 bit words.
+ *
+ * With the channel-planar layout enabled the block is stored in the planar
+ * format (RL_FILE_VERSION_PLANAR): the timestamps followed by each data column
+ * (binary bit field if stored and enabled analog channels) stored contiguously
+ * for all samples of the block, at the column offsets stored in the header.
+ *
+ * With checksums enabled (RL_FILE_VERSION_FLAG_CRC set in the file version)
+ * each block of either format is followed by the CRC-32C of the block bytes,
+ * which is included in the size of compressed blocks.
+ *
+ * @param block Buffer of at least rl_file_get_data_block_bytes_max() bytes
+ * @param analog_buffer Analog data buffer to process (channel-major)
+ * @param digital_buffer Digital data buffer to process
+ * @param buffer_size Number of data samples in the buffer
+ * @param timestamp_realtime Timestamp sampled from realtime clock
+ * @param timestamp_monotonic Timestamp sampled from monotonic clock
+ * @param config Current measurement configuration
+ * @return Number of bytes encoded, 0 on failure with errno set accordingly
+ */
+size_t rl_file_encode_data_block(
+    uint8_t *const block, int32_t const *analog_buffer,
+    uint32_t const *digital_buffer, size_t buffer_size,
+    rl_timestamp_t const *const timestamp_realtime,
+    rl_timestamp_t const *const timestamp_monotonic,
+    rl_config_t const *const config);
 
 /**
  * Handle the sampling data buffer to add a new block to the data file.
  *
+ * CSV data blocks are formatted to text in the block buffer and written at
+ * once, with the block timestamp in the first data row only. With fixed width
+ * data rows, the timestamp column is padded to RL_FILE_CSV_TIMESTAMP_WIDTH and
+ * analog values to RL_FILE_CSV_VALUE_WIDTH characters, such that all data rows
+ * of a file have the same length.
+ *
+ * Arrow data blocks are stored as one record batch each, with bit-packed
+ * boolean columns for the binary channels and 32 bit integer columns for the
+ * analog channels. The data blocks are listed in the file footer written by
+ * rl_file_store_footer_arrow().
+ *
  * @param data_file Data file to write to
- * @param analog_buffer Analog data buffer to process
+ * @param analog_buffer Analog data buffer to process (channel-major)
  * @param digital_buffer Digital data buffer to process
  * @param buffer_size Number of data samples in the buffer
  * @param timestamp_realtime Timestamp sampled from realtime clock
@@ -301,4 +603,19 @@ int rl_file_add_ambient_block(FILE *ambient_file, int32_t const *ambient_buffer,
                               rl_timestamp_t const *const timestamp_monotonic,
                               rl_config_t const *const config);
 
+/**
+ * Encode the sensor data buffer to a binary ambient block with timestamps.
+ *
+ * @param block Buffer to encode the block to
+ * @param ambient_buffer Ambient sensor data buffer to process
+ * @param buffer_size Number of sensor samples in the buffer
+ * @param timestamp_realtime Timestamp sampled from realtime clock
+ * @param timestamp_monotonic Timestamp sampled from monotonic clock
+ * @return Number of bytes encoded
+ */
+size_t rl_file_encode_ambient_block(
+    uint8_t *const block, int32_t const *ambient_buffer, size_t buffer_size,
+    rl_timestamp_t const *const timestamp_realtime,
+    rl_timestamp_t const *const timestamp_monotonic);
+
 #endif /* RL_FILE_H_ */
@@ -30,6 +30,7 @@
  */
 
 #include <errno.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <string.h>
 
@@ -42,6 +43,7 @@
 #include "log.h"
 #include "rl.h"
 #include "rl_hw.h"
+#include "rl_shm.h"
 #include "rl_socket.h"
 #include "util.h"
 
@@ -83,6 +85,11 @@ int rl_get_status(rl_status_t *const status) {
         return res;
     }
 
+    // file system state is kept up to date while sampling
+    if (status->sampling) {
+        return res;
+    }
+
     // get file system state
     int64_t disk_free = fs_space_free(RL_CONFIG_FILE_DIR_DEFAULT);
     int64_t disk_total = fs_space_total(RL_CONFIG_FILE_DIR_DEFAULT);
@@ -200,6 +207,121 @@ int rl_stop(void) {
     return SUCCESS;
 }
 
+int rl_data_reader_open(rl_data_reader_t *const reader) {
+    reader->shm = NULL;
+    reader->sequence = 0;
+    reader->blocks_lost = 0;
+
+    // get ID and attach shared memory read-only
+    int shm_id = shmget(RL_SHMEM_DATA_KEY, 0, RL_SHMEM_PERMISSIONS);
+    if (shm_id == -1) {
+        return ERROR;
+    }
+
+    void *const shm = shmat(shm_id, NULL, SHM_RDONLY);
+    if (shm == (void *)-1) {
+        rl_log(RL_LOG_ERROR,
+               "failed mapping shared data memory; %d message: %s", errno,
+               strerror(errno));
+        return ERROR;
+    }
+
+    rl_shm_header_t const *const header = (rl_shm_header_t const *)shm;
+    if (header->version != RL_SHM_VERSION) {
+        rl_log(RL_LOG_ERROR, "unsupported shared data memory version %u",
+               header->version);
+        shmdt(shm);
+        errno = EPROTO;
+        return ERROR;
+    }
+
+    // start with the next block written
+    reader->shm = header;
+    reader->sequence = atomic_load_explicit(
+        (atomic_uint *)&header->write_sequence, memory_order_acquire);
+
+    return SUCCESS;
+}
+
+int rl_data_reader_close(rl_data_reader_t *const reader) {
+    if (reader->shm == NULL) {
+        return SUCCESS;
+    }
+
+    int res = shmdt(reader->shm);
+    reader->shm = NULL;
+    if (res == -1) {
+        rl_log(RL_LOG_ERROR,
+               "failed detaching shared data memory; %d message: %s", errno,
+               strerror(errno));
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+int rl_data_reader_next(rl_data_reader_t *const reader,
+                        rl_data_block_t *const block) {
+    if (reader->shm == NULL) {
+        errno = EBADF;
+        return ERROR;
+    }
+
+    // stop state before checking, for the last blocks written before the stop
+    bool const stopped = atomic_load_explicit(
+        (atomic_uint *)&reader->shm->stopped, memory_order_acquire);
+
+    uint32_t lost = 0;
+    rl_shm_block_t const *const shm_block =
+        rl_shm_ring_check(reader->shm, &reader->sequence, &lost);
+    if (lost > 0) {
+        reader->blocks_lost += lost;
+        errno = EOVERFLOW;
+        return ERROR;
+    }
+    if (shm_block == NULL && stopped) {
+        errno = ESTALE;
+        return ERROR;
+    }
+    if (shm_block == NULL) {
+        return 0;
+    }
+
+    block->sequence = reader->sequence;
+    block->sample_count = shm_block->sample_count;
+    block->index = shm_block->index;
+    block->samples_lost = shm_block->samples_lost;
+    block->timestamp_realtime = shm_block->timestamp_realtime;
+    block->timestamp_monotonic = shm_block->timestamp_monotonic;
+    for (int ch = 0; ch < RL_CHANNEL_COUNT; ch++) {
+        block->channel[ch] =
+            rl_shm_block_get_channel(reader->shm, shm_block, ch);
+    }
+    block->digital = rl_shm_block_get_digital(reader->shm, shm_block);
+    block->block = shm_block;
+    reader->sequence++;
+
+    // block header overwritten while reading
+    if (rl_shm_ring_validate(shm_block, block->sequence) < 0) {
+        reader->blocks_lost++;
+        errno = EOVERFLOW;
+        return ERROR;
+    }
+
+    return 1;
+}
+
+int rl_data_reader_validate(rl_data_reader_t *const reader,
+                            rl_data_block_t const *const block) {
+    if (rl_shm_ring_validate(block->block, block->sequence) < 0) {
+        reader->blocks_lost++;
+        errno = EOVERFLOW;
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
 static void rl_signal_handler(int signal_number) {
     // signal generated by stop function
     if (signal_number == SIGTERM) {
@@ -32,7 +32,59 @@
 #ifndef RL_LIB_H_
 #define RL_LIB_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include "rl.h"
+#include "rl_shm.h"
+#include "util.h"
+
+/**
+ * Reader of the data shared memory ring of a running measurement.
+ */
+struct rl_data_reader {
+    /// Attached data shared memory ring (read-only), NULL if not open
+    rl_shm_header_t const *shm;
+    /// Sequence of the next block to read
+    uint32_t sequence;
+    /// Number of blocks overwritten before they were read
+    uint32_t blocks_lost;
+};
+
+/**
+ * Type definition for data shared memory ring reader.
+ */
+typedef struct rl_data_reader rl_data_reader_t;
+
+/**
+ * Data block read from the data shared memory ring, referencing the data in
+ * the shared memory without copying.
+ */
+struct rl_data_block {
+    /// Sequence of the block in the ring
+    uint32_t sequence;
+    /// Number of valid samples in the block
+    size_t sample_count;
+    /// Index of the sampled buffer, including buffers lost by overruns
+    uint64_t index;
+    /// Total number of samples lost by sampling overruns
+    uint64_t samples_lost;
+    /// Timestamp of the first sample from realtime clock
+    rl_timestamp_t timestamp_realtime;
+    /// Timestamp of the first sample from monotonic clock
+    rl_timestamp_t timestamp_monotonic;
+    /// Calibrated samples of each analog channel, NULL if not enabled
+    int32_t const *channel[RL_CHANNEL_COUNT];
+    /// Digital samples
+    uint32_t const *digital;
+    /// The block in the data shared memory ring
+    rl_shm_block_t const *block;
+};
+
+/**
+ * Type definition for data block read from the data shared memory ring.
+ */
+typedef struct rl_data_block rl_data_block_t;
 
 /**
  * Check whether RocketLogger is sampling.
@@ -69,4 +121,56 @@ int rl_run(rl_config_t *const config);
  */
 int rl_stop(void);
 
+/**
+ * Attach a reader to the data shared memory ring of the running measurement.
+ *
+ * The reader starts with the next block written. The ring layout (sample
+ * rate, block length and stored channels) is available in the reader's ring
+ * header. Fails with errno set to ENOENT if no measurement with enabled data
+ * shared memory is running.
+ *
+ * @param reader The reader to attach
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_data_reader_open(rl_data_reader_t *const reader);
+
+/**
+ * Detach a reader from the data shared memory ring.
+ *
+ * @param reader The reader to detach
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_data_reader_close(rl_data_reader_t *const reader);
+
+/**
+ * Get the next data block from the data shared memory ring without waiting.
+ *
+ * If the writer overwrote blocks before they were read, fails with errno set
+ * to EOVERFLOW once and continues with the oldest block still available on
+ * the next call. After the measurement stopped and all blocks were read,
+ * fails with errno set to ESTALE, the reader is to be reopened for the next
+ * measurement.
+ *
+ * @param reader The reader
+ * @param block The block to reference the data of the next block
+ * @return Returns 1 if a block was read, 0 if no new block is available,
+ * negative on failure with errno set accordingly
+ */
+int rl_data_reader_next(rl_data_reader_t *const reader,
+                        rl_data_block_t *const block);
+
+/**
+ * Validate a data block was not overwritten while processing its data.
+ *
+ * Fails with errno set to EOVERFLOW if the writer overwrote the block, in
+ * which case the processed data is inconsistent.
+ *
+ * @param reader The reader
+ * @param block The processed block
+ * @return Returns 0 if the block is still valid, negative on failure with
+ * errno set accordingly
+ */
+int rl_data_reader_validate(rl_data_reader_t *const reader,
+                            rl_data_block_t const *const block);
+
 #endif /* RL_LIB_H_ */
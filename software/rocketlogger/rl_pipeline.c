@@ -0,0 +1,446 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log.h"
+#include "rl.h"
+
+#include "rl_pipeline.h"
+
+/**
+ * Pipeline consumer thread processing published buffers.
+ *
+ * @param arg The pipeline consumer to run
+ * @return Always returns NULL
+ */
+static void *rl_pipeline_consumer_run(void *arg);
+
+/**
+ * Check whether a published buffer is pending for a consumer.
+ *
+ * @param consumer The pipeline consumer to check
+ * @return Returns true if a buffer is pending, false otherwise
+ */
+static bool
+rl_pipeline_consumer_pending(rl_pipeline_consumer_t *const consumer);
+
+/**
+ * Take the next buffer to process by a consumer.
+ *
+ * @param consumer The pipeline consumer to take the buffer for
+ * @return Index of the buffer to process, RL_PIPELINE_BUFFER_NONE if none
+ */
+static uint32_t
+rl_pipeline_consumer_take(rl_pipeline_consumer_t *const consumer);
+
+/**
+ * Release a consumer's reference to a buffer of the pool.
+ *
+ * @param pipeline The pipeline the buffer belongs to
+ * @param index Index of the buffer to release
+ */
+static void rl_pipeline_release(rl_pipeline_t *const pipeline, uint32_t index);
+
+uint32_t rl_pipeline_get_buffer_count(rl_config_t const *const config) {
+    uint32_t buffer_count = RL_PIPELINE_BUFFER_TIME * config->update_rate;
+    if (buffer_count < RL_PIPELINE_BUFFER_COUNT_MIN) {
+        buffer_count = RL_PIPELINE_BUFFER_COUNT_MIN;
+    }
+    return buffer_count;
+}
+
+int rl_pipeline_init(rl_pipeline_t *const pipeline, uint32_t buffer_count,
+                     size_t buffer_length) {
+    memset(pipeline, 0, sizeof(rl_pipeline_t));
+
+    // lossless consumer queues plus the buffers held by producer and lossy
+    // consumers (one processed, one pending each)
+    uint32_t const pool_count = buffer_count + RL_PIPELINE_BUFFER_RESERVE;
+    pipeline->buffers = calloc(pool_count, sizeof(rl_pipeline_buffer_t));
+    pipeline->references = calloc(pool_count, sizeof(atomic_uint));
+    if (pipeline->buffers == NULL || pipeline->references == NULL) {
+        rl_log(RL_LOG_ERROR,
+               "failed allocating pipeline buffer pool; %d message: %s", errno,
+               strerror(errno));
+        rl_pipeline_deinit(pipeline);
+        return ERROR;
+    }
+    pipeline->buffer_count = pool_count;
+    pipeline->queue_length = buffer_count;
+
+    for (uint32_t i = 0; i < pool_count; i++) {
+        rl_pipeline_buffer_t *const buffer = &pipeline->buffers[i];
+        atomic_init(&pipeline->references[i], 0);
+        buffer->analog_buffer =
+            malloc(buffer_length * RL_CHANNEL_COUNT * sizeof(int32_t));
+        buffer->digital_buffer = malloc(buffer_length * sizeof(uint32_t));
+        if (buffer->analog_buffer == NULL || buffer->digital_buffer == NULL) {
+            rl_log(RL_LOG_ERROR,
+                   "failed allocating pipeline data buffer; %d message: %s",
+                   errno, strerror(errno));
+            rl_pipeline_deinit(pipeline);
+            return ERROR;
+        }
+    }
+
+    for (int i = 0; i < RL_PIPELINE_CONSUMER_COUNT; i++) {
+        rl_pipeline_consumer_t *const consumer = &pipeline->consumer[i];
+        consumer->queue = malloc(buffer_count * sizeof(uint32_t));
+        if (consumer->queue == NULL) {
+            rl_log(RL_LOG_ERROR,
+                   "failed allocating pipeline consumer queue; %d message: %s",
+                   errno, strerror(errno));
+            rl_pipeline_deinit(pipeline);
+            return ERROR;
+        }
+        atomic_init(&consumer->enabled, false);
+        atomic_init(&consumer->queue_head, 0);
+        atomic_init(&consumer->queue_tail, 0);
+        atomic_init(&consumer->latest, RL_PIPELINE_BUFFER_NONE);
+        atomic_init(&consumer->dropped, 0);
+    }
+
+    atomic_init(&pipeline->write_sequence, 0);
+    atomic_init(&pipeline->running, false);
+    atomic_init(&pipeline->error, false);
+    pthread_mutex_init(&pipeline->mutex, NULL);
+    pthread_cond_init(&pipeline->ready, NULL);
+
+    return SUCCESS;
+}
+
+void rl_pipeline_deinit(rl_pipeline_t *const pipeline) {
+    if (pipeline->buffers != NULL) {
+        for (uint32_t i = 0; i < pipeline->buffer_count; i++) {
+            free(pipeline->buffers[i].analog_buffer);
+            free(pipeline->buffers[i].digital_buffer);
+        }
+    }
+    for (int i = 0; i < RL_PIPELINE_CONSUMER_COUNT; i++) {
+        free(pipeline->consumer[i].queue);
+        pipeline->consumer[i].queue = NULL;
+    }
+    if (pipeline->buffer_count > 0) {
+        pthread_cond_destroy(&pipeline->ready);
+        pthread_mutex_destroy(&pipeline->mutex);
+    }
+    free(pipeline->buffers);
+    free(pipeline->references);
+    pipeline->buffers = NULL;
+    pipeline->references = NULL;
+    pipeline->buffer_count = 0;
+}
+
+int rl_pipeline_add_consumer(rl_pipeline_t *const pipeline,
+                             rl_pipeline_consumer_id_t id,
+                             rl_pipeline_handler_t handler, void *const context,
+                             bool lossless) {
+    if (id >= RL_PIPELINE_CONSUMER_COUNT || handler == NULL) {
+        errno = EINVAL;
+        return ERROR;
+    }
+
+    rl_pipeline_consumer_t *const consumer = &pipeline->consumer[id];
+    consumer->pipeline = pipeline;
+    consumer->handler = handler;
+    consumer->context = context;
+    consumer->lossless = lossless;
+    atomic_store(&consumer->queue_head, 0);
+    atomic_store(&consumer->queue_tail, 0);
+    atomic_store(&consumer->latest, RL_PIPELINE_BUFFER_NONE);
+    atomic_store(&consumer->dropped, 0);
+    atomic_store(&consumer->enabled, true);
+    return SUCCESS;
+}
+
+int rl_pipeline_start(rl_pipeline_t *const pipeline) {
+    atomic_store(&pipeline->running, true);
+
+    // block stop signals in consumer threads, to be handled by the producer
+    sigset_t signal_mask;
+    sigset_t signal_mask_backup;
+    sigemptyset(&signal_mask);
+    sigaddset(&signal_mask, SIGTERM);
+    sigaddset(&signal_mask, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &signal_mask, &signal_mask_backup);
+
+    int res = SUCCESS;
+    for (int i = 0; i < RL_PIPELINE_CONSUMER_COUNT; i++) {
+        rl_pipeline_consumer_t *const consumer = &pipeline->consumer[i];
+        if (!atomic_load(&consumer->enabled)) {
+            continue;
+        }
+
+        int ret = pthread_create(&consumer->thread, NULL,
+                                 rl_pipeline_consumer_run, consumer);
+        if (ret != 0) {
+            errno = ret;
+            rl_log(RL_LOG_ERROR,
+                   "failed creating pipeline consumer thread; %d message: %s",
+                   errno, strerror(errno));
+            atomic_store(&consumer->enabled, false);
+            res = ERROR;
+            continue;
+        }
+        consumer->thread_started = true;
+    }
+
+    pthread_sigmask(SIG_SETMASK, &signal_mask_backup, NULL);
+
+    if (res != SUCCESS) {
+        rl_pipeline_stop(pipeline);
+    }
+
+    return res;
+}
+
+int rl_pipeline_stop(rl_pipeline_t *const pipeline) {
+    // wake and join consumers, which drain all published buffers before exit
+    pthread_mutex_lock(&pipeline->mutex);
+    atomic_store(&pipeline->running, false);
+    pthread_cond_broadcast(&pipeline->ready);
+    pthread_mutex_unlock(&pipeline->mutex);
+
+    for (int i = 0; i < RL_PIPELINE_CONSUMER_COUNT; i++) {
+        rl_pipeline_consumer_t *const consumer = &pipeline->consumer[i];
+        if (!consumer->thread_started) {
+            continue;
+        }
+        pthread_join(consumer->thread, NULL);
+        consumer->thread_started = false;
+    }
+
+    if (atomic_load(&pipeline->error)) {
+        return ERROR;
+    }
+    return SUCCESS;
+}
+
+rl_pipeline_buffer_t *rl_pipeline_acquire(rl_pipeline_t *const pipeline) {
+    // search the next buffer no consumer holds anymore, buffers are released
+    // mostly in order of publishing
+    for (uint32_t i = 1; i <= pipeline->buffer_count; i++) {
+        uint32_t const index =
+            (pipeline->acquired + i) % pipeline->buffer_count;
+        if (atomic_load_explicit(&pipeline->references[index],
+                                 memory_order_acquire) == 0) {
+            pipeline->acquired = index;
+            return &pipeline->buffers[index];
+        }
+    }
+
+    // all buffers queued for multiple lossless consumers: drop for all
+    for (int i = 0; i < RL_PIPELINE_CONSUMER_COUNT; i++) {
+        rl_pipeline_consumer_t *const consumer = &pipeline->consumer[i];
+        if (atomic_load_explicit(&consumer->enabled, memory_order_relaxed)) {
+            atomic_fetch_add_explicit(&consumer->dropped, 1,
+                                      memory_order_relaxed);
+        }
+    }
+    return NULL;
+}
+
+void rl_pipeline_publish(rl_pipeline_t *const pipeline) {
+    uint32_t const index = pipeline->acquired;
+
+    // lossless consumers with a full queue drop the buffer, the others
+    // reference it until processed or replaced by a newer buffer
+    bool deliver[RL_PIPELINE_CONSUMER_COUNT];
+    unsigned int references = 0;
+    for (int i = 0; i < RL_PIPELINE_CONSUMER_COUNT; i++) {
+        rl_pipeline_consumer_t *const consumer = &pipeline->consumer[i];
+        deliver[i] =
+            atomic_load_explicit(&consumer->enabled, memory_order_relaxed);
+        if (deliver[i] && consumer->lossless) {
+            unsigned int const tail = atomic_load_explicit(
+                &consumer->queue_tail, memory_order_relaxed);
+            unsigned int const head = atomic_load_explicit(
+                &consumer->queue_head, memory_order_acquire);
+            if (tail - head >= pipeline->queue_length) {
+                atomic_fetch_add_explicit(&consumer->dropped, 1,
+                                          memory_order_relaxed);
+                deliver[i] = false;
+            }
+        }
+        if (deliver[i]) {
+            references++;
+        }
+    }
+    atomic_store_explicit(&pipeline->references[index], references,
+                          memory_order_relaxed);
+
+    // hand over the buffer, the release orders the data and reference count
+    for (int i = 0; i < RL_PIPELINE_CONSUMER_COUNT; i++) {
+        rl_pipeline_consumer_t *const consumer = &pipeline->consumer[i];
+        if (!deliver[i]) {
+            continue;
+        }
+        if (consumer->lossless) {
+            unsigned int const tail = atomic_load_explicit(
+                &consumer->queue_tail, memory_order_relaxed);
+            consumer->queue[tail % pipeline->queue_length] = index;
+            atomic_store_explicit(&consumer->queue_tail, tail + 1,
+                                  memory_order_release);
+        } else {
+            uint32_t const skipped = atomic_exchange_explicit(
+                &consumer->latest, index, memory_order_acq_rel);
+            if (skipped != RL_PIPELINE_BUFFER_NONE) {
+                atomic_fetch_add_explicit(&consumer->dropped, 1,
+                                          memory_order_relaxed);
+                rl_pipeline_release(pipeline, skipped);
+            }
+        }
+    }
+    atomic_fetch_add_explicit(&pipeline->write_sequence, 1,
+                              memory_order_relaxed);
+
+    // wake up consumers waiting for new data
+    pthread_mutex_lock(&pipeline->mutex);
+    pthread_cond_broadcast(&pipeline->ready);
+    pthread_mutex_unlock(&pipeline->mutex);
+}
+
+bool rl_pipeline_has_error(rl_pipeline_t *const pipeline) {
+    return atomic_load_explicit(&pipeline->error, memory_order_relaxed);
+}
+
+void rl_pipeline_update_status(rl_pipeline_t *const pipeline,
+                               rl_status_t *const status) {
+    for (int i = 0; i < RL_PIPELINE_CONSUMER_COUNT; i++) {
+        rl_pipeline_consumer_t *const consumer = &pipeline->consumer[i];
+        if (consumer->handler == NULL) {
+            status->pipeline_backlog[i] = 0;
+            status->pipeline_dropped[i] = 0;
+            continue;
+        }
+        if (consumer->lossless) {
+            status->pipeline_backlog[i] =
+                atomic_load_explicit(&consumer->queue_tail,
+                                     memory_order_relaxed) -
+                atomic_load_explicit(&consumer->queue_head,
+                                     memory_order_relaxed);
+        } else {
+            status->pipeline_backlog[i] =
+                atomic_load_explicit(&consumer->latest,
+                                     memory_order_relaxed) !=
+                RL_PIPELINE_BUFFER_NONE;
+        }
+        status->pipeline_dropped[i] =
+            atomic_load_explicit(&consumer->dropped, memory_order_relaxed);
+    }
+}
+
+static void *rl_pipeline_consumer_run(void *arg) {
+    rl_pipeline_consumer_t *const consumer = (rl_pipeline_consumer_t *)arg;
+    rl_pipeline_t *const pipeline = consumer->pipeline;
+
+    while (true) {
+        // wait for published buffers or pipeline stop
+        pthread_mutex_lock(&pipeline->mutex);
+        while (atomic_load(&pipeline->running) &&
+               !rl_pipeline_consumer_pending(consumer)) {
+            pthread_cond_wait(&pipeline->ready, &pipeline->mutex);
+        }
+        bool const running = atomic_load(&pipeline->running);
+        pthread_mutex_unlock(&pipeline->mutex);
+
+        // process all pending buffers
+        uint32_t index;
+        while ((index = rl_pipeline_consumer_take(consumer)) !=
+               RL_PIPELINE_BUFFER_NONE) {
+            int res =
+                consumer->handler(&pipeline->buffers[index], consumer->context);
+
+            // release buffer back to the producer
+            rl_pipeline_release(pipeline, index);
+            if (consumer->lossless) {
+                atomic_fetch_add_explicit(&consumer->queue_head, 1,
+                                          memory_order_release);
+            }
+
+            // on failure detach from pipeline and report error to producer
+            if (res < 0) {
+                atomic_store(&consumer->enabled, false);
+                atomic_store(&pipeline->error, true);
+                return NULL;
+            }
+        }
+
+        if (!running) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+static bool
+rl_pipeline_consumer_pending(rl_pipeline_consumer_t *const consumer) {
+    if (consumer->lossless) {
+        return atomic_load(&consumer->queue_head) !=
+               atomic_load(&consumer->queue_tail);
+    }
+    return atomic_load(&consumer->latest) != RL_PIPELINE_BUFFER_NONE;
+}
+
+static uint32_t
+rl_pipeline_consumer_take(rl_pipeline_consumer_t *const consumer) {
+    rl_pipeline_t *const pipeline = consumer->pipeline;
+
+    // lossy consumers take over the newest buffer from the producer
+    if (!consumer->lossless) {
+        return atomic_exchange_explicit(&consumer->latest,
+                                        RL_PIPELINE_BUFFER_NONE,
+                                        memory_order_acq_rel);
+    }
+
+    unsigned int const head =
+        atomic_load_explicit(&consumer->queue_head, memory_order_relaxed);
+    unsigned int const tail =
+        atomic_load_explicit(&consumer->queue_tail, memory_order_acquire);
+    if (head == tail) {
+        return RL_PIPELINE_BUFFER_NONE;
+    }
+    return consumer->queue[head % pipeline->queue_length];
+}
+
+static void rl_pipeline_release(rl_pipeline_t *const pipeline, uint32_t index) {
+    atomic_fetch_sub_explicit(&pipeline->references[index], 1,
+                              memory_order_release);
+}
@@ -0,0 +1,287 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RL_PIPELINE_H_
+#define RL_PIPELINE_H_
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rl.h"
+#include "sensor/sensor.h"
+#include "util.h"
+
+/// Time span in seconds the lossless pipeline consumers are able to buffer
+#define RL_PIPELINE_BUFFER_TIME 4
+/// Minimum number of buffers queued for lossless pipeline consumers
+#define RL_PIPELINE_BUFFER_COUNT_MIN 4
+/// Buffers reserved for the producer and the lossy consumers (two each)
+#define RL_PIPELINE_BUFFER_RESERVE (2 * RL_PIPELINE_CONSUMER_COUNT + 1)
+/// Buffer index marking an empty lossy consumer slot
+#define RL_PIPELINE_BUFFER_NONE UINT32_MAX
+
+/**
+ * RocketLogger pipeline consumer identifiers.
+ */
+enum rl_pipeline_consumer_id {
+    RL_PIPELINE_CONSUMER_FILE = 0,  /// File storage consumer
+    RL_PIPELINE_CONSUMER_WEB = 1,   /// Web interface data stream consumer
+    RL_PIPELINE_CONSUMER_METER = 2, /// Interactive meter display consumer
+};
+
+/**
+ * Typedef for RocketLogger pipeline consumer identifiers.
+ */
+typedef enum rl_pipeline_consumer_id rl_pipeline_consumer_id_t;
+
+/**
+ * Calibrated data buffer passed through the processing pipeline.
+ */
+struct rl_pipeline_buffer {
+    /// Index of the PRU buffer the data originates from
+    uint32_t index;
+    /// Total number of samples lost by overruns up to this buffer
+    uint64_t samples_lost;
+    /// Number of data samples in the buffer
+    size_t buffer_size;
+    /// Number of ambient sensor values in the buffer (zero if none)
+    size_t sensor_buffer_size;
+    /// Timestamp sampled from realtime clock
+    rl_timestamp_t timestamp_realtime;
+    /// Timestamp sampled from monotonic clock
+    rl_timestamp_t timestamp_monotonic;
+    /// Calibrated analog data (channel-major, buffer_size values per channel)
+    int32_t *analog_buffer;
+    /// Digital data (one value per sample)
+    uint32_t *digital_buffer;
+    /// Ambient sensor data
+    int32_t sensor_buffer[SENSOR_REGISTRY_SIZE];
+};
+
+/**
+ * Typedef for calibrated data buffer passed through the processing pipeline.
+ */
+typedef struct rl_pipeline_buffer rl_pipeline_buffer_t;
+
+/**
+ * Data handler function processing a single pipeline buffer.
+ *
+ * @param buffer The data buffer to process
+ * @param context The handler specific context passed at registration
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+typedef int (*rl_pipeline_handler_t)(rl_pipeline_buffer_t const *const buffer,
+                                     void *const context);
+
+/**
+ * Forward declaration of the pipeline structure.
+ */
+typedef struct rl_pipeline rl_pipeline_t;
+
+/**
+ * Pipeline consumer processing published buffers in a dedicated thread.
+ *
+ * Lossless consumers process the published buffers in order from a queue of
+ * buffer indexes. Lossy consumers only hold the newest published buffer, which
+ * replaces any buffer they did not start processing yet.
+ */
+struct rl_pipeline_consumer {
+    /// The pipeline the consumer belongs to
+    rl_pipeline_t *pipeline;
+    /// Data handler called for each processed buffer
+    rl_pipeline_handler_t handler;
+    /// Handler specific context
+    void *context;
+    /// Whether the consumer processes every buffer or skips to the newest
+    bool lossless;
+    /// Whether the consumer is registered and active
+    atomic_bool enabled;
+    /// Queue of the buffer indexes to process (lossless consumers)
+    uint32_t *queue;
+    /// Number of buffers read from the queue by the consumer
+    atomic_uint queue_head;
+    /// Number of buffers added to the queue by the producer
+    atomic_uint queue_tail;
+    /// Index of the newest buffer to process (lossy consumers), or
+    /// RL_PIPELINE_BUFFER_NONE
+    atomic_uint latest;
+    /// Number of buffers not processed by the consumer
+    atomic_uint dropped;
+    /// Consumer thread
+    pthread_t thread;
+    /// Whether the consumer thread was started
+    bool thread_started;
+};
+
+/**
+ * Typedef for the pipeline consumer.
+ */
+typedef struct rl_pipeline_consumer rl_pipeline_consumer_t;
+
+/**
+ * Single producer, multiple consumer data processing pipeline.
+ *
+ * The producer publishes calibrated data buffers from a reference counted
+ * buffer pool to the registered consumers, each processing them independently
+ * in its own thread without locks on the data path. A buffer is reused once
+ * all consumers it was published to processed or skipped it.
+ *
+ * A lossless consumer falling behind by its full queue length drops the new
+ * buffers, without affecting the other consumers. The pool reserves buffers
+ * for the lossy consumers to always receive the newest data, and the producer
+ * never blocks.
+ */
+struct rl_pipeline {
+    /// The buffer pool
+    rl_pipeline_buffer_t *buffers;
+    /// Number of consumers still using each buffer of the pool
+    atomic_uint *references;
+    /// Number of buffers in the pool
+    uint32_t buffer_count;
+    /// Maximum number of buffers queued for a lossless consumer
+    uint32_t queue_length;
+    /// Index of the buffer acquired by the producer
+    uint32_t acquired;
+    /// Number of buffers published by the producer
+    atomic_uint write_sequence;
+    /// Whether the consumer threads are running
+    atomic_bool running;
+    /// Whether a consumer failed processing data
+    atomic_bool error;
+    /// Mutex protecting the consumer wake up condition
+    pthread_mutex_t mutex;
+    /// Condition signaling newly published buffers to the consumers
+    pthread_cond_t ready;
+    /// The pipeline consumers
+    rl_pipeline_consumer_t consumer[RL_PIPELINE_CONSUMER_COUNT];
+};
+
+/**
+ * Get the maximum number of buffers queued for a lossless pipeline consumer
+ * for a measurement configuration.
+ *
+ * @param config Current measurement configuration
+ * @return Maximum number of buffers queued for a lossless consumer
+ */
+uint32_t rl_pipeline_get_buffer_count(rl_config_t const *const config);
+
+/**
+ * Initialize the processing pipeline and allocate its buffer pool.
+ *
+ * @param pipeline The pipeline to initialize
+ * @param buffer_count Maximum number of buffers queued for a lossless
+ * consumer, the pool additionally holds RL_PIPELINE_BUFFER_RESERVE buffers
+ * @param buffer_length Maximum number of samples per buffer
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_pipeline_init(rl_pipeline_t *const pipeline, uint32_t buffer_count,
+                     size_t buffer_length);
+
+/**
+ * Deinitialize the processing pipeline and free its buffer pool.
+ *
+ * @param pipeline The pipeline to deinitialize
+ */
+void rl_pipeline_deinit(rl_pipeline_t *const pipeline);
+
+/**
+ * Register a data consumer with the pipeline.
+ *
+ * @param pipeline The pipeline to register the consumer with
+ * @param id The consumer identifier
+ * @param handler The data handler called for each buffer
+ * @param context Handler specific context passed to the handler
+ * @param lossless Process every buffer if true, skip to newest otherwise
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_pipeline_add_consumer(rl_pipeline_t *const pipeline,
+                             rl_pipeline_consumer_id_t id,
+                             rl_pipeline_handler_t handler, void *const context,
+                             bool lossless);
+
+/**
+ * Start the consumer threads of the pipeline.
+ *
+ * @param pipeline The pipeline to start
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_pipeline_start(rl_pipeline_t *const pipeline);
+
+/**
+ * Stop the pipeline after all consumers processed the published buffers.
+ *
+ * @param pipeline The pipeline to stop
+ * @return Returns 0 on success, negative if a consumer failed processing data
+ */
+int rl_pipeline_stop(rl_pipeline_t *const pipeline);
+
+/**
+ * Acquire a free buffer of the pool to be filled by the producer.
+ *
+ * Only fails if multiple lossless consumers hold all buffers of the pool, the
+ * data is then dropped and accounted to all active consumers.
+ *
+ * @param pipeline The pipeline to acquire the buffer from
+ * @return Pointer to the buffer to fill, NULL if no buffer is free
+ */
+rl_pipeline_buffer_t *rl_pipeline_acquire(rl_pipeline_t *const pipeline);
+
+/**
+ * Publish the previously acquired buffer to all consumers.
+ *
+ * Lossless consumers with a full queue drop the buffer, lossy consumers drop
+ * the buffer they did not start processing yet.
+ *
+ * @param pipeline The pipeline to publish the buffer to
+ */
+void rl_pipeline_publish(rl_pipeline_t *const pipeline);
+
+/**
+ * Check whether any consumer failed processing data.
+ *
+ * @param pipeline The pipeline to check
+ * @return Returns true if a consumer failed, false otherwise
+ */
+bool rl_pipeline_has_error(rl_pipeline_t *const pipeline);
+
+/**
+ * Update the pipeline consumer backlog and drop counters of the status.
+ *
+ * @param pipeline The pipeline to get the consumer state from
+ * @param status The status to update
+ */
+void rl_pipeline_update_status(rl_pipeline_t *const pipeline,
+                               rl_status_t *const status);
+
+#endif /* RL_PIPELINE_H_ */
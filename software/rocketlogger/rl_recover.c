@@ -0,0 +1,732 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "log.h"
+#include "rl.h"
+#include "rl_crc.h"
+#include "rl_file.h"
+#include "util.h"
+
+#include "rl_recover.h"
+
+/// Number of nanoseconds per second
+#define RL_RECOVER_NANOSECONDS 1000000000LL
+
+/**
+ * Buffered sequential reader of a data file.
+ */
+struct rl_recover_reader {
+    /// File descriptor of the data file
+    int fd;
+    /// Size of the data file in bytes
+    uint64_t file_size;
+    /// Read buffer
+    uint8_t *buffer;
+    /// Size of the read buffer in bytes
+    size_t buffer_size;
+    /// File offset of the buffered data
+    uint64_t buffer_offset;
+    /// Number of buffered bytes
+    size_t buffer_length;
+};
+
+/**
+ * Typedef for a buffered data file reader.
+ */
+typedef struct rl_recover_reader rl_recover_reader_t;
+
+/**
+ * Data block verification result.
+ */
+enum rl_recover_block {
+    RL_RECOVER_BLOCK_VALID,   //!< Valid data block
+    RL_RECOVER_BLOCK_EMPTY,   //!< Zero filled, never written data block
+    RL_RECOVER_BLOCK_DAMAGED, //!< Damaged or partially written data block
+};
+
+/**
+ * Typedef for data block verification result.
+ */
+typedef enum rl_recover_block rl_recover_block_t;
+
+/**
+ * Get a range of the data file from the read buffer, reading ahead the buffer
+ * size if not buffered yet.
+ *
+ * @param reader The data file reader
+ * @param offset File offset of the data to get
+ * @param length Number of bytes to get, within the file size
+ * @return Pointer to the buffered data, NULL on failure with errno set
+ */
+static uint8_t const *rl_recover_read(rl_recover_reader_t *const reader,
+                                      uint64_t offset, size_t length);
+
+/**
+ * Check whether a data block's timestamps are plausible.
+ *
+ * @param timestamps The realtime and monotonic timestamp of the data block
+ * @return true if plausible, false otherwise
+ */
+static bool rl_recover_timestamps_valid(uint8_t const *const timestamps);
+
+/**
+ * Verify a data block.
+ *
+ * @param block The data block, including checksum if enabled
+ * @param length Size of the data block in bytes
+ * @param timestamp_offset Offset of the data block timestamps in bytes
+ * @param checksum Whether the data block ends with a CRC-32C checksum
+ * @return The data block verification result
+ */
+static rl_recover_block_t rl_recover_check_block(uint8_t const *const block,
+                                                 size_t length,
+                                                 size_t timestamp_offset,
+                                                 bool checksum);
+
+/**
+ * Check whether a data range contains only zeros.
+ *
+ * @param data The data to check
+ * @param length Size of the data in bytes
+ * @return true if all zero, false otherwise
+ */
+static bool rl_recover_is_zero(uint8_t const *const data, size_t length);
+
+/**
+ * Add a range of damaged data blocks to a recovery report.
+ *
+ * @param report The recovery report to update
+ * @param block_index Index of the first damaged data block
+ * @param block_count Number of damaged data blocks
+ * @param block_size Number of samples per data block
+ * @param start_time Estimated start time of the first damaged data block
+ * @param truncated Whether the damaged data blocks are truncated
+ */
+static void rl_recover_add_range(rl_recover_report_t *const report,
+                                 uint64_t block_index, uint64_t block_count,
+                                 uint32_t block_size,
+                                 rl_timestamp_t const *const start_time,
+                                 bool truncated);
+
+/**
+ * Estimate the start time of a data block from a reference data block.
+ *
+ * @param start_time The estimated start time to write
+ * @param reference Start time of the reference data block
+ * @param block_offset Number of data blocks after the reference data block
+ * @param block_duration Duration of a data block in nanoseconds
+ */
+static void rl_recover_estimate_time(rl_timestamp_t *const start_time,
+                                     rl_timestamp_t const *const reference,
+                                     uint64_t block_offset,
+                                     uint64_t block_duration);
+
+/**
+ * Truncate the data block index file to the recovered data blocks.
+ *
+ * @param index_file_name The data block index file
+ * @param lead_in The lead-in of the recovered data file
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int rl_recover_index_file(char const *const index_file_name,
+                                 rl_file_lead_in_t const *const lead_in);
+
+/**
+ * Print a line of the recovery report.
+ *
+ * @param description Line description
+ * @param format Format string of the line value
+ * @param ... Arguments of the format string
+ */
+static void rl_recover_print_line(char const *const description,
+                                  char const *format, ...);
+
+int rl_recover_file(char const *const file_name,
+                    char const *const index_file_name,
+                    rl_recover_report_t *const report) {
+    memset(report, 0, sizeof(rl_recover_report_t));
+
+    int fd = open(file_name, O_RDWR);
+    if (fd < 0) {
+        rl_log(RL_LOG_ERROR, "failed opening data file; %d message: %s", errno,
+               strerror(errno));
+        return ERROR;
+    }
+
+    struct stat file_stat;
+    rl_file_lead_in_t lead_in;
+    if (fstat(fd, &file_stat) < 0) {
+        rl_log(RL_LOG_ERROR, "failed getting data file size; %d message: %s",
+               errno, strerror(errno));
+        close(fd);
+        return ERROR;
+    }
+    if (pread(fd, &lead_in, sizeof(lead_in), 0) != sizeof(lead_in) ||
+        lead_in.file_magic != RL_FILE_MAGIC) {
+        rl_log(RL_LOG_ERROR, "not a RocketLogger data file.");
+        close(fd);
+        errno = EINVAL;
+        return ERROR;
+    }
+
+    uint16_t const file_version = lead_in.file_version & RL_FILE_VERSION_MASK;
+    bool const checksum = (lead_in.file_version & RL_FILE_VERSION_FLAG_CRC);
+    bool const compressed = (file_version == RL_FILE_VERSION_COMPRESSED);
+    uint64_t const channel_offset =
+        sizeof(rl_file_lead_in_t) + lead_in.comment_length;
+    size_t const channel_total =
+        lead_in.channel_bin_count + lead_in.channel_count;
+    if ((file_version != RL_FILE_VERSION &&
+         file_version != RL_FILE_VERSION_COMPRESSED &&
+         file_version != RL_FILE_VERSION_PLANAR) ||
+        lead_in.data_block_size == 0 || lead_in.sample_rate == 0 ||
+        channel_offset + channel_total * sizeof(rl_file_channel_t) >
+            lead_in.header_length ||
+        lead_in.header_length > (uint64_t)file_stat.st_size) {
+        rl_log(RL_LOG_ERROR, "unsupported or invalid data file header.");
+        close(fd);
+        errno = EINVAL;
+        return ERROR;
+    }
+
+    // row size from the analog channel data sizes
+    rl_file_channel_t *channel =
+        malloc(channel_total * sizeof(rl_file_channel_t));
+    if (channel == NULL) {
+        close(fd);
+        return ERROR;
+    }
+    ssize_t const channel_bytes = channel_total * sizeof(rl_file_channel_t);
+    if (pread(fd, channel, channel_bytes, channel_offset) != channel_bytes) {
+        rl_log(RL_LOG_ERROR, "failed reading channel definitions.");
+        free(channel);
+        close(fd);
+        errno = EINVAL;
+        return ERROR;
+    }
+    size_t row_bytes =
+        sizeof(uint32_t) * ((lead_in.channel_bin_count + 31) / 32);
+    for (size_t i = lead_in.channel_bin_count; i < channel_total; i++) {
+        row_bytes += channel[i].data_size;
+    }
+    free(channel);
+
+    size_t const checksum_bytes = checksum ? sizeof(uint32_t) : 0;
+    size_t const timestamp_offset = compressed ? sizeof(uint32_t) : 0;
+    size_t const block_bytes_min =
+        timestamp_offset + 2 * sizeof(rl_timestamp_t) + checksum_bytes;
+    size_t block_bytes_max = block_bytes_min +
+                             (size_t)lead_in.data_block_size * row_bytes;
+    if (compressed) {
+        block_bytes_max =
+            rl_file_get_data_block_bytes_max(lead_in.data_block_size);
+    }
+
+    // the last data block of a finished file holds the remaining samples
+    size_t last_block_bytes = 0;
+    if (!compressed && lead_in.data_block_count > 0) {
+        uint64_t const last_sample_count =
+            lead_in.sample_count - (uint64_t)(lead_in.data_block_count - 1) *
+                                       lead_in.data_block_size;
+        if (last_sample_count > 0 &&
+            last_sample_count < lead_in.data_block_size) {
+            last_block_bytes =
+                block_bytes_min + (size_t)last_sample_count * row_bytes;
+        }
+    }
+    uint64_t const block_duration = (uint64_t)lead_in.data_block_size *
+                                    RL_RECOVER_NANOSECONDS /
+                                    lead_in.sample_rate;
+
+    rl_recover_reader_t reader = {
+        .fd = fd,
+        .file_size = (uint64_t)file_stat.st_size,
+        .buffer = NULL,
+        .buffer_size = RL_RECOVER_BUFFER_SIZE,
+        .buffer_offset = 0,
+        .buffer_length = 0,
+    };
+    if (reader.buffer_size < block_bytes_max) {
+        reader.buffer_size = block_bytes_max;
+    }
+    reader.buffer = malloc(reader.buffer_size);
+    if (reader.buffer == NULL) {
+        close(fd);
+        return ERROR;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    report->file_version = lead_in.file_version;
+    report->header_block_count = lead_in.data_block_count;
+    report->header_sample_count = lead_in.sample_count;
+
+    // scan data blocks, keeping track of the open run of invalid blocks
+    uint64_t offset = lead_in.header_length;
+    uint64_t data_end = offset;
+    uint64_t block_index = 0;
+    uint64_t run_start = 0;
+    uint64_t run_nonzero_end = 0;
+    bool run_open = false;
+    bool valid_found = false;
+    rl_timestamp_t valid_time = lead_in.start_time;
+    uint64_t valid_index = 0;
+    rl_file_checkpoint_t checkpoint;
+    bool checkpoint_found = false;
+    bool scan_aborted = false;
+    int res = SUCCESS;
+
+    while (offset < reader.file_size) {
+        // a checkpoint record marks the end of the written data blocks
+        if (offset + sizeof(checkpoint) <= reader.file_size) {
+            uint8_t const *data =
+                rl_recover_read(&reader, offset, sizeof(checkpoint));
+            if (data == NULL) {
+                res = ERROR;
+                break;
+            }
+            memcpy(&checkpoint, data, sizeof(checkpoint));
+            if (checkpoint.checkpoint_magic == RL_FILE_CHECKPOINT_MAGIC &&
+                checkpoint.checkpoint_offset == offset) {
+                checkpoint_found = true;
+                break;
+            }
+        }
+
+        size_t block_bytes = block_bytes_max;
+        if (compressed) {
+            uint32_t size = 0;
+            if (offset + sizeof(size) <= reader.file_size) {
+                uint8_t const *data =
+                    rl_recover_read(&reader, offset, sizeof(size));
+                if (data == NULL) {
+                    res = ERROR;
+                    break;
+                }
+                memcpy(&size, data, sizeof(size));
+            }
+            // without a valid size the following blocks cannot be located
+            if (size < block_bytes_min || size > block_bytes_max ||
+                size % sizeof(uint32_t) != 0) {
+                scan_aborted = true;
+                break;
+            }
+            block_bytes = size;
+        } else if (last_block_bytes > 0 &&
+                   block_index + 1 == lead_in.data_block_count &&
+                   offset + last_block_bytes <= reader.file_size) {
+            // keep a shorter last block matching the header sample count, if
+            // verified by its checksum or if it ends the file
+            uint8_t const *block =
+                rl_recover_read(&reader, offset, last_block_bytes);
+            if (block == NULL) {
+                res = ERROR;
+                break;
+            }
+            if ((checksum || offset + last_block_bytes == reader.file_size) &&
+                rl_recover_check_block(block, last_block_bytes,
+                                       timestamp_offset, checksum) ==
+                    RL_RECOVER_BLOCK_VALID) {
+                block_bytes = last_block_bytes;
+            }
+        }
+        if (offset + block_bytes > reader.file_size) {
+            break;
+        }
+
+        uint8_t const *block = rl_recover_read(&reader, offset, block_bytes);
+        if (block == NULL) {
+            res = ERROR;
+            break;
+        }
+        rl_recover_block_t const state = rl_recover_check_block(
+            block, block_bytes, timestamp_offset, checksum);
+
+        if (state == RL_RECOVER_BLOCK_VALID) {
+            if (run_open) {
+                rl_timestamp_t start_time;
+                rl_recover_estimate_time(&start_time, &valid_time,
+                                         run_start - valid_index,
+                                         block_duration);
+                rl_recover_add_range(report, run_start,
+                                     block_index - run_start,
+                                     lead_in.data_block_size, &start_time,
+                                     false);
+                run_open = false;
+            }
+            memcpy(&valid_time, block + timestamp_offset, sizeof(valid_time));
+            valid_index = block_index;
+            valid_found = true;
+            data_end = offset + block_bytes;
+            report->block_count = block_index + 1;
+            if (checksum) {
+                report->verified_block_count++;
+            }
+        } else {
+            if (!run_open) {
+                run_open = true;
+                run_start = block_index;
+                run_nonzero_end = block_index;
+            }
+            if (state == RL_RECOVER_BLOCK_DAMAGED) {
+                run_nonzero_end = block_index + 1;
+            }
+            // compressed blocks of unknown size cannot be kept in place
+            if (compressed && state == RL_RECOVER_BLOCK_DAMAGED) {
+                scan_aborted = true;
+                break;
+            }
+        }
+
+        offset += block_bytes;
+        block_index++;
+    }
+
+    if (res == SUCCESS && !checkpoint_found && offset < reader.file_size) {
+        // partially written block at the end of the file
+        uint64_t const length = reader.file_size - offset;
+        bool partial = true;
+        if (!scan_aborted && length <= block_bytes_max) {
+            uint8_t const *data = rl_recover_read(&reader, offset, length);
+            if (data == NULL) {
+                res = ERROR;
+            } else {
+                partial = !rl_recover_is_zero(data, length);
+            }
+        }
+        if (partial) {
+            if (!run_open) {
+                run_open = true;
+                run_start = block_index;
+            }
+            if (run_nonzero_end <= block_index) {
+                run_nonzero_end = block_index + 1;
+            }
+        }
+    }
+
+    free(reader.buffer);
+    if (res < 0) {
+        rl_log(RL_LOG_ERROR, "failed reading data file; %d message: %s",
+               errno, strerror(errno));
+        close(fd);
+        return ERROR;
+    }
+
+    // trailing damaged blocks are truncated with the file
+    if (run_open && run_nonzero_end > run_start) {
+        rl_timestamp_t start_time;
+        rl_recover_estimate_time(&start_time, &valid_time,
+                                 valid_found ? run_start - valid_index
+                                             : run_start,
+                                 block_duration);
+        rl_recover_add_range(report, run_start, run_nonzero_end - run_start,
+                             lead_in.data_block_size, &start_time, true);
+    }
+
+    // recovered sample count, the last block might be partially filled
+    uint64_t const block_count = report->block_count;
+    uint64_t sample_count = block_count * lead_in.data_block_size;
+    if (block_count == lead_in.data_block_count &&
+        lead_in.sample_count <= sample_count &&
+        lead_in.sample_count + lead_in.data_block_size > sample_count) {
+        sample_count = lead_in.sample_count;
+    } else if (checkpoint_found && checkpoint.data_block_count == block_count &&
+               checkpoint.sample_count <= sample_count &&
+               checkpoint.sample_count + lead_in.data_block_size >
+                   sample_count) {
+        sample_count = checkpoint.sample_count;
+    }
+    report->sample_count = sample_count;
+    report->truncated_bytes = reader.file_size - data_end;
+
+    // update header and truncate file only if needed
+    if (lead_in.data_block_count != block_count ||
+        lead_in.sample_count != sample_count ||
+        reader.file_size != data_end) {
+        lead_in.data_block_count = block_count;
+        lead_in.sample_count = sample_count;
+        if (pwrite(fd, &lead_in, sizeof(lead_in), 0) != sizeof(lead_in) ||
+            ftruncate(fd, data_end) < 0 || fsync(fd) < 0) {
+            rl_log(RL_LOG_ERROR, "failed repairing data file; %d message: %s",
+                   errno, strerror(errno));
+            close(fd);
+            return ERROR;
+        }
+        report->repaired = true;
+    }
+    close(fd);
+
+    if (index_file_name != NULL) {
+        return rl_recover_index_file(index_file_name, &lead_in);
+    }
+    return SUCCESS;
+}
+
+void rl_recover_print(rl_recover_report_t const *const report) {
+    rl_recover_print_line("File version", "%u%s",
+                          report->file_version & RL_FILE_VERSION_MASK,
+                          (report->file_version & RL_FILE_VERSION_FLAG_CRC)
+                              ? " with block checksums"
+                              : "");
+    rl_recover_print_line("Data blocks", "%u (header: %u)",
+                          report->block_count, report->header_block_count);
+    rl_recover_print_line("Samples", "%llu (header: %llu)",
+                          report->sample_count, report->header_sample_count);
+    if (report->file_version & RL_FILE_VERSION_FLAG_CRC) {
+        rl_recover_print_line("Verified blocks", "%llu",
+                              report->verified_block_count);
+    }
+    rl_recover_print_line("Damaged blocks", "%llu",
+                          report->damaged_block_count);
+    for (size_t i = 0; i < report->range_count; i++) {
+        if (i == RL_RECOVER_RANGE_COUNT_MAX) {
+            rl_recover_print_line("", "%zu more ranges",
+                                  report->range_count - i);
+            break;
+        }
+        rl_recover_range_t const *const range = &report->range[i];
+        rl_recover_print_line(
+            "", "blocks %llu-%llu, samples %llu-%llu, from %lld.%09lld (%s)",
+            range->block_index, range->block_index + range->block_count - 1,
+            range->sample_index, range->sample_index + range->sample_count - 1,
+            range->start_time.sec, range->start_time.nsec,
+            range->truncated ? "truncated" : "kept");
+    }
+    rl_recover_print_line("Truncated", "%llu Bytes", report->truncated_bytes);
+    rl_recover_print_line("File", report->repaired ? "repaired" : "unchanged");
+}
+
+void rl_recover_print_json(rl_recover_report_t const *const report) {
+    printf("{ \"file_version\": %u, ",
+           report->file_version & RL_FILE_VERSION_MASK);
+    printf("\"checksum\": %s, ",
+           (report->file_version & RL_FILE_VERSION_FLAG_CRC) ? "true"
+                                                             : "false");
+    printf("\"header_block_count\": %u, ", report->header_block_count);
+    printf("\"header_sample_count\": %llu, ", report->header_sample_count);
+    printf("\"block_count\": %u, ", report->block_count);
+    printf("\"sample_count\": %llu, ", report->sample_count);
+    printf("\"verified_block_count\": %llu, ", report->verified_block_count);
+    printf("\"damaged_block_count\": %llu, ", report->damaged_block_count);
+    printf("\"truncated_bytes\": %llu, ", report->truncated_bytes);
+    printf("\"repaired\": %s, ", report->repaired ? "true" : "false");
+    printf("\"range_count\": %zu, ", report->range_count);
+    printf("\"ranges\": [");
+    for (size_t i = 0;
+         i < report->range_count && i < RL_RECOVER_RANGE_COUNT_MAX; i++) {
+        rl_recover_range_t const *const range = &report->range[i];
+        printf("%s{ \"block_index\": %llu, \"block_count\": %llu, "
+               "\"sample_index\": %llu, \"sample_count\": %llu, "
+               "\"start_time\": %lld.%09lld, \"truncated\": %s }",
+               i > 0 ? ", " : "", range->block_index, range->block_count,
+               range->sample_index, range->sample_count, range->start_time.sec,
+               range->start_time.nsec, range->truncated ? "true" : "false");
+    }
+    printf("] }\n");
+}
+
+static uint8_t const *rl_recover_read(rl_recover_reader_t *const reader,
+                                      uint64_t offset, size_t length) {
+    if (offset >= reader->buffer_offset &&
+        offset + length <= reader->buffer_offset + reader->buffer_length) {
+        return reader->buffer + (offset - reader->buffer_offset);
+    }
+
+    size_t read_length = reader->buffer_size;
+    if (offset + read_length > reader->file_size) {
+        read_length = reader->file_size - offset;
+    }
+    size_t count = 0;
+    while (count < read_length) {
+        ssize_t res = pread(reader->fd, reader->buffer + count,
+                            read_length - count, offset + count);
+        if (res < 0 && errno == EINTR) {
+            continue;
+        }
+        if (res <= 0) {
+            if (res == 0) {
+                errno = EIO;
+            }
+            reader->buffer_length = 0;
+            return NULL;
+        }
+        count += res;
+    }
+    reader->buffer_offset = offset;
+    reader->buffer_length = read_length;
+    return reader->buffer;
+}
+
+static bool rl_recover_timestamps_valid(uint8_t const *const timestamps) {
+    rl_timestamp_t realtime;
+    rl_timestamp_t monotonic;
+    memcpy(&realtime, timestamps, sizeof(realtime));
+    memcpy(&monotonic, timestamps + sizeof(realtime), sizeof(monotonic));
+
+    if (realtime.sec <= 0 || realtime.nsec < 0 ||
+        realtime.nsec >= RL_RECOVER_NANOSECONDS) {
+        return false;
+    }
+    if (monotonic.sec < 0 || monotonic.nsec < 0 ||
+        monotonic.nsec >= RL_RECOVER_NANOSECONDS) {
+        return false;
+    }
+    return (monotonic.sec > 0 || monotonic.nsec > 0);
+}
+
+static rl_recover_block_t rl_recover_check_block(uint8_t const *const block,
+                                                 size_t length,
+                                                 size_t timestamp_offset,
+                                                 bool checksum) {
+    bool valid;
+    if (checksum) {
+        uint32_t crc;
+        memcpy(&crc, block + length - sizeof(crc), sizeof(crc));
+        valid = (rl_crc32c(RL_CRC32C_INIT, block, length - sizeof(crc)) == crc);
+    } else {
+        valid = rl_recover_timestamps_valid(block + timestamp_offset);
+    }
+
+    if (valid) {
+        return RL_RECOVER_BLOCK_VALID;
+    }
+    if (rl_recover_is_zero(block, length)) {
+        return RL_RECOVER_BLOCK_EMPTY;
+    }
+    return RL_RECOVER_BLOCK_DAMAGED;
+}
+
+static bool rl_recover_is_zero(uint8_t const *const data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (data[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void rl_recover_add_range(rl_recover_report_t *const report,
+                                 uint64_t block_index, uint64_t block_count,
+                                 uint32_t block_size,
+                                 rl_timestamp_t const *const start_time,
+                                 bool truncated) {
+    if (report->range_count < RL_RECOVER_RANGE_COUNT_MAX) {
+        rl_recover_range_t *const range = &report->range[report->range_count];
+        range->block_index = block_index;
+        range->block_count = block_count;
+        range->sample_index = block_index * block_size;
+        range->sample_count = block_count * block_size;
+        range->start_time = *start_time;
+        range->truncated = truncated;
+    }
+    report->range_count++;
+    report->damaged_block_count += block_count;
+}
+
+static void rl_recover_estimate_time(rl_timestamp_t *const start_time,
+                                     rl_timestamp_t const *const reference,
+                                     uint64_t block_offset,
+                                     uint64_t block_duration) {
+    uint64_t const duration = block_offset * block_duration;
+    int64_t nsec = reference->nsec + (int64_t)(duration %
+                                               RL_RECOVER_NANOSECONDS);
+    start_time->sec = reference->sec +
+                      (int64_t)(duration / RL_RECOVER_NANOSECONDS) +
+                      nsec / RL_RECOVER_NANOSECONDS;
+    start_time->nsec = nsec % RL_RECOVER_NANOSECONDS;
+}
+
+static int rl_recover_index_file(char const *const index_file_name,
+                                 rl_file_lead_in_t const *const lead_in) {
+    int fd = open(index_file_name, O_RDWR);
+    if (fd < 0) {
+        // index file is optional
+        return SUCCESS;
+    }
+
+    struct stat file_stat;
+    rl_file_index_header_t index_header;
+    if (fstat(fd, &file_stat) < 0 ||
+        pread(fd, &index_header, sizeof(index_header), 0) !=
+            sizeof(index_header) ||
+        index_header.index_magic != RL_FILE_INDEX_MAGIC ||
+        index_header.record_length == 0 ||
+        index_header.start_time.sec != lead_in->start_time.sec ||
+        index_header.start_time.nsec != lead_in->start_time.nsec) {
+        rl_log(RL_LOG_WARNING, "ignoring invalid or mismatching index file.");
+        close(fd);
+        return SUCCESS;
+    }
+
+    // drop records of truncated and partially indexed data blocks
+    uint64_t const record_count =
+        ((uint64_t)file_stat.st_size - sizeof(index_header)) /
+        index_header.record_length;
+    uint64_t index_size = sizeof(index_header) +
+                          record_count * index_header.record_length;
+    if (record_count > lead_in->data_block_count) {
+        index_size = sizeof(index_header) +
+                     (uint64_t)lead_in->data_block_count *
+                         index_header.record_length;
+    }
+    if (index_size != (uint64_t)file_stat.st_size) {
+        if (ftruncate(fd, index_size) < 0 || fsync(fd) < 0) {
+            rl_log(RL_LOG_ERROR,
+                   "failed truncating index file; %d message: %s", errno,
+                   strerror(errno));
+            close(fd);
+            return ERROR;
+        }
+    }
+    close(fd);
+    return SUCCESS;
+}
+
+static void rl_recover_print_line(char const *const description,
+                                  char const *format, ...) {
+    va_list args;
+    va_start(args, format);
+    printf("  %24s - ", description);
+    vprintf(format, args);
+    printf("\n");
+    va_end(args);
+}
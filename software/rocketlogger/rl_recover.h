@@ -0,0 +1,140 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RL_RECOVER_H_
+#define RL_RECOVER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rl_file.h"
+#include "util.h"
+
+/// Size of the buffer to scan the data blocks of a file in bytes
+#define RL_RECOVER_BUFFER_SIZE (8 * 1024 * 1024)
+
+/// Maximum number of damaged data block ranges listed in a recovery report
+#define RL_RECOVER_RANGE_COUNT_MAX 32
+
+/**
+ * Range of consecutive damaged data blocks of a data file.
+ */
+struct rl_recover_range {
+    /// Index of the first damaged data block
+    uint64_t block_index;
+    /// Number of damaged data blocks
+    uint64_t block_count;
+    /// Index of the first sample of the damaged data blocks
+    uint64_t sample_index;
+    /// Number of samples of the damaged data blocks
+    uint64_t sample_count;
+    /// Start time of the damaged data blocks, estimated from the last valid
+    /// data block
+    rl_timestamp_t start_time;
+    /// Whether the data blocks were truncated from the file, otherwise they
+    /// are kept to preserve the position of the following data blocks
+    bool truncated;
+};
+
+/**
+ * Typedef for a range of damaged data blocks.
+ */
+typedef struct rl_recover_range rl_recover_range_t;
+
+/**
+ * Report of a data file recovery.
+ */
+struct rl_recover_report {
+    /// File version of the data file
+    uint16_t file_version;
+    /// Data block count stored in the header before the recovery
+    uint32_t header_block_count;
+    /// Sample count stored in the header before the recovery
+    uint64_t header_sample_count;
+    /// Number of data blocks of the recovered file
+    uint32_t block_count;
+    /// Number of samples of the recovered file
+    uint64_t sample_count;
+    /// Number of data blocks verified by their checksum
+    uint64_t verified_block_count;
+    /// Number of damaged data blocks, kept or truncated
+    uint64_t damaged_block_count;
+    /// Number of bytes truncated from the end of the file
+    uint64_t truncated_bytes;
+    /// Whether the file header or size was repaired
+    bool repaired;
+    /// Total number of damaged data block ranges
+    size_t range_count;
+    /// The first RL_RECOVER_RANGE_COUNT_MAX damaged data block ranges
+    rl_recover_range_t range[RL_RECOVER_RANGE_COUNT_MAX];
+};
+
+/**
+ * Typedef for a data file recovery report.
+ */
+typedef struct rl_recover_report rl_recover_report_t;
+
+/**
+ * Recover a damaged or unfinished RLD data file in place.
+ *
+ * Scans all data blocks of the file sequentially, verifying their checksum if
+ * stored (RL_FILE_VERSION_FLAG_CRC), or the plausibility of their timestamps
+ * otherwise. The file is truncated after the last valid data block and the
+ * header is updated with the recovered data block and sample counts. Damaged
+ * data blocks before the last valid one are kept in place for fixed size data
+ * blocks, compressed data blocks are truncated from the first damaged one.
+ * The data block index file is truncated to the recovered data blocks.
+ *
+ * @param file_name The data file to recover
+ * @param index_file_name The data block index file of the data file
+ * @param report The recovery report to write
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_recover_file(char const *const file_name,
+                    char const *const index_file_name,
+                    rl_recover_report_t *const report);
+
+/**
+ * Print a data file recovery report in user readable format.
+ *
+ * @param report The recovery report to print
+ */
+void rl_recover_print(rl_recover_report_t const *const report);
+
+/**
+ * Print a data file recovery report in JSON format.
+ *
+ * @param report The recovery report to print
+ */
+void rl_recover_print_json(rl_recover_report_t const *const report);
+
+#endif /* RL_RECOVER_H_ */
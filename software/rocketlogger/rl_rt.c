@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <malloc.h>
+#include <sched.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "log.h"
+#include "rl.h"
+
+#include "rl_rt.h"
+
+/**
+ * Pre-fault the stack of the calling thread.
+ *
+ * Not inlined so the stack frame is allocated below the caller's.
+ */
+static void __attribute__((noinline)) rl_rt_stack_prefault(void) {
+    volatile uint8_t stack[RL_RT_STACK_PREFAULT_SIZE];
+    memset((uint8_t *)stack, 0, sizeof(stack));
+}
+
+int rl_rt_init(void) {
+    // lock memory pages, new pages are faulted in when mapped
+    int res = mlockall(MCL_CURRENT | MCL_FUTURE);
+    if (res < 0) {
+        rl_log(RL_LOG_ERROR, "failed locking memory; %d message: %s", errno,
+               strerror(errno));
+        return ERROR;
+    }
+
+    // keep freed heap memory mapped and serve allocations from the heap
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+
+    rl_rt_stack_prefault();
+
+    // real-time scheduling of the calling thread
+    struct sched_param param = {.sched_priority = RL_RT_PRIORITY};
+    res = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (res != 0) {
+        errno = res;
+        rl_log(RL_LOG_ERROR,
+               "failed setting real-time scheduling; %d message: %s", errno,
+               strerror(errno));
+        munlockall();
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+void rl_rt_deinit(void) {
+    struct sched_param param = {.sched_priority = 0};
+    pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+    munlockall();
+}
+
+int64_t rl_rt_time_ns(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (int64_t)time.tv_sec * 1000000000LL + time.tv_nsec;
+}
+
+void rl_rt_latency_init(rl_rt_latency_t *const latency, uint32_t update_rate) {
+    latency->period_ns = 1000000000LL / update_rate;
+    latency->count = 0;
+    memset(latency->phase, 0, sizeof(latency->phase));
+}
+
+int64_t rl_rt_latency_update(rl_rt_latency_t *const latency,
+                             uint32_t buffer_index, int64_t wakeup_ns) {
+    int64_t const phase =
+        wakeup_ns - (int64_t)buffer_index * latency->period_ns;
+    latency->phase[latency->count % RL_RT_LATENCY_WINDOW] = phase;
+    latency->count++;
+
+    // earliest wakeup of the window is the latency reference
+    uint32_t const window = (latency->count < RL_RT_LATENCY_WINDOW)
+                                ? latency->count
+                                : RL_RT_LATENCY_WINDOW;
+    int64_t reference = phase;
+    for (uint32_t k = 0; k < window; k++) {
+        if (latency->phase[k] < reference) {
+            reference = latency->phase[k];
+        }
+    }
+
+    return phase - reference;
+}
+
+void rl_rt_histogram_add(uint32_t *const histogram, uint32_t *const max,
+                         int64_t time_ns) {
+    uint32_t time_us = UINT32_MAX;
+    if (time_ns < 0) {
+        time_us = 0;
+    } else if (time_ns / 1000 < UINT32_MAX) {
+        time_us = (uint32_t)(time_ns / 1000);
+    }
+
+    // logarithmic bins: index of the most significant bit
+    int bin = 0;
+    if (time_us >= 2) {
+        bin = 31 - __builtin_clz(time_us);
+    }
+    if (bin >= RL_TIMING_HISTOGRAM_BINS) {
+        bin = RL_TIMING_HISTOGRAM_BINS - 1;
+    }
+
+    histogram[bin]++;
+    if (time_us > *max) {
+        *max = time_us;
+    }
+}
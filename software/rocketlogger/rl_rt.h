@@ -0,0 +1,125 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RL_RT_H_
+#define RL_RT_H_
+
+#include <stdint.h>
+
+#include "rl.h"
+
+/// Real-time scheduling priority of the sampling thread (SCHED_FIFO), below
+/// the default priority of threaded interrupt handlers
+#define RL_RT_PRIORITY 49
+/// Stack size in bytes to pre-fault when applying the real-time profile
+#define RL_RT_STACK_PREFAULT_SIZE (64 * 1024)
+/// Number of buffers considered for the wakeup latency reference
+#define RL_RT_LATENCY_WINDOW 16
+
+/**
+ * Wakeup latency estimator.
+ *
+ * The PRU buffer events are not timestamped, the latency of a wakeup is
+ * therefore estimated relative to the earliest wakeup of the most recent
+ * buffers, after removing the nominal buffer period. This reference tracks
+ * slow clock drift between the ADC and the system clock.
+ */
+struct rl_rt_latency {
+    /// Nominal buffer period in nanoseconds
+    int64_t period_ns;
+    /// Wakeup time minus nominal buffer start of the most recent buffers
+    int64_t phase[RL_RT_LATENCY_WINDOW];
+    /// Number of wakeups processed
+    uint32_t count;
+};
+
+/**
+ * Typedef for the wakeup latency estimator.
+ */
+typedef struct rl_rt_latency rl_rt_latency_t;
+
+/**
+ * Apply the real-time execution profile to the calling thread.
+ *
+ * Locks current and future memory pages, disables returning heap memory to
+ * the system, pre-faults the stack and sets the SCHED_FIFO scheduling policy.
+ * Threads created afterwards inherit the scheduling policy, other processing
+ * threads should therefore be started before.
+ *
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_rt_init(void);
+
+/**
+ * Revert the real-time execution profile of the calling thread.
+ */
+void rl_rt_deinit(void);
+
+/**
+ * Get the current monotonic time.
+ *
+ * @return Monotonic time in nanoseconds
+ */
+int64_t rl_rt_time_ns(void);
+
+/**
+ * Initialize the wakeup latency estimator.
+ *
+ * @param latency The latency estimator to initialize
+ * @param update_rate The buffer update rate in Hz
+ */
+void rl_rt_latency_init(rl_rt_latency_t *const latency, uint32_t update_rate);
+
+/**
+ * Estimate the wakeup latency of a completed buffer.
+ *
+ * @param latency The latency estimator to update
+ * @param buffer_index Index of the buffer the wakeup belongs to
+ * @param wakeup_ns Monotonic wakeup time in nanoseconds
+ * @return The estimated wakeup latency in nanoseconds
+ */
+int64_t rl_rt_latency_update(rl_rt_latency_t *const latency,
+                             uint32_t buffer_index, int64_t wakeup_ns);
+
+/**
+ * Add a time measurement to a timing histogram.
+ *
+ * Bin 0 counts values below 2 us, bin i values in [2^i, 2^(i+1)) us, and the
+ * last bin all larger values.
+ *
+ * @param histogram The histogram of RL_TIMING_HISTOGRAM_BINS bins to update
+ * @param max The maximum value in microseconds to update
+ * @param time_ns The measured time in nanoseconds
+ */
+void rl_rt_histogram_add(uint32_t *const histogram, uint32_t *const max,
+                         int64_t time_ns);
+
+#endif /* RL_RT_H_ */
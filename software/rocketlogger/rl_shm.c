@@ -0,0 +1,337 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/types.h>
+
+#include "log.h"
+#include "rl.h"
+#include "util.h"
+
+#include "rl_shm.h"
+
+/// data shared memory ring of the measurement, NULL if not created
+static rl_shm_header_t *rl_shm = NULL;
+/// data shared memory ID of the measurement
+static int rl_shm_id = -1;
+
+/**
+ * Get the writable ring slot used for the block with a given sequence.
+ *
+ * @param header The data shared memory ring
+ * @param sequence The block sequence
+ * @return Pointer to the block in the ring slot of the sequence
+ */
+static rl_shm_block_t *rl_shm_ring_get_slot(rl_shm_header_t const *const header,
+                                            uint32_t sequence);
+
+/**
+ * Mark a data shared memory segment left by a previous measurement stopped
+ * and remove it.
+ *
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int rl_shm_remove_stale(void);
+
+uint32_t rl_shm_ring_get_block_count(rl_config_t const *const config) {
+    // power of two for consistent ring slots at block sequence wrap around
+    uint32_t block_count = RL_SHM_BLOCK_COUNT_MIN;
+    while (block_count < RL_SHM_BUFFER_TIME * config->update_rate) {
+        block_count *= 2;
+    }
+    return block_count;
+}
+
+size_t rl_shm_ring_get_size(rl_config_t const *const config,
+                            uint32_t block_length, uint32_t block_count) {
+    // block header, enabled analog channels and digital data, 8 byte aligned
+    size_t const values = (count_channels(config->channel_enable) + 1) *
+                          (size_t)block_length;
+    size_t const block_size =
+        (sizeof(rl_shm_block_t) + values * sizeof(int32_t) + 7) & ~(size_t)7;
+
+    return sizeof(rl_shm_header_t) + block_count * block_size;
+}
+
+void rl_shm_ring_init(rl_shm_header_t *const header,
+                      rl_config_t const *const config, uint32_t sample_rate,
+                      uint32_t block_length, uint32_t block_count) {
+    header->version = RL_SHM_VERSION;
+    header->header_size = sizeof(rl_shm_header_t);
+    header->block_count = block_count;
+    header->block_size =
+        (uint32_t)((rl_shm_ring_get_size(config, block_length, block_count) -
+                    sizeof(rl_shm_header_t)) /
+                   block_count);
+    header->block_length = block_length;
+    header->sample_rate = sample_rate;
+    header->update_rate = config->update_rate;
+    header->channel_mask = 0;
+    for (int ch = 0; ch < RL_CHANNEL_COUNT; ch++) {
+        if (config->channel_enable[ch]) {
+            header->channel_mask |= (0x1U << ch);
+        }
+    }
+    header->digital_enable = config->digital_enable;
+
+    // invalidate the blocks of all ring slots
+    for (uint32_t i = 0; i < block_count; i++) {
+        atomic_store_explicit(&rl_shm_ring_get_slot(header, i)->sequence,
+                              RL_SHM_SEQUENCE_INVALID, memory_order_relaxed);
+    }
+    atomic_store_explicit(&header->stopped, 0, memory_order_relaxed);
+    atomic_store_explicit(&header->write_sequence, 0, memory_order_release);
+}
+
+void rl_shm_ring_write(rl_shm_header_t *const header,
+                       int32_t const *analog_buffer,
+                       uint32_t const *digital_buffer, size_t buffer_size,
+                       uint64_t index, uint64_t samples_lost,
+                       rl_timestamp_t const *const timestamp_realtime,
+                       rl_timestamp_t const *const timestamp_monotonic) {
+    uint32_t const sequence =
+        atomic_load_explicit(&header->write_sequence, memory_order_relaxed);
+    rl_shm_block_t *const block = rl_shm_ring_get_slot(header, sequence);
+
+    // invalidate the slot before overwriting the oldest block
+    atomic_store_explicit(&block->sequence, RL_SHM_SEQUENCE_INVALID,
+                          memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    // store at most a block of samples, the channel stride of the buffer
+    // remains its full size
+    size_t sample_count = buffer_size;
+    if (sample_count > header->block_length) {
+        sample_count = header->block_length;
+    }
+    block->sample_count = (uint32_t)sample_count;
+    block->index = index;
+    block->samples_lost = samples_lost;
+    block->timestamp_realtime = *timestamp_realtime;
+    block->timestamp_monotonic = *timestamp_monotonic;
+
+    // stored analog channels from the channel-major buffer and digital data
+    int32_t *channel_data = (int32_t *)(block + 1);
+    for (int ch = 0; ch < RL_CHANNEL_COUNT; ch++) {
+        if ((header->channel_mask & (0x1U << ch)) == 0) {
+            continue;
+        }
+        memcpy(channel_data, analog_buffer + ch * buffer_size,
+               sample_count * sizeof(int32_t));
+        channel_data += header->block_length;
+    }
+    memcpy(channel_data, digital_buffer, sample_count * sizeof(uint32_t));
+
+    // complete the block, then make it available to the readers
+    atomic_store_explicit(&block->sequence, sequence, memory_order_release);
+    atomic_store_explicit(&header->write_sequence, sequence + 1,
+                          memory_order_release);
+}
+
+rl_shm_block_t const *rl_shm_ring_check(rl_shm_header_t const *const header,
+                                        uint32_t *const sequence,
+                                        uint32_t *const lost) {
+    uint32_t const write_sequence = atomic_load_explicit(
+        (atomic_uint *)&header->write_sequence, memory_order_acquire);
+
+    // block not yet written
+    uint32_t const available = write_sequence - *sequence;
+    if (available == 0 || available > UINT32_MAX / 2) {
+        return NULL;
+    }
+
+    // block overwritten, or its slot is the next to be overwritten: skip to
+    // the oldest block not reused by the next write
+    if (available >= header->block_count) {
+        uint32_t const oldest = write_sequence - header->block_count + 1;
+        *lost += oldest - *sequence;
+        *sequence = oldest;
+    }
+
+    return rl_shm_ring_get_slot(header, *sequence);
+}
+
+int rl_shm_ring_validate(rl_shm_block_t const *const block,
+                         uint32_t sequence) {
+    // the writer invalidates the slot before overwriting its data
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit((atomic_uint *)&block->sequence,
+                             memory_order_relaxed) != sequence) {
+        return ERROR;
+    }
+    return SUCCESS;
+}
+
+int32_t const *rl_shm_block_get_channel(rl_shm_header_t const *const header,
+                                        rl_shm_block_t const *const block,
+                                        int channel) {
+    if ((header->channel_mask & (0x1U << channel)) == 0) {
+        return NULL;
+    }
+
+    // channels are stored in order, skipping the ones not stored
+    int offset = 0;
+    for (int ch = 0; ch < channel; ch++) {
+        if (header->channel_mask & (0x1U << ch)) {
+            offset++;
+        }
+    }
+
+    return (int32_t const *)(block + 1) + offset * header->block_length;
+}
+
+uint32_t const *rl_shm_block_get_digital(rl_shm_header_t const *const header,
+                                         rl_shm_block_t const *const block) {
+    int channel_count = 0;
+    for (int ch = 0; ch < RL_CHANNEL_COUNT; ch++) {
+        if (header->channel_mask & (0x1U << ch)) {
+            channel_count++;
+        }
+    }
+
+    return (uint32_t const *)(block + 1) + channel_count * header->block_length;
+}
+
+int rl_shm_init(rl_config_t const *const config, uint32_t sample_rate,
+                uint32_t block_length) {
+    uint32_t const block_count = rl_shm_ring_get_block_count(config);
+    size_t const size = rl_shm_ring_get_size(config, block_length, block_count);
+
+    // create a new segment of the measurement's ring size
+    int shm_id = shmget(RL_SHMEM_DATA_KEY, size,
+                        IPC_CREAT | IPC_EXCL | RL_SHMEM_PERMISSIONS);
+    if (shm_id == -1 && errno == EEXIST) {
+        rl_log(RL_LOG_WARNING, "removing stale shared data memory");
+        if (rl_shm_remove_stale() == SUCCESS) {
+            shm_id = shmget(RL_SHMEM_DATA_KEY, size,
+                            IPC_CREAT | IPC_EXCL | RL_SHMEM_PERMISSIONS);
+        }
+    }
+    if (shm_id == -1) {
+        rl_log(RL_LOG_ERROR,
+               "failed creating shared data memory; %d message: %s", errno,
+               strerror(errno));
+        return ERROR;
+    }
+
+    void *const shm = shmat(shm_id, NULL, 0);
+    if (shm == (void *)-1) {
+        rl_log(RL_LOG_ERROR,
+               "failed mapping shared data memory; %d message: %s", errno,
+               strerror(errno));
+        shmctl(shm_id, IPC_RMID, NULL);
+        return ERROR;
+    }
+
+    rl_shm = (rl_shm_header_t *)shm;
+    rl_shm_id = shm_id;
+    rl_shm_ring_init(rl_shm, config, sample_rate, block_length, block_count);
+    rl_log(RL_LOG_INFO, "using shared data memory ring of %u blocks with %u "
+                        "samples",
+           block_count, block_length);
+
+    return SUCCESS;
+}
+
+int rl_shm_deinit(void) {
+    if (rl_shm == NULL) {
+        return SUCCESS;
+    }
+
+    // readers still attached detect the stop after the last block
+    atomic_store_explicit(&rl_shm->stopped, 1, memory_order_release);
+    shmdt(rl_shm);
+    rl_shm = NULL;
+
+    // mark shared memory for deletion after the last reader detached
+    int res = shmctl(rl_shm_id, IPC_RMID, NULL);
+    rl_shm_id = -1;
+    if (res == -1) {
+        rl_log(RL_LOG_ERROR,
+               "failed removing shared data memory; %d message: %s", errno,
+               strerror(errno));
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+int rl_shm_write(int32_t const *analog_buffer, uint32_t const *digital_buffer,
+                 size_t buffer_size, uint64_t index, uint64_t samples_lost,
+                 rl_timestamp_t const *const timestamp_realtime,
+                 rl_timestamp_t const *const timestamp_monotonic) {
+    if (rl_shm == NULL) {
+        errno = ENODEV;
+        return ERROR;
+    }
+
+    rl_shm_ring_write(rl_shm, analog_buffer, digital_buffer, buffer_size,
+                      index, samples_lost, timestamp_realtime,
+                      timestamp_monotonic);
+
+    return SUCCESS;
+}
+
+static rl_shm_block_t *rl_shm_ring_get_slot(rl_shm_header_t const *const header,
+                                            uint32_t sequence) {
+    uint8_t *const base = (uint8_t *)header + header->header_size;
+    return (rl_shm_block_t *)(base + (size_t)(sequence % header->block_count) *
+                                         header->block_size);
+}
+
+static int rl_shm_remove_stale(void) {
+    int const shm_id = shmget(RL_SHMEM_DATA_KEY, 0, RL_SHMEM_PERMISSIONS);
+    if (shm_id == -1) {
+        return ERROR;
+    }
+
+    // readers of the previous measurement detect it stopped
+    void *const shm = shmat(shm_id, NULL, 0);
+    if (shm != (void *)-1) {
+        rl_shm_header_t *const header = (rl_shm_header_t *)shm;
+        atomic_store_explicit(&header->stopped, 1, memory_order_release);
+        shmdt(shm);
+    }
+
+    if (shmctl(shm_id, IPC_RMID, NULL) == -1) {
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
@@ -0,0 +1,259 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef RL_SHM_H_
+#define RL_SHM_H_
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rl.h"
+#include "util.h"
+
+/// Data shared memory ring layout version
+#define RL_SHM_VERSION 1
+/// Block sequence marking a ring slot currently being written
+#define RL_SHM_SEQUENCE_INVALID UINT32_MAX
+/// Minimum number of blocks in the data shared memory ring (power of two)
+#define RL_SHM_BLOCK_COUNT_MIN 4
+/// Time span of the data kept in the shared memory ring in seconds
+#define RL_SHM_BUFFER_TIME 2
+
+/**
+ * Data shared memory ring header, at the start of the shared memory.
+ *
+ * The header is followed by the ring of block_count blocks of block_size
+ * bytes each. Blocks are written to the ring slots in order, i.e. the block
+ * with sequence s is stored in ring slot (s % block_count). The ring layout
+ * is fixed for a measurement, a new shared memory segment is created for each
+ * measurement.
+ */
+struct rl_shm_header {
+    /// Data shared memory ring layout version
+    uint16_t version;
+    /// Size of the header in bytes, offset of the first ring slot
+    uint16_t header_size;
+    /// Number of blocks in the ring
+    uint32_t block_count;
+    /// Size of a ring slot in bytes (including block header)
+    uint32_t block_size;
+    /// Maximum number of samples per block
+    uint32_t block_length;
+    /// Sample rate of the data in the ring (native rate before aggregation)
+    uint32_t sample_rate;
+    /// Number of blocks written per second
+    uint32_t update_rate;
+    /// Analog channels stored in the blocks, bit i for channel i
+    uint32_t channel_mask;
+    /// Whether the digital inputs are enabled
+    uint32_t digital_enable;
+    /// Number of blocks written, sequence of the next block to write
+    atomic_uint write_sequence;
+    /// Non-zero after the measurement stopped, no more blocks are written
+    atomic_uint stopped;
+};
+
+/**
+ * Type definition for data shared memory ring header.
+ */
+typedef struct rl_shm_header rl_shm_header_t;
+
+/**
+ * Data shared memory block header, at the start of each ring slot.
+ *
+ * The header is followed by the calibrated samples of each stored analog
+ * channel (block_length int32 values each, in channel order) and the digital
+ * samples (block_length uint32 values), in the same units and bit layout as
+ * the RLD data files.
+ */
+struct rl_shm_block {
+    /// Block sequence, RL_SHM_SEQUENCE_INVALID while the block is written
+    atomic_uint sequence;
+    /// Number of valid samples in the block
+    uint32_t sample_count;
+    /// Index of the sampled buffer, including buffers lost by overruns
+    uint64_t index;
+    /// Total number of samples lost by sampling overruns
+    uint64_t samples_lost;
+    /// Timestamp of the first sample from realtime clock
+    rl_timestamp_t timestamp_realtime;
+    /// Timestamp of the first sample from monotonic clock
+    rl_timestamp_t timestamp_monotonic;
+};
+
+/**
+ * Type definition for data shared memory block header.
+ */
+typedef struct rl_shm_block rl_shm_block_t;
+
+/**
+ * Get the number of blocks of the data shared memory ring for a measurement,
+ * a power of two holding at least RL_SHM_BUFFER_TIME seconds of data.
+ *
+ * @param config Configuration of the measurement
+ * @return Number of blocks in the ring
+ */
+uint32_t rl_shm_ring_get_block_count(rl_config_t const *const config);
+
+/**
+ * Get the size of the data shared memory ring.
+ *
+ * @param config Configuration of the measurement
+ * @param block_length Maximum number of samples per block
+ * @param block_count Number of blocks in the ring
+ * @return Size of the ring in bytes, including the header
+ */
+size_t rl_shm_ring_get_size(rl_config_t const *const config,
+                            uint32_t block_length, uint32_t block_count);
+
+/**
+ * Initialize the data shared memory ring layout and invalidate all blocks.
+ *
+ * @param header The memory of rl_shm_ring_get_size() bytes to initialize
+ * @param config Configuration of the measurement
+ * @param sample_rate Sample rate of the data written to the ring
+ * @param block_length Maximum number of samples per block
+ * @param block_count Number of blocks in the ring
+ */
+void rl_shm_ring_init(rl_shm_header_t *const header,
+                      rl_config_t const *const config, uint32_t sample_rate,
+                      uint32_t block_length, uint32_t block_count);
+
+/**
+ * Write the next block to the data shared memory ring, overwriting the oldest
+ * block without waiting for readers.
+ *
+ * @param header The data shared memory ring
+ * @param analog_buffer Calibrated analog data buffer (channel-major)
+ * @param digital_buffer Digital data buffer
+ * @param buffer_size Number of samples in the buffers
+ * @param index Index of the sampled buffer
+ * @param samples_lost Total number of samples lost by sampling overruns
+ * @param timestamp_realtime Timestamp sampled from realtime clock
+ * @param timestamp_monotonic Timestamp sampled from monotonic clock
+ */
+void rl_shm_ring_write(rl_shm_header_t *const header,
+                       int32_t const *analog_buffer,
+                       uint32_t const *digital_buffer, size_t buffer_size,
+                       uint64_t index, uint64_t samples_lost,
+                       rl_timestamp_t const *const timestamp_realtime,
+                       rl_timestamp_t const *const timestamp_monotonic);
+
+/**
+ * Check whether the block with a given sequence is available.
+ *
+ * If the block was already overwritten or is being overwritten, the sequence
+ * is advanced to the oldest block still available in the ring and the number
+ * of skipped blocks is added to the lost block counter.
+ *
+ * @param header The data shared memory ring
+ * @param sequence Pointer to the sequence of the block to check, updated on
+ * overrun
+ * @param lost Pointer to the lost block counter, updated on overrun
+ * @return Pointer to the block, NULL if not yet written
+ */
+rl_shm_block_t const *rl_shm_ring_check(rl_shm_header_t const *const header,
+                                        uint32_t *const sequence,
+                                        uint32_t *const lost);
+
+/**
+ * Validate a block was not overwritten while reading its data.
+ *
+ * To be called after the block data was processed, to detect overwrites by
+ * the writer during processing.
+ *
+ * @param block The processed block
+ * @param sequence The sequence of the processed block
+ * @return Returns 0 if the block is still valid, negative if overwritten
+ */
+int rl_shm_ring_validate(rl_shm_block_t const *const block, uint32_t sequence);
+
+/**
+ * Get the samples of an analog channel of a block.
+ *
+ * @param header The data shared memory ring
+ * @param block The block
+ * @param channel Index of the analog channel
+ * @return Pointer to the channel samples, NULL if the channel is not stored
+ */
+int32_t const *rl_shm_block_get_channel(rl_shm_header_t const *const header,
+                                        rl_shm_block_t const *const block,
+                                        int channel);
+
+/**
+ * Get the digital samples of a block.
+ *
+ * @param header The data shared memory ring
+ * @param block The block
+ * @return Pointer to the digital samples
+ */
+uint32_t const *rl_shm_block_get_digital(rl_shm_header_t const *const header,
+                                         rl_shm_block_t const *const block);
+
+/**
+ * Create the data shared memory ring of a measurement.
+ *
+ * @param config Configuration of the measurement
+ * @param sample_rate Sample rate of the data written to the ring
+ * @param block_length Maximum number of samples per block
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_shm_init(rl_config_t const *const config, uint32_t sample_rate,
+                uint32_t block_length);
+
+/**
+ * Mark the data shared memory ring stopped and remove it. Attached readers
+ * keep access until they detach.
+ *
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_shm_deinit(void);
+
+/**
+ * Write the next block to the data shared memory ring of the measurement.
+ *
+ * @param analog_buffer Calibrated analog data buffer (channel-major)
+ * @param digital_buffer Digital data buffer
+ * @param buffer_size Number of samples in the buffers
+ * @param index Index of the sampled buffer
+ * @param samples_lost Total number of samples lost by sampling overruns
+ * @param timestamp_realtime Timestamp sampled from realtime clock
+ * @param timestamp_monotonic Timestamp sampled from monotonic clock
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_shm_write(int32_t const *analog_buffer, uint32_t const *digital_buffer,
+                 size_t buffer_size, uint64_t index, uint64_t samples_lost,
+                 rl_timestamp_t const *const timestamp_realtime,
+                 rl_timestamp_t const *const timestamp_monotonic);
+
+#endif /* RL_SHM_H_ */
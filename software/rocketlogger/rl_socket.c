@@ -30,21 +30,116 @@
  */
 
 #include <errno.h>
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <zmq.h>
 
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "log.h"
 #include "rl.h"
+#include "rl_crc.h"
 #include "rl_file.h"
 #include "sensor/sensor.h"
 #include "util.h"
 
 #include "rl_socket.h"
 
-#define RL_SOCKET_METADATA_SIZE 1000
+#define RL_SOCKET_METADATA_SIZE 3000
+
+/// Number of data message buffers shared with ZeroMQ
+#define RL_SOCKET_MESSAGE_POOL_SIZE 8
+
+/// Maximum number of queued data messages per subscriber
+#define RL_SOCKET_SEND_HWM (RL_SOCKET_MESSAGE_POOL_SIZE / 2)
+
+/// Maximum number of frames of a data message
+#define RL_SOCKET_FRAME_COUNT_MAX (3 + RL_CHANNEL_COUNT + SENSOR_REGISTRY_SIZE)
+
+/// Number of published resolution levels
+#define RL_SOCKET_LEVEL_COUNT 4
+
+/// Number of published channel groups
+#define RL_SOCKET_GROUP_COUNT 5
+
+/// Maximum topic length, including the terminating zero
+#define RL_SOCKET_TOPIC_LENGTH 32
+
+/// Maximum number of distinct subscriptions tracked
+#define RL_SOCKET_SUBSCRIPTION_COUNT_MAX 64
+
+/// Topic of the metadata messages
+#define RL_SOCKET_METADATA_TOPIC "metadata"
+
+/**
+ * Channel groups published as separate topics.
+ */
+enum rl_socket_group {
+    RL_SOCKET_GROUP_ALL = 0,     /// All channels
+    RL_SOCKET_GROUP_VOLTAGE = 1, /// Voltage channels
+    RL_SOCKET_GROUP_CURRENT = 2, /// Current channels and their range valid
+    RL_SOCKET_GROUP_AMBIENT = 3, /// Ambient sensor channels
+    RL_SOCKET_GROUP_DIGITAL = 4, /// Digital input channels
+};
+
+/**
+ * Type definition for channel groups published as separate topics.
+ */
+typedef enum rl_socket_group rl_socket_group_t;
+
+/**
+ * Data message buffer, shared with ZeroMQ for zero-copy publishing.
+ */
+struct rl_socket_message {
+    /// Number of references by the publisher and queued message frames
+    atomic_uint references;
+    /// Size of the allocated buffer in bytes
+    size_t size;
+    /// Buffer holding the data of all frames of the message
+    uint8_t *buffer;
+};
+
+/**
+ * Type definition for data message buffer.
+ */
+typedef struct rl_socket_message rl_socket_message_t;
+
+/**
+ * Data of one resolution level within a data message buffer.
+ */
+struct rl_socket_level_data {
+    /// Number of values per analog channel frame
+    size_t channel_values;
+    /// Number of values of the digital frame
+    size_t digital_values;
+    /// Analog channel frames, NULL if not published
+    int32_t *channel[RL_CHANNEL_COUNT];
+    /// Digital frame, NULL if not published
+    uint32_t *digital;
+};
+
+/**
+ * Type definition for data of one resolution level.
+ */
+typedef struct rl_socket_level_data rl_socket_level_data_t;
+
+/// resolution level names used in the topics
+static char const *const RL_SOCKET_LEVEL_NAMES[RL_SOCKET_LEVEL_COUNT] = {
+    "full", "10k", "1k", "10"};
+
+/// resolution level envelope rates in Hz (zero for all samples)
+static uint32_t const RL_SOCKET_LEVEL_RATES[RL_SOCKET_LEVEL_COUNT] = {
+    0, 10000, 1000, 10};
+
+/// channel group names used in the topics and metadata
+static char const *const RL_SOCKET_GROUP_NAMES[RL_SOCKET_GROUP_COUNT] = {
+    "all", "voltage", "current", "ambient", "digital"};
 
 /// data socket metadata in JSON format
 char metadata_json[RL_SOCKET_METADATA_SIZE];
@@ -52,12 +147,174 @@ char metadata_json[RL_SOCKET_METADATA_SIZE];
 void *zmq_data_context = NULL;
 /// the ZeroMQ data socket
 void *zmq_data_socket = NULL;
+/// version of the data socket metadata
+static uint32_t rl_socket_metadata_version = 0;
+/// whether the metadata is to be published with the next data
+static bool rl_socket_metadata_pending = false;
+/// channel layout hash of the metadata
+static uint32_t rl_socket_layout_hash = 0;
+/// number of data messages dropped by the publisher
+static atomic_uint rl_socket_messages_dropped;
+/// number of samples per envelope value of each level (1 for all samples)
+static size_t rl_socket_decimation[RL_SOCKET_LEVEL_COUNT];
+/// data message buffers, allocated on first use
+static rl_socket_message_t rl_socket_message_pool[RL_SOCKET_MESSAGE_POOL_SIZE];
+/// data topic of each resolution level and channel group
+static char rl_socket_topic[RL_SOCKET_LEVEL_COUNT][RL_SOCKET_GROUP_COUNT]
+                           [RL_SOCKET_TOPIC_LENGTH];
+/// whether each data topic has subscribers
+static bool rl_socket_topic_subscribed[RL_SOCKET_LEVEL_COUNT]
+                                      [RL_SOCKET_GROUP_COUNT];
+/// topic prefixes subscribed to by at least one subscriber
+static char rl_socket_subscription[RL_SOCKET_SUBSCRIPTION_COUNT_MAX]
+                                  [RL_SOCKET_TOPIC_LENGTH];
+/// number of topic prefixes subscribed to
+static size_t rl_socket_subscription_count = 0;
+
+/**
+ * Generate the data socket metadata in JSON format.
+ *
+ * @param json Buffer of RL_SOCKET_METADATA_SIZE bytes to write the metadata
+ * @param config Current measurement configuration
+ * @param version Metadata version to include
+ * @param layout_hash Channel layout hash to include
+ */
+static void rl_socket_metadata_json(char *const json,
+                                    rl_config_t const *const config,
+                                    uint32_t version, uint32_t layout_hash);
+
+/**
+ * Process the pending subscription messages of the data socket.
+ *
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int rl_socket_update_subscriptions(void);
+
+/**
+ * Check whether a topic is matched by any subscribed topic prefix.
+ *
+ * @param topic The topic to check
+ * @return Returns true if the topic has subscribers, false otherwise
+ */
+static bool rl_socket_is_subscribed(char const *const topic);
+
+/**
+ * Get the channel group of an analog channel.
+ *
+ * @param channel Index of the analog channel
+ * @return The channel group, RL_SOCKET_GROUP_ALL for channels published only
+ * with all channels
+ */
+static rl_socket_group_t rl_socket_channel_group(int channel);
+
+/**
+ * Check whether the digital frame of a channel group holds any channel.
+ *
+ * @param group The channel group
+ * @param config Current measurement configuration
+ * @return Returns true if digital or range valid channels are published
+ */
+static bool rl_socket_group_has_digital(rl_socket_group_t group,
+                                        rl_config_t const *const config);
+
+/**
+ * Get a data message buffer not referenced by any queued message frames.
+ *
+ * @param size Minimum size of the message buffer in bytes
+ * @return Message buffer referenced by the publisher, NULL with errno set to
+ * EBUSY if all buffers are still queued, or to ENOMEM on allocation failure
+ */
+static rl_socket_message_t *rl_socket_message_acquire(size_t size);
+
+/**
+ * ZeroMQ callback releasing a data message buffer reference of a sent frame.
+ *
+ * @param data Frame data (unused)
+ * @param hint Data message buffer of the frame
+ */
+static void rl_socket_message_release(void *data, void *hint);
+
+/**
+ * Publish a data message of a topic, dropped if it cannot be queued.
+ *
+ * @param message Data message buffer holding the frame data
+ * @param topic The topic of the message
+ * @param frame_data Data of the message frames within the message buffer
+ * @param frame_size Sizes of the message frames in bytes
+ * @param frame_count Number of message frames
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int rl_socket_send_message(rl_socket_message_t *const message,
+                                  char const *const topic,
+                                  void *const *const frame_data,
+                                  size_t const *const frame_size,
+                                  size_t frame_count);
+
+/**
+ * Publish a data message frame without copying its data.
+ *
+ * @param message Data message buffer holding the frame data
+ * @param data Frame data within the message buffer
+ * @param size Frame size in bytes
+ * @param flags ZeroMQ send flags
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int rl_socket_send_frame(rl_socket_message_t *const message,
+                                void *const data, size_t size, int flags);
+
+/**
+ * Compute the min/max/mean envelope of a channel's samples.
+ *
+ * @param envelope Envelope buffer of 3 * count values, stores the min, max
+ * and mean value arrays
+ * @param data Channel samples
+ * @param size Number of samples
+ * @param factor Number of samples per envelope value, the last envelope
+ * value covers the remaining samples
+ * @param count Number of envelope values, ceil(size / factor)
+ */
+static void rl_socket_envelope(int32_t *const envelope,
+                               int32_t const *const data, size_t size,
+                               size_t factor, size_t count);
+
+/**
+ * Compute the envelope of the digital input samples, the bitwise AND and OR
+ * of the samples of each envelope value.
+ *
+ * @param envelope Envelope buffer of 2 * count values, stores the AND and OR
+ * value arrays
+ * @param data Digital input samples
+ * @param size Number of samples
+ * @param factor Number of samples per envelope value
+ * @param count Number of envelope values, ceil(size / factor)
+ */
+static void rl_socket_envelope_digital(uint32_t *const envelope,
+                                       uint32_t const *const data, size_t size,
+                                       size_t factor, size_t count);
 
 int rl_socket_init(void) {
-    // open and bind zmq data socket
+    // open and bind zmq data socket, passing all subscriptions to track the
+    // topics with subscribers and to welcome new subscribers with metadata
     zmq_data_context = zmq_ctx_new();
-    zmq_data_socket = zmq_socket(zmq_data_context, ZMQ_PUB);
-    int zmq_res = zmq_bind(zmq_data_socket, RL_ZMQ_DATA_SOCKET);
+    zmq_data_socket = zmq_socket(zmq_data_context, ZMQ_XPUB);
+
+    // limit queued messages to keep message buffers for other subscribers
+    int const send_hwm = RL_SOCKET_SEND_HWM;
+    int const verbose = 1;
+    int zmq_res = zmq_setsockopt(zmq_data_socket, ZMQ_SNDHWM, &send_hwm,
+                                 sizeof(send_hwm));
+    if (zmq_res == 0) {
+        zmq_res = zmq_setsockopt(zmq_data_socket, ZMQ_XPUB_VERBOSE, &verbose,
+                                 sizeof(verbose));
+    }
+    if (zmq_res < 0) {
+        rl_log(RL_LOG_ERROR,
+               "failed configuring zeromq data socket; %d message: %s", errno,
+               strerror(errno));
+        return ERROR;
+    }
+
+    zmq_res = zmq_bind(zmq_data_socket, RL_ZMQ_DATA_SOCKET);
     if (zmq_res < 0) {
         rl_log(RL_LOG_ERROR,
                "failed binding zeromq data socket; %d message: %s", errno,
@@ -65,24 +322,354 @@ int rl_socket_init(void) {
         return ERROR;
     }
 
+    // data topics named by resolution level and channel group
+    for (int level = 0; level < RL_SOCKET_LEVEL_COUNT; level++) {
+        for (int group = 0; group < RL_SOCKET_GROUP_COUNT; group++) {
+            snprintf(rl_socket_topic[level][group], RL_SOCKET_TOPIC_LENGTH,
+                     "data.%s.%s", RL_SOCKET_LEVEL_NAMES[level],
+                     RL_SOCKET_GROUP_NAMES[group]);
+            rl_socket_topic_subscribed[level][group] = false;
+        }
+    }
+    rl_socket_subscription_count = 0;
+
+    // metadata versions distinct from previous runs for running subscribers
+    metadata_json[0] = 0;
+    rl_socket_metadata_version = (uint32_t)time(NULL);
+    rl_socket_metadata_pending = false;
+    rl_socket_layout_hash = 0;
+    atomic_store(&rl_socket_messages_dropped, 0);
+
     return SUCCESS;
 }
 
 int rl_socket_deinit(void) {
-    // close and destroy zmq data socket
+    // close and destroy zmq data socket, releases all queued message frames
     zmq_close(zmq_data_socket);
     zmq_ctx_destroy(zmq_data_context);
 
     zmq_data_socket = NULL;
     zmq_data_context = NULL;
 
+    for (int i = 0; i < RL_SOCKET_MESSAGE_POOL_SIZE; i++) {
+        rl_socket_message_t *const message = &rl_socket_message_pool[i];
+        free(message->buffer);
+        message->buffer = NULL;
+        message->size = 0;
+        atomic_store(&message->references, 0);
+    }
+
     return SUCCESS;
 }
 
 int rl_socket_metadata(rl_config_t const *const config) {
-    // data rate and channel info init
-    snprintf(metadata_json, RL_SOCKET_METADATA_SIZE,
-             "{\"data_rate\":%d,\"channels\":[", config->sample_rate);
+    // samples per envelope value, envelopes of single samples at low rates
+    for (int level = 0; level < RL_SOCKET_LEVEL_COUNT; level++) {
+        rl_socket_decimation[level] = 1;
+        if (RL_SOCKET_LEVEL_RATES[level] > 0 &&
+            config->sample_rate > RL_SOCKET_LEVEL_RATES[level]) {
+            rl_socket_decimation[level] =
+                config->sample_rate / RL_SOCKET_LEVEL_RATES[level];
+        }
+    }
+
+    // new metadata version to publish on channel layout change only, the
+    // layout hashed without version and hash values
+    char json[RL_SOCKET_METADATA_SIZE];
+    rl_socket_metadata_json(json, config, 0, 0);
+    uint32_t const layout_hash = rl_crc32c(RL_CRC32C_INIT, json, strlen(json));
+    if (layout_hash == rl_socket_layout_hash && metadata_json[0] != 0) {
+        return SUCCESS;
+    }
+
+    rl_socket_layout_hash = layout_hash;
+    rl_socket_metadata_version++;
+    rl_socket_metadata_json(metadata_json, config, rl_socket_metadata_version,
+                            rl_socket_layout_hash);
+    rl_socket_metadata_pending = true;
+
+    return SUCCESS;
+}
+
+int rl_socket_handle_data(int32_t const *analog_buffer,
+                          uint32_t const *digital_buffer,
+                          int32_t const *ambient_buffer, size_t buffer_size,
+                          size_t ambient_buffer_size, uint64_t sequence,
+                          uint64_t samples_lost,
+                          rl_timestamp_t const *const timestamp_realtime,
+                          rl_timestamp_t const *const timestamp_monotonic,
+                          rl_config_t const *const config) {
+
+    int res = rl_socket_update_subscriptions();
+    if (res < 0) {
+        rl_log(RL_LOG_ERROR,
+               "failed receiving data socket subscriptions; %d message: %s",
+               errno, strerror(errno));
+        return ERROR;
+    }
+
+    // publish metadata on change and for new subscribers, retried with the
+    // next buffer if not queued
+    if (rl_socket_metadata_pending) {
+        int zmq_res = zmq_send(zmq_data_socket, RL_SOCKET_METADATA_TOPIC,
+                               strlen(RL_SOCKET_METADATA_TOPIC),
+                               ZMQ_SNDMORE | ZMQ_DONTWAIT);
+        if (zmq_res >= 0) {
+            zmq_res = zmq_send(zmq_data_socket, metadata_json,
+                               strlen(metadata_json), ZMQ_DONTWAIT);
+        }
+        if (zmq_res < 0 && errno != EAGAIN) {
+            rl_log(RL_LOG_ERROR, "failed publishing metadata; %d message: %s",
+                   errno, strerror(errno));
+            return ERROR;
+        }
+        rl_socket_metadata_pending = (zmq_res < 0);
+    }
+
+    // resolution levels with subscribers, the only ones to compute
+    bool level_enable[RL_SOCKET_LEVEL_COUNT] = {false};
+    bool publish = false;
+    for (int level = 0; level < RL_SOCKET_LEVEL_COUNT; level++) {
+        for (int group = 0; group < RL_SOCKET_GROUP_COUNT; group++) {
+            level_enable[level] |= rl_socket_topic_subscribed[level][group];
+        }
+        publish |= level_enable[level];
+    }
+    if (!publish) {
+        return SUCCESS;
+    }
+
+    size_t sensor_count = 0;
+    if (config->ambient_enable) {
+        sensor_count = rl_status.sensor_count;
+    }
+
+    // message size of the channel data (or their envelopes) of all levels,
+    // limited to the channel groups with subscribers
+    rl_socket_level_data_t level_data[RL_SOCKET_LEVEL_COUNT];
+    bool channel_enable[RL_SOCKET_LEVEL_COUNT][RL_CHANNEL_COUNT] = {{false}};
+    bool digital_enable[RL_SOCKET_LEVEL_COUNT] = {false};
+    size_t message_size = 2 * sizeof(rl_timestamp_t) +
+                          sizeof(rl_socket_data_header_t) +
+                          sensor_count * sizeof(int32_t);
+    for (int level = 0; level < RL_SOCKET_LEVEL_COUNT; level++) {
+        if (!level_enable[level]) {
+            continue;
+        }
+
+        bool const *const subscribed = rl_socket_topic_subscribed[level];
+        size_t const envelope_count =
+            (buffer_size + rl_socket_decimation[level] - 1) /
+            rl_socket_decimation[level];
+        level_data[level].channel_values = 3 * envelope_count;
+        level_data[level].digital_values = 2 * envelope_count;
+        if (RL_SOCKET_LEVEL_RATES[level] == 0) {
+            level_data[level].channel_values = buffer_size;
+            level_data[level].digital_values = buffer_size;
+        }
+
+        for (int ch = 0; ch < RL_CHANNEL_COUNT; ch++) {
+            channel_enable[level][ch] =
+                config->channel_enable[ch] &&
+                (subscribed[RL_SOCKET_GROUP_ALL] ||
+                 subscribed[rl_socket_channel_group(ch)]);
+            if (channel_enable[level][ch]) {
+                message_size +=
+                    level_data[level].channel_values * sizeof(int32_t);
+            }
+        }
+        for (int group = 0; group < RL_SOCKET_GROUP_COUNT; group++) {
+            digital_enable[level] |=
+                subscribed[group] &&
+                rl_socket_group_has_digital((rl_socket_group_t)group, config);
+        }
+        if (digital_enable[level]) {
+            message_size += level_data[level].digital_values * sizeof(uint32_t);
+        }
+    }
+
+    // drop the buffer while all message buffers are queued for slow clients
+    rl_socket_message_t *const message =
+        rl_socket_message_acquire(message_size);
+    if (message == NULL && errno == EBUSY) {
+        atomic_fetch_add_explicit(&rl_socket_messages_dropped, 1,
+                                  memory_order_relaxed);
+        return SUCCESS;
+    }
+    if (message == NULL) {
+        rl_log(RL_LOG_ERROR,
+               "failed allocating data message buffer; %d message: %s", errno,
+               strerror(errno));
+        return ERROR;
+    }
+
+    // assemble the frames of all levels in the message buffer, raw timestamp
+    // values first for their alignment
+    uint8_t *frame = message->buffer;
+
+    rl_timestamp_t *const timestamps = (rl_timestamp_t *)frame;
+    timestamps[0] = *timestamp_realtime;
+    timestamps[1] = *timestamp_monotonic;
+    frame += 2 * sizeof(rl_timestamp_t);
+
+    rl_socket_data_header_t *const header = (rl_socket_data_header_t *)frame;
+    header->header_version = RL_SOCKET_DATA_HEADER_VERSION;
+    header->header_size = sizeof(rl_socket_data_header_t);
+    header->metadata_version = rl_socket_metadata_version;
+    header->sequence = sequence;
+    header->samples_lost = samples_lost;
+    header->messages_dropped = atomic_load_explicit(
+        &rl_socket_messages_dropped, memory_order_relaxed);
+    header->sample_rate = config->sample_rate;
+    header->layout_hash = rl_socket_layout_hash;
+    frame += sizeof(rl_socket_data_header_t);
+
+    // ambient sensor values, shared by all levels
+    int32_t *const sensor_frame = (int32_t *)frame;
+    if (ambient_buffer_size > 0) {
+        memcpy(sensor_frame, ambient_buffer, sensor_count * sizeof(int32_t));
+    }
+    frame += sensor_count * sizeof(int32_t);
+
+    // analog channels (or their envelopes) from the channel-major buffer and
+    // digital data (or their envelope), in one pass per level
+    for (int level = 0; level < RL_SOCKET_LEVEL_COUNT; level++) {
+        if (!level_enable[level]) {
+            continue;
+        }
+
+        rl_socket_level_data_t *const data = &level_data[level];
+        size_t const decimation = rl_socket_decimation[level];
+        size_t const envelope_count = data->digital_values / 2;
+        for (int ch = 0; ch < RL_CHANNEL_COUNT; ch++) {
+            data->channel[ch] = NULL;
+            if (!channel_enable[level][ch]) {
+                continue;
+            }
+
+            data->channel[ch] = (int32_t *)frame;
+            if (RL_SOCKET_LEVEL_RATES[level] == 0) {
+                memcpy(data->channel[ch], analog_buffer + ch * buffer_size,
+                       buffer_size * sizeof(int32_t));
+            } else {
+                rl_socket_envelope(data->channel[ch],
+                                   analog_buffer + ch * buffer_size,
+                                   buffer_size, decimation, envelope_count);
+            }
+            frame += data->channel_values * sizeof(int32_t);
+        }
+
+        data->digital = NULL;
+        if (digital_enable[level]) {
+            data->digital = (uint32_t *)frame;
+            if (RL_SOCKET_LEVEL_RATES[level] == 0) {
+                memcpy(data->digital, digital_buffer,
+                       buffer_size * sizeof(uint32_t));
+            } else {
+                rl_socket_envelope_digital(data->digital, digital_buffer,
+                                           buffer_size, decimation,
+                                           envelope_count);
+            }
+            frame += data->digital_values * sizeof(uint32_t);
+        }
+    }
+
+    // publish a message per topic with subscribers, referencing the message
+    // buffer until sent
+    for (int level = 0; level < RL_SOCKET_LEVEL_COUNT && res == SUCCESS;
+         level++) {
+        for (int group = 0; group < RL_SOCKET_GROUP_COUNT; group++) {
+            if (!rl_socket_topic_subscribed[level][group]) {
+                continue;
+            }
+
+            rl_socket_level_data_t const *const data = &level_data[level];
+            void *frame_data[RL_SOCKET_FRAME_COUNT_MAX];
+            size_t frame_size[RL_SOCKET_FRAME_COUNT_MAX];
+            size_t frame_count = 0;
+
+            frame_data[frame_count] = header;
+            frame_size[frame_count++] = sizeof(rl_socket_data_header_t);
+            frame_data[frame_count] = timestamps;
+            frame_size[frame_count++] = 2 * sizeof(rl_timestamp_t);
+
+            for (int ch = 0; ch < RL_CHANNEL_COUNT; ch++) {
+                if (data->channel[ch] == NULL ||
+                    (group != RL_SOCKET_GROUP_ALL &&
+                     group != (int)rl_socket_channel_group(ch))) {
+                    continue;
+                }
+                frame_data[frame_count] = data->channel[ch];
+                frame_size[frame_count++] =
+                    data->channel_values * sizeof(int32_t);
+            }
+
+            // ambient sensor values (or empty if none available)
+            if (group == RL_SOCKET_GROUP_ALL ||
+                group == RL_SOCKET_GROUP_AMBIENT) {
+                for (size_t i = 0; i < sensor_count; i++) {
+                    frame_data[frame_count] = &sensor_frame[i];
+                    frame_size[frame_count++] =
+                        sizeof(int32_t) * (ambient_buffer_size > 0);
+                }
+            }
+
+            // digital data (or their envelope, or empty if none available)
+            frame_data[frame_count] = data->digital;
+            frame_size[frame_count++] = 0;
+            if (rl_socket_group_has_digital((rl_socket_group_t)group,
+                                            config)) {
+                frame_size[frame_count - 1] =
+                    data->digital_values * sizeof(uint32_t);
+            }
+
+            res = rl_socket_send_message(message, rl_socket_topic[level][group],
+                                         frame_data, frame_size, frame_count);
+            if (res < 0) {
+                rl_log(RL_LOG_ERROR, "failed publishing data; %d message: %s",
+                       errno, strerror(errno));
+                break;
+            }
+        }
+    }
+
+    // release publisher reference, remaining ones are released by ZeroMQ
+    atomic_fetch_sub_explicit(&message->references, 1, memory_order_release);
+
+    return res;
+}
+
+void rl_socket_update_status(rl_status_t *const status) {
+    status->web_dropped = atomic_load_explicit(&rl_socket_messages_dropped,
+                                               memory_order_relaxed);
+}
+
+static void rl_socket_metadata_json(char *const json,
+                                    rl_config_t const *const config,
+                                    uint32_t version, uint32_t layout_hash) {
+    // resolution level of the web interface
+    int web_level = 0;
+    for (int level = 1; level < RL_SOCKET_LEVEL_COUNT; level++) {
+        if (!config->web_full_rate_enable &&
+            RL_SOCKET_LEVEL_RATES[level] == config->web_rate) {
+            web_level = level;
+        }
+    }
+
+    // metadata version, resolution levels and channel info init
+    snprintf(json, RL_SOCKET_METADATA_SIZE,
+             "{\"version\":%u,\"layout_hash\":%u,\"sample_rate\":%d,"
+             "\"web_level\":\"%s\",\"levels\":{",
+             version, layout_hash, config->sample_rate,
+             RL_SOCKET_LEVEL_NAMES[web_level]);
+    for (int level = 0; level < RL_SOCKET_LEVEL_COUNT; level++) {
+        snprintfcat(json, RL_SOCKET_METADATA_SIZE,
+                    "%s\"%s\":{\"data_rate\":%g,\"envelope\":%s}",
+                    level > 0 ? "," : "", RL_SOCKET_LEVEL_NAMES[level],
+                    (double)config->sample_rate / rl_socket_decimation[level],
+                    RL_SOCKET_LEVEL_RATES[level] > 0 ? "true" : "false");
+    }
+    snprintfcat(json, RL_SOCKET_METADATA_SIZE, "},\"channels\":[");
 
     // analog channel metadata
     for (int ch = 0; ch < RL_CHANNEL_COUNT; ch++) {
@@ -90,22 +677,28 @@ int rl_socket_metadata(rl_config_t const *const config) {
             continue;
         }
 
-        snprintfcat(metadata_json, RL_SOCKET_METADATA_SIZE, "{\"name\":\"%s\",",
+        rl_socket_group_t const group = rl_socket_channel_group(ch);
+        snprintfcat(json, RL_SOCKET_METADATA_SIZE, "{\"name\":\"%s\",",
                     RL_CHANNEL_NAMES[ch]);
+        if (group == RL_SOCKET_GROUP_ALL) {
+            snprintfcat(json, RL_SOCKET_METADATA_SIZE, "\"group\":null,");
+        } else {
+            snprintfcat(json, RL_SOCKET_METADATA_SIZE, "\"group\":\"%s\",",
+                        RL_SOCKET_GROUP_NAMES[group]);
+        }
         if (is_current(ch)) {
             if (is_low_current(ch)) {
-                snprintfcat(metadata_json, RL_SOCKET_METADATA_SIZE,
+                snprintfcat(json, RL_SOCKET_METADATA_SIZE,
                             "\"unit\":\"A\",\"scale\":1e-11},");
             } else {
-                snprintfcat(metadata_json, RL_SOCKET_METADATA_SIZE,
+                snprintfcat(json, RL_SOCKET_METADATA_SIZE,
                             "\"unit\":\"A\",\"scale\":1e-9},");
             }
         } else if (is_voltage(ch)) {
-            snprintfcat(metadata_json, RL_SOCKET_METADATA_SIZE,
+            snprintfcat(json, RL_SOCKET_METADATA_SIZE,
                         "\"unit\":\"V\",\"scale\":1e-8},");
         } else {
-            snprintfcat(metadata_json, RL_SOCKET_METADATA_SIZE,
-                        "\"unit\":null},");
+            snprintfcat(json, RL_SOCKET_METADATA_SIZE, "\"unit\":null},");
         }
     }
 
@@ -113,8 +706,10 @@ int rl_socket_metadata(rl_config_t const *const config) {
     if (config->ambient_enable) {
         for (int ch = 0; ch < SENSOR_REGISTRY_SIZE; ch++) {
             if (rl_status.sensor_available[ch]) {
-                snprintfcat(metadata_json, RL_SOCKET_METADATA_SIZE,
-                            "{\"name\":\"%s\",\"unit\":\"%s\",\"scale\":1e%d},",
+                snprintfcat(json, RL_SOCKET_METADATA_SIZE,
+                            "{\"name\":\"%s\",\"group\":\"ambient\","
+                            "\"unit\":\"%s\",\"scale\":1e%d,"
+                            "\"envelope\":false},",
                             SENSOR_REGISTRY[ch].name,
                             rl_unit_to_string(SENSOR_REGISTRY[ch].unit),
                             SENSOR_REGISTRY[ch].scale);
@@ -125,123 +720,301 @@ int rl_socket_metadata(rl_config_t const *const config) {
     // digital channel metadata
     if (config->digital_enable) {
         for (int i = 0; i < RL_CHANNEL_DIGITAL_COUNT; i++) {
-            snprintfcat(metadata_json, RL_SOCKET_METADATA_SIZE,
-                        "{\"name\":\"DI%d\",\"unit\":\"binary\",\"bit\":%d},",
+            snprintfcat(json, RL_SOCKET_METADATA_SIZE,
+                        "{\"name\":\"DI%d\",\"group\":\"digital\","
+                        "\"unit\":\"binary\",\"bit\":%d},",
                         i + 1, i);
         }
     }
 
     // current range valid metadata and JSON end
     if (config->channel_enable[RL_CONFIG_CHANNEL_I1L]) {
-        snprintfcat(metadata_json, RL_SOCKET_METADATA_SIZE,
-                    "{\"name\":\"I1L_valid\",\"unit\":\"binary\",\"bit\":6,"
-                    "\"hidden\":true},");
+        snprintfcat(json, RL_SOCKET_METADATA_SIZE,
+                    "{\"name\":\"I1L_valid\",\"group\":\"current\","
+                    "\"unit\":\"binary\",\"bit\":6,\"hidden\":true},");
     }
     if (config->channel_enable[RL_CONFIG_CHANNEL_I2L]) {
-        snprintfcat(metadata_json, RL_SOCKET_METADATA_SIZE,
-                    "{\"name\":\"I2L_valid\",\"unit\":\"binary\",\"bit\":7,"
-                    "\"hidden\":true},");
+        snprintfcat(json, RL_SOCKET_METADATA_SIZE,
+                    "{\"name\":\"I2L_valid\",\"group\":\"current\","
+                    "\"unit\":\"binary\",\"bit\":7,\"hidden\":true},");
     }
 
     // trim trailing comma of last array entry
-    if (metadata_json[strlen(metadata_json) - 1] == ',') {
-        metadata_json[strlen(metadata_json) - 1] = 0;
+    if (json[strlen(json) - 1] == ',') {
+        json[strlen(json) - 1] = 0;
     }
 
     // JSON end
-    snprintfcat(metadata_json, RL_SOCKET_METADATA_SIZE, "]}");
+    snprintfcat(json, RL_SOCKET_METADATA_SIZE, "]}");
+}
+
+static int rl_socket_update_subscriptions(void) {
+    // subscription messages: subscribe (1) or unsubscribe (0) and the topic
+    // prefix, unsubscribe is only passed for the last subscriber
+    char message[RL_SOCKET_TOPIC_LENGTH + 1];
+    bool changed = false;
+    while (true) {
+        int const size =
+            zmq_recv(zmq_data_socket, message, sizeof(message), ZMQ_DONTWAIT);
+        if (size < 0 && errno == EAGAIN) {
+            break;
+        }
+        if (size < 0) {
+            return ERROR;
+        }
+
+        // ignore other messages and prefixes longer than any topic
+        if (size < 1 || size > RL_SOCKET_TOPIC_LENGTH ||
+            (message[0] != 0 && message[0] != 1)) {
+            continue;
+        }
+        message[size] = 0;
+        char const *const topic = &message[1];
+
+        size_t index = 0;
+        while (index < rl_socket_subscription_count &&
+               strcmp(rl_socket_subscription[index], topic) != 0) {
+            index++;
+        }
+
+        if (message[0] == 1) {
+            // new subscribers of the metadata receive it right away
+            if (strncmp(RL_SOCKET_METADATA_TOPIC, topic, strlen(topic)) == 0) {
+                rl_socket_metadata_pending = true;
+            }
+            if (index < rl_socket_subscription_count) {
+                continue;
+            }
+            if (index == RL_SOCKET_SUBSCRIPTION_COUNT_MAX) {
+                rl_log(RL_LOG_WARNING,
+                       "too many data socket subscriptions, ignoring '%s'",
+                       topic);
+                continue;
+            }
+            strcpy(rl_socket_subscription[index], topic);
+            rl_socket_subscription_count++;
+        } else if (index < rl_socket_subscription_count) {
+            // move the last subscription to the removed one's place
+            rl_socket_subscription_count--;
+            if (index != rl_socket_subscription_count) {
+                memmove(rl_socket_subscription[index],
+                        rl_socket_subscription[rl_socket_subscription_count],
+                        RL_SOCKET_TOPIC_LENGTH);
+            }
+        }
+        changed = true;
+    }
+
+    if (changed) {
+        for (int level = 0; level < RL_SOCKET_LEVEL_COUNT; level++) {
+            for (int group = 0; group < RL_SOCKET_GROUP_COUNT; group++) {
+                rl_socket_topic_subscribed[level][group] =
+                    rl_socket_is_subscribed(rl_socket_topic[level][group]);
+            }
+        }
+    }
 
     return SUCCESS;
 }
 
-int rl_socket_handle_data(int32_t const *analog_buffer,
-                          uint32_t const *digital_buffer,
-                          int32_t const *ambient_buffer, size_t buffer_size,
-                          size_t ambient_buffer_size,
-                          rl_timestamp_t const *const timestamp_realtime,
-                          rl_timestamp_t const *const timestamp_monotonic,
-                          rl_config_t const *const config) {
+static bool rl_socket_is_subscribed(char const *const topic) {
+    for (size_t i = 0; i < rl_socket_subscription_count; i++) {
+        char const *const prefix = rl_socket_subscription[i];
+        if (strncmp(topic, prefix, strlen(prefix)) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    // publish metadata to socket
-    int zmq_res = zmq_send(zmq_data_socket, metadata_json,
-                           strlen(metadata_json), ZMQ_SNDMORE);
-    if (zmq_res < 0) {
-        rl_log(RL_LOG_ERROR, "failed publishing analog data; %d message: %s",
-               errno, strerror(errno));
-        return ERROR;
+static rl_socket_group_t rl_socket_channel_group(int channel) {
+    if (is_voltage(channel)) {
+        return RL_SOCKET_GROUP_VOLTAGE;
     }
+    if (is_current(channel)) {
+        return RL_SOCKET_GROUP_CURRENT;
+    }
+    return RL_SOCKET_GROUP_ALL;
+}
 
-    // publish raw timestamp values
-    rl_timestamp_t timestamps[2] = {
-        *timestamp_realtime,
-        *timestamp_monotonic,
-    };
+static bool rl_socket_group_has_digital(rl_socket_group_t group,
+                                        rl_config_t const *const config) {
+    bool const range_valid_enable =
+        config->channel_enable[RL_CONFIG_CHANNEL_I1L] ||
+        config->channel_enable[RL_CONFIG_CHANNEL_I2L];
 
-    // publish timestamp data to socket
-    zmq_res =
-        zmq_send(zmq_data_socket, timestamps, sizeof(timestamps), ZMQ_SNDMORE);
-    if (zmq_res < 0) {
-        rl_log(RL_LOG_ERROR, "failed publishing timestamps; %d message: %s",
-               errno, strerror(errno));
-        return ERROR;
+    switch (group) {
+    case RL_SOCKET_GROUP_ALL:
+        return config->digital_enable || range_valid_enable;
+    case RL_SOCKET_GROUP_CURRENT:
+        return range_valid_enable;
+    case RL_SOCKET_GROUP_DIGITAL:
+        return config->digital_enable;
+    default:
+        return false;
     }
+}
 
-    // process analog channels
-    int32_t *const data_buffer = malloc(buffer_size * sizeof(int32_t));
-    for (int ch = 0; ch < RL_CHANNEL_COUNT; ch++) {
-        if (!config->channel_enable[ch]) {
+static rl_socket_message_t *rl_socket_message_acquire(size_t size) {
+    for (int i = 0; i < RL_SOCKET_MESSAGE_POOL_SIZE; i++) {
+        rl_socket_message_t *const message = &rl_socket_message_pool[i];
+        if (atomic_load_explicit(&message->references,
+                                 memory_order_acquire) > 0) {
             continue;
         }
 
-        // copy standalone channel buffer
-        for (size_t i = 0; i < buffer_size; i++) {
-            data_buffer[i] = *(analog_buffer + i * RL_CHANNEL_COUNT + ch);
+        // (re)allocate on first use and configuration change only
+        if (message->size < size) {
+            free(message->buffer);
+            message->buffer = malloc(size);
+            if (message->buffer == NULL) {
+                message->size = 0;
+                return NULL;
+            }
+            message->size = size;
         }
 
-        // publish channel data to socket
-        int zmq_res = zmq_send(zmq_data_socket, data_buffer,
-                               buffer_size * sizeof(int32_t), ZMQ_SNDMORE);
-        if (zmq_res < 0) {
-            rl_log(RL_LOG_ERROR,
-                   "failed publishing analog data; %d message: %s", errno,
-                   strerror(errno));
-            // free data send buffer and exit
-            free(data_buffer);
+        atomic_store_explicit(&message->references, 1, memory_order_relaxed);
+        return message;
+    }
+
+    errno = EBUSY;
+    return NULL;
+}
+
+static void rl_socket_message_release(void *data, void *hint) {
+    (void)data; // suppress unused parameter warning
+    rl_socket_message_t *const message = (rl_socket_message_t *)hint;
+    atomic_fetch_sub_explicit(&message->references, 1, memory_order_release);
+}
+
+static int rl_socket_send_message(rl_socket_message_t *const message,
+                                  char const *const topic,
+                                  void *const *const frame_data,
+                                  size_t const *const frame_size,
+                                  size_t frame_count) {
+    // topic frame first, the message is dropped if it cannot be queued
+    int zmq_res = zmq_send(zmq_data_socket, topic, strlen(topic),
+                           ZMQ_SNDMORE | ZMQ_DONTWAIT);
+    if (zmq_res < 0 && errno == EAGAIN) {
+        atomic_fetch_add_explicit(&rl_socket_messages_dropped, 1,
+                                  memory_order_relaxed);
+        return SUCCESS;
+    }
+    if (zmq_res < 0) {
+        return ERROR;
+    }
+
+    for (size_t i = 0; i < frame_count; i++) {
+        int const flags =
+            (i + 1 < frame_count) ? ZMQ_SNDMORE | ZMQ_DONTWAIT : ZMQ_DONTWAIT;
+        int res = rl_socket_send_frame(message, frame_data[i], frame_size[i],
+                                       flags);
+        if (res < 0) {
             return ERROR;
         }
     }
-    free(data_buffer);
 
-    // publish ambient data to socket
-    if (config->ambient_enable) {
-        for (int ch = 0; ch < rl_status.sensor_count; ch++) {
-            // publish channel data to socket
-            int zmq_res = zmq_send(zmq_data_socket, &ambient_buffer[ch],
-                                   sizeof(int32_t) * (ambient_buffer_size > 0),
-                                   ZMQ_SNDMORE);
-            if (zmq_res < 0) {
-                rl_log(RL_LOG_ERROR,
-                       "failed publishing sensor data; %d message: %s", errno,
-                       strerror(errno));
-                return ERROR;
-            }
+    return SUCCESS;
+}
+
+static int rl_socket_send_frame(rl_socket_message_t *const message,
+                                void *const data, size_t size, int flags) {
+    // empty frames are sent without message buffer reference
+    if (size == 0) {
+        if (zmq_send(zmq_data_socket, "", 0, flags) < 0) {
+            return ERROR;
         }
+        return SUCCESS;
     }
 
-    // publish digital data (or empty if none available) to socket
-    if (config->digital_enable ||
-        config->channel_enable[RL_CONFIG_CHANNEL_I1L] ||
-        config->channel_enable[RL_CONFIG_CHANNEL_I2L]) {
-        zmq_res = zmq_send(zmq_data_socket, digital_buffer,
-                           buffer_size * sizeof(uint32_t), 0);
-    } else {
-        zmq_res = zmq_send(zmq_data_socket, "", 0, 0);
+    zmq_msg_t frame;
+    atomic_fetch_add_explicit(&message->references, 1, memory_order_relaxed);
+    int zmq_res = zmq_msg_init_data(&frame, data, size,
+                                    rl_socket_message_release, message);
+    if (zmq_res < 0) {
+        atomic_fetch_sub_explicit(&message->references, 1,
+                                  memory_order_relaxed);
+        return ERROR;
     }
+
+    // on failure the frame is still owned by the caller and releases the
+    // message buffer reference when closed
+    zmq_res = zmq_msg_send(&frame, zmq_data_socket, flags);
     if (zmq_res < 0) {
-        rl_log(RL_LOG_ERROR, "failed publishing digital data; %d message: %s",
-               errno, strerror(errno));
+        int const send_errno = errno;
+        zmq_msg_close(&frame);
+        errno = send_errno;
         return ERROR;
     }
 
     return SUCCESS;
 }
+
+static void rl_socket_envelope(int32_t *const envelope,
+                               int32_t const *const data, size_t size,
+                               size_t factor, size_t count) {
+    int32_t *const min = envelope;
+    int32_t *const max = envelope + count;
+    int32_t *const mean = envelope + 2 * count;
+
+    for (size_t j = 0; j < count; j++) {
+        int32_t const *const bin = data + j * factor;
+        size_t const bin_size = (j + 1 < count) ? factor : size - j * factor;
+        size_t i = 0;
+        int32_t bin_min = INT32_MAX;
+        int32_t bin_max = INT32_MIN;
+        int64_t bin_sum = 0;
+
+#if defined(__ARM_NEON)
+        // four samples per vector, sums accumulated in 64 bit lanes
+        if (bin_size >= 4) {
+            int32x4_t vector_min = vdupq_n_s32(INT32_MAX);
+            int32x4_t vector_max = vdupq_n_s32(INT32_MIN);
+            int64x2_t vector_sum = vdupq_n_s64(0);
+            for (; i + 4 <= bin_size; i += 4) {
+                int32x4_t const value = vld1q_s32(bin + i);
+                vector_min = vminq_s32(vector_min, value);
+                vector_max = vmaxq_s32(vector_max, value);
+                vector_sum = vpadalq_s32(vector_sum, value);
+            }
+            int32x2_t const pair_min = vpmin_s32(vget_low_s32(vector_min),
+                                                 vget_high_s32(vector_min));
+            int32x2_t const pair_max = vpmax_s32(vget_low_s32(vector_max),
+                                                 vget_high_s32(vector_max));
+            bin_min = vget_lane_s32(vpmin_s32(pair_min, pair_min), 0);
+            bin_max = vget_lane_s32(vpmax_s32(pair_max, pair_max), 0);
+            bin_sum = vgetq_lane_s64(vector_sum, 0) +
+                      vgetq_lane_s64(vector_sum, 1);
+        }
+#endif
+
+        for (; i < bin_size; i++) {
+            int32_t const value = bin[i];
+            bin_min = (value < bin_min) ? value : bin_min;
+            bin_max = (value > bin_max) ? value : bin_max;
+            bin_sum += value;
+        }
+
+        min[j] = bin_min;
+        max[j] = bin_max;
+        mean[j] = (int32_t)(bin_sum / (int64_t)bin_size);
+    }
+}
+
+static void rl_socket_envelope_digital(uint32_t *const envelope,
+                                       uint32_t const *const data, size_t size,
+                                       size_t factor, size_t count) {
+    for (size_t j = 0; j < count; j++) {
+        uint32_t const *const bin = data + j * factor;
+        size_t const bin_size = (j + 1 < count) ? factor : size - j * factor;
+        uint32_t bin_and = UINT32_MAX;
+        uint32_t bin_or = 0;
+        for (size_t i = 0; i < bin_size; i++) {
+            bin_and &= bin[i];
+            bin_or |= bin[i];
+        }
+        envelope[j] = bin_and;
+        envelope[count + j] = bin_or;
+    }
+}
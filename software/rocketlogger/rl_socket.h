@@ -37,6 +37,36 @@
 #include "rl.h"
 #include "util.h"
 
+/// Data message header format version
+#define RL_SOCKET_DATA_HEADER_VERSION 1
+
+/**
+ * Data message header, the first frame of each published data message.
+ */
+struct rl_socket_data_header {
+    /// Data message header format version
+    uint16_t header_version;
+    /// Data message header size in bytes
+    uint16_t header_size;
+    /// Version of the last published metadata describing the message frames
+    uint32_t metadata_version;
+    /// Buffer sequence number, including buffers lost or dropped
+    uint64_t sequence;
+    /// Total number of samples lost by sampling overruns
+    uint64_t samples_lost;
+    /// Total number of data messages dropped by the publisher
+    uint64_t messages_dropped;
+    /// Sample rate of the measurement
+    uint32_t sample_rate;
+    /// Channel layout hash, CRC-32C of the metadata without version
+    uint32_t layout_hash;
+};
+
+/**
+ * Type definition for data message header.
+ */
+typedef struct rl_socket_data_header rl_socket_data_header_t;
+
 /**
  * Initialize socket for data streaming.
  *
@@ -62,11 +92,13 @@ int rl_socket_metadata(rl_config_t const *const config);
 /**
  * Process the data buffer for publishing to data socket.
  *
- * @param analog_buffer Analog data buffer to process
+ * @param analog_buffer Analog data buffer to process (channel-major)
  * @param digital_buffer Digital data buffer to process
  * @param ambient_buffer Ambient sensor data buffer to process
  * @param buffer_size Number of data samples in the buffer
  * @param ambient_buffer_size Number of sensor samples in the buffer
+ * @param sequence Sequence number of the buffer
+ * @param samples_lost Total number of samples lost by sampling overruns
  * @param timestamp_realtime Timestamp sampled from realtime clock
  * @param timestamp_monotonic Timestamp sampled from monotonic clock
  * @param config Current measurement configuration
@@ -75,9 +107,17 @@ int rl_socket_metadata(rl_config_t const *const config);
 int rl_socket_handle_data(int32_t const *analog_buffer,
                           uint32_t const *digital_buffer,
                           int32_t const *ambient_buffer, size_t buffer_size,
-                          size_t ambient_buffer_size,
+                          size_t ambient_buffer_size, uint64_t sequence,
+                          uint64_t samples_lost,
                           rl_timestamp_t const *const timestamp_realtime,
                           rl_timestamp_t const *const timestamp_monotonic,
                           rl_config_t const *const config);
 
+/**
+ * Update the dropped data message counter of the status.
+ *
+ * @param status The status to update
+ */
+void rl_socket_update_status(rl_status_t *const status);
+
 #endif /* RL_SOCKET_H_ */
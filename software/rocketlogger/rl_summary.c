@@ -0,0 +1,296 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <linux/limits.h>
+
+#include "log.h"
+#include "pru.h"
+#include "rl.h"
+#include "rl_file.h"
+#include "util.h"
+
+#include "rl_summary.h"
+
+/**
+ * Reset a summary bin to start accumulating a new bin.
+ *
+ * @param bin The summary bin to reset
+ */
+static void rl_summary_reset_bin(rl_summary_bin_t *const bin);
+
+/**
+ * Store a summary bin and merge it into the bin of the next level.
+ *
+ * @param summary The summary the bin belongs to
+ * @param level The summary level of the bin to store
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int rl_summary_store_bin(rl_summary_t *const summary, int level);
+
+char *rl_summary_get_file_name(char const *const data_file_name) {
+    static char summary_file_name[PATH_MAX];
+
+    // replace the file ending of the file name, if any
+    snprintf(summary_file_name, PATH_MAX - strlen(RL_SUMMARY_EXTENSION), "%s",
+             data_file_name);
+    char *file_ending = strrchr(summary_file_name, '.');
+    if (file_ending == NULL || strchr(file_ending, '/') != NULL) {
+        file_ending = summary_file_name + strlen(summary_file_name);
+    }
+    strcpy(file_ending, RL_SUMMARY_EXTENSION);
+
+    return summary_file_name;
+}
+
+int rl_summary_init(rl_summary_t *const summary, FILE *summary_file,
+                    rl_file_header_t const *const data_file_header,
+                    rl_config_t const *const config) {
+    memset(summary, 0, sizeof(rl_summary_t));
+    summary->file = summary_file;
+
+    // summarize the enabled analog channels in the data file's order
+    for (int i = 0; i < RL_CHANNEL_COUNT; i++) {
+        if (!config->channel_enable[i]) {
+            continue;
+        }
+        int const ch = summary->channel_count;
+        summary->channel[ch] = i;
+        if (i == RL_CONFIG_CHANNEL_I1L) {
+            summary->valid_mask[ch] = PRU_DIGITAL_I1L_VALID_MASK;
+        } else if (i == RL_CONFIG_CHANNEL_I2L) {
+            summary->valid_mask[ch] = PRU_DIGITAL_I2L_VALID_MASK;
+        }
+        summary->channel_count++;
+    }
+    if (summary->channel_count != data_file_header->lead_in.channel_count) {
+        rl_log(RL_LOG_ERROR, "summary channels not matching data file");
+        errno = EINVAL;
+        return ERROR;
+    }
+
+    // bin sizes of the levels at the hardware sample rate, the finest bins
+    // span a minimum number of stored samples to stay smaller than the data
+    summary->sample_rate = config->sample_rate;
+    if (summary->sample_rate < RL_SAMPLE_RATE_MIN) {
+        summary->sample_rate = RL_SAMPLE_RATE_MIN;
+    }
+    uint32_t const bin_size_min = RL_SUMMARY_BIN_SIZE_MIN *
+                                  (summary->sample_rate / config->sample_rate);
+    summary->bin_size[0] = summary->sample_rate / RL_SUMMARY_BASE_RATE;
+    if (summary->bin_size[0] < bin_size_min) {
+        summary->bin_size[0] = bin_size_min;
+    }
+    for (int level = 0; level < RL_SUMMARY_LEVEL_COUNT; level++) {
+        if (level > 0) {
+            summary->bin_size[level] =
+                summary->bin_size[level - 1] * RL_SUMMARY_LEVEL_FACTOR;
+        }
+        rl_summary_reset_bin(&summary->bin[level]);
+    }
+
+    // store header and the definition of the summarized channels
+    rl_summary_header_t summary_header = {
+        .summary_magic = RL_SUMMARY_MAGIC,
+        .summary_version = RL_SUMMARY_VERSION,
+        .record_length = offsetof(rl_summary_record_t, channel) +
+                         summary->channel_count * sizeof(rl_summary_channel_t),
+        .channel_count = summary->channel_count,
+        .level_count = RL_SUMMARY_LEVEL_COUNT,
+        .sample_rate = summary->sample_rate,
+        .start_time = data_file_header->lead_in.start_time,
+    };
+    memcpy(summary_header.bin_size, summary->bin_size,
+           sizeof(summary_header.bin_size));
+
+    size_t count = fwrite(&summary_header, sizeof(rl_summary_header_t), 1,
+                          summary->file);
+    if (count == 1 && summary->channel_count > 0) {
+        count = fwrite(data_file_header->channel +
+                           data_file_header->lead_in.channel_bin_count,
+                       sizeof(rl_file_channel_t) * summary->channel_count, 1,
+                       summary->file);
+    }
+    if (count != 1) {
+        rl_log(RL_LOG_ERROR, "failed storing summary header; %d message: %s",
+               errno, strerror(errno));
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+int rl_summary_add(rl_summary_t *const summary, int32_t const *analog_buffer,
+                   uint32_t const *digital_buffer, size_t buffer_size,
+                   rl_timestamp_t const *const timestamp_realtime) {
+    rl_summary_bin_t *const bin = &summary->bin[0];
+    size_t i = 0;
+
+    while (i < buffer_size) {
+        // bin timestamp interpolated from the block timestamp
+        if (bin->sample_count == 0) {
+            bin->timestamp = *timestamp_realtime;
+            add_time_stamp_offset(&bin->timestamp,
+                                  (int64_t)i * (int64_t)1e9 /
+                                      summary->sample_rate);
+        }
+
+        // accumulate the samples of the block falling into the current bin
+        size_t count = summary->bin_size[0] - bin->sample_count;
+        if (count > buffer_size - i) {
+            count = buffer_size - i;
+        }
+        for (int ch = 0; ch < summary->channel_count; ch++) {
+            int32_t const *const data =
+                analog_buffer + summary->channel[ch] * buffer_size + i;
+            int32_t min = bin->min[ch];
+            int32_t max = bin->max[ch];
+            int64_t sum = 0;
+            for (size_t k = 0; k < count; k++) {
+                if (data[k] < min) {
+                    min = data[k];
+                }
+                if (data[k] > max) {
+                    max = data[k];
+                }
+                sum += data[k];
+            }
+            bin->min[ch] = min;
+            bin->max[ch] = max;
+            bin->sum[ch] += sum;
+
+            if (summary->valid_mask[ch] == 0) {
+                bin->valid[ch] += count;
+                continue;
+            }
+            for (size_t k = 0; k < count; k++) {
+                if (digital_buffer[i + k] & summary->valid_mask[ch]) {
+                    bin->valid[ch]++;
+                }
+            }
+        }
+        bin->sample_count += count;
+        i += count;
+
+        // store completed bins, completing bins of the next levels in turn
+        for (int level = 0; level < RL_SUMMARY_LEVEL_COUNT; level++) {
+            if (summary->bin[level].sample_count < summary->bin_size[level]) {
+                break;
+            }
+            int res = rl_summary_store_bin(summary, level);
+            if (res < 0) {
+                return ERROR;
+            }
+        }
+    }
+
+    return SUCCESS;
+}
+
+int rl_summary_finish(rl_summary_t *const summary) {
+    // incomplete bins are merged upwards before the next level is stored
+    for (int level = 0; level < RL_SUMMARY_LEVEL_COUNT; level++) {
+        if (summary->bin[level].sample_count == 0) {
+            continue;
+        }
+        int res = rl_summary_store_bin(summary, level);
+        if (res < 0) {
+            return ERROR;
+        }
+    }
+
+    fflush(summary->file);
+    return SUCCESS;
+}
+
+static void rl_summary_reset_bin(rl_summary_bin_t *const bin) {
+    bin->sample_count = 0;
+    for (int ch = 0; ch < RL_CHANNEL_COUNT; ch++) {
+        bin->min[ch] = INT32_MAX;
+        bin->max[ch] = INT32_MIN;
+        bin->sum[ch] = 0;
+        bin->valid[ch] = 0;
+    }
+}
+
+static int rl_summary_store_bin(rl_summary_t *const summary, int level) {
+    rl_summary_bin_t *const bin = &summary->bin[level];
+
+    // store the summary record of the bin
+    rl_summary_record_t record = {
+        .level = level,
+        .sample_count = bin->sample_count,
+        .timestamp = bin->timestamp,
+    };
+    for (int ch = 0; ch < summary->channel_count; ch++) {
+        record.channel[ch].min = bin->min[ch];
+        record.channel[ch].max = bin->max[ch];
+        record.channel[ch].mean =
+            (float)((double)bin->sum[ch] / bin->sample_count);
+        record.channel[ch].valid = (float)bin->valid[ch] / bin->sample_count;
+    }
+    size_t const record_length =
+        offsetof(rl_summary_record_t, channel) +
+        summary->channel_count * sizeof(rl_summary_channel_t);
+    size_t count = fwrite(&record, record_length, 1, summary->file);
+    if (count != 1) {
+        rl_log(RL_LOG_ERROR, "failed storing summary record; %d message: %s",
+               errno, strerror(errno));
+        return ERROR;
+    }
+
+    // merge into the bin of the next level
+    if (level + 1 < RL_SUMMARY_LEVEL_COUNT) {
+        rl_summary_bin_t *const next = &summary->bin[level + 1];
+        if (next->sample_count == 0) {
+            next->timestamp = bin->timestamp;
+        }
+        for (int ch = 0; ch < summary->channel_count; ch++) {
+            if (bin->min[ch] < next->min[ch]) {
+                next->min[ch] = bin->min[ch];
+            }
+            if (bin->max[ch] > next->max[ch]) {
+                next->max[ch] = bin->max[ch];
+            }
+            next->sum[ch] += bin->sum[ch];
+            next->valid[ch] += bin->valid[ch];
+        }
+        next->sample_count += bin->sample_count;
+    }
+
+    rl_summary_reset_bin(bin);
+    return SUCCESS;
+}
@@ -0,0 +1,224 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RL_SUMMARY_H_
+#define RL_SUMMARY_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "rl.h"
+#include "rl_file.h"
+#include "util.h"
+
+/// Summary file magic constant (ASCII %RLS)
+#define RL_SUMMARY_MAGIC 0x534C5225
+/// Summary file version number
+#define RL_SUMMARY_VERSION 0x01
+/// Summary file extension
+#define RL_SUMMARY_EXTENSION ".rls"
+/// Number of summary levels
+#define RL_SUMMARY_LEVEL_COUNT 4
+/// Number of bins of the finest summary level per second (1 ms resolution)
+#define RL_SUMMARY_BASE_RATE 1000
+/// Minimum number of stored samples per bin of the finest summary level
+#define RL_SUMMARY_BIN_SIZE_MIN 64
+/// Number of bins of a summary level aggregated to a bin of the next level
+#define RL_SUMMARY_LEVEL_FACTOR 100
+
+/**
+ * Header of the summary file stored alongside a binary data file.
+ *
+ * The header is followed by the channel definitions of the summarized analog
+ * channels, in the data file's channel order. Summary records of all levels
+ * follow in the order the bins are completed, i.e. a bin is stored right after
+ * the last bin of the finer levels it aggregates. Incomplete bins are stored
+ * last, ordered by level, when the measurement is finished.
+ */
+struct rl_summary_header {
+    /// Summary file magic constant
+    uint32_t summary_magic;
+    /// Summary file version number
+    uint16_t summary_version;
+    /// Size of the summary records in bytes
+    uint16_t record_length;
+    /// Number of summarized channels
+    uint16_t channel_count;
+    /// Number of summary levels
+    uint16_t level_count;
+    /// Sample rate of the summarized samples
+    uint32_t sample_rate;
+    /// Start time of the summarized data file, to match it with the data file
+    rl_timestamp_t start_time;
+    /// Number of samples summarized per bin, for each level
+    uint32_t bin_size[RL_SUMMARY_LEVEL_COUNT];
+};
+
+/**
+ * Typedef for RocketLogger summary file header
+ */
+typedef struct rl_summary_header rl_summary_header_t;
+
+/**
+ * Summary of a channel over the samples of a bin.
+ */
+struct rl_summary_channel {
+    /// Minimum value
+    int32_t min;
+    /// Maximum value
+    int32_t max;
+    /// Mean value
+    float mean;
+    /// Ratio of valid samples (low-range current channels, 1 otherwise)
+    float valid;
+};
+
+/**
+ * Typedef for RocketLogger summary of a channel
+ */
+typedef struct rl_summary_channel rl_summary_channel_t;
+
+/**
+ * Summary record of a bin, stored with the summaries of the enabled channels.
+ */
+struct rl_summary_record {
+    /// Summary level of the bin
+    uint32_t level;
+    /// Number of samples summarized, less than the bin size for the last bin
+    uint32_t sample_count;
+    /// Realtime timestamp of the first sample of the bin
+    rl_timestamp_t timestamp;
+    /// Summary of the channels (only the summarized channels are stored)
+    rl_summary_channel_t channel[RL_CHANNEL_COUNT];
+};
+
+/**
+ * Typedef for RocketLogger summary record
+ */
+typedef struct rl_summary_record rl_summary_record_t;
+
+/**
+ * Summary bin being accumulated.
+ */
+struct rl_summary_bin {
+    /// Number of samples accumulated
+    uint32_t sample_count;
+    /// Realtime timestamp of the first sample of the bin
+    rl_timestamp_t timestamp;
+    /// Minimum value of the channels
+    int32_t min[RL_CHANNEL_COUNT];
+    /// Maximum value of the channels
+    int32_t max[RL_CHANNEL_COUNT];
+    /// Sum of the values of the channels
+    int64_t sum[RL_CHANNEL_COUNT];
+    /// Number of valid samples of the channels
+    uint32_t valid[RL_CHANNEL_COUNT];
+};
+
+/**
+ * Typedef for a summary bin being accumulated.
+ */
+typedef struct rl_summary_bin rl_summary_bin_t;
+
+/**
+ * Multi-resolution summary of a measurement, built incrementally per block.
+ */
+struct rl_summary {
+    /// Summary file
+    FILE *file;
+    /// Number of summarized channels
+    int channel_count;
+    /// Channel index of the summarized channels
+    int channel[RL_CHANNEL_COUNT];
+    /// Digital valid mask of the summarized channels (0 if always valid)
+    uint32_t valid_mask[RL_CHANNEL_COUNT];
+    /// Sample rate of the summarized samples
+    uint32_t sample_rate;
+    /// Number of samples summarized per bin, for each level
+    uint32_t bin_size[RL_SUMMARY_LEVEL_COUNT];
+    /// Bins being accumulated, for each level
+    rl_summary_bin_t bin[RL_SUMMARY_LEVEL_COUNT];
+};
+
+/**
+ * Typedef for a multi-resolution summary of a measurement.
+ */
+typedef struct rl_summary rl_summary_t;
+
+/**
+ * Get summary file name from the data file name.
+ *
+ * @param data_file_name The data file name
+ * @return The summary file name (statically allocated)
+ */
+char *rl_summary_get_file_name(char const *const data_file_name);
+
+/**
+ * Initialize a summary of the enabled analog channels and store its header.
+ *
+ * The samples are summarized at the hardware sample rate, before the
+ * aggregation for low data rates.
+ *
+ * @param summary The summary to initialize
+ * @param summary_file The file to store the summary to
+ * @param data_file_header The header of the summarized data file
+ * @param config Current measurement configuration
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_summary_init(rl_summary_t *const summary, FILE *summary_file,
+                    rl_file_header_t const *const data_file_header,
+                    rl_config_t const *const config);
+
+/**
+ * Add a data block to the summary, storing the completed bins.
+ *
+ * @param summary The summary to add the data block to
+ * @param analog_buffer Analog data of the samples (channel-major)
+ * @param digital_buffer Digital data of the samples
+ * @param buffer_size Number of samples of the data block
+ * @param timestamp_realtime Realtime timestamp of the first sample
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_summary_add(rl_summary_t *const summary, int32_t const *analog_buffer,
+                   uint32_t const *digital_buffer, size_t buffer_size,
+                   rl_timestamp_t const *const timestamp_realtime);
+
+/**
+ * Store the incomplete bins of all levels and flush the summary file.
+ *
+ * The summary file is not closed.
+ *
+ * @param summary The summary to finish
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_summary_finish(rl_summary_t *const summary);
+
+#endif /* RL_SUMMARY_H_ */
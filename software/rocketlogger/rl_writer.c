@@ -0,0 +1,841 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(RL_IO_URING) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#define RL_WRITER_IO_URING_AVAILABLE
+#endif
+
+#include "log.h"
+#include "rl.h"
+#include "rl_rt.h"
+
+#include "rl_writer.h"
+
+/// io_uring user data of the request waking up the completion thread to stop
+#define RL_WRITER_USER_DATA_STOP UINT64_MAX
+
+/**
+ * Check whether a pending request can be issued without reordering writes to
+ * its file.
+ *
+ * @param writer The writer the request belongs to
+ * @param index Index of the request to check
+ * @return Returns true if no earlier request to the same file is pending or
+ * in flight, false otherwise
+ */
+static bool rl_writer_is_issuable(rl_writer_t const *const writer, int index);
+
+/**
+ * Get the oldest request that can be issued.
+ *
+ * @param writer The writer to get the request from
+ * @return Index of the request, negative if none can be issued
+ */
+static int rl_writer_get_issuable(rl_writer_t const *const writer);
+
+/**
+ * Mark a request completed, update the statistics and wake up waiting
+ * threads. Called with the writer mutex held.
+ *
+ * @param writer The writer the request belongs to
+ * @param index Index of the completed request
+ */
+static void rl_writer_complete(rl_writer_t *const writer, int index);
+
+/**
+ * Write a buffer to a file descriptor at a given offset.
+ *
+ * Handles partial writes and interrupted system calls.
+ *
+ * @param segment The segment to write
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int rl_writer_pwrite_all(rl_writer_segment_t const *const segment);
+
+/**
+ * Worker thread of the thread backend issuing pending requests.
+ *
+ * @param arg The writer
+ * @return Always NULL
+ */
+static void *rl_writer_thread_run(void *arg);
+
+#ifdef RL_WRITER_IO_URING_AVAILABLE
+
+/**
+ * Set up the io_uring instance and register the buffer pool.
+ *
+ * @param writer The writer to set up io_uring for
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int rl_writer_io_uring_init(rl_writer_t *const writer);
+
+/**
+ * Unmap and close the io_uring instance.
+ *
+ * @param writer The writer to clean up io_uring for
+ */
+static void rl_writer_io_uring_deinit(rl_writer_t *const writer);
+
+/**
+ * Add a submission queue entry. Called with the writer mutex held.
+ *
+ * @param writer The writer to queue the entry for
+ * @param user_data The user data identifying the entry on completion
+ * @param segment The segment to write, NULL for a no operation entry
+ * @param buffer_index Index of the registered buffer holding the data
+ */
+static void rl_writer_io_uring_queue(rl_writer_t *const writer,
+                                     uint64_t user_data,
+                                     rl_writer_segment_t const *const segment,
+                                     int buffer_index);
+
+/**
+ * Submit queued entries to the kernel. Called with the writer mutex held.
+ *
+ * @param writer The writer to submit the entries of
+ * @param count Number of queued entries
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+static int rl_writer_io_uring_enter(rl_writer_t *const writer, uint32_t count);
+
+/**
+ * Drop queued entries not consumed by the kernel after a failed submission.
+ * The dropped writes fail with the given error, their requests complete once
+ * no other segment is in flight. Called with the writer mutex held.
+ *
+ * @param writer The writer to drop the queued entries of
+ * @param error Error number of the failed submission
+ */
+static void rl_writer_io_uring_drop(rl_writer_t *const writer, int error);
+
+/**
+ * Issue all requests that can be issued. Called with the writer mutex held.
+ *
+ * @param writer The writer to issue the requests of
+ * @param count Number of entries already queued (e.g. for resubmission)
+ */
+static void rl_writer_io_uring_issue(rl_writer_t *const writer,
+                                     uint32_t count);
+
+/**
+ * Completion thread of the io_uring backend.
+ *
+ * @param arg The writer
+ * @return Always NULL
+ */
+static void *rl_writer_io_uring_run(void *arg);
+
+#endif
+
+int rl_writer_init(rl_writer_t *const writer, size_t buffer_size,
+                   rl_writer_backend_t backend, bool direct_enable) {
+    memset(writer, 0, sizeof(rl_writer_t));
+    writer->ring_fd = -1;
+    writer->direct_enable = direct_enable;
+
+    // page aligned buffers, with room to match the file alignment for direct
+    // I/O
+    if (direct_enable) {
+        buffer_size += RL_WRITER_ALIGNMENT;
+    }
+    writer->buffer_size = ((buffer_size + RL_WRITER_ALIGNMENT - 1) /
+                           RL_WRITER_ALIGNMENT) *
+                          RL_WRITER_ALIGNMENT;
+    int res = posix_memalign((void **)&writer->buffers, RL_WRITER_ALIGNMENT,
+                             RL_WRITER_BUFFER_COUNT * writer->buffer_size);
+    if (res != 0) {
+        errno = res;
+        rl_log(RL_LOG_ERROR,
+               "failed allocating writer buffers; %d message: %s", errno,
+               strerror(errno));
+        return ERROR;
+    }
+    for (int i = 0; i < RL_WRITER_BUFFER_COUNT; i++) {
+        writer->request[i].state = RL_WRITER_STATE_FREE;
+    }
+
+    pthread_mutex_init(&writer->mutex, NULL);
+    pthread_cond_init(&writer->submitted, NULL);
+    pthread_cond_init(&writer->completed, NULL);
+
+    // use io_uring if available, thread pool otherwise
+    writer->backend = RL_WRITER_BACKEND_THREAD;
+#ifdef RL_WRITER_IO_URING_AVAILABLE
+    if (backend == RL_WRITER_BACKEND_IO_URING) {
+        res = rl_writer_io_uring_init(writer);
+        if (res == SUCCESS) {
+            writer->backend = RL_WRITER_BACKEND_IO_URING;
+        } else {
+            rl_log(RL_LOG_INFO,
+                   "io_uring unavailable, using writer threads; %d message: "
+                   "%s",
+                   errno, strerror(errno));
+        }
+    }
+#else
+    (void)backend;
+#endif
+
+    // start completion thread or thread pool
+    int thread_count = RL_WRITER_THREAD_COUNT;
+    if (writer->backend == RL_WRITER_BACKEND_IO_URING) {
+        thread_count = 1;
+    }
+    for (int i = 0; i < thread_count; i++) {
+        void *(*run)(void *) = rl_writer_thread_run;
+#ifdef RL_WRITER_IO_URING_AVAILABLE
+        if (writer->backend == RL_WRITER_BACKEND_IO_URING) {
+            run = rl_writer_io_uring_run;
+        }
+#endif
+        res = pthread_create(&writer->thread[i], NULL, run, writer);
+        if (res != 0) {
+            errno = res;
+            rl_log(RL_LOG_ERROR,
+                   "failed creating writer thread; %d message: %s", errno,
+                   strerror(errno));
+            rl_writer_deinit(writer);
+            errno = res;
+            return ERROR;
+        }
+        writer->thread_count++;
+    }
+
+    return SUCCESS;
+}
+
+void rl_writer_deinit(rl_writer_t *const writer) {
+    if (writer->buffers == NULL) {
+        return;
+    }
+
+    // complete pending writes, then stop threads
+    rl_writer_flush(writer);
+    pthread_mutex_lock(&writer->mutex);
+    writer->stop = true;
+#ifdef RL_WRITER_IO_URING_AVAILABLE
+    if (writer->backend == RL_WRITER_BACKEND_IO_URING &&
+        writer->thread_count > 0) {
+        rl_writer_io_uring_queue(writer, RL_WRITER_USER_DATA_STOP, NULL, 0);
+        rl_writer_io_uring_enter(writer, 1);
+    }
+#endif
+    pthread_cond_broadcast(&writer->submitted);
+    pthread_mutex_unlock(&writer->mutex);
+    for (int i = 0; i < writer->thread_count; i++) {
+        pthread_join(writer->thread[i], NULL);
+    }
+    writer->thread_count = 0;
+
+#ifdef RL_WRITER_IO_URING_AVAILABLE
+    rl_writer_io_uring_deinit(writer);
+#endif
+
+    pthread_cond_destroy(&writer->completed);
+    pthread_cond_destroy(&writer->submitted);
+    pthread_mutex_destroy(&writer->mutex);
+
+    free(writer->buffers);
+    writer->buffers = NULL;
+}
+
+int rl_writer_file_open(rl_writer_file_t *const file, int fd,
+                        char const *const file_name) {
+    file->fd = fd;
+    file->direct_fd = -1;
+    if (file_name == NULL) {
+        return SUCCESS;
+    }
+
+    // separate descriptor, buffered writes of unaligned ranges stay possible
+    file->direct_fd = open(file_name, O_WRONLY | O_DIRECT);
+    if (file->direct_fd < 0) {
+        rl_log(RL_LOG_WARNING,
+               "direct I/O unavailable for '%s', using buffered writes; %d "
+               "message: %s",
+               file_name, errno, strerror(errno));
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+void rl_writer_file_close(rl_writer_file_t *const file) {
+    if (file->direct_fd >= 0) {
+        close(file->direct_fd);
+    }
+    file->direct_fd = -1;
+}
+
+uint8_t *rl_writer_get_buffer(rl_writer_t *const writer, uint64_t offset) {
+    int index = -1;
+
+    // bounded writes in flight: wait for a free buffer
+    pthread_mutex_lock(&writer->mutex);
+    while (index < 0) {
+        for (int i = 0; i < RL_WRITER_BUFFER_COUNT; i++) {
+            if (writer->request[i].state == RL_WRITER_STATE_FREE) {
+                index = i;
+                break;
+            }
+        }
+        if (index < 0) {
+            pthread_cond_wait(&writer->completed, &writer->mutex);
+        }
+    }
+    writer->request[index].state = RL_WRITER_STATE_RESERVED;
+    pthread_mutex_unlock(&writer->mutex);
+
+    uint8_t *buffer = writer->buffers + index * writer->buffer_size;
+    if (writer->direct_enable) {
+        buffer += offset % RL_WRITER_ALIGNMENT;
+    }
+    return buffer;
+}
+
+int rl_writer_submit(rl_writer_t *const writer,
+                     rl_writer_file_t const *const file, uint8_t *const data,
+                     size_t length, uint64_t offset) {
+    int const index = (data - writer->buffers) / writer->buffer_size;
+    rl_writer_request_t *const request = &writer->request[index];
+
+    // write aligned range directly if the buffer alignment matches the file
+    uint64_t const end = offset + length;
+    uint64_t direct_start = end;
+    uint64_t direct_end = end;
+    if (file->direct_fd >= 0 &&
+        ((uintptr_t)data % RL_WRITER_ALIGNMENT) ==
+            (offset % RL_WRITER_ALIGNMENT)) {
+        direct_start = ((offset + RL_WRITER_ALIGNMENT - 1) /
+                        RL_WRITER_ALIGNMENT) *
+                       RL_WRITER_ALIGNMENT;
+        direct_end = (end / RL_WRITER_ALIGNMENT) * RL_WRITER_ALIGNMENT;
+        if (direct_start >= direct_end) {
+            direct_start = end;
+            direct_end = end;
+        }
+    }
+
+    // split into buffered head, direct middle and buffered tail segments
+    rl_writer_segment_t const segment[RL_WRITER_SEGMENT_COUNT] = {
+        {file->fd, data, direct_start - offset, offset},
+        {file->direct_fd, data + (direct_start - offset),
+         direct_end - direct_start, direct_start},
+        {file->fd, data + (direct_end - offset), end - direct_end, direct_end},
+    };
+    request->fd = file->fd;
+    request->segment_count = 0;
+    for (int i = 0; i < RL_WRITER_SEGMENT_COUNT; i++) {
+        if (segment[i].length > 0) {
+            request->segment[request->segment_count] = segment[i];
+            request->segment_count++;
+        }
+    }
+    request->segment_pending = request->segment_count;
+
+    pthread_mutex_lock(&writer->mutex);
+
+    // refuse further writes after a failed one
+    if (writer->error != 0) {
+        errno = writer->error;
+        request->state = RL_WRITER_STATE_FREE;
+        pthread_cond_broadcast(&writer->completed);
+        pthread_mutex_unlock(&writer->mutex);
+        return ERROR;
+    }
+
+    request->state = RL_WRITER_STATE_PENDING;
+    request->sequence = writer->sequence++;
+    request->submit_time = rl_rt_time_ns();
+    writer->queue_depth++;
+    if (writer->queue_depth > writer->queue_depth_max) {
+        writer->queue_depth_max = writer->queue_depth;
+    }
+
+#ifdef RL_WRITER_IO_URING_AVAILABLE
+    if (writer->backend == RL_WRITER_BACKEND_IO_URING) {
+        rl_writer_io_uring_issue(writer, 0);
+    }
+#endif
+    pthread_cond_broadcast(&writer->submitted);
+    pthread_mutex_unlock(&writer->mutex);
+
+    return SUCCESS;
+}
+
+int rl_writer_flush(rl_writer_t *const writer) {
+    pthread_mutex_lock(&writer->mutex);
+    while (writer->queue_depth > 0) {
+        pthread_cond_wait(&writer->completed, &writer->mutex);
+    }
+    int const error = writer->error;
+    writer->error = 0;
+    pthread_mutex_unlock(&writer->mutex);
+
+    if (error != 0) {
+        errno = error;
+        return ERROR;
+    }
+    return SUCCESS;
+}
+
+void rl_writer_update_status(rl_writer_t *const writer,
+                             rl_status_t *const status) {
+    pthread_mutex_lock(&writer->mutex);
+    status->write_queue_depth = writer->queue_depth;
+    status->write_queue_depth_max = writer->queue_depth_max;
+    memcpy(status->write_latency_histogram, writer->latency_histogram,
+           sizeof(status->write_latency_histogram));
+    status->write_latency_max = writer->latency_max;
+    pthread_mutex_unlock(&writer->mutex);
+}
+
+static bool rl_writer_is_issuable(rl_writer_t const *const writer, int index) {
+    rl_writer_request_t const *const request = &writer->request[index];
+    if (request->state != RL_WRITER_STATE_PENDING) {
+        return false;
+    }
+
+    for (int i = 0; i < RL_WRITER_BUFFER_COUNT; i++) {
+        rl_writer_request_t const *const other = &writer->request[i];
+        if (i == index || other->fd != request->fd) {
+            continue;
+        }
+        if (other->state == RL_WRITER_STATE_IN_FLIGHT ||
+            (other->state == RL_WRITER_STATE_PENDING &&
+             (int32_t)(other->sequence - request->sequence) < 0)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static int rl_writer_get_issuable(rl_writer_t const *const writer) {
+    int index = -1;
+    for (int i = 0; i < RL_WRITER_BUFFER_COUNT; i++) {
+        if (!rl_writer_is_issuable(writer, i)) {
+            continue;
+        }
+        if (index < 0 || (int32_t)(writer->request[i].sequence -
+                                   writer->request[index].sequence) < 0) {
+            index = i;
+        }
+    }
+    return index;
+}
+
+static void rl_writer_complete(rl_writer_t *const writer, int index) {
+    rl_writer_request_t *const request = &writer->request[index];
+
+    rl_rt_histogram_add(writer->latency_histogram, &writer->latency_max,
+                        rl_rt_time_ns() - request->submit_time);
+    request->state = RL_WRITER_STATE_FREE;
+    writer->queue_depth--;
+
+    // wake up waiting submitters and workers for later writes to the file
+    pthread_cond_broadcast(&writer->completed);
+    pthread_cond_broadcast(&writer->submitted);
+}
+
+static int rl_writer_pwrite_all(rl_writer_segment_t const *const segment) {
+    uint8_t const *data = segment->data;
+    size_t length = segment->length;
+    off_t offset = (off_t)segment->offset;
+
+    while (length > 0) {
+        ssize_t written = pwrite(segment->fd, data, length, offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return ERROR;
+        }
+
+        data += written;
+        length -= written;
+        offset += written;
+    }
+
+    return SUCCESS;
+}
+
+static void *rl_writer_thread_run(void *arg) {
+    rl_writer_t *const writer = (rl_writer_t *)arg;
+
+    pthread_mutex_lock(&writer->mutex);
+    while (true) {
+        // wait for a request to issue, stop when idle
+        int const index = rl_writer_get_issuable(writer);
+        if (index < 0) {
+            if (writer->stop) {
+                break;
+            }
+            pthread_cond_wait(&writer->submitted, &writer->mutex);
+            continue;
+        }
+
+        rl_writer_request_t *const request = &writer->request[index];
+        request->state = RL_WRITER_STATE_IN_FLIGHT;
+        pthread_mutex_unlock(&writer->mutex);
+
+        // write segments without holding the lock
+        int error = 0;
+        for (int i = 0; i < request->segment_count; i++) {
+            int res = rl_writer_pwrite_all(&request->segment[i]);
+            if (res < 0) {
+                error = errno;
+                break;
+            }
+        }
+
+        pthread_mutex_lock(&writer->mutex);
+        if (error != 0) {
+            rl_log(RL_LOG_ERROR, "failed writing to file; %d message: %s",
+                   error, strerror(error));
+            if (writer->error == 0) {
+                writer->error = error;
+            }
+        }
+        rl_writer_complete(writer, index);
+    }
+    pthread_mutex_unlock(&writer->mutex);
+
+    return NULL;
+}
+
+#ifdef RL_WRITER_IO_URING_AVAILABLE
+
+static int rl_writer_io_uring_init(rl_writer_t *const writer) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    int const fd = (int)syscall(__NR_io_uring_setup,
+                                RL_WRITER_IO_URING_ENTRIES, &params);
+    if (fd < 0) {
+        return ERROR;
+    }
+    writer->ring_fd = fd;
+
+    // map submission and completion queue rings and submission entries
+    writer->sq_ring_size =
+        params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    writer->cq_ring_size =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+    single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) > 0;
+#endif
+    if (single_mmap && writer->cq_ring_size > writer->sq_ring_size) {
+        writer->sq_ring_size = writer->cq_ring_size;
+    }
+
+    writer->sq_ring =
+        mmap(NULL, writer->sq_ring_size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (writer->sq_ring == MAP_FAILED) {
+        writer->sq_ring = NULL;
+        rl_writer_io_uring_deinit(writer);
+        return ERROR;
+    }
+    if (single_mmap) {
+        writer->cq_ring = writer->sq_ring;
+    } else {
+        writer->cq_ring =
+            mmap(NULL, writer->cq_ring_size, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (writer->cq_ring == MAP_FAILED) {
+            writer->cq_ring = NULL;
+            rl_writer_io_uring_deinit(writer);
+            return ERROR;
+        }
+    }
+    writer->sqes =
+        mmap(NULL, params.sq_entries * sizeof(struct io_uring_sqe),
+             PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+             IORING_OFF_SQES);
+    if (writer->sqes == MAP_FAILED) {
+        writer->sqes = NULL;
+        rl_writer_io_uring_deinit(writer);
+        return ERROR;
+    }
+
+    uint8_t *const sq_ring = (uint8_t *)writer->sq_ring;
+    uint8_t *const cq_ring = (uint8_t *)writer->cq_ring;
+    writer->sq_head = (uint32_t *)(sq_ring + params.sq_off.head);
+    writer->sq_tail = (uint32_t *)(sq_ring + params.sq_off.tail);
+    writer->sq_array = (uint32_t *)(sq_ring + params.sq_off.array);
+    writer->sq_mask = *(uint32_t *)(sq_ring + params.sq_off.ring_mask);
+    writer->cq_head = (uint32_t *)(cq_ring + params.cq_off.head);
+    writer->cq_tail = (uint32_t *)(cq_ring + params.cq_off.tail);
+    writer->cqes = cq_ring + params.cq_off.cqes;
+    writer->cq_mask = *(uint32_t *)(cq_ring + params.cq_off.ring_mask);
+
+    // register pool buffers for fixed buffer writes
+    struct iovec iov[RL_WRITER_BUFFER_COUNT];
+    for (int i = 0; i < RL_WRITER_BUFFER_COUNT; i++) {
+        iov[i].iov_base = writer->buffers + i * writer->buffer_size;
+        iov[i].iov_len = writer->buffer_size;
+    }
+    int res = (int)syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS,
+                           iov, RL_WRITER_BUFFER_COUNT);
+    if (res < 0) {
+        rl_writer_io_uring_deinit(writer);
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+static void rl_writer_io_uring_deinit(rl_writer_t *const writer) {
+    if (writer->sqes != NULL) {
+        munmap(writer->sqes,
+               RL_WRITER_IO_URING_ENTRIES * sizeof(struct io_uring_sqe));
+    }
+    if (writer->cq_ring != NULL && writer->cq_ring != writer->sq_ring) {
+        munmap(writer->cq_ring, writer->cq_ring_size);
+    }
+    if (writer->sq_ring != NULL) {
+        munmap(writer->sq_ring, writer->sq_ring_size);
+    }
+    if (writer->ring_fd >= 0) {
+        close(writer->ring_fd);
+    }
+
+    writer->sqes = NULL;
+    writer->cq_ring = NULL;
+    writer->sq_ring = NULL;
+    writer->ring_fd = -1;
+}
+
+static void rl_writer_io_uring_queue(rl_writer_t *const writer,
+                                     uint64_t user_data,
+                                     rl_writer_segment_t const *const segment,
+                                     int buffer_index) {
+    uint32_t const tail = *writer->sq_tail;
+    uint32_t const index = tail & writer->sq_mask;
+    struct io_uring_sqe *const sqe =
+        &((struct io_uring_sqe *)writer->sqes)[index];
+
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    sqe->user_data = user_data;
+    if (segment == NULL) {
+        sqe->opcode = IORING_OP_NOP;
+    } else {
+        sqe->opcode = IORING_OP_WRITE_FIXED;
+        sqe->fd = segment->fd;
+        sqe->off = segment->offset;
+        sqe->addr = (uint64_t)(uintptr_t)segment->data;
+        sqe->len = (uint32_t)segment->length;
+        sqe->buf_index = (uint16_t)buffer_index;
+    }
+
+    // publish entry to the kernel
+    writer->sq_array[index] = index;
+    __atomic_store_n(writer->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+static int rl_writer_io_uring_enter(rl_writer_t *const writer,
+                                    uint32_t count) {
+    while (count > 0) {
+        int res = (int)syscall(__NR_io_uring_enter, writer->ring_fd, count, 0,
+                               0, NULL, 0);
+        if (res < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            rl_log(RL_LOG_ERROR,
+                   "failed submitting file writes; %d message: %s", errno,
+                   strerror(errno));
+            return ERROR;
+        }
+        count -= (uint32_t)res;
+    }
+
+    return SUCCESS;
+}
+
+static void rl_writer_io_uring_drop(rl_writer_t *const writer, int error) {
+    if (writer->error == 0) {
+        writer->error = error;
+    }
+
+    uint32_t const head = __atomic_load_n(writer->sq_head, __ATOMIC_ACQUIRE);
+    uint32_t const tail = *writer->sq_tail;
+    for (uint32_t i = head; i != tail; i++) {
+        struct io_uring_sqe const *const sqe =
+            &((struct io_uring_sqe *)
+                  writer->sqes)[writer->sq_array[i & writer->sq_mask]];
+        if (sqe->user_data == RL_WRITER_USER_DATA_STOP) {
+            continue;
+        }
+
+        int const index = sqe->user_data / RL_WRITER_SEGMENT_COUNT;
+        rl_writer_request_t *const request = &writer->request[index];
+        request->segment_pending--;
+        if (request->segment_pending == 0) {
+            rl_writer_complete(writer, index);
+        }
+    }
+    __atomic_store_n(writer->sq_tail, head, __ATOMIC_RELEASE);
+}
+
+static void rl_writer_io_uring_issue(rl_writer_t *const writer,
+                                     uint32_t count) {
+    while (true) {
+        // queue all segments of the requests that can be issued
+        int index = rl_writer_get_issuable(writer);
+        while (index >= 0) {
+            rl_writer_request_t *const request = &writer->request[index];
+            request->state = RL_WRITER_STATE_IN_FLIGHT;
+            for (int i = 0; i < request->segment_count; i++) {
+                rl_writer_io_uring_queue(writer,
+                                         index * RL_WRITER_SEGMENT_COUNT + i,
+                                         &request->segment[i], index);
+                count++;
+            }
+            index = rl_writer_get_issuable(writer);
+        }
+
+        int res = rl_writer_io_uring_enter(writer, count);
+        if (res == SUCCESS) {
+            return;
+        }
+
+        // fail writes not taken by the kernel instead of waiting for them
+        // forever, then issue the writes that waited for the failed ones
+        rl_writer_io_uring_drop(writer, errno);
+        count = 0;
+    }
+}
+
+static void *rl_writer_io_uring_run(void *arg) {
+    rl_writer_t *const writer = (rl_writer_t *)arg;
+    bool stop = false;
+
+    while (!stop) {
+        // wait for completions without holding the lock
+        int res = (int)syscall(__NR_io_uring_enter, writer->ring_fd, 0, 1,
+                               IORING_ENTER_GETEVENTS, NULL, 0);
+        if (res < 0 && errno != EINTR) {
+            int const error = errno;
+            rl_log(RL_LOG_ERROR,
+                   "failed waiting for file writes, using writer thread; %d "
+                   "message: %s",
+                   error, strerror(error));
+
+            // completions of writes in flight are lost, fail them and
+            // continue as worker thread of the thread backend
+            pthread_mutex_lock(&writer->mutex);
+            if (writer->error == 0) {
+                writer->error = error;
+            }
+            for (int i = 0; i < RL_WRITER_BUFFER_COUNT; i++) {
+                if (writer->request[i].state == RL_WRITER_STATE_IN_FLIGHT) {
+                    rl_writer_complete(writer, i);
+                }
+            }
+            writer->backend = RL_WRITER_BACKEND_THREAD;
+            pthread_mutex_unlock(&writer->mutex);
+            return rl_writer_thread_run(writer);
+        }
+
+        pthread_mutex_lock(&writer->mutex);
+        uint32_t resubmit_count = 0;
+        uint32_t head = *writer->cq_head;
+        uint32_t const tail =
+            __atomic_load_n(writer->cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            struct io_uring_cqe const *const cqe =
+                &((struct io_uring_cqe *)writer->cqes)[head & writer->cq_mask];
+            if (cqe->user_data == RL_WRITER_USER_DATA_STOP) {
+                stop = true;
+                continue;
+            }
+
+            int const index = cqe->user_data / RL_WRITER_SEGMENT_COUNT;
+            rl_writer_request_t *const request = &writer->request[index];
+            rl_writer_segment_t *const segment =
+                &request->segment[cqe->user_data % RL_WRITER_SEGMENT_COUNT];
+
+            // resubmit remainder of partial writes
+            if (cqe->res > 0 && (size_t)cqe->res < segment->length) {
+                segment->data += cqe->res;
+                segment->length -= cqe->res;
+                segment->offset += cqe->res;
+                rl_writer_io_uring_queue(writer, cqe->user_data, segment,
+                                         index);
+                resubmit_count++;
+                continue;
+            }
+            if (cqe->res < 0) {
+                rl_log(RL_LOG_ERROR, "failed writing to file; %d message: %s",
+                       -cqe->res, strerror(-cqe->res));
+                if (writer->error == 0) {
+                    writer->error = -cqe->res;
+                }
+            }
+
+            request->segment_pending--;
+            if (request->segment_pending == 0) {
+                rl_writer_complete(writer, index);
+            }
+        }
+        __atomic_store_n(writer->cq_head, head, __ATOMIC_RELEASE);
+
+        // issue writes waiting for the completed ones
+        rl_writer_io_uring_issue(writer, resubmit_count);
+        pthread_mutex_unlock(&writer->mutex);
+    }
+
+    return NULL;
+}
+
+#endif
@@ -0,0 +1,305 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RL_WRITER_H_
+#define RL_WRITER_H_
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rl.h"
+
+/// Number of write buffers in the pool, bounding the writes in flight
+#define RL_WRITER_BUFFER_COUNT 8
+/// Alignment in bytes of the write buffers and of direct I/O file ranges
+#define RL_WRITER_ALIGNMENT 4096
+/// Number of worker threads of the thread pool backend
+#define RL_WRITER_THREAD_COUNT 2
+/// Maximum number of segments a write is split into for direct I/O
+#define RL_WRITER_SEGMENT_COUNT 3
+/// Number of io_uring submission queue entries (power of two)
+#define RL_WRITER_IO_URING_ENTRIES 32
+
+/**
+ * Asynchronous writer backends.
+ */
+enum rl_writer_backend {
+    RL_WRITER_BACKEND_IO_URING, /// Linux io_uring with registered buffers
+    RL_WRITER_BACKEND_THREAD,   /// Worker threads using positioned writes
+};
+
+/**
+ * Typedef for asynchronous writer backends.
+ */
+typedef enum rl_writer_backend rl_writer_backend_t;
+
+/**
+ * File written by the asynchronous writer.
+ */
+struct rl_writer_file {
+    /// File descriptor for buffered writes
+    int fd;
+    /// File descriptor opened with O_DIRECT for aligned writes (-1 if none)
+    int direct_fd;
+};
+
+/**
+ * Typedef for a file written by the asynchronous writer.
+ */
+typedef struct rl_writer_file rl_writer_file_t;
+
+/**
+ * Contiguous part of a write request issued as a single write.
+ */
+struct rl_writer_segment {
+    /// File descriptor to write to
+    int fd;
+    /// Data to write
+    uint8_t const *data;
+    /// Number of bytes to write
+    size_t length;
+    /// File offset to write the data at
+    uint64_t offset;
+};
+
+/**
+ * Typedef for a write request segment.
+ */
+typedef struct rl_writer_segment rl_writer_segment_t;
+
+/**
+ * Write request states.
+ */
+enum rl_writer_state {
+    RL_WRITER_STATE_FREE,      /// Buffer available
+    RL_WRITER_STATE_RESERVED,  /// Buffer handed out for filling
+    RL_WRITER_STATE_PENDING,   /// Submitted, waiting for earlier writes
+    RL_WRITER_STATE_IN_FLIGHT, /// Write issued to the kernel
+};
+
+/**
+ * Typedef for write request states.
+ */
+typedef enum rl_writer_state rl_writer_state_t;
+
+/**
+ * Write request, one per pool buffer.
+ */
+struct rl_writer_request {
+    /// Request state
+    rl_writer_state_t state;
+    /// Submission sequence number, requests to a file are issued in order
+    uint32_t sequence;
+    /// File descriptor identifying the file for ordering
+    int fd;
+    /// Segments to write
+    rl_writer_segment_t segment[RL_WRITER_SEGMENT_COUNT];
+    /// Number of segments
+    int segment_count;
+    /// Number of segments not yet completed
+    int segment_pending;
+    /// Submission time in nanoseconds (monotonic)
+    int64_t submit_time;
+};
+
+/**
+ * Typedef for a write request.
+ */
+typedef struct rl_writer_request rl_writer_request_t;
+
+/**
+ * Asynchronous writer with a pool of page aligned buffers.
+ *
+ * Writes to the same file are issued in submission order, one at a time, so
+ * overlapping writes (e.g. checkpoint records overwritten by the next data
+ * block) are safe. Writes to different files proceed concurrently.
+ */
+struct rl_writer {
+    /// Backend in use
+    rl_writer_backend_t backend;
+    /// Whether aligned ranges are written with direct I/O
+    bool direct_enable;
+    /// Size of a pool buffer in bytes
+    size_t buffer_size;
+    /// Pool buffers (RL_WRITER_BUFFER_COUNT times buffer_size bytes)
+    uint8_t *buffers;
+    /// Write requests (one per pool buffer)
+    rl_writer_request_t request[RL_WRITER_BUFFER_COUNT];
+    /// Sequence number of the next submitted request
+    uint32_t sequence;
+    /// Mutex protecting the requests, statistics and the submission queue
+    pthread_mutex_t mutex;
+    /// Condition signaling submitted requests to the worker threads
+    pthread_cond_t submitted;
+    /// Condition signaling completed requests
+    pthread_cond_t completed;
+    /// Worker threads (thread backend) or completion thread (io_uring)
+    pthread_t thread[RL_WRITER_THREAD_COUNT];
+    /// Number of threads started
+    int thread_count;
+    /// Whether the threads are requested to stop
+    bool stop;
+    /// Error number of the first failed write since the last flush (0 if none)
+    int error;
+    /// io_uring file descriptor (-1 if not used)
+    int ring_fd;
+    /// io_uring submission queue ring mapping
+    void *sq_ring;
+    /// Size of the submission queue ring mapping
+    size_t sq_ring_size;
+    /// io_uring completion queue ring mapping
+    void *cq_ring;
+    /// Size of the completion queue ring mapping
+    size_t cq_ring_size;
+    /// io_uring submission queue entries mapping
+    void *sqes;
+    /// io_uring submission queue head index
+    uint32_t *sq_head;
+    /// io_uring submission queue tail index
+    uint32_t *sq_tail;
+    /// io_uring submission queue index array
+    uint32_t *sq_array;
+    /// io_uring submission queue index mask
+    uint32_t sq_mask;
+    /// io_uring completion queue head index
+    uint32_t *cq_head;
+    /// io_uring completion queue tail index
+    uint32_t *cq_tail;
+    /// io_uring completion queue entries
+    void *cqes;
+    /// io_uring completion queue index mask
+    uint32_t cq_mask;
+    /// Number of requests pending or in flight
+    uint32_t queue_depth;
+    /// Maximum number of requests pending or in flight
+    uint32_t queue_depth_max;
+    /// Histogram of the time from submission to completion
+    uint32_t latency_histogram[RL_TIMING_HISTOGRAM_BINS];
+    /// Maximum time from submission to completion in microseconds
+    uint32_t latency_max;
+};
+
+/**
+ * Typedef for the asynchronous writer.
+ */
+typedef struct rl_writer rl_writer_t;
+
+/**
+ * Initialize the writer, allocate the buffer pool and start the backend.
+ *
+ * Falls back to the thread backend if io_uring is unavailable.
+ *
+ * @param writer The writer to initialize
+ * @param buffer_size Maximum number of bytes per write
+ * @param backend The preferred backend
+ * @param direct_enable Whether to write aligned ranges with direct I/O
+ * @return Returns 0 on success, negative on failure with errno set accordingly
+ */
+int rl_writer_init(rl_writer_t *const writer, size_t buffer_size,
+                   rl_writer_backend_t backend, bool direct_enable);
+
+/**
+ * Wait for pending writes, stop the backend and free the buffer pool.
+ *
+ * @param writer The writer to deinitialize
+ */
+void rl_writer_deinit(rl_writer_t *const writer);
+
+/**
+ * Set up a file for the writer.
+ *
+ * @param file The writer file to set up
+ * @param fd File descriptor for buffered writes
+ * @param file_name File name to open for direct I/O, NULL to disable
+ * @return Returns 0 on success, negative if direct I/O is not available for
+ * the file (buffered writes are used)
+ */
+int rl_writer_file_open(rl_writer_file_t *const file, int fd,
+                        char const *const file_name);
+
+/**
+ * Close the direct I/O file descriptor of a writer file.
+ *
+ * The file descriptor for buffered writes is owned by the caller.
+ *
+ * @param file The writer file to close
+ */
+void rl_writer_file_close(rl_writer_file_t *const file);
+
+/**
+ * Get a free buffer from the pool, waiting for a write to complete if all
+ * buffers are in use.
+ *
+ * For direct I/O the returned pointer is offset within the buffer such that
+ * its alignment matches the file offset.
+ *
+ * @param writer The writer to get the buffer from
+ * @param offset File offset the buffer is going to be written at
+ * @return Pointer to a buffer of at least the initialized buffer size
+ */
+uint8_t *rl_writer_get_buffer(rl_writer_t *const writer, uint64_t offset);
+
+/**
+ * Submit a buffer obtained from rl_writer_get_buffer() for writing.
+ *
+ * @param writer The writer to submit to
+ * @param file The file to write to
+ * @param data The buffer data to write
+ * @param length Number of bytes to write
+ * @param offset File offset to write the data at
+ * @return Returns 0 on success, negative if a previous write failed with
+ * errno set accordingly
+ */
+int rl_writer_submit(rl_writer_t *const writer,
+                     rl_writer_file_t const *const file, uint8_t *const data,
+                     size_t length, uint64_t offset);
+
+/**
+ * Wait for all submitted writes to complete.
+ *
+ * @param writer The writer to flush
+ * @return Returns 0 on success, negative if a write failed since the last
+ * flush with errno set accordingly
+ */
+int rl_writer_flush(rl_writer_t *const writer);
+
+/**
+ * Update the write queue depth and latency statistics of the status.
+ *
+ * @param writer The writer to get the statistics from
+ * @param status The status to update
+ */
+void rl_writer_update_status(rl_writer_t *const writer,
+                             rl_status_t *const status);
+
+#endif /* RL_WRITER_H_ */
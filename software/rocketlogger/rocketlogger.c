@@ -42,13 +42,20 @@
 
 #include "log.h"
 #include "rl.h"
+#include "rl_file.h"
 #include "rl_lib.h"
+#include "rl_recover.h"
 #include "version.h"
 
 /**
  * Number of arguments to parse
  */
-#define ARGP_ARGUMENTS_COUNT 1
+#define ARGP_ARGUMENTS_COUNT 2
+
+/**
+ * Number of required arguments
+ */
+#define ARGP_ARGUMENTS_REQUIRED 1
 
 #define OPT_FILE_SIZE 1
 
@@ -66,6 +73,38 @@
 
 #define OPT_STREAM 8
 
+#define OPT_PIPELINE 9
+
+#define OPT_BACKEND 10
+
+#define OPT_SIMULATION_FILE 11
+
+#define OPT_SIMULATION_REALTIME 12
+
+#define OPT_STATUS_RATE 13
+
+#define OPT_REALTIME 14
+
+#define OPT_HEADER_INTERVAL 15
+
+#define OPT_WRITER 16
+
+#define OPT_DIRECT 17
+
+#define OPT_COMPRESS 18
+
+#define OPT_PLANAR 19
+
+#define OPT_FIXED_WIDTH 20
+
+#define OPT_CRC 21
+
+#define OPT_WEB_RATE 22
+
+#define OPT_WEB_FULL_RATE 23
+
+#define OPT_SHM 24
+
 /**
  * Program version output for GNU standard command line format compliance.
  */
@@ -91,12 +130,17 @@ static char doc[] =
     "  Measurement configuration and status management:\n"
     "    config\tDisplay configuration, not starting a new or affecting a "
     "running measurement\n"
-    "    status\tDisplay the current sampling status\n";
+    "    status\tDisplay the current sampling status\n"
+    "\n"
+    "  Data file maintenance:\n"
+    "    recover\tVerify the data blocks of the RLD file FILE, truncate "
+    "damaged or partially written data blocks at its end and repair its "
+    "header\n";
 
 /**
  * List of arguments the program accepts
  */
-static char args_doc[] = "ACTION";
+static char args_doc[] = "ACTION [FILE]";
 
 /**
  * Summary of program options
@@ -126,9 +170,38 @@ static struct argp_option options[] = {
 
     {0, 0, 0, OPTION_DOC,
      "Measurement configuration options for storing measurement files:", 3},
-    {"format", 'f', "FORMAT", 0, "Select file format: 'csv', 'rld'.", 0},
+    {"format", 'f', "FORMAT", 0,
+     "Select file format: 'csv', 'rld', 'arrow'.", 0},
     {"size", OPT_FILE_SIZE, "SIZE", 0,
      "Select max file size (k, M, G, T scaling suffixes can be used).", 0},
+    {"header-interval", OPT_HEADER_INTERVAL, "SECONDS", 0,
+     "Interval in seconds for updating the sample count in the file header. "
+     "Use zero to update on every data block. 1 second per default.",
+     0},
+    {"writer", OPT_WRITER, "WRITER", 0,
+     "Select file writer: 'stdio' (default), 'async' for asynchronous writes "
+     "using io_uring or writer threads (RLD format only).",
+     0},
+    {"direct", OPT_DIRECT, "BOOL", OPTION_ARG_OPTIONAL,
+     "Write aligned file ranges using direct I/O, bypassing the page cache "
+     "(asynchronous writer only).",
+     0},
+    {"compress", OPT_COMPRESS, "BOOL", OPTION_ARG_OPTIONAL,
+     "Store data blocks compressed using delta encoding and bit-packing "
+     "(RLD format only).",
+     0},
+    {"planar", OPT_PLANAR, "BOOL", OPTION_ARG_OPTIONAL,
+     "Store each channel of a data block contiguously for fast single channel "
+     "reads (RLD format only).",
+     0},
+    {"crc", OPT_CRC, "BOOL", OPTION_ARG_OPTIONAL,
+     "Store a CRC-32C checksum with each data block, allowing to verify "
+     "blocks when recovering damaged files (RLD format only).",
+     0},
+    {"fixed-width", OPT_FIXED_WIDTH, "BOOL", OPTION_ARG_OPTIONAL,
+     "Pad data rows to a fixed width, allowing to split and parse files in "
+     "parallel (CSV format only).",
+     0},
     {"comment", 'C', "COMMENT", 0, "Comment stored in file header. Comment is "
                                    "ignored if file saving is disabled.",
      0},
@@ -168,14 +241,57 @@ static struct argp_option options[] = {
      "Enabled per default.",
      0},
     {"stream", OPT_STREAM, 0, OPTION_ALIAS, 0, 0},
+    {"web-rate", OPT_WEB_RATE, "RATE", 0,
+     "Rate in Hz of the min/max/mean envelopes plotted by the web interface, "
+     "one of 10, 1000 or 10000. 1000 Hz per default.",
+     0},
+    {"web-full-rate", OPT_WEB_FULL_RATE, "BOOL", OPTION_ARG_OPTIONAL,
+     "Publish all samples at the full sample rate for the web interface "
+     "instead of envelopes. Disabled per default.",
+     0},
+    {"shm", OPT_SHM, "BOOL", OPTION_ARG_OPTIONAL,
+     "Write the calibrated data at full rate to a shared memory ring for "
+     "local data readers. Disabled per default.",
+     0},
+    {"pipeline", OPT_PIPELINE, "BOOL", OPTION_ARG_OPTIONAL,
+     "Enable pipelined data processing, where storing, streaming and "
+     "displaying data is decoupled from sampling using dedicated threads. "
+     "Disabled per default.",
+     0},
+    {"realtime", OPT_REALTIME, "BOOL", OPTION_ARG_OPTIONAL,
+     "Sample with real-time profile: real-time scheduling priority and "
+     "locked memory for the sampling thread. Requires pipelined processing. "
+     "Disabled per default.",
+     0},
+    {"status-rate", OPT_STATUS_RATE, "RATE", 0,
+     "Status update rate in Hz for disk space polling and status publishing, "
+     "independent of the data update rate. 1 Hz per default.",
+     0},
+
+    {0, 0, 0, OPTION_DOC,
+     "Data acquisition backend options for development and profiling:", 6},
+    {"backend", OPT_BACKEND, "BACKEND", 0,
+     "Select data acquisition backend: 'pru' for the PRU and ADC hardware, "
+     "'simulation' for a software simulation not requiring the hardware. PRU "
+     "per default.",
+     0},
+    {"simulation-file", OPT_SIMULATION_FILE, "FILE", 0,
+     "RLD file to replay in simulation. Use zero to simulate synthetic "
+     "waveforms (default).",
+     0},
+    {"simulation-realtime", OPT_SIMULATION_REALTIME, "BOOL",
+     OPTION_ARG_OPTIONAL,
+     "Simulate data at the configured sample rate. If disabled, data is "
+     "simulated as fast as it is processed. Enabled per default.",
+     0},
 
     {0, 0, 0, OPTION_DOC, "Optional arguments for status and config actions:",
-     6},
+     7},
     {"json", OPT_JSON, 0, 0,
      "Print configuration or status as JSON formatted string.", 0},
     {"cli", OPT_CLI, 0, 0, "Print configuration as full CLI command.", 0},
 
-    {0, 0, 0, OPTION_DOC, "Generic program switches:", 7},
+    {0, 0, 0, OPTION_DOC, "Generic program switches:", 8},
     {"verbose", 'v', 0, 0, "Produce verbose output", 0},
     {"quiet", 'q', 0, 0, "Do not produce any output", 0},
     {"silent", 's', 0, OPTION_ALIAS, 0, 0},
@@ -293,11 +409,18 @@ int main(int argc, char *argv[]) {
     // validate arguments
     bool valid_action =
         (strcmp(action, "start") == 0 || strcmp(action, "stop") == 0 ||
-         strcmp(action, "config") == 0 || strcmp(action, "status") == 0);
+         strcmp(action, "config") == 0 || strcmp(action, "status") == 0 ||
+         strcmp(action, "recover") == 0);
     if (!valid_action) {
         rl_log(RL_LOG_ERROR, "unknown action '%s'", action);
         exit(EXIT_FAILURE);
     }
+    char const *const file_name = arguments.args[1];
+    if ((strcmp(action, "recover") == 0) != (file_name != NULL)) {
+        rl_log(RL_LOG_ERROR, "the FILE argument is required for and only "
+                             "allowed with the recover action.");
+        exit(EXIT_FAILURE);
+    }
 
     if (arguments.cli && arguments.json) {
         rl_log(RL_LOG_ERROR, "cannot format in output as JSON and and CLI "
@@ -381,6 +504,21 @@ int main(int argc, char *argv[]) {
             rl_status_print(&status);
         }
     }
+    if (strcmp(action, "recover") == 0) {
+        rl_recover_report_t report;
+        int res = rl_recover_file(
+            file_name, rl_file_get_index_file_name(file_name), &report);
+        if (res < 0) {
+            rl_log(RL_LOG_ERROR, "Failed recovering data file '%s'.\n",
+                   file_name);
+            exit(EXIT_FAILURE);
+        }
+        if (arguments.json) {
+            rl_recover_print_json(&report);
+        } else if (!arguments.silent) {
+            rl_recover_print(&report);
+        }
+    }
     exit(EXIT_SUCCESS);
 }
 
@@ -451,6 +589,8 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
             config->file_format = RL_FILE_FORMAT_CSV;
         } else if (strcmp(arg, "rld") == 0 || strcmp(arg, "RLD") == 0) {
             config->file_format = RL_FILE_FORMAT_RLD;
+        } else if (strcmp(arg, "arrow") == 0 || strcmp(arg, "ARROW") == 0) {
+            config->file_format = RL_FILE_FORMAT_ARROW;
         } else {
             argp_usage(state);
         }
@@ -514,6 +654,60 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
         /* maximum file size: mandatory SIZE value */
         parse_uint64(arg, state, &config->file_size);
         break;
+    case OPT_HEADER_INTERVAL:
+        /* file header update interval: mandatory SECONDS value */
+        parse_uint32(arg, state, &config->file_header_interval);
+        break;
+    case OPT_WRITER:
+        /* file writer: mandatory WRITER value */
+        if (strcmp(arg, "stdio") == 0) {
+            config->file_writer = RL_FILE_WRITER_STDIO;
+        } else if (strcmp(arg, "async") == 0) {
+            config->file_writer = RL_FILE_WRITER_ASYNC;
+        } else {
+            argp_usage(state);
+        }
+        break;
+    case OPT_DIRECT:
+        /* direct I/O: optional BOOL value */
+        if (arg != NULL) {
+            parse_bool(arg, state, &config->file_direct_enable);
+        } else {
+            config->file_direct_enable = true;
+        }
+        break;
+    case OPT_COMPRESS:
+        /* compression: optional BOOL value */
+        if (arg != NULL) {
+            parse_bool(arg, state, &config->file_compress_enable);
+        } else {
+            config->file_compress_enable = true;
+        }
+        break;
+    case OPT_PLANAR:
+        /* planar layout: optional BOOL value */
+        if (arg != NULL) {
+            parse_bool(arg, state, &config->file_planar_enable);
+        } else {
+            config->file_planar_enable = true;
+        }
+        break;
+    case OPT_CRC:
+        /* data block checksum: optional BOOL value */
+        if (arg != NULL) {
+            parse_bool(arg, state, &config->file_crc_enable);
+        } else {
+            config->file_crc_enable = true;
+        }
+        break;
+    case OPT_FIXED_WIDTH:
+        /* fixed width data rows: optional BOOL value */
+        if (arg != NULL) {
+            parse_bool(arg, state, &config->file_fixed_width_enable);
+        } else {
+            config->file_fixed_width_enable = true;
+        }
+        break;
     case OPT_CLI:
         /* CLI format the config output: no value */
         arguments->cli = true;
@@ -534,6 +728,72 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
         /* perform calibration measurement: no value */
         config->calibration_ignore = true;
         break;
+    case OPT_PIPELINE:
+        /* pipelined data processing: optional BOOL value */
+        if (arg != NULL) {
+            parse_bool(arg, state, &config->pipeline_enable);
+        } else {
+            config->pipeline_enable = true;
+        }
+        break;
+    case OPT_REALTIME:
+        /* real-time profile: optional BOOL value */
+        if (arg != NULL) {
+            parse_bool(arg, state, &config->realtime_enable);
+        } else {
+            config->realtime_enable = true;
+        }
+        break;
+    case OPT_WEB_RATE:
+        /* web data stream rate: mandatory RATE value */
+        parse_uint32(arg, state, &config->web_rate);
+        break;
+    case OPT_WEB_FULL_RATE:
+        /* full rate web data stream: optional BOOL value */
+        if (arg != NULL) {
+            parse_bool(arg, state, &config->web_full_rate_enable);
+        } else {
+            config->web_full_rate_enable = true;
+        }
+        break;
+    case OPT_SHM:
+        /* data shared memory ring: optional BOOL value */
+        if (arg != NULL) {
+            parse_bool(arg, state, &config->shm_enable);
+        } else {
+            config->shm_enable = true;
+        }
+        break;
+    case OPT_STATUS_RATE:
+        /* status update rate: mandatory RATE value */
+        parse_uint32(arg, state, &config->status_rate);
+        break;
+    case OPT_BACKEND:
+        /* data acquisition backend: mandatory BACKEND value */
+        if (strcmp(arg, "pru") == 0) {
+            config->backend = RL_BACKEND_PRU;
+        } else if (strcmp(arg, "simulation") == 0) {
+            config->backend = RL_BACKEND_SIMULATION;
+        } else {
+            argp_usage(state);
+        }
+        break;
+    case OPT_SIMULATION_FILE:
+        /* simulation replay file: mandatory FILE value */
+        if (strlen(arg) == 1 && arg[0] == '0') {
+            config->simulation_file[0] = 0;
+        } else {
+            strncpy(config->simulation_file, arg, PATH_MAX - 1);
+        }
+        break;
+    case OPT_SIMULATION_REALTIME:
+        /* real-time simulation: optional BOOL value */
+        if (arg != NULL) {
+            parse_bool(arg, state, &config->simulation_realtime);
+        } else {
+            config->simulation_realtime = true;
+        }
+        break;
 
     /* unnamed argument options */
     case ARGP_KEY_ARG:
@@ -545,7 +805,7 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
         break;
     case ARGP_KEY_END:
         // check for not enough arguments
-        if (state->arg_num < ARGP_ARGUMENTS_COUNT) {
+        if (state->arg_num < ARGP_ARGUMENTS_REQUIRED) {
             argp_usage(state);
         }
         break;
@@ -0,0 +1,301 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../calibration.h"
+#include "../log.h"
+#include "../rl.h"
+#include "test.h"
+
+/// Number of samples per test buffer
+#define TEST_BUFFER_LENGTH 4096
+/// Half range of the values tested exhaustively
+#define TEST_VALUE_RANGE (1 << 20)
+/// Number of random values tested
+#define TEST_RANDOM_COUNT (1 << 20)
+/// Number of values tested close to integer calibration results
+#define TEST_BOUNDARY_COUNT (1 << 18)
+/// Number of random calibrations tested
+#define TEST_CALIBRATION_COUNT 8
+/// ADC value range in bits
+#define TEST_ADC_BITS 24
+
+/// Status referenced by the calibration module
+rl_status_t rl_status;
+
+/// Channel offsets of the default calibration file
+static int const DEFAULT_OFFSETS[RL_CHANNEL_COUNT] = {0, 0, 0, 0, 0,
+                                                      0, 0, 0, 12};
+
+/// Channel scales of the default calibration file
+static double const DEFAULT_SCALES[RL_CHANNEL_COUNT] = {
+    -122.26593800080128, -122.26593800080128, -122.26593800080128,
+    -122.26593800080128, 17.53077787511489,   31.789143880208332,
+    17.53077787511489,   31.789143880208332,  5.0};
+
+/// PRU data test buffer
+static pru_data_t pru_data[TEST_BUFFER_LENGTH];
+/// Calibrated analog test buffer
+static int32_t analog_buffer[TEST_BUFFER_LENGTH * RL_CHANNEL_COUNT];
+/// Digital test buffer
+static uint32_t digital_buffer[TEST_BUFFER_LENGTH];
+
+/// State of the pseudo random number generator
+static uint64_t random_state = 1;
+
+/**
+ * Get a pseudo random number.
+ *
+ * @return 32 bit pseudo random number
+ */
+static uint32_t random_next(void) {
+    random_state =
+        random_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(random_state >> 32);
+}
+
+/**
+ * Get a pseudo random ADC value.
+ *
+ * @return Signed value of the ADC range
+ */
+static int32_t random_adc_value(void) {
+    return ((int32_t)random_next()) >> (32 - TEST_ADC_BITS);
+}
+
+/**
+ * Set the calibration under test.
+ *
+ * @param offsets The channel offsets
+ * @param scales The channel scales
+ */
+static void calibration_set(int const *const offsets,
+                            double const *const scales) {
+    for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+        rl_calibration.offsets[j] = offsets[j];
+        rl_calibration.scales[j] = scales[j];
+    }
+    calibration_update_fixed_point();
+}
+
+/**
+ * Calibrate the PRU test buffer and compare with the double precision
+ * reference.
+ *
+ * @param buffer_size Number of samples in the PRU test buffer
+ * @param config The configuration with the enabled channels
+ * @return Number of mismatching values
+ */
+static int calibration_compare(size_t buffer_size,
+                               rl_config_t const *const config) {
+    int mismatches = 0;
+
+    calibration_apply(analog_buffer, digital_buffer, pru_data, buffer_size,
+                      config);
+
+    for (size_t i = 0; i < buffer_size; i++) {
+        if (digital_buffer[i] != pru_data[i].channel_digital) {
+            mismatches++;
+        }
+        for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+            int32_t expected = 0;
+            if (config->channel_enable[j]) {
+                expected = (int32_t)((pru_data[i].channel_analog[j] +
+                                      rl_calibration.offsets[j]) *
+                                     rl_calibration.scales[j]);
+            }
+            if (analog_buffer[j * buffer_size + i] != expected) {
+                if (mismatches < 10) {
+                    fprintf(stderr,
+                            "channel %d value %d scale %.17g: got %d, "
+                            "expected %d\n",
+                            j, pru_data[i].channel_analog[j],
+                            rl_calibration.scales[j],
+                            analog_buffer[j * buffer_size + i], expected);
+                }
+                mismatches++;
+            }
+        }
+    }
+
+    return mismatches;
+}
+
+/**
+ * Test the calibration of all values in a range around zero.
+ *
+ * @param config The configuration with the enabled channels
+ * @return Number of mismatching values
+ */
+static int test_range(rl_config_t const *const config) {
+    int mismatches = 0;
+    size_t count = 0;
+
+    for (int32_t value = -TEST_VALUE_RANGE; value < TEST_VALUE_RANGE;
+         value++) {
+        pru_data[count].channel_digital = (uint32_t)value;
+        for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+            pru_data[count].channel_analog[j] = value;
+        }
+        count++;
+        if (count == TEST_BUFFER_LENGTH) {
+            mismatches += calibration_compare(count, config);
+            count = 0;
+        }
+    }
+
+    return mismatches + calibration_compare(count, config);
+}
+
+/**
+ * Test the calibration of random values of the full ADC range.
+ *
+ * @param config The configuration with the enabled channels
+ * @return Number of mismatching values
+ */
+static int test_random(rl_config_t const *const config) {
+    int mismatches = 0;
+
+    for (int n = 0; n < TEST_RANDOM_COUNT / TEST_BUFFER_LENGTH; n++) {
+        for (size_t i = 0; i < TEST_BUFFER_LENGTH; i++) {
+            pru_data[i].channel_digital = random_next();
+            for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+                pru_data[i].channel_analog[j] = random_adc_value();
+            }
+        }
+        mismatches += calibration_compare(TEST_BUFFER_LENGTH, config);
+    }
+
+    return mismatches;
+}
+
+/**
+ * Test the calibration of values with results close to integers.
+ *
+ * @param config The configuration with the enabled channels
+ * @return Number of mismatching values
+ */
+static int test_boundary(rl_config_t const *const config) {
+    int mismatches = 0;
+
+    for (int n = 0; n < TEST_BOUNDARY_COUNT / TEST_BUFFER_LENGTH; n++) {
+        for (size_t i = 0; i < TEST_BUFFER_LENGTH; i++) {
+            pru_data[i].channel_digital = 0;
+            for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+                // value closest to a random integer result, then neighbors
+                double const target =
+                    (double)random_adc_value() * fabs(rl_calibration.scales[j]);
+                double value = 0;
+                if (rl_calibration.scales[j] != 0) {
+                    value = nearbyint(target / rl_calibration.scales[j]);
+                }
+                value += (int)(random_next() % 3) - 1;
+                if (fabs(value) >= (1 << (TEST_ADC_BITS - 1))) {
+                    value = 0;
+                }
+                pru_data[i].channel_analog[j] =
+                    (int32_t)value - rl_calibration.offsets[j];
+            }
+        }
+        mismatches += calibration_compare(TEST_BUFFER_LENGTH, config);
+    }
+
+    return mismatches;
+}
+
+/**
+ * Run all value tests for the current calibration.
+ *
+ * @param config The configuration with the enabled channels
+ */
+static void test_calibration(rl_config_t const *const config) {
+    CHECK(test_range(config) == 0);
+    CHECK(test_random(config) == 0);
+    CHECK(test_boundary(config) == 0);
+}
+
+int main(void) {
+    rl_log_init("/dev/null", RL_LOG_IGNORE);
+
+    rl_config_t config;
+    memset(&config, 0, sizeof(config));
+    for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+        config.channel_enable[j] = true;
+    }
+
+    // default calibration file
+    calibration_set(DEFAULT_OFFSETS, DEFAULT_SCALES);
+    test_calibration(&config);
+
+    // reset calibration with exact unit scales
+    calibration_reset_offsets();
+    calibration_reset_scales();
+    test_calibration(&config);
+
+    // random calibrations with scales of different magnitudes and signs
+    for (int n = 0; n < TEST_CALIBRATION_COUNT; n++) {
+        int offsets[RL_CHANNEL_COUNT];
+        double scales[RL_CHANNEL_COUNT];
+        for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+            offsets[j] = random_adc_value() >> 8;
+            scales[j] = ldexp((double)random_next() / UINT32_MAX + 0.5,
+                              (int)(random_next() % 16) - 8);
+            if (random_next() % 2) {
+                scales[j] = -scales[j];
+            }
+        }
+        // scales with a short or without binary fraction
+        scales[0] = 0;
+        scales[1] = 1.0 / 3.0;
+        scales[2] = 0.5 + ldexp(1, -40);
+        scales[3] = -ldexp(1, -10);
+        calibration_set(offsets, scales);
+        test_calibration(&config);
+    }
+
+    // disabled channels are not calibrated and set to zero
+    calibration_set(DEFAULT_OFFSETS, DEFAULT_SCALES);
+    for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+        config.channel_enable[j] = (j % 3 != 1);
+    }
+    test_calibration(&config);
+    for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+        config.channel_enable[j] = (j == RL_CONFIG_CHANNEL_I1L);
+    }
+    test_calibration(&config);
+
+    return test_result();
+}
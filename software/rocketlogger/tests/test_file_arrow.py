@@ -0,0 +1,75 @@
+"""
+RocketLogger Arrow file format conformance tests
+* sample the simulated input once to RLD and once to an Arrow IPC file
+* compare the Arrow data and channel metadata against the RLD data
+"""
+
+import numpy as np
+import pytest
+import rocketlogger_cli as cli
+from rocketlogger.data import RocketLoggerData
+
+pa = pytest.importorskip("pyarrow")
+ipc = pytest.importorskip("pyarrow.ipc")
+
+
+@pytest.fixture
+def simulation_config(tmpdir):
+    config = cli.getDefaultConfig()
+    config["output"] = tmpdir.join("test.rld")
+    config["backend"] = "simulation"
+    config["simulation-realtime"] = False
+    yield config
+
+
+def sample_compare_assert(config):
+    result = cli.runMeasurement(config)
+    assert result.returncode == 0
+    data = RocketLoggerData(config["output"])
+
+    config["output"] = config["output"].new(ext="arrow")
+    config["format"] = "arrow"
+    result = cli.runMeasurement(config)
+    assert result.returncode == 0
+    reader = ipc.open_file(pa.memory_map(str(config["output"])))
+    table = reader.read_all()
+
+    assert reader.num_record_batches == data.get_header()["data_block_count"]
+    assert table.num_rows == config["samples"]
+    assert int(table.schema.metadata[b"sample_rate"]) == config["rate"]
+    assert sorted(table.column_names) == sorted(data.get_channel_names())
+
+    for name in table.column_names:
+        metadata = table.schema.field(name).metadata
+        values = table.column(name).to_numpy(zero_copy_only=False)
+        if pa.types.is_boolean(table.schema.field(name).type):
+            assert np.array_equal(values, data.get_data(name).squeeze() > 0)
+        else:
+            assert metadata[b"unit"].decode() in ["V", "A", "s"]
+            values = values * 10.0 ** int(metadata[b"scale"])
+            assert np.allclose(values, data.get_data(name).squeeze())
+
+
+@pytest.mark.parametrize("rate", [100, 1000, 64000])
+def test_arrow_default(simulation_config, rate):
+    simulation_config["rate"] = rate
+    simulation_config["samples"] = 5 * rate
+    sample_compare_assert(simulation_config)
+
+
+@pytest.mark.parametrize("rate", [1000, 64000])
+def test_arrow_voltage_only(simulation_config, rate):
+    simulation_config["rate"] = rate
+    simulation_config["samples"] = 5 * rate
+    simulation_config["channel"] = cli.channels_voltage
+    simulation_config["digital"] = False
+    sample_compare_assert(simulation_config)
+
+
+@pytest.mark.parametrize("rate", [1000, 64000])
+def test_arrow_current_only(simulation_config, rate):
+    simulation_config["rate"] = rate
+    simulation_config["samples"] = 5 * rate
+    simulation_config["channel"] = cli.channels_current
+    simulation_config["digital"] = False
+    sample_compare_assert(simulation_config)
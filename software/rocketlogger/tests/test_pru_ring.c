@@ -0,0 +1,270 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../pru.h"
+#include "../pru_ring.h"
+#include "test.h"
+
+/// Number of buffers in the test ring
+#define TEST_BUFFER_COUNT 4
+/// Number of data elements per test buffer
+#define TEST_BUFFER_LENGTH 16
+
+/// The PRU control structure describing the test ring layout
+static pru_control_t pru_control;
+
+/// Shared memory backing the test ring
+static void *ring_memory = NULL;
+
+/**
+ * Initialize a test ring backed by heap memory.
+ *
+ * @param ring The ring to initialize
+ */
+static void ring_setup(pru_ring_t *const ring) {
+    pru_control.buffer_length = TEST_BUFFER_LENGTH;
+    pru_control.buffer_count = TEST_BUFFER_COUNT;
+    pru_control.buffer_size =
+        TEST_BUFFER_LENGTH *
+            (PRU_SAMPLE_SIZE * RL_CHANNEL_COUNT + PRU_DIGITAL_SIZE) +
+        PRU_BUFFER_STATUS_SIZE;
+
+    free(ring_memory);
+    ring_memory = malloc(pru_control.buffer_count * pru_control.buffer_size);
+    memset(ring_memory, 0, pru_control.buffer_count * pru_control.buffer_size);
+    pru_ring_init(ring, ring_memory, &pru_control);
+}
+
+/**
+ * Produce a buffer with data derived from the buffer index.
+ *
+ * @param ring The ring to write to
+ * @param index The buffer index to write
+ */
+static void produce(pru_ring_t *const ring, uint32_t index) {
+    pru_data_t data[TEST_BUFFER_LENGTH];
+    for (uint32_t i = 0; i < TEST_BUFFER_LENGTH; i++) {
+        data[i].channel_digital = index;
+        for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+            data[i].channel_analog[j] = (int32_t)(index * 1000 + i * 10 + j);
+        }
+    }
+    pru_ring_write_buffer(ring, index, data);
+}
+
+/**
+ * Check a buffer holds the data produced for a buffer index.
+ *
+ * @param buffer The buffer to check
+ * @param index The expected buffer index
+ * @return 1 if the buffer content matches, 0 otherwise
+ */
+static int buffer_matches(pru_buffer_t const *const buffer, uint32_t index) {
+    if (buffer->index != index || buffer->sequence != index) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < TEST_BUFFER_LENGTH; i++) {
+        if (buffer->data[i].channel_digital != index ||
+            buffer->data[i].channel_analog[RL_CHANNEL_COUNT - 1] !=
+                (int32_t)(index * 1000 + i * 10 + RL_CHANNEL_COUNT - 1)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void test_empty_ring(void) {
+    pru_ring_t ring;
+    ring_setup(&ring);
+
+    uint32_t index = 0;
+    uint32_t lost = 0;
+    CHECK(pru_ring_check(&ring, &index, &lost) == NULL);
+    CHECK(index == 0);
+    CHECK(lost == 0);
+}
+
+static void test_sequential(void) {
+    pru_ring_t ring;
+    ring_setup(&ring);
+
+    uint32_t lost = 0;
+    for (uint32_t i = 0; i < 5 * TEST_BUFFER_COUNT; i++) {
+        uint32_t index = i;
+        produce(&ring, i);
+        pru_buffer_t const *buffer = pru_ring_check(&ring, &index, &lost);
+        CHECK(buffer != NULL);
+        CHECK(index == i);
+        CHECK(buffer != NULL && buffer_matches(buffer, i));
+        CHECK(pru_ring_validate(&ring, i) == 0);
+
+        // next buffer is not available yet
+        index = i + 1;
+        CHECK(pru_ring_check(&ring, &index, &lost) == NULL);
+        CHECK(index == i + 1);
+    }
+    CHECK(lost == 0);
+}
+
+static void test_backlog(void) {
+    pru_ring_t ring;
+    ring_setup(&ring);
+
+    // fill the whole ring before consuming
+    for (uint32_t i = 0; i < TEST_BUFFER_COUNT; i++) {
+        produce(&ring, i);
+    }
+
+    uint32_t lost = 0;
+    for (uint32_t i = 0; i < TEST_BUFFER_COUNT; i++) {
+        uint32_t index = i;
+        pru_buffer_t const *buffer = pru_ring_check(&ring, &index, &lost);
+        CHECK(buffer != NULL && buffer_matches(buffer, i));
+        CHECK(index == i);
+    }
+    CHECK(lost == 0);
+}
+
+static void test_in_progress(void) {
+    pru_ring_t ring;
+    ring_setup(&ring);
+
+    // buffer started but not completed is not available
+    pru_ring_write_start(&ring, 0);
+    uint32_t index = 0;
+    uint32_t lost = 0;
+    CHECK(pru_ring_check(&ring, &index, &lost) == NULL);
+
+    pru_ring_write_complete(&ring, 0);
+    CHECK(pru_ring_check(&ring, &index, &lost) != NULL);
+    CHECK(lost == 0);
+}
+
+static void test_overrun(void) {
+    pru_ring_t ring;
+    ring_setup(&ring);
+
+    // producer laps the consumer by more than the ring size
+    uint32_t const produced = 2 * TEST_BUFFER_COUNT + 1;
+    for (uint32_t i = 0; i < produced; i++) {
+        produce(&ring, i);
+    }
+
+    uint32_t index = 0;
+    uint32_t lost = 0;
+    pru_buffer_t const *buffer = pru_ring_check(&ring, &index, &lost);
+    CHECK(buffer != NULL);
+    CHECK(index == produced - TEST_BUFFER_COUNT);
+    CHECK(lost == produced - TEST_BUFFER_COUNT);
+    CHECK(buffer != NULL && buffer_matches(buffer, index));
+
+    // remaining buffers are consumed without further loss
+    for (index++; index < produced; index++) {
+        uint32_t expected = index;
+        buffer = pru_ring_check(&ring, &index, &lost);
+        CHECK(buffer != NULL && buffer_matches(buffer, expected));
+    }
+    CHECK(lost == produced - TEST_BUFFER_COUNT);
+}
+
+static void test_overrun_in_progress(void) {
+    pru_ring_t ring;
+    ring_setup(&ring);
+
+    // producer overwrites the slot of the requested buffer, still writing
+    for (uint32_t i = 0; i < TEST_BUFFER_COUNT; i++) {
+        produce(&ring, i);
+    }
+    pru_ring_write_start(&ring, TEST_BUFFER_COUNT);
+
+    uint32_t index = 0;
+    uint32_t lost = 0;
+    pru_buffer_t const *buffer = pru_ring_check(&ring, &index, &lost);
+    CHECK(buffer != NULL && buffer_matches(buffer, 1));
+    CHECK(index == 1);
+    CHECK(lost == 1);
+}
+
+static void test_overwrite_while_processing(void) {
+    pru_ring_t ring;
+    ring_setup(&ring);
+
+    produce(&ring, 0);
+    uint32_t index = 0;
+    uint32_t lost = 0;
+    CHECK(pru_ring_check(&ring, &index, &lost) != NULL);
+
+    // producer laps and starts overwriting buffer being processed
+    for (uint32_t i = 1; i < TEST_BUFFER_COUNT; i++) {
+        produce(&ring, i);
+    }
+    pru_ring_write_start(&ring, TEST_BUFFER_COUNT);
+    CHECK(pru_ring_validate(&ring, 0) < 0);
+}
+
+static void test_index_wrap(void) {
+    pru_ring_t ring;
+    ring_setup(&ring);
+
+    // buffer index wrap around at 32 bit, ring slots stay consistent
+    uint32_t const start = UINT32_MAX - 2 * TEST_BUFFER_COUNT;
+    uint32_t lost = 0;
+    for (uint32_t i = start; i != start + 4 * TEST_BUFFER_COUNT; i++) {
+        if (i == PRU_BUFFER_INDEX_INVALID) {
+            continue;
+        }
+        uint32_t index = i;
+        produce(&ring, i);
+        pru_buffer_t const *buffer = pru_ring_check(&ring, &index, &lost);
+        CHECK(buffer != NULL && buffer_matches(buffer, i));
+    }
+    CHECK(lost == 0);
+}
+
+int main(void) {
+    test_empty_ring();
+    test_sequential();
+    test_backlog();
+    test_in_progress();
+    test_overrun();
+    test_overrun_in_progress();
+    test_overwrite_while_processing();
+    test_index_wrap();
+
+    free(ring_memory);
+
+    return test_result();
+}
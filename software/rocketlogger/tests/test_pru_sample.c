@@ -0,0 +1,195 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../calibration.h"
+#include "../log.h"
+#include "../pru.h"
+#include "../rl.h"
+#include "../rl_file.h"
+#include "test.h"
+
+/// Number of file parts of the test measurement
+#define TEST_FILE_PARTS 3
+
+/// Whether finishing a file fails when trimming it
+static bool trim_fail = false;
+
+/// Number of trimmed files
+static int trim_count = 0;
+
+/**
+ * The wrapped file trim function (linked with --wrap=rl_file_trim).
+ */
+int __real_rl_file_trim(FILE *file_handle);
+
+/**
+ * File trim wrapper failing on request.
+ */
+int __wrap_rl_file_trim(FILE *file_handle) {
+    trim_count++;
+    if (trim_fail) {
+        return ERROR;
+    }
+    return __real_rl_file_trim(file_handle);
+}
+
+/// Directory of the test measurement files
+static char test_dir[] = "/tmp/rl_test_pru_sample_XXXXXX";
+
+/**
+ * Check whether a file exists.
+ */
+static bool file_exists(char const *const file_name) {
+    return access(file_name, F_OK) == 0;
+}
+
+/**
+ * Run a simulated measurement split into file parts.
+ *
+ * @param config The measurement configuration to set up
+ * @return The result of the measurement
+ */
+static int run_measurement(rl_config_t *const config) {
+    rl_config_reset(config);
+    config->backend = RL_BACKEND_SIMULATION;
+    config->simulation_realtime = false;
+    config->sample_rate = 64000;
+    config->update_rate = 10;
+    config->web_enable = false;
+    config->ambient_enable = false;
+    config->file_size = RL_CONFIG_FILE_SIZE_MIN;
+    snprintf(config->file_name, sizeof(config->file_name), "%s/data.rld",
+             test_dir);
+
+    // samples for the number of parts, each slightly below the maximum size
+    uint64_t const sample_size =
+        (RL_CHANNEL_COUNT + 1) * sizeof(int32_t);
+    config->sample_limit =
+        TEST_FILE_PARTS * RL_CONFIG_FILE_SIZE_MIN / sample_size;
+
+    rl_status_reset(&rl_status);
+    rl_status.disk_use_rate = 0;
+    trim_count = 0;
+    calibration_reset_offsets();
+    calibration_reset_scales();
+
+    int res = pru_init(config);
+    CHECK(res == SUCCESS);
+    FILE *data_file = fopen64(config->file_name, "w+");
+    CHECK(data_file != NULL);
+    if (res < 0 || data_file == NULL) {
+        return ERROR;
+    }
+
+    res = pru_sample(data_file, NULL, config);
+
+    fclose(data_file);
+    pru_deinit();
+    return res;
+}
+
+/**
+ * Remove the measurement files of a test.
+ */
+static void remove_files(rl_config_t const *const config) {
+    char file_name[PATH_MAX];
+    unlink(config->file_name);
+    for (int i = 1; i <= TEST_FILE_PARTS + 1; i++) {
+        rl_file_get_part_file_name(file_name, config->file_name, i);
+        unlink(file_name);
+    }
+}
+
+static void test_split(void) {
+    rl_config_t config;
+    trim_fail = false;
+    int res = run_measurement(&config);
+    CHECK(res == SUCCESS);
+    CHECK(!rl_status.error);
+    CHECK(rl_status.sample_count == config.sample_limit);
+
+    // all parts are finished, no unused prepared part is left
+    char file_name[PATH_MAX];
+    int parts = 1;
+    do {
+        rl_file_get_part_file_name(file_name, config.file_name, parts);
+        parts++;
+    } while (file_exists(file_name) && parts <= TEST_FILE_PARTS + 1);
+    parts--;
+    CHECK(parts >= TEST_FILE_PARTS);
+    CHECK(parts <= TEST_FILE_PARTS + 1);
+    CHECK(!file_exists(file_name));
+    CHECK(trim_count == parts);
+
+    remove_files(&config);
+}
+
+static void test_split_finish_failure(void) {
+    rl_config_t config;
+    trim_fail = true;
+    int res = run_measurement(&config);
+
+    // sampling stops with error on the first file rollover
+    CHECK(res == ERROR);
+    CHECK(rl_status.error);
+    CHECK(rl_status.sample_count < config.sample_limit);
+    CHECK(file_exists(config.file_name));
+
+    // the already opened next part is removed
+    char file_name[PATH_MAX];
+    rl_file_get_part_file_name(file_name, config.file_name, 1);
+    CHECK(!file_exists(file_name));
+
+    remove_files(&config);
+}
+
+int main(void) {
+    if (mkdtemp(test_dir) == NULL) {
+        fprintf(stderr, "failed creating test directory\n");
+        return EXIT_FAILURE;
+    }
+    rl_log_init("/dev/null", RL_LOG_IGNORE);
+
+    test_split();
+    test_split_finish_failure();
+
+    rmdir(test_dir);
+
+    return test_result();
+}
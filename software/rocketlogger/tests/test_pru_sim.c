@@ -0,0 +1,256 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../pru.h"
+#include "../pru_ring.h"
+#include "../pru_sim.h"
+#include "../rl.h"
+#include "test.h"
+
+/// Number of buffers in the test ring
+#define TEST_BUFFER_COUNT 4
+/// Number of data elements per test buffer (a quarter waveform period)
+#define TEST_BUFFER_LENGTH (PRU_SIM_WAVEFORM_LENGTH / 4)
+/// ADC sample rate of the test (in kSPS), 10 ms buffer period
+#define TEST_SAMPLE_RATE 100
+/// Timeout in microseconds waiting for a buffer event
+#define TEST_EVENT_TIMEOUT_US 1000000
+
+/// Measurement configuration of the test
+static rl_config_t config;
+
+/// PRU control structure of the test
+static pru_control_t control;
+
+/// Buffer ring in the simulated shared memory
+static pru_ring_t ring;
+
+/**
+ * Initialize and start the simulation backend.
+ *
+ * @param realtime Whether buffers are paced to the sample rate
+ * @param sample_limit Number of samples to produce (0 for continuous)
+ */
+static void sim_start(bool realtime, uint32_t sample_limit) {
+    memset(&config, 0, sizeof(config));
+    config.backend = RL_BACKEND_SIMULATION;
+    config.simulation_realtime = realtime;
+
+    memset(&control, 0, sizeof(control));
+    control.state = sample_limit > 0 ? PRU_STATE_SAMPLE_FINITE
+                                     : PRU_STATE_SAMPLE_CONTINUOUS;
+    control.sample_rate = TEST_SAMPLE_RATE;
+    control.sample_limit = sample_limit;
+    control.buffer_length = TEST_BUFFER_LENGTH;
+    control.buffer_count = TEST_BUFFER_COUNT;
+    control.buffer_size =
+        TEST_BUFFER_LENGTH *
+            (PRU_SAMPLE_SIZE * RL_CHANNEL_COUNT + PRU_DIGITAL_SIZE) +
+        PRU_BUFFER_STATUS_SIZE;
+
+    uint32_t address;
+    uint32_t size;
+    CHECK(pru_sim_backend.init(&config) == SUCCESS);
+    void *const memory = pru_sim_backend.map_memory(&address, &size);
+    CHECK(memory != NULL);
+    CHECK(size >= control.buffer_count * control.buffer_size);
+    pru_ring_init(&ring, memory, &control);
+
+    // start event, the producer thread starts when clearing it
+    CHECK(pru_sim_backend.start(&control) == SUCCESS);
+    CHECK(pru_sim_backend.wait_event(TEST_EVENT_TIMEOUT_US) == 1);
+    pru_sim_backend.clear_event();
+}
+
+/**
+ * Stop and deinitialize the simulation backend.
+ */
+static void sim_stop(void) {
+    CHECK(pru_sim_backend.set_state(PRU_STATE_OFF) > 0);
+    CHECK(pru_sim_backend.wait_event(TEST_EVENT_TIMEOUT_US) == 1);
+    pru_sim_backend.deinit();
+}
+
+/**
+ * Wait for a buffer of the ring to complete.
+ *
+ * @param index The buffer index to wait for
+ * @param lost Number of buffers lost by overruns
+ * @return The completed buffer, NULL on timeout
+ */
+static pru_buffer_t const *wait_buffer(uint32_t index, uint32_t *const lost) {
+    uint32_t expected = index;
+    for (int i = 0; i < 10; i++) {
+        pru_buffer_t const *buffer = pru_ring_check(&ring, &expected, lost);
+        if (buffer != NULL) {
+            return buffer;
+        }
+        if (pru_sim_backend.wait_event(TEST_EVENT_TIMEOUT_US) > 0) {
+            pru_sim_backend.clear_event();
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Sleep for a number of milliseconds.
+ */
+static void sleep_ms(uint32_t milliseconds) {
+    struct timespec const delay = {
+        .tv_sec = milliseconds / 1000,
+        .tv_nsec = (milliseconds % 1000) * 1000000,
+    };
+    nanosleep(&delay, NULL);
+}
+
+/**
+ * Get the elapsed time since a monotonic timestamp in milliseconds.
+ */
+static int64_t elapsed_ms(struct timespec const *const start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000 +
+           (now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
+static void test_finite(void) {
+    // finite sample limit not a multiple of the buffer length
+    uint32_t const buffer_limit = 3;
+    sim_start(false, (buffer_limit - 1) * TEST_BUFFER_LENGTH + 1);
+
+    uint32_t lost = 0;
+    for (uint32_t i = 0; i < buffer_limit; i++) {
+        pru_buffer_t const *buffer = wait_buffer(i, &lost);
+        CHECK(buffer != NULL);
+        CHECK(pru_ring_validate(&ring, i) == 0);
+        pru_sim_backend.release_buffer(i);
+    }
+    CHECK(lost == 0);
+
+    // no buffers produced beyond the sample limit
+    uint32_t index = buffer_limit;
+    sleep_ms(50);
+    CHECK(pru_ring_check(&ring, &index, &lost) == NULL);
+
+    sim_stop();
+}
+
+static void test_waveform(void) {
+    sim_start(false, 0);
+
+    // synthetic waveform continues across buffers, repeating every period
+    uint32_t lost = 0;
+    pru_buffer_t const *buffer = wait_buffer(0, &lost);
+    CHECK(buffer != NULL);
+    pru_data_t *first = malloc(TEST_BUFFER_LENGTH * sizeof(pru_data_t));
+    if (buffer != NULL) {
+        memcpy(first, buffer->data, TEST_BUFFER_LENGTH * sizeof(pru_data_t));
+    }
+    pru_sim_backend.release_buffer(0);
+
+    for (uint32_t i = 1; i < TEST_BUFFER_COUNT; i++) {
+        buffer = wait_buffer(i, &lost);
+        CHECK(buffer != NULL &&
+              memcmp(buffer->data, first,
+                     TEST_BUFFER_LENGTH * sizeof(pru_data_t)) != 0);
+        pru_sim_backend.release_buffer(i);
+    }
+    buffer = wait_buffer(TEST_BUFFER_COUNT, &lost);
+    CHECK(buffer != NULL && memcmp(buffer->data, first,
+                                   TEST_BUFFER_LENGTH * sizeof(pru_data_t)) ==
+                                0);
+    CHECK(lost == 0);
+    free(first);
+
+    sim_stop();
+}
+
+static void test_reader_backpressure(void) {
+    sim_start(false, 0);
+
+    // without releasing, the producer stops after filling the ring
+    uint32_t lost = 0;
+    for (uint32_t i = 0; i < TEST_BUFFER_COUNT; i++) {
+        CHECK(wait_buffer(i, &lost) != NULL);
+    }
+    uint32_t index = TEST_BUFFER_COUNT;
+    sleep_ms(50);
+    CHECK(pru_ring_check(&ring, &index, &lost) == NULL);
+    CHECK(pru_ring_validate(&ring, 0) == 0);
+
+    // releasing a buffer lets the producer overwrite it
+    pru_sim_backend.release_buffer(0);
+    CHECK(wait_buffer(TEST_BUFFER_COUNT, &lost) != NULL);
+    CHECK(pru_ring_validate(&ring, 0) < 0);
+    CHECK(lost == 0);
+
+    sim_stop();
+}
+
+static void test_realtime_period(void) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    sim_start(true, 0);
+
+    // buffers are paced to the sample rate
+    uint32_t const buffer_period_ms = TEST_BUFFER_LENGTH / TEST_SAMPLE_RATE;
+    uint32_t const buffers = 2 * TEST_BUFFER_COUNT;
+    uint32_t lost = 0;
+    for (uint32_t i = 0; i < buffers; i++) {
+        CHECK(wait_buffer(i, &lost) != NULL);
+        pru_sim_backend.release_buffer(i);
+    }
+    int64_t const elapsed = elapsed_ms(&start);
+    CHECK(elapsed >= (buffers - 1) * buffer_period_ms);
+    CHECK(elapsed < 10 * buffers * buffer_period_ms);
+
+    // like the hardware, buffers not read in time are overwritten
+    sleep_ms(2 * TEST_BUFFER_COUNT * buffer_period_ms);
+    CHECK(wait_buffer(buffers, &lost) != NULL);
+    CHECK(lost > 0);
+
+    sim_stop();
+}
+
+int main(void) {
+    test_finite();
+    test_waveform();
+    test_reader_backpressure();
+    test_realtime_period();
+
+    return test_result();
+}
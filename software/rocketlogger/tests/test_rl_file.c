@@ -0,0 +1,229 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../pru.h"
+#include "../rl.h"
+#include "../rl_file.h"
+#include "test.h"
+
+/// Data update rate of the test measurements
+#define TEST_UPDATE_RATE 100
+/// Number of data blocks per test file
+#define TEST_BLOCK_COUNT 3
+/// Maximum number of samples per test buffer
+#define TEST_BUFFER_LENGTH (RL_SAMPLE_RATE_MIN / TEST_UPDATE_RATE * 2)
+/// File comment of the test files
+#define TEST_FILE_COMMENT "RocketLogger file format test"
+
+/// Number of test channel masks
+#define TEST_CHANNEL_MASK_COUNT 4
+/// Channel masks of the test files (bit i enables config channel i)
+static uint32_t const test_channel_masks[TEST_CHANNEL_MASK_COUNT] = {
+    0x1FF, // all channels
+    0x001, // V1 only
+    0x030, // I1L and I1H
+    0x148, // V4, I2L and DT
+};
+
+/// Number of test sample rate and aggregation settings
+#define TEST_RATE_COUNT 4
+/// Sample rates of the test files
+static uint32_t const test_sample_rates[TEST_RATE_COUNT] = {
+    100,
+    100,
+    1000,
+    2000,
+};
+/// Aggregation modes of the test files
+static rl_aggregation_mode_t const test_aggregation_modes[TEST_RATE_COUNT] = {
+    RL_AGGREGATION_MODE_DOWNSAMPLE,
+    RL_AGGREGATION_MODE_AVERAGE,
+    RL_AGGREGATION_MODE_AVERAGE,
+    RL_AGGREGATION_MODE_AVERAGE,
+};
+
+/// Calibrated analog test data (channel-major)
+static int32_t analog_buffer[TEST_BUFFER_LENGTH * RL_CHANNEL_COUNT];
+/// Digital test data
+static uint32_t digital_buffer[TEST_BUFFER_LENGTH];
+
+/// State of the test data pseudo random number generator
+static uint32_t random_state;
+
+/**
+ * Get a deterministic pseudo random test value.
+ *
+ * @return The next pseudo random value
+ */
+static uint32_t random_next(void) {
+    random_state = random_state * 1103515245 + 12345;
+    return random_state;
+}
+
+/**
+ * Write a test data file in the RLD format.
+ *
+ * @param file The file to write to
+ * @param config The measurement configuration of the file
+ */
+static void write_file(FILE *file, rl_config_t const *const config) {
+    // digital, range valid and analog channels
+    rl_file_channel_t channels[RL_CHANNEL_DIGITAL_COUNT + 2 + RL_CHANNEL_COUNT];
+    memset(channels, 0, sizeof(channels));
+
+    rl_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    rl_file_setup_data_lead_in(&header.lead_in, config);
+    header.channel = channels;
+    rl_file_setup_data_header(&header, config);
+
+    // fixed start time and device address for reproducible output
+    memset(header.lead_in.mac_address, 0, sizeof(header.lead_in.mac_address));
+    header.lead_in.start_time.sec = 1600000000;
+    header.lead_in.start_time.nsec = 123456789;
+    rl_file_store_header_bin(file, &header);
+
+    uint32_t const aggregates = config->sample_rate < RL_SAMPLE_RATE_MIN
+                                    ? RL_SAMPLE_RATE_MIN / config->sample_rate
+                                    : 1;
+    size_t const buffer_size =
+        aggregates * config->sample_rate / config->update_rate;
+
+    for (uint32_t block = 0; block < TEST_BLOCK_COUNT; block++) {
+        // analog data is stored channel-major
+        for (size_t i = 0; i < buffer_size; i++) {
+            for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+                analog_buffer[j * buffer_size + i] = (int32_t)random_next();
+            }
+        }
+        for (size_t i = 0; i < buffer_size; i++) {
+            digital_buffer[i] = random_next();
+        }
+        rl_timestamp_t const timestamp_realtime = {
+            .sec = 1600000000 + block,
+            .nsec = 10000000 * block,
+        };
+        rl_timestamp_t const timestamp_monotonic = {
+            .sec = 1000 + block,
+            .nsec = 20000000 * block,
+        };
+
+        int res = rl_file_add_data_block(file, analog_buffer, digital_buffer,
+                                         buffer_size, &timestamp_realtime,
+                                         &timestamp_monotonic, config);
+        CHECK(res == 1);
+
+        header.lead_in.data_block_count++;
+        header.lead_in.sample_count += buffer_size / aggregates;
+        rl_file_update_header_bin(file, &header);
+    }
+}
+
+/**
+ * Compare a test file with the next file of the reference data.
+ *
+ * @param file The test file to compare
+ * @param reference The reference data file to compare with
+ * @return true if the files are bit-identical, false otherwise
+ */
+static bool compare_file(FILE *file, FILE *reference) {
+    long const size = ftell(file);
+    rewind(file);
+
+    uint8_t *const data = malloc(size);
+    uint8_t *const expected = malloc(size);
+    bool const equal = fread(data, size, 1, file) == 1 &&
+                       fread(expected, size, 1, reference) == 1 &&
+                       memcmp(data, expected, size) == 0;
+    free(data);
+    free(expected);
+    return equal;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <reference data file>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *reference = fopen(argv[1], "rb");
+    if (reference == NULL) {
+        fprintf(stderr, "failed opening reference data file %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    // the reference data holds the concatenated files written by the
+    // original RLD v4 writer for all test configurations
+    random_state = 0;
+    for (int m = 0; m < TEST_CHANNEL_MASK_COUNT; m++) {
+        for (int d = 0; d < 2; d++) {
+            for (int r = 0; r < TEST_RATE_COUNT; r++) {
+                rl_config_t config;
+                rl_config_reset(&config);
+                config.file_enable = true;
+                config.file_format = RL_FILE_FORMAT_RLD;
+                config.file_comment = TEST_FILE_COMMENT;
+                config.update_rate = TEST_UPDATE_RATE;
+                config.sample_rate = test_sample_rates[r];
+                config.aggregation_mode = test_aggregation_modes[r];
+                config.digital_enable = (d > 0);
+                for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+                    config.channel_enable[j] =
+                        (test_channel_masks[m] & (1 << j)) > 0;
+                }
+
+                FILE *file = tmpfile();
+                write_file(file, &config);
+                if (!compare_file(file, reference)) {
+                    fprintf(stderr,
+                            "file differs: channels 0x%03x, digital %d, "
+                            "rate %u, aggregation %d\n",
+                            test_channel_masks[m], d, config.sample_rate,
+                            config.aggregation_mode);
+                    failures++;
+                }
+                fclose(file);
+            }
+        }
+    }
+
+    // no trailing reference data
+    CHECK(fgetc(reference) == EOF);
+    fclose(reference);
+
+    return test_result();
+}
@@ -0,0 +1,303 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../pru.h"
+#include "../rl.h"
+#include "../rl_file.h"
+#include "test.h"
+
+/// Sample rate of the test measurements
+#define TEST_SAMPLE_RATE 64000
+/// Number of samples per test data block (at 10 Hz update rate)
+#define TEST_BUFFER_LENGTH (TEST_SAMPLE_RATE / 10)
+/// Number of data blocks per timed run
+#define TEST_BLOCK_COUNT 10
+/// Number of timed runs, the fastest is compared
+#define TEST_RUN_COUNT 3
+/// Minimum throughput improvement over formatting values with fprintf
+#define TEST_SPEEDUP_MIN 10
+
+/// Number of test channel masks
+#define TEST_CHANNEL_MASK_COUNT 4
+/// Channel masks of the test configurations (bit i enables config channel i)
+static uint32_t const test_channel_masks[TEST_CHANNEL_MASK_COUNT] = {
+    0x1FF, // all channels
+    0x001, // V1 only
+    0x030, // I1L and I1H
+    0x148, // V4, I2L and DT
+};
+
+/// Calibrated analog test data (channel-major)
+static int32_t analog_buffer[TEST_BUFFER_LENGTH * RL_CHANNEL_COUNT];
+/// Digital test data
+static uint32_t digital_buffer[TEST_BUFFER_LENGTH];
+
+/**
+ * Fill the test buffers with pseudo random data, including the extreme values.
+ */
+static void test_data_setup(void) {
+    uint32_t state = 1;
+    for (size_t i = 0; i < TEST_BUFFER_LENGTH * RL_CHANNEL_COUNT; i++) {
+        state = state * 1103515245 + 12345;
+        analog_buffer[i] = (int32_t)state >> (i % 32);
+    }
+    analog_buffer[0] = INT32_MIN;
+    analog_buffer[1] = INT32_MAX;
+    analog_buffer[2] = 0;
+    for (size_t i = 0; i < TEST_BUFFER_LENGTH; i++) {
+        state = state * 1103515245 + 12345;
+        digital_buffer[i] = state;
+    }
+}
+
+/**
+ * Reference CSV data block formatting with one fprintf call per value, as
+ * done by the original file writer.
+ *
+ * @param data_file Data file to write to
+ * @param timestamp_realtime Timestamp of the data block
+ * @param config Measurement configuration with the enabled channels
+ */
+static void add_data_block_reference(FILE *data_file,
+                                     rl_timestamp_t const *const timestamp,
+                                     rl_config_t const *const config) {
+    fprintf(data_file, "%lli.%09lli", timestamp->sec, timestamp->nsec);
+    for (size_t i = 0; i < TEST_BUFFER_LENGTH; i++) {
+        int32_t const *analog_data = analog_buffer + i;
+        uint32_t const digital_data = digital_buffer[i];
+
+        if (config->digital_enable) {
+            uint32_t binary_mask = PRU_DIGITAL_INPUT1_MASK;
+            for (int j = 0; j < RL_CHANNEL_DIGITAL_COUNT; j++) {
+                fprintf(data_file, (RL_FILE_CSV_DELIMITER "%i"),
+                        (digital_data & binary_mask) > 0);
+                binary_mask = binary_mask << 1;
+            }
+        }
+        if (config->channel_enable[RL_CONFIG_CHANNEL_I1L]) {
+            fprintf(data_file, (RL_FILE_CSV_DELIMITER "%i"),
+                    (digital_data & PRU_DIGITAL_I1L_VALID_MASK) > 0);
+        }
+        if (config->channel_enable[RL_CONFIG_CHANNEL_I2L]) {
+            fprintf(data_file, (RL_FILE_CSV_DELIMITER "%i"),
+                    (digital_data & PRU_DIGITAL_I2L_VALID_MASK) > 0);
+        }
+        for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+            if (config->channel_enable[j]) {
+                fprintf(data_file, (RL_FILE_CSV_DELIMITER "%d"),
+                        analog_data[j * TEST_BUFFER_LENGTH]);
+            }
+        }
+        fprintf(data_file, "\n");
+    }
+    fflush(data_file);
+}
+
+/**
+ * Set up a 64 kSps CSV measurement configuration.
+ *
+ * @param config The configuration to set up
+ * @param channel_mask Enabled channels (bit i enables config channel i)
+ * @param digital_enable Whether digital channels are stored
+ */
+static void config_setup(rl_config_t *const config, uint32_t channel_mask,
+                         bool digital_enable) {
+    rl_config_reset(config);
+    config->file_enable = true;
+    config->file_format = RL_FILE_FORMAT_CSV;
+    config->sample_rate = TEST_SAMPLE_RATE;
+    config->update_rate = 10;
+    config->digital_enable = digital_enable;
+    for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+        config->channel_enable[j] = (channel_mask & (1 << j)) > 0;
+    }
+}
+
+/**
+ * Get the monotonic time.
+ *
+ * @return The time in nanoseconds
+ */
+static uint64_t time_ns(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+/**
+ * Compare the content of two files.
+ *
+ * @return true if the files are identical, false otherwise
+ */
+static bool compare_files(FILE *file, FILE *reference) {
+    long const size = ftell(file);
+    if (size != ftell(reference)) {
+        return false;
+    }
+    rewind(file);
+    rewind(reference);
+
+    char *const data = malloc(size);
+    char *const expected = malloc(size);
+    bool const equal = fread(data, size, 1, file) == 1 &&
+                       fread(expected, size, 1, reference) == 1 &&
+                       memcmp(data, expected, size) == 0;
+    free(data);
+    free(expected);
+    return equal;
+}
+
+static void test_csv_identical(void) {
+    rl_timestamp_t const timestamp_realtime = {1600000000, 123456789};
+    rl_timestamp_t const timestamp_monotonic = {1000, 987654321};
+
+    for (int m = 0; m < TEST_CHANNEL_MASK_COUNT; m++) {
+        for (int d = 0; d < 2; d++) {
+            rl_config_t config;
+            config_setup(&config, test_channel_masks[m], d > 0);
+
+            FILE *file = tmpfile();
+            FILE *reference = tmpfile();
+            int res = rl_file_add_data_block(
+                file, analog_buffer, digital_buffer, TEST_BUFFER_LENGTH,
+                &timestamp_realtime, &timestamp_monotonic, &config);
+            CHECK(res == 1);
+            add_data_block_reference(reference, &timestamp_realtime, &config);
+
+            bool const equal = compare_files(file, reference);
+            CHECK(equal);
+            if (!equal) {
+                fprintf(stderr, "CSV mismatch: channel mask 0x%03x, digital %d\n",
+                        test_channel_masks[m], d);
+            }
+            fclose(file);
+            fclose(reference);
+        }
+    }
+}
+
+static void test_csv_fixed_width(void) {
+    rl_timestamp_t const timestamp_realtime = {1600000000, 123456789};
+    rl_timestamp_t const timestamp_monotonic = {1000, 987654321};
+    rl_config_t config;
+    config_setup(&config, 0x1FF, true);
+    config.file_fixed_width_enable = true;
+
+    FILE *file = tmpfile();
+    for (int i = 0; i < 2; i++) {
+        int res = rl_file_add_data_block(
+            file, analog_buffer, digital_buffer, TEST_BUFFER_LENGTH,
+            &timestamp_realtime, &timestamp_monotonic, &config);
+        CHECK(res == 1);
+    }
+
+    // all data rows have the same length
+    rewind(file);
+    char line[1024];
+    size_t row_count = 0;
+    size_t row_length = 0;
+    bool equal = true;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (row_count == 0) {
+            row_length = strlen(line);
+        }
+        equal = equal && strlen(line) == row_length;
+        row_count++;
+    }
+    CHECK(row_count == 2 * TEST_BUFFER_LENGTH);
+    CHECK(row_length == RL_FILE_CSV_TIMESTAMP_WIDTH +
+                            (RL_CHANNEL_DIGITAL_COUNT + 2) * 2 +
+                            RL_CHANNEL_COUNT * (1 + RL_FILE_CSV_VALUE_WIDTH) +
+                            1);
+    CHECK(equal);
+    fclose(file);
+}
+
+static void test_csv_speedup(void) {
+    rl_timestamp_t const timestamp_realtime = {1600000000, 123456789};
+    rl_timestamp_t const timestamp_monotonic = {1000, 987654321};
+    rl_config_t config;
+    config_setup(&config, 0x1FF, true);
+
+    FILE *file = fopen("/dev/null", "w");
+    CHECK(file != NULL);
+    if (file == NULL) {
+        return;
+    }
+
+    uint64_t duration = UINT64_MAX;
+    uint64_t duration_reference = UINT64_MAX;
+    for (int run = 0; run < TEST_RUN_COUNT; run++) {
+        uint64_t start = time_ns();
+        for (int i = 0; i < TEST_BLOCK_COUNT; i++) {
+            rl_file_add_data_block(file, analog_buffer, digital_buffer,
+                                   TEST_BUFFER_LENGTH, &timestamp_realtime,
+                                   &timestamp_monotonic, &config);
+        }
+        uint64_t const time = time_ns() - start;
+        duration = time < duration ? time : duration;
+
+        start = time_ns();
+        for (int i = 0; i < TEST_BLOCK_COUNT; i++) {
+            add_data_block_reference(file, &timestamp_realtime, &config);
+        }
+        uint64_t const time_reference = time_ns() - start;
+        duration_reference = time_reference < duration_reference
+                                 ? time_reference
+                                 : duration_reference;
+    }
+    fclose(file);
+
+    uint64_t const samples = TEST_BLOCK_COUNT * TEST_BUFFER_LENGTH;
+    printf("CSV formatting: %.1f ns/sample, fprintf reference: %.1f "
+           "ns/sample\n",
+           (double)duration / samples, (double)duration_reference / samples);
+    CHECK(duration * TEST_SPEEDUP_MIN <= duration_reference);
+}
+
+int main(void) {
+    test_data_setup();
+
+    test_csv_identical();
+    test_csv_fixed_width();
+    test_csv_speedup();
+
+    rl_file_block_buffer_deinit();
+
+    return test_result();
+}
@@ -0,0 +1,121 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// include implementation to test the internal data block encoders
+#include "../rl_file.c"
+#include "test.h"
+
+/// Maximum number of samples encoded at once
+#define TEST_SAMPLE_COUNT 37
+/// Maximum size of an encoded sample in bytes
+#define TEST_SAMPLE_SIZE ((RL_CHANNEL_COUNT + 1) * sizeof(int32_t))
+
+/// Analog test data (channel-major)
+static int32_t analog_buffer[TEST_SAMPLE_COUNT * RL_CHANNEL_COUNT];
+/// Digital test data
+static uint32_t digital_buffer[TEST_SAMPLE_COUNT];
+/// Data block encoded with the selected encoder
+static uint8_t block[TEST_SAMPLE_COUNT * TEST_SAMPLE_SIZE];
+/// Data block encoded with the generic encoder
+static uint8_t block_generic[TEST_SAMPLE_COUNT * TEST_SAMPLE_SIZE];
+
+static void test_data_setup(void) {
+    uint32_t state = 1;
+    for (size_t i = 0; i < TEST_SAMPLE_COUNT * RL_CHANNEL_COUNT; i++) {
+        state = state * 1103515245 + 12345;
+        analog_buffer[i] = (int32_t)state;
+    }
+    for (size_t i = 0; i < TEST_SAMPLE_COUNT; i++) {
+        state = state * 1103515245 + 12345;
+        digital_buffer[i] = state;
+    }
+}
+
+static void test_specialized_selected(void) {
+    // every specialized encoder is selected for its channel configuration
+    size_t const count = sizeof(RL_FILE_ENCODERS) / sizeof(RL_FILE_ENCODERS[0]);
+    for (size_t i = 0; i < count; i++) {
+        CHECK(rl_file_get_encoder(RL_FILE_ENCODERS[i].channel_mask,
+                                  RL_FILE_ENCODERS[i].digital_enable) ==
+              RL_FILE_ENCODERS[i].encoder);
+    }
+}
+
+static void test_encoders_identical(void) {
+    // selected encoder output is identical to the generic encoder output for
+    // all channel and digital configurations
+    int specialized = 0;
+    for (uint32_t mask = 0; mask <= RL_FILE_CHANNEL_MASK_ALL; mask++) {
+        for (int digital = 0; digital < 2; digital++) {
+            rl_file_encoder_t const encoder =
+                rl_file_get_encoder(mask, digital > 0);
+            if (encoder != rl_file_encode_generic) {
+                specialized++;
+            }
+
+            for (size_t count = 1; count <= TEST_SAMPLE_COUNT;
+                 count += TEST_SAMPLE_COUNT - 1) {
+                memset(block, 0xAA, sizeof(block));
+                memset(block_generic, 0x55, sizeof(block_generic));
+                size_t const size =
+                    encoder(block, analog_buffer, TEST_SAMPLE_COUNT,
+                            digital_buffer, count, mask, digital > 0);
+                size_t const size_generic = rl_file_encode_generic(
+                    block_generic, analog_buffer, TEST_SAMPLE_COUNT,
+                    digital_buffer, count, mask, digital > 0);
+                if (size != size_generic ||
+                    memcmp(block, block_generic, size) != 0) {
+                    fprintf(stderr,
+                            "encoder output differs: channels 0x%03x, "
+                            "digital %d, samples %zu\n",
+                            mask, digital, count);
+                    failures++;
+                }
+            }
+        }
+    }
+    CHECK(specialized ==
+          sizeof(RL_FILE_ENCODERS) / sizeof(RL_FILE_ENCODERS[0]));
+}
+
+int main(void) {
+    test_data_setup();
+    test_specialized_selected();
+    test_encoders_identical();
+
+    return test_result();
+}
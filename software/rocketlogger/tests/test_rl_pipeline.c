@@ -0,0 +1,355 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "../rl.h"
+#include "../rl_pipeline.h"
+#include "test.h"
+
+/// Maximum number of buffers queued for the lossless test consumer
+#define TEST_QUEUE_LENGTH 4
+/// Number of samples per test buffer
+#define TEST_BUFFER_LENGTH 8
+/// Maximum number of buffers recorded by a test consumer
+#define TEST_RECORD_MAX 64
+/// Timeout in milliseconds waiting for a consumer
+#define TEST_TIMEOUT_MS 2000
+
+/**
+ * Test consumer state recording the processed buffers.
+ */
+struct test_consumer {
+    /// Whether the handler waits before processing a buffer
+    atomic_bool blocked;
+    /// Whether the handler fails processing
+    bool fail;
+    /// Number of processed buffers
+    atomic_uint count;
+    /// Index of the last processed buffer
+    atomic_uint last;
+    /// Indexes of the processed buffers
+    uint32_t record[TEST_RECORD_MAX];
+};
+
+typedef struct test_consumer test_consumer_t;
+
+/**
+ * Sleep for a millisecond.
+ */
+static void sleep_ms(void) {
+    struct timespec const delay = {.tv_sec = 0, .tv_nsec = 1000000};
+    nanosleep(&delay, NULL);
+}
+
+/**
+ * Test handler recording the processed buffer index.
+ */
+static int test_handler(rl_pipeline_buffer_t const *const buffer,
+                        void *const context) {
+    test_consumer_t *const consumer = (test_consumer_t *)context;
+    while (atomic_load(&consumer->blocked)) {
+        sleep_ms();
+    }
+    if (consumer->fail) {
+        return ERROR;
+    }
+
+    // data written by the producer is visible to the consumer
+    if (buffer->digital_buffer[TEST_BUFFER_LENGTH - 1] != buffer->index) {
+        return ERROR;
+    }
+
+    unsigned int const count = atomic_load(&consumer->count);
+    if (count < TEST_RECORD_MAX) {
+        consumer->record[count] = buffer->index;
+    }
+    atomic_store(&consumer->last, buffer->index);
+    atomic_store(&consumer->count, count + 1);
+    return SUCCESS;
+}
+
+/**
+ * Initialize a test consumer state.
+ */
+static void consumer_setup(test_consumer_t *const consumer, bool blocked) {
+    atomic_init(&consumer->blocked, blocked);
+    consumer->fail = false;
+    atomic_init(&consumer->count, 0);
+    atomic_init(&consumer->last, RL_PIPELINE_BUFFER_NONE);
+}
+
+/**
+ * Acquire, fill and publish a buffer with data derived from its index.
+ *
+ * @return 0 if the buffer was published, -1 if no buffer was free
+ */
+static int produce(rl_pipeline_t *const pipeline, uint32_t index) {
+    rl_pipeline_buffer_t *const buffer = rl_pipeline_acquire(pipeline);
+    if (buffer == NULL) {
+        return ERROR;
+    }
+    buffer->index = index;
+    buffer->buffer_size = TEST_BUFFER_LENGTH;
+    buffer->sensor_buffer_size = 0;
+    for (uint32_t i = 0; i < TEST_BUFFER_LENGTH; i++) {
+        buffer->digital_buffer[i] = index;
+    }
+    rl_pipeline_publish(pipeline);
+    return SUCCESS;
+}
+
+/**
+ * Wait until a consumer processed the buffer with a given index.
+ *
+ * @return true if processed before the timeout, false otherwise
+ */
+static bool wait_processed(test_consumer_t *const consumer, uint32_t index) {
+    for (int i = 0; i < TEST_TIMEOUT_MS; i++) {
+        if (atomic_load(&consumer->last) == index) {
+            return true;
+        }
+        sleep_ms();
+    }
+    return false;
+}
+
+static void test_lossless_in_order(void) {
+    rl_pipeline_t pipeline;
+    test_consumer_t file;
+    consumer_setup(&file, false);
+
+    CHECK(rl_pipeline_init(&pipeline, TEST_QUEUE_LENGTH, TEST_BUFFER_LENGTH) ==
+          SUCCESS);
+    CHECK(rl_pipeline_add_consumer(&pipeline, RL_PIPELINE_CONSUMER_FILE,
+                                   test_handler, &file, true) == SUCCESS);
+    CHECK(rl_pipeline_start(&pipeline) == SUCCESS);
+
+    // consumer keeping up receives every buffer in order
+    uint32_t const produced = 5 * TEST_QUEUE_LENGTH;
+    for (uint32_t i = 0; i < produced; i++) {
+        CHECK(produce(&pipeline, i) == SUCCESS);
+        CHECK(wait_processed(&file, i));
+    }
+    CHECK(rl_pipeline_stop(&pipeline) == SUCCESS);
+    CHECK(!rl_pipeline_has_error(&pipeline));
+
+    CHECK(atomic_load(&file.count) == produced);
+    for (uint32_t i = 0; i < produced; i++) {
+        CHECK(file.record[i] == i);
+    }
+
+    rl_status_t status;
+    rl_pipeline_update_status(&pipeline, &status);
+    CHECK(status.pipeline_backlog[RL_PIPELINE_CONSUMER_FILE] == 0);
+    CHECK(status.pipeline_dropped[RL_PIPELINE_CONSUMER_FILE] == 0);
+
+    rl_pipeline_deinit(&pipeline);
+}
+
+static void test_drain_on_stop(void) {
+    rl_pipeline_t pipeline;
+    test_consumer_t file;
+    consumer_setup(&file, true);
+
+    CHECK(rl_pipeline_init(&pipeline, TEST_QUEUE_LENGTH, TEST_BUFFER_LENGTH) ==
+          SUCCESS);
+    CHECK(rl_pipeline_add_consumer(&pipeline, RL_PIPELINE_CONSUMER_FILE,
+                                   test_handler, &file, true) == SUCCESS);
+    CHECK(rl_pipeline_start(&pipeline) == SUCCESS);
+
+    // queued buffers are processed before the consumer exits
+    for (uint32_t i = 0; i < TEST_QUEUE_LENGTH; i++) {
+        CHECK(produce(&pipeline, i) == SUCCESS);
+    }
+    atomic_store(&file.blocked, false);
+    CHECK(rl_pipeline_stop(&pipeline) == SUCCESS);
+    CHECK(atomic_load(&file.count) == TEST_QUEUE_LENGTH);
+
+    rl_pipeline_deinit(&pipeline);
+}
+
+static void test_lossless_stall_independent(void) {
+    rl_pipeline_t pipeline;
+    test_consumer_t file;
+    test_consumer_t web;
+    test_consumer_t meter;
+    consumer_setup(&file, true);
+    consumer_setup(&web, false);
+    consumer_setup(&meter, false);
+
+    CHECK(rl_pipeline_init(&pipeline, TEST_QUEUE_LENGTH, TEST_BUFFER_LENGTH) ==
+          SUCCESS);
+    CHECK(rl_pipeline_add_consumer(&pipeline, RL_PIPELINE_CONSUMER_FILE,
+                                   test_handler, &file, true) == SUCCESS);
+    CHECK(rl_pipeline_add_consumer(&pipeline, RL_PIPELINE_CONSUMER_WEB,
+                                   test_handler, &web, false) == SUCCESS);
+    CHECK(rl_pipeline_add_consumer(&pipeline, RL_PIPELINE_CONSUMER_METER,
+                                   test_handler, &meter, false) == SUCCESS);
+    CHECK(rl_pipeline_start(&pipeline) == SUCCESS);
+
+    // stalled lossless consumer fills its queue, the lossy consumers still
+    // get every newest buffer and the producer never runs out of buffers
+    uint32_t const produced = 4 * TEST_QUEUE_LENGTH;
+    for (uint32_t i = 0; i < produced; i++) {
+        CHECK(produce(&pipeline, i) == SUCCESS);
+        CHECK(wait_processed(&web, i));
+        CHECK(wait_processed(&meter, i));
+    }
+
+    // drops are charged to the stalled consumer only
+    rl_status_t status;
+    rl_pipeline_update_status(&pipeline, &status);
+    CHECK(status.pipeline_backlog[RL_PIPELINE_CONSUMER_FILE] ==
+          TEST_QUEUE_LENGTH);
+    CHECK(status.pipeline_dropped[RL_PIPELINE_CONSUMER_FILE] ==
+          produced - TEST_QUEUE_LENGTH);
+    CHECK(status.pipeline_dropped[RL_PIPELINE_CONSUMER_WEB] == 0);
+    CHECK(status.pipeline_dropped[RL_PIPELINE_CONSUMER_METER] == 0);
+
+    // lossless consumer resumes with the oldest queued buffers
+    atomic_store(&file.blocked, false);
+    CHECK(rl_pipeline_stop(&pipeline) == SUCCESS);
+    CHECK(atomic_load(&file.count) == TEST_QUEUE_LENGTH);
+    for (uint32_t i = 0; i < TEST_QUEUE_LENGTH; i++) {
+        CHECK(file.record[i] == i);
+    }
+    CHECK(atomic_load(&web.count) == produced);
+    CHECK(atomic_load(&meter.count) == produced);
+
+    rl_pipeline_deinit(&pipeline);
+}
+
+static void test_lossy_skip_independent(void) {
+    rl_pipeline_t pipeline;
+    test_consumer_t file;
+    test_consumer_t web;
+    test_consumer_t meter;
+    consumer_setup(&file, false);
+    consumer_setup(&web, true);
+    consumer_setup(&meter, false);
+
+    CHECK(rl_pipeline_init(&pipeline, TEST_QUEUE_LENGTH, TEST_BUFFER_LENGTH) ==
+          SUCCESS);
+    CHECK(rl_pipeline_add_consumer(&pipeline, RL_PIPELINE_CONSUMER_FILE,
+                                   test_handler, &file, true) == SUCCESS);
+    CHECK(rl_pipeline_add_consumer(&pipeline, RL_PIPELINE_CONSUMER_WEB,
+                                   test_handler, &web, false) == SUCCESS);
+    CHECK(rl_pipeline_add_consumer(&pipeline, RL_PIPELINE_CONSUMER_METER,
+                                   test_handler, &meter, false) == SUCCESS);
+    CHECK(rl_pipeline_start(&pipeline) == SUCCESS);
+
+    // stalled lossy consumer skips buffers, the others are not affected
+    uint32_t const produced = 4 * TEST_QUEUE_LENGTH;
+    for (uint32_t i = 0; i < produced; i++) {
+        CHECK(produce(&pipeline, i) == SUCCESS);
+        CHECK(wait_processed(&file, i));
+        CHECK(wait_processed(&meter, i));
+    }
+
+    // lossy consumer processes the buffer it took before stalling and the
+    // newest buffer, all in between are charged to it as dropped
+    atomic_store(&web.blocked, false);
+    CHECK(wait_processed(&web, produced - 1));
+    CHECK(rl_pipeline_stop(&pipeline) == SUCCESS);
+
+    rl_status_t status;
+    rl_pipeline_update_status(&pipeline, &status);
+    CHECK(atomic_load(&file.count) == produced);
+    CHECK(atomic_load(&meter.count) == produced);
+    CHECK(atomic_load(&web.count) <= 2);
+    CHECK(atomic_load(&web.count) +
+              status.pipeline_dropped[RL_PIPELINE_CONSUMER_WEB] ==
+          produced);
+    CHECK(status.pipeline_dropped[RL_PIPELINE_CONSUMER_FILE] == 0);
+    CHECK(status.pipeline_dropped[RL_PIPELINE_CONSUMER_METER] == 0);
+
+    rl_pipeline_deinit(&pipeline);
+}
+
+static void test_consumer_failure(void) {
+    rl_pipeline_t pipeline;
+    test_consumer_t file;
+    test_consumer_t meter;
+    consumer_setup(&file, false);
+    consumer_setup(&meter, false);
+    meter.fail = true;
+
+    CHECK(rl_pipeline_init(&pipeline, TEST_QUEUE_LENGTH, TEST_BUFFER_LENGTH) ==
+          SUCCESS);
+    CHECK(rl_pipeline_add_consumer(&pipeline, RL_PIPELINE_CONSUMER_FILE,
+                                   test_handler, &file, true) == SUCCESS);
+    CHECK(rl_pipeline_add_consumer(&pipeline, RL_PIPELINE_CONSUMER_METER,
+                                   test_handler, &meter, false) == SUCCESS);
+    CHECK(rl_pipeline_start(&pipeline) == SUCCESS);
+
+    // failed consumer is detached, the others continue processing
+    uint32_t const produced = 3 * TEST_QUEUE_LENGTH;
+    for (uint32_t i = 0; i < produced; i++) {
+        CHECK(produce(&pipeline, i) == SUCCESS);
+        CHECK(wait_processed(&file, i));
+    }
+    CHECK(rl_pipeline_has_error(&pipeline));
+    CHECK(rl_pipeline_stop(&pipeline) == ERROR);
+    CHECK(atomic_load(&file.count) == produced);
+    CHECK(atomic_load(&meter.count) == 0);
+
+    rl_pipeline_deinit(&pipeline);
+}
+
+static void test_invalid_consumer(void) {
+    rl_pipeline_t pipeline;
+    test_consumer_t file;
+    consumer_setup(&file, false);
+
+    CHECK(rl_pipeline_init(&pipeline, TEST_QUEUE_LENGTH, TEST_BUFFER_LENGTH) ==
+          SUCCESS);
+    CHECK(rl_pipeline_add_consumer(&pipeline, RL_PIPELINE_CONSUMER_COUNT,
+                                   test_handler, &file, true) == ERROR);
+    CHECK(rl_pipeline_add_consumer(&pipeline, RL_PIPELINE_CONSUMER_FILE, NULL,
+                                   &file, true) == ERROR);
+    rl_pipeline_deinit(&pipeline);
+}
+
+int main(void) {
+    test_lossless_in_order();
+    test_drain_on_stop();
+    test_lossless_stall_independent();
+    test_lossy_skip_independent();
+    test_consumer_failure();
+    test_invalid_consumer();
+
+    return test_result();
+}
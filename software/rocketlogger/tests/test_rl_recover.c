@@ -0,0 +1,444 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../rl.h"
+#include "../rl_crc.h"
+#include "../rl_file.h"
+#include "../rl_recover.h"
+#include "test.h"
+
+/// Sample rate of the test data
+#define TEST_SAMPLE_RATE 1000
+/// Number of samples per data block
+#define TEST_BLOCK_SIZE 100
+/// Number of data blocks written
+#define TEST_BLOCK_COUNT 10
+/// Start time of the test data in seconds
+#define TEST_START_TIME 100
+/// Size of the synthetic compressed data block payload in bytes
+#define TEST_COMPRESSED_BYTES 64
+
+/**
+ * Test data file with one binary and one analog channel.
+ */
+struct test_file {
+    /// Header lead-in
+    rl_file_lead_in_t lead_in;
+    /// Channel definitions
+    rl_file_channel_t channel[2];
+};
+
+/**
+ * Size of a data block of the test file.
+ *
+ * @param file_version The file version including flags
+ * @return Size of a data block in bytes
+ */
+static size_t test_block_bytes(uint16_t file_version) {
+    size_t bytes = 2 * sizeof(rl_timestamp_t);
+    if ((file_version & RL_FILE_VERSION_MASK) == RL_FILE_VERSION_COMPRESSED) {
+        bytes += sizeof(uint32_t) + TEST_COMPRESSED_BYTES;
+    } else {
+        bytes += TEST_BLOCK_SIZE * 2 * sizeof(uint32_t);
+    }
+    if (file_version & RL_FILE_VERSION_FLAG_CRC) {
+        bytes += sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+/**
+ * Size of the last data block of a finished test file.
+ *
+ * @param file_version The file version including flags
+ * @param sample_count The total number of samples of the test file
+ * @return Size of the last data block in bytes
+ */
+static size_t test_last_block_bytes(uint16_t file_version,
+                                    uint64_t sample_count) {
+    size_t const bytes = test_block_bytes(file_version);
+    uint64_t const last_sample_count = sample_count % TEST_BLOCK_SIZE;
+    if ((file_version & RL_FILE_VERSION_MASK) == RL_FILE_VERSION_COMPRESSED ||
+        last_sample_count == 0) {
+        return bytes;
+    }
+    return bytes - (TEST_BLOCK_SIZE - last_sample_count) * 2 * sizeof(uint32_t);
+}
+
+/**
+ * Write a test data file with valid data blocks and a checkpoint record.
+ *
+ * The last data block holds only the remaining samples if the header is
+ * valid, like in finished files.
+ *
+ * @param file_name The file to write
+ * @param file_version The file version including flags
+ * @param sample_count The total number of samples
+ * @param header_valid Whether to update the header counts
+ * @param trailing_bytes Number of zero bytes preallocated after the checkpoint
+ * @return Returns 0 on success, negative on failure
+ */
+static int test_write(char const *const file_name, uint16_t file_version,
+                      uint64_t sample_count, bool header_valid,
+                      size_t trailing_bytes) {
+    struct test_file header;
+    memset(&header, 0, sizeof(header));
+    header.lead_in.file_magic = RL_FILE_MAGIC;
+    header.lead_in.file_version = file_version;
+    header.lead_in.header_length = sizeof(header);
+    header.lead_in.data_block_size = TEST_BLOCK_SIZE;
+    header.lead_in.sample_rate = TEST_SAMPLE_RATE;
+    header.lead_in.start_time.sec = TEST_START_TIME;
+    header.lead_in.channel_bin_count = 1;
+    header.lead_in.channel_count = 1;
+    header.channel[0].unit = RL_UNIT_BINARY;
+    strcpy(header.channel[0].name, "DI1");
+    header.channel[1].unit = RL_UNIT_VOLT;
+    header.channel[1].channel_scale = RL_SCALE_NANO;
+    header.channel[1].data_size = sizeof(int32_t);
+    strcpy(header.channel[1].name, "V1");
+    if (header_valid) {
+        header.lead_in.data_block_count = TEST_BLOCK_COUNT;
+        header.lead_in.sample_count = sample_count;
+    }
+
+    FILE *file = fopen(file_name, "w");
+    if (file == NULL) {
+        return ERROR;
+    }
+    fwrite(&header, sizeof(header), 1, file);
+
+    size_t block_bytes = test_block_bytes(file_version);
+    uint64_t data_bytes = 0;
+    bool const compressed =
+        (file_version & RL_FILE_VERSION_MASK) == RL_FILE_VERSION_COMPRESSED;
+    bool const checksum = (file_version & RL_FILE_VERSION_FLAG_CRC);
+    uint8_t block[test_block_bytes(RL_FILE_VERSION | RL_FILE_VERSION_FLAG_CRC) +
+                  sizeof(uint32_t)];
+    for (int b = 0; b < TEST_BLOCK_COUNT; b++) {
+        if (header_valid && b == TEST_BLOCK_COUNT - 1) {
+            block_bytes = test_last_block_bytes(file_version, sample_count);
+        }
+        size_t offset = 0;
+        if (compressed) {
+            uint32_t const size = block_bytes;
+            memcpy(block, &size, sizeof(size));
+            offset += sizeof(size);
+        }
+        rl_timestamp_t const timestamp[2] = {
+            {.sec = TEST_START_TIME + b / 10, .nsec = (b % 10) * 100000000},
+            {.sec = 10 + b / 10, .nsec = (b % 10) * 100000000},
+        };
+        memcpy(block + offset, timestamp, sizeof(timestamp));
+        offset += sizeof(timestamp);
+        size_t const crc_offset = block_bytes - (checksum ? 4 : 0);
+        for (; offset < crc_offset; offset++) {
+            block[offset] = (uint8_t)(b + offset);
+        }
+        if (checksum) {
+            uint32_t const crc = rl_crc32c(RL_CRC32C_INIT, block, crc_offset);
+            memcpy(block + crc_offset, &crc, sizeof(crc));
+        }
+        fwrite(block, block_bytes, 1, file);
+        data_bytes += block_bytes;
+    }
+
+    rl_file_checkpoint_t const checkpoint = {
+        .checkpoint_magic = RL_FILE_CHECKPOINT_MAGIC,
+        .data_block_count = TEST_BLOCK_COUNT,
+        .sample_count = sample_count,
+        .checkpoint_offset = sizeof(header) + data_bytes,
+    };
+    fwrite(&checkpoint, sizeof(checkpoint), 1, file);
+    for (size_t i = 0; i < trailing_bytes; i++) {
+        fputc(0, file);
+    }
+
+    return fclose(file);
+}
+
+/**
+ * Overwrite bytes of a data block of a test file.
+ *
+ * @param file_name The file to modify
+ * @param file_version The file version including flags
+ * @param block_index Index of the data block to modify
+ * @param block_offset Offset of the bytes in the data block
+ * @param length Number of bytes to overwrite
+ * @param value The value to write
+ */
+static void test_damage(char const *const file_name, uint16_t file_version,
+                        int block_index, size_t block_offset, size_t length,
+                        uint8_t value) {
+    FILE *file = fopen(file_name, "r+");
+    CHECK(file != NULL);
+    if (file == NULL) {
+        return;
+    }
+    fseek(file,
+          sizeof(struct test_file) +
+              block_index * test_block_bytes(file_version) + block_offset,
+          SEEK_SET);
+    for (size_t i = 0; i < length; i++) {
+        fputc(value, file);
+    }
+    fclose(file);
+}
+
+/**
+ * Get the size of a file.
+ *
+ * @param file_name The file name
+ * @return The file size in bytes
+ */
+static uint64_t test_file_size(char const *const file_name) {
+    struct stat file_stat;
+    if (stat(file_name, &file_stat) < 0) {
+        return 0;
+    }
+    return file_stat.st_size;
+}
+
+/**
+ * Read the lead-in of a test file.
+ *
+ * @param file_name The file to read
+ * @param lead_in The lead-in to read to
+ */
+static void test_read_lead_in(char const *const file_name,
+                              rl_file_lead_in_t *const lead_in) {
+    memset(lead_in, 0, sizeof(rl_file_lead_in_t));
+    FILE *file = fopen(file_name, "r");
+    CHECK(file != NULL);
+    if (file == NULL) {
+        return;
+    }
+    CHECK(fread(lead_in, sizeof(rl_file_lead_in_t), 1, file) == 1);
+    fclose(file);
+}
+
+static void test_intact(char const *const file_name, uint16_t version,
+                        uint64_t samples) {
+    CHECK(test_write(file_name, version, samples, true, 0) == SUCCESS);
+    // finished files have no checkpoint record
+    uint64_t const size = sizeof(struct test_file) +
+                          (TEST_BLOCK_COUNT - 1) * test_block_bytes(version) +
+                          test_last_block_bytes(version, samples);
+    CHECK(truncate(file_name, size) == 0);
+
+    rl_recover_report_t report;
+    CHECK(rl_recover_file(file_name, NULL, &report) == SUCCESS);
+    CHECK(report.block_count == TEST_BLOCK_COUNT);
+    CHECK(report.sample_count == samples);
+    if (version & RL_FILE_VERSION_FLAG_CRC) {
+        CHECK(report.verified_block_count == TEST_BLOCK_COUNT);
+    }
+    CHECK(report.damaged_block_count == 0);
+    CHECK(report.range_count == 0);
+    CHECK(report.truncated_bytes == 0);
+    CHECK(!report.repaired);
+    CHECK(test_file_size(file_name) == size);
+
+    rl_file_lead_in_t lead_in;
+    test_read_lead_in(file_name, &lead_in);
+    CHECK(lead_in.data_block_count == TEST_BLOCK_COUNT);
+    CHECK(lead_in.sample_count == samples);
+}
+
+static void test_checksum_damaged(char const *const file_name) {
+    uint16_t const version = RL_FILE_VERSION | RL_FILE_VERSION_FLAG_CRC;
+    uint64_t const samples = TEST_BLOCK_SIZE * TEST_BLOCK_COUNT - 10;
+    CHECK(test_write(file_name, version, samples, false, 4096) == SUCCESS);
+    // flipped data bits and damaged last block
+    test_damage(file_name, version, 3, 100, 1, 0xFF);
+    test_damage(file_name, version, 4, 200, 1, 0xFF);
+    test_damage(file_name, version, TEST_BLOCK_COUNT - 1, 300, 1, 0xFF);
+
+    rl_recover_report_t report;
+    CHECK(rl_recover_file(file_name, NULL, &report) == SUCCESS);
+    CHECK(report.header_block_count == 0);
+    CHECK(report.block_count == TEST_BLOCK_COUNT - 1);
+    CHECK(report.sample_count == TEST_BLOCK_SIZE * (TEST_BLOCK_COUNT - 1));
+    CHECK(report.verified_block_count == TEST_BLOCK_COUNT - 3);
+    CHECK(report.damaged_block_count == 3);
+    CHECK(report.range_count == 2);
+    CHECK(report.range[0].block_index == 3);
+    CHECK(report.range[0].block_count == 2);
+    CHECK(report.range[0].sample_index == 3 * TEST_BLOCK_SIZE);
+    CHECK(report.range[0].start_time.sec == TEST_START_TIME);
+    CHECK(report.range[0].start_time.nsec == 300000000);
+    CHECK(!report.range[0].truncated);
+    CHECK(report.range[1].block_index == TEST_BLOCK_COUNT - 1);
+    CHECK(report.range[1].truncated);
+    CHECK(report.repaired);
+    CHECK(test_file_size(file_name) ==
+          sizeof(struct test_file) +
+              (TEST_BLOCK_COUNT - 1) * test_block_bytes(version));
+
+    rl_file_lead_in_t lead_in;
+    test_read_lead_in(file_name, &lead_in);
+    CHECK(lead_in.data_block_count == TEST_BLOCK_COUNT - 1);
+    CHECK(lead_in.sample_count == TEST_BLOCK_SIZE * (TEST_BLOCK_COUNT - 1));
+
+    // repaired file is left unchanged
+    CHECK(rl_recover_file(file_name, NULL, &report) == SUCCESS);
+    CHECK(!report.repaired);
+}
+
+static void test_checkpoint(char const *const file_name) {
+    uint16_t const version = RL_FILE_VERSION;
+    uint64_t const samples = TEST_BLOCK_SIZE * TEST_BLOCK_COUNT - 10;
+    CHECK(test_write(file_name, version, samples, false, 4096) == SUCCESS);
+
+    rl_recover_report_t report;
+    CHECK(rl_recover_file(file_name, NULL, &report) == SUCCESS);
+    CHECK(report.block_count == TEST_BLOCK_COUNT);
+    CHECK(report.sample_count == samples);
+    CHECK(report.verified_block_count == 0);
+    CHECK(report.damaged_block_count == 0);
+    CHECK(report.truncated_bytes == sizeof(rl_file_checkpoint_t) + 4096);
+    CHECK(report.repaired);
+}
+
+static void test_partial_block(char const *const file_name) {
+    uint16_t const version = RL_FILE_VERSION;
+    CHECK(test_write(file_name, version, 0, false, 0) == SUCCESS);
+    // last block partially written, no checkpoint
+    uint64_t const size = sizeof(struct test_file) +
+                          TEST_BLOCK_COUNT * test_block_bytes(version) - 100;
+    CHECK(truncate(file_name, size) == 0);
+
+    rl_recover_report_t report;
+    CHECK(rl_recover_file(file_name, NULL, &report) == SUCCESS);
+    CHECK(report.block_count == TEST_BLOCK_COUNT - 1);
+    CHECK(report.sample_count == TEST_BLOCK_SIZE * (TEST_BLOCK_COUNT - 1));
+    CHECK(report.range_count == 1);
+    CHECK(report.range[0].block_index == TEST_BLOCK_COUNT - 1);
+    CHECK(report.range[0].start_time.sec == TEST_START_TIME);
+    CHECK(report.range[0].start_time.nsec == 900000000);
+    CHECK(report.range[0].truncated);
+    CHECK(report.truncated_bytes == test_block_bytes(version) - 100);
+}
+
+static void test_compressed(char const *const file_name,
+                            char const *const index_file_name) {
+    uint16_t const version =
+        RL_FILE_VERSION_COMPRESSED | RL_FILE_VERSION_FLAG_CRC;
+    CHECK(test_write(file_name, version, 0, false, 0) == SUCCESS);
+    test_damage(file_name, version, 6, 40, 4, 0x55);
+
+    // index of all data blocks, to be truncated with the data file
+    rl_file_index_header_t const index_header = {
+        .index_magic = RL_FILE_INDEX_MAGIC,
+        .index_version = RL_FILE_INDEX_VERSION,
+        .record_length = sizeof(rl_file_index_record_t),
+        .start_time = {.sec = TEST_START_TIME, .nsec = 0},
+    };
+    rl_file_index_record_t record;
+    memset(&record, 0, sizeof(record));
+    FILE *index_file = fopen(index_file_name, "w");
+    CHECK(index_file != NULL);
+    if (index_file == NULL) {
+        return;
+    }
+    fwrite(&index_header, sizeof(index_header), 1, index_file);
+    for (int b = 0; b < TEST_BLOCK_COUNT; b++) {
+        fwrite(&record, sizeof(record), 1, index_file);
+    }
+    fclose(index_file);
+
+    rl_recover_report_t report;
+    CHECK(rl_recover_file(file_name, index_file_name, &report) == SUCCESS);
+    CHECK(report.block_count == 6);
+    CHECK(report.verified_block_count == 6);
+    CHECK(report.range_count == 1);
+    CHECK(report.range[0].block_index == 6);
+    CHECK(report.range[0].truncated);
+    CHECK(report.truncated_bytes ==
+          (TEST_BLOCK_COUNT - 6) * test_block_bytes(version) +
+              sizeof(rl_file_checkpoint_t));
+    CHECK(test_file_size(index_file_name) ==
+          sizeof(index_header) + 6 * sizeof(record));
+}
+
+static void test_invalid(char const *const file_name) {
+    FILE *file = fopen(file_name, "w");
+    CHECK(file != NULL);
+    if (file == NULL) {
+        return;
+    }
+    uint8_t zeros[256] = {0};
+    fwrite(zeros, sizeof(zeros), 1, file);
+    fclose(file);
+
+    rl_recover_report_t report;
+    CHECK(rl_recover_file(file_name, NULL, &report) == ERROR);
+    CHECK(test_file_size(file_name) == sizeof(zeros));
+}
+
+int main(void) {
+    char file_name[] = "/tmp/test_rl_recover_XXXXXX";
+    int fd = mkstemp(file_name);
+    if (fd < 0) {
+        perror("mkstemp");
+        return EXIT_FAILURE;
+    }
+    close(fd);
+    char index_file_name[sizeof(file_name) + 4];
+    snprintf(index_file_name, sizeof(index_file_name), "%s.rli", file_name);
+
+    // last data block full and partially filled
+    uint64_t const samples = TEST_BLOCK_SIZE * TEST_BLOCK_COUNT;
+    test_intact(file_name, RL_FILE_VERSION | RL_FILE_VERSION_FLAG_CRC, samples);
+    test_intact(file_name, RL_FILE_VERSION | RL_FILE_VERSION_FLAG_CRC,
+                samples - 10);
+    test_intact(file_name, RL_FILE_VERSION, samples - 10);
+    test_intact(file_name, RL_FILE_VERSION_PLANAR | RL_FILE_VERSION_FLAG_CRC,
+                samples - TEST_BLOCK_SIZE + 1);
+    test_checksum_damaged(file_name);
+    test_checkpoint(file_name);
+    test_partial_block(file_name);
+    test_compressed(file_name, index_file_name);
+    test_invalid(file_name);
+
+    unlink(file_name);
+    unlink(index_file_name);
+
+    return test_result();
+}
@@ -0,0 +1,164 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../rl.h"
+#include "../rl_rt.h"
+#include "test.h"
+
+/// Nanoseconds per microsecond
+#define TEST_NS_PER_US 1000LL
+
+/**
+ * Get the histogram bin a single time measurement is counted in.
+ *
+ * @param time_ns The measured time in nanoseconds
+ * @return The histogram bin, negative if not exactly one bin was incremented
+ */
+static int histogram_bin(int64_t time_ns) {
+    uint32_t histogram[RL_TIMING_HISTOGRAM_BINS] = {0};
+    uint32_t max = 0;
+    rl_rt_histogram_add(histogram, &max, time_ns);
+
+    int bin = -1;
+    for (int i = 0; i < RL_TIMING_HISTOGRAM_BINS; i++) {
+        if (histogram[i] == 1 && bin < 0) {
+            bin = i;
+        } else if (histogram[i] != 0) {
+            return -1;
+        }
+    }
+    return bin;
+}
+
+static void test_histogram_bins(void) {
+    CHECK(histogram_bin(-5) == 0);
+    CHECK(histogram_bin(0) == 0);
+    CHECK(histogram_bin(1999) == 0);
+    CHECK(histogram_bin(2 * TEST_NS_PER_US) == 1);
+    CHECK(histogram_bin(4 * TEST_NS_PER_US - 1) == 1);
+    CHECK(histogram_bin(4 * TEST_NS_PER_US) == 2);
+    CHECK(histogram_bin(1000 * TEST_NS_PER_US) == 9);
+    CHECK(histogram_bin(1000000 * TEST_NS_PER_US) == 19);
+    CHECK(histogram_bin((1LL << 20) * TEST_NS_PER_US) ==
+          RL_TIMING_HISTOGRAM_BINS - 1);
+    CHECK(histogram_bin(INT64_MAX) == RL_TIMING_HISTOGRAM_BINS - 1);
+}
+
+static void test_histogram_max(void) {
+    uint32_t histogram[RL_TIMING_HISTOGRAM_BINS] = {0};
+    uint32_t max = 0;
+
+    rl_rt_histogram_add(histogram, &max, 150 * TEST_NS_PER_US);
+    rl_rt_histogram_add(histogram, &max, 900 * TEST_NS_PER_US);
+    rl_rt_histogram_add(histogram, &max, 20 * TEST_NS_PER_US);
+    CHECK(max == 900);
+    CHECK(histogram[7] == 1 && histogram[9] == 1 && histogram[4] == 1);
+
+    rl_rt_histogram_add(histogram, &max, INT64_MAX);
+    CHECK(max == UINT32_MAX);
+}
+
+static void test_latency_periodic(void) {
+    rl_rt_latency_t latency;
+    rl_rt_latency_init(&latency, 10);
+
+    // constant offset to the buffer events is not observable
+    int64_t const offset = 123456789;
+    int64_t latency_max = 0;
+    for (uint32_t i = 0; i < 100; i++) {
+        int64_t const wakeup = offset + (int64_t)i * latency.period_ns;
+        int64_t const value = rl_rt_latency_update(&latency, i, wakeup);
+        if (value > latency_max) {
+            latency_max = value;
+        }
+    }
+    CHECK(latency_max == 0);
+}
+
+static void test_latency_late(void) {
+    rl_rt_latency_t latency;
+    rl_rt_latency_init(&latency, 10);
+
+    for (uint32_t i = 0; i < 20; i++) {
+        int64_t const wakeup = (int64_t)i * latency.period_ns;
+        CHECK(rl_rt_latency_update(&latency, i, wakeup) == 0);
+    }
+
+    // single late wakeup, skipped buffer continues the period
+    CHECK(rl_rt_latency_update(&latency, 20,
+                               20 * latency.period_ns +
+                                   500 * TEST_NS_PER_US) ==
+          500 * TEST_NS_PER_US);
+    CHECK(rl_rt_latency_update(&latency, 22, 22 * latency.period_ns) == 0);
+
+    // late first wakeup is corrected by an earlier later one
+    rl_rt_latency_init(&latency, 10);
+    CHECK(rl_rt_latency_update(&latency, 0, 300 * TEST_NS_PER_US) == 0);
+    CHECK(rl_rt_latency_update(&latency, 1, latency.period_ns) == 0);
+    CHECK(rl_rt_latency_update(&latency, 2,
+                               2 * latency.period_ns +
+                                   300 * TEST_NS_PER_US) ==
+          300 * TEST_NS_PER_US);
+}
+
+static void test_latency_drift(void) {
+    rl_rt_latency_t latency;
+    rl_rt_latency_init(&latency, 1);
+
+    // ADC clock 100 ppm slower than the system clock
+    int64_t const period = latency.period_ns + latency.period_ns / 10000;
+    int64_t latency_max = 0;
+    for (uint32_t i = 0; i < 3600; i++) {
+        int64_t const value =
+            rl_rt_latency_update(&latency, i, (int64_t)i * period);
+        if (value > latency_max) {
+            latency_max = value;
+        }
+    }
+
+    // drift only accumulates within the reference window
+    CHECK(latency_max <= RL_RT_LATENCY_WINDOW * (period - latency.period_ns));
+}
+
+int main(void) {
+    test_histogram_bins();
+    test_histogram_max();
+    test_latency_periodic();
+    test_latency_late();
+    test_latency_drift();
+
+    return test_result();
+}
@@ -0,0 +1,275 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../rl.h"
+#include "../rl_shm.h"
+#include "test.h"
+
+/// Number of blocks in the test ring
+#define TEST_BLOCK_COUNT 4
+/// Number of samples per test block
+#define TEST_BLOCK_LENGTH 16
+/// Maximum number of samples per written buffer
+#define TEST_BUFFER_LENGTH_MAX (2 * TEST_BLOCK_LENGTH)
+
+/// Memory backing the test ring
+static rl_shm_header_t *ring = NULL;
+
+/**
+ * Initialize a test ring backed by heap memory, storing channels V1 and I1L
+ * only.
+ */
+static void ring_setup(void) {
+    rl_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.update_rate = 1;
+    config.digital_enable = true;
+    config.channel_enable[0] = true;
+    config.channel_enable[4] = true;
+
+    size_t const size =
+        rl_shm_ring_get_size(&config, TEST_BLOCK_LENGTH, TEST_BLOCK_COUNT);
+    free(ring);
+    ring = malloc(size);
+    memset(ring, 0xff, size);
+    rl_shm_ring_init(ring, &config, 1000, TEST_BLOCK_LENGTH, TEST_BLOCK_COUNT);
+}
+
+/**
+ * Write a block with data derived from the block index.
+ *
+ * @param index The block index to write
+ * @param size Number of samples to write
+ */
+static void produce(uint64_t index, size_t size) {
+    int32_t analog[RL_CHANNEL_COUNT * TEST_BUFFER_LENGTH_MAX];
+    uint32_t digital[TEST_BUFFER_LENGTH_MAX];
+    for (size_t i = 0; i < size; i++) {
+        digital[i] = (uint32_t)index;
+        for (int j = 0; j < RL_CHANNEL_COUNT; j++) {
+            analog[j * size + i] = (int32_t)(index * 1000 + i * 10 + j);
+        }
+    }
+    rl_timestamp_t const timestamp = {(int64_t)index, 0};
+    rl_shm_ring_write(ring, analog, digital, size, index, 0, &timestamp,
+                      &timestamp);
+}
+
+/**
+ * Check a block holds the data produced for a block index.
+ *
+ * @param block The block to check
+ * @param index The expected block index
+ * @param size The expected number of samples
+ * @return 1 if the block content matches, 0 otherwise
+ */
+static int block_matches(rl_shm_block_t const *const block, uint64_t index,
+                         size_t size) {
+    if (block->index != index || block->sample_count != size ||
+        block->timestamp_realtime.sec != (int64_t)index) {
+        return 0;
+    }
+    int32_t const *const v1 = rl_shm_block_get_channel(ring, block, 0);
+    int32_t const *const i1l = rl_shm_block_get_channel(ring, block, 4);
+    uint32_t const *const digital = rl_shm_block_get_digital(ring, block);
+    for (size_t i = 0; i < size; i++) {
+        if (v1[i] != (int32_t)(index * 1000 + i * 10) ||
+            i1l[i] != (int32_t)(index * 1000 + i * 10 + 4) ||
+            digital[i] != (uint32_t)index) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void test_layout(void) {
+    ring_setup();
+
+    CHECK(ring->version == RL_SHM_VERSION);
+    CHECK(ring->block_count == TEST_BLOCK_COUNT);
+    CHECK(ring->channel_mask == 0x11);
+    CHECK(ring->block_size % 8 == 0);
+    CHECK(ring->block_size >=
+          sizeof(rl_shm_block_t) + 3 * TEST_BLOCK_LENGTH * sizeof(int32_t));
+
+    produce(0, TEST_BLOCK_LENGTH);
+    uint32_t sequence = 0;
+    uint32_t lost = 0;
+    rl_shm_block_t const *block = rl_shm_ring_check(ring, &sequence, &lost);
+    CHECK(block != NULL);
+    CHECK(rl_shm_block_get_channel(ring, block, 1) == NULL);
+    CHECK(rl_shm_block_get_channel(ring, block, 5) == NULL);
+}
+
+static void test_block_count(void) {
+    rl_config_t config;
+    memset(&config, 0, sizeof(config));
+
+    config.update_rate = 1;
+    CHECK(rl_shm_ring_get_block_count(&config) == RL_SHM_BLOCK_COUNT_MIN);
+    config.update_rate = 10;
+    CHECK(rl_shm_ring_get_block_count(&config) == 32);
+}
+
+static void test_empty_ring(void) {
+    ring_setup();
+
+    uint32_t sequence = 0;
+    uint32_t lost = 0;
+    CHECK(rl_shm_ring_check(ring, &sequence, &lost) == NULL);
+    CHECK(sequence == 0);
+    CHECK(lost == 0);
+}
+
+static void test_sequential(void) {
+    ring_setup();
+
+    uint32_t lost = 0;
+    for (uint32_t i = 0; i < 5 * TEST_BLOCK_COUNT; i++) {
+        uint32_t sequence = i;
+        produce(i, TEST_BLOCK_LENGTH);
+        rl_shm_block_t const *block = rl_shm_ring_check(ring, &sequence, &lost);
+        CHECK(block != NULL);
+        CHECK(sequence == i);
+        CHECK(block != NULL && block_matches(block, i, TEST_BLOCK_LENGTH));
+        CHECK(block != NULL && rl_shm_ring_validate(block, i) == 0);
+
+        // next block is not available yet
+        sequence = i + 1;
+        CHECK(rl_shm_ring_check(ring, &sequence, &lost) == NULL);
+        CHECK(sequence == i + 1);
+    }
+    CHECK(lost == 0);
+}
+
+static void test_partial_block(void) {
+    ring_setup();
+
+    produce(0, TEST_BLOCK_LENGTH / 2);
+    uint32_t sequence = 0;
+    uint32_t lost = 0;
+    rl_shm_block_t const *block = rl_shm_ring_check(ring, &sequence, &lost);
+    CHECK(block != NULL && block_matches(block, 0, TEST_BLOCK_LENGTH / 2));
+}
+
+static void test_oversized_buffer(void) {
+    ring_setup();
+
+    // samples beyond the block length are dropped from each channel
+    produce(0, TEST_BUFFER_LENGTH_MAX);
+    uint32_t sequence = 0;
+    uint32_t lost = 0;
+    rl_shm_block_t const *block = rl_shm_ring_check(ring, &sequence, &lost);
+    CHECK(block != NULL && block_matches(block, 0, TEST_BLOCK_LENGTH));
+}
+
+static void test_overrun(void) {
+    ring_setup();
+
+    // writer laps the reader by more than the ring size
+    uint32_t const produced = 2 * TEST_BLOCK_COUNT + 1;
+    for (uint32_t i = 0; i < produced; i++) {
+        produce(i, TEST_BLOCK_LENGTH);
+    }
+
+    // the oldest block's slot is the next to be overwritten and skipped too
+    uint32_t sequence = 0;
+    uint32_t lost = 0;
+    rl_shm_block_t const *block = rl_shm_ring_check(ring, &sequence, &lost);
+    CHECK(block != NULL);
+    CHECK(sequence == produced - TEST_BLOCK_COUNT + 1);
+    CHECK(lost == produced - TEST_BLOCK_COUNT + 1);
+    CHECK(block != NULL && block_matches(block, sequence, TEST_BLOCK_LENGTH));
+
+    // remaining blocks are read without further loss
+    for (sequence++; sequence < produced; sequence++) {
+        uint32_t const expected = sequence;
+        block = rl_shm_ring_check(ring, &sequence, &lost);
+        CHECK(block != NULL &&
+              block_matches(block, expected, TEST_BLOCK_LENGTH));
+    }
+    CHECK(lost == produced - TEST_BLOCK_COUNT + 1);
+}
+
+static void test_overwrite_while_processing(void) {
+    ring_setup();
+
+    produce(0, TEST_BLOCK_LENGTH);
+    uint32_t sequence = 0;
+    uint32_t lost = 0;
+    rl_shm_block_t const *block = rl_shm_ring_check(ring, &sequence, &lost);
+    CHECK(block != NULL);
+
+    // writer laps and overwrites the block being processed
+    for (uint32_t i = 1; i <= TEST_BLOCK_COUNT; i++) {
+        produce(i, TEST_BLOCK_LENGTH);
+    }
+    CHECK(block != NULL && rl_shm_ring_validate(block, 0) < 0);
+}
+
+static void test_sequence_wrap(void) {
+    ring_setup();
+
+    // block sequence wrap around at 32 bit, ring slots stay consistent
+    uint32_t const start = UINT32_MAX - 2 * TEST_BLOCK_COUNT;
+    atomic_store(&ring->write_sequence, start);
+    uint32_t lost = 0;
+    for (uint32_t i = start; i != start + 4 * TEST_BLOCK_COUNT; i++) {
+        uint32_t sequence = i;
+        produce(i, TEST_BLOCK_LENGTH);
+        rl_shm_block_t const *block = rl_shm_ring_check(ring, &sequence, &lost);
+        CHECK(block != NULL && block_matches(block, i, TEST_BLOCK_LENGTH));
+        CHECK(block != NULL && rl_shm_ring_validate(block, i) == 0);
+    }
+    CHECK(lost == 0);
+}
+
+int main(void) {
+    test_layout();
+    test_block_count();
+    test_empty_ring();
+    test_sequential();
+    test_partial_block();
+    test_oversized_buffer();
+    test_overrun();
+    test_overwrite_while_processing();
+    test_sequence_wrap();
+
+    free(ring);
+
+    return test_result();
+}
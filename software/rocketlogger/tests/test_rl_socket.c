@@ -0,0 +1,785 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zmq.h>
+
+#include "../rl.h"
+#include "../rl_socket.h"
+#include "../util.h"
+#include "test.h"
+
+/// Sample rate of the test measurements
+#define TEST_SAMPLE_RATE 64000
+/// Number of samples per data buffer, the last envelope value of each level
+/// covers less samples
+#define TEST_BUFFER_LENGTH (TEST_SAMPLE_RATE / 10 + 10)
+/// Number of data message buffers of the publisher
+#define TEST_MESSAGE_POOL_SIZE 8
+/// Number of frames of a data message of all channels: topic, header,
+/// timestamps, analog channels and digital inputs
+#define TEST_DATA_FRAME_COUNT (4 + RL_CHANNEL_COUNT)
+/// Maximum number of frames recorded
+#define TEST_FRAME_COUNT_MAX (16 * TEST_DATA_FRAME_COUNT)
+/// Maximum number of frames held back from sending, of two topics
+#define TEST_HELD_COUNT_MAX                                                    \
+    (2 * (TEST_MESSAGE_POOL_SIZE + 1) * TEST_DATA_FRAME_COUNT)
+/// Maximum number of pending subscription messages
+#define TEST_SUBSCRIPTION_COUNT_MAX 16
+/// Maximum subscription topic length
+#define TEST_TOPIC_LENGTH 32
+/// Total number of samples lost reported with the published buffers
+#define TEST_SAMPLES_LOST 42
+
+/**
+ * Frame published to the data socket.
+ */
+struct test_frame {
+    /// Copy of the frame data
+    uint8_t *data;
+    /// Size of the frame data in bytes
+    size_t size;
+    /// Send flags of the frame
+    int flags;
+    /// Data of zero-copy frames, NULL for copied frames
+    void const *zero_copy;
+};
+
+/// Frames published by the last data handling
+static struct test_frame frames[TEST_FRAME_COUNT_MAX];
+/// Number of frames published by the last data handling
+static size_t frame_count = 0;
+/// Zero-copy frames held back, as queued for slow subscribers
+static zmq_msg_t held[TEST_HELD_COUNT_MAX];
+/// Number of zero-copy frames held back, including released ones
+static size_t held_count = 0;
+/// Index of the oldest zero-copy frame still held back
+static size_t held_first = 0;
+/// Whether to hold back zero-copy frames instead of sending them
+static bool hold = false;
+/// Error of failing zero-copy frame sends, 0 to send successfully
+static int send_errno = 0;
+/// Error of failing copied frame sends, 0 to send successfully
+static int send_copy_errno = 0;
+/// Pending subscription messages, (un)subscribe flag followed by the topic
+static char subscriptions[TEST_SUBSCRIPTION_COUNT_MAX][TEST_TOPIC_LENGTH];
+/// Number of pending subscription messages
+static size_t subscription_count = 0;
+/// Sequence number of the next published buffer
+static uint64_t sequence = 0;
+
+/// Analog test data (channel-major)
+static int32_t analog_buffer[TEST_BUFFER_LENGTH * RL_CHANNEL_COUNT];
+/// Digital test data
+static uint32_t digital_buffer[TEST_BUFFER_LENGTH];
+
+/**
+ * Record a published frame.
+ */
+static void frame_record(void const *data, size_t size, int flags,
+                         bool zero_copy) {
+    if (frame_count >= TEST_FRAME_COUNT_MAX) {
+        return;
+    }
+    struct test_frame *const frame = &frames[frame_count++];
+    frame->data = malloc(size + 1);
+    memcpy(frame->data, data, size);
+    frame->data[size] = '\0';
+    frame->size = size;
+    frame->flags = flags;
+    frame->zero_copy = zero_copy ? data : NULL;
+}
+
+/**
+ * Socket bind wrapper, the test does not communicate (linked with
+ * --wrap=zmq_bind).
+ */
+int __wrap_zmq_bind(void *socket, char const *endpoint) {
+    (void)socket;
+    (void)endpoint;
+    return 0;
+}
+
+/**
+ * Socket receive wrapper passing the pending subscription messages (linked
+ * with --wrap=zmq_recv).
+ */
+int __wrap_zmq_recv(void *socket, void *buffer, size_t size, int flags) {
+    (void)socket;
+    (void)flags;
+    if (subscription_count == 0) {
+        errno = EAGAIN;
+        return -1;
+    }
+    char const *const message = subscriptions[0];
+    size_t const length = 1 + strlen(message + 1);
+    memcpy(buffer, message, (length < size) ? length : size);
+    subscription_count--;
+    memmove(subscriptions, subscriptions + 1,
+            subscription_count * sizeof(subscriptions[0]));
+    return (int)length;
+}
+
+/**
+ * Socket send wrapper recording the copied frames (linked with
+ * --wrap=zmq_send).
+ */
+int __wrap_zmq_send(void *socket, void const *data, size_t size, int flags) {
+    (void)socket;
+    if (send_copy_errno != 0) {
+        errno = send_copy_errno;
+        return -1;
+    }
+    frame_record(data, size, flags, false);
+    return (int)size;
+}
+
+/**
+ * Message send wrapper recording and releasing or holding back zero-copy
+ * frames (linked with --wrap=zmq_msg_send).
+ */
+int __wrap_zmq_msg_send(zmq_msg_t *msg, void *socket, int flags) {
+    (void)socket;
+    if (send_errno != 0) {
+        errno = send_errno;
+        return -1;
+    }
+    size_t const size = zmq_msg_size(msg);
+    frame_record(zmq_msg_data(msg), size, flags, true);
+    if (hold && held_count < TEST_HELD_COUNT_MAX) {
+        zmq_msg_init(&held[held_count]);
+        zmq_msg_move(&held[held_count], msg);
+        held_count++;
+    } else {
+        zmq_msg_close(msg);
+    }
+    return (int)size;
+}
+
+/**
+ * Queue a subscription message of a subscriber.
+ *
+ * @param topic The topic prefix
+ * @param subscribe Whether to subscribe or unsubscribe
+ */
+static void subscribe(char const *const topic, bool subscribe) {
+    if (subscription_count >= TEST_SUBSCRIPTION_COUNT_MAX) {
+        return;
+    }
+    char *const message = subscriptions[subscription_count++];
+    message[0] = subscribe ? 1 : 0;
+    snprintf(message + 1, TEST_TOPIC_LENGTH - 1, "%s", topic);
+}
+
+/**
+ * Drop the recorded frames.
+ */
+static void frames_reset(void) {
+    for (size_t i = 0; i < frame_count; i++) {
+        free(frames[i].data);
+    }
+    frame_count = 0;
+}
+
+/**
+ * Release the held back frames, starting with the oldest.
+ *
+ * @param count Number of frames to release
+ */
+static void held_release(size_t count) {
+    for (size_t i = 0; i < count && held_first < held_count; i++) {
+        zmq_msg_close(&held[held_first++]);
+    }
+    if (held_first == held_count) {
+        held_first = 0;
+        held_count = 0;
+    }
+}
+
+/**
+ * Get the number of recorded data messages.
+ *
+ * @return Number of data messages published by the last data handling
+ */
+static size_t message_count(void) {
+    size_t count = 0;
+    size_t start = 0;
+    for (size_t i = 0; i < frame_count; i++) {
+        if ((frames[i].flags & ZMQ_SNDMORE) != 0) {
+            continue;
+        }
+        if (strncmp((char *)frames[start].data, "data.", 5) == 0) {
+            count++;
+        }
+        start = i + 1;
+    }
+    return count;
+}
+
+/**
+ * Find a message of a topic published by the last data handling.
+ *
+ * @param topic The topic of the message
+ * @param count Number of frames of the message, including the topic frame
+ * @return The topic frame of the message, NULL if not published
+ */
+static struct test_frame *find_message(char const *const topic,
+                                       size_t *const count) {
+    size_t start = 0;
+    for (size_t i = 0; i < frame_count; i++) {
+        if ((frames[i].flags & ZMQ_SNDMORE) != 0) {
+            continue;
+        }
+        if (strcmp((char *)frames[start].data, topic) == 0) {
+            *count = i + 1 - start;
+            return &frames[start];
+        }
+        start = i + 1;
+    }
+    *count = 0;
+    return NULL;
+}
+
+/**
+ * Get the number of data messages dropped by the publisher.
+ *
+ * @return The dropped data message counter of the status
+ */
+static uint64_t messages_dropped(void) {
+    rl_status_t status;
+    memset(&status, 0, sizeof(status));
+    rl_socket_update_status(&status);
+    return status.web_dropped;
+}
+
+/**
+ * Fill the test buffers with pseudo random data, including the extreme values.
+ */
+static void test_data_setup(void) {
+    uint32_t state = 1;
+    for (size_t i = 0; i < TEST_BUFFER_LENGTH * RL_CHANNEL_COUNT; i++) {
+        state = state * 1103515245 + 12345;
+        analog_buffer[i] = (int32_t)state >> (i % 32);
+    }
+    analog_buffer[0] = INT32_MIN;
+    analog_buffer[1] = INT32_MAX;
+    analog_buffer[TEST_BUFFER_LENGTH - 1] = INT32_MIN;
+    for (size_t i = 0; i < TEST_BUFFER_LENGTH; i++) {
+        state = state * 1103515245 + 12345;
+        digital_buffer[i] = state;
+    }
+}
+
+/**
+ * Set up the data socket and the test measurement configuration with all
+ * channels enabled.
+ *
+ * @param config The configuration to set up
+ * @param sample_rate The sample rate
+ */
+static void test_setup(rl_config_t *const config, uint32_t sample_rate) {
+    rl_config_reset(config);
+    config->sample_rate = sample_rate;
+    config->update_rate = 10;
+    config->ambient_enable = false;
+    config->digital_enable = true;
+    for (int ch = 0; ch < RL_CHANNEL_COUNT; ch++) {
+        config->channel_enable[ch] = true;
+    }
+
+    CHECK(rl_socket_init() == SUCCESS);
+    CHECK(rl_socket_metadata(config) == SUCCESS);
+}
+
+/**
+ * Release the held back frames and close the data socket.
+ */
+static void test_teardown(void) {
+    hold = false;
+    held_release(TEST_HELD_COUNT_MAX);
+    frames_reset();
+    subscription_count = 0;
+    rl_socket_deinit();
+}
+
+/**
+ * Publish the test data.
+ *
+ * @param config The measurement configuration
+ * @return The data handling result
+ */
+static int test_handle_data(rl_config_t const *const config) {
+    rl_timestamp_t const timestamp = {.sec = 1, .nsec = 0};
+    frames_reset();
+    return rl_socket_handle_data(analog_buffer, digital_buffer, NULL,
+                                 TEST_BUFFER_LENGTH, 0, sequence++,
+                                 TEST_SAMPLES_LOST, &timestamp, &timestamp,
+                                 config);
+}
+
+/**
+ * Check the frame layout of a data message.
+ *
+ * @param message The topic frame of the message
+ * @param count Number of frames of the message
+ * @param channel_count Expected number of analog channel frames
+ * @param channel_bytes Expected size of an analog channel frame
+ * @param digital_bytes Expected size of the digital frame
+ */
+static void check_message(struct test_frame const *const message,
+                          size_t count, size_t channel_count,
+                          size_t channel_bytes, size_t digital_bytes) {
+    CHECK(count == 4 + channel_count);
+    if (count != 4 + channel_count) {
+        return;
+    }
+    CHECK(message[0].zero_copy == NULL);
+    CHECK(message[0].flags == (ZMQ_SNDMORE | ZMQ_DONTWAIT));
+    CHECK(message[1].size == sizeof(rl_socket_data_header_t));
+    CHECK(message[2].size == 2 * sizeof(rl_timestamp_t));
+    for (size_t i = 1; i < count; i++) {
+        CHECK(message[i].flags ==
+              ((i + 1 < count) ? ZMQ_SNDMORE | ZMQ_DONTWAIT : ZMQ_DONTWAIT));
+        // empty frames are copied
+        CHECK((message[i].zero_copy != NULL) == (message[i].size > 0));
+    }
+    for (size_t i = 0; i < channel_count; i++) {
+        CHECK(message[3 + i].size == channel_bytes);
+    }
+    CHECK(message[count - 1].size == digital_bytes);
+}
+
+static void test_envelope(void) {
+    char const *const topics[] = {"data.10k.all", "data.1k.all", "data.10.all"};
+    size_t const rates[] = {10000, 1000, 10};
+
+    rl_config_t config;
+    test_setup(&config, TEST_SAMPLE_RATE);
+
+    for (size_t level = 0; level < 3; level++) {
+        size_t const factor = TEST_SAMPLE_RATE / rates[level];
+        size_t const count = (TEST_BUFFER_LENGTH + factor - 1) / factor;
+        subscribe(topics[level], true);
+        CHECK(test_handle_data(&config) == SUCCESS);
+        subscribe(topics[level], false);
+
+        size_t frame_total;
+        struct test_frame const *const message =
+            find_message(topics[level], &frame_total);
+        CHECK(message != NULL);
+        CHECK(message_count() == 1);
+        if (message == NULL) {
+            continue;
+        }
+        check_message(message, frame_total, RL_CHANNEL_COUNT,
+                      3 * count * sizeof(int32_t),
+                      2 * count * sizeof(uint32_t));
+        if (frame_total != TEST_DATA_FRAME_COUNT) {
+            continue;
+        }
+
+        // reference min, max and mean of each envelope value
+        for (int ch = 0; ch < RL_CHANNEL_COUNT; ch++) {
+            int32_t const *const data = analog_buffer + ch * TEST_BUFFER_LENGTH;
+            int32_t const *const envelope = (int32_t *)message[3 + ch].data;
+            for (size_t j = 0; j < count; j++) {
+                int32_t min = INT32_MAX;
+                int32_t max = INT32_MIN;
+                int64_t sum = 0;
+                size_t i = j * factor;
+                for (; i < (j + 1) * factor && i < TEST_BUFFER_LENGTH; i++) {
+                    min = (data[i] < min) ? data[i] : min;
+                    max = (data[i] > max) ? data[i] : max;
+                    sum += data[i];
+                }
+                CHECK(envelope[j] == min);
+                CHECK(envelope[count + j] == max);
+                CHECK(envelope[2 * count + j] ==
+                      (int32_t)(sum / (int64_t)(i - j * factor)));
+            }
+        }
+
+        uint32_t const *const envelope =
+            (uint32_t *)message[frame_total - 1].data;
+        for (size_t j = 0; j < count; j++) {
+            uint32_t all = UINT32_MAX;
+            uint32_t any = 0;
+            size_t i = j * factor;
+            for (; i < (j + 1) * factor && i < TEST_BUFFER_LENGTH; i++) {
+                all &= digital_buffer[i];
+                any |= digital_buffer[i];
+            }
+            CHECK(envelope[j] == all);
+            CHECK(envelope[count + j] == any);
+        }
+    }
+
+    test_teardown();
+}
+
+static void test_envelope_low_rate(void) {
+    // sample rates below the level rate publish envelopes of single samples
+    rl_config_t config;
+    test_setup(&config, 100);
+    subscribe("data.1k.all", true);
+    CHECK(test_handle_data(&config) == SUCCESS);
+
+    size_t count;
+    struct test_frame const *const message =
+        find_message("data.1k.all", &count);
+    CHECK(message != NULL);
+    if (message != NULL) {
+        check_message(message, count, RL_CHANNEL_COUNT,
+                      3 * TEST_BUFFER_LENGTH * sizeof(int32_t),
+                      2 * TEST_BUFFER_LENGTH * sizeof(uint32_t));
+    }
+    for (int ch = 0; message != NULL && count == TEST_DATA_FRAME_COUNT &&
+                     ch < RL_CHANNEL_COUNT;
+         ch++) {
+        int32_t const *const data = analog_buffer + ch * TEST_BUFFER_LENGTH;
+        int32_t const *const envelope = (int32_t *)message[3 + ch].data;
+        for (size_t k = 0; k < 3; k++) {
+            CHECK(memcmp(envelope + k * TEST_BUFFER_LENGTH, data,
+                         TEST_BUFFER_LENGTH * sizeof(int32_t)) == 0);
+        }
+    }
+
+    test_teardown();
+}
+
+static void test_full_rate(void) {
+    rl_config_t config;
+    test_setup(&config, TEST_SAMPLE_RATE);
+    subscribe("data.full.all", true);
+    CHECK(test_handle_data(&config) == SUCCESS);
+
+    size_t count;
+    struct test_frame const *const message =
+        find_message("data.full.all", &count);
+    CHECK(message != NULL);
+    if (message != NULL) {
+        check_message(message, count, RL_CHANNEL_COUNT,
+                      TEST_BUFFER_LENGTH * sizeof(int32_t),
+                      TEST_BUFFER_LENGTH * sizeof(uint32_t));
+    }
+    if (message != NULL && count == TEST_DATA_FRAME_COUNT) {
+        for (int ch = 0; ch < RL_CHANNEL_COUNT; ch++) {
+            CHECK(memcmp(message[3 + ch].data,
+                         analog_buffer + ch * TEST_BUFFER_LENGTH,
+                         TEST_BUFFER_LENGTH * sizeof(int32_t)) == 0);
+        }
+        CHECK(memcmp(message[count - 1].data, digital_buffer,
+                     TEST_BUFFER_LENGTH * sizeof(uint32_t)) == 0);
+    }
+
+    test_teardown();
+}
+
+static void test_groups(void) {
+    size_t const count = (TEST_BUFFER_LENGTH + 63) / 64;
+    size_t voltage_count = 0;
+    size_t current_count = 0;
+    for (int ch = 0; ch < RL_CHANNEL_COUNT; ch++) {
+        voltage_count += is_voltage(ch);
+        current_count += is_current(ch);
+    }
+
+    rl_config_t config;
+    test_setup(&config, TEST_SAMPLE_RATE);
+    subscribe("data.1k.all", true);
+    subscribe("data.1k.voltage", true);
+    subscribe("data.1k.current", true);
+    subscribe("data.1k.digital", true);
+    CHECK(test_handle_data(&config) == SUCCESS);
+    CHECK(message_count() == 4);
+
+    // group messages reference the frames of all channels
+    size_t all_count;
+    struct test_frame const *const all =
+        find_message("data.1k.all", &all_count);
+    size_t voltage_total;
+    struct test_frame const *const voltage =
+        find_message("data.1k.voltage", &voltage_total);
+    size_t current_total;
+    struct test_frame const *const current =
+        find_message("data.1k.current", &current_total);
+    size_t digital_total;
+    struct test_frame const *const digital =
+        find_message("data.1k.digital", &digital_total);
+    CHECK(all != NULL && voltage != NULL && current != NULL &&
+          digital != NULL);
+    if (all == NULL || voltage == NULL || current == NULL || digital == NULL) {
+        test_teardown();
+        return;
+    }
+    check_message(voltage, voltage_total, voltage_count,
+                  3 * count * sizeof(int32_t), 0);
+    check_message(current, current_total, current_count,
+                  3 * count * sizeof(int32_t), 2 * count * sizeof(uint32_t));
+    check_message(digital, digital_total, 0, 0, 2 * count * sizeof(uint32_t));
+    CHECK(voltage[1].zero_copy == all[1].zero_copy);
+    CHECK(digital[digital_total - 1].zero_copy ==
+          all[all_count - 1].zero_copy);
+
+    size_t voltage_index = 3;
+    size_t current_index = 3;
+    for (int ch = 0; ch < RL_CHANNEL_COUNT; ch++) {
+        if (all_count != TEST_DATA_FRAME_COUNT) {
+            break;
+        }
+        if (is_voltage(ch) && voltage_index + 1 < voltage_total) {
+            CHECK(voltage[voltage_index++].zero_copy == all[3 + ch].zero_copy);
+        }
+        if (is_current(ch) && current_index + 1 < current_total) {
+            CHECK(current[current_index++].zero_copy == all[3 + ch].zero_copy);
+        }
+    }
+
+    test_teardown();
+}
+
+static void test_subscriptions(void) {
+    rl_config_t config;
+    test_setup(&config, TEST_SAMPLE_RATE);
+    size_t count;
+
+    // no data computed or published without subscribers
+    CHECK(test_handle_data(&config) == SUCCESS);
+    CHECK(message_count() == 0);
+
+    // prefix subscriptions match all groups of a level
+    subscribe("data.10.", true);
+    subscribe("data.full.all", true);
+    subscribe("data.1k.all", true);
+    CHECK(test_handle_data(&config) == SUCCESS);
+    CHECK(message_count() == 5 + 2);
+    CHECK(find_message("data.10.ambient", &count) != NULL);
+
+    // removing the first and the last tracked subscription
+    subscribe("data.10.", false);
+    CHECK(test_handle_data(&config) == SUCCESS);
+    CHECK(message_count() == 2);
+    CHECK(find_message("data.full.all", &count) != NULL);
+    CHECK(find_message("data.1k.all", &count) != NULL);
+    subscribe("data.1k.all", false);
+    CHECK(test_handle_data(&config) == SUCCESS);
+    CHECK(message_count() == 1);
+    CHECK(find_message("data.full.all", &count) != NULL);
+    subscribe("data.full.all", false);
+    CHECK(test_handle_data(&config) == SUCCESS);
+    CHECK(message_count() == 0);
+
+    test_teardown();
+}
+
+static void test_metadata(void) {
+    rl_config_t config;
+    test_setup(&config, TEST_SAMPLE_RATE);
+    subscribe("metadata", true);
+    subscribe("data.1k.all", true);
+
+    // changed metadata is published once before the data messages
+    CHECK(test_handle_data(&config) == SUCCESS);
+    CHECK(message_count() == 1);
+    size_t count;
+    struct test_frame const *metadata = find_message("metadata", &count);
+    struct test_frame const *message = find_message("data.1k.all", &count);
+    CHECK(metadata != NULL && message != NULL);
+    if (metadata == NULL || message == NULL) {
+        test_teardown();
+        return;
+    }
+    CHECK(metadata[1].flags == ZMQ_DONTWAIT);
+    char const *const json = (char *)metadata[1].data;
+    rl_socket_data_header_t header;
+    memcpy(&header, message[1].data, sizeof(header));
+    char version[32];
+    snprintf(version, sizeof(version), "{\"version\":%u,",
+             header.metadata_version);
+    CHECK(strncmp(json, version, strlen(version)) == 0);
+    char layout_hash[32];
+    snprintf(layout_hash, sizeof(layout_hash), "\"layout_hash\":%u,",
+             header.layout_hash);
+    CHECK(strstr(json, layout_hash) != NULL);
+    CHECK(strstr(json, "\"1k\":{\"data_rate\":1000,\"envelope\":true}") !=
+          NULL);
+    CHECK(strstr(json, "\"full\":{\"data_rate\":64000,\"envelope\":false}") !=
+          NULL);
+    CHECK(header.header_version == RL_SOCKET_DATA_HEADER_VERSION);
+    CHECK(header.header_size == sizeof(rl_socket_data_header_t));
+    CHECK(header.sequence == sequence - 1);
+    CHECK(header.samples_lost == TEST_SAMPLES_LOST);
+    CHECK(header.sample_rate == TEST_SAMPLE_RATE);
+
+    // unchanged metadata is sent to new subscribers only
+    CHECK(rl_socket_metadata(&config) == SUCCESS);
+    CHECK(test_handle_data(&config) == SUCCESS);
+    CHECK(find_message("metadata", &count) == NULL);
+    subscribe("metadata", true);
+    CHECK(test_handle_data(&config) == SUCCESS);
+    CHECK(message_count() == 1);
+    metadata = find_message("metadata", &count);
+    CHECK(metadata != NULL &&
+          strncmp((char *)metadata[1].data, version, strlen(version)) == 0);
+
+    // metadata not queued is retried with the next buffer
+    subscribe("metadata", true);
+    send_copy_errno = EAGAIN;
+    CHECK(test_handle_data(&config) == SUCCESS);
+    send_copy_errno = 0;
+    CHECK(test_handle_data(&config) == SUCCESS);
+    CHECK(find_message("metadata", &count) != NULL);
+
+    // new version on configuration change
+    config.channel_enable[0] = false;
+    CHECK(rl_socket_metadata(&config) == SUCCESS);
+    CHECK(test_handle_data(&config) == SUCCESS);
+    metadata = find_message("metadata", &count);
+    message = find_message("data.1k.all", &count);
+    CHECK(metadata != NULL && message != NULL);
+    if (message != NULL) {
+        rl_socket_data_header_t header_changed;
+        memcpy(&header_changed, message[1].data, sizeof(header_changed));
+        CHECK(header_changed.metadata_version == header.metadata_version + 1);
+        CHECK(header_changed.layout_hash != header.layout_hash);
+    }
+
+    test_teardown();
+}
+
+static void test_message_pool(void) {
+    rl_config_t config;
+    test_setup(&config, TEST_SAMPLE_RATE);
+    subscribe("data.1k.all", true);
+    subscribe("data.10.all", true);
+
+    // messages queued for slow subscribers keep their buffer, shared by the
+    // messages of all topics
+    hold = true;
+    void const *buffers[TEST_MESSAGE_POOL_SIZE];
+    size_t count;
+    for (int i = 0; i < TEST_MESSAGE_POOL_SIZE; i++) {
+        CHECK(test_handle_data(&config) == SUCCESS);
+        struct test_frame const *const message =
+            find_message("data.1k.all", &count);
+        struct test_frame const *const other =
+            find_message("data.10.all", &count);
+        CHECK(message != NULL && other != NULL);
+        if (message == NULL || other == NULL) {
+            test_teardown();
+            return;
+        }
+        CHECK(message[1].zero_copy == other[1].zero_copy);
+        buffers[i] = message[1].zero_copy;
+        for (int j = 0; j < i; j++) {
+            CHECK(buffers[i] != buffers[j]);
+        }
+    }
+
+    // data is dropped while all buffers are queued
+    uint64_t const dropped = messages_dropped();
+    CHECK(test_handle_data(&config) == SUCCESS);
+    CHECK(messages_dropped() == dropped + 1);
+    CHECK(message_count() == 0);
+
+    // sent message buffers are reused without allocation
+    held_release(2 * (TEST_DATA_FRAME_COUNT - 1));
+    CHECK(test_handle_data(&config) == SUCCESS);
+    struct test_frame const *const message =
+        find_message("data.1k.all", &count);
+    CHECK(message != NULL);
+    if (message != NULL) {
+        CHECK(message[1].zero_copy == buffers[0]);
+        rl_socket_data_header_t header;
+        memcpy(&header, message[1].data, sizeof(header));
+        CHECK(header.messages_dropped == dropped + 1);
+    }
+
+    test_teardown();
+}
+
+static void test_send_failure(void) {
+    rl_config_t config;
+    test_setup(&config, TEST_SAMPLE_RATE);
+    subscribe("data.1k.all", true);
+
+    // failed messages release their buffers
+    send_errno = ENOTSOCK;
+    for (int i = 0; i < 2 * TEST_MESSAGE_POOL_SIZE; i++) {
+        CHECK(test_handle_data(&config) == ERROR);
+    }
+    send_errno = 0;
+
+    // messages that cannot be queued are dropped and counted
+    uint64_t const dropped = messages_dropped();
+    send_copy_errno = EAGAIN;
+    for (int i = 0; i < 2 * TEST_MESSAGE_POOL_SIZE; i++) {
+        CHECK(test_handle_data(&config) == SUCCESS);
+    }
+    send_copy_errno = 0;
+    CHECK(messages_dropped() == dropped + 2 * TEST_MESSAGE_POOL_SIZE);
+
+    CHECK(test_handle_data(&config) == SUCCESS);
+    size_t count;
+    struct test_frame const *const message =
+        find_message("data.1k.all", &count);
+    CHECK(message != NULL);
+    if (message != NULL) {
+        rl_socket_data_header_t header;
+        memcpy(&header, message[1].data, sizeof(header));
+        CHECK(header.messages_dropped ==
+              dropped + 2 * TEST_MESSAGE_POOL_SIZE);
+        CHECK(header.sequence == sequence - 1);
+    }
+
+    test_teardown();
+}
+
+int main(void) {
+    test_data_setup();
+
+    test_envelope();
+    test_envelope_low_rate();
+    test_full_rate();
+    test_groups();
+    test_subscriptions();
+    test_metadata();
+    test_message_pool();
+    test_send_failure();
+
+    return test_result();
+}
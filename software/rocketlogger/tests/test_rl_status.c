@@ -0,0 +1,180 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// include implementation to test the status shared memory sequence lock
+#include "../rl.c"
+#include "test.h"
+
+/// Number of status updates written by the concurrent writer
+#define TEST_WRITE_COUNT 200000
+
+/**
+ * Set up a status with all fields derived from an update counter.
+ *
+ * @param status The status to set up
+ * @param count The update counter
+ */
+static void status_setup(rl_status_t *const status, uint64_t count) {
+    memset(status, 0, sizeof(rl_status_t));
+    status->sample_count = count;
+    status->buffer_count = count;
+    status->disk_free = count;
+    memset(status->calibration_file, 'a' + (int)(count % 26),
+           sizeof(status->calibration_file) - 1);
+}
+
+/**
+ * Check a status was written completely by a single update.
+ *
+ * @param status The status to check
+ * @return true if the status is consistent, false if torn
+ */
+static bool status_consistent(rl_status_t const *const status) {
+    uint64_t const count = status->sample_count;
+    if (status->buffer_count != count || status->disk_free != count) {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(status->calibration_file) - 1; i++) {
+        if (status->calibration_file[i] != 'a' + (int)(count % 26)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_write_read(void) {
+    rl_status_t status;
+    rl_status_t status_read;
+    status_setup(&status, 42);
+
+    unsigned int const sequence = atomic_load(&rl_status_shm->sequence);
+    CHECK(rl_status_shm_write(&status) == SUCCESS);
+    CHECK(atomic_load(&rl_status_shm->sequence) == sequence + 2);
+
+    CHECK(rl_status_read(&status_read) == SUCCESS);
+    CHECK(status_read.sample_count == 42);
+    CHECK(status_consistent(&status_read));
+    CHECK(status_read.config == NULL);
+}
+
+static void test_concurrent(void) {
+    rl_status_t status;
+    status_setup(&status, 0);
+    CHECK(rl_status_shm_write(&status) == SUCCESS);
+
+    // writer process updates the status while the reader checks snapshots
+    pid_t const pid = fork();
+    if (pid == 0) {
+        for (uint64_t i = 1; i <= TEST_WRITE_COUNT; i++) {
+            status_setup(&status, i);
+            rl_status_shm_write(&status);
+        }
+        _exit(EXIT_SUCCESS);
+    }
+    CHECK(pid > 0);
+
+    int torn = 0;
+    int reads = 0;
+    uint64_t last = 0;
+    while (last < TEST_WRITE_COUNT) {
+        rl_status_t status_read;
+        if (rl_status_read(&status_read) < 0) {
+            continue;
+        }
+        reads++;
+        if (!status_consistent(&status_read) ||
+            status_read.sample_count < last) {
+            torn++;
+        }
+        last = status_read.sample_count;
+    }
+    waitpid(pid, NULL, 0);
+
+    CHECK(reads > 0);
+    CHECK(torn == 0);
+    CHECK((atomic_load(&rl_status_shm->sequence) & 0x1) == 0);
+}
+
+static void test_stale_lock(void) {
+    rl_status_t status;
+    rl_status_t status_read;
+    status_setup(&status, 7);
+    CHECK(rl_status_shm_write(&status) == SUCCESS);
+
+    // writer terminated while holding the lock
+    unsigned int const sequence = atomic_load(&rl_status_shm->sequence);
+    atomic_store(&rl_status_shm->sequence, sequence + 1);
+
+    // readers give up instead of returning a possibly torn status
+    CHECK(rl_status_read(&status_read) == ERROR);
+    CHECK(errno == EBUSY);
+
+    // next writer takes over the lock after a bounded wait and releases it
+    status_setup(&status, 8);
+    CHECK(rl_status_shm_write(&status) == SUCCESS);
+    CHECK(atomic_load(&rl_status_shm->sequence) == sequence + 2);
+
+    CHECK(rl_status_read(&status_read) == SUCCESS);
+    CHECK(status_read.sample_count == 8);
+    CHECK(status_consistent(&status_read));
+}
+
+int main(void) {
+    // shared anonymous mapping in place of the system status segment
+    void *const shm = mmap(NULL, sizeof(rl_status_shm_t),
+                           PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+                           -1, 0);
+    if (shm == MAP_FAILED) {
+        fprintf(stderr, "failed mapping shared memory\n");
+        return EXIT_FAILURE;
+    }
+    rl_status_shm = (rl_status_shm_t *)shm;
+    atomic_init(&rl_status_shm->sequence, 0);
+
+    test_write_read();
+    test_concurrent();
+    test_stale_lock();
+
+    rl_status_shm = NULL;
+    munmap(shm, sizeof(rl_status_shm_t));
+
+    return test_result();
+}
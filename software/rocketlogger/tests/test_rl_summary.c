@@ -0,0 +1,217 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../pru.h"
+#include "../rl.h"
+#include "../rl_file.h"
+#include "../rl_summary.h"
+#include "test.h"
+
+/// Sample rate of the test data
+#define TEST_SAMPLE_RATE 4000
+/// Number of samples per data block
+#define TEST_BLOCK_SIZE 1000
+/// Number of data blocks summarized, not a multiple of any bin size
+#define TEST_BLOCK_COUNT 45
+/// Number of summarized channels (V1 and I1L)
+#define TEST_CHANNEL_COUNT 2
+/// Start time of the test data in seconds
+#define TEST_START_TIME 100
+
+/**
+ * Get the test value of a channel for a sample.
+ *
+ * @param channel The summarized channel (0 for V1, 1 for I1L)
+ * @param sample The sample index since the start of the measurement
+ * @return The test value
+ */
+static int32_t test_value(int channel, uint64_t sample) {
+    if (channel == 0) {
+        return (int32_t)sample;
+    }
+    return -3 * (int32_t)(sample % 1000);
+}
+
+/**
+ * Summarize the test data to a temporary file.
+ *
+ * @param summary_file The file to store the summary to
+ * @return Returns 0 on success, negative on failure
+ */
+static int test_summarize(FILE *summary_file) {
+    rl_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.sample_rate = TEST_SAMPLE_RATE;
+    config.channel_enable[RL_CONFIG_CHANNEL_V1] = true;
+    config.channel_enable[RL_CONFIG_CHANNEL_I1L] = true;
+
+    rl_file_channel_t channel[TEST_CHANNEL_COUNT + 1];
+    memset(channel, 0, sizeof(channel));
+    strcpy(channel[1].name, "V1");
+    strcpy(channel[2].name, "I1L");
+    rl_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.lead_in.channel_bin_count = 1;
+    header.lead_in.channel_count = TEST_CHANNEL_COUNT;
+    header.lead_in.start_time.sec = TEST_START_TIME;
+    header.channel = channel;
+
+    rl_summary_t summary;
+    int res = rl_summary_init(&summary, summary_file, &header, &config);
+    if (res < 0) {
+        return res;
+    }
+
+    static int32_t analog_buffer[RL_CHANNEL_COUNT * TEST_BLOCK_SIZE];
+    static uint32_t digital_buffer[TEST_BLOCK_SIZE];
+    for (int b = 0; b < TEST_BLOCK_COUNT; b++) {
+        uint64_t const offset = (uint64_t)b * TEST_BLOCK_SIZE;
+        for (int i = 0; i < TEST_BLOCK_SIZE; i++) {
+            analog_buffer[RL_CONFIG_CHANNEL_V1 * TEST_BLOCK_SIZE + i] =
+                test_value(0, offset + i);
+            analog_buffer[RL_CONFIG_CHANNEL_I1L * TEST_BLOCK_SIZE + i] =
+                test_value(1, offset + i);
+            digital_buffer[i] = (i % 2 == 0) ? PRU_DIGITAL_I1L_VALID_MASK : 0;
+        }
+        rl_timestamp_t const timestamp = {
+            .sec = TEST_START_TIME + offset / TEST_SAMPLE_RATE,
+            .nsec = (offset % TEST_SAMPLE_RATE) *
+                    (1000000000 / TEST_SAMPLE_RATE),
+        };
+        res = rl_summary_add(&summary, analog_buffer, digital_buffer,
+                             TEST_BLOCK_SIZE, &timestamp);
+        if (res < 0) {
+            return res;
+        }
+    }
+
+    return rl_summary_finish(&summary);
+}
+
+/**
+ * Check a summary record against the summarized test data.
+ *
+ * @param record The summary record to check
+ * @param first The index of the first summarized sample
+ */
+static void test_check_record(rl_summary_record_t const *const record,
+                              uint64_t first) {
+    int64_t const time_ns =
+        record->timestamp.sec * 1000000000LL + record->timestamp.nsec;
+    CHECK(time_ns == TEST_START_TIME * 1000000000LL +
+                         (int64_t)first * (1000000000 / TEST_SAMPLE_RATE));
+
+    for (int ch = 0; ch < TEST_CHANNEL_COUNT; ch++) {
+        int32_t min = INT32_MAX;
+        int32_t max = INT32_MIN;
+        double sum = 0;
+        for (uint64_t n = first; n < first + record->sample_count; n++) {
+            int32_t const value = test_value(ch, n);
+            min = (value < min) ? value : min;
+            max = (value > max) ? value : max;
+            sum += value;
+        }
+        double const mean = sum / record->sample_count;
+        double const tolerance = 1e-6 * (1.0 + ((mean < 0) ? -mean : mean));
+        CHECK(record->channel[ch].min == min);
+        CHECK(record->channel[ch].max == max);
+        CHECK(record->channel[ch].mean >= mean - tolerance &&
+              record->channel[ch].mean <= mean + tolerance);
+    }
+
+    // only every second sample has a valid low range current
+    CHECK(record->channel[0].valid == 1.0f);
+    CHECK(record->channel[1].valid >= 0.49f &&
+          record->channel[1].valid <= 0.51f);
+}
+
+static void test_summary(void) {
+    FILE *summary_file = tmpfile();
+    CHECK(summary_file != NULL);
+    if (summary_file == NULL) {
+        return;
+    }
+    CHECK(test_summarize(summary_file) == SUCCESS);
+    rewind(summary_file);
+
+    // header and channel definitions
+    rl_summary_header_t header;
+    CHECK(fread(&header, sizeof(header), 1, summary_file) == 1);
+    CHECK(header.summary_magic == RL_SUMMARY_MAGIC);
+    CHECK(header.channel_count == TEST_CHANNEL_COUNT);
+    CHECK(header.level_count == RL_SUMMARY_LEVEL_COUNT);
+    CHECK(header.sample_rate == TEST_SAMPLE_RATE);
+    CHECK(header.start_time.sec == TEST_START_TIME);
+    CHECK(header.bin_size[0] == RL_SUMMARY_BIN_SIZE_MIN);
+    CHECK(header.bin_size[1] == header.bin_size[0] * RL_SUMMARY_LEVEL_FACTOR);
+    rl_file_channel_t channel[TEST_CHANNEL_COUNT];
+    CHECK(fread(channel, sizeof(channel), 1, summary_file) == 1);
+    CHECK(strcmp(channel[0].name, "V1") == 0);
+    CHECK(strcmp(channel[1].name, "I1L") == 0);
+
+    // records of each level cover all samples in order
+    uint64_t sample_offset[RL_SUMMARY_LEVEL_COUNT] = {0};
+    uint32_t record_count[RL_SUMMARY_LEVEL_COUNT] = {0};
+    rl_summary_record_t record;
+    while (fread(&record, header.record_length, 1, summary_file) == 1) {
+        CHECK(record.level < RL_SUMMARY_LEVEL_COUNT);
+        if (record.level >= RL_SUMMARY_LEVEL_COUNT) {
+            break;
+        }
+        CHECK(record.sample_count > 0);
+        CHECK(record.sample_count <= header.bin_size[record.level]);
+        test_check_record(&record, sample_offset[record.level]);
+        sample_offset[record.level] += record.sample_count;
+        record_count[record.level]++;
+    }
+
+    uint64_t const sample_count = TEST_BLOCK_COUNT * TEST_BLOCK_SIZE;
+    for (int level = 0; level < RL_SUMMARY_LEVEL_COUNT; level++) {
+        CHECK(sample_offset[level] == sample_count);
+        CHECK(record_count[level] ==
+              (sample_count + header.bin_size[level] - 1) /
+                  header.bin_size[level]);
+    }
+
+    fclose(summary_file);
+}
+
+int main(void) {
+    test_summary();
+
+    return test_result();
+}
@@ -0,0 +1,250 @@
+/**
+ * Copyright (c) 2016-2020, ETH Zurich, Computer Engineering Group
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../rl.h"
+#include "../rl_writer.h"
+#include "test.h"
+
+/// Size of the file header region rewritten periodically
+#define TEST_HEADER_SIZE 64
+/// Size of the trailer overwritten by the next block
+#define TEST_TRAILER_SIZE 24
+/// Maximum block size in bytes
+#define TEST_BLOCK_SIZE_MAX 20000
+/// Number of blocks to write
+#define TEST_BLOCK_COUNT 300
+
+/**
+ * Get the size of a test block, covering unaligned and multi-page sizes.
+ *
+ * @param index The block index
+ * @return The block size in bytes
+ */
+static size_t block_size(int index) {
+    return 100 + ((size_t)index * 7919) % (TEST_BLOCK_SIZE_MAX - 100);
+}
+
+/**
+ * Write blocks with trailers overwritten by the next block and periodic header
+ * rewrites, then verify the file content.
+ *
+ * @param directory Directory to create the test file in
+ * @param backend The writer backend to test
+ * @param direct_enable Whether to use direct I/O
+ */
+static void test_write(char const *const directory,
+                       rl_writer_backend_t backend, bool direct_enable) {
+    char file_name[PATH_MAX];
+    snprintf(file_name, PATH_MAX, "%s/test_rl_writer_XXXXXX", directory);
+    int fd = mkstemp(file_name);
+    if (fd < 0) {
+        return;
+    }
+
+    rl_writer_t writer;
+    rl_writer_file_t file;
+    int res = rl_writer_init(&writer, TEST_BLOCK_SIZE_MAX + TEST_TRAILER_SIZE,
+                             backend, direct_enable);
+    CHECK(res == SUCCESS);
+    if (res < 0) {
+        close(fd);
+        unlink(file_name);
+        return;
+    }
+    // direct I/O is not available on all file systems (e.g. tmpfs)
+    rl_writer_file_open(&file, fd, direct_enable ? file_name : NULL);
+
+    uint64_t offset = TEST_HEADER_SIZE;
+    uint32_t submit_count = 0;
+    for (int i = 0; i < TEST_BLOCK_COUNT; i++) {
+        size_t const size = block_size(i);
+        uint8_t *block = rl_writer_get_buffer(&writer, offset);
+        memset(block, (uint8_t)i, size);
+        memset(block + size, 0xff, TEST_TRAILER_SIZE);
+        res = rl_writer_submit(&writer, &file, block, size + TEST_TRAILER_SIZE,
+                               offset);
+        CHECK(res == SUCCESS);
+        offset += size;
+        submit_count++;
+
+        if (i % 10 == 0) {
+            uint8_t *header = rl_writer_get_buffer(&writer, 0);
+            memset(header, (uint8_t)i, TEST_HEADER_SIZE);
+            res = rl_writer_submit(&writer, &file, header, TEST_HEADER_SIZE, 0);
+            CHECK(res == SUCCESS);
+            submit_count++;
+        }
+    }
+    CHECK(rl_writer_flush(&writer) == SUCCESS);
+
+    // statistics of all completed writes
+    rl_status_t status;
+    memset(&status, 0, sizeof(status));
+    rl_writer_update_status(&writer, &status);
+    uint32_t latency_count = 0;
+    for (int i = 0; i < RL_TIMING_HISTOGRAM_BINS; i++) {
+        latency_count += status.write_latency_histogram[i];
+    }
+    CHECK(status.write_queue_depth == 0);
+    CHECK(status.write_queue_depth_max >= 1);
+    CHECK(status.write_queue_depth_max <= RL_WRITER_BUFFER_COUNT);
+    CHECK(latency_count == submit_count);
+
+    rl_writer_deinit(&writer);
+    rl_writer_file_close(&file);
+
+    // verify header, blocks in order and final trailer
+    struct stat file_stat;
+    CHECK(fstat(fd, &file_stat) == 0);
+    CHECK((uint64_t)file_stat.st_size == offset + TEST_TRAILER_SIZE);
+
+    uint8_t *data = malloc(offset + TEST_TRAILER_SIZE);
+    CHECK(pread(fd, data, offset + TEST_TRAILER_SIZE, 0) ==
+          (ssize_t)(offset + TEST_TRAILER_SIZE));
+    bool valid = true;
+    for (size_t j = 0; j < TEST_HEADER_SIZE; j++) {
+        valid = valid && data[j] == (uint8_t)((TEST_BLOCK_COUNT - 1) / 10 * 10);
+    }
+    uint64_t block_offset = TEST_HEADER_SIZE;
+    for (int i = 0; i < TEST_BLOCK_COUNT; i++) {
+        for (size_t j = 0; j < block_size(i); j++) {
+            valid = valid && data[block_offset + j] == (uint8_t)i;
+        }
+        block_offset += block_size(i);
+    }
+    for (size_t j = 0; j < TEST_TRAILER_SIZE; j++) {
+        valid = valid && data[block_offset + j] == 0xff;
+    }
+    CHECK(valid);
+    if (!valid) {
+        fprintf(stderr, "invalid content: %s, backend %d, direct %d\n",
+                directory, writer.backend, direct_enable);
+    }
+
+    free(data);
+    close(fd);
+    unlink(file_name);
+}
+
+/**
+ * Fail submitting writes to io_uring and verify that waiting for the failed
+ * writes returns an error instead of blocking, and that writing continues
+ * once submission succeeds again.
+ */
+static void test_submit_failure(void) {
+    char file_name[] = "test_rl_writer_XXXXXX";
+    int fd = mkstemp(file_name);
+    if (fd < 0) {
+        return;
+    }
+
+    rl_writer_t writer;
+    rl_writer_file_t file;
+    int res = rl_writer_init(&writer, TEST_BLOCK_SIZE_MAX,
+                             RL_WRITER_BACKEND_IO_URING, false);
+    CHECK(res == SUCCESS);
+    if (res < 0 || writer.backend != RL_WRITER_BACKEND_IO_URING) {
+        if (res == SUCCESS) {
+            rl_writer_deinit(&writer);
+        }
+        close(fd);
+        unlink(file_name);
+        return;
+    }
+    rl_writer_file_open(&file, fd, NULL);
+
+    // let the completion thread start waiting for completions
+    usleep(100000);
+
+    // submission fails on an invalid ring descriptor, while the idle
+    // completion thread keeps waiting on the valid one
+    int const ring_fd = writer.ring_fd;
+    writer.ring_fd = -1;
+    uint8_t *block = rl_writer_get_buffer(&writer, 0);
+    memset(block, 0xa5, TEST_HEADER_SIZE);
+    res = rl_writer_submit(&writer, &file, block, TEST_HEADER_SIZE, 0);
+    CHECK(res == SUCCESS);
+    res = rl_writer_flush(&writer);
+    CHECK(res == ERROR);
+    CHECK(errno == EBADF);
+
+    writer.ring_fd = ring_fd;
+    block = rl_writer_get_buffer(&writer, 0);
+    memset(block, 0x5a, TEST_HEADER_SIZE);
+    res = rl_writer_submit(&writer, &file, block, TEST_HEADER_SIZE, 0);
+    CHECK(res == SUCCESS);
+    CHECK(rl_writer_flush(&writer) == SUCCESS);
+
+    rl_writer_deinit(&writer);
+    rl_writer_file_close(&file);
+
+    uint8_t data[TEST_HEADER_SIZE];
+    CHECK(pread(fd, data, TEST_HEADER_SIZE, 0) == TEST_HEADER_SIZE);
+    bool valid = true;
+    for (size_t j = 0; j < TEST_HEADER_SIZE; j++) {
+        valid = valid && data[j] == 0x5a;
+    }
+    CHECK(valid);
+
+    close(fd);
+    unlink(file_name);
+}
+
+int main(void) {
+    // file system of the build directory and tmpfs
+    char const *const directories[] = {".", "/dev/shm"};
+
+    for (size_t i = 0; i < sizeof(directories) / sizeof(directories[0]);
+         i++) {
+        test_write(directories[i], RL_WRITER_BACKEND_IO_URING, false);
+        test_write(directories[i], RL_WRITER_BACKEND_IO_URING, true);
+        test_write(directories[i], RL_WRITER_BACKEND_THREAD, false);
+        test_write(directories[i], RL_WRITER_BACKEND_THREAD, true);
+    }
+
+    test_submit_failure();
+
+    return test_result();
+}
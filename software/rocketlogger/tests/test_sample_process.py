@@ -60,6 +60,23 @@ def tes_digital_only(measurement_config, rate):
     sample_load_assert(measurement_config)
 
 
+@pytest.mark.parametrize("rate", cli.sample_rates)
+def test_pipeline(measurement_config, rate):
+    measurement_config["rate"] = rate
+    measurement_config["samples"] = 5 * rate
+    measurement_config["pipeline"] = True
+    sample_load_assert(measurement_config)
+
+
+@pytest.mark.parametrize("rate", cli.sample_rates)
+def test_realtime(measurement_config, rate):
+    measurement_config["rate"] = rate
+    measurement_config["samples"] = 5 * rate
+    measurement_config["pipeline"] = True
+    measurement_config["realtime"] = True
+    sample_load_assert(measurement_config)
+
+
 @pytest.mark.parametrize("rate", cli.sample_rates)
 def test_split_default(measurement_config, rate):
     measurement_config["rate"] = rate
@@ -109,6 +109,21 @@ void create_time_stamp(rl_timestamp_t *const timestamp_realtime,
     timestamp_monotonic->nsec = (int64_t)spec_monotonic.tv_nsec;
 }
 
+void add_time_stamp_offset(rl_timestamp_t *const timestamp,
+                           int64_t offset_ns) {
+    timestamp->sec += offset_ns / (int64_t)1e9;
+    timestamp->nsec += offset_ns % (int64_t)1e9;
+
+    // normalize nanoseconds to the range [0, 1e9)
+    if (timestamp->nsec < 0) {
+        timestamp->sec -= 1;
+        timestamp->nsec += (int64_t)1e9;
+    } else if (timestamp->nsec >= (int64_t)1e9) {
+        timestamp->sec += 1;
+        timestamp->nsec -= (int64_t)1e9;
+    }
+}
+
 void get_mac_addr(uint8_t mac_address[MAC_ADDRESS_LENGTH]) {
     FILE *fp = fopen(MAC_ADDRESS_FILE, "r");
 
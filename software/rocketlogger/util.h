@@ -130,6 +130,14 @@ int div_ceil(int n, int d);
 void create_time_stamp(rl_timestamp_t *const time_realtime,
                        rl_timestamp_t *const time_monotonic);
 
+/**
+ * Shift a time stamp by a time offset.
+ *
+ * @param timestamp Timestamp data structure to shift
+ * @param offset_ns The time offset to add in nanoseconds (may be negative)
+ */
+void add_time_stamp_offset(rl_timestamp_t *const timestamp, int64_t offset_ns);
+
 /**
  * Get MAC address of network device.
  *